@@ -19,6 +19,7 @@ RUN_TESTS=false
 RUN_EXAMPLES=false
 CLEAN=false
 VERBOSE=false
+PREMAKE_OPTIONS=""
 JOBS=$(nproc 2>/dev/null || sysctl -n hw.ncpu 2>/dev/null || echo 4)
 
 # Script directory
@@ -45,12 +46,13 @@ usage() {
     echo "  --rebuild            Clean + Generate + Build"
     echo "  --test               Run Python tests (auto-creates venv + installs deps)"
     echo "  --examples           Run all example programs"
-    echo "  --benchmark          Run benchmark example"
+    echo "  --benchmark          Run benchmark and replay benchmark examples"
     echo "  --all                Build and run tests and examples"
     echo ""
     echo -e "${YELLOW}Configuration:${NC}"
     echo "  --debug              Build in debug mode"
     echo "  --release            Build in release mode (default)"
+    echo "  --trace              Compile in MX_TRACE trace points"
     echo ""
     echo -e "${YELLOW}Compiler:${NC}"
     echo "  --gcc                Use GCC compiler (default)"
@@ -141,10 +143,10 @@ generate() {
     # This ensures "location build" puts files in ./build/
     case "$PLATFORM" in
         linux|macosx)
-            premake5 gmake2
+            premake5 $PREMAKE_OPTIONS gmake2
             ;;
         windows)
-            premake5 vs2022
+            premake5 $PREMAKE_OPTIONS vs2022
             ;;
         *)
             print_error "Unknown platform: $PLATFORM"
@@ -356,6 +358,11 @@ run_benchmark() {
     echo "========================================"
     "$EXAMPLE_DIR/Benchmark"
     echo "========================================"
+    if [ -f "$EXAMPLE_DIR/ReplayBenchmark" ]; then
+        "$EXAMPLE_DIR/ReplayBenchmark" --json "$SCRIPT_DIR/$BUILD_DIR/replay_benchmark.json"
+        echo "========================================"
+        print_info "Replay results written to $BUILD_DIR/replay_benchmark.json"
+    fi
     echo ""
     
     print_success "Benchmark complete"
@@ -378,6 +385,7 @@ while [ $# -gt 0 ]; do
         --all) ACTION="build"; RUN_TESTS=true; RUN_EXAMPLES=true ;;
         --debug) CONFIG="debug" ;;
         --release) CONFIG="release" ;;
+        --trace) PREMAKE_OPTIONS="--trace" ;;
         --gcc) COMPILER="gcc" ;;
         --clang) COMPILER="clang" ;;
         -j|--jobs) shift; JOBS="$1" ;;
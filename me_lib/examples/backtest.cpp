@@ -0,0 +1,701 @@
+/**
+ * Backtest - deterministic parallel replay of historical events
+ * Partitions a memory-mapped, time-ordered event file by symbol and
+ * replays every symbol on its own context and book, in simulated time,
+ * on a work-stealing thread pool. Fills are gathered per thread and
+ * merged in symbol order, so the output (and its checksum) is identical
+ * whatever the thread count or scheduling.
+ *
+ * Usage:
+ *   Backtest [options]
+ *     --generate FILE    Write a generated event file to FILE and exit
+ *     --input FILE       Replay an event file (default: generate one in memory)
+ *     --symbols N        Symbols to generate (default 64)
+ *     --events N         Events to generate (default 4000000)
+ *     --seed N           Generator seed (default 1)
+ *     --threads N        Worker threads (default: all cores)
+ *     --fills FILE       Write every fill, in symbol then time order
+ *     --check            Replay again on one thread and compare
+ */
+
+#include "matchengine.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BACKTEST_HAS_MMAP 1
+#endif
+
+using Clock = std::chrono::steady_clock;
+using Duration = std::chrono::duration<double>;
+
+/* ============================================================================
+ * Event File Format
+ * Header, symbol_count 16-byte zero-padded names, then record_count
+ * events in time order. Events of different symbols interleave freely.
+ * ========================================================================= */
+
+static const char EVENT_MAGIC[8] = { 'M', 'X', 'E', 'V', 'E', 'N', 'T', 'S' };
+static const uint32_t EVENT_VERSION = 1;
+static const uint32_t SYMBOL_NAME_SIZE = 16;
+
+struct EventHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t record_count;
+    uint32_t symbol_count;
+    uint32_t reserved;
+};
+
+enum EventType : uint8_t {
+    EVENT_ADD = 'A',            // Resting limit order
+    EVENT_CANCEL = 'X',         // Cancel (the order may already be gone)
+    EVENT_MODIFY = 'U',         // Reduce total quantity
+    EVENT_EXECUTE = 'E',        // IOC limit order
+    EVENT_MARKET = 'M'          // Market order
+};
+
+struct EventRecord {
+    uint64_t timestamp;         // Nanoseconds; becomes the context's time
+    uint64_t order_id;
+    uint32_t symbol;            // Index into the symbol table
+    uint32_t price;
+    uint32_t quantity;
+    uint8_t type;               // EventType
+    uint8_t side;               // mx_side_t
+    uint8_t reserved[2];
+};
+
+static_assert(sizeof(EventRecord) == 32, "EventRecord is part of the file format");
+
+/**
+ * One trade, as written to --fills
+ */
+struct Fill {
+    uint64_t timestamp;
+    uint64_t aggressive_order_id;
+    uint64_t passive_order_id;
+    uint32_t symbol;
+    uint32_t price;
+    uint32_t quantity;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(Fill) == 40, "Fill is part of the output format");
+
+/* ============================================================================
+ * Event Source
+ * A mapped event file, or a buffer generated in memory
+ * ========================================================================= */
+
+class EventFile {
+private:
+    const uint8_t* data_;
+    size_t size_;
+    std::vector<uint8_t> buffer_;
+#if defined(BACKTEST_HAS_MMAP)
+    void* mapping_;
+#endif
+
+public:
+    EventFile() : data_(nullptr), size_(0) {
+#if defined(BACKTEST_HAS_MMAP)
+        mapping_ = nullptr;
+#endif
+    }
+    
+    ~EventFile() {
+#if defined(BACKTEST_HAS_MMAP)
+        if (mapping_) munmap(mapping_, size_);
+#endif
+    }
+    
+    EventFile(const EventFile&) = delete;
+    EventFile& operator=(const EventFile&) = delete;
+    
+    void adopt(std::vector<uint8_t> buffer) {
+        buffer_ = std::move(buffer);
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+    }
+    
+    bool open(const std::string& path) {
+#if defined(BACKTEST_HAS_MMAP)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) return false;
+        mapping_ = mapping;
+        data_ = static_cast<const uint8_t*>(mapping);
+        size_ = static_cast<size_t>(info.st_size);
+        return true;
+#else
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        adopt(std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                                   std::istreambuf_iterator<char>()));
+        return true;
+#endif
+    }
+    
+    bool valid() const {
+        if (size_ < sizeof(EventHeader)) return false;
+        const EventHeader& h = header();
+        if (std::memcmp(h.magic, EVENT_MAGIC, sizeof(EVENT_MAGIC)) != 0 ||
+            h.version != EVENT_VERSION || h.record_size != sizeof(EventRecord) || h.symbol_count == 0) {
+            return false;
+        }
+        size_t records_offset = sizeof(EventHeader) + static_cast<size_t>(h.symbol_count) * SYMBOL_NAME_SIZE;
+        return size_ >= records_offset &&
+               (size_ - records_offset) / sizeof(EventRecord) >= h.record_count;
+    }
+    
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    
+    const EventHeader& header() const {
+        return *reinterpret_cast<const EventHeader*>(data_);
+    }
+    
+    std::string symbol(uint32_t index) const {
+        const char* name = reinterpret_cast<const char*>(data_ + sizeof(EventHeader)) + index * SYMBOL_NAME_SIZE;
+        return std::string(name, strnlen(name, SYMBOL_NAME_SIZE));
+    }
+    
+    const EventRecord* records() const {
+        return reinterpret_cast<const EventRecord*>(
+            data_ + sizeof(EventHeader) + static_cast<size_t>(header().symbol_count) * SYMBOL_NAME_SIZE);
+    }
+};
+
+/* ============================================================================
+ * Event Generator
+ * Symbol activity is Zipf-like (symbol k gets weight 1 / (k + 1)), so a
+ * few names dominate the file the way they do in real market data and
+ * a static split of symbols over threads would leave most of them idle
+ * ========================================================================= */
+
+struct GeneratorOptions {
+    uint32_t symbols = 64;
+    uint64_t events = 4000000;
+    uint32_t seed = 1;
+};
+
+static std::vector<uint8_t> generate_events(const GeneratorOptions& options) {
+    std::mt19937_64 rng(options.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    
+    std::vector<double> weights(options.symbols);
+    for (uint32_t i = 0; i < options.symbols; ++i) {
+        weights[i] = 1.0 / (i + 1);
+    }
+    std::discrete_distribution<uint32_t> pick_symbol(weights.begin(), weights.end());
+    
+    size_t records_offset = sizeof(EventHeader) + static_cast<size_t>(options.symbols) * SYMBOL_NAME_SIZE;
+    std::vector<uint8_t> data(records_offset + options.events * sizeof(EventRecord), 0);
+    
+    EventHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, EVENT_MAGIC, sizeof(EVENT_MAGIC));
+    header.version = EVENT_VERSION;
+    header.record_size = sizeof(EventRecord);
+    header.record_count = options.events;
+    header.symbol_count = options.symbols;
+    std::memcpy(data.data(), &header, sizeof(header));
+    
+    for (uint32_t i = 0; i < options.symbols; ++i) {
+        char* name = reinterpret_cast<char*>(data.data() + sizeof(EventHeader)) + i * SYMBOL_NAME_SIZE;
+        std::snprintf(name, SYMBOL_NAME_SIZE, "SYM%04u", i);
+    }
+    
+    // Orders each symbol has added, for cancels and modifies to pick from.
+    // Some will have traded away by then, as in real feeds.
+    std::vector<std::vector<uint64_t>> live(options.symbols);
+    
+    EventRecord* records = reinterpret_cast<EventRecord*>(data.data() + records_offset);
+    uint64_t timestamp = 1700000000ull * 1000000000ull;
+    uint64_t next_id = 1;
+    
+    for (uint64_t i = 0; i < options.events; ++i) {
+        EventRecord& event = records[i];
+        timestamp += 1 + rng() % 1000;
+        event.timestamp = timestamp;
+        event.symbol = pick_symbol(rng);
+        event.side = static_cast<uint8_t>((rng() & 1) ? MX_SIDE_BUY : MX_SIDE_SELL);
+        
+        uint32_t mid = 10000 + event.symbol * 100;
+        std::vector<uint64_t>& orders = live[event.symbol];
+        double action = unit(rng);
+        
+        if (action < 0.35 && !orders.empty()) {
+            size_t pick = rng() % orders.size();
+            event.type = EVENT_CANCEL;
+            event.order_id = orders[pick];
+            orders[pick] = orders.back();
+            orders.pop_back();
+        } else if (action < 0.40 && !orders.empty()) {
+            event.type = EVENT_MODIFY;
+            event.order_id = orders[rng() % orders.size()];
+            event.quantity = 1 + static_cast<uint32_t>(rng() % 50);
+        } else if (action < 0.48) {
+            event.type = EVENT_EXECUTE;
+            event.order_id = next_id++;
+            event.price = event.side == MX_SIDE_BUY ? mid + 5 : mid - 5;
+            event.quantity = 1 + static_cast<uint32_t>(rng() % 300);
+        } else if (action < 0.50) {
+            event.type = EVENT_MARKET;
+            event.order_id = next_id++;
+            event.quantity = 1 + static_cast<uint32_t>(rng() % 100);
+        } else {
+            uint32_t offset = 1 + static_cast<uint32_t>(rng() % 20);
+            event.type = EVENT_ADD;
+            event.order_id = next_id++;
+            event.price = event.side == MX_SIDE_BUY ? mid - offset : mid + offset;
+            event.quantity = 1 + static_cast<uint32_t>(rng() % 100);
+            orders.push_back(event.order_id);
+        }
+    }
+    return data;
+}
+
+/* ============================================================================
+ * Partitioning
+ * Each thread counts its slice of the file per symbol; the counts give
+ * every (slice, symbol) pair its own output range, and a second pass
+ * fills the ranges. A symbol's events keep their file order.
+ * ========================================================================= */
+
+struct Partition {
+    std::vector<uint32_t> events;      // Record indices grouped by symbol
+    std::vector<uint64_t> begin;       // symbol_count + 1 offsets into events
+};
+
+static void partition_events(const EventFile& file, uint32_t threads, Partition& out) {
+    const EventHeader& header = file.header();
+    const EventRecord* records = file.records();
+    uint64_t count = header.record_count;
+    uint32_t symbols = header.symbol_count;
+    
+    std::vector<std::vector<uint64_t>> offsets(threads, std::vector<uint64_t>(symbols, 0));
+    auto slice_begin = [&](uint32_t t) { return count * t / threads; };
+    
+    auto run = [&](void (*pass)(const EventRecord*, uint64_t, uint64_t, uint32_t,
+                                std::vector<uint64_t>&, Partition&)) {
+        std::vector<std::thread> workers;
+        for (uint32_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                pass(records, slice_begin(t), slice_begin(t + 1), symbols, offsets[t], out);
+            });
+        }
+        for (auto& worker : workers) worker.join();
+    };
+    
+    run([](const EventRecord* records, uint64_t begin, uint64_t end, uint32_t symbols,
+           std::vector<uint64_t>& counts, Partition&) {
+        for (uint64_t i = begin; i < end; ++i) {
+            if (records[i].symbol < symbols) counts[records[i].symbol]++;
+        }
+    });
+    
+    // Prefix sums: symbol-major, slice-minor keeps file order within a symbol
+    out.begin.assign(symbols + 1, 0);
+    uint64_t total = 0;
+    for (uint32_t s = 0; s < symbols; ++s) {
+        out.begin[s] = total;
+        for (uint32_t t = 0; t < threads; ++t) {
+            uint64_t slice_count = offsets[t][s];
+            offsets[t][s] = total;
+            total += slice_count;
+        }
+    }
+    out.begin[symbols] = total;
+    out.events.resize(total);
+    
+    run([](const EventRecord* records, uint64_t begin, uint64_t end, uint32_t symbols,
+           std::vector<uint64_t>& next, Partition& partition) {
+        for (uint64_t i = begin; i < end; ++i) {
+            if (records[i].symbol < symbols) {
+                partition.events[next[records[i].symbol]++] = static_cast<uint32_t>(i);
+            }
+        }
+    });
+}
+
+/* ============================================================================
+ * Work-Stealing Pool
+ * One task per symbol. Tasks are dealt largest first, round robin, onto
+ * per-worker deques; a worker takes from the front of its own deque and
+ * steals from the back of the others' once it runs dry.
+ * ========================================================================= */
+
+class TaskPool {
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<uint32_t> tasks;
+    };
+    
+    std::vector<Queue> queues_;
+    std::atomic<uint64_t> steals_;
+
+public:
+    explicit TaskPool(uint32_t workers) : queues_(workers), steals_(0) {}
+    
+    void push(uint32_t worker, uint32_t task) {
+        queues_[worker].tasks.push_back(task);
+    }
+    
+    bool next(uint32_t worker, uint32_t& task) {
+        {
+            Queue& own = queues_[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = own.tasks.front();
+                own.tasks.pop_front();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queues_.size(); ++i) {
+            Queue& victim = queues_[(worker + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.back();
+                victim.tasks.pop_back();
+                steals_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    uint64_t steals() const { return steals_.load(); }
+};
+
+/* ============================================================================
+ * Backtest
+ * ========================================================================= */
+
+struct SymbolResult {
+    uint32_t worker;            // Whose fill buffer holds this symbol's fills
+    uint64_t fill_begin;
+    uint64_t fill_end;
+    uint64_t events;
+    uint64_t rejected;          // Events that did not return MX_STATUS_OK
+    uint64_t volume;
+};
+
+struct BacktestResult {
+    std::vector<std::vector<Fill>> fills;   // Per worker, in task order
+    std::vector<SymbolResult> symbols;
+    uint64_t steals;
+    double partition_seconds;
+    double replay_seconds;
+    
+    template<typename F>
+    void for_each_fill(F&& visit) const {
+        for (const SymbolResult& symbol : symbols) {
+            const std::vector<Fill>& buffer = fills[symbol.worker];
+            for (uint64_t i = symbol.fill_begin; i < symbol.fill_end; ++i) {
+                visit(buffer[i]);
+            }
+        }
+    }
+    
+    uint64_t fill_count() const {
+        uint64_t count = 0;
+        for (const SymbolResult& symbol : symbols) count += symbol.fill_end - symbol.fill_begin;
+        return count;
+    }
+    
+    /**
+     * FNV-1a over every fill in symbol, then time order
+     */
+    uint64_t checksum() const {
+        uint64_t hash = 14695981039346656037ull;
+        for_each_fill([&hash](const Fill& fill) {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&fill);
+            for (size_t i = 0; i < sizeof(Fill); ++i) {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+        });
+        return hash;
+    }
+};
+
+class Backtest {
+private:
+    const EventFile& file_;
+    uint32_t threads_;
+    Partition partition_;
+    double partition_seconds_;
+    
+    struct TaskState {
+        std::vector<Fill>* fills;
+        uint32_t symbol;
+        uint64_t volume;
+    };
+    
+    static void trade_callback(void* user_data, uint64_t aggressive_order_id,
+                               uint64_t passive_order_id, uint32_t price,
+                               uint32_t quantity, uint64_t timestamp) {
+        TaskState* state = static_cast<TaskState*>(user_data);
+        Fill fill;
+        fill.timestamp = timestamp;
+        fill.aggressive_order_id = aggressive_order_id;
+        fill.passive_order_id = passive_order_id;
+        fill.symbol = state->symbol;
+        fill.price = price;
+        fill.quantity = quantity;
+        fill.reserved = 0;
+        state->fills->push_back(fill);
+        state->volume += quantity;
+    }
+    
+    static int apply(mx_order_book_t* book, const EventRecord& event) {
+        mx_side_t side = static_cast<mx_side_t>(event.side);
+        switch (event.type) {
+            case EVENT_ADD:
+                return mx_order_book_add_limit(book, event.order_id, side, event.price, event.quantity);
+            case EVENT_CANCEL:
+                return mx_order_book_cancel(book, event.order_id);
+            case EVENT_MODIFY:
+                return mx_order_book_modify(book, event.order_id, event.quantity);
+            case EVENT_EXECUTE:
+                return mx_order_book_add_order(book, event.order_id, MX_ORDER_TYPE_LIMIT, side,
+                                               event.price, 0, event.quantity, 0, MX_TIF_IOC, 0, 0);
+            case EVENT_MARKET:
+                return mx_order_book_add_market(book, event.order_id, side, event.quantity);
+            default:
+                return MX_STATUS_INVALID_PARAM;
+        }
+    }
+    
+    /**
+     * Replay one symbol on a fresh context, advancing its clock to each
+     * event's timestamp before applying it
+     */
+    void run_symbol(uint32_t symbol, uint32_t worker, std::vector<Fill>& fills,
+                    SymbolResult& result) const {
+        const EventRecord* records = file_.records();
+        
+        TaskState state;
+        state.fills = &fills;
+        state.symbol = symbol;
+        state.volume = 0;
+        
+        mx_context_t* ctx = mx_context_new();
+        mx_context_set_callbacks(ctx, trade_callback, nullptr, &state);
+        mx_order_book_t* book = mx_order_book_new(ctx, file_.symbol(symbol).c_str());
+        
+        result.worker = worker;
+        result.fill_begin = fills.size();
+        result.events = partition_.begin[symbol + 1] - partition_.begin[symbol];
+        result.rejected = 0;
+        
+        for (uint64_t i = partition_.begin[symbol]; i < partition_.begin[symbol + 1]; ++i) {
+            const EventRecord& event = records[partition_.events[i]];
+            mx_context_set_timestamp(ctx, event.timestamp);
+            result.rejected += apply(book, event) != MX_STATUS_OK;
+        }
+        
+        result.fill_end = fills.size();
+        result.volume = state.volume;
+        
+        mx_order_book_free(book);
+        mx_context_free(ctx);
+    }
+
+public:
+    Backtest(const EventFile& file, uint32_t threads)
+        : file_(file), threads_(threads) {
+        auto start = Clock::now();
+        partition_events(file_, threads_, partition_);
+        partition_seconds_ = Duration(Clock::now() - start).count();
+    }
+    
+    BacktestResult run(uint32_t workers) const {
+        uint32_t symbols = file_.header().symbol_count;
+        
+        BacktestResult result;
+        result.fills.resize(workers);
+        result.symbols.resize(symbols);
+        result.partition_seconds = partition_seconds_;
+        
+        // Largest symbols first so the stragglers at the end are small
+        std::vector<uint32_t> order(symbols);
+        for (uint32_t s = 0; s < symbols; ++s) order[s] = s;
+        std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+            return partition_.begin[a + 1] - partition_.begin[a] > partition_.begin[b + 1] - partition_.begin[b];
+        });
+        
+        TaskPool pool(workers);
+        for (uint32_t i = 0; i < symbols; ++i) {
+            pool.push(i % workers, order[i]);
+        }
+        
+        auto start = Clock::now();
+        std::vector<std::thread> threads;
+        for (uint32_t w = 0; w < workers; ++w) {
+            threads.emplace_back([this, w, &pool, &result] {
+                uint32_t symbol;
+                while (pool.next(w, symbol)) {
+                    run_symbol(symbol, w, result.fills[w], result.symbols[symbol]);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        
+        result.replay_seconds = Duration(Clock::now() - start).count();
+        result.steals = pool.steals();
+        return result;
+    }
+};
+
+/* ============================================================================
+ * Main
+ * ========================================================================= */
+
+static void usage() {
+    std::cout << "Usage: Backtest [--generate FILE | --input FILE] [--symbols N] [--events N]\n"
+                 "                [--seed N] [--threads N] [--fills FILE] [--check]\n";
+}
+
+static bool write_fills(const std::string& path, const BacktestResult& result) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    result.for_each_fill([&out](const Fill& fill) {
+        out.write(reinterpret_cast<const char*>(&fill), sizeof(fill));
+    });
+    return static_cast<bool>(out);
+}
+
+int main(int argc, char** argv) {
+    GeneratorOptions options;
+    std::string generate_path;
+    std::string input_path;
+    std::string fills_path;
+    uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+    bool check = false;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            usage();
+            return 0;
+        }
+        if (arg == "--check") {
+            check = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "--generate") generate_path = value;
+        else if (arg == "--input") input_path = value;
+        else if (arg == "--fills") fills_path = value;
+        else if (arg == "--symbols") options.symbols = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--events") options.events = std::strtoull(value, nullptr, 10);
+        else if (arg == "--seed") options.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--threads") threads = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (options.symbols == 0 || threads == 0 || options.events > UINT32_MAX) {
+        usage();
+        return 1;
+    }
+    
+    std::cout << "MatchX Matching Engine - Parallel Backtest\n";
+    std::cout << "==========================================\n";
+    
+    EventFile file;
+    if (input_path.empty()) {
+        file.adopt(generate_events(options));
+    } else if (!file.open(input_path)) {
+        std::cerr << "Cannot open event file " << input_path << "\n";
+        return 1;
+    }
+    if (!file.valid() || file.header().record_count > UINT32_MAX) {
+        std::cerr << "Not a valid event file\n";
+        return 1;
+    }
+    
+    const EventHeader& header = file.header();
+    if (!generate_path.empty()) {
+        std::ofstream out(generate_path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+        if (!out) {
+            std::cerr << "Cannot write " << generate_path << "\n";
+            return 1;
+        }
+        std::cout << "Wrote " << header.record_count << " events over " << header.symbol_count
+                  << " symbols to " << generate_path << "\n";
+        return 0;
+    }
+    
+    Backtest backtest(file, threads);
+    BacktestResult result = backtest.run(threads);
+    
+    uint64_t rejected = 0;
+    uint64_t volume = 0;
+    for (const SymbolResult& symbol : result.symbols) {
+        rejected += symbol.rejected;
+        volume += symbol.volume;
+    }
+    
+    std::cout << "  Events:       " << header.record_count << " over " << header.symbol_count << " symbols\n";
+    std::cout << "  Threads:      " << threads << " (" << result.steals << " tasks stolen)\n";
+    std::cout << "  Partition:    " << std::fixed << std::setprecision(4) << result.partition_seconds << " seconds\n";
+    std::cout << "  Replay:       " << std::fixed << std::setprecision(4) << result.replay_seconds << " seconds\n";
+    std::cout << "  Events/sec:   " << std::fixed << std::setprecision(0)
+              << (result.replay_seconds > 0 ? header.record_count / result.replay_seconds : 0.0) << "\n";
+    std::cout << "  Fills:        " << result.fill_count() << "\n";
+    std::cout << "  Volume:       " << volume << "\n";
+    std::cout << "  Rejected:     " << rejected << "\n";
+    std::cout << "  Checksum:     " << std::hex << std::setw(16) << std::setfill('0')
+              << result.checksum() << std::dec << std::setfill(' ') << "\n";
+    
+    if (!fills_path.empty() && !write_fills(fills_path, result)) {
+        std::cerr << "Cannot write " << fills_path << "\n";
+        return 1;
+    }
+    
+    if (check) {
+        BacktestResult reference = backtest.run(1);
+        bool same = reference.checksum() == result.checksum() &&
+                    reference.fill_count() == result.fill_count();
+        std::cout << "  Check:        single-threaded replay "
+                  << (same ? "matches" : "DIFFERS") << "\n";
+        if (!same) return 1;
+    }
+    
+    std::cout << "\n✓ Backtest complete!\n\n";
+    return 0;
+}
@@ -34,6 +34,7 @@ void on_order_event(void* user_data, uint64_t order_id, mx_order_event_t event,
         case 4: event_str = "CANCELLED"; break;
         case 5: event_str = "EXPIRED"; break;
         case 6: event_str = "TRIGGERED"; break;
+        case 7: event_str = "REPLACED"; break;
     }
     
     printf("  ORDER #%llu: %s (filled: %u, remaining: %u)\n",
@@ -9,15 +9,79 @@
 #include <chrono>
 #include <vector>
 #include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 using Clock = std::chrono::high_resolution_clock;
 using Duration = std::chrono::duration<double>;
 
+/**
+ * L1 data-cache read-miss counter for the calling thread
+ * Uses perf_event_open on Linux; elsewhere (or without permission)
+ * available() is false and the benchmark prints n/a
+ */
+class CacheMissCounter {
+private:
+    int fd_;
+
+public:
+    CacheMissCounter() : fd_(-1) {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_L1D |
+                      (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    
+    ~CacheMissCounter() {
+#if defined(__linux__)
+        if (fd_ >= 0) close(fd_);
+#endif
+    }
+    
+    bool available() const { return fd_ >= 0; }
+    
+    void start() {
+#if defined(__linux__)
+        if (fd_ < 0) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+    
+    uint64_t stop() {
+        uint64_t count = 0;
+#if defined(__linux__)
+        if (fd_ < 0) return 0;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd_, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) {
+            count = 0;
+        }
+#endif
+        return count;
+    }
+};
+
 class Benchmark {
 private:
     mx_context_t* ctx_;
     mx_order_book_t* book_;
     size_t trade_count_;
+    bool price_ladder_;
     
     static void trade_callback(void* user_data, uint64_t, uint64_t,
                               uint32_t, uint32_t, uint64_t) {
@@ -26,9 +90,14 @@ private:
     }
 
 public:
-    Benchmark() : trade_count_(0) {
+    explicit Benchmark(bool price_ladder = false)
+        : trade_count_(0), price_ladder_(price_ladder) {
         ctx_ = mx_context_new();
         mx_context_set_callbacks(ctx_, trade_callback, nullptr, this);
+        if (price_ladder_) {
+            // $90k - $110k band at $1 ticks covers every price used below
+            mx_context_set_price_bounds(ctx_, 9000000, 11000000, 100);
+        }
         book_ = mx_order_book_new(ctx_, "BENCH");
     }
     
@@ -132,6 +201,59 @@ public:
         std::cout << "  Trades:       " << trade_count_ << "\n";
     }
     
+    /**
+     * Sweep levels of 50 resting orders with one aggressive order each
+     * With one cache line per Order, expect roughly one L1D miss per fill
+     */
+    void bench_level_sweep(size_t levels) {
+        const size_t orders_per_level = 50;
+        
+        std::cout << "\nBenchmark: Sweep " << levels << " levels of "
+                  << orders_per_level << " orders\n";
+        std::cout << std::string(50, '-') << "\n";
+        
+        mx_order_book_clear(book_);
+        trade_count_ = 0;
+        
+        // Build every level first so the sweep reads orders that have
+        // been evicted from L1 by the rest of the book
+        uint64_t next_id = 1;
+        for (size_t level = 0; level < levels; ++level) {
+            uint32_t price = 10000000 + static_cast<uint32_t>(level) * 100;
+            for (size_t i = 0; i < orders_per_level; ++i) {
+                mx_order_book_add_limit(book_, next_id++, MX_SIDE_SELL, price, 10);
+            }
+        }
+        
+        CacheMissCounter misses;
+        misses.start();
+        auto start = Clock::now();
+        
+        for (size_t level = 0; level < levels; ++level) {
+            uint32_t price = 10000000 + static_cast<uint32_t>(level) * 100;
+            mx_order_book_add_limit(book_, next_id++, MX_SIDE_BUY, price,
+                                   static_cast<uint32_t>(orders_per_level * 10));
+        }
+        
+        auto end = Clock::now();
+        uint64_t miss_count = misses.stop();
+        Duration elapsed = end - start;
+        
+        double fills = trade_count_ ? static_cast<double>(trade_count_) : 1.0;
+        
+        std::cout << "  Time:         " << std::fixed << std::setprecision(4) 
+                  << elapsed.count() << " seconds\n";
+        std::cout << "  Fills:        " << trade_count_ << "\n";
+        std::cout << "  Latency:      " << std::fixed << std::setprecision(1) 
+                  << (elapsed.count() * 1e9) / fills << " ns/fill\n";
+        if (misses.available()) {
+            std::cout << "  L1D misses:   " << std::fixed << std::setprecision(2)
+                      << miss_count / fills << " per fill\n";
+        } else {
+            std::cout << "  L1D misses:   n/a (perf counters unavailable)\n";
+        }
+    }
+    
     void bench_queries(size_t count) {
         std::cout << "\nBenchmark: " << count << " market data queries\n";
         std::cout << std::string(50, '-') << "\n";
@@ -176,10 +298,12 @@ public:
         std::cout << "╔════════════════════════════════════════════════╗\n";
         std::cout << "║   MatchX Performance Benchmark                 ║\n";
         std::cout << "╚════════════════════════════════════════════════╝\n";
+        std::cout << "  Price levels: " << (price_ladder_ ? "array ladder" : "std::map") << "\n";
         
         bench_add_orders(10000);
         bench_cancel_orders(10000);
         bench_matching(5000);
+        bench_level_sweep(2000);
         bench_queries(100000);
         
         std::cout << "\n✓ Benchmark complete!\n\n";
@@ -200,5 +324,8 @@ int main() {
     Benchmark bench;
     bench.run_all_benchmarks();
     
+    Benchmark ladder_bench(true);
+    ladder_bench.run_all_benchmarks();
+    
     return 0;
 }
@@ -0,0 +1,692 @@
+/**
+ * Replay Benchmark - order flow replay with latency percentiles
+ * Replays an ITCH-like add / cancel / modify / execute stream against a
+ * book built to a configurable depth and level spread, and reports
+ * throughput, per-operation p50/p99/p99.9 and allocations per operation.
+ *
+ * Usage:
+ *   ReplayBenchmark [options]
+ *     --generate FILE    Write a generated workload to FILE and exit
+ *     --replay FILE      Replay a workload file (default: generate one in memory)
+ *     --orders N         Flow records to generate (default 1000000)
+ *     --depth N          Initial price levels per side (default 50)
+ *     --spread N         Ticks between levels (default 1)
+ *     --seed N           Generator seed (default 1)
+ *     --backend NAME     map, ladder or both (default both)
+ *     --json FILE        Also write results as JSON, for regression gates
+ */
+
+#include "matchengine.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define REPLAY_HAS_MMAP 1
+#endif
+
+using Clock = std::chrono::steady_clock;
+using Duration = std::chrono::duration<double>;
+
+/* ============================================================================
+ * Allocation Counting
+ * Both the library's allocator hooks and global operator new are counted,
+ * so std::map nodes and pool growth show up alike
+ * ========================================================================= */
+
+static uint64_t g_allocations = 0;
+
+static void* counting_malloc(size_t size) {
+    ++g_allocations;
+    return std::malloc(size);
+}
+
+static void* counting_realloc(void* ptr, size_t size) {
+    ++g_allocations;
+    return std::realloc(ptr, size);
+}
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+/* ============================================================================
+ * Workload Format
+ * A header followed by fixed-size records, replayed straight from the
+ * mapped file. The first warmup_count records build the initial book and
+ * are not measured.
+ * ========================================================================= */
+
+static const char REPLAY_MAGIC[8] = { 'M', 'X', 'R', 'E', 'P', 'L', 'A', 'Y' };
+static const uint32_t REPLAY_VERSION = 1;
+
+struct ReplayHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t record_count;
+    uint64_t warmup_count;
+    uint32_t min_price;         // Every price in the file lies in
+    uint32_t max_price;         // [min_price, max_price] on tick_size
+    uint32_t tick_size;
+    uint32_t depth;             // Generator settings, for the report
+    uint32_t spread;
+    uint32_t reserved;
+};
+
+enum RecordType : uint8_t {
+    RECORD_ADD = 'A',           // Resting limit order
+    RECORD_CANCEL = 'X',        // Cancel a resting order
+    RECORD_MODIFY = 'U',        // Reduce a resting order's total quantity
+    RECORD_EXECUTE = 'E'        // IOC limit order at the opposite touch
+};
+
+struct ReplayRecord {
+    uint64_t order_id;
+    uint32_t price;
+    uint32_t quantity;
+    uint8_t type;               // RecordType
+    uint8_t side;               // mx_side_t
+    uint8_t reserved[6];
+};
+
+static_assert(sizeof(ReplayRecord) == 24, "ReplayRecord is part of the file format");
+
+struct GeneratorOptions {
+    uint64_t orders = 1000000;
+    uint32_t depth = 50;
+    uint32_t spread = 1;
+    uint32_t seed = 1;
+};
+
+/* ============================================================================
+ * Workload Generator
+ * Decides each record against a live book of its own, so cancels and
+ * modifies always name an order that is still resting, and executes
+ * trade against whatever the touch holds at that point
+ * ========================================================================= */
+
+class WorkloadGenerator {
+private:
+    static const uint32_t MID_PRICE = 10000000;     // $100k
+    static const uint32_t TICK_SIZE = 100;          // $1
+    static const uint32_t ORDERS_PER_LEVEL = 4;
+    
+    GeneratorOptions options_;
+    std::mt19937_64 rng_;
+    mx_context_t* ctx_;
+    mx_order_book_t* book_;
+    
+    std::vector<ReplayRecord> records_;
+    std::vector<uint64_t> live_;                    // Resting order IDs
+    std::unordered_map<uint64_t, size_t> live_index_;
+    uint64_t next_id_;
+    
+    static void order_callback(void* user_data, uint64_t order_id, mx_order_event_t event,
+                               uint32_t, uint32_t) {
+        if (event == MX_EVENT_ORDER_FILLED || event == MX_EVENT_ORDER_CANCELLED) {
+            static_cast<WorkloadGenerator*>(user_data)->forget(order_id);
+        }
+    }
+    
+    void forget(uint64_t order_id) {
+        auto it = live_index_.find(order_id);
+        if (it == live_index_.end()) return;
+        size_t index = it->second;
+        live_index_.erase(it);
+        if (index + 1 != live_.size()) {
+            live_[index] = live_.back();
+            live_index_[live_[index]] = index;
+        }
+        live_.pop_back();
+    }
+    
+    uint32_t level_price(mx_side_t side, uint32_t level) const {
+        uint32_t offset = (level + 1) * options_.spread * TICK_SIZE;
+        return side == MX_SIDE_BUY ? MID_PRICE - offset : MID_PRICE + offset;
+    }
+    
+    uint32_t max_level() const { return options_.depth * 2; }
+    
+    void emit(RecordType type, mx_side_t side, uint64_t order_id, uint32_t price, uint32_t quantity) {
+        ReplayRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.order_id = order_id;
+        record.price = price;
+        record.quantity = quantity;
+        record.type = type;
+        record.side = static_cast<uint8_t>(side);
+        records_.push_back(record);
+    }
+    
+    void add(mx_side_t side, uint32_t level, uint32_t quantity) {
+        uint64_t order_id = next_id_++;
+        uint32_t price = level_price(side, level);
+        emit(RECORD_ADD, side, order_id, price, quantity);
+        live_index_[order_id] = live_.size();
+        live_.push_back(order_id);
+        mx_order_book_add_limit(book_, order_id, side, price, quantity);
+    }
+    
+    mx_side_t random_side() {
+        return (rng_() & 1) ? MX_SIDE_BUY : MX_SIDE_SELL;
+    }
+    
+    uint32_t random_quantity(uint32_t max) {
+        return 1 + static_cast<uint32_t>(rng_() % max);
+    }
+    
+    // Levels from the touch, geometrically distributed: most flow lands
+    // near the inside as it does in real books
+    uint32_t random_level() {
+        std::geometric_distribution<uint32_t> distance(0.15);
+        uint32_t level = distance(rng_);
+        return level < max_level() ? level : max_level() - 1;
+    }
+    
+    void next_record() {
+        double action = std::uniform_real_distribution<double>(0.0, 1.0)(rng_);
+        
+        if (action < 0.50 || live_.empty()) {
+            add(random_side(), random_level(), random_quantity(100));
+            return;
+        }
+        
+        uint64_t order_id = live_[rng_() % live_.size()];
+        if (action < 0.85) {
+            emit(RECORD_CANCEL, MX_SIDE_BUY, order_id, 0, 0);
+            mx_order_book_cancel(book_, order_id);
+            return;
+        }
+        
+        if (action < 0.90) {
+            mx_side_t side = MX_SIDE_BUY;
+            uint32_t price = 0;
+            uint32_t remaining = 0;
+            uint32_t filled = 0;
+            mx_order_book_get_order_info(book_, order_id, &side, &price, &remaining, &filled);
+            if (remaining > 1) {
+                // modify takes the new total, filled part included
+                uint32_t quantity = filled + remaining / 2;
+                emit(RECORD_MODIFY, side, order_id, price, quantity);
+                mx_order_book_modify(book_, order_id, quantity);
+                return;
+            }
+        }
+        
+        // Execute against the touch; an empty side gets an add instead
+        mx_side_t side = random_side();
+        uint32_t touch = side == MX_SIDE_BUY ? mx_order_book_get_best_ask(book_)
+                                             : mx_order_book_get_best_bid(book_);
+        if (touch == 0) {
+            add(side == MX_SIDE_BUY ? MX_SIDE_SELL : MX_SIDE_BUY, 0, random_quantity(100));
+            return;
+        }
+        uint64_t aggressor_id = next_id_++;
+        uint32_t quantity = random_quantity(300);
+        emit(RECORD_EXECUTE, side, aggressor_id, touch, quantity);
+        mx_order_book_add_order(book_, aggressor_id, MX_ORDER_TYPE_LIMIT, side, touch, 0,
+                                quantity, 0, MX_TIF_IOC, 0, 0);
+    }
+
+public:
+    explicit WorkloadGenerator(const GeneratorOptions& options)
+        : options_(options)
+        , rng_(options.seed)
+        , next_id_(1) {
+        ctx_ = mx_context_new();
+        mx_context_set_callbacks(ctx_, nullptr, order_callback, this);
+        book_ = mx_order_book_new(ctx_, "REPLAY");
+    }
+    
+    ~WorkloadGenerator() {
+        mx_order_book_free(book_);
+        mx_context_free(ctx_);
+    }
+    
+    /**
+     * Build the workload: header followed by records, ready to be written
+     * out or replayed in place
+     */
+    std::vector<uint8_t> generate() {
+        records_.clear();
+        records_.reserve(static_cast<size_t>(options_.orders) +
+                         options_.depth * 2 * ORDERS_PER_LEVEL);
+        
+        for (uint32_t level = 0; level < options_.depth; ++level) {
+            for (uint32_t i = 0; i < ORDERS_PER_LEVEL; ++i) {
+                add(MX_SIDE_BUY, level, random_quantity(100));
+                add(MX_SIDE_SELL, level, random_quantity(100));
+            }
+        }
+        uint64_t warmup = records_.size();
+        
+        while (records_.size() < warmup + options_.orders) {
+            next_record();
+        }
+        
+        ReplayHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+        header.version = REPLAY_VERSION;
+        header.record_size = sizeof(ReplayRecord);
+        header.record_count = records_.size();
+        header.warmup_count = warmup;
+        header.min_price = level_price(MX_SIDE_BUY, max_level() - 1);
+        header.max_price = level_price(MX_SIDE_SELL, max_level() - 1);
+        header.tick_size = TICK_SIZE;
+        header.depth = options_.depth;
+        header.spread = options_.spread;
+        
+        std::vector<uint8_t> data(sizeof(header) + records_.size() * sizeof(ReplayRecord));
+        std::memcpy(data.data(), &header, sizeof(header));
+        std::memcpy(data.data() + sizeof(header), records_.data(),
+                    records_.size() * sizeof(ReplayRecord));
+        return data;
+    }
+};
+
+/* ============================================================================
+ * Workload Source
+ * A mapped workload file, or a buffer generated in memory
+ * ========================================================================= */
+
+class Workload {
+private:
+    const uint8_t* data_;
+    size_t size_;
+    std::vector<uint8_t> buffer_;
+#if defined(REPLAY_HAS_MMAP)
+    void* mapping_;
+#endif
+
+public:
+    Workload() : data_(nullptr), size_(0) {
+#if defined(REPLAY_HAS_MMAP)
+        mapping_ = nullptr;
+#endif
+    }
+    
+    ~Workload() {
+#if defined(REPLAY_HAS_MMAP)
+        if (mapping_) munmap(mapping_, size_);
+#endif
+    }
+    
+    Workload(const Workload&) = delete;
+    Workload& operator=(const Workload&) = delete;
+    
+    void adopt(std::vector<uint8_t> buffer) {
+        buffer_ = std::move(buffer);
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+    }
+    
+    bool open(const std::string& path) {
+#if defined(REPLAY_HAS_MMAP)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) return false;
+        mapping_ = mapping;
+        data_ = static_cast<const uint8_t*>(mapping);
+        size_ = static_cast<size_t>(info.st_size);
+        return true;
+#else
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        adopt(std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                                   std::istreambuf_iterator<char>()));
+        return true;
+#endif
+    }
+    
+    /**
+     * Check the header and that every record it announces is present
+     */
+    bool valid() const {
+        if (size_ < sizeof(ReplayHeader)) return false;
+        const ReplayHeader& h = header();
+        return std::memcmp(h.magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC)) == 0 &&
+               h.version == REPLAY_VERSION &&
+               h.record_size == sizeof(ReplayRecord) &&
+               h.warmup_count <= h.record_count &&
+               (size_ - sizeof(ReplayHeader)) / sizeof(ReplayRecord) >= h.record_count;
+    }
+    
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    
+    const ReplayHeader& header() const {
+        return *reinterpret_cast<const ReplayHeader*>(data_);
+    }
+    
+    const ReplayRecord* records() const {
+        return reinterpret_cast<const ReplayRecord*>(data_ + sizeof(ReplayHeader));
+    }
+};
+
+/* ============================================================================
+ * Replay
+ * ========================================================================= */
+
+struct ReplayResult {
+    std::string backend;
+    uint64_t records;
+    uint64_t rejected;              // Records that did not return MX_STATUS_OK
+    uint64_t trades;
+    double seconds;
+    double allocations_per_op;
+    mx_latency_stats_t latency[MX_LATENCY_OP_COUNT];
+};
+
+static const char* const LATENCY_OP_NAMES[MX_LATENCY_OP_COUNT] = {
+    "add", "cancel", "modify", "match"
+};
+
+class Replayer {
+private:
+    const Workload& workload_;
+    bool ladder_;
+    uint64_t trades_;
+    
+    static void trade_callback(void* user_data, uint64_t, uint64_t,
+                               uint32_t, uint32_t, uint64_t) {
+        static_cast<Replayer*>(user_data)->trades_++;
+    }
+    
+    static int apply(mx_order_book_t* book, const ReplayRecord& record) {
+        mx_side_t side = static_cast<mx_side_t>(record.side);
+        switch (record.type) {
+            case RECORD_ADD:
+                return mx_order_book_add_limit(book, record.order_id, side,
+                                               record.price, record.quantity);
+            case RECORD_CANCEL:
+                return mx_order_book_cancel(book, record.order_id);
+            case RECORD_MODIFY:
+                return mx_order_book_modify(book, record.order_id, record.quantity);
+            case RECORD_EXECUTE:
+                return mx_order_book_add_order(book, record.order_id, MX_ORDER_TYPE_LIMIT, side,
+                                               record.price, 0, record.quantity, 0,
+                                               MX_TIF_IOC, 0, 0);
+            default:
+                return MX_STATUS_INVALID_PARAM;
+        }
+    }
+    
+    mx_context_t* make_context(bool track_latency) {
+        const ReplayHeader& header = workload_.header();
+        mx_context_t* ctx = mx_context_new();
+        mx_context_set_callbacks(ctx, trade_callback, nullptr, this);
+        if (ladder_) {
+            mx_context_set_price_bounds(ctx, header.min_price, header.max_price, header.tick_size);
+        }
+        mx_context_set_latency_tracking(ctx, track_latency ? 1 : 0);
+        return ctx;
+    }
+    
+    /**
+     * Replay the warm-up records, then time the rest
+     */
+    void run_pass(bool track_latency, ReplayResult& result) {
+        const ReplayHeader& header = workload_.header();
+        const ReplayRecord* records = workload_.records();
+        
+        mx_context_t* ctx = make_context(track_latency);
+        mx_order_book_t* book = mx_order_book_new(ctx, "REPLAY");
+        
+        for (uint64_t i = 0; i < header.warmup_count; ++i) {
+            apply(book, records[i]);
+        }
+        if (track_latency) {
+            mx_order_book_reset_latency(book);
+        }
+        
+        trades_ = 0;
+        uint64_t rejected = 0;
+        uint64_t allocations = g_allocations;
+        auto start = Clock::now();
+        
+        for (uint64_t i = header.warmup_count; i < header.record_count; ++i) {
+            rejected += apply(book, records[i]) != MX_STATUS_OK;
+        }
+        
+        auto end = Clock::now();
+        
+        if (track_latency) {
+            for (uint32_t op = 0; op < MX_LATENCY_OP_COUNT; ++op) {
+                mx_order_book_get_latency(book, static_cast<mx_latency_op_t>(op), &result.latency[op]);
+            }
+        } else {
+            uint64_t measured = header.record_count - header.warmup_count;
+            result.records = measured;
+            result.rejected = rejected;
+            result.trades = trades_;
+            result.seconds = Duration(end - start).count();
+            result.allocations_per_op = measured
+                ? static_cast<double>(g_allocations - allocations) / static_cast<double>(measured)
+                : 0.0;
+        }
+        
+        mx_order_book_free(book);
+        mx_context_free(ctx);
+    }
+
+public:
+    Replayer(const Workload& workload, bool ladder)
+        : workload_(workload), ladder_(ladder), trades_(0) {}
+    
+    /**
+     * One untimed-per-op pass for throughput and allocations, then one
+     * with the library's latency histograms on for percentiles
+     */
+    ReplayResult run() {
+        ReplayResult result;
+        std::memset(result.latency, 0, sizeof(result.latency));
+        result.backend = ladder_ ? "ladder" : "map";
+        run_pass(false, result);
+        run_pass(true, result);
+        return result;
+    }
+};
+
+/* ============================================================================
+ * Reporting
+ * ========================================================================= */
+
+static void print_result(const ReplayResult& result) {
+    std::cout << "\nBackend: " << (result.backend == "ladder" ? "array ladder" : "std::map") << "\n";
+    std::cout << std::string(50, '-') << "\n";
+    std::cout << "  Time:         " << std::fixed << std::setprecision(4)
+              << result.seconds << " seconds\n";
+    std::cout << "  Ops/sec:      " << std::fixed << std::setprecision(0)
+              << (result.seconds > 0 ? result.records / result.seconds : 0.0) << "\n";
+    std::cout << "  Trades:       " << result.trades << "\n";
+    std::cout << "  Rejected:     " << result.rejected << "\n";
+    std::cout << "  Allocs/op:    " << std::fixed << std::setprecision(3)
+              << result.allocations_per_op << "\n";
+    std::cout << "  Latency (ns)       count     p50     p99   p99.9     max\n";
+    for (uint32_t op = 0; op < MX_LATENCY_OP_COUNT; ++op) {
+        const mx_latency_stats_t& stats = result.latency[op];
+        char line[128];
+        std::snprintf(line, sizeof(line), "    %-10s %11llu %7llu %7llu %7llu %7llu\n",
+                      LATENCY_OP_NAMES[op],
+                      static_cast<unsigned long long>(stats.count),
+                      static_cast<unsigned long long>(stats.p50_ns),
+                      static_cast<unsigned long long>(stats.p99_ns),
+                      static_cast<unsigned long long>(stats.p999_ns),
+                      static_cast<unsigned long long>(stats.max_ns));
+        std::cout << line;
+    }
+}
+
+static bool write_json(const std::string& path, const ReplayHeader& header,
+                       const std::vector<ReplayResult>& results) {
+    std::ofstream out(path);
+    if (!out) return false;
+    
+    out << std::fixed;
+    out << "{\n";
+    out << "  \"workload\": {\"records\": " << header.record_count - header.warmup_count
+        << ", \"warmup\": " << header.warmup_count
+        << ", \"depth\": " << header.depth
+        << ", \"spread\": " << header.spread << "},\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ReplayResult& result = results[i];
+        out << "    {\"backend\": \"" << result.backend << "\""
+            << ", \"seconds\": " << std::setprecision(6) << result.seconds
+            << ", \"ops_per_sec\": " << std::setprecision(0)
+            << (result.seconds > 0 ? result.records / result.seconds : 0.0)
+            << ", \"trades\": " << result.trades
+            << ", \"rejected\": " << result.rejected
+            << ", \"allocs_per_op\": " << std::setprecision(4) << result.allocations_per_op
+            << ",\n     \"latency_ns\": {";
+        for (uint32_t op = 0; op < MX_LATENCY_OP_COUNT; ++op) {
+            const mx_latency_stats_t& stats = result.latency[op];
+            out << (op ? ", " : "") << "\"" << LATENCY_OP_NAMES[op] << "\": {"
+                << "\"count\": " << stats.count
+                << ", \"p50\": " << stats.p50_ns
+                << ", \"p99\": " << stats.p99_ns
+                << ", \"p999\": " << stats.p999_ns
+                << ", \"max\": " << stats.max_ns << "}";
+        }
+        out << "}}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+/* ============================================================================
+ * Main
+ * ========================================================================= */
+
+static void usage() {
+    std::cout << "Usage: ReplayBenchmark [--generate FILE | --replay FILE] [--orders N]\n"
+                 "                       [--depth N] [--spread N] [--seed N]\n"
+                 "                       [--backend map|ladder|both] [--json FILE]\n";
+}
+
+int main(int argc, char** argv) {
+    GeneratorOptions options;
+    std::string generate_path;
+    std::string replay_path;
+    std::string json_path;
+    std::string backend = "both";
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (arg == "--help" || arg == "-h") {
+            usage();
+            return 0;
+        }
+        if (!value) {
+            usage();
+            return 1;
+        }
+        ++i;
+        if (arg == "--generate") generate_path = value;
+        else if (arg == "--replay") replay_path = value;
+        else if (arg == "--json") json_path = value;
+        else if (arg == "--backend") backend = value;
+        else if (arg == "--orders") options.orders = std::strtoull(value, nullptr, 10);
+        else if (arg == "--depth") options.depth = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--spread") options.spread = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--seed") options.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (options.depth == 0 || options.spread == 0 ||
+        (backend != "map" && backend != "ladder" && backend != "both")) {
+        usage();
+        return 1;
+    }
+    
+    // Before any other mx_ call, as mx_set_allocators requires
+    mx_set_allocators(counting_malloc, counting_realloc, std::free);
+    
+    std::cout << "MatchX Matching Engine - Replay Benchmark\n";
+    std::cout << "=========================================\n";
+    
+    Workload workload;
+    if (replay_path.empty()) {
+        WorkloadGenerator generator(options);
+        workload.adopt(generator.generate());
+    } else if (!workload.open(replay_path)) {
+        std::cerr << "Cannot open workload " << replay_path << "\n";
+        return 1;
+    }
+    if (!workload.valid()) {
+        std::cerr << "Not a valid workload file\n";
+        return 1;
+    }
+    
+    const ReplayHeader& header = workload.header();
+    if (!generate_path.empty()) {
+        std::ofstream out(generate_path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(workload.data()),
+                  static_cast<std::streamsize>(workload.size()));
+        if (!out) {
+            std::cerr << "Cannot write " << generate_path << "\n";
+            return 1;
+        }
+        std::cout << "Wrote " << header.record_count << " records to " << generate_path << "\n";
+        return 0;
+    }
+    
+    std::cout << "  Records:      " << header.record_count - header.warmup_count
+              << " (+" << header.warmup_count << " warm-up)\n";
+    std::cout << "  Book:         " << header.depth << " levels per side, "
+              << header.spread << " tick(s) apart\n";
+    
+    std::vector<ReplayResult> results;
+    if (backend != "ladder") {
+        results.push_back(Replayer(workload, false).run());
+        print_result(results.back());
+    }
+    if (backend != "map") {
+        results.push_back(Replayer(workload, true).run());
+        print_result(results.back());
+    }
+    
+    if (!json_path.empty() && !write_json(json_path, header, results)) {
+        std::cerr << "Cannot write " << json_path << "\n";
+        return 1;
+    }
+    
+    std::cout << "\n✓ Replay complete!\n\n";
+    return 0;
+}
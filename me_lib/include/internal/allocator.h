@@ -7,6 +7,7 @@
 #define MX_INTERNAL_ALLOCATOR_H
 
 #include "common.h"
+#include <cstdlib>
 
 namespace matchx {
 
@@ -65,6 +66,12 @@ inline void mx_free(void* ptr) {
 }
 
 inline void* mx_calloc(size_t count, size_t size) {
+    // The C library's calloc skips the memset for freshly mapped memory,
+    // so large zeroed arrays are only paged in as they are touched
+    if (g_allocators.malloc_fn == std::malloc && g_allocators.free_fn == std::free) {
+        return std::calloc(count, size);
+    }
+    
     size_t total = count * size;
     void* ptr = mx_malloc(total);
     if (ptr) {
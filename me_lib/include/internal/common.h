@@ -11,6 +11,10 @@
 #include <cstring>
 #include <cassert>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 /* Include public API for types */
 #include "matchengine.h"
 
@@ -91,11 +95,41 @@ char* mx_strdup(const char* str);
 #define MX_CLEAR_BIT(flags, bit) ((flags) &= ~(bit))
 #define MX_HAS_BIT(flags, bit) (((flags) & (bit)) != 0)
 
+/* Bit scans (x must be non-zero) */
+MX_FORCE_INLINE uint32_t mx_ctz64(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(x));
+#endif
+}
+
+MX_FORCE_INLINE uint32_t mx_msb64(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return static_cast<uint32_t>(index);
+#else
+    return 63u - static_cast<uint32_t>(__builtin_clzll(x));
+#endif
+}
+
+MX_FORCE_INLINE uint32_t mx_popcount64(uint64_t x) {
+#if defined(_MSC_VER)
+    return static_cast<uint32_t>(__popcnt64(x));
+#else
+    return static_cast<uint32_t>(__builtin_popcountll(x));
+#endif
+}
+
 /* ============================================================================
  * Type Aliases for Convenience
  * ========================================================================= */
 
 using OrderId = uint64_t;
+using OwnerId = uint64_t;
 using Price = uint32_t;
 using Quantity = uint32_t;
 using Timestamp = uint64_t;
@@ -107,6 +141,7 @@ using TimeInForce = mx_time_in_force_t;
 constexpr Price INVALID_PRICE = 0;
 constexpr Quantity INVALID_QUANTITY = 0;
 constexpr OrderId INVALID_ORDER_ID = 0;
+constexpr OwnerId NO_OWNER = 0;
 
 /* ============================================================================
  * Debug Macros
@@ -1,6 +1,6 @@
 /**
  * Context - global state container
- * Holds callbacks, configuration, and timestamp
+ * Holds callbacks, configuration, timestamp and the optional memory arena
  * No global state - everything goes through context!
  */
 
@@ -9,6 +9,9 @@
 
 #include "common.h"
 #include "types.h"
+#include "utils/arena.h"
+#include "core/latency_histogram.h"
+#include "core/trace_ring.h"
 #include <ctime>
 
 namespace matchx {
@@ -27,9 +30,30 @@ private:
     // Configuration
     OrderBookConfig config_;
     
-    // Timing
+    // Timing - current_timestamp_ is the last reading of clock_
     Timestamp current_timestamp_;
-    bool use_system_time_;
+    mx_clock_source_t clock_;
+    
+    // Backing store for books when config_.arena_flags is set
+    Arena arena_;
+    
+    // Trace records from MX_TRACE_POINT (empty unless built with MX_TRACE)
+    TraceRing trace_;
+    
+    // Cycle counter calibration (0 until latency tracking or the TSC
+    // clock first needs it)
+    double ns_per_tick_;
+    
+    // MX_CLOCK_TSC: counter values paired with system time when the clock
+    // was selected (origin) and at the last resync (base). Each resync
+    // re-measures the rate over the whole span since the origin, so the
+    // short calibration's error stops accumulating after the first one
+    uint64_t tsc_origin_;
+    Timestamp tsc_origin_ns_;
+    uint64_t tsc_base_;
+    Timestamp tsc_base_ns_;
+    double tsc_ns_per_tick_;
+    uint64_t tsc_resync_ticks_;     // About one second of ticks
     
     MX_IMPLEMENTS_ALLOCATORS
 
@@ -42,7 +66,16 @@ public:
         : callbacks_()
         , config_()
         , current_timestamp_(0)
-        , use_system_time_(true) {
+        , clock_(MX_CLOCK_COARSE)
+        , arena_()
+        , trace_()
+        , ns_per_tick_(0.0)
+        , tsc_origin_(0)
+        , tsc_origin_ns_(0)
+        , tsc_base_(0)
+        , tsc_base_ns_(0)
+        , tsc_ns_per_tick_(0.0)
+        , tsc_resync_ticks_(0) {
         
         // Initialize with system time
         update_timestamp();
@@ -91,11 +124,46 @@ public:
         config_.tick_size = tick_size;
     }
     
-    void set_capacity_hints(uint32_t max_orders, uint32_t price_levels) {
+    void set_capacity_hints(uint32_t max_orders, uint32_t price_levels,
+                            uint32_t arena_flags = MX_ARENA_NONE) {
         config_.expected_max_orders = max_orders;
         config_.expected_price_levels = price_levels;
+        config_.arena_flags = arena_flags;
+        if (arena_flags != MX_ARENA_NONE) {
+            arena_.set_flags(arena_flags | MX_ARENA_ENABLE);
+        }
     }
     
+    /**
+     * Arena for new books, or nullptr if books use mx_malloc
+     */
+    Arena* arena() {
+        return config_.arena_flags != MX_ARENA_NONE ? &arena_ : nullptr;
+    }
+    
+    const Arena& arena_state() const { return arena_; }
+    
+    void set_event_buffer(uint32_t capacity) {
+        config_.event_buffer_capacity = capacity;
+    }
+    
+    void set_latency_tracking(bool enable) {
+        config_.track_latency = enable;
+        if (enable && ns_per_tick_ == 0.0) {
+            ns_per_tick_ = calibrate_cycle_counter();
+        }
+    }
+    
+    void set_book_view(bool enable, uint32_t levels) {
+        config_.publish_view = enable;
+        config_.view_levels = levels;
+    }
+    
+    /**
+     * Nanoseconds per LatencyHistogram tick
+     */
+    double ns_per_tick() const { return ns_per_tick_; }
+    
     void enable_stop_orders(bool enable) {
         config_.enable_stop_orders = enable;
     }
@@ -124,45 +192,120 @@ public:
      */
     void set_timestamp(Timestamp timestamp) {
         current_timestamp_ = timestamp;
-        use_system_time_ = false;
+        clock_ = MX_CLOCK_MANUAL;
     }
     
     /**
-     * Enable automatic system time updates
+     * Switch time source; false (and no change) if the TSC cannot keep time
      */
-    void use_system_time(bool enable) {
-        use_system_time_ = enable;
-        if (enable) {
-            update_timestamp();
+    bool set_clock(mx_clock_source_t source) {
+        if (source == MX_CLOCK_TSC) {
+            if (!has_invariant_cycle_counter()) return false;
+            if (ns_per_tick_ == 0.0) {
+                ns_per_tick_ = calibrate_cycle_counter();
+            }
+            tsc_ns_per_tick_ = ns_per_tick_;
+            tsc_resync_ticks_ = static_cast<uint64_t>(1e9 / tsc_ns_per_tick_);
+            tsc_origin_ = tsc_base_ = read_cycle_counter();
+            tsc_origin_ns_ = tsc_base_ns_ = get_system_timestamp();
         }
+        clock_ = source;
+        update_timestamp();
+        return true;
     }
     
+    mx_clock_source_t clock() const { return clock_; }
+    
     /**
-     * Update timestamp to current system time
+     * Start of a book call: only the per-call sources are read
      */
-    void update_timestamp() {
-        if (use_system_time_) {
+    MX_FORCE_INLINE void tick() {
+        if (clock_ == MX_CLOCK_TSC) {
+            current_timestamp_ = get_tsc_timestamp();
+        } else if (clock_ == MX_CLOCK_SYSTEM) {
             current_timestamp_ = get_system_timestamp();
         }
     }
     
+    /**
+     * Read the clock now (start of a batch, or on request); the coarse
+     * clock refreshes from the system clock here and nowhere else
+     */
+    void update_timestamp() {
+        switch (clock_) {
+            case MX_CLOCK_TSC:
+                current_timestamp_ = get_tsc_timestamp();
+                break;
+            case MX_CLOCK_MANUAL:
+                break;
+            default:
+                current_timestamp_ = get_system_timestamp();
+                break;
+        }
+    }
+    
+    /* ========================================================================
+     * Tracing
+     * ===================================================================== */
+    
+    TraceRing& trace_ring() { return trace_; }
+    const TraceRing& trace_ring() const { return trace_; }
+    
+    /**
+     * Record a trace point (reached through MX_TRACE_POINT only)
+     */
+    MX_FORCE_INLINE void trace(mx_trace_point_t point, OrderId order_id, Side side,
+                               Price price, Quantity quantity, uint32_t count) {
+        if (trace_.enabled()) {
+            trace_.push(static_cast<uint16_t>(point), order_id, side, price, quantity,
+                        count, current_timestamp_);
+        }
+    }
+    
     /* ========================================================================
      * Statistics
      * ===================================================================== */
     
     /**
      * Get memory usage across all contexts (would need global tracking)
+     * Only arena-backed storage is counted
      */
     size_t get_memory_usage() const {
-        // This is a placeholder - actual implementation would track allocations
-        return 0;
+        return arena_.reserved_bytes();
     }
-    
+
 private:
     /* ========================================================================
      * Internal Helpers
      * ===================================================================== */
     
+    /**
+     * Cycle counter scaled onto the system clock's nanoseconds
+     * (signed delta, so a core whose counter trails the base by a few
+     * ticks does not wrap)
+     */
+    MX_FORCE_INLINE Timestamp get_tsc_timestamp() {
+        uint64_t ticks = read_cycle_counter();
+        if (MX_UNLIKELY(ticks - tsc_base_ >= tsc_resync_ticks_)) {
+            resync_tsc(ticks);
+        }
+        int64_t delta = static_cast<int64_t>(ticks - tsc_base_);
+        return tsc_base_ns_ + static_cast<Timestamp>(static_cast<int64_t>(static_cast<double>(delta) * tsc_ns_per_tick_));
+    }
+    
+    /**
+     * Re-measure the rate since the origin and re-anchor on the system
+     * clock (one clock_gettime a second)
+     */
+    void resync_tsc(uint64_t ticks) {
+        Timestamp now = get_system_timestamp();
+        if (ticks > tsc_origin_ && now > tsc_origin_ns_) {
+            tsc_ns_per_tick_ = static_cast<double>(now - tsc_origin_ns_) / static_cast<double>(ticks - tsc_origin_);
+        }
+        tsc_base_ = ticks;
+        tsc_base_ns_ = now;
+    }
+    
     /**
      * Get high-resolution system timestamp in nanoseconds
      */
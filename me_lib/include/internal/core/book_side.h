@@ -0,0 +1,321 @@
+/**
+ * BookSide - price-sorted collection of PriceLevels for one side of a book
+ * Uses the tick-indexed PriceLadder when the context has price bounds,
+ * otherwise falls back to a std::map keyed on price
+ */
+
+#ifndef MX_INTERNAL_CORE_BOOK_SIDE_H
+#define MX_INTERNAL_CORE_BOOK_SIDE_H
+
+#include "../common.h"
+#include "../types.h"
+#include "../utils/memory_pool.h"
+#include "price_level.h"
+#include "price_ladder.h"
+#include <functional>
+#include <map>
+#include <type_traits>
+
+namespace matchx {
+
+/* ============================================================================
+ * BookSide Class
+ * Bids are ordered highest first, asks lowest first
+ * ========================================================================= */
+
+template<Side S>
+class BookSide {
+public:
+    static constexpr bool IS_BID = (S == MX_SIDE_BUY);
+
+private:
+    using Compare = typename std::conditional<IS_BID, std::greater<Price>, std::less<Price>>::type;
+    using LevelMap = std::map<Price, PriceLevel, Compare,
+                              ProxyAllocator<std::pair<const Price, PriceLevel>>>;
+    
+    LevelMap map_;              // Unbounded fallback
+    PriceLadder ladder_;        // Bounded fast path
+    uint32_t best_index_;       // Ladder index of the best level (NPOS if empty)
+    uint32_t level_count_;      // Occupied ladder levels
+    
+    MX_IMPLEMENTS_ALLOCATORS
+
+public:
+    /* ========================================================================
+     * Constructors
+     * ===================================================================== */
+    
+    BookSide()
+        : map_()
+        , ladder_()
+        , best_index_(PriceLadder::NPOS)
+        , level_count_(0) {}
+    
+    // Non-copyable
+    BookSide(const BookSide&) = delete;
+    BookSide& operator=(const BookSide&) = delete;
+    
+    /**
+     * Switch to ladder storage for a bounded band (from arena if given)
+     * Must be called while the side is empty. Returns false if the
+     * ladder could not be allocated (the map fallback stays in use)
+     */
+    bool init_ladder(Price min_price, Price max_price, Price tick_size, Arena* arena = nullptr) {
+        MX_ASSERT(empty());
+        return ladder_.init(min_price, max_price, tick_size, arena);
+    }
+    
+    /**
+     * Drop ladder storage and fall back to the map (side must be empty)
+     */
+    void release_ladder() {
+        MX_ASSERT(empty());
+        ladder_.release();
+    }
+    
+    /* ========================================================================
+     * Getters
+     * ===================================================================== */
+    
+    bool uses_ladder() const { return ladder_.enabled(); }
+    const PriceLadder& ladder() const { return ladder_; }
+    
+    uint32_t size() const {
+        return uses_ladder() ? level_count_ : static_cast<uint32_t>(map_.size());
+    }
+    
+    bool empty() const { return size() == 0; }
+    
+    /**
+     * Whether a resting order at this price can be stored on this side
+     */
+    bool accepts_price(Price price) const {
+        return !uses_ladder() || ladder_.contains(price);
+    }
+    
+    /**
+     * True if price a is strictly better than price b for this side
+     */
+    static bool is_better(Price a, Price b) {
+        return IS_BID ? (a > b) : (a < b);
+    }
+    
+    /* ========================================================================
+     * Level Access
+     * ===================================================================== */
+    
+    /**
+     * Best (most aggressive) level, or nullptr if the side is empty
+     */
+    MX_FORCE_INLINE PriceLevel* best() const {
+        if (MX_LIKELY(uses_ladder())) {
+            return (best_index_ != PriceLadder::NPOS) ? ladder_.level_at(best_index_) : nullptr;
+        }
+        return map_.empty() ? nullptr : const_cast<PriceLevel*>(&map_.begin()->second);
+    }
+    
+    Price best_price() const {
+        const PriceLevel* level = best();
+        return level ? level->price() : 0;
+    }
+    
+    /**
+     * Find an existing (non-empty) level
+     */
+    PriceLevel* find(Price price) const {
+        if (MX_LIKELY(uses_ladder())) {
+            if (!ladder_.contains(price)) return nullptr;
+            uint32_t index = ladder_.index_of(price);
+            return ladder_.test(index) ? ladder_.level_at(index) : nullptr;
+        }
+        auto it = map_.find(price);
+        return (it != map_.end()) ? const_cast<PriceLevel*>(&it->second) : nullptr;
+    }
+    
+    /**
+     * Find a level, creating it if needed
+     * Price must satisfy accepts_price()
+     */
+    PriceLevel* find_or_create(Price price) {
+        if (MX_LIKELY(uses_ladder())) {
+            uint32_t index = ladder_.index_of(price);
+            if (ladder_.test(index)) {
+                return ladder_.level_at(index);
+            }
+            ++level_count_;
+            if (best_index_ == PriceLadder::NPOS ||
+                (IS_BID ? index > best_index_ : index < best_index_)) {
+                best_index_ = index;
+            }
+            return ladder_.occupy(index);
+        }
+        
+        auto it = map_.find(price);
+        if (it != map_.end()) {
+            return &it->second;
+        }
+        auto result = map_.emplace(price, PriceLevel(price));
+        return &result.first->second;
+    }
+    
+    /**
+     * Remove an empty level
+     */
+    void erase(PriceLevel* level) {
+        MX_ASSERT(level != nullptr && level->empty());
+        
+        if (MX_LIKELY(uses_ladder())) {
+            uint32_t index = ladder_.index_of(level->price());
+            MX_ASSERT(ladder_.test(index));
+            ladder_.reset(index);
+            --level_count_;
+            if (index == best_index_) {
+                best_index_ = next_worse_index(index);
+            }
+            return;
+        }
+        
+        map_.erase(level->price());
+    }
+    
+    /* ========================================================================
+     * Volume
+     * The book reports each change in resting volume here as well as to its
+     * DepthCache; on the ladder it feeds the per-tick volume vector
+     * ===================================================================== */
+    
+    MX_FORCE_INLINE void add_volume(Price price, Quantity quantity) {
+        if (MX_LIKELY(uses_ladder())) {
+            ladder_.add_volume(ladder_.index_of(price), quantity);
+        }
+    }
+    
+    MX_FORCE_INLINE void remove_volume(Price price, Quantity quantity) {
+        if (MX_LIKELY(uses_ladder())) {
+            ladder_.remove_volume(ladder_.index_of(price), quantity);
+        }
+    }
+    
+    /**
+     * Volume of every level on the side
+     */
+    uint64_t total_volume() const {
+        if (uses_ladder()) {
+            if (best_index_ == PriceLadder::NPOS) return 0;
+            uint32_t worst = IS_BID ? ladder_.find_lowest() : ladder_.find_highest();
+            return IS_BID ? ladder_.sum_volume(worst, best_index_)
+                          : ladder_.sum_volume(best_index_, worst);
+        }
+        
+        uint64_t volume = 0;
+        for (const auto& pair : map_) {
+            volume += pair.second.total_volume();
+        }
+        return volume;
+    }
+    
+    /**
+     * Volume of the best num_levels levels
+     */
+    uint64_t depth_volume(uint32_t num_levels) const {
+        if (num_levels == 0) return 0;
+        
+        if (uses_ladder()) {
+            if (best_index_ == PriceLadder::NPOS) return 0;
+            uint32_t last = IS_BID ? ladder_.select_down(best_index_, num_levels)
+                                   : ladder_.select_up(best_index_, num_levels);
+            if (last == PriceLadder::NPOS) return total_volume();
+            return IS_BID ? ladder_.sum_volume(last, best_index_)
+                          : ladder_.sum_volume(best_index_, last);
+        }
+        
+        uint64_t volume = 0;
+        uint32_t count = 0;
+        for (const auto& pair : map_) {
+            if (count++ >= num_levels) break;
+            volume += pair.second.total_volume();
+        }
+        return volume;
+    }
+    
+    /**
+     * Volume resting from the best level through limit (inclusive), summed
+     * best first and stopping as soon as it reaches threshold
+     */
+    uint64_t volume_through(Price limit, uint64_t threshold) const {
+        uint64_t cumulative = 0;
+        
+        if (uses_ladder()) {
+            if (best_index_ == PriceLadder::NPOS) return 0;
+            const Quantity* volumes = ladder_.volumes();
+            if (IS_BID) {
+                if (limit > ladder_.max_price()) return 0;
+                uint32_t first = ladder_.ceil_index(limit);
+                if (first > best_index_) return 0;
+                ladder_.kernels().scan_down(volumes + first, best_index_ - first + 1,
+                                            threshold, cumulative);
+            } else {
+                if (limit < ladder_.min_price()) return 0;
+                uint32_t last = ladder_.floor_index(limit);
+                if (last < best_index_) return 0;
+                ladder_.kernels().scan_up(volumes + best_index_, last - best_index_ + 1,
+                                          threshold, cumulative);
+            }
+            return cumulative;
+        }
+        
+        for (const auto& pair : map_) {
+            if (is_better(limit, pair.first)) break;
+            cumulative += pair.second.total_volume();
+            if (cumulative >= threshold) break;
+        }
+        return cumulative;
+    }
+    
+    /* ========================================================================
+     * Iteration
+     * ===================================================================== */
+    
+    /**
+     * Visit levels from best to worst
+     * func(const PriceLevel&) returns false to stop early
+     */
+    template<typename Func>
+    void for_each_level(Func func) const {
+        if (uses_ladder()) {
+            for (uint32_t index = best_index_; index != PriceLadder::NPOS;
+                 index = next_worse_index(index)) {
+                if (!func(static_cast<const PriceLevel&>(*ladder_.level_at(index)))) {
+                    return;
+                }
+            }
+            return;
+        }
+        
+        for (const auto& pair : map_) {
+            if (!func(pair.second)) {
+                return;
+            }
+        }
+    }
+    
+    /* ========================================================================
+     * Administrative
+     * ===================================================================== */
+    
+    void clear() {
+        map_.clear();
+        ladder_.clear();
+        best_index_ = PriceLadder::NPOS;
+        level_count_ = 0;
+    }
+
+private:
+    uint32_t next_worse_index(uint32_t index) const {
+        return IS_BID ? ladder_.find_next_below(index) : ladder_.find_next_above(index);
+    }
+};
+
+} // namespace matchx
+
+#endif // MX_INTERNAL_CORE_BOOK_SIDE_H
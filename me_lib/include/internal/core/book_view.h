@@ -0,0 +1,134 @@
+/**
+ * BookView - seqlock-published summary of a book for other threads
+ * The book's own thread is the only writer; risk and market data threads
+ * copy the latest summary without locks and without making it wait
+ */
+
+#ifndef MX_INTERNAL_CORE_BOOK_VIEW_H
+#define MX_INTERNAL_CORE_BOOK_VIEW_H
+
+#include "../common.h"
+#include "../types.h"
+#include "../allocator.h"
+#include <atomic>
+#include <cstring>
+#include <new>
+
+namespace matchx {
+
+/* ============================================================================
+ * BookView Class
+ * Two seqlocked slots of mx_book_view_t. Each publish fills the slot that
+ * is not the newest (its sequence is odd meanwhile), then makes it the
+ * newest, so readers copying the newest slot are only disturbed when two
+ * publishes land during one copy - the writer never spins on readers.
+ *
+ * The counter and each slot sit on their own cache lines, so polling
+ * readers do not contend with the slot being written
+ * ========================================================================= */
+
+class BookView {
+private:
+    struct MX_CACHE_ALIGNED Slot {
+        std::atomic<uint64_t> sequence;     // Odd while the writer fills it
+        mx_book_view_t view;
+    };
+
+    MX_CACHE_ALIGNED std::atomic<uint64_t> published_;  // Publishes so far; newest slot is published_ & 1
+    Slot slots_[2];
+    uint32_t levels_;                                   // Levels per side to publish
+    void* block_;                                       // Unaligned allocation
+
+    explicit BookView(uint32_t levels, void* block)
+        : published_(0)
+        , levels_(levels)
+        , block_(block) {
+        for (Slot& slot : slots_) {
+            slot.sequence.store(0, std::memory_order_relaxed);
+            std::memset(&slot.view, 0, sizeof(slot.view));
+        }
+    }
+
+    ~BookView() = default;
+
+public:
+    // Non-copyable
+    BookView(const BookView&) = delete;
+    BookView& operator=(const BookView&) = delete;
+
+    /* ========================================================================
+     * Lifetime
+     * mx_malloc makes no alignment promise, so the view is placed on a
+     * cache line inside a slightly larger block
+     * ===================================================================== */
+
+    /**
+     * Returns nullptr on allocation failure
+     */
+    static BookView* create(uint32_t levels) {
+        void* block = mx_malloc(sizeof(BookView) + MX_CACHE_LINE_SIZE);
+        if (!block) return nullptr;
+
+        uintptr_t base = reinterpret_cast<uintptr_t>(block);
+        base = (base + MX_CACHE_LINE_SIZE - 1) & ~static_cast<uintptr_t>(MX_CACHE_LINE_SIZE - 1);
+        return new (reinterpret_cast<void*>(base)) BookView(MX_MIN(levels, static_cast<uint32_t>(MX_BOOK_VIEW_LEVELS)), block);
+    }
+
+    static void destroy(BookView* view) {
+        if (!view) return;
+        void* block = view->block_;
+        view->~BookView();
+        mx_free(block);
+    }
+
+    uint32_t levels() const { return levels_; }
+
+    /* ========================================================================
+     * Writer (the book's thread only)
+     * ===================================================================== */
+
+    /**
+     * Open the spare slot for writing; every field must be filled before
+     * end_write() since the slot still holds the view from two publishes ago
+     */
+    mx_book_view_t& begin_write() {
+        uint64_t next = published_.load(std::memory_order_relaxed) + 1;
+        Slot& slot = slots_[next & 1];
+        uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.view.sequence = next;
+        return slot.view;
+    }
+
+    void end_write() {
+        uint64_t next = published_.load(std::memory_order_relaxed) + 1;
+        Slot& slot = slots_[next & 1];
+        slot.sequence.store(slot.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        published_.store(next, std::memory_order_release);
+    }
+
+    /* ========================================================================
+     * Readers (any thread)
+     * ===================================================================== */
+
+    uint64_t sequence() const {
+        return published_.load(std::memory_order_acquire);
+    }
+
+    void read(mx_book_view_t& out) const {
+        for (;;) {
+            const Slot& slot = slots_[published_.load(std::memory_order_acquire) & 1];
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (MX_UNLIKELY(sequence & 1)) continue;    // Lapped - the writer is refilling it
+
+            std::memcpy(&out, &slot.view, sizeof(out));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (MX_LIKELY(slot.sequence.load(std::memory_order_relaxed) == sequence)) return;
+        }
+    }
+};
+
+} // namespace matchx
+
+#endif // MX_INTERNAL_CORE_BOOK_VIEW_H
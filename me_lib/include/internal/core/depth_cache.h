@@ -0,0 +1,160 @@
+/**
+ * DepthCache - running volume total and top-of-book level cache for one
+ * side of a book
+ * Quoting logic polls the top few levels far more often than they change,
+ * so the book keeps them as ready-made mx_level_t records and only walks
+ * its levels again after a change that could affect them
+ */
+
+#ifndef MX_INTERNAL_CORE_DEPTH_CACHE_H
+#define MX_INTERNAL_CORE_DEPTH_CACHE_H
+
+#include "../common.h"
+#include "../types.h"
+#include "book_side.h"
+#include <cstring>
+
+namespace matchx {
+
+/* ============================================================================
+ * DepthCache Class
+ * The book reports every volume change on its side (add / remove) and the
+ * price it happened at. A change strictly worse than the last cached level
+ * of a full cache cannot move the top CAPACITY levels, so it leaves the
+ * cache valid; anything else marks it for a rebuild on the next query.
+ *
+ * Queries are const but refill the cache, which is no more thread-safe
+ * than the rest of the book
+ * ========================================================================= */
+
+class DepthCache {
+public:
+    static constexpr uint32_t CAPACITY = 16;
+
+private:
+    bool is_bid_;
+    uint64_t total_volume_;                 // Every resting order on the side
+    
+    mutable mx_level_t levels_[CAPACITY];   // Best first
+    mutable uint32_t count_;
+    mutable bool dirty_;
+
+public:
+    /* ========================================================================
+     * Constructors
+     * ===================================================================== */
+    
+    explicit DepthCache(Side side)
+        : is_bid_(side == MX_SIDE_BUY)
+        , total_volume_(0)
+        , count_(0)
+        , dirty_(true) {}
+    
+    // Non-copyable
+    DepthCache(const DepthCache&) = delete;
+    DepthCache& operator=(const DepthCache&) = delete;
+    
+    /* ========================================================================
+     * Updates
+     * ===================================================================== */
+    
+    uint64_t total_volume() const { return total_volume_; }
+    
+    void add(Price price, Quantity quantity) {
+        total_volume_ += quantity;
+        touch(price);
+    }
+    
+    void remove(Price price, Quantity quantity) {
+        MX_ASSERT(total_volume_ >= quantity);
+        total_volume_ -= quantity;
+        touch(price);
+    }
+    
+    /**
+     * Note a change at price that moved no volume (visible quantity,
+     * queue order)
+     */
+    void touch(Price price) {
+        if (dirty_) return;
+        if (count_ < CAPACITY || !is_worse(price, levels_[count_ - 1].price)) {
+            dirty_ = true;
+        }
+    }
+    
+    /**
+     * Recount the side from scratch (after clear or snapshot restore)
+     */
+    template<Side S>
+    void reset(const BookSide<S>& side) {
+        total_volume_ = side.total_volume();
+        dirty_ = true;
+    }
+    
+    /* ========================================================================
+     * Queries
+     * ===================================================================== */
+    
+    /**
+     * Copy up to max_levels levels of side into out, best first
+     * Returns the number written
+     */
+    template<Side S>
+    uint32_t copy(const BookSide<S>& side, uint32_t max_levels, mx_level_t* out) const {
+        if (max_levels > CAPACITY) {
+            return fill(side, max_levels, out);
+        }
+        refresh(side);
+        uint32_t count = MX_MIN(max_levels, count_);
+        std::memcpy(out, levels_, count * sizeof(mx_level_t));
+        return count;
+    }
+    
+    /**
+     * Total volume of the best num_levels levels of side
+     */
+    template<Side S>
+    uint64_t depth(const BookSide<S>& side, uint32_t num_levels) const {
+        if (num_levels > CAPACITY) {
+            return side.depth_volume(num_levels);
+        }
+        refresh(side);
+        uint64_t volume = 0;
+        uint32_t count = MX_MIN(num_levels, count_);
+        for (uint32_t i = 0; i < count; ++i) {
+            volume += levels_[i].volume;
+        }
+        return volume;
+    }
+
+private:
+    bool is_worse(Price a, Price b) const {
+        return is_bid_ ? (a < b) : (a > b);
+    }
+    
+    template<Side S>
+    void refresh(const BookSide<S>& side) const {
+        if (!dirty_) return;
+        count_ = fill(side, CAPACITY, levels_);
+        dirty_ = false;
+    }
+    
+    template<Side S>
+    static uint32_t fill(const BookSide<S>& side, uint32_t max_levels, mx_level_t* out) {
+        uint32_t count = 0;
+        side.for_each_level([&](const PriceLevel& level) {
+            if (count >= max_levels) return false;
+            mx_level_t& record = out[count++];
+            record.price = level.price();
+            record.volume = level.total_volume();
+            record.visible_volume = level.visible_volume();
+            record.order_count = level.order_count();
+            return true;
+        });
+        return count;
+    }
+};
+
+} // namespace matchx
+
+#endif // MX_INTERNAL_CORE_DEPTH_CACHE_H
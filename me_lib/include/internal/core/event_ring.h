@@ -0,0 +1,175 @@
+/**
+ * EventRing - per-book buffer of trade and order-event records
+ * Used instead of callbacks when the context enables event buffering,
+ * so matching only appends PODs and consumers drain them in bulk
+ */
+
+#ifndef MX_INTERNAL_CORE_EVENT_RING_H
+#define MX_INTERNAL_CORE_EVENT_RING_H
+
+#include "../common.h"
+#include "../types.h"
+#include "../allocator.h"
+
+namespace matchx {
+
+/* ============================================================================
+ * EventRing Class
+ * Power-of-two ring of mx_event_t indexed by free-running head/tail counters
+ *
+ * The ring is preallocated at the configured capacity and doubles if a
+ * burst outruns the consumer, so events are never dropped while memory
+ * lasts (the book is single-threaded, so growth needs no coordination)
+ * ========================================================================= */
+
+class EventRing {
+private:
+    mx_event_t* events_;
+    uint32_t mask_;             // capacity - 1
+    uint32_t head_;             // Next slot to read
+    uint32_t tail_;             // Next slot to write
+    
+    MX_IMPLEMENTS_ALLOCATORS
+
+public:
+    /* ========================================================================
+     * Constructors
+     * ===================================================================== */
+    
+    EventRing() : events_(nullptr), mask_(0), head_(0), tail_(0) {}
+    
+    ~EventRing() {
+        mx_free(events_);
+    }
+    
+    // Non-copyable
+    EventRing(const EventRing&) = delete;
+    EventRing& operator=(const EventRing&) = delete;
+    
+    /**
+     * Allocate room for at least capacity events
+     * Returns false (and stays disabled) on allocation failure
+     */
+    bool init(uint32_t capacity) {
+        uint32_t size = 16;
+        while (size < capacity && size < (1u << 31)) size <<= 1;
+        
+        mx_event_t* events = static_cast<mx_event_t*>(mx_malloc(sizeof(mx_event_t) * size));
+        if (!events) return false;
+        
+        mx_free(events_);
+        events_ = events;
+        mask_ = size - 1;
+        head_ = 0;
+        tail_ = 0;
+        return true;
+    }
+    
+    /* ========================================================================
+     * Getters
+     * ===================================================================== */
+    
+    bool enabled() const { return events_ != nullptr; }
+    uint32_t size() const { return tail_ - head_; }
+    uint32_t capacity() const { return events_ ? mask_ + 1 : 0; }
+    bool empty() const { return head_ == tail_; }
+    
+    /* ========================================================================
+     * Producer
+     * ===================================================================== */
+    
+    MX_FORCE_INLINE void push_trade(OrderId aggressive_id, OrderId passive_id,
+                                    Price price, Quantity quantity, Timestamp timestamp) {
+        mx_event_t* event = claim();
+        if (MX_UNLIKELY(!event)) return;
+        
+        event->order_id = aggressive_id;
+        event->passive_order_id = passive_id;
+        event->timestamp = timestamp;
+        event->type = MX_EVENT_TYPE_TRADE;
+        event->order_event = 0;
+        event->price = price;
+        event->quantity = quantity;
+        event->remaining = 0;
+        event->reserved = 0;
+    }
+    
+    MX_FORCE_INLINE void push_order_event(OrderId order_id, mx_order_event_t order_event,
+                                          Quantity filled, Quantity remaining,
+                                          Timestamp timestamp) {
+        mx_event_t* event = claim();
+        if (MX_UNLIKELY(!event)) return;
+        
+        event->order_id = order_id;
+        event->passive_order_id = 0;
+        event->timestamp = timestamp;
+        event->type = MX_EVENT_TYPE_ORDER;
+        event->order_event = static_cast<uint32_t>(order_event);
+        event->price = 0;
+        event->quantity = filled;
+        event->remaining = remaining;
+        event->reserved = 0;
+    }
+    
+    /* ========================================================================
+     * Consumer
+     * ===================================================================== */
+    
+    /**
+     * Copy up to max events (oldest first) into out and release them
+     * Returns the number copied
+     */
+    uint32_t poll(mx_event_t* out, uint32_t max) {
+        uint32_t count = size();
+        if (count > max) count = max;
+        if (count == 0) return 0;
+        
+        // At most two contiguous runs: up to the end of storage, then from the start
+        uint32_t start = head_ & mask_;
+        uint32_t first = mask_ + 1 - start;
+        if (first > count) first = count;
+        
+        std::memcpy(out, events_ + start, sizeof(mx_event_t) * first);
+        std::memcpy(out + first, events_, sizeof(mx_event_t) * (count - first));
+        
+        head_ += count;
+        return count;
+    }
+    
+    void clear() {
+        head_ = 0;
+        tail_ = 0;
+    }
+
+private:
+    MX_FORCE_INLINE mx_event_t* claim() {
+        if (MX_UNLIKELY(size() > mask_) && !grow()) {
+            return nullptr; // Out of memory - drop rather than overwrite unread events
+        }
+        return &events_[tail_++ & mask_];
+    }
+    
+    /**
+     * Double the storage, unwrapping pending events to the front
+     */
+    bool grow() {
+        uint32_t old_capacity = mask_ + 1;
+        if (old_capacity >= (1u << 31)) return false;
+        
+        uint32_t new_capacity = old_capacity * 2;
+        mx_event_t* events = static_cast<mx_event_t*>(mx_malloc(sizeof(mx_event_t) * new_capacity));
+        if (!events) return false;
+        
+        uint32_t count = poll(events, size());
+        mx_free(events_);
+        events_ = events;
+        mask_ = new_capacity - 1;
+        head_ = 0;
+        tail_ = count;
+        return true;
+    }
+};
+
+} // namespace matchx
+
+#endif // MX_INTERNAL_CORE_EVENT_RING_H
@@ -0,0 +1,188 @@
+/**
+ * ExpiryQueue - time-ordered schedule of orders with an expiry
+ * Intrusive binary min-heap keyed on expire time, so an expiration pass
+ * only touches the orders that are actually due
+ */
+
+#ifndef MX_INTERNAL_CORE_EXPIRY_QUEUE_H
+#define MX_INTERNAL_CORE_EXPIRY_QUEUE_H
+
+#include "../common.h"
+#include "../types.h"
+#include "../allocator.h"
+#include "order.h"
+
+namespace matchx {
+
+/* ============================================================================
+ * ExpiryQueue Class
+ * Each order remembers its heap slot (Order::expiry_slot), which makes
+ * unscheduling on cancel or fill O(log n) with no search
+ *
+ * The expire time is copied into the heap entry so sifting compares
+ * contiguous keys instead of chasing order pointers
+ * ========================================================================= */
+
+class ExpiryQueue {
+private:
+    struct Entry {
+        Timestamp expire_time;
+        Order* order;
+    };
+    
+    Entry* heap_;
+    uint32_t size_;
+    uint32_t capacity_;
+    
+    MX_IMPLEMENTS_ALLOCATORS
+
+public:
+    /* ========================================================================
+     * Constructors
+     * ===================================================================== */
+    
+    ExpiryQueue() : heap_(nullptr), size_(0), capacity_(0) {}
+    
+    ~ExpiryQueue() {
+        mx_free(heap_);
+    }
+    
+    // Non-copyable
+    ExpiryQueue(const ExpiryQueue&) = delete;
+    ExpiryQueue& operator=(const ExpiryQueue&) = delete;
+    
+    /* ========================================================================
+     * Getters
+     * ===================================================================== */
+    
+    bool empty() const { return size_ == 0; }
+    uint32_t size() const { return size_; }
+    
+    /**
+     * Earliest scheduled order if it is due at current_time, else nullptr
+     */
+    MX_FORCE_INLINE Order* next_due(Timestamp current_time) const {
+        if (size_ == 0 || heap_[0].expire_time > current_time) return nullptr;
+        return heap_[0].order;
+    }
+    
+    /* ========================================================================
+     * Scheduling
+     * ===================================================================== */
+    
+    /**
+     * Schedule an order at its expire time
+     * Returns false if the heap could not grow
+     */
+    bool schedule(Order* order) {
+        MX_ASSERT(order->has_expiry());
+        MX_ASSERT(!order->is_scheduled());
+        
+        if (MX_UNLIKELY(size_ == capacity_) && !grow()) {
+            return false;
+        }
+        
+        uint32_t slot = size_++;
+        heap_[slot].expire_time = order->expire_time();
+        heap_[slot].order = order;
+        order->set_expiry_slot(slot);
+        sift_up(slot);
+        return true;
+    }
+    
+    /**
+     * Remove a scheduled order (no-op if it is not scheduled)
+     */
+    void unschedule(Order* order) {
+        if (!order->is_scheduled()) return;
+        
+        uint32_t slot = order->expiry_slot();
+        MX_ASSERT(slot < size_ && heap_[slot].order == order);
+        order->set_expiry_slot(Order::NO_EXPIRY_SLOT);
+        
+        uint32_t last = --size_;
+        if (slot == last) return;
+        
+        // Move the last entry into the hole and restore heap order
+        place(slot, heap_[last]);
+        if (slot > 0 && heap_[slot].expire_time < heap_[parent(slot)].expire_time) {
+            sift_up(slot);
+        } else {
+            sift_down(slot);
+        }
+    }
+    
+    /**
+     * Visit every order due at current_time (in no particular order)
+     * Subtrees whose root is not yet due are pruned
+     */
+    template<typename Func>
+    void for_each_due(Timestamp current_time, Func func) const {
+        visit_due(0, current_time, func);
+    }
+    
+    /**
+     * Drop all entries (orders themselves are owned by OrderPool)
+     */
+    void clear() {
+        for (uint32_t i = 0; i < size_; ++i) {
+            heap_[i].order->set_expiry_slot(Order::NO_EXPIRY_SLOT);
+        }
+        size_ = 0;
+    }
+
+private:
+    static uint32_t parent(uint32_t slot) { return (slot - 1) / 2; }
+    
+    MX_FORCE_INLINE void place(uint32_t slot, const Entry& entry) {
+        heap_[slot] = entry;
+        entry.order->set_expiry_slot(slot);
+    }
+    
+    void sift_up(uint32_t slot) {
+        Entry entry = heap_[slot];
+        while (slot > 0) {
+            uint32_t up = parent(slot);
+            if (heap_[up].expire_time <= entry.expire_time) break;
+            place(slot, heap_[up]);
+            slot = up;
+        }
+        place(slot, entry);
+    }
+    
+    void sift_down(uint32_t slot) {
+        Entry entry = heap_[slot];
+        for (;;) {
+            uint32_t child = slot * 2 + 1;
+            if (child >= size_) break;
+            if (child + 1 < size_ && heap_[child + 1].expire_time < heap_[child].expire_time) {
+                ++child;
+            }
+            if (entry.expire_time <= heap_[child].expire_time) break;
+            place(slot, heap_[child]);
+            slot = child;
+        }
+        place(slot, entry);
+    }
+    
+    template<typename Func>
+    void visit_due(uint32_t slot, Timestamp current_time, Func& func) const {
+        if (slot >= size_ || heap_[slot].expire_time > current_time) return;
+        func(heap_[slot].order);
+        visit_due(slot * 2 + 1, current_time, func);
+        visit_due(slot * 2 + 2, current_time, func);
+    }
+    
+    bool grow() {
+        uint32_t new_capacity = capacity_ ? capacity_ * 2 : 64;
+        Entry* new_heap = static_cast<Entry*>(mx_realloc(heap_, sizeof(Entry) * new_capacity));
+        if (!new_heap) return false;
+        heap_ = new_heap;
+        capacity_ = new_capacity;
+        return true;
+    }
+};
+
+} // namespace matchx
+
+#endif // MX_INTERNAL_CORE_EXPIRY_QUEUE_H
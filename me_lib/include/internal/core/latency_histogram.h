@@ -0,0 +1,222 @@
+/**
+ * LatencyHistogram - log-bucketed latency recording for book operations
+ * Samples are raw cycle-counter deltas; the context's calibration turns
+ * them into nanoseconds only when they are read back
+ */
+
+#ifndef MX_INTERNAL_CORE_LATENCY_HISTOGRAM_H
+#define MX_INTERNAL_CORE_LATENCY_HISTOGRAM_H
+
+#include "../common.h"
+#include <chrono>
+
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(_MSC_VER)
+#include <x86intrin.h>
+#include <cpuid.h>
+#endif
+
+namespace matchx {
+
+/* ============================================================================
+ * Cycle Counter
+ * TSC on x86 (invariant on every CPU this targets), steady_clock
+ * nanoseconds elsewhere
+ * ========================================================================= */
+
+MX_FORCE_INLINE uint64_t read_cycle_counter() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/**
+ * True if the counter ticks at a constant rate through frequency and
+ * power-state changes (CPUID 0x80000007 EDX bit 8), so it can keep time
+ * and not just measure short intervals. Always true off x86, where the
+ * counter is steady_clock itself
+ */
+inline bool has_invariant_cycle_counter() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int regs[4];
+    __cpuid(regs, 0x80000000);
+    if (static_cast<unsigned>(regs[0]) < 0x80000007u) return false;
+    __cpuid(regs, 0x80000007);
+    return (regs[3] & (1 << 8)) != 0;
+#elif defined(__x86_64__) || defined(__i386__)
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return false;
+    return (edx & (1u << 8)) != 0;
+#else
+    return true;
+#endif
+}
+
+/**
+ * Nanoseconds per cycle-counter tick, measured against steady_clock
+ * Spins for about two milliseconds
+ */
+inline double calibrate_cycle_counter() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    uint64_t start_ticks = read_cycle_counter();
+    Clock::time_point end;
+    do {
+        end = Clock::now();
+    } while (end - start < std::chrono::milliseconds(2));
+    uint64_t ticks = read_cycle_counter() - start_ticks;
+    double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    return ticks ? ns / static_cast<double>(ticks) : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+/* ============================================================================
+ * LatencyHistogram Class
+ * HDR-style buckets: values below 2^SUB_BITS get a bucket each, and every
+ * power of two above that is split into 2^SUB_BITS equal buckets, so a
+ * recorded value is known to within 1 / 2^SUB_BITS (about 3%) across the
+ * whole range at a fixed 9 KB
+ *
+ * Recording is an index computation and an increment; like the book that
+ * owns it, the histogram is single-threaded
+ * ========================================================================= */
+
+class LatencyHistogram {
+public:
+    static constexpr uint32_t SUB_BITS = 5;
+    static constexpr uint32_t SUB_COUNT = 1u << SUB_BITS;
+    static constexpr uint32_t MAX_BITS = 40;     // ~6 minutes of TSC ticks at 3 GHz
+    static constexpr uint32_t BUCKET_COUNT = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+private:
+    uint64_t counts_[BUCKET_COUNT];
+    uint64_t total_count_;
+    uint64_t total_ticks_;
+    uint64_t min_;
+    uint64_t max_;
+    
+    MX_IMPLEMENTS_ALLOCATORS
+
+public:
+    /* ========================================================================
+     * Constructors
+     * ===================================================================== */
+    
+    LatencyHistogram() {
+        reset();
+    }
+    
+    // Non-copyable
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+    
+    /* ========================================================================
+     * Recording
+     * ===================================================================== */
+    
+    MX_FORCE_INLINE void record(uint64_t ticks) {
+        ++counts_[bucket_of(ticks)];
+        ++total_count_;
+        total_ticks_ += ticks;
+        if (ticks < min_) min_ = ticks;
+        if (ticks > max_) max_ = ticks;
+    }
+    
+    void reset() {
+        std::memset(counts_, 0, sizeof(counts_));
+        total_count_ = 0;
+        total_ticks_ = 0;
+        min_ = UINT64_MAX;
+        max_ = 0;
+    }
+    
+    /* ========================================================================
+     * Queries (ticks)
+     * ===================================================================== */
+    
+    uint64_t count() const { return total_count_; }
+    uint64_t total() const { return total_ticks_; }
+    uint64_t min() const { return total_count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    
+    /**
+     * Value that percentile% of samples are at or below, reported as the
+     * top of its bucket (clamped to the smallest and largest sample)
+     */
+    uint64_t value_at_percentile(double percentile) const {
+        if (total_count_ == 0) return 0;
+        if (percentile <= 0.0) return min_;
+        if (percentile >= 100.0) return max_;
+        
+        uint64_t target = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total_count_) + 0.5);
+        if (target == 0) target = 1;
+        
+        uint64_t seen = 0;
+        for (uint32_t index = 0; index < BUCKET_COUNT; ++index) {
+            seen += counts_[index];
+            if (seen >= target) {
+                uint64_t top = (index + 1 < BUCKET_COUNT) ? lowest_value(index + 1) - 1 : max_;
+                return MX_MAX(MX_MIN(top, max_), min_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    static MX_FORCE_INLINE uint32_t bucket_of(uint64_t value) {
+        if (value < SUB_COUNT) {
+            return static_cast<uint32_t>(value);
+        }
+        uint32_t msb = mx_msb64(value);
+        if (msb >= MAX_BITS) {
+            return BUCKET_COUNT - 1;
+        }
+        uint32_t shift = msb - SUB_BITS;
+        uint32_t sub = static_cast<uint32_t>(value >> shift) - SUB_COUNT;
+        return ((shift + 1) << SUB_BITS) | sub;
+    }
+    
+    static uint64_t lowest_value(uint32_t index) {
+        uint32_t group = index >> SUB_BITS;
+        if (group == 0) {
+            return index;
+        }
+        uint64_t mantissa = (index & (SUB_COUNT - 1)) + SUB_COUNT;
+        return mantissa << (group - 1);
+    }
+};
+
+/* ============================================================================
+ * LatencyTimer
+ * Records the lifetime of a scope into a histogram; a null histogram
+ * (tracking off) skips both counter reads
+ * ========================================================================= */
+
+class LatencyTimer {
+private:
+    LatencyHistogram* histogram_;
+    uint64_t start_;
+
+public:
+    explicit MX_FORCE_INLINE LatencyTimer(LatencyHistogram* histogram)
+        : histogram_(histogram)
+        , start_(histogram ? read_cycle_counter() : 0) {}
+    
+    MX_FORCE_INLINE ~LatencyTimer() {
+        if (histogram_) {
+            histogram_->record(read_cycle_counter() - start_);
+        }
+    }
+    
+    LatencyTimer(const LatencyTimer&) = delete;
+    LatencyTimer& operator=(const LatencyTimer&) = delete;
+};
+
+} // namespace matchx
+
+#endif // MX_INTERNAL_CORE_LATENCY_HISTOGRAM_H
@@ -12,26 +12,54 @@
 
 namespace matchx {
 
+class Order;
+
+/* ============================================================================
+ * OrderCold
+ * Attributes matching rarely reads, kept out of the hot Order line
+ *
+ * Lives in a parallel array owned by OrderPool; each Order slot is bound
+ * to one record for the lifetime of the pool
+ * ========================================================================= */
+
+struct OrderCold {
+    Timestamp created_time;        // When order was created
+    Timestamp expire_time;         // Expiration time (0 = no expiry)
+    Price stop_price;              // Stop trigger price (0 for non-stop orders)
+    uint32_t flags;                // MX_ORDER_FLAG_* bits
+    uint32_t expiry_slot;          // Position in the book's ExpiryQueue
+    TimeInForce time_in_force;
+    OwnerId owner;                 // Mass-cancel tag (NO_OWNER = untagged)
+    Order* owner_prev;             // OrderPool's per-owner chain, newest first
+    Order* owner_next;
+};
+
 /* ============================================================================
  * Order Class
  * Represents a single order with all its attributes
+ *
+ * Exactly one cache line: list links, price, quantities and identity.
+ * Side and type are stored as bytes; everything else lives in OrderCold
+ * and is reached through cold_. Sweeping a level therefore reads one
+ * line per resting order
  * ========================================================================= */
 
-class Order : public IntrusiveListNode<Order> {
+class MX_CACHE_ALIGNED Order : public IntrusiveListNode<Order> {
+public:
+    static constexpr uint32_t NO_EXPIRY_SLOT = UINT32_MAX;
+
 private:
-    // Order identification
-    OrderId order_id_;
+    static constexpr uint8_t HOT_FLAG_SCHEDULED = 1u << 0;   // In the ExpiryQueue
+    static constexpr uint8_t HOT_FLAG_OWNED = 1u << 1;       // On an owner chain
     
     // Order attributes
-    Side side_;
-    OrderType order_type_;
+    uint8_t side_;                 // Side
+    uint8_t order_type_;           // OrderType
     OrderState state_;
-    TimeInForce time_in_force_;
-    uint32_t flags_;
+    uint8_t hot_flags_;            // HOT_FLAG_* bits
     
     // Pricing
-    Price price_;           // Limit price (0 for market orders)
-    Price stop_price_;      // Stop trigger price (0 for non-stop orders)
+    Price price_;                  // Limit price (0 for market orders)
     
     // Quantities
     Quantity total_quantity_;      // Original order quantity
@@ -39,9 +67,10 @@ private:
     Quantity display_quantity_;    // Visible quantity (for iceberg)
     Quantity visible_filled_;      // How much of visible portion is filled
     
-    // Timing
-    Timestamp created_time_;       // When order was created
-    Timestamp expire_time_;        // Expiration time (0 = no expiry)
+    // Order identification
+    OrderId order_id_;
+    
+    OrderCold* cold_;              // Rarely used attributes
     
     MX_IMPLEMENTS_ALLOCATORS
 
@@ -50,41 +79,57 @@ public:
      * Constructors
      * ===================================================================== */
     
-    Order(OrderId id, Side side, OrderType type, Price price, 
+    Order(OrderCold* cold, OrderId id, Side side, OrderType type, Price price,
           Quantity quantity, Timestamp created)
-        : order_id_(id)
-        , side_(side)
-        , order_type_(type)
+        : side_(static_cast<uint8_t>(side))
+        , order_type_(static_cast<uint8_t>(type))
         , state_(OrderState::PENDING_NEW)
-        , time_in_force_(MX_TIF_GTC)
-        , flags_(MX_ORDER_FLAG_NONE)
+        , hot_flags_(0)
         , price_(price)
-        , stop_price_(0)
         , total_quantity_(quantity)
         , filled_quantity_(0)
         , display_quantity_(0) // 0 means show all
         , visible_filled_(0)
-        , created_time_(created)
-        , expire_time_(0) {}
+        , order_id_(id)
+        , cold_(cold) {
+        
+        cold_->created_time = created;
+        cold_->expire_time = 0;
+        cold_->stop_price = 0;
+        cold_->flags = MX_ORDER_FLAG_NONE;
+        cold_->expiry_slot = NO_EXPIRY_SLOT;
+        cold_->time_in_force = MX_TIF_GTC;
+        cold_->owner = NO_OWNER;
+        cold_->owner_prev = nullptr;
+        cold_->owner_next = nullptr;
+    }
     
     // Full constructor with all parameters
-    Order(OrderId id, Side side, OrderType type, Price price, Price stop_price,
-          Quantity quantity, Quantity display_qty, TimeInForce tif, 
+    Order(OrderCold* cold, OrderId id, Side side, OrderType type, Price price,
+          Price stop_price, Quantity quantity, Quantity display_qty, TimeInForce tif,
           uint32_t flags, Timestamp created, Timestamp expire)
-        : order_id_(id)
-        , side_(side)
-        , order_type_(type)
+        : side_(static_cast<uint8_t>(side))
+        , order_type_(static_cast<uint8_t>(type))
         , state_(OrderState::PENDING_NEW)
-        , time_in_force_(tif)
-        , flags_(flags)
+        , hot_flags_(0)
         , price_(price)
-        , stop_price_(stop_price)
         , total_quantity_(quantity)
         , filled_quantity_(0)
         , display_quantity_(display_qty)
         , visible_filled_(0)
-        , created_time_(created)
-        , expire_time_(expire) {}
+        , order_id_(id)
+        , cold_(cold) {
+        
+        cold_->created_time = created;
+        cold_->expire_time = expire;
+        cold_->stop_price = stop_price;
+        cold_->flags = flags;
+        cold_->expiry_slot = NO_EXPIRY_SLOT;
+        cold_->time_in_force = tif;
+        cold_->owner = NO_OWNER;
+        cold_->owner_prev = nullptr;
+        cold_->owner_next = nullptr;
+    }
     
     ~Order() = default;
     
@@ -97,20 +142,21 @@ public:
      * ===================================================================== */
     
     OrderId order_id() const { return order_id_; }
-    Side side() const { return side_; }
-    OrderType order_type() const { return order_type_; }
+    Side side() const { return static_cast<Side>(side_); }
+    OrderType order_type() const { return static_cast<OrderType>(order_type_); }
     OrderState state() const { return state_; }
-    TimeInForce time_in_force() const { return time_in_force_; }
-    uint32_t flags() const { return flags_; }
+    TimeInForce time_in_force() const { return cold_->time_in_force; }
+    uint32_t flags() const { return cold_->flags; }
     
     Price price() const { return price_; }
-    Price stop_price() const { return stop_price_; }
+    Price stop_price() const { return cold_->stop_price; }
     
     Quantity total_quantity() const { return total_quantity_; }
     Quantity filled_quantity() const { return filled_quantity_; }
     Quantity remaining_quantity() const { return total_quantity_ - filled_quantity_; }
     
     Quantity display_quantity() const { return display_quantity_; }
+    Quantity visible_filled() const { return visible_filled_; }
     Quantity visible_quantity() const {
         // If display_quantity is 0, show all remaining
         if (display_quantity_ == 0) {
@@ -121,8 +167,13 @@ public:
                (display_quantity_ - visible_filled_) : 0;
     }
     
-    Timestamp created_time() const { return created_time_; }
-    Timestamp expire_time() const { return expire_time_; }
+    Timestamp created_time() const { return cold_->created_time; }
+    Timestamp expire_time() const { return cold_->expire_time; }
+    
+    OrderCold* cold() const { return cold_; }
+    
+    OwnerId owner() const { return cold_->owner; }
+    Order* next_owned() const { return cold_->owner_next; }
     
     /* ========================================================================
      * State Queries
@@ -143,29 +194,53 @@ public:
     bool is_cancelled() const { return state_ == OrderState::CANCELLED; }
     bool is_partially_filled() const { return state_ == OrderState::PARTIALLY_FILLED; }
     
-    bool is_gtc() const { return time_in_force_ == MX_TIF_GTC; }
-    bool is_ioc() const { return time_in_force_ == MX_TIF_IOC; }
-    bool is_fok() const { return time_in_force_ == MX_TIF_FOK; }
-    bool is_day() const { return time_in_force_ == MX_TIF_DAY; }
-    bool is_gtd() const { return time_in_force_ == MX_TIF_GTD; }
+    bool is_gtc() const { return cold_->time_in_force == MX_TIF_GTC; }
+    bool is_ioc() const { return cold_->time_in_force == MX_TIF_IOC; }
+    bool is_fok() const { return cold_->time_in_force == MX_TIF_FOK; }
+    bool is_day() const { return cold_->time_in_force == MX_TIF_DAY; }
+    bool is_gtd() const { return cold_->time_in_force == MX_TIF_GTD; }
     
-    bool is_post_only() const { return MX_HAS_BIT(flags_, MX_ORDER_FLAG_POST_ONLY); }
-    bool is_hidden() const { return MX_HAS_BIT(flags_, MX_ORDER_FLAG_HIDDEN); }
+    bool is_post_only() const { return MX_HAS_BIT(cold_->flags, MX_ORDER_FLAG_POST_ONLY); }
+    bool is_hidden() const { return MX_HAS_BIT(cold_->flags, MX_ORDER_FLAG_HIDDEN); }
     bool is_iceberg() const { return display_quantity_ > 0; }
-    bool is_aon() const { return MX_HAS_BIT(flags_, MX_ORDER_FLAG_AON); }
-    bool is_reduce_only() const { return MX_HAS_BIT(flags_, MX_ORDER_FLAG_REDUCE_ONLY); }
+    bool is_aon() const { return MX_HAS_BIT(cold_->flags, MX_ORDER_FLAG_AON); }
+    bool is_reduce_only() const { return MX_HAS_BIT(cold_->flags, MX_ORDER_FLAG_REDUCE_ONLY); }
     
-    bool has_expiry() const { return expire_time_ > 0; }
+    bool has_expiry() const { return cold_->expire_time > 0; }
     bool is_expired(Timestamp current_time) const {
-        return has_expiry() && current_time >= expire_time_;
+        return has_expiry() && current_time >= cold_->expire_time;
     }
     
+    // Answered from the hot line so fills never touch the cold record
+    bool is_scheduled() const { return (hot_flags_ & HOT_FLAG_SCHEDULED) != 0; }
+    uint32_t expiry_slot() const { return cold_->expiry_slot; }
+    bool has_owner() const { return (hot_flags_ & HOT_FLAG_OWNED) != 0; }
+    
     /* ========================================================================
      * Setters (internal state changes)
      * ===================================================================== */
     
     void set_state(OrderState state) { state_ = state; }
     void set_price(Price price) { price_ = price; }
+    void set_order_id(OrderId id) { order_id_ = id; }     // OrderPool re-keys the lookup
+    void set_expiry_slot(uint32_t slot) {
+        cold_->expiry_slot = slot;
+        if (slot == NO_EXPIRY_SLOT) {
+            hot_flags_ &= static_cast<uint8_t>(~HOT_FLAG_SCHEDULED);
+        } else {
+            hot_flags_ |= HOT_FLAG_SCHEDULED;
+        }
+    }
+    
+    // Chain links are maintained by OrderPool
+    void set_owner(OwnerId owner) {
+        cold_->owner = owner;
+        if (owner == NO_OWNER) {
+            hot_flags_ &= static_cast<uint8_t>(~HOT_FLAG_OWNED);
+        } else {
+            hot_flags_ |= HOT_FLAG_OWNED;
+        }
+    }
     
     /* ========================================================================
      * Order Operations
@@ -221,6 +296,25 @@ public:
         return true;
     }
     
+    /**
+     * New price and total quantity for a cancel/replace that gives up time
+     * priority; fills so far are kept and an iceberg shows a fresh slice
+     */
+    void amend(Price price, Quantity total_quantity) {
+        price_ = price;
+        total_quantity_ = total_quantity;
+        visible_filled_ = 0;
+    }
+    
+    /**
+     * Reapply saved fill progress and state (snapshot restore only)
+     */
+    void restore(Quantity filled, Quantity visible_filled, OrderState state) {
+        filled_quantity_ = filled;
+        visible_filled_ = visible_filled;
+        state_ = state;
+    }
+    
     /**
      * Cancel the order
      */
@@ -243,13 +337,13 @@ public:
         
         // Convert stop order to regular order
         if (order_type_ == MX_ORDER_TYPE_STOP) {
-            order_type_ = MX_ORDER_TYPE_MARKET;
+            order_type_ = static_cast<uint8_t>(MX_ORDER_TYPE_MARKET);
         } else if (order_type_ == MX_ORDER_TYPE_STOP_LIMIT) {
-            order_type_ = MX_ORDER_TYPE_LIMIT;
+            order_type_ = static_cast<uint8_t>(MX_ORDER_TYPE_LIMIT);
         }
         
         state_ = OrderState::TRIGGERED;
-        stop_price_ = 0; // No longer a stop order
+        cold_->stop_price = 0; // No longer a stop order
     }
     
     /* ========================================================================
@@ -262,19 +356,19 @@ public:
     OrderSnapshot snapshot() const {
         OrderSnapshot snap;
         snap.order_id = order_id_;
-        snap.side = side_;
-        snap.type = order_type_;
+        snap.side = side();
+        snap.type = order_type();
         snap.price = price_;
-        snap.stop_price = stop_price_;
+        snap.stop_price = cold_->stop_price;
         snap.total_quantity = total_quantity_;
         snap.filled_quantity = filled_quantity_;
         snap.remaining_quantity = remaining_quantity();
         snap.display_quantity = display_quantity_;
-        snap.tif = time_in_force_;
-        snap.flags = flags_;
+        snap.tif = cold_->time_in_force;
+        snap.flags = cold_->flags;
         snap.state = state_;
-        snap.created_time = created_time_;
-        snap.expire_time = expire_time_;
+        snap.created_time = cold_->created_time;
+        snap.expire_time = cold_->expire_time;
         return snap;
     }
     
@@ -307,6 +401,9 @@ public:
     }
 };
 
+static_assert(sizeof(Order) == MX_CACHE_LINE_SIZE, "Order must occupy exactly one cache line");
+static_assert(alignof(Order) == MX_CACHE_LINE_SIZE, "Order must be cache-line aligned");
+
 } // namespace matchx
 
 #endif // MX_INTERNAL_CORE_ORDER_H
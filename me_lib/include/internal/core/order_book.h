@@ -9,18 +9,23 @@
 
 #include "../common.h"
 #include "../types.h"
+#include "../context.h"
 #include "../utils/hash_map.h"
 #include "order.h"
 #include "price_level.h"
+#include "book_side.h"
+#include "depth_cache.h"
 #include "order_pool.h"
-#include <map>
+#include "event_ring.h"
+#include "latency_histogram.h"
+#include "book_view.h"
 #include <string>
 #include <vector>
 
 namespace matchx {
 
-// Forward declaration
-class Context;
+// Forward declarations
+namespace snapshot { struct OrderRecord; }
 
 /* ============================================================================
  * OrderBook Class
@@ -38,22 +43,46 @@ private:
     // Order management
     OrderPool order_pool_;
     
-    // Price levels - using std::map for now (could optimize to array for bounded prices)
-    // Key insight: std::map keeps prices sorted automatically!
-    std::map<Price, PriceLevel, std::greater<Price>, ProxyAllocator<std::pair<const Price, PriceLevel>>> bid_levels_;  // Descending (highest first)
-    std::map<Price, PriceLevel, std::less<Price>, ProxyAllocator<std::pair<const Price, PriceLevel>>> ask_levels_;     // Ascending (lowest first)
+    // Price levels - tick-indexed ladder when the context has price bounds,
+    // std::map otherwise. Either way levels come out sorted best first
+    BookSide<MX_SIDE_BUY> bid_levels_;   // Descending (highest first)
+    BookSide<MX_SIDE_SELL> ask_levels_;  // Ascending (lowest first)
     
-    // Stop orders (not in main book yet)
-    OrderIdMap<Order*> stop_orders_;
+    // Pending stop orders (not in main book yet), queued by stop price
+    // on the same level layout as the book. On a bounded book the stop
+    // ladders are only built when the first stop arrives
+    BookSide<MX_SIDE_SELL> buy_stops_;   // Ascending - lowest stop fires first
+    BookSide<MX_SIDE_BUY> sell_stops_;   // Descending - highest stop fires first
+    bool stop_ladders_built_;            // Or tried and fell back to the map
     
     // Best prices (cached for O(1) access)
     Price best_bid_;
     Price best_ask_;
     
+    // Side volume totals and cached top levels (kept in step with the
+    // bid/ask levels above)
+    DepthCache bid_depth_;
+    DepthCache ask_depth_;
+    
     // Statistics
     uint64_t total_trades_;
     uint64_t total_volume_;
     
+    // Buffered events (enabled when the context asks for an event buffer)
+    EventRing events_;
+    
+    // MX_LATENCY_OP_COUNT histograms indexed by mx_latency_op_t, or
+    // nullptr when the context does not track latency
+    LatencyHistogram* latency_;
+    
+    // Published summary for other threads, or nullptr when the context
+    // does not publish views
+    BookView* view_;
+    
+    // Open mutating calls, so nested ones (batch commands) share the
+    // outermost call's clock reading and view publish
+    uint32_t call_depth_;
+    
     MX_IMPLEMENTS_ALLOCATORS
 
 public:
@@ -101,7 +130,13 @@ public:
     mx_status_t modify_order(OrderId order_id, Quantity new_quantity);
     
     /**
-     * Replace an order (cancel + add, loses time priority)
+     * Amend a resting order in place (cancel/replace)
+     * The order keeps its pool slot, owner and expiry; new_quantity is the
+     * new total, filled quantity included. A same-price reduction keeps
+     * time priority; any other change moves the order to the back of its
+     * new level, matching first if the new price crosses. Reports one
+     * MX_EVENT_ORDER_REPLACED instead of a cancel and an accept.
+     * new_order_id of 0 (or old_order_id) keeps the order's ID.
      */
     mx_status_t replace_order(OrderId old_order_id, OrderId new_order_id,
                              Price new_price, Quantity new_quantity);
@@ -118,6 +153,24 @@ public:
                          Quantity display_qty, TimeInForce tif, uint32_t flags,
                          uint64_t expire_time);
     
+    /**
+     * Run new/cancel/modify/replace commands in order in a single pass
+     * statuses (optional) receives one result per command
+     * Returns the number of commands that succeeded
+     */
+    uint32_t submit_batch(const mx_command_t* commands, int* statuses, uint32_t count);
+    
+    /**
+     * Tag an order for mass cancel (NO_OWNER removes the tag)
+     */
+    mx_status_t set_owner(OrderId order_id, OwnerId owner);
+    
+    /**
+     * Cancel every order of owner on the selected side(s) in one pass
+     * Returns the number cancelled
+     */
+    uint32_t mass_cancel(OwnerId owner, mx_side_filter_t side_filter);
+    
     /* ========================================================================
      * Market Data Queries
      * ===================================================================== */
@@ -138,6 +191,12 @@ public:
     Quantity get_volume_at_price(Side side, Price price) const;
     uint64_t get_depth(Side side, uint32_t num_levels) const;
     
+    /**
+     * Copy up to max_levels levels of one side into out, best first
+     * Returns the number written
+     */
+    uint32_t get_levels(Side side, uint32_t max_levels, mx_level_t* out) const;
+    
     /* ========================================================================
      * Order Queries
      * ===================================================================== */
@@ -160,6 +219,8 @@ public:
     uint32_t get_ask_level_count() const { return static_cast<uint32_t>(ask_levels_.size()); }
     uint32_t get_total_order_count() const { return static_cast<uint32_t>(order_pool_.active_order_count()); }
     
+    bool uses_price_ladder() const { return bid_levels_.uses_ladder(); }
+    
     uint64_t get_total_trades() const { return total_trades_; }
     uint64_t get_total_volume() const { return total_volume_; }
     
@@ -179,10 +240,82 @@ public:
     
     /**
      * Process stop orders that may have been triggered
+     * (stops also fire automatically after every order operation)
      */
     uint32_t process_stops();
     
+    /* ========================================================================
+     * Snapshots (see core/snapshot.h for the file layout)
+     * ===================================================================== */
+    
+    /**
+     * Write every resting order and pending stop, in queue order
+     * The file is written beside path and renamed into place
+     */
+    mx_status_t save_snapshot(const char* path) const;
+    
+    /**
+     * Replace the book's contents with a saved snapshot
+     * Rebuilds pool, levels and indexes directly - no matching, no events.
+     * On failure the book is left empty
+     */
+    mx_status_t load_snapshot(const char* path);
+    
+    /* ========================================================================
+     * Buffered Events
+     * ===================================================================== */
+    
+    bool uses_event_buffer() const { return events_.enabled(); }
+    
+    /**
+     * Drain up to max_events buffered events, oldest first
+     */
+    uint32_t poll_events(mx_event_t* out, uint32_t max_events) {
+        return events_.poll(out, max_events);
+    }
+    
+    uint32_t get_pending_event_count() const { return events_.size(); }
+    
+    /* ========================================================================
+     * Latency
+     * ===================================================================== */
+    
+    bool tracks_latency() const { return latency_ != nullptr; }
+    
+    /**
+     * Distribution of one operation in nanoseconds
+     * (false if the book does not track latency)
+     */
+    bool get_latency(mx_latency_op_t op, mx_latency_stats_t& stats) const;
+    
+    uint64_t get_latency_percentile(mx_latency_op_t op, double percentile) const;
+    
+    void reset_latency();
+    
+    /* ========================================================================
+     * Published View (readable from any thread)
+     * ===================================================================== */
+    
+    bool publishes_view() const { return view_ != nullptr; }
+    
+    /**
+     * Copy the latest published view (false if the book has none)
+     */
+    bool read_view(mx_book_view_t& out) const {
+        if (!view_) return false;
+        view_->read(out);
+        return true;
+    }
+    
+    uint64_t get_view_sequence() const { return view_ ? view_->sequence() : 0; }
+
 private:
+    /**
+     * Reserve (and pre-fault) this book's storage in the context arena
+     * Returns the arena to build from, or nullptr to use mx_malloc
+     */
+    static Arena* reserve_arena(Context* ctx);
+    
     /* ========================================================================
      * Internal Order Processing
      * ===================================================================== */
@@ -193,19 +326,21 @@ private:
     mx_status_t process_new_order(Order* order);
     
     /**
-     * Match an order against the book
+     * Execute one batch command
      */
-    MatchResult match_order(Order* order);
+    mx_status_t execute_command(const mx_command_t& command);
     
     /**
-     * Match a limit order
+     * Match an order against the book
      */
-    MatchResult match_limit_order(Order* order);
+    MatchResult match_order(Order* order);
     
     /**
-     * Match a market order
+     * Sweep one contra side best-first until the order is filled or
+     * PricePolicy says the next level is out of reach
      */
-    MatchResult match_market_order(Order* order);
+    template<typename PricePolicy, Side ContraSide>
+    MatchResult match_against(Order* order, BookSide<ContraSide>& levels);
     
     /**
      * Add order to book (after matching or if no match)
@@ -237,12 +372,90 @@ private:
      */
     void remove_level_if_empty(Side side, Price price);
     
+    /**
+     * Check that a resting price fits the configured price band
+     */
+    bool is_price_in_band(Price price) const {
+        return bid_levels_.accepts_price(price);
+    }
+    
     /**
      * Update best bid/ask after level changes
      */
     void update_best_bid();
     void update_best_ask();
     
+    /**
+     * Histogram for op, or nullptr when latency is not tracked
+     */
+    LatencyHistogram* latency_histogram(mx_latency_op_t op) {
+        return latency_ ? &latency_[op] : nullptr;
+    }
+    
+    /**
+     * Brackets every public mutating call. The outermost one reads the
+     * context clock on entry (a batch also refreshes the coarse clock)
+     * and publishes the view, if any, on exit
+     */
+    class CallScope {
+    private:
+        OrderBook* book_;
+    
+    public:
+        explicit MX_FORCE_INLINE CallScope(OrderBook* book, bool batch = false)
+            : book_(book) {
+            if (book_->call_depth_++ == 0) {
+                if (batch) {
+                    book_->context_->update_timestamp();
+                } else {
+                    book_->context_->tick();
+                }
+            }
+        }
+        
+        MX_FORCE_INLINE ~CallScope() {
+            if (--book_->call_depth_ == 0 && book_->view_) {
+                book_->publish_view();
+            }
+        }
+        
+        CallScope(const CallScope&) = delete;
+        CallScope& operator=(const CallScope&) = delete;
+    };
+    
+    /**
+     * Copy top of book, levels and counters into the view
+     */
+    void publish_view();
+    
+    DepthCache& depth_cache(Side side) {
+        return (side == MX_SIDE_BUY) ? bid_depth_ : ask_depth_;
+    }
+    
+    /**
+     * Report resting volume added to or removed from the level at price,
+     * keeping the depth cache and the side's volume vector in step
+     */
+    void add_level_volume(Side side, Price price, Quantity quantity) {
+        if (side == MX_SIDE_BUY) {
+            bid_depth_.add(price, quantity);
+            bid_levels_.add_volume(price, quantity);
+        } else {
+            ask_depth_.add(price, quantity);
+            ask_levels_.add_volume(price, quantity);
+        }
+    }
+    
+    void remove_level_volume(Side side, Price price, Quantity quantity) {
+        if (side == MX_SIDE_BUY) {
+            bid_depth_.remove(price, quantity);
+            bid_levels_.remove_volume(price, quantity);
+        } else {
+            ask_depth_.remove(price, quantity);
+            ask_levels_.remove_volume(price, quantity);
+        }
+    }
+    
     /* ========================================================================
      * Special Order Type Handling
      * ===================================================================== */
@@ -282,6 +495,56 @@ private:
      */
     bool should_trigger_stop(const Order* stop_order) const;
     
+    /**
+     * Turn a stop into a live limit/market order
+     */
+    void activate_stop(Order* order);
+    
+    /* ========================================================================
+     * Stop Index
+     * ===================================================================== */
+    
+    static bool is_pending_stop(const Order* order) {
+        return order->is_stop() && order->state() == OrderState::PENDING_NEW;
+    }
+    
+    void add_to_stop_index(Order* order);
+    void remove_from_stop_index(Order* order);
+    
+    /**
+     * Give both stop sides the book's ladder band, once (stop sides
+     * must be empty). On allocation failure they stay on the map
+     */
+    void build_stop_ladders();
+    
+    /**
+     * Front of the best stop level if the market has crossed it
+     */
+    Order* next_triggered_stop() const;
+    
+    /**
+     * Fire crossed stops, including stops reached by earlier triggers
+     * Cheap no-op when no stops are resting
+     */
+    uint32_t trigger_stops() {
+        if (MX_LIKELY(buy_stops_.empty() && sell_stops_.empty())) return 0;
+        return run_stop_cascade();
+    }
+    
+    uint32_t run_stop_cascade();
+    
+    /* ========================================================================
+     * Snapshot Restore
+     * ===================================================================== */
+    
+    /**
+     * Append count saved orders of one side to levels, in file order
+     * stops selects the stop index (keyed on stop price) over the book
+     */
+    template<Side S>
+    mx_status_t restore_orders(const snapshot::OrderRecord* records, uint64_t count,
+                               Side side, bool stops, BookSide<S>& levels);
+    
     /* ========================================================================
      * Callbacks
      * ===================================================================== */
@@ -314,10 +577,15 @@ private:
                                Price price, Price stop_price, Quantity quantity,
                                TimeInForce tif, uint32_t flags) const;
     
+    /**
+     * Map a failed OrderPool create to a status (duplicate vs out of memory)
+     */
+    mx_status_t create_failure_status(OrderId order_id) const;
+    
     /* ========================================================================
      * Debug
      * ===================================================================== */
-    
+
 #ifdef MX_DEBUG
 public:
     void validate() const;
@@ -1,6 +1,7 @@
 /**
  * OrderPool - manages memory allocation for Order objects
  * Uses memory pool for zero-allocation order creation/destruction
+ * Hot Order lines and their OrderCold records live in separate arrays
  */
 
 #ifndef MX_INTERNAL_CORE_ORDER_POOL_H
@@ -11,6 +12,7 @@
 #include "../utils/memory_pool.h"
 #include "../utils/hash_map.h"
 #include "order.h"
+#include "expiry_queue.h"
 
 namespace matchx {
 
@@ -21,8 +23,10 @@ namespace matchx {
 
 class OrderPool {
 private:
-    MemoryPool<Order> pool_;                    // Memory pool for orders
-    OrderIdMap<Order*> order_lookup_;           // Fast O(1) order lookup by ID
+    SplitMemoryPool<Order, OrderCold> pool_;    // Aligned hot orders + cold side table
+    OrderIdMap<Order*> order_lookup_;           // Flat open-addressing lookup by ID
+    ExpiryQueue expiry_queue_;                  // Live orders with an expire time
+    OrderIdMap<Order*> owner_heads_;            // Newest live order of each owner
     
     MX_IMPLEMENTS_ALLOCATORS
 
@@ -31,13 +35,11 @@ public:
      * Constructors
      * ===================================================================== */
     
-    explicit OrderPool(size_t initial_capacity = 10000)
-        : pool_(initial_capacity)
-        , order_lookup_(initial_capacity) {
-        
-        // Pre-allocate hash map buckets to avoid rehashing
-        order_lookup_.reserve(initial_capacity);
-    }
+    explicit OrderPool(size_t initial_capacity = 10000, Arena* arena = nullptr)
+        : pool_(initial_capacity, arena)
+        , order_lookup_(initial_capacity, arena)  // Sized up front to avoid rehashing
+        , expiry_queue_()
+        , owner_heads_() {}
     
     ~OrderPool() {
         // Destroy all remaining orders
@@ -48,6 +50,14 @@ public:
     OrderPool(const OrderPool&) = delete;
     OrderPool& operator=(const OrderPool&) = delete;
     
+    /**
+     * Add the arena blocks a pool constructed for initial_capacity takes to plan
+     */
+    static void footprint(size_t initial_capacity, ArenaPlan& plan) {
+        SplitMemoryPool<Order, OrderCold>::chunk_footprint(initial_capacity, plan);
+        OrderIdMap<Order*>::footprint(initial_capacity, plan);
+    }
+    
     /* ========================================================================
      * Order Creation
      * ===================================================================== */
@@ -58,18 +68,12 @@ public:
     Order* create_order(OrderId id, Side side, Price price, 
                    Quantity quantity, Timestamp timestamp) {
     
-        // Check for duplicate order ID
-        if (MX_UNLIKELY(order_lookup_.contains(id))) {
-            return nullptr; // Duplicate order ID
-        }
-    
-        // Allocate and construct order
-        Order* order = pool_.construct(id, side, MX_ORDER_TYPE_LIMIT, 
-                                      price, quantity, timestamp);
+        // Allocate and construct order (nullptr on duplicate order ID)
+        Order* order = construct_order(id, id, side, MX_ORDER_TYPE_LIMIT,
+                                       price, quantity, timestamp);
     
         if (MX_LIKELY(order != nullptr)) {
             order->set_state(OrderState::ACTIVE);
-            order_lookup_[id] = order;
         }
     
         return order;
@@ -81,17 +85,12 @@ public:
     Order* create_market_order(OrderId id, Side side, 
                               Quantity quantity, Timestamp timestamp) {
         
-        if (MX_UNLIKELY(order_lookup_.contains(id))) {
-            return nullptr;
-        }
-        
         // Market orders have price 0
-        Order* order = pool_.construct(id, side, MX_ORDER_TYPE_MARKET,
-                                      0, quantity, timestamp);
+        Order* order = construct_order(id, id, side, MX_ORDER_TYPE_MARKET,
+                                       0, quantity, timestamp);
         
         if (MX_LIKELY(order != nullptr)) {
             order->set_state(OrderState::ACTIVE);
-            order_lookup_[id] = order;
         }
         
         return order;
@@ -106,13 +105,9 @@ public:
                             TimeInForce tif, uint32_t flags,
                             Timestamp timestamp, Timestamp expire_time) {
         
-        if (MX_UNLIKELY(order_lookup_.contains(id))) {
-            return nullptr;
-        }
-        
-        Order* order = pool_.construct(id, side, type, price, stop_price,
-                                      quantity, display_qty, tif, flags,
-                                      timestamp, expire_time);
+        Order* order = construct_order(id, id, side, type, price, stop_price,
+                                       quantity, display_qty, tif, flags,
+                                       timestamp, expire_time);
         
         if (MX_LIKELY(order != nullptr)) {
             // Stop orders start as pending, others as active
@@ -121,7 +116,6 @@ public:
             } else {
                 order->set_state(OrderState::ACTIVE);
             }
-            order_lookup_[id] = order;
         }
         
         return order;
@@ -139,8 +133,12 @@ public:
         
         OrderId id = order->order_id();
         
-        // Remove from lookup
+        // Remove from lookup, the expiry schedule and its owner chain
         order_lookup_.erase(id);
+        expiry_queue_.unschedule(order);
+        if (order->has_owner()) {
+            unlink_owner(order);
+        }
         
         // Return to pool (calls destructor)
         pool_.destroy(order);
@@ -165,8 +163,8 @@ public:
      * Find an order by ID - O(1) lookup
      */
     Order* find_order(OrderId order_id) const {
-        auto it = order_lookup_.find(order_id);
-        return (it != order_lookup_.end()) ? it->second : nullptr;
+        Order* const* slot = order_lookup_.find(order_id);
+        return slot ? *slot : nullptr;
     }
     
     /**
@@ -176,6 +174,22 @@ public:
         return order_lookup_.contains(order_id);
     }
     
+    /**
+     * Move a live order to a new ID, keeping its slot
+     * Returns false if new_id is taken or the lookup is out of memory
+     */
+    bool rekey_order(Order* order, OrderId new_id) {
+        bool inserted;
+        Order** slot = order_lookup_.find_or_insert(new_id, inserted);
+        if (MX_UNLIKELY(slot == nullptr || !inserted)) return false;
+        
+        // Fill the new entry first: erasing the old one may shift it
+        *slot = order;
+        order_lookup_.erase(order->order_id());
+        order->set_order_id(new_id);
+        return true;
+    }
+    
     /**
      * Get order snapshot (safe copy of order data)
      */
@@ -187,6 +201,49 @@ public:
         return true;
     }
     
+    /* ========================================================================
+     * Owners
+     * Every live order tagged with an owner is on that owner's chain, so
+     * a mass cancel visits exactly the owner's orders and nothing else
+     * ===================================================================== */
+    
+    /**
+     * Move an order onto owner's chain (NO_OWNER just untags it)
+     * Returns false if the owner index is out of memory
+     */
+    bool set_owner(Order* order, OwnerId owner) {
+        if (order->owner() == owner) return true;
+        
+        if (order->has_owner()) {
+            unlink_owner(order);
+        }
+        if (owner == NO_OWNER) return true;
+        
+        bool inserted;
+        Order** head = owner_heads_.find_or_insert(owner, inserted);
+        if (MX_UNLIKELY(head == nullptr)) return false;
+        
+        OrderCold* cold = order->cold();
+        cold->owner_prev = nullptr;
+        cold->owner_next = inserted ? nullptr : *head;
+        if (cold->owner_next) {
+            cold->owner_next->cold()->owner_prev = order;
+        }
+        *head = order;
+        order->set_owner(owner);
+        return true;
+    }
+    
+    /**
+     * Newest live order of an owner (follow Order::next_owned), or nullptr
+     */
+    Order* owner_head(OwnerId owner) const {
+        Order* const* head = owner_heads_.find(owner);
+        return head ? *head : nullptr;
+    }
+    
+    size_t owner_count() const { return owner_heads_.size(); }
+    
     /* ========================================================================
      * Statistics
      * ===================================================================== */
@@ -209,6 +266,8 @@ public:
      */
     void clear() {
         // Destroy all orders
+        expiry_queue_.clear();
+        owner_heads_.clear();
         for (auto& pair : order_lookup_) {
             pool_.destroy(pair.second);
         }
@@ -223,6 +282,16 @@ public:
         order_lookup_.reserve(count);
     }
     
+    /**
+     * Earliest-expiring live order if it is due, else nullptr
+     * Destroying it makes the next one visible - O(log n) per expiry
+     */
+    Order* next_expired_order(Timestamp current_time) const {
+        return expiry_queue_.next_due(current_time);
+    }
+    
+    size_t scheduled_order_count() const { return expiry_queue_.size(); }
+    
     /**
      * Find and collect expired orders
      * Returns list of expired order IDs
@@ -231,13 +300,10 @@ public:
     size_t find_expired_orders(Timestamp current_time, OutputIterator out) const {
         size_t count = 0;
         
-        for (const auto& pair : order_lookup_) {
-            Order* order = pair.second;
-            if (order->is_expired(current_time)) {
-                *out++ = order->order_id();
-                ++count;
-            }
-        }
+        expiry_queue_.for_each_due(current_time, [&out, &count](Order* order) {
+            *out++ = order->order_id();
+            ++count;
+        });
         
         return count;
     }
@@ -265,6 +331,55 @@ public:
         }
     }
     
+private:
+    void unlink_owner(Order* order) {
+        OrderCold* cold = order->cold();
+        if (cold->owner_prev) {
+            cold->owner_prev->cold()->owner_next = cold->owner_next;
+        } else if (cold->owner_next) {
+            *owner_heads_.find(cold->owner) = cold->owner_next;
+        } else {
+            owner_heads_.erase(cold->owner);
+        }
+        if (cold->owner_next) {
+            cold->owner_next->cold()->owner_prev = cold->owner_prev;
+        }
+        cold->owner_prev = nullptr;
+        cold->owner_next = nullptr;
+        order->set_owner(NO_OWNER);
+    }
+    
+    /**
+     * Claim the lookup slot, then construct the order into it
+     * One probe sequence covers both the duplicate check and the insert.
+     * Returns nullptr on duplicate ID or allocation failure
+     */
+    template<typename... Args>
+    Order* construct_order(OrderId id, Args&&... args) {
+        bool inserted;
+        Order** slot = order_lookup_.find_or_insert(id, inserted);
+        if (MX_UNLIKELY(!inserted)) {
+            return nullptr;
+        }
+        
+        Order* order = pool_.construct(std::forward<Args>(args)...);
+        if (MX_UNLIKELY(order == nullptr)) {
+            order_lookup_.erase(id);
+            return nullptr;
+        }
+        
+        // Register on insert so expiry passes never scan the pool
+        if (order->has_expiry() && MX_UNLIKELY(!expiry_queue_.schedule(order))) {
+            order_lookup_.erase(id);
+            pool_.destroy(order);
+            return nullptr;
+        }
+        
+        *slot = order;
+        return order;
+    }
+    
+public:
     /* ========================================================================
      * Debug
      * ===================================================================== */
@@ -0,0 +1,440 @@
+/**
+ * PriceLadder - contiguous tick-indexed storage for bounded price bands
+ * One PriceLevel slot per tick plus a two-level occupancy bitmap,
+ * so level lookup is O(1) and best-price search is a few word scans
+ */
+
+#ifndef MX_INTERNAL_CORE_PRICE_LADDER_H
+#define MX_INTERNAL_CORE_PRICE_LADDER_H
+
+#include "../common.h"
+#include "../types.h"
+#include "../allocator.h"
+#include "../utils/arena.h"
+#include "price_level.h"
+#include "volume_kernels.h"
+#include <new>
+
+namespace matchx {
+
+/* ============================================================================
+ * PriceLadder Class
+ * Owns one PriceLevel per tick in [min_price, max_price]
+ *
+ * Occupancy is tracked in two levels:
+ *   bits_[w]    - bit i set if tick (w * 64 + i) has resting orders
+ *   summary_[s] - bit j set if bits_[s * 64 + j] is non-zero
+ * A band of 262,144 ticks needs only 64 summary words, so even a
+ * worst-case scan for the next occupied tick touches a single cache line
+ *
+ * Each level sits in its own cache-line slot, so reading a level header
+ * never pulls in (or false-shares with) a neighbouring tick. A slot is
+ * constructed when its tick becomes occupied and is never read while the
+ * tick is empty, so init() writes no slots: the storage (and the zeroed
+ * bitmap and volume arrays) is only paged in as prices are used
+ *
+ * volumes_ mirrors each level's total volume as a plain array (zero for
+ * empty ticks), so cumulative depth over a price range is one SIMD scan.
+ * The book keeps it in step through add_volume() / remove_volume()
+ * ========================================================================= */
+
+class PriceLadder {
+public:
+    static constexpr uint32_t NPOS = UINT32_MAX;
+
+private:
+    struct MX_CACHE_ALIGNED LevelSlot {
+        PriceLevel level;
+        
+        explicit LevelSlot(Price price) : level(price) {}
+    };
+    
+    static_assert(sizeof(LevelSlot) == MX_CACHE_LINE_SIZE, "Ladder slots must be one cache line");
+    
+    Arena* arena_;              // Optional backing store
+    void* storage_;             // Raw allocation backing levels_
+    LevelSlot* levels_;         // num_ticks_ slots, live only where occupied
+    uint64_t* bits_;            // Leaf occupancy words
+    uint64_t* summary_;         // One bit per leaf word
+    Quantity* volumes_;         // Total volume per tick
+    const VolumeKernels* kernels_;
+    uint32_t num_ticks_;
+    uint32_t num_words_;
+    uint32_t num_summary_;
+    Price min_price_;
+    Price max_price_;
+    Price tick_size_;
+    
+    MX_IMPLEMENTS_ALLOCATORS
+
+public:
+    /* ========================================================================
+     * Constructors
+     * ===================================================================== */
+    
+    PriceLadder()
+        : arena_(nullptr)
+        , storage_(nullptr)
+        , levels_(nullptr)
+        , bits_(nullptr)
+        , summary_(nullptr)
+        , volumes_(nullptr)
+        , kernels_(&volume_kernels())
+        , num_ticks_(0)
+        , num_words_(0)
+        , num_summary_(0)
+        , min_price_(0)
+        , max_price_(0)
+        , tick_size_(1) {}
+    
+    ~PriceLadder() {
+        release();
+    }
+    
+    // Non-copyable
+    PriceLadder(const PriceLadder&) = delete;
+    PriceLadder& operator=(const PriceLadder&) = delete;
+    
+    /**
+     * Allocate the ladder for a price band, from arena if given
+     * Returns false (and stays disabled) if the band is invalid or
+     * the allocation fails
+     */
+    bool init(Price min_price, Price max_price, Price tick_size, Arena* arena = nullptr) {
+        release();
+        
+        uint32_t ticks = ladder_tick_count(min_price, max_price, tick_size);
+        if (ticks == 0) {
+            return false;
+        }
+        
+        uint32_t words = (ticks + 63) / 64;
+        uint32_t summary = (words + 63) / 64;
+        
+        arena_ = arena;
+        storage_ = mx_arena_malloc(arena_, storage_bytes(ticks));
+        bits_ = static_cast<uint64_t*>(mx_arena_calloc(arena_, words, sizeof(uint64_t)));
+        summary_ = static_cast<uint64_t*>(mx_arena_calloc(arena_, summary, sizeof(uint64_t)));
+        volumes_ = static_cast<Quantity*>(mx_arena_calloc(arena_, ticks, sizeof(Quantity)));
+        
+        if (!storage_ || !bits_ || !summary_ || !volumes_) {
+            mx_arena_free(arena_, storage_, storage_bytes(ticks));
+            mx_arena_free(arena_, bits_, sizeof(uint64_t) * words);
+            mx_arena_free(arena_, summary_, sizeof(uint64_t) * summary);
+            mx_arena_free(arena_, volumes_, sizeof(Quantity) * ticks);
+            storage_ = nullptr;
+            bits_ = nullptr;
+            summary_ = nullptr;
+            volumes_ = nullptr;
+            return false;
+        }
+        
+        uintptr_t base = reinterpret_cast<uintptr_t>(storage_);
+        base = (base + MX_CACHE_LINE_SIZE - 1) & ~static_cast<uintptr_t>(MX_CACHE_LINE_SIZE - 1);
+        levels_ = reinterpret_cast<LevelSlot*>(base);
+        
+        num_ticks_ = ticks;
+        num_words_ = words;
+        num_summary_ = summary;
+        min_price_ = min_price;
+        max_price_ = min_price + (ticks - 1) * tick_size;
+        tick_size_ = tick_size;
+        return true;
+    }
+    
+    /**
+     * Add the arena blocks init() takes for a price band to plan
+     * (none if the band is invalid)
+     */
+    static void footprint(Price min_price, Price max_price, Price tick_size, ArenaPlan& plan) {
+        uint32_t ticks = ladder_tick_count(min_price, max_price, tick_size);
+        if (ticks == 0) return;
+        
+        uint32_t words = (ticks + 63) / 64;
+        uint32_t summary = (words + 63) / 64;
+        plan.add(storage_bytes(ticks));
+        plan.add(sizeof(uint64_t) * words);
+        plan.add(sizeof(uint64_t) * summary);
+        plan.add(sizeof(Quantity) * ticks);
+    }
+    
+    /* ========================================================================
+     * Getters
+     * ===================================================================== */
+    
+    bool enabled() const { return levels_ != nullptr; }
+    uint32_t num_ticks() const { return num_ticks_; }
+    Price min_price() const { return min_price_; }
+    Price max_price() const { return max_price_; }
+    Price tick_size() const { return tick_size_; }
+    
+    /**
+     * Check that a price lies inside the band and on a tick boundary
+     */
+    bool contains(Price price) const {
+        if (price < min_price_ || price > max_price_) return false;
+        return tick_size_ == 1 || (price - min_price_) % tick_size_ == 0;
+    }
+    
+    MX_FORCE_INLINE uint32_t index_of(Price price) const {
+        MX_ASSERT(contains(price));
+        return (tick_size_ == 1) ? (price - min_price_)
+                                 : (price - min_price_) / tick_size_;
+    }
+    
+    /**
+     * Level of an occupied tick
+     */
+    MX_FORCE_INLINE PriceLevel* level_at(uint32_t index) const {
+        MX_ASSERT(index < num_ticks_ && test(index));
+        return &levels_[index].level;
+    }
+    
+    /**
+     * Index of the highest tick at or below price (price >= min_price)
+     */
+    uint32_t floor_index(Price price) const {
+        MX_ASSERT(price >= min_price_);
+        if (price >= max_price_) return num_ticks_ - 1;
+        return (price - min_price_) / tick_size_;
+    }
+    
+    /**
+     * Index of the lowest tick at or above price (price <= max_price)
+     */
+    uint32_t ceil_index(Price price) const {
+        MX_ASSERT(price <= max_price_);
+        if (price <= min_price_) return 0;
+        return static_cast<uint32_t>((static_cast<uint64_t>(price - min_price_) + tick_size_ - 1) / tick_size_);
+    }
+    
+    /* ========================================================================
+     * Occupancy
+     * ===================================================================== */
+    
+    MX_FORCE_INLINE bool test(uint32_t index) const {
+        return (bits_[index >> 6] >> (index & 63)) & 1;
+    }
+    
+    MX_FORCE_INLINE void set(uint32_t index) {
+        uint32_t word = index >> 6;
+        bits_[word] |= (1ULL << (index & 63));
+        summary_[word >> 6] |= (1ULL << (word & 63));
+    }
+    
+    /**
+     * Mark an empty tick occupied and construct its (empty) level
+     */
+    MX_FORCE_INLINE PriceLevel* occupy(uint32_t index) {
+        MX_ASSERT(index < num_ticks_ && !test(index));
+        set(index);
+        return &(new (&levels_[index]) LevelSlot(min_price_ + index * tick_size_))->level;
+    }
+    
+    MX_FORCE_INLINE void reset(uint32_t index) {
+        uint32_t word = index >> 6;
+        bits_[word] &= ~(1ULL << (index & 63));
+        if (bits_[word] == 0) {
+            summary_[word >> 6] &= ~(1ULL << (word & 63));
+        }
+    }
+    
+    /**
+     * Lowest occupied tick, or NPOS
+     */
+    uint32_t find_lowest() const {
+        for (uint32_t s = 0; s < num_summary_; ++s) {
+            if (summary_[s]) {
+                uint32_t word = (s << 6) + mx_ctz64(summary_[s]);
+                return (word << 6) + mx_ctz64(bits_[word]);
+            }
+        }
+        return NPOS;
+    }
+    
+    /**
+     * Highest occupied tick, or NPOS
+     */
+    uint32_t find_highest() const {
+        for (uint32_t s = num_summary_; s-- > 0; ) {
+            if (summary_[s]) {
+                uint32_t word = (s << 6) + mx_msb64(summary_[s]);
+                return (word << 6) + mx_msb64(bits_[word]);
+            }
+        }
+        return NPOS;
+    }
+    
+    /**
+     * Next occupied tick strictly above index, or NPOS
+     */
+    uint32_t find_next_above(uint32_t index) const {
+        uint32_t next = index + 1;
+        if (next >= num_ticks_) return NPOS;
+        
+        uint32_t word = next >> 6;
+        uint64_t mask = bits_[word] & (~0ULL << (next & 63));
+        if (mask) {
+            return (word << 6) + mx_ctz64(mask);
+        }
+        
+        uint32_t next_word = word + 1;
+        if (next_word >= num_words_) return NPOS;
+        
+        uint32_t s = next_word >> 6;
+        uint64_t summary = summary_[s] & (~0ULL << (next_word & 63));
+        for (;;) {
+            if (summary) {
+                uint32_t w = (s << 6) + mx_ctz64(summary);
+                return (w << 6) + mx_ctz64(bits_[w]);
+            }
+            if (++s >= num_summary_) return NPOS;
+            summary = summary_[s];
+        }
+    }
+    
+    /**
+     * Next occupied tick strictly below index, or NPOS
+     */
+    uint32_t find_next_below(uint32_t index) const {
+        if (index == 0) return NPOS;
+        
+        uint32_t prev = index - 1;
+        uint32_t word = prev >> 6;
+        uint64_t mask = bits_[word] & (~0ULL >> (63 - (prev & 63)));
+        if (mask) {
+            return (word << 6) + mx_msb64(mask);
+        }
+        
+        if (word == 0) return NPOS;
+        
+        uint32_t prev_word = word - 1;
+        uint32_t s = prev_word >> 6;
+        uint64_t summary = summary_[s] & (~0ULL >> (63 - (prev_word & 63)));
+        for (;;) {
+            if (summary) {
+                uint32_t w = (s << 6) + mx_msb64(summary);
+                return (w << 6) + mx_msb64(bits_[w]);
+            }
+            if (s-- == 0) return NPOS;
+            summary = summary_[s];
+        }
+    }
+    
+    /**
+     * n-th occupied tick (n >= 1) counting up from index inclusive, or NPOS
+     */
+    uint32_t select_up(uint32_t index, uint32_t n) const {
+        MX_ASSERT(n > 0);
+        uint32_t word = index >> 6;
+        uint64_t mask = bits_[word] & (~0ULL << (index & 63));
+        for (;;) {
+            uint32_t count = mx_popcount64(mask);
+            if (n <= count) {
+                while (--n) mask &= mask - 1;
+                return (word << 6) + mx_ctz64(mask);
+            }
+            n -= count;
+            uint32_t next = find_next_above((word << 6) | 63);
+            if (next == NPOS) return NPOS;
+            word = next >> 6;
+            mask = bits_[word];
+        }
+    }
+    
+    /**
+     * n-th occupied tick (n >= 1) counting down from index inclusive, or NPOS
+     */
+    uint32_t select_down(uint32_t index, uint32_t n) const {
+        MX_ASSERT(n > 0);
+        uint32_t word = index >> 6;
+        uint64_t mask = bits_[word] & (~0ULL >> (63 - (index & 63)));
+        for (;;) {
+            uint32_t count = mx_popcount64(mask);
+            if (n <= count) {
+                while (--n) mask &= ~(1ULL << mx_msb64(mask));
+                return (word << 6) + mx_msb64(mask);
+            }
+            n -= count;
+            uint32_t next = find_next_below(word << 6);
+            if (next == NPOS) return NPOS;
+            word = next >> 6;
+            mask = bits_[word];
+        }
+    }
+    
+    /* ========================================================================
+     * Volume Vector
+     * ===================================================================== */
+    
+    const Quantity* volumes() const { return volumes_; }
+    const VolumeKernels& kernels() const { return *kernels_; }
+    
+    MX_FORCE_INLINE void add_volume(uint32_t index, Quantity quantity) {
+        MX_ASSERT(index < num_ticks_);
+        volumes_[index] += quantity;
+    }
+    
+    MX_FORCE_INLINE void remove_volume(uint32_t index, Quantity quantity) {
+        MX_ASSERT(index < num_ticks_ && volumes_[index] >= quantity);
+        volumes_[index] -= quantity;
+    }
+    
+    /**
+     * Total volume of ticks [first, last]
+     */
+    uint64_t sum_volume(uint32_t first, uint32_t last) const {
+        MX_ASSERT(first <= last && last < num_ticks_);
+        return kernels_->sum(volumes_ + first, last - first + 1);
+    }
+    
+    /**
+     * Empty every occupied level and clear the bitmap
+     * Orders are owned by OrderPool - only the level links are dropped
+     */
+    void clear() {
+        if (!enabled()) return;
+        
+        for (uint32_t w = 0; w < num_words_; ++w) {
+            uint64_t word = bits_[w];
+            while (word) {
+                uint32_t index = (w << 6) + mx_ctz64(word);
+                levels_[index].level.reset();
+                volumes_[index] = 0;
+                word &= word - 1;
+            }
+            bits_[w] = 0;
+        }
+        std::memset(summary_, 0, sizeof(uint64_t) * num_summary_);
+    }
+    
+    /**
+     * Free the ladder storage and go back to disabled
+     */
+    void release() {
+        clear();
+        mx_arena_free(arena_, storage_, storage_bytes(num_ticks_));
+        mx_arena_free(arena_, bits_, sizeof(uint64_t) * num_words_);
+        mx_arena_free(arena_, summary_, sizeof(uint64_t) * num_summary_);
+        mx_arena_free(arena_, volumes_, sizeof(Quantity) * num_ticks_);
+        arena_ = nullptr;
+        storage_ = nullptr;
+        levels_ = nullptr;
+        bits_ = nullptr;
+        summary_ = nullptr;
+        volumes_ = nullptr;
+        num_ticks_ = 0;
+        num_words_ = 0;
+        num_summary_ = 0;
+    }
+
+private:
+    // Over-allocate so the slots can start on a cache line
+    static size_t storage_bytes(uint32_t ticks) {
+        return sizeof(LevelSlot) * ticks + MX_CACHE_LINE_SIZE;
+    }
+};
+
+} // namespace matchx
+
+#endif // MX_INTERNAL_CORE_PRICE_LADDER_H
@@ -16,12 +16,15 @@ namespace matchx {
 /* ============================================================================
  * PriceLevel Class
  * Represents all orders at a specific price level
+ *
+ * Members are ordered to avoid interior padding so the header fits in a
+ * single cache line; PriceLadder gives each level its own line
  * ========================================================================= */
 
 class PriceLevel {
 private:
-    Price price_;                           // The price for this level
     IntrusiveList<Order> orders_;          // Orders in time priority (FIFO)
+    Price price_;                           // The price for this level
     Quantity total_volume_;                // Total quantity at this level
     Quantity visible_volume_;              // Visible quantity (for depth display)
     
@@ -33,8 +36,8 @@ public:
      * ===================================================================== */
     
     explicit PriceLevel(Price price = 0)
-        : price_(price)
-        , orders_()
+        : orders_()
+        , price_(price)
         , total_volume_(0)
         , visible_volume_(0) {}
     
@@ -49,8 +52,8 @@ public:
     
     // Moveable
     PriceLevel(PriceLevel&& other) noexcept
-        : price_(other.price_)
-        , orders_(std::move(other.orders_))
+        : orders_(std::move(other.orders_))
+        , price_(other.price_)
         , total_volume_(other.total_volume_)
         , visible_volume_(other.visible_volume_) {
         
@@ -93,7 +96,8 @@ public:
      */
     void add_order(Order* order) {
         MX_ASSERT(order != nullptr);
-        MX_ASSERT(order->price() == price_);
+        MX_ASSERT(order->price() == price_ ||
+                  (order->is_stop() && order->stop_price() == price_)); // Stop index keys on stop price
         MX_ASSERT(!order->is_linked()); // Order must not be in another list
         
         orders_.push_back(order);
@@ -113,6 +117,15 @@ public:
         orders_.remove(order);
     }
     
+    /**
+     * Drop all orders and volumes (orders themselves are owned by OrderPool)
+     */
+    void reset() {
+        orders_.clear();
+        total_volume_ = 0;
+        visible_volume_ = 0;
+    }
+    
     /**
      * Update volume after an order is partially filled
      * Call this after modifying order quantity
@@ -161,14 +174,16 @@ public:
      * Match against orders at this level
      * Returns total quantity matched
      * 
+     * Passive orders are unlinked from the level before on_fill runs, so
+     * the callback owns a fully filled passive order and may destroy it.
+     * 
      * @param aggressive_order  The incoming order
      * @param max_quantity      Maximum quantity to match
-     * @param on_trade          Callback for each trade
-     * @param timestamp         Current timestamp
+     * @param on_fill           Called as on_fill(Order* passive, Price, Quantity)
      */
-    template<typename TradeCallback>
-    Quantity match_orders(Order* aggressive_order, Quantity max_quantity,
-                         TradeCallback on_trade, Timestamp timestamp) {
+    template<typename FillCallback>
+    MX_FORCE_INLINE Quantity match_orders(Order* aggressive_order, Quantity max_quantity,
+                                          FillCallback&& on_fill) {
         Quantity total_matched = 0;
         
         while (total_matched < max_quantity && !orders_.empty()) {
@@ -179,9 +194,6 @@ public:
             Quantity passive_remaining = passive_order->remaining_quantity();
             Quantity match_qty = MX_MIN(aggressive_remaining, passive_remaining);
             
-            // Execute the trade
-            Price execution_price = passive_order->price();
-            
             // Fill both orders
             aggressive_order->fill(match_qty);
             passive_order->fill(match_qty);
@@ -190,8 +202,6 @@ public:
             total_volume_ -= match_qty;
             visible_volume_ -= MX_MIN(match_qty, passive_order->visible_quantity());
             
-            on_trade(aggressive_order->order_id(), passive_order->order_id(), execution_price, match_qty, timestamp);
-
             // Remove passive order if fully filled
             if (passive_order->is_filled()) {
                 orders_.pop_front();
@@ -207,6 +217,9 @@ public:
             
             total_matched += match_qty;
             
+            // Last use of passive_order - callback may retire it
+            on_fill(passive_order, price_, match_qty);
+            
             // Stop if aggressive order is filled
             if (aggressive_order->is_filled()) {
                 break;
@@ -230,16 +243,8 @@ public:
      * Returns quantity that can be filled immediately
      */
     Quantity calculate_fok_fill(Quantity quantity) const {
-        Quantity available = 0;
-        
-        for (Order* order : orders_) {
-            available += order->remaining_quantity();
-            if (available >= quantity) {
-                return quantity; // Can fill completely
-            }
-        }
-        
-        return 0; // Cannot fill completely, so FOK would be rejected
+        // total_volume_ already sums every order's remaining quantity
+        return (total_volume_ >= quantity) ? quantity : 0;
     }
     
     /* ========================================================================
@@ -307,6 +312,8 @@ public:
 #endif
 };
 
+static_assert(sizeof(PriceLevel) <= MX_CACHE_LINE_SIZE, "PriceLevel must fit in one cache line");
+
 } // namespace matchx
 
 #endif // MX_INTERNAL_CORE_PRICE_LEVEL_H
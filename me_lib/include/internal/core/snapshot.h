@@ -0,0 +1,90 @@
+/**
+ * Snapshot - on-disk layout of a saved order book
+ * Plain little-endian records with no pointers, so a file can be mapped
+ * at any address and read in place
+ */
+
+#ifndef MX_INTERNAL_CORE_SNAPSHOT_H
+#define MX_INTERNAL_CORE_SNAPSHOT_H
+
+#include "../common.h"
+#include "../types.h"
+
+namespace matchx {
+namespace snapshot {
+
+/* ============================================================================
+ * File Layout
+ *
+ *   FileHeader
+ *   OrderRecord x bid_orders        bid levels best first, FIFO within a level
+ *   OrderRecord x ask_orders        ask levels best first, FIFO within a level
+ *   OrderRecord x buy_stop_orders   buy stop levels in trigger order, FIFO
+ *   OrderRecord x sell_stop_orders  sell stop levels in trigger order, FIFO
+ *
+ * Appending the records back in file order rebuilds every queue with
+ * its original time priority
+ * ========================================================================= */
+
+static constexpr uint32_t MAGIC = 0x4E53584D;     // "MXSN" read little-endian
+static constexpr uint16_t VERSION = 1;
+
+struct FileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;          // sizeof(FileHeader) when written
+    uint32_t record_size;          // sizeof(OrderRecord) when written
+    uint32_t reserved;
+    uint64_t bid_orders;
+    uint64_t ask_orders;
+    uint64_t buy_stop_orders;
+    uint64_t sell_stop_orders;
+    uint64_t total_trades;
+    uint64_t total_volume;
+    uint64_t saved_timestamp;      // Context time at save
+    uint64_t checksum;             // checksum() over all records
+    char symbol[32];               // Informational, NUL padded
+};
+
+struct OrderRecord {
+    uint64_t order_id;
+    uint64_t created_time;
+    uint64_t expire_time;
+    uint32_t price;
+    uint32_t stop_price;
+    uint32_t total_quantity;
+    uint32_t filled_quantity;
+    uint32_t display_quantity;
+    uint32_t visible_filled;
+    uint32_t flags;
+    uint8_t side;
+    uint8_t order_type;
+    uint8_t state;                 // OrderState
+    uint8_t time_in_force;
+    uint64_t owner;                // 0 = untagged (zero in files predating owners)
+};
+
+static_assert(sizeof(FileHeader) == 112, "Snapshot header layout changed - bump VERSION");
+static_assert(sizeof(OrderRecord) == 64, "Snapshot record layout changed - bump VERSION");
+
+/**
+ * Word-at-a-time checksum of the record area
+ * Cheap enough to verify multi-million-order files on load
+ */
+inline uint64_t checksum(const OrderRecord* records, uint64_t count, uint64_t seed) {
+    const uint64_t* words = reinterpret_cast<const uint64_t*>(records);
+    uint64_t n = count * (sizeof(OrderRecord) / sizeof(uint64_t));
+    uint64_t h = seed;
+    for (uint64_t i = 0; i < n; ++i) {
+        h = (h ^ words[i]) * 0x100000001B3ULL;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+static constexpr uint64_t CHECKSUM_SEED = 0xCBF29CE484222325ULL;
+
+} // namespace snapshot
+} // namespace matchx
+
+#endif // MX_INTERNAL_CORE_SNAPSHOT_H
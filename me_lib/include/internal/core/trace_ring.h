@@ -0,0 +1,177 @@
+/**
+ * TraceRing - per-context flight recorder of binary trace records
+ * Trace points only exist in builds with MX_TRACE defined; elsewhere
+ * MX_TRACE_POINT expands to nothing and its arguments are not evaluated
+ */
+
+#ifndef MX_INTERNAL_CORE_TRACE_RING_H
+#define MX_INTERNAL_CORE_TRACE_RING_H
+
+#include "../common.h"
+#include "../types.h"
+#include "../allocator.h"
+
+namespace matchx {
+
+/* ============================================================================
+ * Trace Points
+ * MX_TRACE_POINT(context, point, order_id, side, price, quantity, count)
+ * records one mx_trace_record_t stamped with the context's current time
+ * (the call's clock reading - tracing never reads a clock itself)
+ * ========================================================================= */
+
+#ifdef MX_TRACE
+    #define MX_TRACE_POINT(ctx, point, order_id, side, price, quantity, count) \
+        (ctx)->trace((point), (order_id), (side), (price), (quantity), (count))
+#else
+    #define MX_TRACE_POINT(ctx, point, order_id, side, price, quantity, count) ((void)0)
+#endif
+
+/* ============================================================================
+ * TraceRing Class
+ * Power-of-two ring of mx_trace_record_t indexed by free-running counters
+ *
+ * Unlike EventRing it never grows. With a sink, a full ring is handed to
+ * the sink before the next record is written; without one the
+ * oldest record is overwritten, so the ring always holds the latest
+ * history for a dump after the fact
+ * ========================================================================= */
+
+class TraceRing {
+private:
+    mx_trace_record_t* records_;
+    uint32_t mask_;             // capacity - 1
+    uint32_t head_;             // Oldest unread record
+    uint32_t tail_;             // Next slot to write
+    uint64_t overwritten_;      // Records lost to wraparound (no sink)
+    mx_trace_sink_t sink_;
+    void* user_data_;
+
+    MX_IMPLEMENTS_ALLOCATORS
+
+public:
+    /* ========================================================================
+     * Constructors
+     * ===================================================================== */
+
+    TraceRing()
+        : records_(nullptr), mask_(0), head_(0), tail_(0), overwritten_(0)
+        , sink_(nullptr), user_data_(nullptr) {}
+
+    ~TraceRing() {
+        mx_free(records_);
+    }
+
+    // Non-copyable
+    TraceRing(const TraceRing&) = delete;
+    TraceRing& operator=(const TraceRing&) = delete;
+
+    /**
+     * Allocate room for at least capacity records (0 disables tracing)
+     * Pending records are discarded. Returns false on allocation failure,
+     * leaving tracing disabled
+     */
+    bool init(uint32_t capacity, mx_trace_sink_t sink, void* user_data) {
+        mx_free(records_);
+        records_ = nullptr;
+        mask_ = 0;
+        head_ = 0;
+        tail_ = 0;
+        overwritten_ = 0;
+        sink_ = sink;
+        user_data_ = user_data;
+        if (capacity == 0) return true;
+
+        uint32_t size = 16;
+        while (size < capacity && size < (1u << 31)) size <<= 1;
+
+        records_ = static_cast<mx_trace_record_t*>(mx_malloc(sizeof(mx_trace_record_t) * size));
+        if (!records_) return false;
+        mask_ = size - 1;
+        return true;
+    }
+
+    /* ========================================================================
+     * Getters
+     * ===================================================================== */
+
+    bool enabled() const { return records_ != nullptr; }
+    uint32_t size() const { return tail_ - head_; }
+    uint32_t capacity() const { return records_ ? mask_ + 1 : 0; }
+    uint64_t overwritten() const { return overwritten_; }
+
+    /* ========================================================================
+     * Producer
+     * ===================================================================== */
+
+    MX_FORCE_INLINE void push(uint16_t point, OrderId order_id, Side side,
+                              Price price, Quantity quantity, uint32_t count,
+                              Timestamp timestamp) {
+        if (MX_UNLIKELY(size() > mask_)) {
+            if (sink_) {
+                flush();
+            } else {
+                ++head_;
+                ++overwritten_;
+            }
+        }
+
+        mx_trace_record_t* record = &records_[tail_++ & mask_];
+        record->timestamp = timestamp;
+        record->order_id = order_id;
+        record->point = point;
+        record->side = static_cast<uint16_t>(side);
+        record->price = price;
+        record->quantity = quantity;
+        record->count = count;
+    }
+
+    /* ========================================================================
+     * Consumer
+     * ===================================================================== */
+
+    /**
+     * Copy up to max records (oldest first) into out and release them
+     * Returns the number copied
+     */
+    uint32_t read(mx_trace_record_t* out, uint32_t max) {
+        uint32_t count = size();
+        if (count > max) count = max;
+        if (count == 0) return 0;
+
+        // At most two contiguous runs: up to the end of storage, then from the start
+        uint32_t start = head_ & mask_;
+        uint32_t first = mask_ + 1 - start;
+        if (first > count) first = count;
+
+        std::memcpy(out, records_ + start, sizeof(mx_trace_record_t) * first);
+        std::memcpy(out + first, records_, sizeof(mx_trace_record_t) * (count - first));
+
+        head_ += count;
+        return count;
+    }
+
+    /**
+     * Hand every pending record to the sink, in at most two calls
+     * Returns the number handed over (0 without a sink)
+     */
+    uint32_t flush() {
+        uint32_t count = size();
+        if (!sink_ || count == 0) return 0;
+
+        uint32_t start = head_ & mask_;
+        uint32_t first = mask_ + 1 - start;
+        if (first > count) first = count;
+
+        head_ += count;
+        sink_(records_ + start, first, user_data_);
+        if (count > first) {
+            sink_(records_, count - first, user_data_);
+        }
+        return count;
+    }
+};
+
+} // namespace matchx
+
+#endif // MX_INTERNAL_CORE_TRACE_RING_H
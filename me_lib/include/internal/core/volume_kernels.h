@@ -0,0 +1,53 @@
+/**
+ * VolumeKernels - sums and threshold searches over a per-tick volume vector
+ * PriceLadder keeps one Quantity per tick beside its levels, so depth and
+ * FOK/AON checks become contiguous scans instead of level-by-level walks
+ */
+
+#ifndef MX_INTERNAL_CORE_VOLUME_KERNELS_H
+#define MX_INTERNAL_CORE_VOLUME_KERNELS_H
+
+#include "../common.h"
+
+namespace matchx {
+
+/* ============================================================================
+ * VolumeKernels
+ * One table per instruction set; volume_kernels() picks the widest the CPU
+ * supports (AVX-512, AVX2, else scalar) on first use. Every kernel returns
+ * exactly what the scalar version would
+ *
+ * Define MX_NO_SIMD to build the scalar kernels only
+ * ========================================================================= */
+
+struct VolumeKernels {
+    const char* name;
+    
+    /**
+     * Sum of volumes[0, count)
+     */
+    uint64_t (*sum)(const Quantity* volumes, uint32_t count);
+    
+    /**
+     * Sum volumes[0], volumes[1], ... until the running total reaches
+     * threshold. Returns the index that reached it, or count if none did;
+     * cumulative receives the running total at that point
+     */
+    uint32_t (*scan_up)(const Quantity* volumes, uint32_t count,
+                        uint64_t threshold, uint64_t& cumulative);
+    
+    /**
+     * As scan_up, summing from volumes[count - 1] down to volumes[0]
+     */
+    uint32_t (*scan_down)(const Quantity* volumes, uint32_t count,
+                          uint64_t threshold, uint64_t& cumulative);
+};
+
+/**
+ * Kernels for this CPU (selected once, thread-safe)
+ */
+const VolumeKernels& volume_kernels();
+
+} // namespace matchx
+
+#endif // MX_INTERNAL_CORE_VOLUME_KERNELS_H
@@ -179,6 +179,19 @@ struct CallbackContext {
  * Configuration
  * ========================================================================= */
 
+/* Largest band the array-based price ladder will allocate */
+constexpr uint32_t MAX_LADDER_TICKS = 1u << 24;
+
+/**
+ * Number of ticks in [min_price, max_price] at tick_size,
+ * or 0 if the band is invalid or too wide for a ladder
+ */
+inline uint32_t ladder_tick_count(Price min_price, Price max_price, Price tick_size) {
+    if (tick_size == 0 || min_price > max_price) return 0;
+    uint64_t ticks = static_cast<uint64_t>(max_price - min_price) / tick_size + 1;
+    return (ticks <= MAX_LADDER_TICKS) ? static_cast<uint32_t>(ticks) : 0;
+}
+
 struct OrderBookConfig {
     // Price bounds (for array-based price levels)
     Price min_price;
@@ -188,6 +201,17 @@ struct OrderBookConfig {
     // Capacity hints
     uint32_t expected_max_orders;
     uint32_t expected_price_levels;
+    uint32_t arena_flags;           // mx_arena_flags_t (0 = mx_malloc)
+    
+    // Buffered events (0 = deliver through callbacks)
+    uint32_t event_buffer_capacity;
+    
+    // Per-operation latency histograms
+    bool track_latency;
+    
+    // Seqlock-published summary for other threads
+    bool publish_view;
+    uint32_t view_levels;
     
     // Features
     bool enable_stop_orders;
@@ -200,9 +224,22 @@ struct OrderBookConfig {
         , tick_size(1)
         , expected_max_orders(10000)
         , expected_price_levels(1000)
+        , arena_flags(MX_ARENA_NONE)
+        , event_buffer_capacity(0)
+        , track_latency(false)
+        , publish_view(false)
+        , view_levels(0)
         , enable_stop_orders(true)
         , enable_iceberg_orders(true)
         , enable_time_expiry(true) {}
+    
+    /**
+     * Price bands are opt-in: the defaults cover the whole Price range,
+     * which is far too wide for a ladder, so books fall back to std::map
+     */
+    bool has_price_bounds() const {
+        return ladder_tick_count(min_price, max_price, tick_size) != 0;
+    }
 };
 
 } // namespace matchx
@@ -0,0 +1,224 @@
+/**
+ * Arena - per-context memory reserved straight from the OS
+ * Backs order pools, order ID indexes and ladder levels so books that
+ * stay within their capacity hints never call malloc or page-fault
+ */
+
+#ifndef MX_INTERNAL_UTILS_ARENA_H
+#define MX_INTERNAL_UTILS_ARENA_H
+
+#include "../common.h"
+#include "../allocator.h"
+
+namespace matchx {
+
+/* ============================================================================
+ * ArenaPlan
+ * Sizes of the blocks a component is about to request, in order
+ * ========================================================================= */
+
+struct ArenaPlan {
+    static constexpr uint32_t MAX_BLOCKS = 32;
+    
+    size_t blocks[MAX_BLOCKS];
+    uint32_t count;
+    
+    ArenaPlan() : count(0) {}
+    
+    void add(size_t bytes) {
+        MX_ASSERT(count < MAX_BLOCKS);
+        if (count < MAX_BLOCKS) blocks[count++] = bytes;
+    }
+};
+
+/* ============================================================================
+ * Arena Class
+ * Chain of anonymous mappings carved out by a bump pointer
+ *
+ * Every block is MX_CACHE_LINE_SIZE aligned and rounded to whole lines.
+ * Released blocks go on a free list and are handed back to the next
+ * request of the same size, which is how a book created after another
+ * of the same shape reuses its storage. Mappings are only returned to
+ * the OS when the arena is destroyed
+ * ========================================================================= */
+
+class Arena {
+private:
+    struct Region {
+        Region* next;
+        char* base;             // First usable byte (after this header)
+        size_t size;            // Usable bytes
+        size_t used;            // Bump offset from base
+        size_t mapped_size;     // Length passed to the OS
+        bool huge;              // Backed by MAP_HUGETLB
+    };
+    
+    struct FreeBlock {
+        FreeBlock* next;
+        size_t size;
+    };
+    
+    Region* regions_;           // Newest first; only the head is bumped
+    FreeBlock* free_blocks_;
+    uint32_t flags_;            // mx_arena_flags_t
+    size_t reserved_bytes_;
+    size_t used_bytes_;
+    size_t huge_bytes_;
+    uint32_t region_count_;
+    
+    MX_IMPLEMENTS_ALLOCATORS
+
+public:
+    static constexpr uint32_t VALID_FLAGS = MX_ARENA_ENABLE | MX_ARENA_HUGE_PAGES |
+                                             MX_ARENA_PREFAULT | MX_ARENA_NUMA_LOCAL;
+    
+    /* ========================================================================
+     * Constructors
+     * ===================================================================== */
+    
+    Arena()
+        : regions_(nullptr)
+        , free_blocks_(nullptr)
+        , flags_(MX_ARENA_NONE)
+        , reserved_bytes_(0)
+        , used_bytes_(0)
+        , huge_bytes_(0)
+        , region_count_(0) {}
+    
+    ~Arena() {
+        release();
+    }
+    
+    // Non-copyable
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    
+    /**
+     * Options for regions mapped from now on (existing ones keep theirs)
+     */
+    void set_flags(uint32_t flags) { flags_ = flags; }
+    
+    /* ========================================================================
+     * Getters
+     * ===================================================================== */
+    
+    uint32_t flags() const { return flags_; }
+    bool enabled() const { return flags_ != MX_ARENA_NONE; }
+    size_t reserved_bytes() const { return reserved_bytes_; }
+    size_t used_bytes() const { return used_bytes_; }
+    size_t huge_page_bytes() const { return huge_bytes_; }
+    uint32_t region_count() const { return region_count_; }
+    
+    /**
+     * Bytes a request of this size really takes (whole cache lines)
+     */
+    static size_t block_size(size_t bytes) {
+        return (bytes + MX_CACHE_LINE_SIZE - 1) & ~static_cast<size_t>(MX_CACHE_LINE_SIZE - 1);
+    }
+    
+    /**
+     * Whether ptr points into one of this arena's mappings
+     */
+    bool owns(const void* ptr) const {
+        const char* p = static_cast<const char*>(ptr);
+        for (const Region* region = regions_; region; region = region->next) {
+            if (p >= region->base && p < region->base + region->size) return true;
+        }
+        return false;
+    }
+    
+    /* ========================================================================
+     * Allocation
+     * ===================================================================== */
+    
+    /**
+     * Make sure the planned blocks can be served without mapping piecemeal
+     * Blocks the free list holds at their exact size are counted as
+     * served; unless the current region has room for the rest, one region
+     * is mapped (and pre-faulted) for them
+     * Returns false if the OS refused the mapping
+     */
+    bool reserve(const ArenaPlan& plan);
+    
+    /**
+     * Cache-line-aligned block of at least bytes
+     * Maps a new region when the current one is exhausted; returns
+     * nullptr only if that fails
+     */
+    void* allocate(size_t bytes);
+    
+    /**
+     * As allocate(), zero-filled
+     * Fresh region memory is zero already and is left untouched, so its
+     * pages are only faulted in when first written; a reused block is
+     * cleared
+     */
+    void* allocate_zeroed(size_t bytes);
+    
+    /**
+     * Return a block from allocate() for reuse (bytes as requested)
+     */
+    void deallocate(void* ptr, size_t bytes) {
+        if (!ptr) return;
+        MX_ASSERT(owns(ptr));
+        
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        block->size = block_size(bytes);
+        block->next = free_blocks_;
+        free_blocks_ = block;
+        used_bytes_ -= block->size;
+    }
+    
+    /**
+     * Unmap everything (no blocks may still be in use)
+     */
+    void release();
+
+private:
+    bool map_region(size_t bytes);
+    
+    void* take_free_block(size_t size) {
+        for (FreeBlock** link = &free_blocks_; *link; link = &(*link)->next) {
+            if ((*link)->size == size) {
+                FreeBlock* block = *link;
+                *link = block->next;
+                used_bytes_ += size;
+                return block;
+            }
+        }
+        return nullptr;
+    }
+};
+
+/* ============================================================================
+ * Arena-or-Heap Helpers
+ * Components take an optional Arena* and fall back to mx_malloc without one
+ * ========================================================================= */
+
+inline void* mx_arena_malloc(Arena* arena, size_t size) {
+    if (arena) {
+        void* ptr = arena->allocate(size);
+        if (ptr) return ptr;
+    }
+    return mx_malloc(size);
+}
+
+inline void* mx_arena_calloc(Arena* arena, size_t count, size_t size) {
+    if (arena) {
+        void* ptr = arena->allocate_zeroed(count * size);
+        if (ptr) return ptr;
+    }
+    return mx_calloc(count, size);
+}
+
+inline void mx_arena_free(Arena* arena, void* ptr, size_t size) {
+    if (arena && ptr && arena->owns(ptr)) {
+        arena->deallocate(ptr, size);
+    } else {
+        mx_free(ptr);
+    }
+}
+
+} // namespace matchx
+
+#endif // MX_INTERNAL_UTILS_ARENA_H
@@ -6,7 +6,9 @@
 #define MX_INTERNAL_UTILS_HASH_MAP_H
 
 #include "../common.h"
+#include "../allocator.h"
 #include "memory_pool.h"
+#include "arena.h"
 #include <unordered_map>
 #include <functional>
 
@@ -137,13 +139,249 @@ public:
     void max_load_factor(float ml) { map_.max_load_factor(ml); }
 };
 
-/* Specialized typedefs */
+/* ============================================================================
+ * OrderIdMap - flat open-addressing map keyed by OrderId
+ *
+ * Slots live in one power-of-two array (no per-entry nodes), probed
+ * linearly from the hashed home slot. INVALID_ORDER_ID (0) marks an empty
+ * slot, so it can never be used as a key. Erase uses backward-shift
+ * deletion: later entries of the probe run are pulled back into the hole,
+ * so there are no tombstones and lookups never degrade with churn.
+ * Value should be small and trivially copyable (e.g. Order*).
+ * ========================================================================= */
+
 template<typename Value>
-class OrderIdMap : public HashMap<OrderId, Value, FastHash<OrderId> > {
+class OrderIdMap {
+public:
+    struct Slot {
+        OrderId first;
+        Value second;
+    };
+    
+    typedef size_t size_type;
+    
+    /* Forward iterator over occupied slots */
+    template<typename SlotType>
+    class Iterator {
+    private:
+        SlotType* slot_;
+        SlotType* end_;
+        
+        void skip_empty() {
+            while (slot_ != end_ && slot_->first == INVALID_ORDER_ID) ++slot_;
+        }
+        
+    public:
+        Iterator(SlotType* slot, SlotType* end) : slot_(slot), end_(end) { skip_empty(); }
+        
+        SlotType& operator*() const { return *slot_; }
+        SlotType* operator->() const { return slot_; }
+        
+        Iterator& operator++() {
+            ++slot_;
+            skip_empty();
+            return *this;
+        }
+        
+        bool operator==(const Iterator& other) const { return slot_ == other.slot_; }
+        bool operator!=(const Iterator& other) const { return slot_ != other.slot_; }
+    };
+    
+    typedef Iterator<Slot> iterator;
+    typedef Iterator<const Slot> const_iterator;
+    
+private:
+    Slot* slots_;
+    size_type capacity_;        // Always a power of two (or 0)
+    size_type mask_;
+    size_type size_;
+    Arena* arena_;              // Optional backing store for the slot array
+    
+    MX_IMPLEMENTS_ALLOCATORS
+    
 public:
-    OrderIdMap() : HashMap<OrderId, Value, FastHash<OrderId> >() {}
-    explicit OrderIdMap(typename HashMap<OrderId, Value, FastHash<OrderId> >::size_type n) 
-        : HashMap<OrderId, Value, FastHash<OrderId> >(n) {}
+    OrderIdMap() : slots_(nullptr), capacity_(0), mask_(0), size_(0), arena_(nullptr) {}
+    
+    explicit OrderIdMap(size_type expected, Arena* arena = nullptr) : OrderIdMap() {
+        arena_ = arena;
+        reserve(expected);
+    }
+    
+    ~OrderIdMap() {
+        mx_arena_free(arena_, slots_, sizeof(Slot) * capacity_);
+    }
+    
+    /**
+     * Add the slot array sized for expected entries to plan
+     */
+    static void footprint(size_type expected, ArenaPlan& plan) {
+        plan.add(sizeof(Slot) * capacity_for(expected));
+    }
+    
+    // Non-copyable
+    OrderIdMap(const OrderIdMap&) = delete;
+    OrderIdMap& operator=(const OrderIdMap&) = delete;
+    
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+    size_type capacity() const { return capacity_; }
+    
+    iterator begin() { return iterator(slots_, slots_ + capacity_); }
+    iterator end() { return iterator(slots_ + capacity_, slots_ + capacity_); }
+    const_iterator begin() const { return const_iterator(slots_, slots_ + capacity_); }
+    const_iterator end() const { return const_iterator(slots_ + capacity_, slots_ + capacity_); }
+    
+    /**
+     * Find the value for a key, or nullptr
+     */
+    MX_FORCE_INLINE Value* find(OrderId key) {
+        // The empty-slot key is never stored
+        if (MX_UNLIKELY(capacity_ == 0 || key == INVALID_ORDER_ID)) return nullptr;
+        
+        for (size_type i = home(key); ; i = (i + 1) & mask_) {
+            Slot& slot = slots_[i];
+            if (slot.first == key) return &slot.second;
+            if (slot.first == INVALID_ORDER_ID) return nullptr;
+        }
+    }
+    
+    MX_FORCE_INLINE const Value* find(OrderId key) const {
+        return const_cast<OrderIdMap*>(this)->find(key);
+    }
+    
+    bool contains(OrderId key) const {
+        return find(key) != nullptr;
+    }
+    
+    /**
+     * Find the slot for a key, claiming an empty one if absent
+     * Single probe sequence for check-then-insert; inserted reports
+     * whether the key is new (its value is then value-initialized).
+     * Returns nullptr only if the table is full and cannot grow
+     */
+    Value* find_or_insert(OrderId key, bool& inserted) {
+        MX_ASSERT(key != INVALID_ORDER_ID);
+        inserted = false;
+        
+        if (MX_UNLIKELY((size_ + 1) * 4 > capacity_ * 3)) {
+            // Keep at least one empty slot so probes always terminate
+            if (!grow() && size_ + 2 > capacity_) {
+                return nullptr;
+            }
+        }
+        
+        for (size_type i = home(key); ; i = (i + 1) & mask_) {
+            Slot& slot = slots_[i];
+            if (slot.first == key) {
+                return &slot.second;
+            }
+            if (slot.first == INVALID_ORDER_ID) {
+                slot.first = key;
+                slot.second = Value();
+                ++size_;
+                inserted = true;
+                return &slot.second;
+            }
+        }
+    }
+    
+    /**
+     * Insert a new key. Returns false if the key already exists
+     * (or the table is out of memory)
+     */
+    bool insert(OrderId key, const Value& value) {
+        bool inserted;
+        Value* slot = find_or_insert(key, inserted);
+        if (inserted) *slot = value;
+        return inserted;
+    }
+    
+    /**
+     * Remove a key. Returns false if it was not present
+     */
+    bool erase(OrderId key) {
+        if (MX_UNLIKELY(capacity_ == 0 || key == INVALID_ORDER_ID)) return false;
+        
+        size_type i = home(key);
+        for (;;) {
+            if (slots_[i].first == key) break;
+            if (slots_[i].first == INVALID_ORDER_ID) return false;
+            i = (i + 1) & mask_;
+        }
+        
+        // Backward-shift: pull later entries of the run into the hole
+        // unless doing so would move them before their home slot
+        size_type hole = i;
+        for (size_type j = (i + 1) & mask_; slots_[j].first != INVALID_ORDER_ID; j = (j + 1) & mask_) {
+            size_type ideal = home(slots_[j].first);
+            if (((j - ideal) & mask_) >= ((j - hole) & mask_)) {
+                slots_[hole] = slots_[j];
+                hole = j;
+            }
+        }
+        slots_[hole].first = INVALID_ORDER_ID;
+        --size_;
+        return true;
+    }
+    
+    void clear() {
+        for (size_type i = 0; i < capacity_; ++i) {
+            slots_[i].first = INVALID_ORDER_ID;
+        }
+        size_ = 0;
+    }
+    
+    /**
+     * Size the table so count entries fit without rehashing
+     */
+    void reserve(size_type count) {
+        size_type needed = capacity_for(count);
+        if (needed > capacity_) {
+            rehash(needed);
+        }
+    }
+    
+private:
+    // Smallest power of two keeping count entries under 3/4 load
+    static size_type capacity_for(size_type count) {
+        size_type needed = 16;
+        while (needed * 3 < count * 4) needed <<= 1;
+        return needed;
+    }
+    
+    MX_FORCE_INLINE size_type home(OrderId key) const {
+        return static_cast<size_type>(FastHash<OrderId>()(key)) & mask_;
+    }
+    
+    bool grow() {
+        return rehash(capacity_ ? capacity_ * 2 : 16);
+    }
+    
+    bool rehash(size_type new_capacity) {
+        Slot* old_slots = slots_;
+        size_type old_capacity = capacity_;
+        
+        Slot* new_slots = static_cast<Slot*>(mx_arena_malloc(arena_, sizeof(Slot) * new_capacity));
+        if (MX_UNLIKELY(!new_slots)) return false;
+        for (size_type i = 0; i < new_capacity; ++i) {
+            new_slots[i].first = INVALID_ORDER_ID;
+        }
+        
+        slots_ = new_slots;
+        capacity_ = new_capacity;
+        mask_ = new_capacity - 1;
+        
+        for (size_type i = 0; i < old_capacity; ++i) {
+            if (old_slots[i].first != INVALID_ORDER_ID) {
+                size_type j = home(old_slots[i].first);
+                while (slots_[j].first != INVALID_ORDER_ID) j = (j + 1) & mask_;
+                slots_[j] = old_slots[i];
+            }
+        }
+        
+        mx_arena_free(arena_, old_slots, sizeof(Slot) * old_capacity);
+        return true;
+    }
 };
 
 template<typename Value>
@@ -8,6 +8,7 @@
 #define MX_INTERNAL_UTILS_MEMORY_POOL_H
 
 #include "../common.h"
+#include "arena.h"
 #include <vector>
 #include <cstdio>
 
@@ -188,6 +189,174 @@ private:
     }
 };
 
+/* ============================================================================
+ * Split Memory Pool
+ * Pool of cache-line-aligned Hot objects, each paired for life with a
+ * Cold record in a separate array
+ *
+ * Hot objects are constructed as Hot(Cold*, args...) and must hand the
+ * pointer back through cold(). Free Hot slots remember their Cold record,
+ * so allocating and freeing never touch the cold array
+ *
+ * Chunks come from the Arena when one is given, else from mx_malloc
+ * ========================================================================= */
+
+template<typename Hot, typename Cold>
+class SplitMemoryPool {
+private:
+    struct FreeNode {
+        FreeNode* next;
+        Cold* cold;
+    };
+    
+    struct Block {
+        void* ptr;
+        size_t size;
+    };
+    
+    static_assert(sizeof(Hot) >= sizeof(FreeNode), "Hot object too small for free list");
+    
+    size_t chunk_size_;
+    size_t total_capacity_;
+    size_t allocated_count_;
+    
+    Arena* arena_;                // Optional backing store
+    std::vector<Block> blocks_;   // Raw allocations (hot and cold arrays)
+    FreeNode* free_list_head_;
+    
+    MX_IMPLEMENTS_ALLOCATORS
+
+public:
+    explicit SplitMemoryPool(size_t initial_chunk_size = 1024, Arena* arena = nullptr)
+        : chunk_size_(initial_chunk_size ? initial_chunk_size : 1)
+        , total_capacity_(0)
+        , allocated_count_(0)
+        , arena_(arena)
+        , free_list_head_(nullptr) {
+        
+        blocks_.reserve(16);
+        allocate_chunk();
+    }
+    
+    ~SplitMemoryPool() {
+        for (const Block& block : blocks_) {
+            mx_arena_free(arena_, block.ptr, block.size);
+        }
+    }
+    
+    /**
+     * Add the arena blocks one chunk of count objects takes to plan
+     */
+    static void chunk_footprint(size_t count, ArenaPlan& plan) {
+        if (count == 0) count = 1;
+        plan.add(hot_bytes(count));
+        plan.add(cold_bytes(count));
+    }
+    
+    // Non-copyable
+    SplitMemoryPool(const SplitMemoryPool&) = delete;
+    SplitMemoryPool& operator=(const SplitMemoryPool&) = delete;
+    
+    /* ========================================================================
+     * Allocation
+     * ===================================================================== */
+    
+    /**
+     * Construct a Hot object bound to its Cold record
+     * Returns nullptr if a new chunk could not be allocated
+     */
+    template<typename... Args>
+    Hot* construct(Args&&... args) {
+        if (MX_UNLIKELY(free_list_head_ == nullptr) && !allocate_chunk()) {
+            return nullptr;
+        }
+        
+        FreeNode* node = free_list_head_;
+        free_list_head_ = node->next;
+        Cold* cold = node->cold;
+        
+        ++allocated_count_;
+        return new (static_cast<void*>(node)) Hot(cold, std::forward<Args>(args)...);
+    }
+    
+    /**
+     * Destroy a Hot object and return its slot (and Cold record) to the pool
+     */
+    void destroy(Hot* ptr) {
+        if (!ptr) return;
+        
+        MX_ASSERT(allocated_count_ > 0);
+        
+        Cold* cold = ptr->cold();
+        ptr->~Hot();
+        
+        FreeNode* node = reinterpret_cast<FreeNode*>(ptr);
+        node->next = free_list_head_;
+        node->cold = cold;
+        free_list_head_ = node;
+        
+        --allocated_count_;
+    }
+    
+    /* ========================================================================
+     * Statistics
+     * ===================================================================== */
+    
+    size_t capacity() const { return total_capacity_; }
+    size_t allocated() const { return allocated_count_; }
+    size_t available() const { return total_capacity_ - allocated_count_; }
+    size_t chunk_count() const { return blocks_.size() / 2; }
+    
+    size_t memory_usage() const {
+        return total_capacity_ * (sizeof(Hot) + sizeof(Cold));
+    }
+    
+    /**
+     * Pre-allocate capacity for expected number of objects
+     */
+    void reserve(size_t count) {
+        while (total_capacity_ < count) {
+            if (!allocate_chunk()) return;
+        }
+    }
+
+private:
+    /**
+     * Allocate a hot/cold chunk pair and add its slots to the free list
+     */
+    bool allocate_chunk() {
+        void* hot_block = mx_arena_malloc(arena_, hot_bytes(chunk_size_));
+        void* cold_block = mx_arena_malloc(arena_, cold_bytes(chunk_size_));
+        if (!hot_block || !cold_block) {
+            mx_arena_free(arena_, hot_block, hot_bytes(chunk_size_));
+            mx_arena_free(arena_, cold_block, cold_bytes(chunk_size_));
+            return false;
+        }
+        
+        blocks_.push_back(Block{hot_block, hot_bytes(chunk_size_)});
+        blocks_.push_back(Block{cold_block, cold_bytes(chunk_size_)});
+        total_capacity_ += chunk_size_;
+        
+        uintptr_t base = reinterpret_cast<uintptr_t>(hot_block);
+        base = (base + alignof(Hot) - 1) & ~static_cast<uintptr_t>(alignof(Hot) - 1);
+        Hot* hot = reinterpret_cast<Hot*>(base);
+        Cold* cold = static_cast<Cold*>(cold_block);
+        
+        // Link in reverse so the first allocations come from the front
+        for (size_t i = chunk_size_; i-- > 0; ) {
+            FreeNode* node = reinterpret_cast<FreeNode*>(&hot[i]);
+            node->next = free_list_head_;
+            node->cold = &cold[i];
+            free_list_head_ = node;
+        }
+        return true;
+    }
+    
+    // Over-allocate so the hot array can start on a cache line
+    static size_t hot_bytes(size_t count) { return count * sizeof(Hot) + alignof(Hot); }
+    static size_t cold_bytes(size_t count) { return count * sizeof(Cold); }
+};
+
 /* ============================================================================
  * STL-Compatible Allocator Wrapper for Containers
  * Following the article's proxy_allocator pattern
@@ -46,6 +46,7 @@ extern "C" {
 
 MX_API unsigned int mx_get_version(void);
 MX_API int mx_is_compatible_dll(void);
+MX_API int mx_is_trace_enabled(void);     /* 1 if built with MX_TRACE */
 
 /* ============================================================================
  * Forward Declarations - Opaque Handles
@@ -66,6 +67,13 @@ typedef enum {
     MX_SIDE_SELL = 1
 } mx_side_t;
 
+/* Sides a bulk operation applies to */
+typedef enum {
+    MX_SIDE_FILTER_BUY = 0,         /* Same values as mx_side_t */
+    MX_SIDE_FILTER_SELL = 1,
+    MX_SIDE_FILTER_BOTH = 2
+} mx_side_filter_t;
+
 /* Order type */
 typedef enum {
     MX_ORDER_TYPE_LIMIT = 0,
@@ -115,9 +123,18 @@ typedef enum {
     MX_EVENT_ORDER_PARTIAL = 3,     /* Order partially filled */
     MX_EVENT_ORDER_CANCELLED = 4,   /* Order cancelled */
     MX_EVENT_ORDER_EXPIRED = 5,     /* Order expired (DAY/GTD) */
-    MX_EVENT_ORDER_TRIGGERED = 6    /* Stop order triggered */
+    MX_EVENT_ORDER_TRIGGERED = 6,   /* Stop order triggered */
+    MX_EVENT_ORDER_REPLACED = 7     /* Order amended in place (cancel/replace) */
 } mx_order_event_t;
 
+/* Context time source - see mx_context_set_clock() */
+typedef enum {
+    MX_CLOCK_COARSE = 0,    /* Cached; refreshed per batch and by mx_context_update_timestamp() */
+    MX_CLOCK_SYSTEM = 1,    /* CLOCK_MONOTONIC, read at the start of every call */
+    MX_CLOCK_TSC = 2,       /* Calibrated invariant TSC, read at the start of every call */
+    MX_CLOCK_MANUAL = 3     /* Moves only with mx_context_set_timestamp() */
+} mx_clock_source_t;
+
 /* ============================================================================
  * Callback Types
  * ========================================================================= */
@@ -159,6 +176,185 @@ MX_API void mx_set_allocators(
     void (*f_free)(void*)
 );
 
+/* ============================================================================
+ * Batch Commands
+ * Input records for mx_order_book_submit_batch()
+ * ========================================================================= */
+
+/* Batch command kind */
+typedef enum {
+    MX_CMD_NEW = 0,                 /* Add an order (all mx_order_book_add_order fields) */
+    MX_CMD_CANCEL = 1,              /* Cancel order_id */
+    MX_CMD_MODIFY = 2,              /* Reduce order_id to quantity */
+    MX_CMD_REPLACE = 3              /* Amend order_id to price / quantity (keeps the ID) */
+} mx_command_type_t;
+
+/* Batch command record - unused fields are ignored */
+typedef struct mx_command_s {
+    uint64_t order_id;
+    uint64_t expire_time;           /* GTD expiry (NEW) */
+    uint32_t type;                  /* mx_command_type_t */
+    uint32_t order_type;            /* mx_order_type_t (NEW) */
+    uint32_t side;                  /* mx_side_t (NEW) */
+    uint32_t price;                 /* Limit price (NEW, REPLACE) */
+    uint32_t stop_price;            /* Stop trigger price (NEW) */
+    uint32_t quantity;              /* Order quantity (NEW) or new quantity (MODIFY, REPLACE) */
+    uint32_t display_qty;           /* Iceberg display quantity (NEW) */
+    uint32_t tif;                   /* mx_time_in_force_t (NEW) */
+    uint32_t flags;                 /* mx_order_flags_t (NEW) */
+    uint32_t reserved;
+} mx_command_t;
+
+/* ============================================================================
+ * Buffered Events
+ * Alternative to callbacks - see mx_context_set_event_buffer()
+ * ========================================================================= */
+
+/* Kind of a buffered event record */
+typedef enum {
+    MX_EVENT_TYPE_TRADE = 0,        /* Fill between an aggressive and a resting order */
+    MX_EVENT_TYPE_ORDER = 1         /* Order lifecycle event (mx_order_event_t) */
+} mx_event_type_t;
+
+/* Buffered event record (plain data, safe to memcpy) */
+typedef struct mx_event_s {
+    uint64_t order_id;              /* Order the event is for (aggressive order for trades) */
+    uint64_t passive_order_id;      /* Resting order for trades, 0 otherwise */
+    uint64_t timestamp;             /* Event timestamp */
+    uint32_t type;                  /* mx_event_type_t */
+    uint32_t order_event;           /* mx_order_event_t (order events only) */
+    uint32_t price;                 /* Trade price (trades only) */
+    uint32_t quantity;              /* Trade quantity, or filled quantity for order events */
+    uint32_t remaining;             /* Remaining quantity (order events only) */
+    uint32_t reserved;
+} mx_event_t;
+
+/* ============================================================================
+ * Memory Arena
+ * Per-context backing store - see mx_context_set_capacity_hints_ex()
+ * ========================================================================= */
+
+/* Arena options (bitwise OR); any non-zero value enables the arena */
+typedef enum {
+    MX_ARENA_NONE = 0,              /* Order storage comes from mx_set_allocators() */
+    MX_ARENA_ENABLE = (1 << 0),         /* Reserve anonymous memory with mmap/VirtualAlloc */
+    MX_ARENA_HUGE_PAGES = (1 << 1),     /* Try MAP_HUGETLB, then transparent huge pages */
+    MX_ARENA_PREFAULT = (1 << 2),       /* Touch every page when a book is created */
+    MX_ARENA_NUMA_LOCAL = (1 << 3)      /* Bind pages to the NUMA node of the creating thread */
+} mx_arena_flags_t;
+
+/* Arena usage for a context */
+typedef struct mx_arena_stats_s {
+    uint64_t reserved_bytes;        /* Mapped from the OS */
+    uint64_t used_bytes;            /* Handed out to live books */
+    uint64_t huge_page_bytes;       /* Portion of reserved_bytes backed by MAP_HUGETLB */
+    uint32_t region_count;          /* Separate mappings */
+    uint32_t flags;                 /* mx_arena_flags_t in effect */
+} mx_arena_stats_t;
+
+/* ============================================================================
+ * Depth Levels
+ * Output records for mx_order_book_get_levels()
+ * ========================================================================= */
+
+/* Aggregate state of one price level */
+typedef struct mx_level_s {
+    uint32_t price;                 /* Level price in ticks */
+    uint32_t volume;                /* Total resting quantity, hidden included */
+    uint32_t visible_volume;        /* Quantity shown (iceberg display portions) */
+    uint32_t order_count;           /* Resting orders at the level */
+} mx_level_t;
+
+/* ============================================================================
+ * Latency Tracking
+ * See mx_context_set_latency_tracking()
+ * ========================================================================= */
+
+/* Timed order book operation */
+typedef enum {
+    MX_LATENCY_ADD = 0,             /* Any add call, matching and stop cascades included */
+    MX_LATENCY_CANCEL = 1,          /* Cancel call */
+    MX_LATENCY_MODIFY = 2,          /* Modify or replace call */
+    MX_LATENCY_MATCH = 3,           /* Sweep of the contra side, when it filled anything */
+    MX_LATENCY_OP_COUNT = 4
+} mx_latency_op_t;
+
+/* Latency distribution of one operation, in nanoseconds */
+typedef struct mx_latency_stats_s {
+    uint64_t count;                 /* Samples recorded */
+    uint64_t min_ns;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;               /* 99.9th percentile */
+    uint64_t max_ns;
+} mx_latency_stats_t;
+
+/* ============================================================================
+ * Published Book View
+ * See mx_context_set_book_view()
+ * ========================================================================= */
+
+/* Book view limits */
+typedef enum {
+    MX_BOOK_VIEW_LEVELS = 16        /* Most levels per side a view can carry */
+} mx_book_view_limits_t;
+
+/* Summary of a book as of the end of its last operation (plain data) */
+typedef struct mx_book_view_s {
+    uint64_t sequence;              /* Publish count, 0 before the first operation */
+    uint64_t timestamp;             /* Context timestamp when it was published */
+    uint64_t total_trades;          /* Trades since the book was created */
+    uint64_t total_volume;          /* Quantity traded since the book was created */
+    uint64_t bid_volume;            /* Total resting quantity per side */
+    uint64_t ask_volume;
+    uint32_t best_bid;              /* 0 if no bids */
+    uint32_t best_ask;              /* 0 if no asks */
+    uint32_t order_count;           /* Live orders, pending stops included */
+    uint32_t bid_level_count;       /* Price levels per side */
+    uint32_t ask_level_count;
+    uint32_t bid_count;             /* Entries filled in bids / asks */
+    uint32_t ask_count;
+    uint32_t reserved;
+    mx_level_t bids[MX_BOOK_VIEW_LEVELS];   /* Best first */
+    mx_level_t asks[MX_BOOK_VIEW_LEVELS];
+} mx_book_view_t;
+
+/* ============================================================================
+ * Tracing
+ * Only in libraries built with MX_TRACE - see mx_context_set_trace()
+ * ========================================================================= */
+
+/* Trace point that wrote a record */
+typedef enum {
+    MX_TRACE_BOOK_ADD = 0,          /* Order rested; count = orders at its level after */
+    MX_TRACE_BOOK_REMOVE = 1,       /* Order unlinked; count = orders at its level after */
+    MX_TRACE_REMOVE_NOT_RESTING = 2,    /* Removal of an order not active or partially filled */
+    MX_TRACE_REMOVE_NOT_LINKED = 3,     /* Removal of an order missing from its level's queue */
+    MX_TRACE_REMOVE_NO_LEVEL = 4,       /* Removal of an order whose price level does not exist */
+    MX_TRACE_LEVEL_ERASED = 5,      /* Empty level erased; count = levels left on the side */
+    MX_TRACE_BEST_PRICE = 6         /* Best price recomputed after a removal at it; price = new best (0 if none) */
+} mx_trace_point_t;
+
+/* Trace record (plain data, safe to memcpy) */
+typedef struct mx_trace_record_s {
+    uint64_t timestamp;             /* Context timestamp of the call that wrote it */
+    uint64_t order_id;              /* 0 for level and best price records */
+    uint16_t point;                 /* mx_trace_point_t */
+    uint16_t side;                  /* mx_side_t */
+    uint32_t price;
+    uint32_t quantity;              /* Remaining quantity of the order */
+    uint32_t count;                 /* Point-specific, see mx_trace_point_t */
+} mx_trace_record_t;
+
+/* Receives trace records, oldest first; must not call into the context's books */
+typedef void (*mx_trace_sink_t)(
+    const mx_trace_record_t* records,
+    uint32_t count,
+    void* user_data
+);
+
 /* ============================================================================
  * Context Management
  * ========================================================================= */
@@ -195,6 +391,7 @@ MX_API void mx_context_set_callbacks(
 
 /**
  * Set the current timestamp for the context (used for DAY/GTD orders).
+ * Switches the context to MX_CLOCK_MANUAL.
  * 
  * @param ctx       Context handle
  * @param timestamp Current timestamp in nanoseconds
@@ -209,6 +406,215 @@ MX_API void mx_context_set_timestamp(mx_context_t* ctx, uint64_t timestamp);
  */
 MX_API uint64_t mx_context_get_timestamp(const mx_context_t* ctx);
 
+/**
+ * Choose where the context's timestamps come from.
+ * Order books read the clock at most once per call (once per batch) and
+ * stamp the orders, trades and events of that call with the same value.
+ * MX_CLOCK_COARSE (the default) reads nothing per call: the time moves
+ * at each batch and whenever mx_context_update_timestamp() is called.
+ * MX_CLOCK_TSC scales the CPU timestamp counter to CLOCK_MONOTONIC
+ * nanoseconds; selecting it calibrates the counter (about two
+ * milliseconds, once per context) and anchors it to the system clock.
+ * 
+ * @param ctx    Context handle
+ * @param source Time source
+ * @return MX_STATUS_OK, MX_STATUS_INVALID_PARAM if ctx is NULL or source
+ *         is unknown, or MX_STATUS_ERROR if MX_CLOCK_TSC is requested on a
+ *         CPU without an invariant TSC (the clock is left unchanged)
+ */
+MX_API int mx_context_set_clock(mx_context_t* ctx, mx_clock_source_t source);
+
+/**
+ * Get the context's time source.
+ * 
+ * @param ctx Context handle
+ * @return Current source (MX_CLOCK_COARSE if ctx is NULL)
+ */
+MX_API mx_clock_source_t mx_context_get_clock(const mx_context_t* ctx);
+
+/**
+ * Read the context's clock now, e.g. once per inbound message or per
+ * poll loop with MX_CLOCK_COARSE. Does nothing under MX_CLOCK_MANUAL.
+ * 
+ * @param ctx Context handle
+ * @return The new current timestamp in nanoseconds (0 if ctx is NULL)
+ */
+MX_API uint64_t mx_context_update_timestamp(mx_context_t* ctx);
+
+/**
+ * Set capacity hints for order books created from this context.
+ * Books pre-size their order pool and order ID index for max_orders
+ * live orders so the hot path does not rehash or grow. Both tables
+ * still grow past the hint if needed. Existing books are not affected.
+ * Arena options set through mx_context_set_capacity_hints_ex() are kept.
+ * 
+ * @param ctx           Context handle
+ * @param max_orders    Expected peak number of live orders per book
+ * @param price_levels  Expected number of price levels per side
+ */
+MX_API void mx_context_set_capacity_hints(
+    mx_context_t* ctx,
+    uint32_t max_orders,
+    uint32_t price_levels
+);
+
+/**
+ * Set capacity hints and arena options for order books created from
+ * this context.
+ * With arena flags set, each new book reserves room for its order pool,
+ * order ID index and ladder levels from a memory arena owned by the
+ * context, mapped straight from the OS (and pre-faulted with
+ * MX_ARENA_PREFAULT), so a book that stays within its hints makes no
+ * malloc calls and takes no page faults once created. Storage released
+ * by a freed book is reused by the next book of the same shape. Books
+ * must be freed before their context. Existing books are not affected.
+ * 
+ * @param ctx           Context handle
+ * @param max_orders    Expected peak number of live orders per book
+ * @param price_levels  Expected number of price levels per side
+ * @param arena_flags   mx_arena_flags_t bits, or MX_ARENA_NONE
+ * @return MX_STATUS_OK, or MX_STATUS_INVALID_PARAM if ctx is NULL or
+ *         arena_flags has unknown bits
+ */
+MX_API int mx_context_set_capacity_hints_ex(
+    mx_context_t* ctx,
+    uint32_t max_orders,
+    uint32_t price_levels,
+    uint32_t arena_flags
+);
+
+/**
+ * Get memory arena usage for a context.
+ * 
+ * @param ctx   Context handle
+ * @param stats Output statistics (all zero if the arena is unused)
+ * @return MX_STATUS_OK, or MX_STATUS_INVALID_PARAM on NULL arguments
+ */
+MX_API int mx_context_get_arena_stats(const mx_context_t* ctx, mx_arena_stats_t* stats);
+
+/**
+ * Set the price band for order books created from this context.
+ * Books created afterwards keep their price levels in a tick-indexed
+ * ladder instead of a tree, giving O(1) level lookup. Limit prices
+ * outside [min_price, max_price] or off the tick grid are rejected
+ * with MX_STATUS_INVALID_PRICE. Existing books are not affected.
+ *
+ * Memory: each book keeps a ladder for bids and one for asks, plus one
+ * per stop side from its first stop order. A ladder takes about 72 bytes
+ * per tick in the band (a 64-byte level slot plus volume and occupancy
+ * words) - 16M ticks is over 1 GiB per ladder. The storage is reserved
+ * up front but only paged in as prices are used, unless the arena is
+ * asked to prefault (MX_ARENA_PREFAULT).
+ *
+ * @param ctx        Context handle
+ * @param min_price  Lowest accepted price in ticks
+ * @param max_price  Highest accepted price in ticks
+ * @param tick_size  Price increment (must be > 0)
+ * @return MX_STATUS_OK, or MX_STATUS_INVALID_PARAM if the band is empty
+ *         or wider than the ladder supports (16M ticks).
+ *         Passing min_price = max_price = 0 removes the band.
+ */
+MX_API int mx_context_set_price_bounds(
+    mx_context_t* ctx,
+    uint32_t min_price,
+    uint32_t max_price,
+    uint32_t tick_size
+);
+
+/**
+ * Switch order books created from this context to buffered events.
+ * Instead of invoking the trade/order callbacks, each book appends
+ * mx_event_t records to its own ring, in the order the callbacks would
+ * have fired, and the caller drains them with mx_order_book_poll_events().
+ * The ring grows if it fills up, so unread events are never overwritten.
+ * Existing books are not affected.
+ * 
+ * @param ctx       Context handle
+ * @param capacity  Initial ring size in events (rounded up to a power
+ *                  of two), or 0 to go back to callbacks
+ * @return MX_STATUS_OK, or MX_STATUS_INVALID_PARAM if ctx is NULL
+ */
+MX_API int mx_context_set_event_buffer(mx_context_t* ctx, uint32_t capacity);
+
+/**
+ * Record per-operation latency in order books created from this context.
+ * Each book times its add, cancel, modify and match operations with the
+ * CPU timestamp counter into log-bucketed histograms (values within ~3%),
+ * read back with mx_order_book_get_latency(). Books created without it
+ * pay a single branch per operation. Enabling calibrates the counter
+ * against the system clock, which takes about two milliseconds.
+ * Existing books are not affected.
+ * 
+ * @param ctx    Context handle
+ * @param enable Non-zero to record latency
+ * @return MX_STATUS_OK, or MX_STATUS_INVALID_PARAM if ctx is NULL
+ */
+MX_API int mx_context_set_latency_tracking(mx_context_t* ctx, int enable);
+
+/**
+ * Publish a read-only view of order books created from this context.
+ * At the end of every mutating call (one per batch) the book copies its
+ * top of book, the best levels levels of each side and its counters
+ * into a cache-line-aligned, double-buffered seqlock, so other threads
+ * can read them with mx_order_book_read_view() without locks and without
+ * ever stalling the thread that owns the book. Publishing costs one
+ * copy of the view per call. Existing books are not affected.
+ *
+ * @param ctx    Context handle
+ * @param enable Non-zero to publish views
+ * @param levels Levels per side to include (0 to MX_BOOK_VIEW_LEVELS)
+ * @return MX_STATUS_OK, or MX_STATUS_INVALID_PARAM if ctx is NULL or
+ *         levels is out of range
+ */
+MX_API int mx_context_set_book_view(mx_context_t* ctx, int enable, uint32_t levels);
+
+/**
+ * Record trace points of the context's books into a ring of capacity
+ * records (rounded up to a power of two; 0 turns tracing off).
+ * With a sink, a full ring is handed to it before the next record is
+ * written. Without one the oldest records are overwritten, and the ring
+ * keeps the latest history for mx_context_read_trace().
+ * Pending records are discarded.
+ * 
+ * @param ctx Context
+ * @param capacity Records to keep, or 0
+ * @param sink Receives full rings and mx_context_flush_trace() (can be NULL)
+ * @param user_data Passed to sink
+ * @return MX_STATUS_OK, MX_STATUS_INVALID_PARAM if ctx is NULL,
+ *         MX_STATUS_OUT_OF_MEMORY, or MX_STATUS_ERROR if the library was
+ *         built without MX_TRACE
+ */
+MX_API int mx_context_set_trace(
+    mx_context_t* ctx,
+    uint32_t capacity,
+    mx_trace_sink_t sink,
+    void* user_data
+);
+
+/**
+ * Copy up to max_records pending trace records (oldest first) and
+ * release them.
+ * 
+ * @return Number of records copied
+ */
+MX_API uint32_t mx_context_read_trace(
+    mx_context_t* ctx,
+    mx_trace_record_t* records,
+    uint32_t max_records
+);
+
+/**
+ * Hand every pending trace record to the sink now.
+ * 
+ * @return Number of records handed over (0 without a sink)
+ */
+MX_API uint32_t mx_context_flush_trace(mx_context_t* ctx);
+
+/**
+ * Trace records overwritten before they were read (no sink only).
+ */
+MX_API uint64_t mx_context_trace_overwritten(const mx_context_t* ctx);
+
 /* ============================================================================
  * Order Book Management
  * ========================================================================= */
@@ -337,6 +743,27 @@ MX_API int mx_order_book_add_order(
     uint64_t expire_time
 );
 
+/**
+ * Submit several new/cancel/modify/replace commands in one call.
+ * Commands run in array order in a single pass, exactly as if each had
+ * been submitted on its own, so callbacks/buffered events come out in
+ * the same order. Every command in the batch sees the same timestamp.
+ * 
+ * @param book      Order book
+ * @param commands  Array of count commands
+ * @param statuses  Optional array of count results (MX_STATUS_* per
+ *                  command, MX_STATUS_INVALID_PARAM for an unknown
+ *                  command, side, order type or time in force); may be NULL
+ * @param count     Number of commands
+ * @return Number of commands that returned MX_STATUS_OK
+ */
+MX_API uint32_t mx_order_book_submit_batch(
+    mx_order_book_t* book,
+    const mx_command_t* commands,
+    int* statuses,
+    uint32_t count
+);
+
 /**
  * Cancel an order from the order book.
  * 
@@ -364,14 +791,21 @@ MX_API int mx_order_book_modify(
 );
 
 /**
- * Replace an order (cancel and replace - loses time priority).
+ * Replace (amend) a resting order in place.
+ * The order keeps its slot, owner tag and expiry, and reports a single
+ * MX_EVENT_ORDER_REPLACED (filled and remaining after the amend). A
+ * same-price reduction keeps time priority; any other change moves the
+ * order to the back of the new price level, trading first if the new
+ * price crosses the book. Pending stops cannot be replaced.
  * 
  * @param book          Order book
  * @param old_order_id  Order ID to replace
- * @param new_order_id  New order ID
+ * @param new_order_id  New order ID (0 or old_order_id keeps the ID)
  * @param new_price     New price
- * @param new_quantity  New quantity
- * @return MX_STATUS_OK on success, error code otherwise
+ * @param new_quantity  New total quantity, filled quantity included
+ * @return MX_STATUS_OK on success, MX_STATUS_INVALID_PARAM for an order
+ *         not resting in the book, MX_STATUS_WOULD_MATCH for a post-only
+ *         order repriced through the touch, other error code otherwise
  */
 MX_API int mx_order_book_replace(
     mx_order_book_t* book,
@@ -381,6 +815,46 @@ MX_API int mx_order_book_replace(
     uint32_t new_quantity
 );
 
+/* ============================================================================
+ * Owners and Mass Cancel
+ * ========================================================================= */
+
+/**
+ * Tag a live order with an owner (a user, session or account ID).
+ * Tagged orders can be pulled together with mx_order_book_mass_cancel().
+ * Tag right after adding; an order that traded out on entry is gone.
+ * Owners are saved in snapshots.
+ * 
+ * @param book     Order book
+ * @param order_id Live order (resting or pending stop)
+ * @param owner    Owner ID, or 0 to remove the tag
+ * @return MX_STATUS_OK, MX_STATUS_ORDER_NOT_FOUND, or
+ *         MX_STATUS_OUT_OF_MEMORY if the owner index cannot grow
+ */
+MX_API int mx_order_book_set_owner(
+    mx_order_book_t* book,
+    uint64_t order_id,
+    uint64_t owner
+);
+
+/**
+ * Cancel every order of one owner, resting and pending stops alike.
+ * Visits only that owner's orders, frees each emptied level once and
+ * recomputes the best prices once, so it is much cheaper than one
+ * mx_order_book_cancel() per order. A cancelled event is delivered for
+ * each order, newest first, after the book has reached its final state.
+ * 
+ * @param book        Order book
+ * @param owner       Owner ID (0 matches nothing)
+ * @param side_filter Buy side, sell side or both
+ * @return Number of orders cancelled
+ */
+MX_API uint32_t mx_order_book_mass_cancel(
+    mx_order_book_t* book,
+    uint64_t owner,
+    mx_side_filter_t side_filter
+);
+
 /* ============================================================================
  * Market Data Queries
  * ========================================================================= */
@@ -445,6 +919,24 @@ MX_API uint64_t mx_order_book_get_depth(
     uint32_t num_levels
 );
 
+/**
+ * Get the top price levels of one side, best first.
+ * The book keeps its top levels cached between changes, so repeated
+ * queries of up to 16 levels cost a copy rather than a walk.
+ * 
+ * @param book       Order book
+ * @param side       Bid or ask side
+ * @param max_levels Capacity of out
+ * @param out        Output: up to max_levels levels
+ * @return Number of levels written (fewer if the side is shallower)
+ */
+MX_API uint32_t mx_order_book_get_levels(
+    const mx_order_book_t* book,
+    mx_side_t side,
+    uint32_t max_levels,
+    mx_level_t* out
+);
+
 /* ============================================================================
  * Order Queries
  * ========================================================================= */
@@ -500,13 +992,141 @@ MX_API uint32_t mx_order_book_process_expirations(
 
 /**
  * Trigger stop orders based on market price movement.
- * Should be called after trades when stop orders might be triggered.
+ * Stops fire automatically (including cascades) after every add, cancel
+ * and expiration, so calling this is only needed as a consistency sweep.
  * 
  * @param book Order book
  * @return Number of stop orders triggered
  */
 MX_API uint32_t mx_order_book_process_stops(mx_order_book_t* book);
 
+/**
+ * Drain buffered events (books created with an event buffer only).
+ * Events are returned oldest first and removed from the book's ring.
+ * 
+ * @param book       Order book
+ * @param events     Output array
+ * @param max_events Capacity of the output array
+ * @return Number of events written (0 if the book uses callbacks)
+ */
+MX_API uint32_t mx_order_book_poll_events(
+    mx_order_book_t* book,
+    mx_event_t* events,
+    uint32_t max_events
+);
+
+/**
+ * Number of buffered events waiting to be polled.
+ * 
+ * @param book Order book
+ * @return Pending event count (0 if the book uses callbacks)
+ */
+MX_API uint32_t mx_order_book_pending_events(const mx_order_book_t* book);
+
+/* ============================================================================
+ * Latency
+ * ========================================================================= */
+
+/**
+ * Get the latency distribution of one operation since the book was
+ * created or last reset. Percentiles are reported as the top of their
+ * histogram bucket.
+ * 
+ * @param book  Order book
+ * @param op    Operation to report
+ * @param stats Output distribution (all zero if nothing was recorded)
+ * @return MX_STATUS_OK, MX_STATUS_INVALID_PARAM on NULL arguments or an
+ *         unknown op, or MX_STATUS_ERROR if the book does not track latency
+ */
+MX_API int mx_order_book_get_latency(
+    const mx_order_book_t* book,
+    mx_latency_op_t op,
+    mx_latency_stats_t* stats
+);
+
+/**
+ * Get any percentile of one operation's latency.
+ * 
+ * @param book       Order book
+ * @param op         Operation to report
+ * @param percentile 0 to 100 (e.g. 99.99)
+ * @return Latency in nanoseconds, or 0 if nothing was recorded
+ */
+MX_API uint64_t mx_order_book_get_latency_percentile(
+    const mx_order_book_t* book,
+    mx_latency_op_t op,
+    double percentile
+);
+
+/**
+ * Discard every recorded latency sample of a book.
+ * 
+ * @param book Order book
+ */
+MX_API void mx_order_book_reset_latency(mx_order_book_t* book);
+
+/* ============================================================================
+ * Published View
+ * Safe to call from any thread while another thread operates the book
+ * (the book itself must outlive the call)
+ * ========================================================================= */
+
+/**
+ * Copy the book's latest published view.
+ * Never blocks the writer; a reader only retries if the book publishes
+ * twice while it is copying.
+ *
+ * @param book Order book
+ * @param view Output summary
+ * @return MX_STATUS_OK, MX_STATUS_INVALID_PARAM on NULL arguments, or
+ *         MX_STATUS_ERROR if the book does not publish a view
+ */
+MX_API int mx_order_book_read_view(const mx_order_book_t* book, mx_book_view_t* view);
+
+/**
+ * Publish count of the book's view, for cheap change polling before a
+ * full mx_order_book_read_view().
+ *
+ * @param book Order book
+ * @return Sequence of the latest view (0 if none was published)
+ */
+MX_API uint64_t mx_order_book_view_sequence(const mx_order_book_t* book);
+
+/* ============================================================================
+ * Snapshots
+ * ========================================================================= */
+
+/**
+ * Save the book to a versioned binary snapshot file.
+ * Every resting order and pending stop is written per price level in
+ * time-priority order, with expiry metadata and the trade counters.
+ * The file is written next to path and renamed over it when complete.
+ * 
+ * @param book Order book
+ * @param path Destination file
+ * @return MX_STATUS_OK, MX_STATUS_INVALID_PARAM on NULL arguments, or
+ *         MX_STATUS_ERROR if the file could not be written
+ */
+MX_API int mx_order_book_save_snapshot(const mx_order_book_t* book, const char* path);
+
+/**
+ * Replace the book's contents with a snapshot.
+ * The file is memory-mapped and the order pool, price levels, stop
+ * index and expiry schedule are rebuilt directly: nothing is matched
+ * and no callbacks or events fire. The book's price band (if any) must
+ * accept every saved price. A file that fails the header or checksum
+ * checks leaves the book untouched; a record rejected while rebuilding
+ * leaves it empty.
+ * 
+ * @param book Order book
+ * @param path Snapshot file from mx_order_book_save_snapshot()
+ * @return MX_STATUS_OK, MX_STATUS_INVALID_PARAM on NULL arguments,
+ *         MX_STATUS_ERROR for an unreadable, corrupt or incompatible
+ *         file, MX_STATUS_INVALID_PRICE if a price is outside the band,
+ *         or MX_STATUS_DUPLICATE_ORDER for repeated order IDs
+ */
+MX_API int mx_order_book_load_snapshot(mx_order_book_t* book, const char* path);
+
 /* ============================================================================
  * Utility Functions
  * ========================================================================= */
@@ -16,6 +16,12 @@ workspace "MatchEngine"
         systemversion "latest"
     filter {}
 
+-- Trace points (MX_TRACE_POINT) are compiled out unless requested
+newoption {
+    trigger = "trace",
+    description = "Build with MX_TRACE trace points (see mx_context_set_trace)"
+}
+
 -- MatchX Shared Library Project
 project "MatchEngine"
     kind "SharedLib"
@@ -61,6 +67,10 @@ project "MatchEngine"
                 }
     filter {}
     
+    filter "options:trace"
+        defines { "MX_TRACE" }
+    filter {}
+    
     filter "configurations:debug"
         defines { "MX_DEBUG", "_DEBUG" }
         symbols "On"
@@ -125,6 +135,10 @@ project "MatchEngineStatic"
         optimize "Speed"
     filter {}
     
+    filter "options:trace"
+        defines { "MX_TRACE" }
+    filter {}
+    
     filter "configurations:debug"
         defines { "MX_DEBUG", "_DEBUG" }
         symbols "On"
@@ -245,3 +259,81 @@ project "Benchmark"
         optimize "Speed"
         defines { "NDEBUG" }
     filter {}
+
+-- Benchmark: order flow replay with latency percentiles
+project "ReplayBenchmark"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++14"
+    staticruntime "off"
+    
+    files {
+        "%{wks.location}/../examples/replay_benchmark.cpp"
+    }
+    
+    includedirs {
+        "%{wks.location}/../include"
+    }
+    
+    links {
+        "MatchEngine"
+    }
+    
+    libdirs {
+        "%{cfg.buildtarget.directory}"
+    }
+    
+    filter "system:linux"
+        links { "pthread" }
+        linkoptions { "-Wl,-rpath,'$$ORIGIN'" }
+    filter "system:macosx"
+        linkoptions { "-Wl,-rpath,@executable_path" }
+    filter {}
+    
+    filter "configurations:debug"
+        symbols "On"
+    filter {}
+    
+    filter "configurations:release"
+        optimize "Speed"
+        defines { "NDEBUG" }
+    filter {}
+
+-- Example: Backtest (parallel historical replay)
+project "Backtest"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++14"
+    staticruntime "off"
+    
+    files {
+        "%{wks.location}/../examples/backtest.cpp"
+    }
+    
+    includedirs {
+        "%{wks.location}/../include"
+    }
+    
+    links {
+        "MatchEngine"
+    }
+    
+    libdirs {
+        "%{cfg.buildtarget.directory}"
+    }
+    
+    filter "system:linux"
+        links { "pthread" }
+        linkoptions { "-Wl,-rpath,'$$ORIGIN'" }
+    filter "system:macosx"
+        linkoptions { "-Wl,-rpath,@executable_path" }
+    filter {}
+    
+    filter "configurations:debug"
+        symbols "On"
+    filter {}
+    
+    filter "configurations:release"
+        optimize "Speed"
+        defines { "NDEBUG" }
+    filter {}
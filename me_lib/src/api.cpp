@@ -121,6 +121,22 @@ int mx_order_book_replace(mx_order_book_t* book,
     return orderbook->replace_order(old_order_id, new_order_id, new_price, new_quantity);
 }
 
+int mx_order_book_set_owner(mx_order_book_t* book, uint64_t order_id, uint64_t owner) {
+    if (!book) return MX_STATUS_INVALID_PARAM;
+    
+    matchx::OrderBook* orderbook = AS_TYPE(matchx::OrderBook, book);
+    return orderbook->set_owner(order_id, owner);
+}
+
+uint32_t mx_order_book_mass_cancel(mx_order_book_t* book,
+                                   uint64_t owner,
+                                   mx_side_filter_t side_filter) {
+    if (!book || side_filter > MX_SIDE_FILTER_BOTH) return 0;
+    
+    matchx::OrderBook* orderbook = AS_TYPE(matchx::OrderBook, book);
+    return orderbook->mass_cancel(owner, side_filter);
+}
+
 /* ============================================================================
  * Advanced Order Operations
  * ========================================================================= */
@@ -143,6 +159,16 @@ int mx_order_book_add_order(mx_order_book_t* book,
                                quantity, display_qty, tif, flags, expire_time);
 }
 
+uint32_t mx_order_book_submit_batch(mx_order_book_t* book,
+                                    const mx_command_t* commands,
+                                    int* statuses,
+                                    uint32_t count) {
+    if (!book || (!commands && count > 0)) return 0;
+    
+    matchx::OrderBook* orderbook = AS_TYPE(matchx::OrderBook, book);
+    return orderbook->submit_batch(commands, statuses, count);
+}
+
 /* ============================================================================
  * Market Data Queries
  * ========================================================================= */
@@ -193,6 +219,16 @@ uint64_t mx_order_book_get_depth(const mx_order_book_t* book,
     return orderbook->get_depth(side, num_levels);
 }
 
+uint32_t mx_order_book_get_levels(const mx_order_book_t* book,
+                                  mx_side_t side,
+                                  uint32_t max_levels,
+                                  mx_level_t* out) {
+    if (!book || !out) return 0;
+    
+    const matchx::OrderBook* orderbook = AS_CTYPE(matchx::OrderBook, book);
+    return orderbook->get_levels(side, max_levels, out);
+}
+
 /* ============================================================================
  * Order Queries
  * ========================================================================= */
@@ -246,4 +282,87 @@ uint32_t mx_order_book_process_stops(mx_order_book_t* book) {
     return orderbook->process_stops();
 }
 
+uint32_t mx_order_book_poll_events(mx_order_book_t* book,
+                                   mx_event_t* events,
+                                   uint32_t max_events) {
+    if (!book || !events) return 0;
+    
+    matchx::OrderBook* orderbook = AS_TYPE(matchx::OrderBook, book);
+    return orderbook->poll_events(events, max_events);
+}
+
+uint32_t mx_order_book_pending_events(const mx_order_book_t* book) {
+    if (!book) return 0;
+    
+    const matchx::OrderBook* orderbook = AS_CTYPE(matchx::OrderBook, book);
+    return orderbook->get_pending_event_count();
+}
+
+/* ============================================================================
+ * Latency
+ * ========================================================================= */
+
+int mx_order_book_get_latency(const mx_order_book_t* book,
+                              mx_latency_op_t op,
+                              mx_latency_stats_t* stats) {
+    if (!book || !stats) return MX_STATUS_INVALID_PARAM;
+    if (op < 0 || op >= MX_LATENCY_OP_COUNT) return MX_STATUS_INVALID_PARAM;
+    
+    const matchx::OrderBook* orderbook = AS_CTYPE(matchx::OrderBook, book);
+    return orderbook->get_latency(op, *stats) ? MX_STATUS_OK : MX_STATUS_ERROR;
+}
+
+uint64_t mx_order_book_get_latency_percentile(const mx_order_book_t* book,
+                                              mx_latency_op_t op,
+                                              double percentile) {
+    if (!book) return 0;
+    if (op < 0 || op >= MX_LATENCY_OP_COUNT) return 0;
+    
+    const matchx::OrderBook* orderbook = AS_CTYPE(matchx::OrderBook, book);
+    return orderbook->get_latency_percentile(op, percentile);
+}
+
+void mx_order_book_reset_latency(mx_order_book_t* book) {
+    if (!book) return;
+    
+    matchx::OrderBook* orderbook = AS_TYPE(matchx::OrderBook, book);
+    orderbook->reset_latency();
+}
+
+/* ============================================================================
+ * Published View
+ * ========================================================================= */
+
+int mx_order_book_read_view(const mx_order_book_t* book, mx_book_view_t* view) {
+    if (!book || !view) return MX_STATUS_INVALID_PARAM;
+    
+    const matchx::OrderBook* orderbook = AS_CTYPE(matchx::OrderBook, book);
+    return orderbook->read_view(*view) ? MX_STATUS_OK : MX_STATUS_ERROR;
+}
+
+uint64_t mx_order_book_view_sequence(const mx_order_book_t* book) {
+    if (!book) return 0;
+    
+    const matchx::OrderBook* orderbook = AS_CTYPE(matchx::OrderBook, book);
+    return orderbook->get_view_sequence();
+}
+
+/* ============================================================================
+ * Snapshots
+ * ========================================================================= */
+
+int mx_order_book_save_snapshot(const mx_order_book_t* book, const char* path) {
+    if (!book || !path) return MX_STATUS_INVALID_PARAM;
+    
+    const matchx::OrderBook* orderbook = AS_CTYPE(matchx::OrderBook, book);
+    return orderbook->save_snapshot(path);
+}
+
+int mx_order_book_load_snapshot(mx_order_book_t* book, const char* path) {
+    if (!book || !path) return MX_STATUS_INVALID_PARAM;
+    
+    matchx::OrderBook* orderbook = AS_TYPE(matchx::OrderBook, book);
+    return orderbook->load_snapshot(path);
+}
+
 } // extern "C"
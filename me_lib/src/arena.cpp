@@ -0,0 +1,239 @@
+/**
+ * Arena implementation
+ * Platform mapping code lives here so OS headers stay out of the
+ * internal headers
+ */
+
+#include "internal/utils/arena.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace matchx {
+
+/* ============================================================================
+ * Platform Helpers
+ * ========================================================================= */
+
+namespace {
+
+const size_t HUGE_PAGE_SIZE = 2u * 1024u * 1024u;
+const size_t MIN_REGION_SIZE = 2u * 1024u * 1024u;   // Growth past the reservation
+
+size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+size_t page_size() {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return static_cast<size_t>(info.dwPageSize);
+#elif defined(__linux__) || defined(__APPLE__)
+    long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? static_cast<size_t>(size) : 4096u;
+#else
+    return 4096u;
+#endif
+}
+
+/**
+ * Map length bytes of zeroed, writable memory
+ * length is rounded up in place; huge is set if huge pages back it
+ */
+void* os_map(size_t& length, uint32_t flags, bool& huge) {
+    huge = false;
+
+#if defined(_WIN32)
+    (void)flags;
+    length = round_up(length, page_size());
+    return VirtualAlloc(nullptr, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#elif defined(__linux__) || defined(__APPLE__)
+    void* mem = MAP_FAILED;
+
+#if defined(MAP_HUGETLB)
+    if (flags & MX_ARENA_HUGE_PAGES) {
+        size_t huge_length = round_up(length, HUGE_PAGE_SIZE);
+        mem = mmap(nullptr, huge_length, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mem != MAP_FAILED) {
+            length = huge_length;
+            huge = true;
+        }
+    }
+#endif
+    
+    if (mem == MAP_FAILED) {
+        // No reserved huge pages - fall back to normal pages (THP if asked)
+        length = round_up(length, (flags & MX_ARENA_HUGE_PAGES) ? HUGE_PAGE_SIZE : page_size());
+        mem = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) return nullptr;
+#if defined(MADV_HUGEPAGE)
+        if (flags & MX_ARENA_HUGE_PAGES) {
+            madvise(mem, length, MADV_HUGEPAGE);
+        }
+#endif
+    }
+
+#if defined(__linux__) && defined(SYS_mbind)
+    if (flags & MX_ARENA_NUMA_LOCAL) {
+        // MPOL_LOCAL: allocate on the node of the faulting (creating) thread
+        const int mpol_local = 4;
+        syscall(SYS_mbind, mem, length, mpol_local, nullptr, 0, 0);
+    }
+#endif
+    
+    return mem;
+#else
+    (void)flags;
+    void* mem = mx_calloc(1, length);
+    return mem;
+#endif
+}
+
+void os_unmap(void* mem, size_t length) {
+#if defined(_WIN32)
+    (void)length;
+    VirtualFree(mem, 0, MEM_RELEASE);
+#elif defined(__linux__) || defined(__APPLE__)
+    munmap(mem, length);
+#else
+    (void)length;
+    mx_free(mem);
+#endif
+}
+
+/**
+ * Write one byte per page so every page is resident before matching
+ */
+void prefault(char* mem, size_t length) {
+    size_t step = page_size();
+    for (size_t offset = 0; offset < length; offset += step) {
+        static_cast<volatile char*>(mem)[offset] = 0;
+    }
+}
+
+} // namespace
+
+/* ============================================================================
+ * Arena
+ * ========================================================================= */
+
+bool Arena::reserve(const ArenaPlan& plan) {
+    // A freed block only serves a request of exactly its size, so match
+    // each planned block against one not already claimed by another
+    const FreeBlock* claimed[ArenaPlan::MAX_BLOCKS];
+    uint32_t claimed_count = 0;
+    size_t needed = 0;
+    
+    for (uint32_t i = 0; i < plan.count; i++) {
+        size_t size = block_size(plan.blocks[i]);
+        if (size == 0) size = MX_CACHE_LINE_SIZE;
+        
+        const FreeBlock* match = nullptr;
+        for (const FreeBlock* block = free_blocks_; block && !match; block = block->next) {
+            if (block->size != size) continue;
+            bool taken = false;
+            for (uint32_t j = 0; j < claimed_count && !taken; j++) {
+                taken = claimed[j] == block;
+            }
+            if (!taken) match = block;
+        }
+        
+        if (match) {
+            claimed[claimed_count++] = match;
+        } else {
+            needed += size;
+        }
+    }
+    
+    size_t room = regions_ ? regions_->size - regions_->used : 0;
+    if (needed == 0 || room >= needed) {
+        return true;
+    }
+    return map_region(needed);
+}
+
+void* Arena::allocate(size_t bytes) {
+    size_t size = block_size(bytes);
+    if (size == 0) size = MX_CACHE_LINE_SIZE;
+    
+    if (void* block = take_free_block(size)) {
+        return block;
+    }
+    
+    if (!regions_ || regions_->size - regions_->used < size) {
+        if (!map_region(size > MIN_REGION_SIZE ? size : MIN_REGION_SIZE)) {
+            return nullptr;
+        }
+    }
+    
+    Region* region = regions_;
+    void* block = region->base + region->used;
+    region->used += size;
+    used_bytes_ += size;
+    return block;
+}
+
+void* Arena::allocate_zeroed(size_t bytes) {
+    size_t size = block_size(bytes);
+    if (size == 0) size = MX_CACHE_LINE_SIZE;
+    
+    if (void* block = take_free_block(size)) {
+        std::memset(block, 0, size);
+        return block;
+    }
+    return allocate(size);
+}
+
+void Arena::release() {
+    Region* region = regions_;
+    while (region) {
+        Region* next = region->next;
+        os_unmap(region, region->mapped_size);
+        region = next;
+    }
+    regions_ = nullptr;
+    free_blocks_ = nullptr;
+    reserved_bytes_ = 0;
+    used_bytes_ = 0;
+    huge_bytes_ = 0;
+    region_count_ = 0;
+}
+
+bool Arena::map_region(size_t bytes) {
+    size_t header = block_size(sizeof(Region));
+    size_t length = header + bytes;
+    bool huge = false;
+    
+    void* mem = os_map(length, flags_, huge);
+    if (!mem) return false;
+    
+    if (flags_ & MX_ARENA_PREFAULT) {
+        prefault(static_cast<char*>(mem), length);
+    }
+    
+    Region* region = static_cast<Region*>(mem);
+    region->next = regions_;
+    region->base = static_cast<char*>(mem) + header;
+    region->size = length - header;
+    region->used = 0;
+    region->mapped_size = length;
+    region->huge = huge;
+    regions_ = region;
+    
+    reserved_bytes_ += length;
+    if (huge) huge_bytes_ += length;
+    ++region_count_;
+    return true;
+}
+
+} // namespace matchx
@@ -55,4 +55,148 @@ uint64_t mx_context_get_timestamp(const mx_context_t* ctx) {
     return context->get_timestamp();
 }
 
+int mx_context_set_clock(mx_context_t* ctx, mx_clock_source_t source) {
+    if (!ctx) return MX_STATUS_INVALID_PARAM;
+    if (source < MX_CLOCK_COARSE || source > MX_CLOCK_MANUAL) return MX_STATUS_INVALID_PARAM;
+    
+    matchx::Context* context = reinterpret_cast<matchx::Context*>(ctx);
+    return context->set_clock(source) ? MX_STATUS_OK : MX_STATUS_ERROR;
+}
+
+mx_clock_source_t mx_context_get_clock(const mx_context_t* ctx) {
+    if (!ctx) return MX_CLOCK_COARSE;
+    
+    const matchx::Context* context = reinterpret_cast<const matchx::Context*>(ctx);
+    return context->clock();
+}
+
+uint64_t mx_context_update_timestamp(mx_context_t* ctx) {
+    if (!ctx) return 0;
+    
+    matchx::Context* context = reinterpret_cast<matchx::Context*>(ctx);
+    context->update_timestamp();
+    return context->get_timestamp();
+}
+
+void mx_context_set_capacity_hints(mx_context_t* ctx,
+                                   uint32_t max_orders,
+                                   uint32_t price_levels) {
+    if (!ctx) return;
+    
+    matchx::Context* context = reinterpret_cast<matchx::Context*>(ctx);
+    context->set_capacity_hints(max_orders, price_levels, context->config().arena_flags);
+}
+
+int mx_context_set_capacity_hints_ex(mx_context_t* ctx,
+                                     uint32_t max_orders,
+                                     uint32_t price_levels,
+                                     uint32_t arena_flags) {
+    if (!ctx) return MX_STATUS_INVALID_PARAM;
+    if (arena_flags & ~matchx::Arena::VALID_FLAGS) return MX_STATUS_INVALID_PARAM;
+    
+    matchx::Context* context = reinterpret_cast<matchx::Context*>(ctx);
+    context->set_capacity_hints(max_orders, price_levels, arena_flags);
+    return MX_STATUS_OK;
+}
+
+int mx_context_get_arena_stats(const mx_context_t* ctx, mx_arena_stats_t* stats) {
+    if (!ctx || !stats) return MX_STATUS_INVALID_PARAM;
+    
+    const matchx::Context* context = reinterpret_cast<const matchx::Context*>(ctx);
+    const matchx::Arena& arena = context->arena_state();
+    stats->reserved_bytes = arena.reserved_bytes();
+    stats->used_bytes = arena.used_bytes();
+    stats->huge_page_bytes = arena.huge_page_bytes();
+    stats->region_count = arena.region_count();
+    stats->flags = context->config().arena_flags;
+    return MX_STATUS_OK;
+}
+
+int mx_context_set_price_bounds(mx_context_t* ctx,
+                                uint32_t min_price,
+                                uint32_t max_price,
+                                uint32_t tick_size) {
+    if (!ctx) return MX_STATUS_INVALID_PARAM;
+    
+    matchx::Context* context = reinterpret_cast<matchx::Context*>(ctx);
+    
+    // 0/0 restores the unbounded defaults
+    if (min_price == 0 && max_price == 0) {
+        matchx::OrderBookConfig defaults;
+        context->set_price_bounds(defaults.min_price, defaults.max_price, defaults.tick_size);
+        return MX_STATUS_OK;
+    }
+    
+    if (matchx::ladder_tick_count(min_price, max_price, tick_size) == 0) {
+        return MX_STATUS_INVALID_PARAM;
+    }
+    
+    context->set_price_bounds(min_price, max_price, tick_size);
+    return MX_STATUS_OK;
+}
+
+int mx_context_set_event_buffer(mx_context_t* ctx, uint32_t capacity) {
+    if (!ctx) return MX_STATUS_INVALID_PARAM;
+    
+    matchx::Context* context = reinterpret_cast<matchx::Context*>(ctx);
+    context->set_event_buffer(capacity);
+    return MX_STATUS_OK;
+}
+
+int mx_context_set_latency_tracking(mx_context_t* ctx, int enable) {
+    if (!ctx) return MX_STATUS_INVALID_PARAM;
+    
+    matchx::Context* context = reinterpret_cast<matchx::Context*>(ctx);
+    context->set_latency_tracking(enable != 0);
+    return MX_STATUS_OK;
+}
+
+int mx_context_set_book_view(mx_context_t* ctx, int enable, uint32_t levels) {
+    if (!ctx || levels > MX_BOOK_VIEW_LEVELS) return MX_STATUS_INVALID_PARAM;
+    
+    matchx::Context* context = reinterpret_cast<matchx::Context*>(ctx);
+    context->set_book_view(enable != 0, levels);
+    return MX_STATUS_OK;
+}
+
+int mx_context_set_trace(mx_context_t* ctx,
+                         uint32_t capacity,
+                         mx_trace_sink_t sink,
+                         void* user_data) {
+    if (!ctx) return MX_STATUS_INVALID_PARAM;
+#ifdef MX_TRACE
+    matchx::Context* context = reinterpret_cast<matchx::Context*>(ctx);
+    return context->trace_ring().init(capacity, sink, user_data)
+        ? MX_STATUS_OK : MX_STATUS_OUT_OF_MEMORY;
+#else
+    MX_UNUSED(capacity);
+    MX_UNUSED(sink);
+    MX_UNUSED(user_data);
+    return MX_STATUS_ERROR;
+#endif
+}
+
+uint32_t mx_context_read_trace(mx_context_t* ctx,
+                               mx_trace_record_t* records,
+                               uint32_t max_records) {
+    if (!ctx || !records) return 0;
+    
+    matchx::Context* context = reinterpret_cast<matchx::Context*>(ctx);
+    return context->trace_ring().read(records, max_records);
+}
+
+uint32_t mx_context_flush_trace(mx_context_t* ctx) {
+    if (!ctx) return 0;
+    
+    matchx::Context* context = reinterpret_cast<matchx::Context*>(ctx);
+    return context->trace_ring().flush();
+}
+
+uint64_t mx_context_trace_overwritten(const mx_context_t* ctx) {
+    if (!ctx) return 0;
+    
+    const matchx::Context* context = reinterpret_cast<const matchx::Context*>(ctx);
+    return context->trace_ring().overwritten();
+}
+
 } // extern "C"
@@ -17,26 +17,82 @@ namespace matchx {
 OrderBook::OrderBook(Context* ctx, const char* symbol)
     : symbol_(nullptr)
     , context_(ctx)
-    , order_pool_(ctx->config().expected_max_orders)
+    , order_pool_(ctx->config().expected_max_orders, reserve_arena(ctx))
     , bid_levels_()
     , ask_levels_()
-    , stop_orders_()
+    , buy_stops_()
+    , sell_stops_()
+    , stop_ladders_built_(false)
     , best_bid_(0)
     , best_ask_(0)
+    , bid_depth_(MX_SIDE_BUY)
+    , ask_depth_(MX_SIDE_SELL)
     , total_trades_(0)
-    , total_volume_(0) {
+    , total_volume_(0)
+    , events_()
+    , latency_(nullptr)
+    , view_(nullptr)
+    , call_depth_(0) {
     
     // Copy symbol string
     if (symbol) {
         symbol_ = mx_strdup(symbol);
     }
     
-    // Reserve capacity in stop orders map
-    stop_orders_.reserve(1000);
+    // Bounded instruments get the tick-indexed ladder on both sides; the
+    // stop sides follow with the first stop order (build_stop_ladders)
+    const OrderBookConfig& config = ctx->config();
+    if (config.has_price_bounds()) {
+        Arena* arena = ctx->arena();
+        bool bids_ok = bid_levels_.init_ladder(config.min_price, config.max_price, config.tick_size, arena);
+        bool asks_ok = bids_ok &&
+                       ask_levels_.init_ladder(config.min_price, config.max_price, config.tick_size, arena);
+        if (!asks_ok) {
+            // Out of memory - keep both sides on the map so they agree on accepted prices
+            bid_levels_.release_ladder();
+        }
+    }
+    
+    // Buffered events replace callbacks; on allocation failure the book
+    // keeps delivering through callbacks rather than losing events
+    if (config.event_buffer_capacity > 0) {
+        events_.init(config.event_buffer_capacity);
+    }
+    
+    if (config.track_latency) {
+        latency_ = new LatencyHistogram[MX_LATENCY_OP_COUNT];
+    }
+    
+    // Without the view readers get MX_STATUS_ERROR, matching has no cost
+    if (config.publish_view) {
+        view_ = BookView::create(config.view_levels);
+    }
+}
+
+Arena* OrderBook::reserve_arena(Context* ctx) {
+    Arena* arena = ctx->arena();
+    if (!arena) return nullptr;
+    
+    // Map the whole footprint as one region up front so matching never
+    // takes the first-touch fault; a refused mapping leaves allocate()
+    // to map on demand (and fall back to mx_malloc if that fails too).
+    // Stop ladders are left out: most books never see a stop
+    const OrderBookConfig& config = ctx->config();
+    ArenaPlan plan;
+    OrderPool::footprint(config.expected_max_orders, plan);
+    if (config.has_price_bounds()) {
+        for (int i = 0; i < 2; i++) {       // Bids and asks
+            PriceLadder::footprint(config.min_price, config.max_price, config.tick_size, plan);
+        }
+    }
+    arena->reserve(plan);
+    return arena;
 }
 
 OrderBook::~OrderBook() {
     clear();
+    delete[] latency_;
+    BookView::destroy(view_);
     
     if (symbol_) {
         mx_free(symbol_);
@@ -50,47 +106,51 @@ OrderBook::~OrderBook() {
 
 mx_status_t OrderBook::add_limit_order(OrderId order_id, Side side,
                                        Price price, Quantity quantity) {
+    CallScope scope(this);
+    LatencyTimer timer(latency_histogram(MX_LATENCY_ADD));
+    
     // Validate parameters
     if (order_id == INVALID_ORDER_ID) return MX_STATUS_INVALID_PARAM;
     if (price == 0) return MX_STATUS_INVALID_PRICE;
+    if (!is_price_in_band(price)) return MX_STATUS_INVALID_PRICE;
     if (quantity == 0) return MX_STATUS_INVALID_QUANTITY;
     
-    // Check for duplicate
-    if (order_pool_.has_order(order_id)) {
-        return MX_STATUS_DUPLICATE_ORDER;
-    }
-    
-    // Create order
+    // Create order (the pool rejects duplicates in the same hash probe)
     Timestamp now = get_current_timestamp();
     Order* order = order_pool_.create_order(order_id, side, price, quantity, now);
     
     if (!order) {
-        return MX_STATUS_OUT_OF_MEMORY;
+        return create_failure_status(order_id);
     }
     
-    // Process the order
-    return process_new_order(order);
+    // Process the order, then fire any stops it pushed the market through
+    mx_status_t status = process_new_order(order);
+    trigger_stops();
+    return status;
 }
 
 mx_status_t OrderBook::add_market_order(OrderId order_id, Side side, Quantity quantity) {
+    CallScope scope(this);
+    LatencyTimer timer(latency_histogram(MX_LATENCY_ADD));
+    
     if (order_id == INVALID_ORDER_ID) return MX_STATUS_INVALID_PARAM;
     if (quantity == 0) return MX_STATUS_INVALID_QUANTITY;
     
-    if (order_pool_.has_order(order_id)) {
-        return MX_STATUS_DUPLICATE_ORDER;
-    }
-    
     Timestamp now = get_current_timestamp();
     Order* order = order_pool_.create_market_order(order_id, side, quantity, now);
     
     if (!order) {
-        return MX_STATUS_OUT_OF_MEMORY;
+        return create_failure_status(order_id);
     }
     
-    return process_new_order(order);
+    mx_status_t status = process_new_order(order);
+    trigger_stops();
+    return status;
 }
 
 mx_status_t OrderBook::cancel_order(OrderId order_id) {
+    CallScope scope(this);
+    LatencyTimer timer(latency_histogram(MX_LATENCY_CANCEL));
     Order* order = order_pool_.find_order(order_id);
     
     if (!order) {
@@ -98,8 +158,8 @@ mx_status_t OrderBook::cancel_order(OrderId order_id) {
     }
     
     // Remove from book or stop orders
-    if (order->is_stop() && order->state() == OrderState::PENDING_NEW) {
-        stop_orders_.erase(order_id);
+    if (is_pending_stop(order)) {
+        remove_from_stop_index(order);
     } else {
         remove_from_book(order);
     }
@@ -114,10 +174,15 @@ mx_status_t OrderBook::cancel_order(OrderId order_id) {
     // Destroy order
     order_pool_.destroy_order(order);
     
+    // Pulling the touch can move the market into resting stops
+    trigger_stops();
+    
     return MX_STATUS_OK;
 }
 
 mx_status_t OrderBook::modify_order(OrderId order_id, Quantity new_quantity) {
+    CallScope scope(this);
+    LatencyTimer timer(latency_histogram(MX_LATENCY_MODIFY));
     Order* order = order_pool_.find_order(order_id);
     
     if (!order) {
@@ -146,6 +211,17 @@ mx_status_t OrderBook::modify_order(OrderId order_id, Quantity new_quantity) {
             
             // Update price level volumes
             level->update_order_volume(order, old_remaining, old_visible);
+            remove_level_volume(order->side(), order->price(), old_remaining - order->remaining_quantity());
+        }
+    } else if (is_pending_stop(order)) {
+        // Keep the stop level's volume in step
+        PriceLevel* level = order->is_buy() ? buy_stops_.find(order->stop_price())
+                                            : sell_stops_.find(order->stop_price());
+        Quantity old_remaining = order->remaining_quantity();
+        Quantity old_visible = order->visible_quantity();
+        order->reduce_quantity(new_quantity);
+        if (level) {
+            level->update_order_volume(order, old_remaining, old_visible);
         }
     } else {
         // Just reduce quantity for non-active orders
@@ -157,22 +233,97 @@ mx_status_t OrderBook::modify_order(OrderId order_id, Quantity new_quantity) {
 
 mx_status_t OrderBook::replace_order(OrderId old_order_id, OrderId new_order_id,
                                      Price new_price, Quantity new_quantity) {
-    // Cancel old order
-    mx_status_t status = cancel_order(old_order_id);
-    if (status != MX_STATUS_OK) {
-        return status;
-    }
+    CallScope scope(this);
+    LatencyTimer timer(latency_histogram(MX_LATENCY_MODIFY));
     
-    // Get old order's side before it's destroyed
-    Order* old_order = order_pool_.find_order(old_order_id);
-    if (!old_order) {
+    if (new_order_id == INVALID_ORDER_ID) new_order_id = old_order_id;
+    if (new_price == 0 || !is_price_in_band(new_price)) return MX_STATUS_INVALID_PRICE;
+    
+    Order* order = order_pool_.find_order(old_order_id);
+    if (!order) {
         return MX_STATUS_ORDER_NOT_FOUND;
     }
     
-    Side side = old_order->side();
+    // Only resting orders are amended; stops wait outside the book
+    if (!order->is_linked() || is_pending_stop(order)) {
+        return MX_STATUS_INVALID_PARAM;
+    }
+    if (new_quantity <= order->filled_quantity()) {
+        return MX_STATUS_INVALID_QUANTITY;
+    }
+    
+    Side side = order->side();
+    Price old_price = order->price();
+    bool keeps_priority = (new_price == old_price && new_quantity <= order->total_quantity());
+    
+    // Post-only orders may not be repriced into the other side
+    if (!keeps_priority && order->is_post_only()) {
+        bool crosses = (side == MX_SIDE_BUY) ? (best_ask_ > 0 && new_price >= best_ask_)
+                                             : (best_bid_ > 0 && new_price <= best_bid_);
+        if (crosses) return MX_STATUS_WOULD_MATCH;
+    }
+    
+    // Checked last, so a failed replace leaves the order untouched
+    if (new_order_id != old_order_id) {
+        if (order_pool_.has_order(new_order_id)) return MX_STATUS_DUPLICATE_ORDER;
+        if (!order_pool_.rekey_order(order, new_order_id)) return MX_STATUS_OUT_OF_MEMORY;
+    }
     
-    // Add new order (loses time priority)
-    return add_limit_order(new_order_id, side, new_price, new_quantity);
+    // Same price, no more quantity: shrink in place and keep the queue spot
+    if (keeps_priority) {
+        if (new_quantity < order->total_quantity()) {
+            PriceLevel* level = get_level(side, old_price);
+            MX_ASSERT(level != nullptr);
+            Quantity old_remaining = order->remaining_quantity();
+            Quantity old_visible = order->visible_quantity();
+            order->reduce_quantity(new_quantity);
+            level->update_order_volume(order, old_remaining, old_visible);
+            remove_level_volume(side, old_price, old_remaining - order->remaining_quantity());
+        }
+        notify_order_event(order->order_id(), MX_EVENT_ORDER_REPLACED,
+                          order->filled_quantity(), order->remaining_quantity());
+        return MX_STATUS_OK;
+    }
+    
+    // Otherwise the same slot leaves its level and re-enters as an
+    // aggressor at the new price, behind everything already there
+    PriceLevel* level = get_level(side, old_price);
+    MX_ASSERT(level != nullptr);
+    remove_level_volume(side, old_price, order->remaining_quantity());
+    level->remove_order(order);
+    if (level->empty()) {
+        if (side == MX_SIDE_BUY) {
+            bid_levels_.erase(level);
+            update_best_bid();
+        } else {
+            ask_levels_.erase(level);
+            update_best_ask();
+        }
+    }
+    
+    order->amend(new_price, new_quantity);
+    notify_order_event(order->order_id(), MX_EVENT_ORDER_REPLACED,
+                      order->filled_quantity(), order->remaining_quantity());
+    
+    Quantity filled_before = order->filled_quantity();
+    match_order(order);
+    
+    if (order->is_filled()) {
+        notify_order_event(order->order_id(), MX_EVENT_ORDER_FILLED,
+                         order->filled_quantity(), 0);
+        order_pool_.destroy_order(order);
+    } else {
+        add_to_book(order);
+        if (order->filled_quantity() > filled_before) {
+            notify_order_event(order->order_id(), MX_EVENT_ORDER_PARTIAL,
+                             order->filled_quantity(), order->remaining_quantity());
+        }
+    }
+    
+    // Moving the touch (or trading through it) can fire resting stops
+    trigger_stops();
+    
+    return MX_STATUS_OK;
 }
 
 /* ============================================================================
@@ -183,6 +334,8 @@ mx_status_t OrderBook::add_order(OrderId order_id, OrderType order_type, Side si
                                  Price price, Price stop_price, Quantity quantity,
                                  Quantity display_qty, TimeInForce tif, uint32_t flags,
                                  uint64_t expire_time) {
+    CallScope scope(this);
+    LatencyTimer timer(latency_histogram(MX_LATENCY_ADD));
     
     // Validate
     mx_status_t status = validate_order(order_id, order_type, side, price, 
@@ -199,16 +352,166 @@ mx_status_t OrderBook::add_order(OrderId order_id, OrderType order_type, Side si
     );
     
     if (!order) {
-        return MX_STATUS_OUT_OF_MEMORY;
+        return create_failure_status(order_id);
     }
     
     // Handle stop orders separately
+    mx_status_t result;
     if (order->is_stop()) {
-        return handle_stop_order(order);
+        result = handle_stop_order(order);
+    } else {
+        // Process regular order
+        result = process_new_order(order);
     }
     
-    // Process regular order
-    return process_new_order(order);
+    trigger_stops();
+    return result;
+}
+
+/* ============================================================================
+ * Batch Operations
+ * ========================================================================= */
+
+uint32_t OrderBook::submit_batch(const mx_command_t* commands, int* statuses, uint32_t count) {
+    // The clock is read once here and commands run as nested calls, so
+    // the whole batch is stamped with one time
+    CallScope scope(this, true);
+    
+    uint32_t ok_count = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        mx_status_t status = execute_command(commands[i]);
+        if (statuses) {
+            statuses[i] = status;
+        }
+        if (status == MX_STATUS_OK) {
+            ++ok_count;
+        }
+    }
+    
+    return ok_count;
+}
+
+mx_status_t OrderBook::execute_command(const mx_command_t& command) {
+    switch (command.type) {
+        case MX_CMD_NEW: {
+            if (command.side > MX_SIDE_SELL ||
+                command.order_type > MX_ORDER_TYPE_STOP_LIMIT ||
+                command.tif > MX_TIF_GTD) {
+                return MX_STATUS_INVALID_PARAM;
+            }
+            
+            Side side = static_cast<Side>(command.side);
+            OrderType order_type = static_cast<OrderType>(command.order_type);
+            TimeInForce tif = static_cast<TimeInForce>(command.tif);
+            
+            // Plain GTC limits take the lighter simple-API path
+            if (order_type == MX_ORDER_TYPE_LIMIT && tif == MX_TIF_GTC &&
+                command.flags == MX_ORDER_FLAG_NONE && command.display_qty == 0 &&
+                command.expire_time == 0) {
+                return add_limit_order(command.order_id, side, command.price, command.quantity);
+            }
+            
+            return add_order(command.order_id, order_type, side, command.price,
+                             command.stop_price, command.quantity, command.display_qty,
+                             tif, command.flags, command.expire_time);
+        }
+        
+        case MX_CMD_CANCEL:
+            return cancel_order(command.order_id);
+        
+        case MX_CMD_MODIFY:
+            return modify_order(command.order_id, command.quantity);
+        
+        case MX_CMD_REPLACE:
+            return replace_order(command.order_id, command.order_id, command.price, command.quantity);
+        
+        default:
+            return MX_STATUS_INVALID_PARAM;
+    }
+}
+
+/* ============================================================================
+ * Owners and Mass Cancel
+ * ========================================================================= */
+
+mx_status_t OrderBook::set_owner(OrderId order_id, OwnerId owner) {
+    Order* order = order_pool_.find_order(order_id);
+    if (!order) {
+        return MX_STATUS_ORDER_NOT_FOUND;
+    }
+    
+    return order_pool_.set_owner(order, owner) ? MX_STATUS_OK : MX_STATUS_OUT_OF_MEMORY;
+}
+
+uint32_t OrderBook::mass_cancel(OwnerId owner, mx_side_filter_t side_filter) {
+    CallScope scope(this);
+    if (owner == NO_OWNER) return 0;
+    
+    // Pass 1: unlink the owner's orders. Consecutive orders at one price
+    // share a level lookup, each level is freed once when it empties and
+    // best prices are recomputed once at the end
+    uint32_t unlinked = 0;
+    bool bids_changed = false;
+    bool asks_changed = false;
+    PriceLevel* level = nullptr;
+    Side level_side = MX_SIDE_BUY;
+    Price level_price = 0;
+    
+    for (Order* order = order_pool_.owner_head(owner); order; order = order->next_owned()) {
+        Side side = order->side();
+        if (side_filter != MX_SIDE_FILTER_BOTH && static_cast<int>(side) != static_cast<int>(side_filter)) {
+            continue;
+        }
+        
+        if (is_pending_stop(order)) {
+            remove_from_stop_index(order);
+        } else if (order->is_linked()) {
+            Price price = order->price();
+            if (!level || side != level_side || price != level_price) {
+                level = get_level(side, price);
+                level_side = side;
+                level_price = price;
+            }
+            MX_ASSERT(level != nullptr);
+            
+            remove_level_volume(side, price, order->remaining_quantity());
+            level->remove_order(order);
+            if (level->empty()) {
+                if (side == MX_SIDE_BUY) {
+                    bid_levels_.erase(level);
+                } else {
+                    ask_levels_.erase(level);
+                }
+                level = nullptr;
+            }
+            (side == MX_SIDE_BUY ? bids_changed : asks_changed) = true;
+        }
+        
+        order->cancel();
+        ++unlinked;
+    }
+    
+    if (unlinked == 0) return 0;
+    if (bids_changed) update_best_bid();
+    if (asks_changed) update_best_ask();
+    
+    // Pass 2: report and free them, so callbacks already see the final book
+    uint32_t cancelled = 0;
+    Order* next;
+    for (Order* order = order_pool_.owner_head(owner); order && cancelled < unlinked; order = next) {
+        next = order->next_owned();
+        if (!order->is_cancelled()) continue;
+        
+        notify_order_event(order->order_id(), MX_EVENT_ORDER_CANCELLED,
+                          order->filled_quantity(), 0);
+        order_pool_.destroy_order(order);
+        ++cancelled;
+    }
+    
+    // Pulling the touch can move the market into resting stops
+    trigger_stops();
+    
+    return cancelled;
 }
 
 /* ============================================================================
@@ -284,255 +587,100 @@ mx_status_t OrderBook::process_new_order(Order* order) {
     return result.status;
 }
 
-MatchResult OrderBook::match_order(Order* order) {
-    if (order->is_market()) {
-        return match_market_order(order);
-    } else {
-        return match_limit_order(order);
+/* ============================================================================
+ * Matching
+ * One sweep loop serves every aggressor side and order type. The contra
+ * side is a template parameter and a price policy decides, at compile
+ * time, whether the next level is still reachable.
+ * ========================================================================= */
+
+namespace {
+
+/* Limit orders stop at the first level priced through their limit */
+struct LimitPricePolicy {
+    template<Side ContraSide>
+    static MX_FORCE_INLINE bool crosses(const Order* order, Price level_price) {
+        return !BookSide<ContraSide>::is_better(order->price(), level_price);
     }
-}
+};
 
-MatchResult OrderBook::match_limit_order(Order* order) {
-    MatchResult result;
-    result.status = MX_STATUS_OK;
-    
-    Timestamp now = get_current_timestamp();
+/* Market orders take whatever is there */
+struct MarketPricePolicy {
+    template<Side ContraSide>
+    static MX_FORCE_INLINE bool crosses(const Order*, Price) {
+        return true;
+    }
+};
+
+} // anonymous namespace
+
+MatchResult OrderBook::match_order(Order* order) {
+    uint64_t start = latency_ ? read_cycle_counter() : 0;
     
-    if (order->is_buy()) {
-        // Buy order matches against asks (ascending)
-        auto it = ask_levels_.begin();
-        while (it != ask_levels_.end() && order->remaining_quantity() > 0) {
-            PriceLevel& level = it->second;
-            
-            // Check if price allows matching
-            if (order->price() < level.price()) {
-                break; // No more matchable prices
-            }
-            
-            // Collect filled orders for cleanup
-            std::vector<OrderId> filled_orders;
-            
-            // Match at this level
-            Quantity matched = level.match_orders(
-                order, 
-                order->remaining_quantity(),
-                [this, now, &filled_orders](OrderId agg_id, OrderId pass_id, Price price, Quantity qty, Timestamp ts) {
-                    this->notify_trade(agg_id, pass_id, price, qty, now);
-                    
-                    // Check passive order state after fill
-                    Order* passive_order = order_pool_.find_order(pass_id);
-                    if (passive_order) {
-                        if (passive_order->is_filled()) {
-                            filled_orders.push_back(pass_id);
-                        } else if (passive_order->filled_quantity() > 0) {
-                            // Passive order partially filled - notify
-                            notify_order_event(pass_id, MX_EVENT_ORDER_PARTIAL,
-                                             passive_order->filled_quantity(),
-                                             passive_order->remaining_quantity());
-                        }
-                    }
-                },
-                now
-            );
-            
-            result.matched_quantity += matched;
-            total_trades_++;
-            total_volume_ += matched;
-            
-            // Destroy fully filled passive orders (already removed from level by match_orders)
-            for (OrderId filled_id : filled_orders) {
-                Order* filled_order = order_pool_.find_order(filled_id);
-                if (filled_order) {
-                    notify_order_event(filled_id, MX_EVENT_ORDER_FILLED,
-                                     filled_order->filled_quantity(), 0);
-                    order_pool_.destroy_order(filled_order);
-                }
-            }
-            
-            // Remove level if empty
-            if (level.empty()) {
-                it = ask_levels_.erase(it);
-                update_best_ask();
-            } else {
-                ++it;
-            }
-        }
+    MatchResult result;
+    if (order->is_market()) {
+        result = order->is_buy()
+            ? match_against<MarketPricePolicy>(order, ask_levels_)   // Market buy matches against asks
+            : match_against<MarketPricePolicy>(order, bid_levels_);  // Market sell matches against bids
     } else {
-        // Sell order matches against bids (descending)
-        auto it = bid_levels_.begin();
-        while (it != bid_levels_.end() && order->remaining_quantity() > 0) {
-            PriceLevel& level = it->second;
-            
-            // Check if price allows matching
-            if (order->price() > level.price()) {
-                break; // No more matchable prices
-            }
-            
-            // Collect filled orders for cleanup
-            std::vector<OrderId> filled_orders;
-            
-            // Match at this level
-            Quantity matched = level.match_orders(
-                order,
-                order->remaining_quantity(),
-                [this, now, &filled_orders](OrderId agg_id, OrderId pass_id, Price price, Quantity qty, Timestamp ts) {
-                    this->notify_trade(agg_id, pass_id, price, qty, now);
-                    
-                    // Check passive order state after fill
-                    Order* passive_order = order_pool_.find_order(pass_id);
-                    if (passive_order) {
-                        if (passive_order->is_filled()) {
-                            filled_orders.push_back(pass_id);
-                        } else if (passive_order->filled_quantity() > 0) {
-                            // Passive order partially filled - notify
-                            notify_order_event(pass_id, MX_EVENT_ORDER_PARTIAL,
-                                             passive_order->filled_quantity(),
-                                             passive_order->remaining_quantity());
-                        }
-                    }
-                },
-                now
-            );
-            
-            result.matched_quantity += matched;
-            total_trades_++;
-            total_volume_ += matched;
-            
-            // Destroy fully filled passive orders (already removed from level by match_orders)
-            for (OrderId filled_id : filled_orders) {
-                Order* filled_order = order_pool_.find_order(filled_id);
-                if (filled_order) {
-                    notify_order_event(filled_id, MX_EVENT_ORDER_FILLED,
-                                     filled_order->filled_quantity(), 0);
-                    order_pool_.destroy_order(filled_order);
-                }
-            }
-            
-            // Remove level if empty
-            if (level.empty()) {
-                it = bid_levels_.erase(it);
-                update_best_bid();
-            } else {
-                ++it;
-            }
-        }
+        result = order->is_buy()
+            ? match_against<LimitPricePolicy>(order, ask_levels_)    // Buy order matches against asks (ascending)
+            : match_against<LimitPricePolicy>(order, bid_levels_);   // Sell order matches against bids (descending)
     }
     
-    result.remaining_quantity = order->remaining_quantity();
-    result.fully_matched = (result.remaining_quantity == 0);
-    
+    // Only sweeps that traded count - a resting add's empty pass is not a match
+    if (latency_ && result.matched_quantity > 0) {
+        latency_[MX_LATENCY_MATCH].record(read_cycle_counter() - start);
+    }
     return result;
 }
 
-MatchResult OrderBook::match_market_order(Order* order) {
+template<typename PricePolicy, Side ContraSide>
+MatchResult OrderBook::match_against(Order* order, BookSide<ContraSide>& levels) {
     MatchResult result;
     result.status = MX_STATUS_OK;
     
     Timestamp now = get_current_timestamp();
+    Price& best_contra = (ContraSide == MX_SIDE_BUY) ? best_bid_ : best_ask_;
+    DepthCache& contra_depth = depth_cache(ContraSide);
+    
+    // Passive orders are retired as they fill - no per-level buffers,
+    // and no lookups by ID for an order we already hold
+    auto on_fill = [this, order, now](Order* passive, Price price, Quantity qty) {
+        notify_trade(order->order_id(), passive->order_id(), price, qty, now);
+        ++total_trades_;
+        
+        if (passive->is_filled()) {
+            // Already unlinked from the level by match_orders
+            notify_order_event(passive->order_id(), MX_EVENT_ORDER_FILLED,
+                             passive->filled_quantity(), 0);
+            order_pool_.destroy_order(passive);
+        } else {
+            // Passive order partially filled - notify
+            notify_order_event(passive->order_id(), MX_EVENT_ORDER_PARTIAL,
+                             passive->filled_quantity(), passive->remaining_quantity());
+        }
+    };
     
-    if (order->is_buy()) {
-        // Market buy matches against asks
-        auto it = ask_levels_.begin();
-        while (it != ask_levels_.end() && order->remaining_quantity() > 0) {
-            PriceLevel& level = it->second;
-            
-            // Collect filled orders for cleanup
-            std::vector<OrderId> filled_orders;
-            
-            Quantity matched = level.match_orders(
-                order,
-                order->remaining_quantity(),
-                [this, now, &filled_orders](OrderId agg_id, OrderId pass_id, Price price, Quantity qty, Timestamp ts) {
-                    this->notify_trade(agg_id, pass_id, price, qty, now);
-                    
-                    // Check passive order state after fill
-                    Order* passive_order = order_pool_.find_order(pass_id);
-                    if (passive_order) {
-                        if (passive_order->is_filled()) {
-                            filled_orders.push_back(pass_id);
-                        } else if (passive_order->filled_quantity() > 0) {
-                            // Passive order partially filled - notify
-                            notify_order_event(pass_id, MX_EVENT_ORDER_PARTIAL,
-                                             passive_order->filled_quantity(),
-                                             passive_order->remaining_quantity());
-                        }
-                    }
-                },
-                now
-            );
-            
-            result.matched_quantity += matched;
-            total_trades_++;
-            total_volume_ += matched;
-            
-            // Destroy fully filled passive orders (already removed from level by match_orders)
-            for (OrderId filled_id : filled_orders) {
-                Order* filled_order = order_pool_.find_order(filled_id);
-                if (filled_order) {
-                    notify_order_event(filled_id, MX_EVENT_ORDER_FILLED,
-                                     filled_order->filled_quantity(), 0);
-                    order_pool_.destroy_order(filled_order);
-                }
-            }
-            
-            if (level.empty()) {
-                it = ask_levels_.erase(it);
-                update_best_ask();
-            } else {
-                ++it;
-            }
+    PriceLevel* level;
+    while (order->remaining_quantity() > 0 && (level = levels.best()) != nullptr) {
+        // Check if price allows matching
+        if (!PricePolicy::template crosses<ContraSide>(order, level->price())) {
+            break; // No more matchable prices
         }
-    } else {
-        // Market sell matches against bids
-        auto it = bid_levels_.begin();
-        while (it != bid_levels_.end() && order->remaining_quantity() > 0) {
-            PriceLevel& level = it->second;
-            
-            // Collect filled orders for cleanup
-            std::vector<OrderId> filled_orders;
-            
-            Quantity matched = level.match_orders(
-                order,
-                order->remaining_quantity(),
-                [this, now, &filled_orders](OrderId agg_id, OrderId pass_id, Price price, Quantity qty, Timestamp ts) {
-                    this->notify_trade(agg_id, pass_id, price, qty, now);
-                    
-                    // Check passive order state after fill
-                    Order* passive_order = order_pool_.find_order(pass_id);
-                    if (passive_order) {
-                        if (passive_order->is_filled()) {
-                            filled_orders.push_back(pass_id);
-                        } else if (passive_order->filled_quantity() > 0) {
-                            // Passive order partially filled - notify
-                            notify_order_event(pass_id, MX_EVENT_ORDER_PARTIAL,
-                                             passive_order->filled_quantity(),
-                                             passive_order->remaining_quantity());
-                        }
-                    }
-                },
-                now
-            );
-            
-            result.matched_quantity += matched;
-            total_trades_++;
-            total_volume_ += matched;
-            
-            // Destroy fully filled passive orders (already removed from level by match_orders)
-            for (OrderId filled_id : filled_orders) {
-                Order* filled_order = order_pool_.find_order(filled_id);
-                if (filled_order) {
-                    notify_order_event(filled_id, MX_EVENT_ORDER_FILLED,
-                                     filled_order->filled_quantity(), 0);
-                    order_pool_.destroy_order(filled_order);
-                }
-            }
-            
-            if (level.empty()) {
-                it = bid_levels_.erase(it);
-                update_best_bid();
-            } else {
-                ++it;
-            }
+        
+        Quantity matched = level->match_orders(order, order->remaining_quantity(), on_fill);
+        contra_depth.remove(level->price(), matched);
+        levels.remove_volume(level->price(), matched);
+        
+        result.matched_quantity += matched;
+        total_volume_ += matched;
+        
+        if (level->empty()) {
+            levels.erase(level);
+            best_contra = levels.best_price();
+        } else {
+            break; // Level still has liquidity, so the aggressor is done
         }
     }
     
@@ -595,12 +743,12 @@ mx_status_t OrderBook::handle_stop_order(Order* order) {
     // Check if already triggered
     if (should_trigger_stop(order)) {
         // Trigger immediately
-        order->trigger_stop();
+        activate_stop(order);
         return process_new_order(order);
     }
     
-    // Add to stop orders map
-    stop_orders_[order->order_id()] = order;
+    // Park in the stop index until the market reaches the stop price
+    add_to_stop_index(order);
     
     notify_order_event(order->order_id(), MX_EVENT_ORDER_ACCEPTED, 0, 
                       order->remaining_quantity());
@@ -608,6 +756,99 @@ mx_status_t OrderBook::handle_stop_order(Order* order) {
     return MX_STATUS_OK;
 }
 
+void OrderBook::activate_stop(Order* order) {
+    // Convert to a plain limit/market order that enters the book as new
+    order->trigger_stop();
+    order->set_state(OrderState::ACTIVE);
+}
+
+/* ============================================================================
+ * Stop Index
+ * Pending stops sit in PriceLevel queues keyed by stop price, so the
+ * next stop to fire is always at the front of the best stop level and
+ * the book never scans stops that are nowhere near the market
+ * ========================================================================= */
+
+void OrderBook::add_to_stop_index(Order* order) {
+    MX_ASSERT(is_pending_stop(order));
+    
+    if (MX_UNLIKELY(!stop_ladders_built_)) {
+        build_stop_ladders();
+    }
+    
+    if (order->is_buy()) {
+        buy_stops_.find_or_create(order->stop_price())->add_order(order);
+    } else {
+        sell_stops_.find_or_create(order->stop_price())->add_order(order);
+    }
+}
+
+void OrderBook::remove_from_stop_index(Order* order) {
+    MX_ASSERT(is_pending_stop(order));
+    
+    if (order->is_buy()) {
+        PriceLevel* level = buy_stops_.find(order->stop_price());
+        MX_ASSERT(level != nullptr);
+        level->remove_order(order);
+        if (level->empty()) buy_stops_.erase(level);
+    } else {
+        PriceLevel* level = sell_stops_.find(order->stop_price());
+        MX_ASSERT(level != nullptr);
+        level->remove_order(order);
+        if (level->empty()) sell_stops_.erase(level);
+    }
+}
+
+void OrderBook::build_stop_ladders() {
+    stop_ladders_built_ = true;
+    if (!bid_levels_.uses_ladder()) return;
+    
+    // Same band as the book, whatever the context's bounds are now
+    const PriceLadder& band = bid_levels_.ladder();
+    Arena* arena = context_->arena();
+    bool buys_ok = buy_stops_.init_ladder(band.min_price(), band.max_price(), band.tick_size(), arena);
+    bool sells_ok = buys_ok &&
+                    sell_stops_.init_ladder(band.min_price(), band.max_price(), band.tick_size(), arena);
+    if (!sells_ok) {
+        buy_stops_.release_ladder();
+    }
+}
+
+Order* OrderBook::next_triggered_stop() const {
+    // Buy stops fire lowest stop first once the ask trades up to them
+    const PriceLevel* buy_level = buy_stops_.best();
+    if (buy_level && best_ask_ > 0 && best_ask_ >= buy_level->price()) {
+        return buy_level->front();
+    }
+    
+    // Sell stops fire highest stop first once the bid trades down to them
+    const PriceLevel* sell_level = sell_stops_.best();
+    if (sell_level && best_bid_ > 0 && best_bid_ <= sell_level->price()) {
+        return sell_level->front();
+    }
+    
+    return nullptr;
+}
+
+uint32_t OrderBook::run_stop_cascade() {
+    uint32_t triggered_count = 0;
+    
+    // Each triggered stop trades against the book and may move the market
+    // into further stops, so re-check against the live best prices each time
+    while (Order* order = next_triggered_stop()) {
+        remove_from_stop_index(order);
+        
+        activate_stop(order);
+        notify_order_event(order->order_id(), MX_EVENT_ORDER_TRIGGERED,
+                          0, order->remaining_quantity());
+        
+        process_new_order(order);
+        ++triggered_count;
+    }
+    
+    return triggered_count;
+}
+
 bool OrderBook::should_trigger_stop(const Order* stop_order) const {
     if (!stop_order->is_stop()) return false;
     
@@ -630,18 +871,11 @@ void OrderBook::add_to_book(Order* order) {
     MX_ASSERT(order != nullptr);
     MX_ASSERT(!order->is_market()); // Market orders don't go in book
     
-    if (order->order_id() == 1) {
-        printf("[DEBUG] add_to_book: order_id=1, price=%u, side=%d, is_linked_before=%d\n",
-               order->price(), order->side(), order->is_linked() ? 1 : 0);
-    }
-    
     PriceLevel* level = get_or_create_level(order->side(), order->price());
     level->add_order(order);
-    
-    if (order->order_id() == 1) {
-        printf("[DEBUG] add_to_book: after add_order - is_linked_after=%d, level_count=%u\n",
-               order->is_linked() ? 1 : 0, level->order_count());
-    }
+    add_level_volume(order->side(), order->price(), order->remaining_quantity());
+    MX_TRACE_POINT(context_, MX_TRACE_BOOK_ADD, order->order_id(), order->side(),
+                   order->price(), order->remaining_quantity(), level->order_count());
     
     // Update best prices
     if (order->is_buy()) {
@@ -659,48 +893,39 @@ void OrderBook::remove_from_book(Order* order) {
     MX_ASSERT(order != nullptr);
     
     if (!order->is_active() && !order->is_partially_filled()) {
-        printf("[DEBUG] remove_from_book: order not active/partial, returning early\n");
+        MX_TRACE_POINT(context_, MX_TRACE_REMOVE_NOT_RESTING, order->order_id(), order->side(),
+                       order->price(), order->remaining_quantity(), 0);
         return; // Not in book
     }
     
-    printf("[DEBUG] remove_from_book: order_id=%llu, price=%u, side=%d, is_linked=%d\n",
-           (unsigned long long)order->order_id(), order->price(), 
-           order->side(), order->is_linked() ? 1 : 0);
-    
     PriceLevel* level = get_level(order->side(), order->price());
-    printf("[DEBUG] remove_from_book: level=%p\n", (void*)level);
+    if (!level) {
+        MX_TRACE_POINT(context_, MX_TRACE_REMOVE_NO_LEVEL, order->order_id(), order->side(),
+                       order->price(), order->remaining_quantity(), 0);
+        return;
+    }
     
-    if (level) {
-        printf("[DEBUG] remove_from_book: level exists, order_count=%u, empty=%d\n",
-               level->order_count(), level->empty() ? 1 : 0);
-        
-        // Only try to remove from level if order is actually linked
-        if (order->is_linked()) {
-            printf("[DEBUG] remove_from_book: removing order from level\n");
-            level->remove_order(order);
-            printf("[DEBUG] remove_from_book: after remove - order_count=%u, empty=%d\n",
-                   level->order_count(), level->empty() ? 1 : 0);
-        } else {
-            printf("[DEBUG] remove_from_book: order not linked, skipping remove\n");
-        }
-        
-        // Always clean up empty levels and update best prices
-        remove_level_if_empty(order->side(), order->price());
-        
-        printf("[DEBUG] remove_from_book: best_bid=%u, checking if need to update\n", best_bid_);
-        
-        // Update best prices if needed
-        if (order->is_buy() && order->price() == best_bid_) {
-            printf("[DEBUG] remove_from_book: updating best bid\n");
-            update_best_bid();
-            printf("[DEBUG] remove_from_book: new best_bid=%u\n", best_bid_);
-        } else if (order->is_sell() && order->price() == best_ask_) {
-            printf("[DEBUG] remove_from_book: updating best ask\n");
-            update_best_ask();
-            printf("[DEBUG] remove_from_book: new best_ask=%u\n", best_ask_);
-        }
+    // Only try to remove from level if order is actually linked
+    if (order->is_linked()) {
+        remove_level_volume(order->side(), order->price(), order->remaining_quantity());
+        level->remove_order(order);
+        MX_TRACE_POINT(context_, MX_TRACE_BOOK_REMOVE, order->order_id(), order->side(),
+                       order->price(), order->remaining_quantity(), level->order_count());
     } else {
-        printf("[DEBUG] remove_from_book: level is NULL!\n");
+        MX_TRACE_POINT(context_, MX_TRACE_REMOVE_NOT_LINKED, order->order_id(), order->side(),
+                       order->price(), order->remaining_quantity(), level->order_count());
+    }
+    
+    // Always clean up empty levels and update best prices
+    remove_level_if_empty(order->side(), order->price());
+    
+    // Update best prices if needed
+    if (order->is_buy() && order->price() == best_bid_) {
+        update_best_bid();
+        MX_TRACE_POINT(context_, MX_TRACE_BEST_PRICE, 0, MX_SIDE_BUY, best_bid_, 0, 0);
+    } else if (order->is_sell() && order->price() == best_ask_) {
+        update_best_ask();
+        MX_TRACE_POINT(context_, MX_TRACE_BEST_PRICE, 0, MX_SIDE_SELL, best_ask_, 0, 0);
     }
 }
 
@@ -710,93 +935,50 @@ void OrderBook::remove_from_book(Order* order) {
 
 PriceLevel* OrderBook::get_or_create_level(Side side, Price price) {
     if (side == MX_SIDE_BUY) {
-        auto it = bid_levels_.find(price);
-        if (it != bid_levels_.end()) {
-            return &it->second;
-        }
-        
-        // Create new level
-        auto result = bid_levels_.emplace(price, PriceLevel(price));
-        return &result.first->second;
+        return bid_levels_.find_or_create(price);
     } else {
-        auto it = ask_levels_.find(price);
-        if (it != ask_levels_.end()) {
-            return &it->second;
-        }
-        
-        auto result = ask_levels_.emplace(price, PriceLevel(price));
-        return &result.first->second;
+        return ask_levels_.find_or_create(price);
     }
 }
 
 PriceLevel* OrderBook::get_level(Side side, Price price) {
     if (side == MX_SIDE_BUY) {
-        auto it = bid_levels_.find(price);
-        return (it != bid_levels_.end()) ? &it->second : nullptr;
+        return bid_levels_.find(price);
     } else {
-        auto it = ask_levels_.find(price);
-        return (it != ask_levels_.end()) ? &it->second : nullptr;
+        return ask_levels_.find(price);
     }
 }
 
 const PriceLevel* OrderBook::get_level(Side side, Price price) const {
     if (side == MX_SIDE_BUY) {
-        auto it = bid_levels_.find(price);
-        return (it != bid_levels_.end()) ? &it->second : nullptr;
+        return bid_levels_.find(price);
     } else {
-        auto it = ask_levels_.find(price);
-        return (it != ask_levels_.end()) ? &it->second : nullptr;
+        return ask_levels_.find(price);
     }
 }
 
 void OrderBook::remove_level_if_empty(Side side, Price price) {
     if (side == MX_SIDE_BUY) {
-        auto it = bid_levels_.find(price);
-        if (it != bid_levels_.end()) {
-            printf("[DEBUG] remove_level_if_empty: found bid level at price=%u, empty=%d, count=%u\n",
-                   price, it->second.empty() ? 1 : 0, it->second.order_count());
-            if (it->second.empty()) {
-                printf("[DEBUG] remove_level_if_empty: erasing bid level\n");
-                bid_levels_.erase(it);
-                printf("[DEBUG] remove_level_if_empty: bid_levels_.size()=%zu\n", bid_levels_.size());
-            } else {
-                printf("[DEBUG] remove_level_if_empty: bid level not empty, not erasing\n");
-            }
-        } else {
-            printf("[DEBUG] remove_level_if_empty: bid level not found at price=%u\n", price);
+        PriceLevel* level = bid_levels_.find(price);
+        if (level && level->empty()) {
+            bid_levels_.erase(level);
+            MX_TRACE_POINT(context_, MX_TRACE_LEVEL_ERASED, 0, side, price, 0, bid_levels_.size());
         }
     } else {
-        auto it = ask_levels_.find(price);
-        if (it != ask_levels_.end()) {
-            printf("[DEBUG] remove_level_if_empty: found ask level at price=%u, empty=%d, count=%u\n",
-                   price, it->second.empty() ? 1 : 0, it->second.order_count());
-            if (it->second.empty()) {
-                printf("[DEBUG] remove_level_if_empty: erasing ask level\n");
-                ask_levels_.erase(it);
-                printf("[DEBUG] remove_level_if_empty: ask_levels_.size()=%zu\n", ask_levels_.size());
-            } else {
-                printf("[DEBUG] remove_level_if_empty: ask level not empty, not erasing\n");
-            }
-        } else {
-            printf("[DEBUG] remove_level_if_empty: ask level not found at price=%u\n", price);
+        PriceLevel* level = ask_levels_.find(price);
+        if (level && level->empty()) {
+            ask_levels_.erase(level);
+            MX_TRACE_POINT(context_, MX_TRACE_LEVEL_ERASED, 0, side, price, 0, ask_levels_.size());
         }
     }
 }
 
 void OrderBook::update_best_bid() {
-    if (bid_levels_.empty()) {
-        best_bid_ = 0;
-    } else {
-        best_bid_ = bid_levels_.begin()->first; // Highest price (descending order)
-    }
+    best_bid_ = bid_levels_.best_price(); // Highest price (descending order)
 }
 
 void OrderBook::update_best_ask() {
-    if (ask_levels_.empty()) {
-        best_ask_ = 0;
-    } else {
-        best_ask_ = ask_levels_.begin()->first; // Lowest price (ascending order)
-    }
+    best_ask_ = ask_levels_.best_price(); // Lowest price (ascending order)
 }
 
 /* ============================================================================
@@ -809,24 +991,19 @@ Quantity OrderBook::get_volume_at_price(Side side, Price price) const {
 }
 
 uint64_t OrderBook::get_depth(Side side, uint32_t num_levels) const {
-    uint64_t total_volume = 0;
-    uint32_t count = 0;
-    
     if (side == MX_SIDE_BUY) {
-        for (const auto& pair : bid_levels_) {
-            if (count >= num_levels) break;
-            total_volume += pair.second.total_volume();
-            ++count;
-        }
+        return bid_depth_.depth(bid_levels_, num_levels);
     } else {
-        for (const auto& pair : ask_levels_) {
-            if (count >= num_levels) break;
-            total_volume += pair.second.total_volume();
-            ++count;
-        }
+        return ask_depth_.depth(ask_levels_, num_levels);
+    }
+}
+
+uint32_t OrderBook::get_levels(Side side, uint32_t max_levels, mx_level_t* out) const {
+    if (side == MX_SIDE_BUY) {
+        return bid_depth_.copy(bid_levels_, max_levels, out);
+    } else {
+        return ask_depth_.copy(ask_levels_, max_levels, out);
     }
-    
-    return total_volume;
 }
 
 OrderBookStats OrderBook::get_stats() const {
@@ -836,16 +1013,72 @@ OrderBookStats OrderBook::get_stats() const {
     stats.ask_levels = get_ask_level_count();
     stats.best_bid = best_bid_;
     stats.best_ask = best_ask_;
+    stats.total_bid_volume = bid_depth_.total_volume();
+    stats.total_ask_volume = ask_depth_.total_volume();
+    return stats;
+}
+
+/* ============================================================================
+ * Published View
+ * ========================================================================= */
+
+void OrderBook::publish_view() {
+    MX_ASSERT(view_ != nullptr);
+    
+    mx_book_view_t& view = view_->begin_write();
+    view.timestamp = context_->get_timestamp();
+    view.total_trades = total_trades_;
+    view.total_volume = total_volume_;
+    view.bid_volume = bid_depth_.total_volume();
+    view.ask_volume = ask_depth_.total_volume();
+    view.best_bid = best_bid_;
+    view.best_ask = best_ask_;
+    view.order_count = get_total_order_count();
+    view.bid_level_count = get_bid_level_count();
+    view.ask_level_count = get_ask_level_count();
+    view.bid_count = bid_depth_.copy(bid_levels_, view_->levels(), view.bids);
+    view.ask_count = ask_depth_.copy(ask_levels_, view_->levels(), view.asks);
+    view.reserved = 0;
+    view_->end_write();
+}
+
+/* ============================================================================
+ * Latency
+ * ========================================================================= */
+
+bool OrderBook::get_latency(mx_latency_op_t op, mx_latency_stats_t& stats) const {
+    if (!latency_) return false;
+    
+    const LatencyHistogram& histogram = latency_[op];
+    double ns_per_tick = context_->ns_per_tick();
+    auto to_ns = [ns_per_tick](uint64_t ticks) {
+        return static_cast<uint64_t>(static_cast<double>(ticks) * ns_per_tick + 0.5);
+    };
+    
+    stats.count = histogram.count();
+    stats.min_ns = to_ns(histogram.min());
+    stats.mean_ns = histogram.count() ? to_ns(histogram.total() / histogram.count()) : 0;
+    stats.p50_ns = to_ns(histogram.value_at_percentile(50.0));
+    stats.p90_ns = to_ns(histogram.value_at_percentile(90.0));
+    stats.p99_ns = to_ns(histogram.value_at_percentile(99.0));
+    stats.p999_ns = to_ns(histogram.value_at_percentile(99.9));
+    stats.max_ns = to_ns(histogram.max());
+    return true;
+}
+
+uint64_t OrderBook::get_latency_percentile(mx_latency_op_t op, double percentile) const {
+    if (!latency_) return 0;
     
-    for (const auto& pair : bid_levels_) {
-        stats.total_bid_volume += pair.second.total_volume();
-    }
+    uint64_t ticks = latency_[op].value_at_percentile(percentile);
+    return static_cast<uint64_t>(static_cast<double>(ticks) * context_->ns_per_tick() + 0.5);
+}
+
+void OrderBook::reset_latency() {
+    if (!latency_) return;
     
-    for (const auto& pair : ask_levels_) {
-        stats.total_ask_volume += pair.second.total_volume();
+    for (uint32_t op = 0; op < MX_LATENCY_OP_COUNT; ++op) {
+        latency_[op].reset();
     }
-    
-    return stats;
 }
 
 /* ============================================================================
@@ -853,69 +1086,49 @@ OrderBookStats OrderBook::get_stats() const {
  * ========================================================================= */
 
 void OrderBook::clear() {
+    CallScope scope(this);
     bid_levels_.clear();
     ask_levels_.clear();
-    stop_orders_.clear();
+    buy_stops_.clear();
+    sell_stops_.clear();
     order_pool_.clear();
+    bid_depth_.reset(bid_levels_);
+    ask_depth_.reset(ask_levels_);
     
     best_bid_ = 0;
     best_ask_ = 0;
 }
 
 uint32_t OrderBook::process_expirations(Timestamp current_time) {
-    std::vector<OrderId> expired_orders;
+    CallScope scope(this);
+    uint32_t expired_count = 0;
     
-    // Find expired orders
-    order_pool_.for_each_order([current_time, &expired_orders](Order* order) {
-        if (order->is_expired(current_time)) {
-            expired_orders.push_back(order->order_id());
-        }
-    });
-    
-    // Cancel them
-    for (OrderId id : expired_orders) {
-        Order* order = order_pool_.find_order(id);
-        if (order) {
+    // Pop due orders earliest first - destroying one unschedules it
+    while (Order* order = order_pool_.next_expired_order(current_time)) {
+        if (is_pending_stop(order)) {
+            remove_from_stop_index(order);
+        } else {
             remove_from_book(order);
-            order->set_state(OrderState::EXPIRED);
-            notify_order_event(id, MX_EVENT_ORDER_EXPIRED, 
-                             order->filled_quantity(), 0);
-            order_pool_.destroy_order(order);
         }
+        order->set_state(OrderState::EXPIRED);
+        notify_order_event(order->order_id(), MX_EVENT_ORDER_EXPIRED, 
+                         order->filled_quantity(), 0);
+        order_pool_.destroy_order(order);
+        ++expired_count;
     }
     
-    return static_cast<uint32_t>(expired_orders.size());
+    // Expired resting orders can move the market into stops
+    trigger_stops();
+    
+    return expired_count;
 }
 
 uint32_t OrderBook::process_stops() {
-    uint32_t triggered_count = 0;
+    CallScope scope(this);
     
-    std::vector<OrderId> to_trigger;
-    
-    // Find stops that should trigger
-    for (auto& pair : stop_orders_) {
-        Order* stop_order = pair.second;
-        if (should_trigger_stop(stop_order)) {
-            to_trigger.push_back(stop_order->order_id());
-        }
-    }
-    
-    // Trigger them
-    for (OrderId id : to_trigger) {
-        auto it = stop_orders_.find(id);
-        if (it != stop_orders_.end()) {
-            Order* order = it->second;
-            stop_orders_.erase(it);
-            
-            order->trigger_stop();
-            notify_order_event(id, MX_EVENT_ORDER_TRIGGERED, 0, order->remaining_quantity());
-            
-            process_new_order(order);
-            ++triggered_count;
-        }
-    }
-    
-    return triggered_count;
+    // Stops already fire inline after every operation; this only catches
+    // anything left crossed by external changes
+    return trigger_stops();
 }
 
 /* ============================================================================
@@ -931,43 +1144,14 @@ bool OrderBook::would_match_immediately(const Order* order) const {
 }
 
 bool OrderBook::can_fill_fok(const Order* order, Quantity& available_quantity) const {
-    available_quantity = 0;
-    
-    if (order->is_buy()) {
-        // Buy order checks against asks
-        for (const auto& pair : ask_levels_) {
-            const PriceLevel& level = pair.second;
-            
-            // Check price compatibility
-            if (order->price() < level.price()) {
-                break; // No more matchable prices
-            }
-            
-            available_quantity += level.total_volume();
-            
-            if (available_quantity >= order->remaining_quantity()) {
-                return true; // Can fill completely
-            }
-        }
-    } else {
-        // Sell order checks against bids
-        for (const auto& pair : bid_levels_) {
-            const PriceLevel& level = pair.second;
-            
-            // Check price compatibility
-            if (order->price() > level.price()) {
-                break; // No more matchable prices
-            }
-            
-            available_quantity += level.total_volume();
-            
-            if (available_quantity >= order->remaining_quantity()) {
-                return true; // Can fill completely
-            }
-        }
-    }
-    
-    return false;
+    // Contra volume at prices the order can reach, best first, stopping
+    // once it covers the order (a threshold scan on the ladder)
+    Quantity needed = order->remaining_quantity();
+    uint64_t available = order->is_buy() ? ask_levels_.volume_through(order->price(), needed)
+                                         : bid_levels_.volume_through(order->price(), needed);
+    
+    available_quantity = static_cast<Quantity>(MX_MIN(available, static_cast<uint64_t>(UINT32_MAX)));
+    return available >= needed;
 }
 
 bool OrderBook::can_fill_aon(const Order* order) const {
@@ -985,32 +1169,45 @@ mx_status_t OrderBook::validate_order(OrderId order_id, OrderType type, Side sid
     // Limit orders must have price
     if (type == MX_ORDER_TYPE_LIMIT || type == MX_ORDER_TYPE_STOP_LIMIT) {
         if (price == 0) return MX_STATUS_INVALID_PRICE;
+        if (!is_price_in_band(price)) return MX_STATUS_INVALID_PRICE;
     }
     
     // Stop orders must have stop price
     if (type == MX_ORDER_TYPE_STOP || type == MX_ORDER_TYPE_STOP_LIMIT) {
         if (stop_price == 0) return MX_STATUS_INVALID_PRICE;
+        if (!is_price_in_band(stop_price)) return MX_STATUS_INVALID_PRICE;
     }
     
-    // Check for duplicate
-    if (order_pool_.has_order(order_id)) {
-        return MX_STATUS_DUPLICATE_ORDER;
-    }
+    // Duplicates are detected by OrderPool when the order is created
     
     return MX_STATUS_OK;
 }
 
+mx_status_t OrderBook::create_failure_status(OrderId order_id) const {
+    // Cold path: tell a duplicate ID apart from pool exhaustion
+    return order_pool_.has_order(order_id) ? MX_STATUS_DUPLICATE_ORDER
+                                           : MX_STATUS_OUT_OF_MEMORY;
+}
+
 /* ============================================================================
  * Callbacks
  * ========================================================================= */
 
 void OrderBook::notify_trade(OrderId aggressive_id, OrderId passive_id,
                              Price price, Quantity quantity, Timestamp timestamp) {
+    if (events_.enabled()) {
+        events_.push_trade(aggressive_id, passive_id, price, quantity, timestamp);
+        return;
+    }
     context_->callbacks().on_trade(aggressive_id, passive_id, price, quantity, timestamp);
 }
 
 void OrderBook::notify_order_event(OrderId order_id, mx_order_event_t event,
                                    Quantity filled, Quantity remaining) {
+    if (events_.enabled()) {
+        events_.push_order_event(order_id, event, filled, remaining, get_current_timestamp());
+        return;
+    }
     context_->callbacks().on_order_event(order_id, event, filled, remaining);
 }
 
@@ -0,0 +1,409 @@
+/**
+ * OrderBook snapshot save/load
+ * Restore maps the file and appends records straight into the pool and
+ * levels, so a multi-million-order book comes back without matching
+ */
+
+#include "internal/core/order_book.h"
+#include "internal/core/snapshot.h"
+#include "internal/context.h"
+#include "internal/allocator.h"
+#include <cstdio>
+#include <string>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MX_SNAPSHOT_MMAP 1
+#endif
+
+namespace matchx {
+
+using snapshot::FileHeader;
+using snapshot::OrderRecord;
+
+namespace {
+
+/* ============================================================================
+ * FileView
+ * Read-only view of a whole file: mmap where available, else a heap copy
+ * ========================================================================= */
+
+class FileView {
+private:
+    const uint8_t* data_;
+    size_t size_;
+    bool mapped_;
+
+public:
+    FileView() : data_(nullptr), size_(0), mapped_(false) {}
+    ~FileView() { close(); }
+    
+    FileView(const FileView&) = delete;
+    FileView& operator=(const FileView&) = delete;
+    
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    
+    bool open(const char* path) {
+#if defined(MX_SNAPSHOT_MMAP)
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        
+        size_t size = static_cast<size_t>(st.st_size);
+        void* mem = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mem == MAP_FAILED) return false;
+        
+        // Records are read once, front to back
+        madvise(mem, size, MADV_SEQUENTIAL);
+        madvise(mem, size, MADV_WILLNEED);
+        
+        data_ = static_cast<const uint8_t*>(mem);
+        size_ = size;
+        mapped_ = true;
+        return true;
+#else
+        FILE* file = std::fopen(path, "rb");
+        if (!file) return false;
+        
+        std::fseek(file, 0, SEEK_END);
+        long length = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+        if (length <= 0) {
+            std::fclose(file);
+            return false;
+        }
+        
+        size_t size = static_cast<size_t>(length);
+        uint8_t* buffer = static_cast<uint8_t*>(mx_malloc(size));
+        bool ok = buffer && std::fread(buffer, 1, size, file) == size;
+        std::fclose(file);
+        if (!ok) {
+            mx_free(buffer);
+            return false;
+        }
+        
+        data_ = buffer;
+        size_ = size;
+        mapped_ = false;
+        return true;
+#endif
+    }
+    
+    void close() {
+        if (!data_) return;
+#if defined(MX_SNAPSHOT_MMAP)
+        if (mapped_) {
+            munmap(const_cast<uint8_t*>(data_), size_);
+        }
+#endif
+        if (!mapped_) {
+            mx_free(const_cast<uint8_t*>(data_));
+        }
+        data_ = nullptr;
+        size_ = 0;
+    }
+};
+
+/* ============================================================================
+ * RecordWriter
+ * Buffers records into large fwrite calls and checksums as it goes
+ * ========================================================================= */
+
+class RecordWriter {
+private:
+    static constexpr uint32_t BUFFER_RECORDS = 4096;
+    
+    FILE* file_;
+    OrderRecord* buffer_;
+    uint32_t buffered_;
+    uint64_t checksum_;
+    bool ok_;
+
+public:
+    explicit RecordWriter(FILE* file)
+        : file_(file)
+        , buffer_(static_cast<OrderRecord*>(mx_malloc(sizeof(OrderRecord) * BUFFER_RECORDS)))
+        , buffered_(0)
+        , checksum_(snapshot::CHECKSUM_SEED)
+        , ok_(buffer_ != nullptr) {}
+    
+    ~RecordWriter() { mx_free(buffer_); }
+    
+    RecordWriter(const RecordWriter&) = delete;
+    RecordWriter& operator=(const RecordWriter&) = delete;
+    
+    bool ok() const { return ok_; }
+    uint64_t checksum() const { return checksum_; }
+    
+    void write(const Order* order) {
+        if (!ok_) return;
+        
+        OrderRecord& record = buffer_[buffered_];
+        std::memset(&record, 0, sizeof(record));
+        record.order_id = order->order_id();
+        record.created_time = order->created_time();
+        record.expire_time = order->expire_time();
+        record.price = order->price();
+        record.stop_price = order->stop_price();
+        record.total_quantity = order->total_quantity();
+        record.filled_quantity = order->filled_quantity();
+        record.display_quantity = order->display_quantity();
+        record.visible_filled = order->visible_filled();
+        record.flags = order->flags();
+        record.side = static_cast<uint8_t>(order->side());
+        record.order_type = static_cast<uint8_t>(order->order_type());
+        record.state = static_cast<uint8_t>(order->state());
+        record.time_in_force = static_cast<uint8_t>(order->time_in_force());
+        record.owner = order->owner();
+        
+        if (++buffered_ == BUFFER_RECORDS) {
+            flush();
+        }
+    }
+    
+    bool flush() {
+        if (ok_ && buffered_ > 0) {
+            checksum_ = snapshot::checksum(buffer_, buffered_, checksum_);
+            ok_ = std::fwrite(buffer_, sizeof(OrderRecord), buffered_, file_) == buffered_;
+            buffered_ = 0;
+        }
+        return ok_;
+    }
+};
+
+/**
+ * Write every order of one side, levels best first, FIFO within a level
+ */
+template<Side S>
+uint64_t write_levels(RecordWriter& writer, const BookSide<S>& levels) {
+    uint64_t count = 0;
+    levels.for_each_level([&writer, &count](const PriceLevel& level) {
+        level.for_each_order([&writer, &count](const Order* order) {
+            writer.write(order);
+            ++count;
+        });
+        return true;
+    });
+    return count;
+}
+
+bool sync_file(FILE* file) {
+    if (std::fflush(file) != 0) return false;
+#if defined(MX_SNAPSHOT_MMAP)
+    return fsync(fileno(file)) == 0;
+#else
+    return true;
+#endif
+}
+
+} // namespace
+
+/* ============================================================================
+ * Save
+ * ========================================================================= */
+
+mx_status_t OrderBook::save_snapshot(const char* path) const {
+    if (!path) return MX_STATUS_INVALID_PARAM;
+    
+    std::string temp_path = std::string(path) + ".tmp";
+    FILE* file = std::fopen(temp_path.c_str(), "wb");
+    if (!file) return MX_STATUS_ERROR;
+    
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = snapshot::MAGIC;
+    header.version = snapshot::VERSION;
+    header.header_size = sizeof(FileHeader);
+    header.record_size = sizeof(OrderRecord);
+    header.total_trades = total_trades_;
+    header.total_volume = total_volume_;
+    header.saved_timestamp = context_->get_timestamp();
+    if (symbol_) {
+        std::strncpy(header.symbol, symbol_, sizeof(header.symbol) - 1);
+    }
+    
+    // Header goes first as a placeholder, then again once counts are known
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    
+    RecordWriter writer(file);
+    if (ok) {
+        header.bid_orders = write_levels(writer, bid_levels_);
+        header.ask_orders = write_levels(writer, ask_levels_);
+        header.buy_stop_orders = write_levels(writer, buy_stops_);
+        header.sell_stop_orders = write_levels(writer, sell_stops_);
+        ok = writer.flush();
+    }
+    
+    if (ok) {
+        header.checksum = writer.checksum();
+        ok = std::fseek(file, 0, SEEK_SET) == 0 &&
+             std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+             sync_file(file);
+    }
+    
+    ok = (std::fclose(file) == 0) && ok;
+
+#if defined(_WIN32)
+    // rename() does not replace an existing file on Windows
+    if (ok) std::remove(path);
+#endif
+    if (!ok || std::rename(temp_path.c_str(), path) != 0) {
+        std::remove(temp_path.c_str());
+        return MX_STATUS_ERROR;
+    }
+    
+    return MX_STATUS_OK;
+}
+
+/* ============================================================================
+ * Load
+ * ========================================================================= */
+
+mx_status_t OrderBook::load_snapshot(const char* path) {
+    if (!path) return MX_STATUS_INVALID_PARAM;
+    CallScope scope(this);
+    
+    FileView view;
+    if (!view.open(path) || view.size() < sizeof(FileHeader)) {
+        return MX_STATUS_ERROR;
+    }
+    
+    FileHeader header;
+    std::memcpy(&header, view.data(), sizeof(header));
+    if (header.magic != snapshot::MAGIC ||
+        header.version != snapshot::VERSION ||
+        header.header_size != sizeof(FileHeader) ||
+        header.record_size != sizeof(OrderRecord)) {
+        return MX_STATUS_ERROR;
+    }
+    
+    // Counts must exactly account for the rest of the file
+    uint64_t capacity = (view.size() - sizeof(FileHeader)) / sizeof(OrderRecord);
+    uint64_t sections[4] = {header.bid_orders, header.ask_orders,
+                            header.buy_stop_orders, header.sell_stop_orders};
+    uint64_t total = 0;
+    for (uint64_t count : sections) {
+        if (count > capacity - total) return MX_STATUS_ERROR;
+        total += count;
+    }
+    if (sizeof(FileHeader) + total * sizeof(OrderRecord) != view.size()) {
+        return MX_STATUS_ERROR;
+    }
+    
+    const OrderRecord* records = reinterpret_cast<const OrderRecord*>(view.data() + sizeof(FileHeader));
+    if (snapshot::checksum(records, total, snapshot::CHECKSUM_SEED) != header.checksum) {
+        return MX_STATUS_ERROR;
+    }
+    
+    clear();
+    order_pool_.reserve(static_cast<size_t>(total));
+    
+    const OrderRecord* cursor = records;
+    mx_status_t status = restore_orders(cursor, header.bid_orders, MX_SIDE_BUY, false, bid_levels_);
+    cursor += header.bid_orders;
+    if (status == MX_STATUS_OK) {
+        status = restore_orders(cursor, header.ask_orders, MX_SIDE_SELL, false, ask_levels_);
+    }
+    cursor += header.ask_orders;
+    if (status == MX_STATUS_OK && !stop_ladders_built_ &&
+        header.buy_stop_orders + header.sell_stop_orders > 0) {
+        // Stop prices are checked against the stop ladders' band
+        build_stop_ladders();
+    }
+    if (status == MX_STATUS_OK) {
+        status = restore_orders(cursor, header.buy_stop_orders, MX_SIDE_BUY, true, buy_stops_);
+    }
+    cursor += header.buy_stop_orders;
+    if (status == MX_STATUS_OK) {
+        status = restore_orders(cursor, header.sell_stop_orders, MX_SIDE_SELL, true, sell_stops_);
+    }
+    
+    if (status != MX_STATUS_OK) {
+        clear();
+        return status;
+    }
+    
+    update_best_bid();
+    update_best_ask();
+    bid_depth_.reset(bid_levels_);
+    ask_depth_.reset(ask_levels_);
+    total_trades_ = header.total_trades;
+    total_volume_ = header.total_volume;
+    return MX_STATUS_OK;
+}
+
+template<Side S>
+mx_status_t OrderBook::restore_orders(const OrderRecord* records, uint64_t count,
+                                      Side side, bool stops, BookSide<S>& levels) {
+    // Consecutive records share a level, so only look one up on a price change
+    PriceLevel* level = nullptr;
+    Price level_price = 0;
+    
+    for (uint64_t i = 0; i < count; ++i) {
+        const OrderRecord& record = records[i];
+        
+        if (record.order_id == INVALID_ORDER_ID ||
+            record.side != static_cast<uint8_t>(side) ||
+            record.order_type > MX_ORDER_TYPE_STOP_LIMIT ||
+            record.time_in_force > MX_TIF_GTD ||
+            record.filled_quantity >= record.total_quantity) {
+            return MX_STATUS_ERROR;
+        }
+        
+        OrderType type = static_cast<OrderType>(record.order_type);
+        OrderState state = static_cast<OrderState>(record.state);
+        bool is_stop = (type == MX_ORDER_TYPE_STOP || type == MX_ORDER_TYPE_STOP_LIMIT);
+        
+        if (stops) {
+            // Pending stops have not been triggered yet
+            if (!is_stop || state != OrderState::PENDING_NEW) return MX_STATUS_ERROR;
+        } else {
+            // Only limit orders rest (triggered stop-limits have become limits)
+            if (type != MX_ORDER_TYPE_LIMIT ||
+                (state != OrderState::ACTIVE && state != OrderState::PARTIALLY_FILLED)) {
+                return MX_STATUS_ERROR;
+            }
+        }
+        
+        Price key = stops ? record.stop_price : record.price;
+        if (key == 0 || !levels.accepts_price(key)) {
+            return MX_STATUS_INVALID_PRICE;
+        }
+        
+        Order* order = order_pool_.create_order_full(
+            record.order_id, type, side, record.price, record.stop_price,
+            record.total_quantity, record.display_quantity,
+            static_cast<TimeInForce>(record.time_in_force), record.flags,
+            record.created_time, record.expire_time);
+        if (!order) {
+            return create_failure_status(record.order_id);
+        }
+        order->restore(record.filled_quantity, record.visible_filled, state);
+        if (record.owner != NO_OWNER && !order_pool_.set_owner(order, record.owner)) {
+            return MX_STATUS_OUT_OF_MEMORY;
+        }
+        
+        if (!level || key != level_price) {
+            level = levels.find_or_create(key);
+            level_price = key;
+        }
+        level->add_order(order);
+        if (!stops) {
+            levels.add_volume(key, order->remaining_quantity());
+        }
+    }
+    
+    return MX_STATUS_OK;
+}
+
+} // namespace matchx
@@ -0,0 +1,252 @@
+/**
+ * Volume kernel implementations
+ * The SIMD versions are compiled per function with target attributes, so
+ * the library still runs on CPUs without them; volume_kernels() checks the
+ * CPU once and hands out the matching table
+ */
+
+#include "internal/core/volume_kernels.h"
+
+#if !defined(MX_NO_SIMD) && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define MX_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace matchx {
+
+namespace {
+
+/* ============================================================================
+ * Scalar Kernels
+ * ========================================================================= */
+
+uint64_t sum_scalar(const Quantity* volumes, uint32_t count) {
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        total += volumes[i];
+    }
+    return total;
+}
+
+// Finish a scan one tick at a time from begin (inclusive) towards end
+uint32_t finish_up(const Quantity* volumes, uint32_t begin, uint32_t count,
+                   uint64_t threshold, uint64_t total, uint64_t& cumulative) {
+    for (uint32_t i = begin; i < count; ++i) {
+        total += volumes[i];
+        if (total >= threshold) {
+            cumulative = total;
+            return i;
+        }
+    }
+    cumulative = total;
+    return count;
+}
+
+uint32_t finish_down(const Quantity* volumes, uint32_t end, uint32_t count,
+                     uint64_t threshold, uint64_t total, uint64_t& cumulative) {
+    for (uint32_t i = end; i-- > 0; ) {
+        total += volumes[i];
+        if (total >= threshold) {
+            cumulative = total;
+            return i;
+        }
+    }
+    cumulative = total;
+    return count;
+}
+
+uint32_t scan_up_scalar(const Quantity* volumes, uint32_t count,
+                        uint64_t threshold, uint64_t& cumulative) {
+    return finish_up(volumes, 0, count, threshold, 0, cumulative);
+}
+
+uint32_t scan_down_scalar(const Quantity* volumes, uint32_t count,
+                          uint64_t threshold, uint64_t& cumulative) {
+    return finish_down(volumes, count, count, threshold, 0, cumulative);
+}
+
+const VolumeKernels SCALAR_KERNELS = {
+    "scalar", sum_scalar, scan_up_scalar, scan_down_scalar
+};
+
+#ifdef MX_X86_KERNELS
+
+/* ============================================================================
+ * AVX2 Kernels
+ * Volumes are summed as 64-bit lanes (low and high halves of each pair
+ * added separately), so no block can overflow. Scans skip whole blocks
+ * whose sum cannot reach the threshold and finish inside the block that
+ * does one tick at a time
+ * ========================================================================= */
+
+const uint32_t AVX2_BLOCK = 32;
+
+__attribute__((target("avx2")))
+inline __m256i widen_add_avx2(__m256i acc, __m256i volumes) {
+    const __m256i low_mask = _mm256_set1_epi64x(0xFFFFFFFFLL);
+    acc = _mm256_add_epi64(acc, _mm256_and_si256(volumes, low_mask));
+    return _mm256_add_epi64(acc, _mm256_srli_epi64(volumes, 32));
+}
+
+__attribute__((target("avx2")))
+inline uint64_t reduce_avx2(__m256i acc) {
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(sum));
+}
+
+__attribute__((target("avx2")))
+inline uint64_t block_sum_avx2(const Quantity* volumes) {
+    const __m256i* in = reinterpret_cast<const __m256i*>(volumes);
+    __m256i acc = widen_add_avx2(_mm256_setzero_si256(), _mm256_loadu_si256(in));
+    acc = widen_add_avx2(acc, _mm256_loadu_si256(in + 1));
+    acc = widen_add_avx2(acc, _mm256_loadu_si256(in + 2));
+    acc = widen_add_avx2(acc, _mm256_loadu_si256(in + 3));
+    return reduce_avx2(acc);
+}
+
+__attribute__((target("avx2")))
+uint64_t sum_avx2(const Quantity* volumes, uint32_t count) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i* in = reinterpret_cast<const __m256i*>(volumes + i);
+        acc0 = widen_add_avx2(acc0, _mm256_loadu_si256(in));
+        acc1 = widen_add_avx2(acc1, _mm256_loadu_si256(in + 1));
+    }
+    return reduce_avx2(_mm256_add_epi64(acc0, acc1)) + sum_scalar(volumes + i, count - i);
+}
+
+__attribute__((target("avx2")))
+uint32_t scan_up_avx2(const Quantity* volumes, uint32_t count,
+                      uint64_t threshold, uint64_t& cumulative) {
+    uint64_t total = 0;
+    uint32_t i = 0;
+    for (; i + AVX2_BLOCK <= count; i += AVX2_BLOCK) {
+        uint64_t block = block_sum_avx2(volumes + i);
+        if (total + block >= threshold) break;
+        total += block;
+    }
+    return finish_up(volumes, i, count, threshold, total, cumulative);
+}
+
+__attribute__((target("avx2")))
+uint32_t scan_down_avx2(const Quantity* volumes, uint32_t count,
+                        uint64_t threshold, uint64_t& cumulative) {
+    uint64_t total = 0;
+    uint32_t end = count;
+    for (; end >= AVX2_BLOCK; end -= AVX2_BLOCK) {
+        uint64_t block = block_sum_avx2(volumes + end - AVX2_BLOCK);
+        if (total + block >= threshold) break;
+        total += block;
+    }
+    return finish_down(volumes, end, count, threshold, total, cumulative);
+}
+
+const VolumeKernels AVX2_KERNELS = {
+    "avx2", sum_avx2, scan_up_avx2, scan_down_avx2
+};
+
+/* ============================================================================
+ * AVX-512 Kernels
+ * Same scheme as AVX2 with 16 ticks per vector
+ * ========================================================================= */
+
+// GCC 12's AVX-512 headers trip -Wuninitialized on their own
+// _mm512_undefined_* placeholders
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+const uint32_t AVX512_BLOCK = 64;
+
+__attribute__((target("avx512f")))
+inline __m512i widen_add_avx512(__m512i acc, __m512i volumes) {
+    const __m512i low_mask = _mm512_set1_epi64(0xFFFFFFFFLL);
+    acc = _mm512_add_epi64(acc, _mm512_and_si512(volumes, low_mask));
+    return _mm512_add_epi64(acc, _mm512_srli_epi64(volumes, 32));
+}
+
+__attribute__((target("avx512f")))
+inline uint64_t block_sum_avx512(const Quantity* volumes) {
+    __m512i acc = widen_add_avx512(_mm512_setzero_si512(), _mm512_loadu_si512(volumes));
+    acc = widen_add_avx512(acc, _mm512_loadu_si512(volumes + 16));
+    acc = widen_add_avx512(acc, _mm512_loadu_si512(volumes + 32));
+    acc = widen_add_avx512(acc, _mm512_loadu_si512(volumes + 48));
+    return static_cast<uint64_t>(_mm512_reduce_add_epi64(acc));
+}
+
+__attribute__((target("avx512f")))
+uint64_t sum_avx512(const Quantity* volumes, uint32_t count) {
+    __m512i acc0 = _mm512_setzero_si512();
+    __m512i acc1 = _mm512_setzero_si512();
+    uint32_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        acc0 = widen_add_avx512(acc0, _mm512_loadu_si512(volumes + i));
+        acc1 = widen_add_avx512(acc1, _mm512_loadu_si512(volumes + i + 16));
+    }
+    return static_cast<uint64_t>(_mm512_reduce_add_epi64(_mm512_add_epi64(acc0, acc1))) +
+           sum_scalar(volumes + i, count - i);
+}
+
+__attribute__((target("avx512f")))
+uint32_t scan_up_avx512(const Quantity* volumes, uint32_t count,
+                        uint64_t threshold, uint64_t& cumulative) {
+    uint64_t total = 0;
+    uint32_t i = 0;
+    for (; i + AVX512_BLOCK <= count; i += AVX512_BLOCK) {
+        uint64_t block = block_sum_avx512(volumes + i);
+        if (total + block >= threshold) break;
+        total += block;
+    }
+    return finish_up(volumes, i, count, threshold, total, cumulative);
+}
+
+__attribute__((target("avx512f")))
+uint32_t scan_down_avx512(const Quantity* volumes, uint32_t count,
+                          uint64_t threshold, uint64_t& cumulative) {
+    uint64_t total = 0;
+    uint32_t end = count;
+    for (; end >= AVX512_BLOCK; end -= AVX512_BLOCK) {
+        uint64_t block = block_sum_avx512(volumes + end - AVX512_BLOCK);
+        if (total + block >= threshold) break;
+        total += block;
+    }
+    return finish_down(volumes, end, count, threshold, total, cumulative);
+}
+
+const VolumeKernels AVX512_KERNELS = {
+    "avx512", sum_avx512, scan_up_avx512, scan_down_avx512
+};
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // MX_X86_KERNELS
+
+/* ============================================================================
+ * Dispatch
+ * ========================================================================= */
+
+const VolumeKernels& select_kernels() {
+#ifdef MX_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return AVX512_KERNELS;
+    if (__builtin_cpu_supports("avx2")) return AVX2_KERNELS;
+#endif
+    return SCALAR_KERNELS;
+}
+
+} // anonymous namespace
+
+const VolumeKernels& volume_kernels() {
+    static const VolumeKernels& kernels = select_kernels();
+    return kernels;
+}
+
+} // namespace matchx
@@ -24,6 +24,14 @@ int mx_is_compatible_dll(void) {
     return (dll_major == header_major) ? 1 : 0;
 }
 
+int mx_is_trace_enabled(void) {
+#ifdef MX_TRACE
+    return 1;
+#else
+    return 0;
+#endif
+}
+
 const char* mx_status_message(mx_status_t status) {
     switch (status) {
         case MX_STATUS_OK:
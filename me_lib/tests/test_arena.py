@@ -0,0 +1,197 @@
+"""
+Memory arena tests
+Books created from a context with arena flags take their order pool,
+order ID index and ladder levels from the context's arena and must
+behave exactly like heap-backed books
+"""
+
+import random
+import pytest
+from testhelpers import (
+    ffi, lib,
+    SIDE_BUY, SIDE_SELL,
+    ORDER_TYPE_STOP, TIF_GTC,
+    STATUS_OK, STATUS_INVALID_PARAM,
+    create_context, free_context,
+    create_order_book, free_order_book,
+    create_trade_callback
+)
+
+ARENA_NONE = lib.MX_ARENA_NONE
+ARENA_ENABLE = lib.MX_ARENA_ENABLE
+ARENA_HUGE_PAGES = lib.MX_ARENA_HUGE_PAGES
+ARENA_PREFAULT = lib.MX_ARENA_PREFAULT
+ARENA_NUMA_LOCAL = lib.MX_ARENA_NUMA_LOCAL
+
+def arena_stats(ctx):
+    stats = ffi.new("mx_arena_stats_t*")
+    assert lib.mx_context_get_arena_stats(ctx, stats) == STATUS_OK
+    return stats
+
+def run_random_flow(book, seed, count=2000):
+    """Random adds and cancels; returns the ids still resting"""
+    rng = random.Random(seed)
+    live = []
+    for order_id in range(1, count + 1):
+        if live and rng.random() < 0.3:
+            victim = live.pop(rng.randrange(len(live)))
+            lib.mx_order_book_cancel(book, victim)
+            continue
+        side = SIDE_BUY if rng.random() < 0.5 else SIDE_SELL
+        price = 10000 + rng.randrange(-20, 21)
+        lib.mx_order_book_add_limit(book, order_id, side, price, rng.randrange(1, 50))
+        live.append(order_id)
+    return [i for i in live if lib.mx_order_book_has_order(book, i)]
+
+class TestArena:
+    """Test arena-backed order books"""
+    
+    def test_invalid_params(self, context):
+        assert lib.mx_context_set_capacity_hints_ex(ffi.NULL, 100, 10, ARENA_ENABLE) == STATUS_INVALID_PARAM
+        assert lib.mx_context_set_capacity_hints_ex(context, 100, 10, 1 << 8) == STATUS_INVALID_PARAM
+        assert lib.mx_context_get_arena_stats(context, ffi.NULL) == STATUS_INVALID_PARAM
+        assert lib.mx_context_get_arena_stats(ffi.NULL, ffi.new("mx_arena_stats_t*")) == STATUS_INVALID_PARAM
+    
+    def test_unused_by_default(self, context, order_book):
+        lib.mx_order_book_add_limit(order_book, 1, SIDE_BUY, 10000, 10)
+        stats = arena_stats(context)
+        assert stats.reserved_bytes == 0
+        assert stats.used_bytes == 0
+        assert stats.region_count == 0
+        assert stats.flags == ARENA_NONE
+    
+    def test_book_reserves_one_region(self, context):
+        flags = ARENA_ENABLE | ARENA_PREFAULT
+        assert lib.mx_context_set_capacity_hints_ex(context, 4096, 100, flags) == STATUS_OK
+        book = create_order_book(context, "ARENA")
+        
+        stats = arena_stats(context)
+        assert stats.flags == flags
+        assert stats.region_count == 1
+        assert stats.used_bytes >= 4096 * 96          # Hot + cold order records
+        assert stats.reserved_bytes >= stats.used_bytes
+        
+        free_order_book(book)
+    
+    def test_matches_like_heap_book(self):
+        results = []
+        for flags in (ARENA_NONE, ARENA_ENABLE | ARENA_PREFAULT | ARENA_NUMA_LOCAL):
+            ctx = create_context()
+            trades = []
+            trade_cb = create_trade_callback(lambda a, p, px, q, ts: trades.append((a, p, px, q)))
+            lib.mx_context_set_callbacks(ctx, trade_cb, ffi.NULL, ffi.NULL)
+            assert lib.mx_context_set_capacity_hints_ex(ctx, 1024, 64, flags) == STATUS_OK
+            book = create_order_book(ctx, "CMP")
+            
+            live = run_random_flow(book, seed=7)
+            results.append((trades, live,
+                            lib.mx_order_book_get_best_bid(book),
+                            lib.mx_order_book_get_best_ask(book)))
+            
+            free_order_book(book)
+            free_context(ctx)
+        
+        assert results[0] == results[1]
+        assert len(results[0][0]) > 0
+    
+    def test_ladder_levels_from_arena(self, context):
+        assert lib.mx_context_set_capacity_hints_ex(context, 256, 64, ARENA_ENABLE) == STATUS_OK
+        book = create_order_book(context, "HEAPONLY")
+        heap_only = arena_stats(context).used_bytes
+        free_order_book(book)
+        
+        assert lib.mx_context_set_price_bounds(context, 9000, 11000, 1) == STATUS_OK
+        book = create_order_book(context, "LADDER")
+        assert arena_stats(context).used_bytes > heap_only + 2 * 2001 * 64
+        
+        assert lib.mx_order_book_add_limit(book, 1, SIDE_SELL, 10001, 10) == STATUS_OK
+        assert lib.mx_order_book_add_limit(book, 2, SIDE_BUY, 10001, 4) == STATUS_OK
+        assert lib.mx_order_book_get_best_ask(book) == 10001
+        assert lib.mx_order_book_has_order(book, 2) == 0
+        
+        free_order_book(book)
+    
+    def test_stop_ladders_built_on_first_stop(self, context):
+        assert lib.mx_context_set_capacity_hints_ex(context, 256, 64, ARENA_ENABLE) == STATUS_OK
+        assert lib.mx_context_set_price_bounds(context, 9000, 11000, 1) == STATUS_OK
+        book = create_order_book(context, "STOPS")
+        without_stops = arena_stats(context).used_bytes
+        
+        assert lib.mx_order_book_add_limit(book, 1, SIDE_BUY, 9500, 10) == STATUS_OK
+        assert arena_stats(context).used_bytes == without_stops
+        
+        assert lib.mx_order_book_add_order(book, 2, ORDER_TYPE_STOP, SIDE_SELL, 0, 9400, 5, 0,
+                                           TIF_GTC, 0, 0) == STATUS_OK
+        assert arena_stats(context).used_bytes > without_stops + 2 * 2001 * 64
+        
+        free_order_book(book)
+    
+    def test_freed_book_storage_is_reused(self, context):
+        assert lib.mx_context_set_capacity_hints_ex(context, 2048, 64, ARENA_ENABLE) == STATUS_OK
+        
+        book = create_order_book(context, "FIRST")
+        first = arena_stats(context)
+        used, reserved, regions = first.used_bytes, first.reserved_bytes, first.region_count
+        free_order_book(book)
+        assert arena_stats(context).used_bytes == 0
+        
+        book = create_order_book(context, "SECOND")
+        second = arena_stats(context)
+        assert second.used_bytes == used
+        assert second.reserved_bytes == reserved
+        assert second.region_count == regions
+        free_order_book(book)
+
+    def test_reserve_ignores_free_blocks_of_other_sizes(self, context):
+        """A free list full of small chunks does not stand in for a larger book"""
+        assert lib.mx_context_set_capacity_hints_ex(context, 16, 8, ARENA_ENABLE) == STATUS_OK
+        book = create_order_book(context, "SMALL")
+        for order_id in range(1, 100001):
+            lib.mx_order_book_add_limit(book, order_id, SIDE_BUY, 1000 + order_id % 500, 1)
+        free_order_book(book)
+
+        assert lib.mx_context_set_capacity_hints_ex(context, 65536, 64, ARENA_ENABLE) == STATUS_OK
+        regions = arena_stats(context).region_count
+        book = create_order_book(context, "LARGE")
+        assert arena_stats(context).region_count == regions + 1
+
+        for order_id in range(1, 65537):
+            lib.mx_order_book_add_limit(book, order_id, SIDE_BUY, 1000 + order_id % 500, 1)
+        assert arena_stats(context).region_count == regions + 1
+        free_order_book(book)
+
+    def test_grows_past_hints(self, context):
+        assert lib.mx_context_set_capacity_hints_ex(context, 16, 8, ARENA_ENABLE) == STATUS_OK
+        book = create_order_book(context, "SMALL")
+        
+        for order_id in range(1, 501):
+            assert lib.mx_order_book_add_limit(book, order_id, SIDE_BUY, 9000 + order_id, 1) == STATUS_OK
+        for order_id in range(1, 501):
+            assert lib.mx_order_book_has_order(book, order_id) == 1
+        assert lib.mx_order_book_get_best_bid(book) == 9500
+        
+        free_order_book(book)
+    
+    def test_legacy_hints_keep_arena_flags(self, context):
+        assert lib.mx_context_set_capacity_hints_ex(context, 128, 8, ARENA_ENABLE) == STATUS_OK
+        lib.mx_context_set_capacity_hints(context, 256, 8)
+        book = create_order_book(context, "LEGACY")
+        
+        stats = arena_stats(context)
+        assert stats.flags == ARENA_ENABLE
+        assert stats.used_bytes >= 256 * 96
+        
+        free_order_book(book)
+    
+    def test_huge_pages_request(self, context):
+        """Huge pages are best effort - the book works either way"""
+        flags = ARENA_ENABLE | ARENA_HUGE_PAGES | ARENA_PREFAULT
+        assert lib.mx_context_set_capacity_hints_ex(context, 1024, 8, flags) == STATUS_OK
+        book = create_order_book(context, "HUGE")
+        
+        stats = arena_stats(context)
+        assert stats.huge_page_bytes <= stats.reserved_bytes
+        assert stats.reserved_bytes % (2 * 1024 * 1024) == 0
+        assert lib.mx_order_book_add_limit(book, 1, SIDE_BUY, 10000, 10) == STATUS_OK
+        
+        free_order_book(book)
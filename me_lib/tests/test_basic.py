@@ -7,10 +7,16 @@ import pytest
 from testhelpers import (
     ffi, lib,
     SIDE_BUY, SIDE_SELL,
+    ORDER_TYPE_LIMIT, TIF_GTC, TIF_DAY, TIF_GTD,
     STATUS_OK, STATUS_ORDER_NOT_FOUND, STATUS_DUPLICATE_ORDER,
+    EVENT_EXPIRED,
     price_to_ticks, ticks_to_price
 )
 
+def add_timed_limit(book, order_id, side, price, quantity, expire_time, tif=TIF_GTD):
+    return lib.mx_order_book_add_order(book, order_id, ORDER_TYPE_LIMIT, side,
+                                       price, 0, quantity, 0, tif, 0, expire_time)
+
 class TestVersionAndCompatibility:
     """Test version information"""
     
@@ -291,6 +297,122 @@ class TestOrderQueries:
         assert quantity_out[0] == quantity
         assert filled_out[0] == 0  # Not filled yet
 
+class TestOrderLookup:
+    """Test the order ID index under churn"""
+    
+    def test_capacity_hints(self, context):
+        """Books created after the hint accept more orders than the hint"""
+        lib.mx_context_set_capacity_hints(context, 64, 16)
+        book = lib.mx_order_book_new(context, b"HINT")
+        
+        for i in range(1, 501):
+            assert lib.mx_order_book_add_limit(book, i, SIDE_BUY, 1000 + i, 10) == STATUS_OK
+        for i in range(1, 501):
+            assert lib.mx_order_book_has_order(book, i) == 1
+        
+        lib.mx_order_book_free(book)
+    
+    def test_churn_keeps_lookups_consistent(self, order_book):
+        """Interleaved adds and cancels never lose or resurrect an order"""
+        import random
+        rng = random.Random(42)
+        live = set()
+        
+        for step in range(20000):
+            if live and rng.random() < 0.5:
+                order_id = rng.choice(tuple(live))
+                assert lib.mx_order_book_cancel(order_book, order_id) == STATUS_OK
+                live.discard(order_id)
+            else:
+                # Sparse, clustered IDs exercise long probe runs
+                order_id = rng.randrange(1, 4096) * 1024 + rng.randrange(4)
+                status = lib.mx_order_book_add_limit(
+                    order_book, order_id, SIDE_BUY, price_to_ticks(100.00), 10
+                )
+                if order_id in live:
+                    assert status == STATUS_DUPLICATE_ORDER
+                else:
+                    assert status == STATUS_OK
+                    live.add(order_id)
+        
+        for order_id in list(live)[:500]:
+            assert lib.mx_order_book_has_order(order_book, order_id) == 1
+        assert lib.mx_order_book_cancel(order_book, 1023) == STATUS_ORDER_NOT_FOUND
+        
+        # ID 0 marks empty slots and must never be found
+        assert lib.mx_order_book_has_order(order_book, 0) == 0
+        assert lib.mx_order_book_cancel(order_book, 0) == STATUS_ORDER_NOT_FOUND
+        
+        total = ffi.new("uint32_t*")
+        lib.mx_order_book_get_stats(order_book, total, ffi.NULL, ffi.NULL, ffi.NULL, ffi.NULL)
+        assert total[0] == len(live)
+
+class TestOrderExpiry:
+    """Test DAY/GTD expiration"""
+    
+    def test_only_due_orders_expire(self, book_with_callbacks):
+        """Orders expire in time order and unexpiring orders are untouched"""
+        book, trades, events = book_with_callbacks
+        
+        add_timed_limit(book, 1, SIDE_BUY, price_to_ticks(99.00), 10, 3000)
+        add_timed_limit(book, 2, SIDE_BUY, price_to_ticks(98.00), 10, 1000, TIF_DAY)
+        add_timed_limit(book, 3, SIDE_BUY, price_to_ticks(97.00), 10, 2000)
+        lib.mx_order_book_add_limit(book, 4, SIDE_BUY, price_to_ticks(96.00), 10)
+        
+        assert lib.mx_order_book_process_expirations(book, 999) == 0
+        assert lib.mx_order_book_process_expirations(book, 2000) == 2
+        expired = [e['order_id'] for e in events.events if e['event'] == EVENT_EXPIRED]
+        assert expired == [2, 3]
+        
+        assert lib.mx_order_book_has_order(book, 1) == 1
+        assert lib.mx_order_book_has_order(book, 4) == 1
+        assert lib.mx_order_book_get_best_bid(book) == price_to_ticks(99.00)
+        
+        assert lib.mx_order_book_process_expirations(book, 10**12) == 1
+        assert lib.mx_order_book_has_order(book, 4) == 1
+    
+    def test_cancelled_and_filled_orders_unscheduled(self, book_with_callbacks):
+        """Orders that leave the book early never produce an expiry"""
+        book, trades, events = book_with_callbacks
+        
+        add_timed_limit(book, 1, SIDE_SELL, price_to_ticks(101.00), 10, 1000)
+        add_timed_limit(book, 2, SIDE_SELL, price_to_ticks(102.00), 10, 1000)
+        add_timed_limit(book, 3, SIDE_SELL, price_to_ticks(103.00), 10, 1000)
+        
+        lib.mx_order_book_cancel(book, 2)
+        lib.mx_order_book_add_limit(book, 4, SIDE_BUY, price_to_ticks(101.00), 10)
+        
+        assert lib.mx_order_book_process_expirations(book, 5000) == 1
+        assert [e['order_id'] for e in events.events if e['event'] == EVENT_EXPIRED] == [3]
+        assert lib.mx_order_book_get_best_ask(book) == 0
+    
+    def test_random_schedule(self, order_book):
+        """Random adds/cancels/expiry passes agree with a reference model"""
+        import random
+        rng = random.Random(7)
+        live = {}
+        
+        for order_id in range(1, 3001):
+            if live and rng.random() < 0.3:
+                victim = rng.choice(tuple(live))
+                assert lib.mx_order_book_cancel(order_book, victim) == STATUS_OK
+                del live[victim]
+            else:
+                expire = rng.randint(1, 500)
+                add_timed_limit(order_book, order_id, SIDE_BUY, 1000 + order_id % 50, 10, expire)
+                live[order_id] = expire
+            
+            if order_id % 100 == 0:
+                now = order_id // 6
+                due = [oid for oid, t in live.items() if t <= now]
+                assert lib.mx_order_book_process_expirations(order_book, now) == len(due)
+                for oid in due:
+                    del live[oid]
+        
+        for oid in live:
+            assert lib.mx_order_book_has_order(order_book, oid) == 1
+        assert lib.mx_order_book_process_expirations(order_book, 1000) == len(live)
+
 class TestOrderBookStats:
     """Test order book statistics"""
     
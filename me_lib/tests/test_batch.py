@@ -0,0 +1,171 @@
+"""
+Batch entry tests
+mx_order_book_submit_batch must behave exactly like the same commands
+submitted one call at a time
+"""
+
+import random
+import pytest
+from testhelpers import (
+    ffi, lib,
+    SIDE_BUY, SIDE_SELL,
+    ORDER_TYPE_LIMIT, ORDER_TYPE_MARKET, ORDER_TYPE_STOP,
+    TIF_GTC, TIF_IOC,
+    STATUS_OK, STATUS_INVALID_PARAM, STATUS_ORDER_NOT_FOUND,
+    STATUS_DUPLICATE_ORDER, STATUS_INVALID_QUANTITY,
+    create_context, free_context,
+    create_order_book, free_order_book,
+    create_trade_callback, create_order_callback,
+    price_to_ticks
+)
+
+CMD_NEW = lib.MX_CMD_NEW
+CMD_CANCEL = lib.MX_CMD_CANCEL
+CMD_MODIFY = lib.MX_CMD_MODIFY
+
+def make_batch(commands):
+    """Build an mx_command_t array from dicts"""
+    batch = ffi.new("mx_command_t[%d]" % len(commands))
+    for i, cmd in enumerate(commands):
+        for key, value in cmd.items():
+            setattr(batch[i], key, value)
+    return batch
+
+def new_limit(order_id, side, price, quantity, tif=TIF_GTC):
+    return dict(type=CMD_NEW, order_id=order_id, order_type=ORDER_TYPE_LIMIT,
+                side=side, price=price, quantity=quantity, tif=tif)
+
+class TestSubmitBatch:
+    """Test batch order entry"""
+    
+    def test_mixed_batch_statuses(self, book_with_callbacks):
+        """Each command reports its own status and later commands see earlier ones"""
+        book, trades, events = book_with_callbacks
+        
+        commands = [
+            new_limit(1, SIDE_SELL, price_to_ticks(100.00), 100),
+            new_limit(1, SIDE_SELL, price_to_ticks(100.00), 100),       # duplicate
+            dict(type=CMD_MODIFY, order_id=1, quantity=60),
+            new_limit(2, SIDE_BUY, price_to_ticks(100.00), 20),          # trades
+            dict(type=CMD_CANCEL, order_id=99),                         # unknown
+            dict(type=CMD_MODIFY, order_id=1, quantity=500),            # grow refused
+            dict(type=7, order_id=3),                                   # bad command
+            dict(type=CMD_NEW, order_id=4, order_type=ORDER_TYPE_MARKET,
+                 side=SIDE_BUY, quantity=10, tif=TIF_IOC),
+            dict(type=CMD_CANCEL, order_id=1),
+        ]
+        batch = make_batch(commands)
+        statuses = ffi.new("int[%d]" % len(commands))
+        
+        ok = lib.mx_order_book_submit_batch(book, batch, statuses, len(commands))
+        
+        assert [statuses[i] for i in range(len(commands))] == [
+            STATUS_OK, STATUS_DUPLICATE_ORDER, STATUS_OK, STATUS_OK,
+            STATUS_ORDER_NOT_FOUND, STATUS_INVALID_QUANTITY, STATUS_INVALID_PARAM,
+            STATUS_OK, STATUS_OK,
+        ]
+        assert ok == 5
+        assert [(t['aggressive_id'], t['quantity']) for t in trades.trades] == [(2, 20), (4, 10)]
+        assert lib.mx_order_book_has_order(book, 1) == 0
+    
+    def test_invalid_enums_rejected(self, order_book):
+        batch = make_batch([
+            dict(type=CMD_NEW, order_id=1, order_type=ORDER_TYPE_LIMIT, side=2,
+                 price=100, quantity=10),
+            dict(type=CMD_NEW, order_id=2, order_type=9, side=SIDE_BUY,
+                 price=100, quantity=10),
+            dict(type=CMD_NEW, order_id=3, order_type=ORDER_TYPE_LIMIT, side=SIDE_BUY,
+                 price=100, quantity=10, tif=42),
+        ])
+        statuses = ffi.new("int[3]")
+        
+        assert lib.mx_order_book_submit_batch(order_book, batch, statuses, 3) == 0
+        assert [statuses[i] for i in range(3)] == [STATUS_INVALID_PARAM] * 3
+        assert lib.mx_order_book_get_best_bid(order_book) == 0
+    
+    def test_null_statuses_and_empty_batch(self, order_book):
+        batch = make_batch([new_limit(1, SIDE_BUY, price_to_ticks(99.00), 10)])
+        
+        assert lib.mx_order_book_submit_batch(order_book, batch, ffi.NULL, 1) == 1
+        assert lib.mx_order_book_submit_batch(order_book, ffi.NULL, ffi.NULL, 0) == 0
+        assert lib.mx_order_book_submit_batch(ffi.NULL, batch, ffi.NULL, 1) == 0
+        assert lib.mx_order_book_get_best_bid(order_book) == price_to_ticks(99.00)
+    
+    def test_stop_in_batch(self, book_with_callbacks):
+        """Stops submitted in a batch fire on later commands of the same batch"""
+        book, trades, events = book_with_callbacks
+        
+        batch = make_batch([
+            new_limit(1, SIDE_SELL, price_to_ticks(101.00), 10),
+            new_limit(2, SIDE_SELL, price_to_ticks(102.00), 10),
+            dict(type=CMD_NEW, order_id=3, order_type=ORDER_TYPE_STOP, side=SIDE_BUY,
+                 stop_price=price_to_ticks(102.00), quantity=10),
+            new_limit(4, SIDE_BUY, price_to_ticks(101.00), 10),
+        ])
+        
+        assert lib.mx_order_book_submit_batch(book, batch, ffi.NULL, 4) == 4
+        assert [(t['aggressive_id'], t['passive_id']) for t in trades.trades] == [(4, 1), (3, 2)]
+
+class TestBatchMatchesSingleCalls:
+    """Differential test: one batch equals the same single calls"""
+    
+    def test_random_flow(self):
+        rng = random.Random(5)
+        
+        streams = []
+        books = []
+        contexts = []
+        callbacks = []
+        for _ in range(2):
+            ctx = create_context()
+            stream = []
+            trade_cb = create_trade_callback(
+                lambda a, p, px, q, ts, stream=stream: stream.append(('trade', a, p, px, q)))
+            order_cb = create_order_callback(
+                lambda oid, ev, f, r, stream=stream: stream.append(('order', oid, ev, f, r)))
+            lib.mx_context_set_callbacks(ctx, trade_cb, order_cb, ffi.NULL)
+            contexts.append(ctx)
+            callbacks.append((trade_cb, order_cb))
+            streams.append(stream)
+            books.append(create_order_book(ctx, "DIFF"))
+        
+        commands = []
+        live = []
+        for order_id in range(1, 1501):
+            action = rng.random()
+            if action < 0.6 or not live:
+                cmd = new_limit(order_id, rng.choice((SIDE_BUY, SIDE_SELL)),
+                                rng.randint(9950, 10050), rng.randint(1, 50),
+                                tif=rng.choice((TIF_GTC, TIF_GTC, TIF_IOC)))
+                live.append(order_id)
+            elif action < 0.85:
+                cmd = dict(type=CMD_CANCEL, order_id=live.pop(rng.randrange(len(live))))
+            else:
+                cmd = dict(type=CMD_MODIFY, order_id=rng.choice(live),
+                           quantity=rng.randint(1, 30))
+            commands.append(cmd)
+        
+        singles = []
+        for cmd in commands:
+            if cmd['type'] == CMD_NEW:
+                status = lib.mx_order_book_add_order(
+                    books[0], cmd['order_id'], ORDER_TYPE_LIMIT, cmd['side'],
+                    cmd['price'], 0, cmd['quantity'], 0, cmd['tif'], 0, 0)
+            elif cmd['type'] == CMD_CANCEL:
+                status = lib.mx_order_book_cancel(books[0], cmd['order_id'])
+            else:
+                status = lib.mx_order_book_modify(books[0], cmd['order_id'], cmd['quantity'])
+            singles.append(status)
+        
+        batch = make_batch(commands)
+        statuses = ffi.new("int[%d]" % len(commands))
+        ok = lib.mx_order_book_submit_batch(books[1], batch, statuses, len(commands))
+        
+        assert [statuses[i] for i in range(len(commands))] == singles
+        assert ok == singles.count(STATUS_OK)
+        assert streams[0] == streams[1]
+        assert any(e[0] == 'trade' for e in streams[0])
+        
+        for book, ctx in zip(books, contexts):
+            free_order_book(book)
+            free_context(ctx)
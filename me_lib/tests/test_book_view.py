@@ -0,0 +1,205 @@
+"""
+Published book view tests
+Books created from a context with a book view publish top of book, the
+best levels and counters at the end of every mutating call; any thread
+can copy the latest view with mx_order_book_read_view
+"""
+
+import random
+import threading
+import pytest
+from testhelpers import (
+    ffi, lib,
+    SIDE_BUY, SIDE_SELL,
+    STATUS_OK, STATUS_ERROR, STATUS_INVALID_PARAM,
+    create_order_book, free_order_book,
+    price_to_ticks
+)
+
+VIEW_LEVELS = lib.MX_BOOK_VIEW_LEVELS
+
+def read_view(book):
+    view = ffi.new("mx_book_view_t*")
+    assert lib.mx_order_book_read_view(book, view) == STATUS_OK
+    return view
+
+def levels(view, side):
+    entries = view.bids if side == SIDE_BUY else view.asks
+    count = view.bid_count if side == SIDE_BUY else view.ask_count
+    return [(entries[i].price, entries[i].volume, entries[i].order_count) for i in range(count)]
+
+def book_levels(book, side, count):
+    out = ffi.new("mx_level_t[%d]" % max(count, 1))
+    n = lib.mx_order_book_get_levels(book, side, count, out)
+    return [(out[i].price, out[i].volume, out[i].order_count) for i in range(n)]
+
+@pytest.fixture
+def viewed_book(context):
+    """Order book publishing five levels per side"""
+    assert lib.mx_context_set_book_view(context, 1, 5) == STATUS_OK
+    book = create_order_book(context, "VIEW")
+    assert book != ffi.NULL
+
+    yield book
+
+    free_order_book(book)
+
+class TestBookView:
+    """Test view contents and publishing"""
+
+    def test_disabled_by_default(self, order_book):
+        """Books from a plain context publish nothing"""
+        lib.mx_order_book_add_limit(order_book, 1, SIDE_BUY, price_to_ticks(100.00), 10)
+
+        view = ffi.new("mx_book_view_t*")
+        assert lib.mx_order_book_read_view(order_book, view) == STATUS_ERROR
+        assert lib.mx_order_book_view_sequence(order_book) == 0
+
+    def test_invalid_arguments(self, context, viewed_book):
+        """NULL arguments and oversized level counts are refused"""
+        view = ffi.new("mx_book_view_t*")
+        assert lib.mx_order_book_read_view(ffi.NULL, view) == STATUS_INVALID_PARAM
+        assert lib.mx_order_book_read_view(viewed_book, ffi.NULL) == STATUS_INVALID_PARAM
+        assert lib.mx_order_book_view_sequence(ffi.NULL) == 0
+        assert lib.mx_context_set_book_view(ffi.NULL, 1, 5) == STATUS_INVALID_PARAM
+        assert lib.mx_context_set_book_view(context, 1, VIEW_LEVELS + 1) == STATUS_INVALID_PARAM
+
+    def test_empty_before_first_operation(self, viewed_book):
+        """A new book reads as an empty view with sequence 0"""
+        view = read_view(viewed_book)
+        assert view.sequence == 0
+        assert view.best_bid == 0 and view.best_ask == 0
+        assert view.bid_count == 0 and view.ask_count == 0
+
+    def test_tracks_operations(self, viewed_book):
+        """Each call publishes once, with the book as it left it"""
+        book = viewed_book
+        bid = price_to_ticks(100.00)
+        ask = price_to_ticks(101.00)
+
+        lib.mx_order_book_add_limit(book, 1, SIDE_BUY, bid, 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_BUY, bid, 5)
+        lib.mx_order_book_add_limit(book, 3, SIDE_SELL, ask, 7)
+
+        view = read_view(book)
+        assert view.sequence == 3
+        assert lib.mx_order_book_view_sequence(book) == 3
+        assert view.best_bid == bid and view.best_ask == ask
+        assert view.order_count == 3
+        assert view.bid_volume == 15 and view.ask_volume == 7
+        assert levels(view, SIDE_BUY) == [(bid, 15, 2)]
+        assert levels(view, SIDE_SELL) == [(ask, 7, 1)]
+
+        # A cross trades and updates the counters
+        lib.mx_order_book_add_limit(book, 4, SIDE_SELL, bid, 12)
+        view = read_view(book)
+        assert view.sequence == 4
+        assert view.total_trades == 2
+        assert view.total_volume == 12
+        assert levels(view, SIDE_BUY) == [(bid, 3, 1)]
+
+        # Rejected calls still publish (the view is simply unchanged)
+        assert lib.mx_order_book_cancel(book, 99) != STATUS_OK
+        assert read_view(book).sequence == 5
+
+        lib.mx_order_book_clear(book)
+        view = read_view(book)
+        assert view.best_bid == 0 and view.best_ask == 0
+        assert view.order_count == 0 and view.bid_count == 0
+
+    def test_batch_publishes_once(self, viewed_book):
+        """A batch is one publish however many commands it runs"""
+        book = viewed_book
+        commands = ffi.new("mx_command_t[10]")
+        for i in range(10):
+            commands[i].type = lib.MX_CMD_NEW
+            commands[i].order_id = i + 1
+            commands[i].side = SIDE_BUY
+            commands[i].price = price_to_ticks(100.00) - i
+            commands[i].quantity = 10
+
+        assert lib.mx_order_book_submit_batch(book, commands, ffi.NULL, 10) == 10
+
+        view = read_view(book)
+        assert view.sequence == 1
+        assert view.bid_level_count == 10
+        assert view.bid_count == 5
+        assert levels(view, SIDE_BUY) == book_levels(book, SIDE_BUY, 5)
+
+    def test_top_of_book_only(self, context):
+        """Zero levels still publishes top of book and counters"""
+        assert lib.mx_context_set_book_view(context, 1, 0) == STATUS_OK
+        book = create_order_book(context, "TOP")
+        try:
+            lib.mx_order_book_add_limit(book, 1, SIDE_SELL, price_to_ticks(50.00), 4)
+            view = read_view(book)
+            assert view.best_ask == price_to_ticks(50.00)
+            assert view.ask_volume == 4
+            assert view.ask_count == 0
+        finally:
+            free_order_book(book)
+
+class TestBookViewConcurrency:
+    """Test reading the view while another thread trades the book"""
+
+    def test_reader_sees_consistent_views(self, context):
+        """Every view a reader copies matches some state the book was in"""
+        assert lib.mx_context_set_book_view(context, 1, VIEW_LEVELS) == STATUS_OK
+        book = create_order_book(context, "RACE")
+        stop = threading.Event()
+        problems = []
+        reads = [0]
+
+        def reader():
+            view = ffi.new("mx_book_view_t*")
+            last = 0
+            while not stop.is_set():
+                assert lib.mx_order_book_read_view(book, view) == STATUS_OK
+                reads[0] += 1
+                if view.sequence < last:
+                    problems.append(('sequence', last, view.sequence))
+                last = view.sequence
+                if view.best_bid and view.best_ask and view.best_bid >= view.best_ask:
+                    problems.append(('crossed', view.best_bid, view.best_ask))
+                bids = levels(view, SIDE_BUY)
+                asks = levels(view, SIDE_SELL)
+                if bids and bids[0][0] != view.best_bid:
+                    problems.append(('bid top', bids[0][0], view.best_bid))
+                if asks and asks[0][0] != view.best_ask:
+                    problems.append(('ask top', asks[0][0], view.best_ask))
+                if [p for p, _, _ in bids] != sorted((p for p, _, _ in bids), reverse=True):
+                    problems.append(('bid order', bids))
+                if sum(v for _, v, _ in bids) > view.bid_volume:
+                    problems.append(('bid volume', view.bid_volume))
+
+        thread = threading.Thread(target=reader)
+        thread.start()
+        try:
+            rng = random.Random(28)
+            live = []
+            for order_id in range(1, 20001):
+                if live and rng.random() < 0.3:
+                    lib.mx_order_book_cancel(book, live.pop(rng.randrange(len(live))))
+                else:
+                    side = rng.choice((SIDE_BUY, SIDE_SELL))
+                    price = 10000 + rng.randint(-40, 40)
+                    lib.mx_order_book_add_limit(book, order_id, side, price, rng.randint(1, 100))
+                    if lib.mx_order_book_has_order(book, order_id):
+                        live.append(order_id)
+        finally:
+            stop.set()
+            thread.join()
+
+        # Quiet again, the view matches the book exactly
+        final = read_view(book)
+        try:
+            assert final.sequence == lib.mx_order_book_view_sequence(book)
+            assert levels(final, SIDE_BUY) == book_levels(book, SIDE_BUY, VIEW_LEVELS)
+            assert levels(final, SIDE_SELL) == book_levels(book, SIDE_SELL, VIEW_LEVELS)
+            assert final.best_bid == lib.mx_order_book_get_best_bid(book)
+            assert final.best_ask == lib.mx_order_book_get_best_ask(book)
+        finally:
+            free_order_book(book)
+
+        assert problems == []
+        assert reads[0] > 0
@@ -0,0 +1,117 @@
+"""
+Context clock tests
+Books read the context clock once per call (once per batch) and stamp
+everything that call does with the same time; the source is coarse by
+default and can be switched to the system clock, the TSC or manual time
+"""
+
+import time
+import pytest
+from testhelpers import (
+    ffi, lib,
+    SIDE_BUY, SIDE_SELL,
+    STATUS_OK, STATUS_INVALID_PARAM,
+    create_order_book, free_order_book,
+    create_trade_callback
+)
+
+CLOCK_COARSE = lib.MX_CLOCK_COARSE
+CLOCK_SYSTEM = lib.MX_CLOCK_SYSTEM
+CLOCK_TSC = lib.MX_CLOCK_TSC
+CLOCK_MANUAL = lib.MX_CLOCK_MANUAL
+
+def monotonic_ns():
+    return time.clock_gettime_ns(time.CLOCK_MONOTONIC)
+
+@pytest.fixture
+def stamped(context):
+    """Book whose trade timestamps are recorded"""
+    stamps = []
+
+    def on_trade(aggressive_id, passive_id, price, quantity, timestamp):
+        stamps.append(timestamp)
+
+    trade_cb = create_trade_callback(on_trade)
+    lib.mx_context_set_callbacks(context, trade_cb, ffi.NULL, ffi.NULL)
+    book = create_order_book(context, "CLOCK")
+
+    yield book, stamps
+
+    free_order_book(book)
+
+def sweep(book, first_id, levels=5):
+    """Rest one order per level, then take them all with one buy"""
+    for i in range(levels):
+        lib.mx_order_book_add_limit(book, first_id + i, SIDE_SELL, 100 + i, 1)
+    lib.mx_order_book_add_limit(book, first_id + levels, SIDE_BUY, 100 + levels, levels)
+
+class TestClockSource:
+    """Test selecting the time source"""
+
+    def test_default_is_coarse(self, context):
+        assert lib.mx_context_get_clock(context) == CLOCK_COARSE
+
+    def test_invalid_arguments(self, context):
+        assert lib.mx_context_set_clock(ffi.NULL, CLOCK_SYSTEM) == STATUS_INVALID_PARAM
+        assert lib.mx_context_set_clock(context, 99) == STATUS_INVALID_PARAM
+        assert lib.mx_context_get_clock(context) == CLOCK_COARSE
+        assert lib.mx_context_update_timestamp(ffi.NULL) == 0
+
+    def test_set_timestamp_is_manual(self, context):
+        """Manual time never moves on its own"""
+        lib.mx_context_set_timestamp(context, 42)
+        assert lib.mx_context_get_clock(context) == CLOCK_MANUAL
+        assert lib.mx_context_update_timestamp(context) == 42
+
+class TestClockReadings:
+    """Test when books read the clock"""
+
+    def test_coarse_moves_per_batch(self, context, stamped):
+        book, stamps = stamped
+        start = lib.mx_context_get_timestamp(context)
+
+        sweep(book, 1)
+        assert stamps == [start] * 5
+
+        command = ffi.new("mx_command_t*")
+        command.type = lib.MX_CMD_NEW
+        command.order_id = 100
+        command.side = SIDE_BUY
+        command.price = 50
+        command.quantity = 1
+        time.sleep(0.001)
+        assert lib.mx_order_book_submit_batch(book, command, ffi.NULL, 1) == 1
+        assert lib.mx_context_get_timestamp(context) > start
+
+    @pytest.mark.parametrize("source", [CLOCK_SYSTEM, CLOCK_TSC])
+    def test_live_sources_read_once_per_call(self, context, stamped, source):
+        """One reading per call, taken while the call ran"""
+        status = lib.mx_context_set_clock(context, source)
+        if source == CLOCK_TSC and status != STATUS_OK:
+            pytest.skip("CPU has no invariant TSC")
+        assert status == STATUS_OK
+        book, stamps = stamped
+
+        for i in range(5):
+            lib.mx_order_book_add_limit(book, 1 + i, SIDE_SELL, 100 + i, 1)
+        before = monotonic_ns()
+        lib.mx_order_book_add_limit(book, 10, SIDE_BUY, 105, 5)
+        after = monotonic_ns()
+
+        assert len(stamps) == 5
+        assert len(set(stamps)) == 1
+        # TSC time is scaled onto CLOCK_MONOTONIC; allow for calibration error
+        slack = 0 if source == CLOCK_SYSTEM else 100000
+        assert before - slack <= stamps[0] <= after + slack
+
+        # The next call reads again
+        time.sleep(0.001)
+        lib.mx_order_book_cancel(book, 999)
+        assert lib.mx_context_get_timestamp(context) > stamps[0]
+
+    def test_update_timestamp(self, context):
+        """Explicit refresh reads the system clock under the coarse source"""
+        before = monotonic_ns()
+        now = lib.mx_context_update_timestamp(context)
+        assert before <= now <= monotonic_ns()
+        assert lib.mx_context_get_timestamp(context) == now
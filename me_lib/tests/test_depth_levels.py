@@ -0,0 +1,189 @@
+"""
+Depth level tests
+mx_order_book_get_levels serves the top levels from a per-side cache -
+these tests check it always agrees with the book itself
+"""
+
+import random
+import pytest
+from testhelpers import (
+    ffi, lib,
+    SIDE_BUY, SIDE_SELL,
+    ORDER_TYPE_LIMIT, TIF_GTC,
+    STATUS_OK,
+    create_order_book, free_order_book,
+    price_to_ticks
+)
+
+CACHED_LEVELS = 16
+
+def get_levels(book, side, max_levels):
+    """Levels as (price, volume, visible_volume, order_count) tuples"""
+    out = ffi.new("mx_level_t[%d]" % max(max_levels, 1))
+    count = lib.mx_order_book_get_levels(book, side, max_levels, out)
+    return [(out[i].price, out[i].volume, out[i].visible_volume, out[i].order_count)
+            for i in range(count)]
+
+def get_side_volumes(book):
+    bid_volume = ffi.new("uint64_t*")
+    ask_volume = ffi.new("uint64_t*")
+    lib.mx_order_book_get_stats(book, ffi.NULL, ffi.NULL, ffi.NULL, bid_volume, ask_volume)
+    return bid_volume[0], ask_volume[0]
+
+def add_iceberg(book, order_id, side, price, quantity, display_qty):
+    return lib.mx_order_book_add_order(book, order_id, ORDER_TYPE_LIMIT, side,
+                                       price, 0, quantity, display_qty, TIF_GTC, 0, 0)
+
+class TestGetLevels:
+    """Test the top-N level snapshot"""
+
+    def test_levels_best_first(self, order_book):
+        """Each side comes back best first with per-level aggregates"""
+        book = order_book
+
+        lib.mx_order_book_add_limit(book, 1, SIDE_BUY, price_to_ticks(99.00), 100)
+        lib.mx_order_book_add_limit(book, 2, SIDE_BUY, price_to_ticks(100.00), 50)
+        lib.mx_order_book_add_limit(book, 3, SIDE_BUY, price_to_ticks(99.00), 25)
+        lib.mx_order_book_add_limit(book, 4, SIDE_SELL, price_to_ticks(102.00), 10)
+        lib.mx_order_book_add_limit(book, 5, SIDE_SELL, price_to_ticks(101.00), 20)
+
+        assert get_levels(book, SIDE_BUY, 10) == [
+            (price_to_ticks(100.00), 50, 50, 1),
+            (price_to_ticks(99.00), 125, 125, 2),
+        ]
+        assert get_levels(book, SIDE_SELL, 10) == [
+            (price_to_ticks(101.00), 20, 20, 1),
+            (price_to_ticks(102.00), 10, 10, 1),
+        ]
+        assert get_levels(book, SIDE_BUY, 1) == [(price_to_ticks(100.00), 50, 50, 1)]
+
+    def test_empty_and_invalid(self, order_book):
+        """Empty sides, zero capacity and NULL arguments return nothing"""
+        book = order_book
+
+        assert get_levels(book, SIDE_BUY, 10) == []
+        lib.mx_order_book_add_limit(book, 1, SIDE_BUY, price_to_ticks(100.00), 10)
+        assert get_levels(book, SIDE_BUY, 0) == []
+
+        out = ffi.new("mx_level_t[4]")
+        assert lib.mx_order_book_get_levels(ffi.NULL, SIDE_BUY, 4, out) == 0
+        assert lib.mx_order_book_get_levels(book, SIDE_BUY, 4, ffi.NULL) == 0
+
+    def test_iceberg_visible_volume(self, order_book):
+        """Visible volume counts only the displayed part of icebergs"""
+        book = order_book
+
+        assert add_iceberg(book, 1, SIDE_SELL, price_to_ticks(100.00), 1000, 100) == STATUS_OK
+        lib.mx_order_book_add_limit(book, 2, SIDE_SELL, price_to_ticks(100.00), 50)
+
+        assert get_levels(book, SIDE_SELL, 1) == [(price_to_ticks(100.00), 1050, 150, 2)]
+
+    def test_levels_follow_changes(self, order_book):
+        """Fills, cancels and modifies show up on the next query"""
+        book = order_book
+
+        for i in range(5):
+            lib.mx_order_book_add_limit(book, 10 + i, SIDE_SELL, price_to_ticks(100.00) + i, 100)
+        assert len(get_levels(book, SIDE_SELL, 10)) == 5
+
+        # Sweep the best level and part of the next
+        lib.mx_order_book_add_limit(book, 1, SIDE_BUY, price_to_ticks(100.00) + 1, 150)
+        assert get_levels(book, SIDE_SELL, 2) == [
+            (price_to_ticks(100.00) + 1, 50, 50, 1),
+            (price_to_ticks(100.00) + 2, 100, 100, 1),
+        ]
+
+        assert lib.mx_order_book_cancel(book, 12) == STATUS_OK
+        assert lib.mx_order_book_modify(book, 13, 40) == STATUS_OK
+        assert get_levels(book, SIDE_SELL, 10) == [
+            (price_to_ticks(100.00) + 1, 50, 50, 1),
+            (price_to_ticks(100.00) + 3, 40, 40, 1),
+            (price_to_ticks(100.00) + 4, 100, 100, 1),
+        ]
+
+        lib.mx_order_book_clear(book)
+        assert get_levels(book, SIDE_SELL, 10) == []
+
+    def test_changes_beyond_cached_levels(self, order_book):
+        """Deep levels are served past the cache and changes behind it stay correct"""
+        book = order_book
+
+        levels = CACHED_LEVELS + 8
+        for i in range(levels):
+            lib.mx_order_book_add_limit(book, 100 + i, SIDE_BUY, price_to_ticks(100.00) - i, 10 + i)
+
+        top = get_levels(book, SIDE_BUY, CACHED_LEVELS)
+        assert len(top) == CACHED_LEVELS
+        assert len(get_levels(book, SIDE_BUY, 64)) == levels
+
+        # Behind the cached levels: the top is unchanged
+        lib.mx_order_book_cancel(book, 100 + levels - 1)
+        assert get_levels(book, SIDE_BUY, CACHED_LEVELS) == top
+
+        # Inside them: the next level moves up
+        lib.mx_order_book_cancel(book, 100)
+        assert get_levels(book, SIDE_BUY, CACHED_LEVELS) == get_levels(book, SIDE_BUY, 64)[:CACHED_LEVELS]
+        assert get_levels(book, SIDE_BUY, 1)[0][0] == price_to_ticks(100.00) - 1
+
+    def test_depth_and_stats_agree(self, order_book):
+        """get_depth and the stats totals match the level snapshot"""
+        book = order_book
+
+        for i in range(20):
+            lib.mx_order_book_add_limit(book, 1 + i, SIDE_BUY, price_to_ticks(99.00) - i, 10 * (i + 1))
+            lib.mx_order_book_add_limit(book, 100 + i, SIDE_SELL, price_to_ticks(101.00) + i, 5 * (i + 1))
+        lib.mx_order_book_add_limit(book, 200, SIDE_BUY, price_to_ticks(101.00) + 1, 12)
+
+        bids = get_levels(book, SIDE_BUY, 64)
+        asks = get_levels(book, SIDE_SELL, 64)
+        for n in (1, 5, CACHED_LEVELS, 20):
+            assert lib.mx_order_book_get_depth(book, SIDE_BUY, n) == sum(l[1] for l in bids[:n])
+            assert lib.mx_order_book_get_depth(book, SIDE_SELL, n) == sum(l[1] for l in asks[:n])
+        assert get_side_volumes(book) == (sum(l[1] for l in bids), sum(l[1] for l in asks))
+
+class TestLevelsMatchBook:
+    """Randomised flow against an uncached walk of the book"""
+
+    def test_random_flow_map(self, context):
+        """Cached top levels always equal the first levels of a full walk"""
+        self.run_random_flow(context)
+
+    def test_random_flow_ladder(self, context):
+        """Same on the tick-indexed ladder backend"""
+        assert lib.mx_context_set_price_bounds(context, price_to_ticks(50.00),
+                                               price_to_ticks(150.00), 1) == STATUS_OK
+        self.run_random_flow(context)
+
+    def run_random_flow(self, context):
+        book = create_order_book(context, "DEPTH")
+        rng = random.Random(19)
+        live = []
+
+        for order_id in range(1, 3001):
+            action = rng.random()
+            if action < 0.6 or not live:
+                side = rng.choice([SIDE_BUY, SIDE_SELL])
+                offset = rng.randint(-5, 40)
+                price = price_to_ticks(100.00) + (offset if side == SIDE_SELL else -offset)
+                quantity = rng.randint(1, 200)
+                if rng.random() < 0.1:
+                    add_iceberg(book, order_id, side, price, quantity * 5, quantity)
+                else:
+                    lib.mx_order_book_add_limit(book, order_id, side, price, quantity)
+                live.append(order_id)
+            elif action < 0.85:
+                lib.mx_order_book_cancel(book, live.pop(rng.randrange(len(live))))
+            else:
+                lib.mx_order_book_modify(book, rng.choice(live), rng.randint(1, 100))
+
+            for side in (SIDE_BUY, SIDE_SELL):
+                n = rng.choice([1, 5, 10, CACHED_LEVELS])
+                full = get_levels(book, side, 256)
+                assert get_levels(book, side, n) == full[:n]
+
+            if order_id % 100 == 0:
+                bids = get_levels(book, SIDE_BUY, 256)
+                asks = get_levels(book, SIDE_SELL, 256)
+                assert get_side_volumes(book) == (sum(l[1] for l in bids), sum(l[1] for l in asks))
+
+        free_order_book(book)
@@ -0,0 +1,163 @@
+"""
+Buffered event tests
+Books created from a context with an event buffer append trade and order
+events to a ring instead of calling callbacks; mx_order_book_poll_events
+drains them in the same order the callbacks would have fired
+"""
+
+import random
+import pytest
+from testhelpers import (
+    ffi, lib,
+    SIDE_BUY, SIDE_SELL,
+    STATUS_OK, STATUS_INVALID_PARAM,
+    EVENT_ACCEPTED, EVENT_FILLED, EVENT_PARTIAL,
+    create_context, free_context,
+    create_order_book, free_order_book,
+    create_trade_callback, create_order_callback,
+    price_to_ticks
+)
+
+EVENT_TYPE_TRADE = lib.MX_EVENT_TYPE_TRADE
+EVENT_TYPE_ORDER = lib.MX_EVENT_TYPE_ORDER
+
+def drain(book, chunk=64):
+    """Poll every pending event as (type, ...) tuples matching the callback args"""
+    buf = ffi.new("mx_event_t[%d]" % chunk)
+    out = []
+    while True:
+        n = lib.mx_order_book_poll_events(book, buf, chunk)
+        for i in range(n):
+            e = buf[i]
+            if e.type == EVENT_TYPE_TRADE:
+                out.append(('trade', e.order_id, e.passive_order_id, e.price, e.quantity))
+            else:
+                out.append(('order', e.order_id, e.order_event, e.quantity, e.remaining))
+        if n < chunk:
+            return out
+
+@pytest.fixture
+def buffered_book(context):
+    """Order book that buffers events instead of calling back"""
+    assert lib.mx_context_set_event_buffer(context, 16) == STATUS_OK
+    book = create_order_book(context, "BUFFERED")
+    assert book != ffi.NULL
+    
+    yield book
+    
+    free_order_book(book)
+
+class TestEventBuffer:
+    """Test buffered event delivery"""
+    
+    def test_invalid_context(self):
+        assert lib.mx_context_set_event_buffer(ffi.NULL, 16) == STATUS_INVALID_PARAM
+    
+    def test_callbacks_not_called(self, context, trade_recorder, order_event_recorder):
+        """Buffered books never invoke the context callbacks"""
+        trade_cb = create_trade_callback(trade_recorder.record)
+        order_cb = create_order_callback(order_event_recorder.record)
+        lib.mx_context_set_callbacks(context, trade_cb, order_cb, ffi.NULL)
+        lib.mx_context_set_event_buffer(context, 16)
+        book = create_order_book(context, "QUIET")
+        
+        lib.mx_order_book_add_limit(book, 1, SIDE_SELL, price_to_ticks(100.00), 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_BUY, price_to_ticks(100.00), 10)
+        
+        assert trade_recorder.count() == 0
+        assert order_event_recorder.count() == 0
+        assert lib.mx_order_book_pending_events(book) > 0
+        
+        free_order_book(book)
+    
+    def test_fill_sequence(self, buffered_book):
+        """A match produces the trade followed by both fill events"""
+        book = buffered_book
+        
+        lib.mx_order_book_add_limit(book, 1, SIDE_SELL, price_to_ticks(100.00), 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_BUY, price_to_ticks(100.00), 4)
+        
+        assert drain(book) == [
+            ('order', 1, EVENT_ACCEPTED, 0, 10),
+            ('trade', 2, 1, price_to_ticks(100.00), 4),
+            ('order', 1, EVENT_PARTIAL, 4, 6),
+            ('order', 2, EVENT_FILLED, 4, 0),
+        ]
+        assert lib.mx_order_book_pending_events(book) == 0
+        assert drain(book) == []
+    
+    def test_ring_grows_past_capacity(self, buffered_book):
+        """More events than the initial ring holds are all kept, in order"""
+        book = buffered_book
+        
+        for i in range(1, 201):
+            lib.mx_order_book_add_limit(book, i, SIDE_BUY, price_to_ticks(90.00) + i, 10)
+        
+        assert lib.mx_order_book_pending_events(book) == 200
+        events = drain(book, chunk=7)
+        assert [e[1] for e in events] == list(range(1, 201))
+    
+    def test_interleaved_polls(self, buffered_book):
+        """Polling part way through keeps order across ring wrap-around"""
+        book = buffered_book
+        seen = []
+        
+        for i in range(1, 101):
+            lib.mx_order_book_add_limit(book, i, SIDE_BUY, price_to_ticks(90.00) + i, 10)
+            if i % 3 == 0:
+                seen.extend(drain(book, chunk=2))
+        seen.extend(drain(book))
+        
+        assert [e[1] for e in seen] == list(range(1, 101))
+
+class TestEventBufferMatchesCallbacks:
+    """Differential test: buffered events equal the callback stream"""
+    
+    def test_random_flow(self):
+        rng = random.Random(99)
+        
+        cb_ctx = create_context()
+        recorded = []
+        trade_cb = create_trade_callback(
+            lambda a, p, px, q, ts: recorded.append(('trade', a, p, px, q)))
+        order_cb = create_order_callback(
+            lambda oid, ev, f, r: recorded.append(('order', oid, ev, f, r)))
+        lib.mx_context_set_callbacks(cb_ctx, trade_cb, order_cb, ffi.NULL)
+        cb_book = create_order_book(cb_ctx, "CB")
+        
+        buf_ctx = create_context()
+        lib.mx_context_set_event_buffer(buf_ctx, 32)
+        buf_book = create_order_book(buf_ctx, "BUF")
+        
+        buffered = []
+        live = []
+        for order_id in range(1, 2001):
+            action = rng.random()
+            if action < 0.6 or not live:
+                side = rng.choice((SIDE_BUY, SIDE_SELL))
+                price = rng.randint(9950, 10050)
+                qty = rng.randint(1, 50)
+                for book in (cb_book, buf_book):
+                    lib.mx_order_book_add_limit(book, order_id, side, price, qty)
+                live.append(order_id)
+            elif action < 0.85:
+                victim = live.pop(rng.randrange(len(live)))
+                for book in (cb_book, buf_book):
+                    lib.mx_order_book_cancel(book, victim)
+            else:
+                side = rng.choice((SIDE_BUY, SIDE_SELL))
+                qty = rng.randint(1, 120)
+                for book in (cb_book, buf_book):
+                    lib.mx_order_book_add_market(book, order_id, side, qty)
+            
+            if rng.random() < 0.1:
+                buffered.extend(drain(buf_book))
+        
+        buffered.extend(drain(buf_book))
+        assert buffered == recorded
+        assert any(e[0] == 'trade' for e in recorded)
+        
+        free_order_book(cb_book)
+        free_order_book(buf_book)
+        free_context(cb_ctx)
+        free_context(buf_ctx)
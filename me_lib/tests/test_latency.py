@@ -0,0 +1,115 @@
+"""
+Latency tracking tests
+Books created from a context with latency tracking record every add,
+cancel, modify and match into per-operation histograms
+"""
+
+import pytest
+from testhelpers import (
+    ffi, lib,
+    SIDE_BUY, SIDE_SELL,
+    STATUS_OK, STATUS_ERROR, STATUS_INVALID_PARAM,
+    create_order_book, free_order_book,
+    price_to_ticks
+)
+
+LATENCY_ADD = lib.MX_LATENCY_ADD
+LATENCY_CANCEL = lib.MX_LATENCY_CANCEL
+LATENCY_MODIFY = lib.MX_LATENCY_MODIFY
+LATENCY_MATCH = lib.MX_LATENCY_MATCH
+
+def get_latency(book, op):
+    stats = ffi.new("mx_latency_stats_t*")
+    assert lib.mx_order_book_get_latency(book, op, stats) == STATUS_OK
+    return stats
+
+@pytest.fixture
+def timed_book(context):
+    """Order book on a context that tracks latency"""
+    assert lib.mx_context_set_latency_tracking(context, 1) == STATUS_OK
+    book = create_order_book(context, "TIMED")
+    assert book != ffi.NULL
+
+    yield book
+
+    free_order_book(book)
+
+class TestLatencyTracking:
+    """Test per-operation latency recording"""
+
+    def test_disabled_by_default(self, order_book):
+        """Books from a plain context report no latency"""
+        lib.mx_order_book_add_limit(order_book, 1, SIDE_BUY, price_to_ticks(100.00), 10)
+
+        stats = ffi.new("mx_latency_stats_t*")
+        assert lib.mx_order_book_get_latency(order_book, LATENCY_ADD, stats) == STATUS_ERROR
+        assert lib.mx_order_book_get_latency_percentile(order_book, LATENCY_ADD, 50.0) == 0
+
+    def test_invalid_arguments(self, timed_book):
+        """NULL arguments and unknown operations are refused"""
+        stats = ffi.new("mx_latency_stats_t*")
+        assert lib.mx_order_book_get_latency(ffi.NULL, LATENCY_ADD, stats) == STATUS_INVALID_PARAM
+        assert lib.mx_order_book_get_latency(timed_book, LATENCY_ADD, ffi.NULL) == STATUS_INVALID_PARAM
+        assert lib.mx_order_book_get_latency(timed_book, lib.MX_LATENCY_OP_COUNT, stats) == STATUS_INVALID_PARAM
+        assert lib.mx_context_set_latency_tracking(ffi.NULL, 1) == STATUS_INVALID_PARAM
+
+    def test_operations_counted(self, timed_book):
+        """Each operation lands in its own histogram"""
+        book = timed_book
+
+        for i in range(10):
+            lib.mx_order_book_add_limit(book, 1 + i, SIDE_SELL, price_to_ticks(100.00) + i, 100)
+        lib.mx_order_book_modify(book, 1, 50)
+        lib.mx_order_book_cancel(book, 2)
+        lib.mx_order_book_cancel(book, 99)                                  # unknown, still timed
+        lib.mx_order_book_add_limit(book, 20, SIDE_BUY, price_to_ticks(100.00), 20)   # trades
+        lib.mx_order_book_add_market(book, 21, SIDE_BUY, 10)                # trades
+
+        assert get_latency(book, LATENCY_ADD).count == 12
+        assert get_latency(book, LATENCY_MODIFY).count == 1
+        assert get_latency(book, LATENCY_CANCEL).count == 2
+        # Resting adds never swept anything
+        assert get_latency(book, LATENCY_MATCH).count == 2
+
+    def test_percentiles_ordered(self, timed_book):
+        """Reported percentiles are monotonic and within the recorded range"""
+        book = timed_book
+
+        for i in range(2000):
+            lib.mx_order_book_add_limit(book, 1 + i, SIDE_BUY, price_to_ticks(90.00) + i % 50, 10)
+
+        stats = get_latency(book, LATENCY_ADD)
+        assert stats.count == 2000
+        assert 0 < stats.p50_ns
+        assert stats.min_ns <= stats.p50_ns <= stats.p90_ns <= stats.p99_ns <= stats.p999_ns <= stats.max_ns
+        assert stats.min_ns <= stats.mean_ns <= stats.max_ns
+
+        assert lib.mx_order_book_get_latency_percentile(book, LATENCY_ADD, 100.0) == stats.max_ns
+        assert lib.mx_order_book_get_latency_percentile(book, LATENCY_ADD, 0.0) == stats.min_ns
+        assert stats.p99_ns <= lib.mx_order_book_get_latency_percentile(book, LATENCY_ADD, 99.99) <= stats.max_ns
+
+    def test_reset(self, timed_book):
+        """Reset drops every sample"""
+        book = timed_book
+
+        lib.mx_order_book_add_limit(book, 1, SIDE_BUY, price_to_ticks(100.00), 10)
+        lib.mx_order_book_cancel(book, 1)
+        lib.mx_order_book_reset_latency(book)
+
+        for op in (LATENCY_ADD, LATENCY_CANCEL, LATENCY_MODIFY, LATENCY_MATCH):
+            stats = get_latency(book, op)
+            assert stats.count == 0
+            assert stats.max_ns == 0
+
+    def test_existing_books_unaffected(self, context):
+        """Enabling tracking only applies to books created afterwards"""
+        before = create_order_book(context, "BEFORE")
+        assert lib.mx_context_set_latency_tracking(context, 1) == STATUS_OK
+        after = create_order_book(context, "AFTER")
+
+        stats = ffi.new("mx_latency_stats_t*")
+        assert lib.mx_order_book_get_latency(before, LATENCY_ADD, stats) == STATUS_ERROR
+        assert lib.mx_order_book_get_latency(after, LATENCY_ADD, stats) == STATUS_OK
+
+        free_order_book(before)
+        free_order_book(after)
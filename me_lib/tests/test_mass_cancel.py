@@ -0,0 +1,226 @@
+"""
+Owner tag and mass cancel tests
+mx_order_book_mass_cancel must leave the book exactly as cancelling the
+owner's orders one at a time would, touching nobody else's orders
+"""
+
+import pytest
+from testhelpers import (
+    ffi, lib,
+    SIDE_BUY, SIDE_SELL,
+    ORDER_TYPE_STOP,
+    TIF_GTC,
+    STATUS_OK, STATUS_INVALID_PARAM, STATUS_ORDER_NOT_FOUND,
+    EVENT_CANCELLED,
+    create_context, free_context,
+    create_order_book, free_order_book,
+    create_order_callback
+)
+
+FILTER_BUY = lib.MX_SIDE_FILTER_BUY
+FILTER_SELL = lib.MX_SIDE_FILTER_SELL
+FILTER_BOTH = lib.MX_SIDE_FILTER_BOTH
+
+MAKER = 7
+OTHER = 8
+
+def book_state(book):
+    """Stats, touch and per-level volume of the book"""
+    stats = [ffi.new("uint32_t*"), ffi.new("uint32_t*"), ffi.new("uint32_t*"),
+             ffi.new("uint64_t*"), ffi.new("uint64_t*")]
+    lib.mx_order_book_get_stats(book, *stats)
+    volumes = {}
+    for price in range(9980, 10021):
+        for side in (SIDE_BUY, SIDE_SELL):
+            volume = lib.mx_order_book_get_volume_at_price(book, side, price)
+            if volume:
+                volumes[(side, price)] = volume
+    return ([s[0] for s in stats], lib.mx_order_book_get_best_bid(book),
+            lib.mx_order_book_get_best_ask(book), volumes)
+
+def populate(book):
+    """Maker quotes several levels a side, interleaved with another owner
+    and an untagged order; returns the maker's order IDs"""
+    maker_ids = []
+    order_id = 1
+    for level in range(5):
+        for side, price in ((SIDE_BUY, 9995 - level), (SIDE_SELL, 10005 + level)):
+            for owner in (MAKER, OTHER, MAKER, 0):
+                assert lib.mx_order_book_add_limit(book, order_id, side, price, 10) == STATUS_OK
+                if owner:
+                    assert lib.mx_order_book_set_owner(book, order_id, owner) == STATUS_OK
+                if owner == MAKER:
+                    maker_ids.append(order_id)
+                order_id += 1
+
+    # Levels only the maker quotes, on both sides of the touch
+    for side, price in ((SIDE_BUY, 9999), (SIDE_SELL, 10001), (SIDE_BUY, 9980)):
+        lib.mx_order_book_add_limit(book, order_id, side, price, 5)
+        lib.mx_order_book_set_owner(book, order_id, MAKER)
+        maker_ids.append(order_id)
+        order_id += 1
+    return maker_ids
+
+@pytest.fixture
+def event_book():
+    ctx = create_context()
+    events = []
+    order_cb = create_order_callback(
+        lambda order_id, event, filled, remaining: events.append((order_id, event, filled)))
+    lib.mx_context_set_callbacks(ctx, ffi.NULL, order_cb, ffi.NULL)
+    book = create_order_book(ctx, "TEST")
+    yield book, events
+    free_order_book(book)
+    free_context(ctx)
+
+class TestOwnerTag:
+    """Test mx_order_book_set_owner"""
+
+    def test_invalid_params(self, order_book):
+        assert lib.mx_order_book_set_owner(ffi.NULL, 1, MAKER) == STATUS_INVALID_PARAM
+        assert lib.mx_order_book_set_owner(order_book, 1, MAKER) == STATUS_ORDER_NOT_FOUND
+        assert lib.mx_order_book_mass_cancel(ffi.NULL, MAKER, FILTER_BOTH) == 0
+        assert lib.mx_order_book_mass_cancel(order_book, MAKER, 3) == 0
+
+    def test_untagged_orders_never_mass_cancelled(self, order_book):
+        lib.mx_order_book_add_limit(order_book, 1, SIDE_BUY, 9990, 10)
+        assert lib.mx_order_book_mass_cancel(order_book, 0, FILTER_BOTH) == 0
+        assert lib.mx_order_book_has_order(order_book, 1) == 1
+
+    def test_retag_and_untag(self, order_book):
+        for order_id in (1, 2, 3):
+            lib.mx_order_book_add_limit(order_book, order_id, SIDE_BUY, 9990, 10)
+            lib.mx_order_book_set_owner(order_book, order_id, MAKER)
+
+        assert lib.mx_order_book_set_owner(order_book, 2, OTHER) == STATUS_OK
+        assert lib.mx_order_book_set_owner(order_book, 3, 0) == STATUS_OK
+
+        assert lib.mx_order_book_mass_cancel(order_book, MAKER, FILTER_BOTH) == 1
+        assert lib.mx_order_book_has_order(order_book, 1) == 0
+        assert lib.mx_order_book_has_order(order_book, 2) == 1
+        assert lib.mx_order_book_has_order(order_book, 3) == 1
+
+    def test_filled_orders_leave_owner_chain(self, order_book):
+        """Orders that trade away must drop off their owner's chain"""
+        lib.mx_order_book_add_limit(order_book, 1, SIDE_SELL, 10000, 10)
+        lib.mx_order_book_add_limit(order_book, 2, SIDE_SELL, 10000, 10)
+        lib.mx_order_book_set_owner(order_book, 1, MAKER)
+        lib.mx_order_book_set_owner(order_book, 2, MAKER)
+
+        lib.mx_order_book_add_limit(order_book, 3, SIDE_BUY, 10000, 15)
+
+        assert lib.mx_order_book_mass_cancel(order_book, MAKER, FILTER_BOTH) == 1
+        assert lib.mx_order_book_get_best_ask(order_book) == 0
+
+class TestMassCancel:
+    """Test mx_order_book_mass_cancel"""
+
+    def check_matches_individual_cancels(self, ladder):
+        books = []
+        contexts = []
+        for _ in range(2):
+            ctx = create_context()
+            if ladder:
+                lib.mx_context_set_price_bounds(ctx, 9000, 11000, 1)
+            contexts.append(ctx)
+            books.append(create_order_book(ctx, "TEST"))
+
+        bulk, single = books
+        maker_ids = populate(bulk)
+        populate(single)
+
+        assert lib.mx_order_book_mass_cancel(bulk, MAKER, FILTER_BOTH) == len(maker_ids)
+        for order_id in maker_ids:
+            assert lib.mx_order_book_cancel(single, order_id) == STATUS_OK
+
+        assert book_state(bulk) == book_state(single)
+        assert lib.mx_order_book_get_best_bid(bulk) == 9995
+        assert lib.mx_order_book_get_best_ask(bulk) == 10005
+
+        for book in books:
+            free_order_book(book)
+        for ctx in contexts:
+            free_context(ctx)
+
+    def test_matches_individual_cancels(self):
+        """Same final book as cancelling each of the maker's orders"""
+        self.check_matches_individual_cancels(ladder=False)
+
+    def test_matches_individual_cancels_on_ladder(self):
+        self.check_matches_individual_cancels(ladder=True)
+
+    def test_side_filter(self, order_book):
+        maker_ids = populate(order_book)
+
+        cancelled = lib.mx_order_book_mass_cancel(order_book, MAKER, FILTER_SELL)
+        assert cancelled == 11
+        assert lib.mx_order_book_get_best_ask(order_book) == 10005
+        assert lib.mx_order_book_get_best_bid(order_book) == 9999
+
+        assert lib.mx_order_book_mass_cancel(order_book, MAKER, FILTER_SELL) == 0
+        assert lib.mx_order_book_mass_cancel(order_book, MAKER, FILTER_BUY) == len(maker_ids) - 11
+        assert lib.mx_order_book_get_best_bid(order_book) == 9995
+        assert lib.mx_order_book_mass_cancel(order_book, OTHER, FILTER_BOTH) == 10
+
+    def test_cancels_pending_stops(self, order_book):
+        lib.mx_order_book_add_order(order_book, 1, ORDER_TYPE_STOP, SIDE_BUY,
+                                    0, 10050, 5, 0, TIF_GTC, 0, 0)
+        lib.mx_order_book_set_owner(order_book, 1, MAKER)
+        lib.mx_order_book_add_limit(order_book, 2, SIDE_SELL, 10040, 5)
+        lib.mx_order_book_set_owner(order_book, 2, MAKER)
+
+        assert lib.mx_order_book_mass_cancel(order_book, MAKER, FILTER_BUY) == 1
+        assert lib.mx_order_book_has_order(order_book, 1) == 0
+        assert lib.mx_order_book_has_order(order_book, 2) == 1
+
+        # The stop is gone, so an offer through its trigger stays untouched
+        lib.mx_order_book_add_limit(order_book, 3, SIDE_SELL, 10055, 5)
+        assert lib.mx_order_book_get_volume_at_price(order_book, SIDE_SELL, 10055) == 5
+
+    def test_events_after_final_state(self, event_book):
+        """One cancelled event per order, newest first, book already final"""
+        book, events = event_book
+        for order_id in (1, 2, 3):
+            lib.mx_order_book_add_limit(book, order_id, SIDE_BUY, 9990 + order_id, 10)
+            lib.mx_order_book_set_owner(book, order_id, MAKER)
+
+        # Partially fill the best bid so its filled quantity is reported
+        lib.mx_order_book_add_limit(book, 4, SIDE_SELL, 9993, 4)
+        del events[:]
+
+        assert lib.mx_order_book_mass_cancel(book, MAKER, FILTER_BOTH) == 3
+        assert events == [(3, EVENT_CANCELLED, 4), (2, EVENT_CANCELLED, 0),
+                          (1, EVENT_CANCELLED, 0)]
+        assert lib.mx_order_book_get_best_bid(book) == 0
+
+    def test_many_orders(self, order_book):
+        """A market maker with thousands of quotes is pulled in one call"""
+        for i in range(5000):
+            side = SIDE_BUY if i % 2 else SIDE_SELL
+            price = 9900 - i % 50 if side == SIDE_BUY else 10100 + i % 50
+            lib.mx_order_book_add_limit(order_book, i + 1, side, price, 1)
+            lib.mx_order_book_set_owner(order_book, i + 1, MAKER)
+
+        assert lib.mx_order_book_mass_cancel(order_book, MAKER, FILTER_BOTH) == 5000
+        total = ffi.new("uint32_t*")
+        bid_levels = ffi.new("uint32_t*")
+        ask_levels = ffi.new("uint32_t*")
+        lib.mx_order_book_get_stats(order_book, total, bid_levels, ask_levels, ffi.NULL, ffi.NULL)
+        assert (total[0], bid_levels[0], ask_levels[0]) == (0, 0, 0)
+
+class TestOwnerSnapshot:
+    """Owners survive a snapshot round trip"""
+
+    def test_owner_restored(self, order_book, tmp_path):
+        path = str(tmp_path / "owners.snap").encode()
+        populate(order_book)
+        assert lib.mx_order_book_save_snapshot(order_book, path) == STATUS_OK
+
+        ctx = create_context()
+        restored = create_order_book(ctx, "TEST")
+        assert lib.mx_order_book_load_snapshot(restored, path) == STATUS_OK
+        assert lib.mx_order_book_mass_cancel(restored, OTHER, FILTER_BOTH) == 10
+        assert lib.mx_order_book_mass_cancel(restored, MAKER, FILTER_BOTH) == 23
+
+        free_order_book(restored)
+        free_context(ctx)
@@ -420,6 +420,35 @@ class TestOrderEvents:
         assert len(partial_events) > 0
         assert partial_events[0]['filled_qty'] == 50
         assert partial_events[0]['remaining_qty'] == 50
+    
+    def test_sweep_retires_each_passive_once(self, book_with_callbacks):
+        """A deep sweep reports one FILLED per consumed order and frees it"""
+        book, trades, events = book_with_callbacks
+        
+        # 20 levels x 3 orders
+        order_id = 1
+        for level in range(20):
+            for _ in range(3):
+                lib.mx_order_book_add_limit(book, order_id, SIDE_SELL,
+                                            price_to_ticks(100.00) + level, 10)
+                order_id += 1
+        events.clear()
+        
+        # Consume 59.5 orders' worth
+        lib.mx_order_book_add_market(book, 1000, SIDE_BUY, 595)
+        
+        assert trades.count() == 60
+        assert trades.total_volume() == 595
+        for passive_id in range(1, 60):
+            filled = [e for e in events.get_for_order(passive_id) if e['event'] == EVENT_FILLED]
+            assert len(filled) == 1
+            assert lib.mx_order_book_has_order(book, passive_id) == 0
+        
+        # Last passive order is partially filled and still resting
+        assert lib.mx_order_book_has_order(book, 60) == 1
+        assert events.get_for_order(60)[-1]['event'] == EVENT_PARTIAL
+        assert events.get_for_order(60)[-1]['remaining_qty'] == 5
+        assert lib.mx_order_book_get_best_ask(book) == price_to_ticks(100.00) + 19
 
 class TestEdgeCases:
     """Test edge cases in matching"""
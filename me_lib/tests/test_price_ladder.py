@@ -0,0 +1,288 @@
+"""
+Price ladder tests
+Books created from a context with price bounds use the tick-indexed
+ladder backend - these tests check it behaves exactly like the map backend
+"""
+
+import random
+import pytest
+from testhelpers import (
+    ffi, lib,
+    SIDE_BUY, SIDE_SELL,
+    ORDER_TYPE_LIMIT, TIF_FOK, TIF_IOC, FLAG_NONE, FLAG_AON,
+    STATUS_OK, STATUS_INVALID_PARAM, STATUS_INVALID_PRICE, STATUS_CANNOT_FILL,
+    create_context, free_context,
+    create_order_book, free_order_book,
+    create_trade_callback,
+    price_to_ticks
+)
+
+MIN_PRICE = price_to_ticks(50.00)
+MAX_PRICE = price_to_ticks(150.00)
+
+@pytest.fixture
+def ladder_book(context, trade_recorder):
+    """Order book on a context bounded to [$50, $150] at 1 tick"""
+    trade_cb = create_trade_callback(trade_recorder.record)
+    lib.mx_context_set_callbacks(context, trade_cb, ffi.NULL, ffi.NULL)
+
+    assert lib.mx_context_set_price_bounds(context, MIN_PRICE, MAX_PRICE, 1) == STATUS_OK
+    book = create_order_book(context, "LADDER")
+    assert book != ffi.NULL
+
+    yield (book, trade_recorder)
+
+    free_order_book(book)
+
+class TestPriceBounds:
+    """Test configuring the price band"""
+
+    def test_invalid_bounds_rejected(self, context):
+        """Empty bands, zero ticks and oversized bands are refused"""
+        assert lib.mx_context_set_price_bounds(context, 200, 100, 1) == STATUS_INVALID_PARAM
+        assert lib.mx_context_set_price_bounds(context, 100, 200, 0) == STATUS_INVALID_PARAM
+        assert lib.mx_context_set_price_bounds(context, 1, 0xFFFFFFFF, 1) == STATUS_INVALID_PARAM
+        assert lib.mx_context_set_price_bounds(ffi.NULL, 100, 200, 1) == STATUS_INVALID_PARAM
+
+    def test_reset_bounds(self, context):
+        """0/0 removes the band so any price is accepted again"""
+        assert lib.mx_context_set_price_bounds(context, 100, 200, 1) == STATUS_OK
+        assert lib.mx_context_set_price_bounds(context, 0, 0, 0) == STATUS_OK
+
+        book = create_order_book(context, "UNBOUNDED")
+        assert lib.mx_order_book_add_limit(book, 1, SIDE_BUY, 5000000, 10) == STATUS_OK
+        free_order_book(book)
+
+    def test_out_of_band_prices_rejected(self, ladder_book):
+        """Limit prices outside the band are invalid"""
+        book, trades = ladder_book
+
+        assert lib.mx_order_book_add_limit(book, 1, SIDE_BUY, MIN_PRICE - 1, 10) == STATUS_INVALID_PRICE
+        assert lib.mx_order_book_add_limit(book, 2, SIDE_SELL, MAX_PRICE + 1, 10) == STATUS_INVALID_PRICE
+        assert lib.mx_order_book_add_limit(book, 3, SIDE_BUY, MIN_PRICE, 10) == STATUS_OK
+        assert lib.mx_order_book_add_limit(book, 4, SIDE_SELL, MAX_PRICE, 10) == STATUS_OK
+
+        # Market orders have no price and are unaffected
+        assert lib.mx_order_book_add_market(book, 5, SIDE_BUY, 10) == STATUS_OK
+        assert len(trades.trades) == 1
+
+    def test_off_tick_prices_rejected(self, context):
+        """Prices must sit on the tick grid"""
+        assert lib.mx_context_set_price_bounds(context, 1000, 2000, 5) == STATUS_OK
+        book = create_order_book(context, "TICK5")
+
+        assert lib.mx_order_book_add_limit(book, 1, SIDE_BUY, 1003, 10) == STATUS_INVALID_PRICE
+        assert lib.mx_order_book_add_limit(book, 2, SIDE_BUY, 1005, 10) == STATUS_OK
+        assert lib.mx_order_book_add_limit(book, 3, SIDE_SELL, 2000, 10) == STATUS_OK
+        assert lib.mx_order_book_get_best_bid(book) == 1005
+        assert lib.mx_order_book_get_best_ask(book) == 2000
+
+        free_order_book(book)
+
+class TestLadderBook:
+    """Test book behaviour on the ladder backend"""
+
+    def test_best_prices_across_gaps(self, ladder_book):
+        """Best bid/ask rescan past empty ticks when the touch is removed"""
+        book, trades = ladder_book
+
+        # Spread bids across several bitmap words
+        lib.mx_order_book_add_limit(book, 1, SIDE_BUY, MIN_PRICE, 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_BUY, MIN_PRICE + 700, 10)
+        lib.mx_order_book_add_limit(book, 3, SIDE_BUY, MIN_PRICE + 4500, 10)
+        assert lib.mx_order_book_get_best_bid(book) == MIN_PRICE + 4500
+
+        lib.mx_order_book_cancel(book, 3)
+        assert lib.mx_order_book_get_best_bid(book) == MIN_PRICE + 700
+        lib.mx_order_book_cancel(book, 2)
+        assert lib.mx_order_book_get_best_bid(book) == MIN_PRICE
+        lib.mx_order_book_cancel(book, 1)
+        assert lib.mx_order_book_get_best_bid(book) == 0
+
+        lib.mx_order_book_add_limit(book, 4, SIDE_SELL, MAX_PRICE, 10)
+        lib.mx_order_book_add_limit(book, 5, SIDE_SELL, MAX_PRICE - 4500, 10)
+        assert lib.mx_order_book_get_best_ask(book) == MAX_PRICE - 4500
+        lib.mx_order_book_cancel(book, 5)
+        assert lib.mx_order_book_get_best_ask(book) == MAX_PRICE
+
+    def test_sweep_multiple_levels(self, ladder_book):
+        """An aggressive order walks levels best first"""
+        book, trades = ladder_book
+
+        lib.mx_order_book_add_limit(book, 1, SIDE_SELL, price_to_ticks(101.00), 100)
+        lib.mx_order_book_add_limit(book, 2, SIDE_SELL, price_to_ticks(100.00), 100)
+        lib.mx_order_book_add_limit(book, 3, SIDE_SELL, price_to_ticks(102.00), 100)
+
+        lib.mx_order_book_add_limit(book, 4, SIDE_BUY, price_to_ticks(101.50), 250)
+
+        assert [t['passive_id'] for t in trades.trades] == [2, 1]
+        assert [t['price'] for t in trades.trades] == [price_to_ticks(100.00), price_to_ticks(101.00)]
+        assert lib.mx_order_book_get_best_bid(book) == price_to_ticks(101.50)
+        assert lib.mx_order_book_get_best_ask(book) == price_to_ticks(102.00)
+
+    def test_depth_and_stats(self, ladder_book):
+        """Depth and stats aggregate levels in price order"""
+        book, trades = ladder_book
+
+        for i in range(5):
+            lib.mx_order_book_add_limit(book, 10 + i, SIDE_BUY, price_to_ticks(99.00) - i * 10, 100 * (i + 1))
+
+        assert lib.mx_order_book_get_depth(book, SIDE_BUY, 2) == 300
+        assert lib.mx_order_book_get_depth(book, SIDE_BUY, 10) == 1500
+        assert lib.mx_order_book_get_volume_at_price(book, SIDE_BUY, price_to_ticks(99.00) - 20) == 300
+
+        total_orders = ffi.new("uint32_t*")
+        bid_levels = ffi.new("uint32_t*")
+        bid_volume = ffi.new("uint64_t*")
+        lib.mx_order_book_get_stats(book, total_orders, bid_levels, ffi.NULL, bid_volume, ffi.NULL)
+        assert total_orders[0] == 5
+        assert bid_levels[0] == 5
+        assert bid_volume[0] == 1500
+
+    def test_clear_and_reuse(self, ladder_book):
+        """Clearing the book empties every ladder slot"""
+        book, trades = ladder_book
+
+        lib.mx_order_book_add_limit(book, 1, SIDE_BUY, price_to_ticks(99.00), 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_SELL, price_to_ticks(101.00), 10)
+        lib.mx_order_book_clear(book)
+
+        assert lib.mx_order_book_get_best_bid(book) == 0
+        assert lib.mx_order_book_get_best_ask(book) == 0
+        assert lib.mx_order_book_get_depth(book, SIDE_BUY, 10) == 0
+
+        assert lib.mx_order_book_add_limit(book, 1, SIDE_BUY, price_to_ticks(98.00), 10) == STATUS_OK
+        assert lib.mx_order_book_get_best_bid(book) == price_to_ticks(98.00)
+
+class TestLadderMatchesMap:
+    """Differential test: ladder and map backends must agree"""
+
+    def test_random_flow(self):
+        rng = random.Random(1234)
+
+        books = []
+        recorders = []
+        contexts = []
+        callbacks = []
+        for bounded in (False, True):
+            ctx = create_context()
+            trades = []
+            cb = create_trade_callback(
+                lambda a, p, px, q, ts, trades=trades: trades.append((a, p, px, q)))
+            lib.mx_context_set_callbacks(ctx, cb, ffi.NULL, ffi.NULL)
+            if bounded:
+                assert lib.mx_context_set_price_bounds(ctx, 9000, 11000, 1) == STATUS_OK
+            contexts.append(ctx)
+            callbacks.append(cb)
+            recorders.append(trades)
+            books.append(create_order_book(ctx, "DIFF"))
+
+        live = []
+        for order_id in range(1, 3001):
+            action = rng.random()
+            if action < 0.6 or not live:
+                side = rng.choice((SIDE_BUY, SIDE_SELL))
+                price = rng.randint(9900, 10100)
+                qty = rng.randint(1, 50)
+                for book in books:
+                    lib.mx_order_book_add_limit(book, order_id, side, price, qty)
+                live.append(order_id)
+            elif action < 0.9:
+                victim = live.pop(rng.randrange(len(live)))
+                for book in books:
+                    lib.mx_order_book_cancel(book, victim)
+            else:
+                side = rng.choice((SIDE_BUY, SIDE_SELL))
+                qty = rng.randint(1, 100)
+                for book in books:
+                    lib.mx_order_book_add_market(book, order_id, side, qty)
+
+            assert lib.mx_order_book_get_best_bid(books[0]) == lib.mx_order_book_get_best_bid(books[1])
+            assert lib.mx_order_book_get_best_ask(books[0]) == lib.mx_order_book_get_best_ask(books[1])
+
+        assert recorders[0] == recorders[1]
+        assert len(recorders[0]) > 0
+        for side in (SIDE_BUY, SIDE_SELL):
+            assert lib.mx_order_book_get_depth(books[0], side, 50) == \
+                   lib.mx_order_book_get_depth(books[1], side, 50)
+
+        for book, ctx in zip(books, contexts):
+            free_order_book(book)
+            free_context(ctx)
+
+class TestLadderVolumeScans:
+    """FOK/AON checks, deep depth and totals come from the ladder's volume vector"""
+
+    def _books(self):
+        contexts, books = [], []
+        for bounded in (False, True):
+            ctx = create_context()
+            if bounded:
+                assert lib.mx_context_set_price_bounds(ctx, 9000, 11000, 1) == STATUS_OK
+            contexts.append(ctx)
+            books.append(create_order_book(ctx, "SCAN"))
+        return contexts, books
+
+    def test_fok_across_wide_book(self, ladder_book):
+        """FOK sums every reachable tick, including long runs of empty ones"""
+        book, trades = ladder_book
+
+        base = price_to_ticks(100.00)
+        for i in range(200):
+            assert lib.mx_order_book_add_limit(book, i + 1, SIDE_SELL, base + i * 7, 10) == STATUS_OK
+
+        # 100 levels reachable at base + 693: 1000 lots
+        limit = base + 99 * 7
+        assert lib.mx_order_book_add_order(book, 1000, ORDER_TYPE_LIMIT, SIDE_BUY, limit, 0,
+                                           1001, 0, TIF_FOK, FLAG_NONE, 0) == STATUS_CANNOT_FILL
+        assert lib.mx_order_book_get_depth(book, SIDE_SELL, 200) == 2000
+
+        assert lib.mx_order_book_add_order(book, 1001, ORDER_TYPE_LIMIT, SIDE_BUY, limit, 0,
+                                           1000, 0, TIF_FOK, FLAG_NONE, 0) == STATUS_OK
+        assert lib.mx_order_book_get_depth(book, SIDE_SELL, 200) == 1000
+        assert lib.mx_order_book_get_best_ask(book) == base + 100 * 7
+
+    def test_random_fok_aon_and_depth(self):
+        """Ladder and map agree on FOK/AON outcomes, deep depth and totals"""
+        rng = random.Random(4321)
+        contexts, books = self._books()
+
+        live = []
+        for order_id in range(1, 4001):
+            action = rng.random()
+            side = rng.choice((SIDE_BUY, SIDE_SELL))
+            price = rng.randint(9500, 10500)
+            if action < 0.55 or not live:
+                qty = rng.randint(1, 50)
+                results = [lib.mx_order_book_add_limit(b, order_id, side, price, qty) for b in books]
+                live.append(order_id)
+            elif action < 0.75:
+                victim = live.pop(rng.randrange(len(live)))
+                results = [lib.mx_order_book_cancel(b, victim) for b in books]
+            elif action < 0.85:
+                victim = rng.choice(live)
+                qty = rng.randint(1, 25)
+                results = [lib.mx_order_book_modify(b, victim, qty) for b in books]
+            else:
+                qty = rng.randint(1, 3000)
+                tif, flags = rng.choice(((TIF_FOK, FLAG_NONE), (TIF_IOC, FLAG_AON)))
+                results = [lib.mx_order_book_add_order(b, order_id, ORDER_TYPE_LIMIT, side, price,
+                                                       0, qty, 0, tif, flags, 0) for b in books]
+            assert results[0] == results[1]
+
+            if order_id % 50 == 0:
+                totals = []
+                for book in books:
+                    bid = ffi.new("uint64_t*")
+                    ask = ffi.new("uint64_t*")
+                    lib.mx_order_book_get_stats(book, ffi.NULL, ffi.NULL, ffi.NULL, bid, ask)
+                    totals.append((bid[0], ask[0]))
+                assert totals[0] == totals[1]
+                for side in (SIDE_BUY, SIDE_SELL):
+                    for levels in (1, 17, 100, 1000):
+                        assert lib.mx_order_book_get_depth(books[0], side, levels) == \
+                               lib.mx_order_book_get_depth(books[1], side, levels)
+
+        for book, ctx in zip(books, contexts):
+            free_order_book(book)
+            free_context(ctx)
@@ -0,0 +1,207 @@
+"""
+Cancel/replace (amend) tests
+mx_order_book_replace must amend the resting order in place: one replaced
+event, the same pool slot and owner, and time priority kept only for a
+same-price reduction
+"""
+
+import pytest
+from testhelpers import (
+    ffi, lib,
+    SIDE_BUY, SIDE_SELL,
+    ORDER_TYPE_LIMIT, ORDER_TYPE_STOP,
+    TIF_GTC, FLAG_POST_ONLY,
+    STATUS_OK, STATUS_INVALID_PARAM, STATUS_ORDER_NOT_FOUND,
+    STATUS_INVALID_PRICE, STATUS_INVALID_QUANTITY,
+    STATUS_DUPLICATE_ORDER, STATUS_WOULD_MATCH,
+    EVENT_FILLED, EVENT_PARTIAL, EVENT_REPLACED,
+    price_to_ticks
+)
+
+PRICE = price_to_ticks(100.00)
+TICK = 1
+
+def event_kinds(events):
+    return [(e['order_id'], e['event']) for e in events.get_all()]
+
+def order_count(book):
+    total = ffi.new("uint32_t*")
+    lib.mx_order_book_get_stats(book, total, ffi.NULL, ffi.NULL, ffi.NULL, ffi.NULL)
+    return total[0]
+
+class TestReplaceValidation:
+    """Test mx_order_book_replace argument checks"""
+
+    def test_invalid_params(self, order_book):
+        assert lib.mx_order_book_replace(ffi.NULL, 1, 1, PRICE, 10) == STATUS_INVALID_PARAM
+        assert lib.mx_order_book_replace(order_book, 1, 1, PRICE, 10) == STATUS_ORDER_NOT_FOUND
+
+        lib.mx_order_book_add_limit(order_book, 1, SIDE_BUY, PRICE, 10)
+        assert lib.mx_order_book_replace(order_book, 1, 1, 0, 10) == STATUS_INVALID_PRICE
+        assert lib.mx_order_book_replace(order_book, 1, 1, PRICE, 0) == STATUS_INVALID_QUANTITY
+
+        lib.mx_order_book_add_limit(order_book, 2, SIDE_BUY, PRICE, 10)
+        assert lib.mx_order_book_replace(order_book, 1, 2, PRICE, 5) == STATUS_DUPLICATE_ORDER
+        assert lib.mx_order_book_get_volume_at_price(order_book, SIDE_BUY, PRICE) == 20
+
+    def test_pending_stop_not_replaced(self, order_book):
+        lib.mx_order_book_add_order(order_book, 1, ORDER_TYPE_STOP, SIDE_BUY,
+                                    0, PRICE + 50, 5, 0, TIF_GTC, 0, 0)
+        assert lib.mx_order_book_replace(order_book, 1, 1, PRICE, 5) == STATUS_INVALID_PARAM
+        assert lib.mx_order_book_has_order(order_book, 1) == 1
+
+    def test_cannot_replace_below_filled(self, order_book):
+        lib.mx_order_book_add_limit(order_book, 1, SIDE_SELL, PRICE, 10)
+        lib.mx_order_book_add_limit(order_book, 2, SIDE_BUY, PRICE, 4)
+
+        assert lib.mx_order_book_replace(order_book, 1, 1, PRICE, 4) == STATUS_INVALID_QUANTITY
+        assert lib.mx_order_book_replace(order_book, 1, 1, PRICE, 7) == STATUS_OK
+        assert lib.mx_order_book_get_volume_at_price(order_book, SIDE_SELL, PRICE) == 3
+
+    def test_post_only_not_repriced_through(self, order_book):
+        lib.mx_order_book_add_limit(order_book, 1, SIDE_SELL, PRICE + 2 * TICK, 10)
+        lib.mx_order_book_add_order(order_book, 2, ORDER_TYPE_LIMIT, SIDE_BUY,
+                                    PRICE, 0, 10, 0, TIF_GTC, FLAG_POST_ONLY, 0)
+
+        assert lib.mx_order_book_replace(order_book, 2, 2, PRICE + 2 * TICK, 10) == STATUS_WOULD_MATCH
+        assert lib.mx_order_book_get_best_bid(order_book) == PRICE
+        assert lib.mx_order_book_replace(order_book, 2, 2, PRICE + TICK, 10) == STATUS_OK
+        assert lib.mx_order_book_get_best_bid(order_book) == PRICE + TICK
+
+class TestReplacePriority:
+    """Time priority across amends"""
+
+    def test_same_price_reduction_keeps_priority(self, book_with_callbacks):
+        book, trades, events = book_with_callbacks
+        lib.mx_order_book_add_limit(book, 1, SIDE_BUY, PRICE, 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_BUY, PRICE, 10)
+
+        assert lib.mx_order_book_replace(book, 1, 1, PRICE, 6) == STATUS_OK
+        lib.mx_order_book_add_limit(book, 3, SIDE_SELL, PRICE, 6)
+
+        assert [t['passive_id'] for t in trades.get_all()] == [1]
+        assert lib.mx_order_book_has_order(book, 1) == 0
+        assert lib.mx_order_book_get_volume_at_price(book, SIDE_BUY, PRICE) == 10
+
+    def test_quantity_increase_loses_priority(self, book_with_callbacks):
+        book, trades, events = book_with_callbacks
+        lib.mx_order_book_add_limit(book, 1, SIDE_BUY, PRICE, 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_BUY, PRICE, 10)
+
+        assert lib.mx_order_book_replace(book, 1, 1, PRICE, 15) == STATUS_OK
+        lib.mx_order_book_add_limit(book, 3, SIDE_SELL, PRICE, 10)
+
+        assert [t['passive_id'] for t in trades.get_all()] == [2]
+        assert lib.mx_order_book_get_volume_at_price(book, SIDE_BUY, PRICE) == 15
+
+    def test_price_change_moves_level(self, order_book):
+        lib.mx_order_book_add_limit(order_book, 1, SIDE_BUY, PRICE, 10)
+        lib.mx_order_book_add_limit(order_book, 2, SIDE_BUY, PRICE - TICK, 10)
+
+        assert lib.mx_order_book_replace(order_book, 1, 1, PRICE - TICK, 10) == STATUS_OK
+        assert lib.mx_order_book_get_best_bid(order_book) == PRICE - TICK
+        assert lib.mx_order_book_get_volume_at_price(order_book, SIDE_BUY, PRICE) == 0
+        assert lib.mx_order_book_get_volume_at_price(order_book, SIDE_BUY, PRICE - TICK) == 20
+
+        lib.mx_order_book_add_limit(order_book, 3, SIDE_SELL, PRICE - TICK, 10)
+        assert lib.mx_order_book_has_order(order_book, 2) == 0
+        assert lib.mx_order_book_has_order(order_book, 1) == 1
+
+class TestReplaceInPlace:
+    """One event, same slot, owner and fill history"""
+
+    def test_single_replaced_event(self, book_with_callbacks):
+        book, trades, events = book_with_callbacks
+        lib.mx_order_book_add_limit(book, 1, SIDE_SELL, PRICE, 10)
+        events.clear()
+
+        assert lib.mx_order_book_replace(book, 1, 1, PRICE + TICK, 12) == STATUS_OK
+        assert event_kinds(events) == [(1, EVENT_REPLACED)]
+        assert events.get_last()['remaining_qty'] == 12
+
+    def test_new_order_id_keeps_slot_and_owner(self, order_book):
+        lib.mx_order_book_add_limit(order_book, 1, SIDE_SELL, PRICE, 10)
+        lib.mx_order_book_set_owner(order_book, 1, 42)
+
+        assert lib.mx_order_book_replace(order_book, 1, 5, PRICE + TICK, 10) == STATUS_OK
+        assert lib.mx_order_book_has_order(order_book, 1) == 0
+        assert lib.mx_order_book_has_order(order_book, 5) == 1
+        assert order_count(order_book) == 1
+
+        assert lib.mx_order_book_mass_cancel(order_book, 42, lib.MX_SIDE_FILTER_BOTH) == 1
+        assert order_count(order_book) == 0
+
+    def test_partially_filled_order_keeps_fills(self, book_with_callbacks):
+        book, trades, events = book_with_callbacks
+        lib.mx_order_book_add_limit(book, 1, SIDE_SELL, PRICE, 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_BUY, PRICE, 4)
+        events.clear()
+
+        assert lib.mx_order_book_replace(book, 1, 1, PRICE + TICK, 10) == STATUS_OK
+        last = events.get_last()
+        assert (last['event'], last['filled_qty'], last['remaining_qty']) == (EVENT_REPLACED, 4, 6)
+        assert lib.mx_order_book_get_volume_at_price(book, SIDE_SELL, PRICE + TICK) == 6
+
+    def test_repeated_requotes(self, order_book):
+        """A market maker walking one quote back and forth never grows the book"""
+        lib.mx_order_book_add_limit(order_book, 1, SIDE_BUY, PRICE, 10)
+        for i in range(1000):
+            price = PRICE - (i % 5) * TICK
+            assert lib.mx_order_book_replace(order_book, 1, 1, price, 10 + i % 3) == STATUS_OK
+
+        assert order_count(order_book) == 1
+        assert lib.mx_order_book_get_best_bid(order_book) == PRICE - (999 % 5) * TICK
+        levels = ffi.new("uint32_t*")
+        lib.mx_order_book_get_stats(order_book, ffi.NULL, levels, ffi.NULL, ffi.NULL, ffi.NULL)
+        assert levels[0] == 1
+
+class TestReplaceCrossing:
+    """A replace priced through the book trades as the aggressor"""
+
+    def test_partial_cross_rests_remainder(self, book_with_callbacks):
+        book, trades, events = book_with_callbacks
+        lib.mx_order_book_add_limit(book, 1, SIDE_SELL, PRICE + TICK, 4)
+        lib.mx_order_book_add_limit(book, 2, SIDE_BUY, PRICE, 10)
+        events.clear()
+
+        assert lib.mx_order_book_replace(book, 2, 2, PRICE + TICK, 10) == STATUS_OK
+        assert [(t['aggressive_id'], t['passive_id'], t['quantity']) for t in trades.get_all()] == [(2, 1, 4)]
+        assert event_kinds(events) == [(2, EVENT_REPLACED), (1, EVENT_FILLED), (2, EVENT_PARTIAL)]
+        assert lib.mx_order_book_get_best_bid(book) == PRICE + TICK
+        assert lib.mx_order_book_get_best_ask(book) == 0
+        assert lib.mx_order_book_get_volume_at_price(book, SIDE_BUY, PRICE + TICK) == 6
+
+    def test_full_cross_fills(self, book_with_callbacks):
+        book, trades, events = book_with_callbacks
+        lib.mx_order_book_add_limit(book, 1, SIDE_SELL, PRICE + TICK, 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_BUY, PRICE, 5)
+        events.clear()
+
+        assert lib.mx_order_book_replace(book, 2, 2, PRICE + TICK, 5) == STATUS_OK
+        assert event_kinds(events) == [(2, EVENT_REPLACED), (1, EVENT_PARTIAL), (2, EVENT_FILLED)]
+        assert lib.mx_order_book_has_order(book, 2) == 0
+        assert lib.mx_order_book_get_best_bid(book) == 0
+        assert lib.mx_order_book_get_volume_at_price(book, SIDE_SELL, PRICE + TICK) == 5
+
+class TestReplaceBatch:
+    """MX_CMD_REPLACE runs the same amend"""
+
+    def test_batch_replace(self, order_book):
+        lib.mx_order_book_add_limit(order_book, 1, SIDE_BUY, PRICE, 10)
+        lib.mx_order_book_add_limit(order_book, 2, SIDE_SELL, PRICE + 5 * TICK, 10)
+
+        batch = ffi.new("mx_command_t[3]")
+        for cmd, (order_id, price, quantity) in zip(batch, ((1, PRICE + TICK, 8),
+                                                            (2, PRICE + 4 * TICK, 12),
+                                                            (9, PRICE, 1))):
+            cmd.type = lib.MX_CMD_REPLACE
+            cmd.order_id = order_id
+            cmd.price = price
+            cmd.quantity = quantity
+        statuses = ffi.new("int[3]")
+
+        assert lib.mx_order_book_submit_batch(order_book, batch, statuses, 3) == 2
+        assert list(statuses) == [STATUS_OK, STATUS_OK, STATUS_ORDER_NOT_FOUND]
+        assert lib.mx_order_book_get_best_bid(order_book) == PRICE + TICK
+        assert lib.mx_order_book_get_best_ask(order_book) == PRICE + 4 * TICK
+        assert lib.mx_order_book_get_volume_at_price(order_book, SIDE_SELL, PRICE + 4 * TICK) == 12
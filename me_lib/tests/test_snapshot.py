@@ -0,0 +1,252 @@
+"""
+Snapshot tests
+A book saved to disk and loaded into a fresh book must hold the same
+orders in the same time priority, keep its stops and expiries, and
+match exactly like the original - without any events firing on load
+"""
+
+import pytest
+from testhelpers import (
+    ffi, lib,
+    SIDE_BUY, SIDE_SELL,
+    ORDER_TYPE_LIMIT, ORDER_TYPE_MARKET, ORDER_TYPE_STOP,
+    TIF_GTC, TIF_GTD,
+    STATUS_OK, STATUS_ERROR, STATUS_INVALID_PARAM, STATUS_INVALID_PRICE,
+    create_context, free_context,
+    create_order_book, free_order_book,
+    create_trade_callback, create_order_callback
+)
+
+ALL_IDS = list(range(1, 40))
+
+def build_book(book):
+    """Several levels per side, a partial fill, an iceberg, stops and a GTD order"""
+    for i in range(5):
+        lib.mx_order_book_add_limit(book, 1 + i, SIDE_BUY, 9990 - i, 10 + i)
+        lib.mx_order_book_add_limit(book, 11 + i, SIDE_SELL, 10010 + i, 10 + i)
+    
+    # Second and third orders at the best bid queue behind order 1
+    lib.mx_order_book_add_limit(book, 6, SIDE_BUY, 9990, 7)
+    lib.mx_order_book_add_limit(book, 7, SIDE_BUY, 9990, 9)
+    
+    # Partially fill order 1
+    lib.mx_order_book_add_limit(book, 30, SIDE_SELL, 9990, 4)
+    
+    # Iceberg showing 5 of 40
+    lib.mx_order_book_add_order(book, 20, ORDER_TYPE_LIMIT, SIDE_SELL,
+                                10010, 0, 40, 5, TIF_GTC, 0, 0)
+    
+    # GTD bid behind the best bid level
+    lib.mx_order_book_add_order(book, 21, ORDER_TYPE_LIMIT, SIDE_BUY,
+                                9985, 0, 12, 0, TIF_GTD, 0, 5000)
+    
+    # Stops on both sides, away from the market
+    lib.mx_order_book_add_order(book, 22, ORDER_TYPE_STOP, SIDE_BUY,
+                                0, 10012, 6, 0, TIF_GTC, 0, 0)
+    lib.mx_order_book_add_order(book, 23, ORDER_TYPE_STOP, SIDE_SELL,
+                                0, 9987, 8, 0, TIF_GTC, 0, 0)
+
+def book_state(book):
+    """Everything observable about the book's resting contents"""
+    stats = [ffi.new("uint32_t*"), ffi.new("uint32_t*"), ffi.new("uint32_t*"),
+             ffi.new("uint64_t*"), ffi.new("uint64_t*")]
+    lib.mx_order_book_get_stats(book, *stats)
+    
+    orders = {}
+    for order_id in ALL_IDS:
+        side = ffi.new("mx_side_t*")
+        price = ffi.new("uint32_t*")
+        qty = ffi.new("uint32_t*")
+        filled = ffi.new("uint32_t*")
+        if lib.mx_order_book_get_order_info(book, order_id, side, price, qty, filled) == STATUS_OK:
+            orders[order_id] = (side[0], price[0], qty[0], filled[0])
+    
+    return (tuple(s[0] for s in stats), orders,
+            lib.mx_order_book_get_best_bid(book),
+            lib.mx_order_book_get_best_ask(book))
+
+def sweep(book, trades):
+    """Clear both sides with market orders and return the trades"""
+    trades.clear()
+    lib.mx_order_book_add_order(book, 100, ORDER_TYPE_MARKET, SIDE_BUY,
+                                0, 0, 1000, 0, TIF_GTC, 0, 0)
+    lib.mx_order_book_add_order(book, 101, ORDER_TYPE_MARKET, SIDE_SELL,
+                                0, 0, 1000, 0, TIF_GTC, 0, 0)
+    return list(trades)
+
+class RecordingBook:
+    """Context plus book with trade and order callbacks recorded"""
+    
+    def __init__(self, symbol="SNAP", bounds=None):
+        self.trades = []
+        self.events = []
+        self.ctx = create_context()
+        self._trade_cb = create_trade_callback(
+            lambda a, p, px, q, ts: self.trades.append((a, p, px, q)))
+        self._order_cb = create_order_callback(
+            lambda oid, ev, f, r: self.events.append((oid, ev)))
+        lib.mx_context_set_callbacks(self.ctx, self._trade_cb, self._order_cb, ffi.NULL)
+        if bounds:
+            assert lib.mx_context_set_price_bounds(self.ctx, bounds[0], bounds[1], 1) == STATUS_OK
+        self.book = create_order_book(self.ctx, symbol)
+    
+    def close(self):
+        free_order_book(self.book)
+        free_context(self.ctx)
+
+@pytest.fixture
+def snapshot_path(tmp_path):
+    return str(tmp_path / "book.snap").encode()
+
+class TestSnapshotRoundTrip:
+    """Test save followed by load"""
+    
+    def test_invalid_params(self, order_book, snapshot_path):
+        assert lib.mx_order_book_save_snapshot(ffi.NULL, snapshot_path) == STATUS_INVALID_PARAM
+        assert lib.mx_order_book_save_snapshot(order_book, ffi.NULL) == STATUS_INVALID_PARAM
+        assert lib.mx_order_book_load_snapshot(ffi.NULL, snapshot_path) == STATUS_INVALID_PARAM
+        assert lib.mx_order_book_load_snapshot(order_book, ffi.NULL) == STATUS_INVALID_PARAM
+    
+    def test_missing_file(self, order_book, tmp_path):
+        missing = str(tmp_path / "missing.snap").encode()
+        assert lib.mx_order_book_load_snapshot(order_book, missing) == STATUS_ERROR
+    
+    def test_empty_book(self, order_book, snapshot_path):
+        assert lib.mx_order_book_save_snapshot(order_book, snapshot_path) == STATUS_OK
+        assert lib.mx_order_book_load_snapshot(order_book, snapshot_path) == STATUS_OK
+        assert lib.mx_order_book_get_best_bid(order_book) == 0
+        assert lib.mx_order_book_get_best_ask(order_book) == 0
+    
+    def test_restores_same_state_without_events(self, snapshot_path):
+        original = RecordingBook()
+        build_book(original.book)
+        assert lib.mx_order_book_save_snapshot(original.book, snapshot_path) == STATUS_OK
+        
+        restored = RecordingBook()
+        assert lib.mx_order_book_load_snapshot(restored.book, snapshot_path) == STATUS_OK
+        assert restored.trades == []
+        assert restored.events == []
+        
+        state = book_state(restored.book)
+        assert state == book_state(original.book)
+        assert state[1][1] == (SIDE_BUY, 9990, 6, 4)          # Partial fill kept
+        assert state[1][20][2] == 40                          # Whole iceberg kept
+        assert 22 in state[1] and 23 in state[1]              # Stops kept
+        
+        original.close()
+        restored.close()
+    
+    def test_restored_book_matches_identically(self, snapshot_path):
+        original = RecordingBook()
+        build_book(original.book)
+        assert lib.mx_order_book_save_snapshot(original.book, snapshot_path) == STATUS_OK
+        
+        restored = RecordingBook()
+        assert lib.mx_order_book_load_snapshot(restored.book, snapshot_path) == STATUS_OK
+        
+        expected = sweep(original.book, original.trades)
+        actual = sweep(restored.book, restored.trades)
+        assert actual == expected
+        
+        # Time priority at the best bid: 1 then 6 then 7
+        bid_side = [t[1] for t in actual if t[0] == 101]
+        assert bid_side[:3] == [1, 6, 7]
+        
+        original.close()
+        restored.close()
+    
+    def test_expiry_schedule_restored(self, snapshot_path):
+        original = RecordingBook()
+        build_book(original.book)
+        assert lib.mx_order_book_save_snapshot(original.book, snapshot_path) == STATUS_OK
+        
+        restored = RecordingBook()
+        assert lib.mx_order_book_load_snapshot(restored.book, snapshot_path) == STATUS_OK
+        
+        assert lib.mx_order_book_process_expirations(restored.book, 4999) == 0
+        assert lib.mx_order_book_process_expirations(restored.book, 5000) == 1
+        assert lib.mx_order_book_has_order(restored.book, 21) == 0
+        
+        original.close()
+        restored.close()
+    
+    def test_restored_stop_triggers(self, snapshot_path):
+        original = RecordingBook()
+        build_book(original.book)
+        assert lib.mx_order_book_save_snapshot(original.book, snapshot_path) == STATUS_OK
+        
+        restored = RecordingBook()
+        assert lib.mx_order_book_load_snapshot(restored.book, snapshot_path) == STATUS_OK
+        
+        # Lift the 10010 and 10011 asks so the last trade reaches the buy stop
+        lib.mx_order_book_add_limit(restored.book, 200, SIDE_BUY, 10012, 40 + 11 + 12)
+        assert lib.mx_order_book_has_order(restored.book, 22) == 0
+        assert any(p == 22 or a == 22 for a, p, _, _ in restored.trades)
+        
+        original.close()
+        restored.close()
+    
+    def test_load_replaces_existing_orders(self, order_book, snapshot_path):
+        lib.mx_order_book_add_limit(order_book, 1, SIDE_BUY, 9000, 10)
+        assert lib.mx_order_book_save_snapshot(order_book, snapshot_path) == STATUS_OK
+        
+        lib.mx_order_book_add_limit(order_book, 2, SIDE_SELL, 11000, 10)
+        assert lib.mx_order_book_load_snapshot(order_book, snapshot_path) == STATUS_OK
+        assert lib.mx_order_book_has_order(order_book, 1) == 1
+        assert lib.mx_order_book_has_order(order_book, 2) == 0
+        assert lib.mx_order_book_get_best_ask(order_book) == 0
+
+class TestSnapshotValidation:
+    """Test rejection of bad or incompatible files"""
+    
+    def saved(self, path):
+        rec = RecordingBook()
+        build_book(rec.book)
+        assert lib.mx_order_book_save_snapshot(rec.book, path) == STATUS_OK
+        rec.close()
+        with open(path, "rb") as f:
+            return bytearray(f.read())
+    
+    def assert_rejected(self, order_book, path, data, status=STATUS_ERROR):
+        """Write data to path and check the load fails without touching the book"""
+        with open(path, "wb") as f:
+            f.write(bytes(data))
+        lib.mx_order_book_add_limit(order_book, 999, SIDE_BUY, 9000, 10)
+        assert lib.mx_order_book_load_snapshot(order_book, path) == status
+        
+        # Rejected before anything is cleared
+        assert lib.mx_order_book_has_order(order_book, 999) == 1
+        assert lib.mx_order_book_get_best_bid(order_book) == 9000
+    
+    def test_corrupt_record(self, order_book, snapshot_path):
+        data = self.saved(snapshot_path)
+        data[112 + 20] ^= 0xFF
+        self.assert_rejected(order_book, snapshot_path, data)
+    
+    def test_truncated(self, order_book, snapshot_path):
+        data = self.saved(snapshot_path)
+        self.assert_rejected(order_book, snapshot_path, data[:-64])
+    
+    def test_bad_magic(self, order_book, snapshot_path):
+        data = self.saved(snapshot_path)
+        data[0:4] = b"XXXX"
+        self.assert_rejected(order_book, snapshot_path, data)
+    
+    def test_price_outside_band(self, snapshot_path):
+        self.saved(snapshot_path)
+        narrow = RecordingBook(bounds=(9000, 10005))
+        lib.mx_order_book_add_limit(narrow.book, 999, SIDE_BUY, 9500, 10)
+        narrow.events.clear()
+        assert lib.mx_order_book_load_snapshot(narrow.book, snapshot_path) == STATUS_INVALID_PRICE
+        assert lib.mx_order_book_get_best_bid(narrow.book) == 0     # Left empty
+        assert lib.mx_order_book_has_order(narrow.book, 999) == 0
+        assert narrow.events == []
+        narrow.close()
+    
+    def test_price_inside_band(self, snapshot_path):
+        self.saved(snapshot_path)
+        wide = RecordingBook(bounds=(9000, 11000))
+        assert lib.mx_order_book_load_snapshot(wide.book, snapshot_path) == STATUS_OK
+        assert lib.mx_order_book_get_best_bid(wide.book) == 9990
+        assert lib.mx_order_book_get_best_ask(wide.book) == 10010
+        wide.close()
@@ -0,0 +1,197 @@
+"""
+Stop order tests
+Stops rest in a price-indexed queue and fire automatically once the
+market reaches their stop price - no process_stops() call required
+"""
+
+import pytest
+from testhelpers import (
+    ffi, lib,
+    SIDE_BUY, SIDE_SELL,
+    ORDER_TYPE_STOP, ORDER_TYPE_STOP_LIMIT,
+    TIF_GTC, TIF_GTD,
+    STATUS_OK, STATUS_INVALID_PRICE,
+    EVENT_ACCEPTED, EVENT_TRIGGERED, EVENT_CANCELLED, EVENT_EXPIRED,
+    price_to_ticks
+)
+
+def add_stop(book, order_id, side, stop_price, quantity, limit_price=0):
+    """Add a stop (market) or stop-limit order"""
+    order_type = ORDER_TYPE_STOP_LIMIT if limit_price else ORDER_TYPE_STOP
+    return lib.mx_order_book_add_order(book, order_id, order_type, side,
+                                       limit_price, stop_price, quantity, 0,
+                                       TIF_GTC, 0, 0)
+
+class TestStopTriggering:
+    """Test automatic stop triggering"""
+    
+    def test_stop_rests_until_crossed(self, book_with_callbacks):
+        """A stop away from the market is accepted and does not trade"""
+        book, trades, events = book_with_callbacks
+        
+        lib.mx_order_book_add_limit(book, 1, SIDE_SELL, price_to_ticks(101.00), 100)
+        
+        assert add_stop(book, 2, SIDE_BUY, price_to_ticks(102.00), 50) == STATUS_OK
+        assert trades.count() == 0
+        assert events.get_for_order(2)[-1]['event'] == EVENT_ACCEPTED
+        assert lib.mx_order_book_has_order(book, 2) == 1
+    
+    def test_buy_stop_fires_without_process_stops(self, book_with_callbacks):
+        """Lifting the offer through the stop price fires the stop inline"""
+        book, trades, events = book_with_callbacks
+        
+        lib.mx_order_book_add_limit(book, 1, SIDE_SELL, price_to_ticks(101.00), 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_SELL, price_to_ticks(102.00), 100)
+        add_stop(book, 3, SIDE_BUY, price_to_ticks(102.00), 40)
+        
+        # Taking out $101 moves the ask to $102 and triggers the stop
+        lib.mx_order_book_add_limit(book, 4, SIDE_BUY, price_to_ticks(101.00), 10)
+        
+        assert EVENT_TRIGGERED in [e['event'] for e in events.get_for_order(3)]
+        assert [(t['aggressive_id'], t['passive_id']) for t in trades.trades] == [(4, 1), (3, 2)]
+        assert lib.mx_order_book_get_volume_at_price(book, SIDE_SELL, price_to_ticks(102.00)) == 60
+        assert lib.mx_order_book_has_order(book, 3) == 0
+    
+    def test_sell_stop_fires_on_cancel(self, book_with_callbacks):
+        """Pulling the bid down through a sell stop fires it"""
+        book, trades, events = book_with_callbacks
+        
+        lib.mx_order_book_add_limit(book, 1, SIDE_BUY, price_to_ticks(100.00), 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_BUY, price_to_ticks(99.00), 100)
+        add_stop(book, 3, SIDE_SELL, price_to_ticks(99.00), 25)
+        
+        lib.mx_order_book_cancel(book, 1)
+        
+        assert trades.count() == 1
+        assert trades.get_last()['aggressive_id'] == 3
+        assert trades.get_last()['price'] == price_to_ticks(99.00)
+        assert lib.mx_order_book_process_stops(book) == 0
+    
+    def test_cascade(self, book_with_callbacks):
+        """A triggered stop that moves the market fires the next stop"""
+        book, trades, events = book_with_callbacks
+        
+        lib.mx_order_book_add_limit(book, 1, SIDE_SELL, price_to_ticks(101.00), 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_SELL, price_to_ticks(102.00), 10)
+        lib.mx_order_book_add_limit(book, 3, SIDE_SELL, price_to_ticks(103.00), 10)
+        add_stop(book, 10, SIDE_BUY, price_to_ticks(102.00), 10)
+        add_stop(book, 11, SIDE_BUY, price_to_ticks(103.00), 10)
+        
+        lib.mx_order_book_add_market(book, 20, SIDE_BUY, 10)
+        
+        assert [(t['aggressive_id'], t['passive_id']) for t in trades.trades] == \
+               [(20, 1), (10, 2), (11, 3)]
+        assert lib.mx_order_book_get_best_ask(book) == 0
+    
+    def test_stops_fire_in_stop_price_order(self, book_with_callbacks):
+        """Lower buy stops fire first, ties fire in arrival order"""
+        book, trades, events = book_with_callbacks
+        
+        lib.mx_order_book_add_limit(book, 1, SIDE_SELL, price_to_ticks(101.00), 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_SELL, price_to_ticks(105.00), 100)
+        add_stop(book, 10, SIDE_BUY, price_to_ticks(104.00), 5)
+        add_stop(book, 11, SIDE_BUY, price_to_ticks(103.00), 5)
+        add_stop(book, 12, SIDE_BUY, price_to_ticks(104.00), 5)
+        
+        lib.mx_order_book_add_limit(book, 3, SIDE_BUY, price_to_ticks(101.00), 10)
+        
+        triggered = [e['order_id'] for e in events.events if e['event'] == EVENT_TRIGGERED]
+        assert triggered == [11, 10, 12]
+
+class TestStopLifecycle:
+    """Test cancel/modify/expiry of stops"""
+    
+    def test_cancel_pending_stop(self, book_with_callbacks):
+        """A cancelled stop never fires"""
+        book, trades, events = book_with_callbacks
+        
+        lib.mx_order_book_add_limit(book, 1, SIDE_SELL, price_to_ticks(101.00), 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_SELL, price_to_ticks(102.00), 10)
+        add_stop(book, 3, SIDE_BUY, price_to_ticks(102.00), 10)
+        
+        assert lib.mx_order_book_cancel(book, 3) == STATUS_OK
+        assert events.get_last()['event'] == EVENT_CANCELLED
+        
+        lib.mx_order_book_add_limit(book, 4, SIDE_BUY, price_to_ticks(101.00), 10)
+        assert trades.count() == 1
+        assert EVENT_TRIGGERED not in [e['event'] for e in events.get_for_order(3)]
+    
+    def test_triggered_stop_limit_rests_and_cancels(self, book_with_callbacks):
+        """A triggered stop-limit that cannot fill rests like a limit order"""
+        book, trades, events = book_with_callbacks
+        
+        lib.mx_order_book_add_limit(book, 1, SIDE_SELL, price_to_ticks(101.00), 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_SELL, price_to_ticks(103.00), 10)
+        add_stop(book, 3, SIDE_BUY, price_to_ticks(101.50), 20,
+                 limit_price=price_to_ticks(102.00))
+        
+        lib.mx_order_book_add_limit(book, 4, SIDE_BUY, price_to_ticks(101.00), 10)
+        
+        assert lib.mx_order_book_get_best_bid(book) == price_to_ticks(102.00)
+        assert lib.mx_order_book_get_volume_at_price(book, SIDE_BUY, price_to_ticks(102.00)) == 20
+        
+        assert lib.mx_order_book_cancel(book, 3) == STATUS_OK
+        assert lib.mx_order_book_get_best_bid(book) == 0
+    
+    def test_modify_pending_stop(self, book_with_callbacks):
+        """Reducing a pending stop changes what it trades once triggered"""
+        book, trades, events = book_with_callbacks
+        
+        lib.mx_order_book_add_limit(book, 1, SIDE_BUY, price_to_ticks(100.00), 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_BUY, price_to_ticks(99.00), 100)
+        add_stop(book, 3, SIDE_SELL, price_to_ticks(99.00), 50)
+        
+        assert lib.mx_order_book_modify(book, 3, 20) == STATUS_OK
+        lib.mx_order_book_add_limit(book, 4, SIDE_SELL, price_to_ticks(100.00), 10)
+        
+        assert trades.get_last()['aggressive_id'] == 3
+        assert trades.get_last()['quantity'] == 20
+    
+    def test_expire_pending_stop(self, book_with_callbacks):
+        """An expired GTD stop leaves the stop index"""
+        book, trades, events = book_with_callbacks
+        
+        lib.mx_order_book_add_limit(book, 1, SIDE_SELL, price_to_ticks(101.00), 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_SELL, price_to_ticks(102.00), 10)
+        lib.mx_order_book_add_order(book, 3, ORDER_TYPE_STOP, SIDE_BUY, 0,
+                                    price_to_ticks(102.00), 10, 0, TIF_GTD, 0, 1000)
+        
+        assert lib.mx_order_book_process_expirations(book, 2000) == 1
+        assert events.get_for_order(3)[-1]['event'] == EVENT_EXPIRED
+        
+        lib.mx_order_book_add_limit(book, 4, SIDE_BUY, price_to_ticks(101.00), 10)
+        assert trades.count() == 1
+
+class TestStopBounds:
+    """Test stops on a price-bounded book"""
+    
+    def test_out_of_band_stop_rejected(self, context):
+        lib.mx_context_set_price_bounds(context, price_to_ticks(50.00), price_to_ticks(150.00), 1)
+        book = lib.mx_order_book_new(context, b"BOUNDED")
+        
+        assert add_stop(book, 1, SIDE_BUY, price_to_ticks(200.00), 10) == STATUS_INVALID_PRICE
+        assert add_stop(book, 2, SIDE_BUY, price_to_ticks(120.00), 10) == STATUS_OK
+        
+        lib.mx_order_book_free(book)
+    
+    def test_stops_fire_on_bounded_book(self, context):
+        """Stop ladders built on the first stop queue and fire like the map"""
+        lib.mx_context_set_price_bounds(context, price_to_ticks(50.00), price_to_ticks(150.00), 1)
+        book = lib.mx_order_book_new(context, b"BOUNDED")
+        
+        lib.mx_order_book_add_limit(book, 1, SIDE_SELL, price_to_ticks(101.00), 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_SELL, price_to_ticks(102.00), 10)
+        lib.mx_order_book_add_limit(book, 3, SIDE_SELL, price_to_ticks(103.00), 100)
+        assert add_stop(book, 4, SIDE_BUY, price_to_ticks(102.50), 5) == STATUS_OK
+        assert add_stop(book, 5, SIDE_BUY, price_to_ticks(102.00), 5) == STATUS_OK
+        assert lib.mx_order_book_has_order(book, 4) == 1
+        assert lib.mx_order_book_has_order(book, 5) == 1
+        
+        # Trading up to 102 fires the 102 stop, whose fill at 103 fires the 102.50 stop
+        lib.mx_order_book_add_limit(book, 6, SIDE_BUY, price_to_ticks(102.00), 20)
+        assert lib.mx_order_book_has_order(book, 5) == 0
+        assert lib.mx_order_book_has_order(book, 4) == 0
+        assert lib.mx_order_book_get_best_ask(book) == price_to_ticks(103.00)
+        assert lib.mx_order_book_get_volume_at_price(book, SIDE_SELL, price_to_ticks(103.00)) == 90
+        
+        lib.mx_order_book_free(book)
@@ -0,0 +1,112 @@
+"""
+Tracing tests
+Libraries built with MX_TRACE record book maintenance trace points into a
+per-context ring that is read on demand or drained by a sink; without
+MX_TRACE the trace points compile to nothing and tracing cannot be enabled
+"""
+
+import pytest
+from testhelpers import (
+    ffi, lib,
+    SIDE_BUY, SIDE_SELL,
+    STATUS_OK, STATUS_ERROR, STATUS_INVALID_PARAM,
+    create_order_book, free_order_book
+)
+
+traced = pytest.mark.skipif(not lib.mx_is_trace_enabled(), reason="library built without MX_TRACE")
+
+def read_trace(context, max_records=256):
+    records = ffi.new("mx_trace_record_t[%d]" % max_records)
+    n = lib.mx_context_read_trace(context, records, max_records)
+    return [(records[i].point, records[i].order_id, records[i].side,
+             records[i].price, records[i].quantity, records[i].count) for i in range(n)]
+
+@pytest.fixture
+def traced_book(context):
+    """Book on a context keeping 64 trace records"""
+    assert lib.mx_context_set_trace(context, 64, ffi.NULL, ffi.NULL) == STATUS_OK
+    book = create_order_book(context, "TRACE")
+
+    yield book
+
+    free_order_book(book)
+
+class TestTraceConfig:
+    """Test enabling tracing"""
+
+    def test_invalid_arguments(self, context):
+        assert lib.mx_context_set_trace(ffi.NULL, 64, ffi.NULL, ffi.NULL) == STATUS_INVALID_PARAM
+        assert lib.mx_context_read_trace(ffi.NULL, ffi.new("mx_trace_record_t[1]"), 1) == 0
+        assert lib.mx_context_read_trace(context, ffi.NULL, 1) == 0
+        assert lib.mx_context_flush_trace(ffi.NULL) == 0
+
+    @pytest.mark.skipif(lib.mx_is_trace_enabled(), reason="library built with MX_TRACE")
+    def test_compiled_out(self, context, order_book):
+        """Without MX_TRACE nothing is ever recorded"""
+        assert lib.mx_context_set_trace(context, 64, ffi.NULL, ffi.NULL) == STATUS_ERROR
+        lib.mx_order_book_add_limit(order_book, 1, SIDE_BUY, 100, 10)
+        lib.mx_order_book_cancel(order_book, 1)
+        assert read_trace(context) == []
+
+    def test_disabled_by_default(self, context, order_book):
+        lib.mx_order_book_add_limit(order_book, 1, SIDE_BUY, 100, 10)
+        assert read_trace(context) == []
+
+@traced
+class TestTraceRecords:
+    """Test what the trace points record"""
+
+    def test_add_and_cancel(self, context, traced_book):
+        book = traced_book
+        lib.mx_context_set_timestamp(context, 1000)
+        lib.mx_order_book_add_limit(book, 1, SIDE_BUY, 100, 10)
+        lib.mx_order_book_add_limit(book, 2, SIDE_BUY, 99, 5)
+        lib.mx_context_set_timestamp(context, 2000)
+        lib.mx_order_book_cancel(book, 1)
+
+        records = ffi.new("mx_trace_record_t[8]")
+        assert lib.mx_context_read_trace(context, records, 8) == 5
+        assert [records[i].timestamp for i in range(5)] == [1000, 1000, 2000, 2000, 2000]
+        assert read_trace(context) == []
+
+        lib.mx_order_book_add_limit(book, 3, SIDE_SELL, 105, 7)
+        lib.mx_order_book_cancel(book, 3)
+        assert read_trace(context) == [
+            (lib.MX_TRACE_BOOK_ADD, 3, SIDE_SELL, 105, 7, 1),
+            (lib.MX_TRACE_BOOK_REMOVE, 3, SIDE_SELL, 105, 7, 0),
+            (lib.MX_TRACE_LEVEL_ERASED, 0, SIDE_SELL, 105, 0, 0),
+            (lib.MX_TRACE_BEST_PRICE, 0, SIDE_SELL, 0, 0, 0),
+        ]
+
+    def test_overwrites_oldest_without_sink(self, context, traced_book):
+        for i in range(100):
+            lib.mx_order_book_add_limit(traced_book, i + 1, SIDE_BUY, 100, 1)
+
+        records = read_trace(context)
+        assert len(records) == 64
+        assert records[0][1] == 37
+        assert records[-1][1] == 100
+        assert lib.mx_context_trace_overwritten(context) == 36
+
+class TestTraceSink:
+    """Test draining records through a sink"""
+
+    @traced
+    def test_sink_gets_every_record(self, context):
+        seen = []
+
+        @ffi.callback("void(const mx_trace_record_t*, uint32_t, void*)")
+        def sink(records, count, user_data):
+            seen.extend(records[i].order_id for i in range(count))
+
+        assert lib.mx_context_set_trace(context, 16, sink, ffi.NULL) == STATUS_OK
+        book = create_order_book(context, "SINK")
+        try:
+            for i in range(100):
+                lib.mx_order_book_add_limit(book, i + 1, SIDE_SELL, 200 + i, 1)
+            assert len(seen) == 96
+            assert lib.mx_context_flush_trace(context) == 4
+            assert seen == list(range(1, 101))
+            assert lib.mx_context_trace_overwritten(context) == 0
+        finally:
+            free_order_book(book)
@@ -327,5 +327,6 @@ EVENT_PARTIAL = 3  # MX_EVENT_ORDER_PARTIAL
 EVENT_CANCELLED = 4  # MX_EVENT_ORDER_CANCELLED
 EVENT_EXPIRED = 5  # MX_EVENT_ORDER_EXPIRED
 EVENT_TRIGGERED = 6  # MX_EVENT_ORDER_TRIGGERED
+EVENT_REPLACED = 7  # MX_EVENT_ORDER_REPLACED
 
 print("✓ Test helpers initialized successfully")
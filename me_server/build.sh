@@ -477,7 +477,7 @@ run_tests() {
     
     log_info "Building tests..."
     cd build
-    make tests config=$BUILD_CONFIG -j$JOBS
+    make Tests config=$BUILD_CONFIG -j$JOBS
     cd "$SCRIPT_DIR"
     
     if [ -f "${BUILD_DIR}/Tests/me_server_tests" ]; then
@@ -0,0 +1,799 @@
+#include "load_generator.h"
+#include "../../common/latency.h"
+#include "../../common/protocol.h"
+#include "../../common/protocol_v2.h"
+#include "../../common/spsc_queue.h"
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+namespace matching {
+namespace client {
+
+using namespace protocol;
+
+namespace {
+
+// =============================================================================
+// ORDER IDS
+// =============================================================================
+// The gateway sends every response to every session, so each session
+// owns the client order IDs under its own prefix and ignores the rest:
+//   [63..40] run nonce   [39..32] session + 1   [31..0] sequence
+// The engine rejects client order IDs it has seen before, so the nonce
+// (from the start time, pid and user ID) keeps repeat runs against a live
+// engine from colliding with earlier ones
+constexpr uint32_t SEQUENCE_BITS = 32;
+constexpr uint32_t SESSION_BITS = 8;
+constexpr uint32_t RUN_SHIFT = SEQUENCE_BITS + SESSION_BITS;
+constexpr uint64_t SEQUENCE_MASK = (1ull << SEQUENCE_BITS) - 1;
+constexpr uint32_t MAX_SESSIONS = (1u << SESSION_BITS) - 1;
+
+constexpr uint64_t BASE_PRICE = 15000;          // $150.00
+constexpr uint32_t RESTING_QUEUE_SIZE = 1 << 16;
+
+uint64_t wall_clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+// Non-zero 24-bit prefix, different for every run in practice
+uint64_t make_run_nonce(uint64_t user_id) {
+    uint64_t x = wall_clock_ns() ^ (static_cast<uint64_t>(getpid()) << 32) ^ (user_id * 0x9E3779B97F4A7C15ull);
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    uint64_t nonce = x >> RUN_SHIFT;
+    return nonce != 0 ? nonce : 1;
+}
+
+// Sleep until close to due, then spin the rest of the way
+void wait_until(uint64_t due, uint64_t spin_ticks) {
+    for (;;) {
+        uint64_t now = latency::read_tsc();
+        if (now >= due) {
+            return;
+        }
+        if (due - now > spin_ticks) {
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+        } else {
+            cpu_relax();
+        }
+    }
+}
+
+// =============================================================================
+// SESSION
+// =============================================================================
+
+// Per-order flags kept by the receiver
+enum OrderFlags : uint8_t {
+    NEW_ANSWERED    = 0x01,
+    CANCEL_ANSWERED = 0x02
+};
+
+struct Session {
+    uint32_t index;
+    int fd;
+    uint64_t user_id;
+    uint64_t id_prefix;                         // Run nonce and session bits of our IDs
+    uint64_t capacity;                          // Orders the schedule can send
+    
+    // Written by the sender before each send, read by the receiver when
+    // the answer arrives; 0 = not sent
+    std::unique_ptr<std::atomic<uint64_t>[]> new_due;
+    std::unique_ptr<std::atomic<uint64_t>[]> new_sent;
+    std::unique_ptr<std::atomic<uint64_t>[]> cancel_due;
+    
+    // Acknowledged orders still resting, oldest first (receiver -> sender)
+    SpscQueue<uint64_t> resting;
+    
+    // Receiver only
+    std::vector<uint8_t> flags;
+    latency::Histogram new_latency;             // From when the order was due
+    latency::Histogram new_send_latency;        // From when it actually went out
+    latency::Histogram cancel_latency;          // From when the cancel was due
+    
+    // Sender counters
+    uint64_t orders_sent;
+    uint64_t cancels_sent;
+    uint64_t send_failures;
+    
+    // Receiver counters
+    uint64_t acks;
+    uint64_t rejects;
+    uint64_t executions;
+    uint64_t cancelled;
+    uint64_t cancel_rejects;
+    
+    std::atomic<uint64_t> sent;                 // Messages awaiting an answer...
+    std::atomic<uint64_t> answered;             // ...and answers received
+    
+    Session(uint32_t session_index, uint64_t run_nonce, uint64_t orders)
+        : index(session_index)
+        , fd(-1)
+        , user_id(0)
+        , id_prefix(run_nonce << RUN_SHIFT | (static_cast<uint64_t>(session_index) + 1) << SEQUENCE_BITS)
+        , capacity(orders)
+        , new_due(new std::atomic<uint64_t>[orders])
+        , new_sent(new std::atomic<uint64_t>[orders])
+        , cancel_due(new std::atomic<uint64_t>[orders])
+        , resting(RESTING_QUEUE_SIZE)
+        , flags(orders, 0)
+        , orders_sent(0)
+        , cancels_sent(0)
+        , send_failures(0)
+        , acks(0)
+        , rejects(0)
+        , executions(0)
+        , cancelled(0)
+        , cancel_rejects(0)
+        , sent(0)
+        , answered(0)
+    {
+        for (uint64_t i = 0; i < orders; i++) {
+            new_due[i].store(0, std::memory_order_relaxed);
+            new_sent[i].store(0, std::memory_order_relaxed);
+            cancel_due[i].store(0, std::memory_order_relaxed);
+        }
+    }
+    
+    uint64_t client_order_id(uint64_t sequence) const {
+        return id_prefix | sequence;
+    }
+    
+    // Sequence number of one of our orders, or false if id is not ours
+    bool owns(uint64_t id, uint64_t& sequence) const {
+        if ((id & ~SEQUENCE_MASK) != id_prefix) {
+            return false;
+        }
+        sequence = id & SEQUENCE_MASK;
+        return sequence < capacity;
+    }
+};
+
+bool connect_session(Session& session, const LoadConfig& config) {
+    session.fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (session.fd < 0) {
+        std::cerr << "[Load] Failed to create socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+    
+    struct sockaddr_in server_addr;
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(config.port);
+    if (inet_pton(AF_INET, config.host.c_str(), &server_addr.sin_addr) <= 0) {
+        std::cerr << "[Load] Invalid address: " << config.host << std::endl;
+        return false;
+    }
+    
+    if (connect(session.fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        std::cerr << "[Load] Session " << session.index << " failed to connect: "
+                  << strerror(errno) << std::endl;
+        return false;
+    }
+    
+    int one = 1;
+    setsockopt(session.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return true;
+}
+
+bool send_all(int fd, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool recv_all(int fd, void* data, size_t size) {
+    uint8_t* bytes = static_cast<uint8_t*>(data);
+    while (size > 0) {
+        ssize_t got = recv(fd, bytes, size, 0);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        bytes += got;
+        size -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+// v2 sessions log on before any order: symbol i of the config is symbol
+// ID i. Nothing else is in flight yet, so the answer is the next message.
+bool logon_session(Session& session, const LoadConfig& config) {
+    std::vector<uint8_t> request = make_logon(session.user_id, PROTOCOL_VERSION_2, config.symbols);
+    LogonMessage reply;
+    if (!send_all(session.fd, request.data(), request.size()) ||
+        !recv_all(session.fd, &reply, sizeof(reply))) {
+        std::cerr << "[Load] Session " << session.index << " LOGON failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (reply.header.get_type() != MessageType::LOGON || reply.version != PROTOCOL_VERSION_2 ||
+        reply.symbol_count != config.symbols.size()) {
+        std::cerr << "[Load] Session " << session.index << " was not granted protocol v2" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// =============================================================================
+// OUTBOX
+// =============================================================================
+// Under v1 every message goes out on its own; under v2 messages collect in
+// one frame until the next one is not due yet (or the frame is full), so a
+// sender that has fallen behind its schedule catches up in batches.
+
+class Outbox {
+public:
+    Outbox(int fd, bool v2) : fd_(fd), v2_(v2) {}
+    
+    bool send(const void* message, size_t size) {
+        if (!v2_) {
+            return send_all(fd_, message, size);
+        }
+        if (frame_.append(message, size)) {
+            return true;
+        }
+        return flush() && frame_.append(message, size);
+    }
+    
+    bool flush() {
+        if (frame_.empty()) {
+            return true;
+        }
+        size_t length;
+        const uint8_t* frame = frame_.seal(length);
+        frame_.reset();
+        return send_all(fd_, frame, length);
+    }
+
+private:
+    int fd_;
+    bool v2_;
+    FrameWriterV2 frame_;
+};
+
+// =============================================================================
+// SENDER
+// =============================================================================
+
+void run_sender(Session& session, const LoadConfig& config, uint64_t start,
+                uint64_t interval_ticks, uint64_t messages, const std::atomic<bool>& running) {
+    std::mt19937_64 rng(config.user_id * 7919 + session.index);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    uint64_t spin_ticks = static_cast<uint64_t>(50000.0 / latency::ns_per_tick());   // 50 us
+    uint64_t next_order = 0;
+    bool v2 = config.protocol == PROTOCOL_VERSION_2;
+    Outbox outbox(session.fd, v2);
+    
+    for (uint64_t i = 0; i < messages && running; i++) {
+        uint64_t due = start + i * interval_ticks;
+        if (v2 && latency::read_tsc() < due && !outbox.flush()) {
+            session.send_failures++;
+            break;
+        }
+        wait_until(due, spin_ticks);
+        
+        // Cancel the oldest resting order, or send a new one when there is
+        // nothing to cancel (or no order numbers left)
+        bool cancel = unit(rng) < config.cancel_ratio || next_order >= session.capacity;
+        const uint64_t* target = cancel ? session.resting.front() : nullptr;
+        
+        if (target) {
+            uint64_t sequence = *target;
+            session.resting.pop();
+            
+            session.cancel_due[sequence].store(due, std::memory_order_release);
+            
+            bool sent;
+            if (v2) {
+                CancelOrderV2 msg;
+                msg.sub.type = static_cast<uint8_t>(MessageType::CANCEL_ORDER);
+                msg.sub.length = sizeof(msg);
+                msg.symbol_id = static_cast<uint16_t>(sequence % config.symbols.size());
+                msg.client_order_id = session.client_order_id(sequence);
+                sent = outbox.send(&msg, sizeof(msg));
+            } else {
+                CancelOrderMessage msg;
+                msg.set_symbol(config.symbols[sequence % config.symbols.size()]);
+                msg.client_order_id = session.client_order_id(sequence);
+                msg.user_id = session.user_id;
+                msg.timestamp = wall_clock_ns();
+                sent = outbox.send(&msg, sizeof(msg));
+            }
+            if (!sent) {
+                session.send_failures++;
+                break;
+            }
+            session.sent.fetch_add(1, std::memory_order_relaxed);
+            session.cancels_sent++;
+            continue;
+        }
+        if (next_order >= session.capacity) {
+            continue;
+        }
+        
+        uint64_t sequence = next_order++;
+        Side side = (rng() & 1) ? Side::BUY : Side::SELL;
+        bool cross = unit(rng) < config.cross_ratio;
+        uint64_t offset = cross ? 50 : 1 + rng() % 100;
+        uint64_t price;
+        if (side == Side::BUY) {
+            price = cross ? BASE_PRICE + offset : BASE_PRICE - offset;
+        } else {
+            price = cross ? BASE_PRICE - offset : BASE_PRICE + offset;
+        }
+        uint64_t quantity = 1 + rng() % 100;
+        
+        session.new_due[sequence].store(due, std::memory_order_release);
+        session.new_sent[sequence].store(latency::read_tsc(), std::memory_order_release);
+        
+        bool sent;
+        if (v2) {
+            NewOrderV2 msg;
+            msg.sub.type = static_cast<uint8_t>(MessageType::NEW_ORDER);
+            msg.sub.length = sizeof(msg);
+            msg.symbol_id = static_cast<uint16_t>(sequence % config.symbols.size());
+            msg.side = static_cast<uint8_t>(side);
+            msg.order_type = static_cast<uint8_t>(OrderType::LIMIT);
+            msg.price = static_cast<uint32_t>(price);
+            msg.quantity = static_cast<uint32_t>(quantity);
+            msg.client_order_id = session.client_order_id(sequence);
+            sent = outbox.send(&msg, sizeof(msg));
+        } else {
+            NewOrderMessage msg;
+            msg.set_symbol(config.symbols[sequence % config.symbols.size()]);
+            msg.client_order_id = session.client_order_id(sequence);
+            msg.user_id = session.user_id;
+            msg.side = static_cast<uint8_t>(side);
+            msg.order_type = static_cast<uint8_t>(OrderType::LIMIT);
+            msg.price = price;
+            msg.quantity = quantity;
+            msg.timestamp = wall_clock_ns();
+            sent = outbox.send(&msg, sizeof(msg));
+        }
+        if (!sent) {
+            session.send_failures++;
+            break;
+        }
+        session.sent.fetch_add(1, std::memory_order_relaxed);
+        session.orders_sent++;
+    }
+    
+    if (session.send_failures == 0 && !outbox.flush()) {
+        session.send_failures++;
+    }
+}
+
+// =============================================================================
+// RECEIVER
+// =============================================================================
+
+void on_new_answer(Session& session, uint64_t sequence, uint64_t now) {
+    session.flags[sequence] |= NEW_ANSWERED;
+    uint64_t due = session.new_due[sequence].load(std::memory_order_acquire);
+    uint64_t sent = session.new_sent[sequence].load(std::memory_order_acquire);
+    if (due) {
+        session.new_latency.record(now - due);
+        session.new_send_latency.record(now - sent);
+    }
+    session.answered.fetch_add(1, std::memory_order_relaxed);
+}
+
+// True if this answers a cancel we sent and have not had answered yet
+bool on_cancel_answer(Session& session, uint64_t sequence, uint64_t now) {
+    uint64_t due = session.cancel_due[sequence].load(std::memory_order_acquire);
+    if (!due || (session.flags[sequence] & CANCEL_ANSWERED)) {
+        return false;
+    }
+    session.flags[sequence] |= CANCEL_ANSWERED;
+    session.cancel_latency.record(now - due);
+    session.answered.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Answer of either protocol version, reduced to its type and order ID
+void handle_response(Session& session, MessageType type, uint64_t client_order_id) {
+    uint64_t now = latency::read_tsc();
+    uint64_t sequence;
+    if (!session.owns(client_order_id, sequence)) {
+        return;
+    }
+    
+    switch (type) {
+        case MessageType::ORDER_ACK: {
+            if (session.flags[sequence] & NEW_ANSWERED) {
+                return;
+            }
+            on_new_answer(session, sequence, now);
+            session.acks++;
+            
+            // Resting (as far as we know): a candidate for cancelling
+            if (uint64_t* slot = session.resting.try_claim()) {
+                *slot = sequence;
+                session.resting.publish();
+            }
+            break;
+        }
+        
+        case MessageType::ORDER_REJECT: {
+            if (!(session.flags[sequence] & NEW_ANSWERED)) {
+                on_new_answer(session, sequence, now);
+                session.rejects++;
+            } else if (on_cancel_answer(session, sequence, now)) {
+                session.cancel_rejects++;       // Filled before the cancel arrived
+            }
+            break;
+        }
+        
+        case MessageType::ORDER_CANCELLED: {
+            if (on_cancel_answer(session, sequence, now)) {
+                session.cancelled++;
+            }
+            break;
+        }
+        
+        case MessageType::EXECUTION: {
+            if (!(session.flags[sequence] & NEW_ANSWERED)) {
+                on_new_answer(session, sequence, now);
+            }
+            session.executions++;
+            break;
+        }
+        
+        default:
+            break;
+    }
+}
+
+void handle_v1(Session& session, const MessageHeader& header) {
+    switch (header.get_type()) {
+        case MessageType::ORDER_ACK:
+            handle_response(session, header.get_type(),
+                            reinterpret_cast<const OrderAckMessage&>(header).client_order_id);
+            break;
+        case MessageType::ORDER_REJECT:
+        case MessageType::ORDER_CANCELLED:
+            handle_response(session, header.get_type(),
+                            reinterpret_cast<const OrderRejectMessage&>(header).client_order_id);
+            break;
+        case MessageType::EXECUTION:
+            handle_response(session, header.get_type(),
+                            reinterpret_cast<const ExecutionMessage&>(header).client_order_id);
+            break;
+        default:
+            break;                              // Trades, quotes
+    }
+}
+
+// The gateway only sends a v2 session its own user's responses
+bool handle_v2(Session& session, const uint8_t* frame, size_t length) {
+    return for_each_message_v2(frame, length, [&](const SubHeaderV2* message) {
+        switch (message->get_type()) {
+            case MessageType::ORDER_ACK:
+                if (message->length >= sizeof(OrderAckV2)) {
+                    handle_response(session, message->get_type(),
+                                    reinterpret_cast<const OrderAckV2*>(message)->client_order_id);
+                }
+                break;
+            case MessageType::ORDER_REJECT:
+            case MessageType::ORDER_CANCELLED:
+                if (message->length >= sizeof(OrderRejectV2)) {
+                    handle_response(session, message->get_type(),
+                                    reinterpret_cast<const OrderRejectV2*>(message)->client_order_id);
+                }
+                break;
+            case MessageType::EXECUTION:
+                if (message->length >= sizeof(ExecutionV2)) {
+                    handle_response(session, message->get_type(),
+                                    reinterpret_cast<const ExecutionV2*>(message)->client_order_id);
+                }
+                break;
+            default:
+                break;
+        }
+    });
+}
+
+void run_receiver(Session& session) {
+    std::vector<uint8_t> buffer(1 << 16);
+    size_t filled = 0;
+    
+    for (;;) {
+        ssize_t bytes_read = recv(session.fd, buffer.data() + filled, buffer.size() - filled, 0);
+        if (bytes_read <= 0) {
+            if (bytes_read < 0 && errno == EINTR) {
+                continue;
+            }
+            return;                             // Closed, or shut down by run_load_generator()
+        }
+        filled += static_cast<size_t>(bytes_read);
+        
+        // Handle every complete message (v1) or frame (v2), keep the partial one
+        size_t offset = 0;
+        while (filled - offset >= FRAME_PREFIX) {
+            const uint8_t* frame = buffer.data() + offset;
+            size_t length = frame_length(frame);
+            bool v2 = frame[0] == PROTOCOL_VERSION_2;
+            if (length < (v2 ? sizeof(FrameHeaderV2) : sizeof(MessageHeader))) {
+                std::cerr << "[Load] Session " << session.index << " bad message length" << std::endl;
+                return;
+            }
+            if (filled - offset < length) {
+                if (length > buffer.size()) {
+                    buffer.resize(length);
+                }
+                break;
+            }
+            if (!v2) {
+                handle_v1(session, *reinterpret_cast<const MessageHeader*>(frame));
+            } else if (!handle_v2(session, frame, length)) {
+                std::cerr << "[Load] Session " << session.index << " malformed v2 frame" << std::endl;
+                return;
+            }
+            offset += length;
+        }
+        if (offset > 0) {
+            memmove(buffer.data(), buffer.data() + offset, filled - offset);
+            filled -= offset;
+        }
+    }
+}
+
+// =============================================================================
+// REPORT
+// =============================================================================
+
+void print_histogram(const char* name, const latency::Snapshot& snapshot) {
+    static const double PERCENTILES[] = { 50.0, 90.0, 99.0, 99.9, 99.99, 100.0 };
+    double us_per_tick = latency::ns_per_tick() / 1000.0;
+    
+    char line[160];
+    int length = snprintf(line, sizeof(line), "  %-18s %10llu", name,
+                          static_cast<unsigned long long>(snapshot.count()));
+    for (double percentile : PERCENTILES) {
+        if (snapshot.count() == 0) {
+            length += snprintf(line + length, sizeof(line) - length, " %9s", "-");
+        } else {
+            length += snprintf(line + length, sizeof(line) - length, " %9.1f",
+                               snapshot.percentile(percentile) * us_per_tick);
+        }
+    }
+    std::cout << line << std::endl;
+}
+
+} // namespace
+
+// =============================================================================
+// OPTIONS
+// =============================================================================
+
+void print_load_usage() {
+    std::cout << "Usage: trading_client --load [options]\n"
+              << "  --host ADDR          Gateway address (default 127.0.0.1)\n"
+              << "  --port N             Gateway port (default 8080)\n"
+              << "  --sessions N         TCP sessions, at most 255 (default 4)\n"
+              << "  --rate N             Messages/sec over all sessions (default 10000)\n"
+              << "  --duration SECONDS   Sending time (default 10)\n"
+              << "  --cancel-ratio X     Share of messages that are cancels (default 0.3)\n"
+              << "  --cross-ratio X      Share of orders priced to trade (default 0.1)\n"
+              << "  --symbols A,B,...    Symbols to trade (default AAPL)\n"
+              << "  --user N             First user ID (default 1001)\n"
+              << "  --protocol N         Wire protocol: 1 (default) | 2 (compact, batched)\n"
+              << "  --drain SECONDS      Wait for answers after sending (default 2)\n";
+}
+
+bool parse_load_args(int argc, char* argv[], int first, LoadConfig& config) {
+    for (int i = first; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        const char* value = argv[++i];
+        
+        if (arg == "--host") {
+            config.host = value;
+        } else if (arg == "--port") {
+            config.port = std::atoi(value);
+        } else if (arg == "--sessions") {
+            config.sessions = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--rate") {
+            config.rate = std::atof(value);
+        } else if (arg == "--duration") {
+            config.duration = std::atof(value);
+        } else if (arg == "--cancel-ratio") {
+            config.cancel_ratio = std::atof(value);
+        } else if (arg == "--cross-ratio") {
+            config.cross_ratio = std::atof(value);
+        } else if (arg == "--user") {
+            config.user_id = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--protocol") {
+            config.protocol = static_cast<uint8_t>(std::atoi(value));
+        } else if (arg == "--drain") {
+            config.drain_timeout = std::atof(value);
+        } else if (arg == "--symbols") {
+            config.symbols.clear();
+            std::istringstream list(value);
+            std::string symbol;
+            while (std::getline(list, symbol, ',')) {
+                if (!symbol.empty()) {
+                    config.symbols.push_back(symbol);
+                }
+            }
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    
+    if (config.sessions == 0 || config.sessions > MAX_SESSIONS || config.rate <= 0.0 || config.duration <= 0.0 ||
+        config.symbols.empty() || config.cancel_ratio < 0.0 || config.cancel_ratio > 1.0 ||
+        config.cross_ratio < 0.0 || config.cross_ratio > 1.0 ||
+        (config.protocol != PROTOCOL_VERSION && config.protocol != PROTOCOL_VERSION_2)) {
+        std::cerr << "Invalid load options" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// =============================================================================
+// LOAD TEST
+// =============================================================================
+
+int run_load_generator(const LoadConfig& config, const std::atomic<bool>& running) {
+    double session_rate = config.rate / config.sessions;
+    uint64_t messages = static_cast<uint64_t>(session_rate * config.duration);
+    if (messages == 0) {
+        std::cerr << "[Load] Rate and duration leave nothing to send" << std::endl;
+        return 1;
+    }
+    if (messages > SEQUENCE_MASK) {
+        std::cerr << "[Load] Too many messages per session for the order ID space" << std::endl;
+        return 1;
+    }
+    uint64_t interval_ticks = static_cast<uint64_t>(1e9 / session_rate / latency::ns_per_tick());
+    
+    std::cout << "[Load] " << config.sessions << " sessions to " << config.host << ":" << config.port
+              << ", " << config.rate << " msg/s for " << config.duration << " s ("
+              << messages << " per session, protocol v" << static_cast<int>(config.protocol) << ")" << std::endl;
+    
+    uint64_t run_nonce = make_run_nonce(config.user_id);
+    std::vector<std::unique_ptr<Session>> sessions;
+    for (uint32_t i = 0; i < config.sessions; i++) {
+        sessions.emplace_back(new Session(i, run_nonce, messages));
+        sessions.back()->user_id = config.user_id + i;
+        if (!connect_session(*sessions.back(), config) ||
+            (config.protocol == PROTOCOL_VERSION_2 && !logon_session(*sessions.back(), config))) {
+            for (auto& session : sessions) {
+                if (session->fd >= 0) {
+                    close(session->fd);
+                }
+            }
+            return 1;
+        }
+    }
+    
+    std::vector<std::thread> receivers;
+    for (auto& session : sessions) {
+        receivers.emplace_back(run_receiver, std::ref(*session));
+    }
+    
+    // Sessions share one clock, offset evenly within an interval
+    uint64_t start = latency::read_tsc() + static_cast<uint64_t>(100e6 / latency::ns_per_tick());
+    auto wall_start = std::chrono::steady_clock::now();
+    std::vector<std::thread> senders;
+    for (auto& session : sessions) {
+        uint64_t offset = interval_ticks * session->index / config.sessions;
+        senders.emplace_back(run_sender, std::ref(*session), std::cref(config), start + offset,
+                             interval_ticks, messages, std::cref(running));
+    }
+    for (auto& sender : senders) {
+        sender.join();
+    }
+    double send_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count() - 0.1;
+    
+    // Give outstanding answers until the drain timeout
+    auto drain_deadline = std::chrono::steady_clock::now() +
+                          std::chrono::microseconds(static_cast<int64_t>(config.drain_timeout * 1e6));
+    for (;;) {
+        bool outstanding = false;
+        for (auto& session : sessions) {
+            if (session->answered.load() < session->sent.load()) {
+                outstanding = true;
+            }
+        }
+        if (!outstanding || std::chrono::steady_clock::now() >= drain_deadline || !running) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    
+    for (auto& session : sessions) {
+        shutdown(session->fd, SHUT_RDWR);
+    }
+    for (auto& receiver : receivers) {
+        receiver.join();
+    }
+    
+    // Merge sessions
+    latency::Snapshot new_latency, new_send_latency, cancel_latency, snapshot;
+    uint64_t orders = 0, cancels = 0, failures = 0, sent = 0, answered = 0;
+    uint64_t acks = 0, rejects = 0, executions = 0, cancelled = 0, cancel_rejects = 0;
+    for (auto& session : sessions) {
+        session->new_latency.snapshot(snapshot);
+        new_latency.add(snapshot);
+        session->new_send_latency.snapshot(snapshot);
+        new_send_latency.add(snapshot);
+        session->cancel_latency.snapshot(snapshot);
+        cancel_latency.add(snapshot);
+        
+        orders += session->orders_sent;
+        cancels += session->cancels_sent;
+        failures += session->send_failures;
+        sent += session->sent.load();
+        answered += session->answered.load();
+        acks += session->acks;
+        rejects += session->rejects;
+        executions += session->executions;
+        cancelled += session->cancelled;
+        cancel_rejects += session->cancel_rejects;
+        close(session->fd);
+    }
+    
+    std::cout << "\n========== LOAD TEST RESULTS ==========" << std::endl;
+    std::cout << "Sessions:         " << config.sessions << std::endl;
+    std::cout << "Target Rate:      " << static_cast<uint64_t>(config.rate) << " msg/s" << std::endl;
+    std::cout << "Achieved Rate:    " << static_cast<uint64_t>(send_seconds > 0 ? (orders + cancels) / send_seconds : 0)
+              << " msg/s" << std::endl;
+    std::cout << "Orders Sent:      " << orders << std::endl;
+    std::cout << "Cancels Sent:     " << cancels << std::endl;
+    std::cout << "Acks:             " << acks << std::endl;
+    std::cout << "Rejects:          " << rejects << std::endl;
+    std::cout << "Executions:       " << executions << std::endl;
+    std::cout << "Cancelled:        " << cancelled << std::endl;
+    std::cout << "Cancel Rejects:   " << cancel_rejects << std::endl;
+    std::cout << "Unanswered:       " << sent - answered << std::endl;
+    if (failures) {
+        std::cout << "Send Failures:    " << failures << std::endl;
+    }
+    
+    char header[160];
+    snprintf(header, sizeof(header), "  %-18s %10s %9s %9s %9s %9s %9s %9s", "Round trip (us)",
+             "count", "p50", "p90", "p99", "p99.9", "p99.99", "max");
+    std::cout << header << std::endl;
+    print_histogram("New order", new_latency);
+    print_histogram("New (from send)", new_send_latency);
+    print_histogram("Cancel", cancel_latency);
+    std::cout << "========================================\n" << std::endl;
+    
+    return failures ? 1 : 0;
+}
+
+} // namespace client
+} // namespace matching
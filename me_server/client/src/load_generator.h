@@ -0,0 +1,57 @@
+#ifndef MATCHING_CLIENT_LOAD_GENERATOR_H
+#define MATCHING_CLIENT_LOAD_GENERATOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace matching {
+namespace client {
+
+// =============================================================================
+// LOAD GENERATOR CONFIGURATION
+// =============================================================================
+// Open-loop load: every session sends on a fixed schedule whatever the
+// responses are doing, and each round trip is measured from the time its
+// message was due, so a stalled gateway shows up as latency instead of
+// as a lower send rate (no coordinated omission).
+struct LoadConfig {
+    std::string host;
+    int port;
+    uint32_t sessions;              // TCP connections, one schedule each
+    double rate;                    // Messages per second over all sessions
+    double duration;                // Seconds of sending
+    double cancel_ratio;            // Share of messages that cancel a resting order
+    double cross_ratio;             // Share of new orders priced to trade
+    double drain_timeout;           // Seconds to wait for responses afterwards
+    uint64_t user_id;               // Session i sends as user_id + i
+    uint8_t protocol;               // 1, or 2 (negotiated at LOGON, batched frames)
+    std::vector<std::string> symbols;
+    
+    LoadConfig()
+        : host("127.0.0.1")
+        , port(8080)
+        , sessions(4)
+        , rate(10000.0)
+        , duration(10.0)
+        , cancel_ratio(0.3)
+        , cross_ratio(0.1)
+        , drain_timeout(2.0)
+        , user_id(1001)
+        , protocol(1)
+        , symbols{"AAPL"}
+    {}
+};
+
+// Parse "--load" mode options (argv[first] onwards); false on bad input
+bool parse_load_args(int argc, char* argv[], int first, LoadConfig& config);
+void print_load_usage();
+
+// Run the load test and print its report; returns the process exit code
+int run_load_generator(const LoadConfig& config, const std::atomic<bool>& running);
+
+} // namespace client
+} // namespace matching
+
+#endif // MATCHING_CLIENT_LOAD_GENERATOR_H
@@ -1,3 +1,4 @@
+#include "load_generator.h"
 #include "../../common/protocol.h"
 #include <iostream>
 #include <string>
@@ -12,6 +13,7 @@
 #include <csignal>
 #include <vector>
 
+using namespace matching::client;
 using namespace matching::protocol;
 
 // =============================================================================
@@ -60,6 +62,8 @@ const char* message_type_to_string(MessageType type) {
         case MessageType::ORDER_ACK: return "ORDER_ACK";
         case MessageType::ORDER_REJECT: return "ORDER_REJECT";
         case MessageType::ORDER_CANCELLED: return "ORDER_CANCELLED";
+        case MessageType::ORDER_REPLACED: return "ORDER_REPLACED";
+        case MessageType::MASS_CANCEL_ACK: return "MASS_CANCEL_ACK";
         case MessageType::EXECUTION: return "EXECUTION";
         case MessageType::TRADE: return "TRADE";
         case MessageType::QUOTE: return "QUOTE";
@@ -164,6 +168,18 @@ void handle_cancel_ack(const OrderRejectMessage& msg) {
     std::cout << std::endl;
 }
 
+void handle_order_replaced(const OrderReplacedMessage& msg) {
+    std::cout << "\n✓ ORDER REPLACED" << std::endl;
+    std::cout << "  Client Order ID: " << msg.orig_client_order_id;
+    if (msg.client_order_id != msg.orig_client_order_id) {
+        std::cout << " -> " << msg.client_order_id;
+    }
+    std::cout << std::endl;
+    std::cout << "  Price:           $" << (msg.price / 100.0) << std::endl;
+    std::cout << "  Quantity:        " << msg.quantity << " (leaves " << msg.leaves_quantity << ")" << std::endl;
+    std::cout << std::endl;
+}
+
 // =============================================================================
 // MESSAGE RECEIVER THREAD
 // =============================================================================
@@ -209,27 +225,31 @@ void message_receiver_thread() {
             case MessageType::ORDER_ACK:
                 handle_order_ack(*reinterpret_cast<const OrderAckMessage*>(buffer.data()));
                 break;
-                
+            
             case MessageType::ORDER_REJECT:
                 handle_order_reject(*reinterpret_cast<const OrderRejectMessage*>(buffer.data()));
                 break;
-                
+            
             case MessageType::ORDER_CANCELLED:
                 handle_cancel_ack(*reinterpret_cast<const OrderRejectMessage*>(buffer.data()));
                 break;
-                
+            
+            case MessageType::ORDER_REPLACED:
+                handle_order_replaced(*reinterpret_cast<const OrderReplacedMessage*>(buffer.data()));
+                break;
+            
             case MessageType::EXECUTION:
                 handle_execution(*reinterpret_cast<const ExecutionMessage*>(buffer.data()));
                 break;
-                
+            
             case MessageType::TRADE:
                 handle_trade(*reinterpret_cast<const TradeMessage*>(buffer.data()));
                 break;
-                
+            
             case MessageType::QUOTE:
                 handle_quote(*reinterpret_cast<const QuoteMessage*>(buffer.data()));
                 break;
-                
+            
             default:
                 std::cout << "[Client] Unknown message type: " 
                          << message_type_to_string(msg_type) << std::endl;
@@ -281,6 +301,27 @@ void send_cancel_order(uint64_t client_order_id, const std::string& symbol, uint
     }
 }
 
+void send_replace_order(uint64_t client_order_id, const std::string& symbol,
+                        uint64_t price, uint64_t quantity, uint64_t user_id) {
+    ReplaceOrderMessage msg;
+    msg.set_symbol(symbol);
+    msg.client_order_id = client_order_id;
+    msg.user_id = user_id;
+    msg.price = price;
+    msg.quantity = quantity;
+    msg.timestamp = get_timestamp();
+    
+    std::cout << "\n→ Sending REPLACE_ORDER:" << std::endl;
+    std::cout << "  Order ID: " << client_order_id << std::endl;
+    std::cout << "  Symbol:   " << symbol << std::endl;
+    std::cout << "  Price:    $" << (price / 100.0) << std::endl;
+    std::cout << "  Quantity: " << quantity << std::endl;
+    
+    if (!send_message(&msg, sizeof(msg))) {
+        std::cerr << "[Client] Failed to send replace" << std::endl;
+    }
+}
+
 // =============================================================================
 // INTERACTIVE MENU
 // =============================================================================
@@ -294,6 +335,7 @@ void print_menu() {
     std::cout << "3. Cancel Order" << std::endl;
     std::cout << "4. Market Maker (auto orders)" << std::endl;
     std::cout << "5. Stress Test" << std::endl;
+    std::cout << "6. Replace Order" << std::endl;
     std::cout << "0. Quit" << std::endl;
     std::cout << "========================================" << std::endl;
     std::cout << "Choice: ";
@@ -314,7 +356,7 @@ void run_interactive_mode(uint64_t user_id) {
             case 0:
                 g_running = false;
                 break;
-                
+            
             case 1: { // Buy order
                 std::cout << "Symbol (AAPL/GOOGL/MSFT/AMZN/TSLA): ";
                 std::string symbol;
@@ -403,6 +445,28 @@ void run_interactive_mode(uint64_t user_id) {
                 break;
             }
             
+            case 6: { // Replace order
+                std::cout << "Order ID to replace: ";
+                std::getline(std::cin, input);
+                uint64_t order_id = std::atoll(input.c_str());
+                
+                std::cout << "Symbol: ";
+                std::string symbol;
+                std::getline(std::cin, symbol);
+                
+                std::cout << "New price (e.g., 150.50): ";
+                std::getline(std::cin, input);
+                double price_dollars = std::atof(input.c_str());
+                uint64_t price = static_cast<uint64_t>(price_dollars * 100);
+                
+                std::cout << "New quantity: ";
+                std::getline(std::cin, input);
+                uint64_t quantity = std::atoll(input.c_str());
+                
+                send_replace_order(order_id, symbol, price, quantity, user_id);
+                break;
+            }
+            
             default:
                 std::cout << "Invalid choice!" << std::endl;
                 break;
@@ -421,6 +485,16 @@ int main(int argc, char* argv[]) {
     
     setup_signal_handlers();
     
+    // Load generation mode: trading_client --load [options]
+    if (argc > 1 && std::string(argv[1]) == "--load") {
+        LoadConfig load_config;
+        if (!parse_load_args(argc, argv, 2, load_config)) {
+            print_load_usage();
+            return 1;
+        }
+        return run_load_generator(load_config, g_running);
+    }
+    
     // Configuration
     std::string host = "127.0.0.1";
     int port = 8080;
@@ -0,0 +1,244 @@
+#ifndef MATCHING_LATENCY_H
+#define MATCHING_LATENCY_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace matching {
+namespace latency {
+
+// =============================================================================
+// TIMESTAMP COUNTER
+// =============================================================================
+// Raw TSC on x86 (invariant and synchronised across cores on the servers
+// we run on), steady_clock nanoseconds elsewhere. Hot paths only take
+// tick differences; conversion to nanoseconds waits until reporting.
+inline uint64_t read_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Nanoseconds per tick. Measured against steady_clock on first use, which
+// spins for about 10 ms, so call it from a reporting thread.
+inline double ns_per_tick() {
+    static const double ratio = [] {
+#if defined(__x86_64__) || defined(__i386__)
+        auto start = std::chrono::steady_clock::now();
+        uint64_t start_ticks = read_tsc();
+        std::chrono::steady_clock::time_point end;
+        do {
+            end = std::chrono::steady_clock::now();
+        } while (end - start < std::chrono::milliseconds(10));
+        uint64_t ticks = read_tsc() - start_ticks;
+        double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        return ticks ? ns / static_cast<double>(ticks) : 1.0;
+#else
+        return 1.0;
+#endif
+    }();
+    return ratio;
+}
+
+// =============================================================================
+// WALL CLOCK
+// =============================================================================
+// Epoch nanoseconds for a TSC reading, so code that has already read the
+// counter gets a timestamp without another clock call. Each thread
+// anchors to system_clock on first use (calibrating the rate first, so
+// call it once at startup) and again about once a second, re-measuring
+// the rate over its whole run so the calibration error does not pile up.
+inline uint64_t system_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+inline uint64_t wall_ns_at(uint64_t ticks) {
+    struct Anchor {
+        uint64_t origin_ticks;
+        uint64_t origin_ns;
+        uint64_t ticks;
+        uint64_t ns;
+        double ns_per_tick;
+        uint64_t resync_ticks;
+    };
+    static thread_local Anchor anchor = [] {
+        Anchor a;
+        a.ns_per_tick = ns_per_tick();
+        a.resync_ticks = static_cast<uint64_t>(1e9 / a.ns_per_tick);
+        a.origin_ticks = a.ticks = read_tsc();
+        a.origin_ns = a.ns = system_ns();
+        return a;
+    }();
+    
+    if (ticks - anchor.ticks >= anchor.resync_ticks && ticks > anchor.ticks) {
+        uint64_t now = system_ns();
+        uint64_t now_ticks = read_tsc();
+        if (now > anchor.origin_ns && now_ticks > anchor.origin_ticks) {
+            anchor.ns_per_tick = static_cast<double>(now - anchor.origin_ns) /
+                                 static_cast<double>(now_ticks - anchor.origin_ticks);
+        }
+        anchor.ticks = now_ticks;
+        anchor.ns = now;
+    }
+    
+    // Signed, so a reading taken just before the anchor does not wrap
+    int64_t delta = static_cast<int64_t>(ticks - anchor.ticks);
+    return anchor.ns + static_cast<uint64_t>(static_cast<int64_t>(static_cast<double>(delta) * anchor.ns_per_tick));
+}
+
+// =============================================================================
+// BUCKETS
+// =============================================================================
+// HDR-style log buckets: one per value below 2^SUB_BITS, then every power
+// of two split into 2^SUB_BITS equal buckets, so any value is known to
+// within 1 / 2^SUB_BITS (about 3%). Values past 2^MAX_BITS ticks share
+// the last bucket.
+constexpr uint32_t SUB_BITS = 5;
+constexpr uint32_t SUB_COUNT = 1u << SUB_BITS;
+constexpr uint32_t MAX_BITS = 40;
+constexpr uint32_t BUCKET_COUNT = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+inline uint32_t bucket_of(uint64_t ticks) {
+    if (ticks < SUB_COUNT) {
+        return static_cast<uint32_t>(ticks);
+    }
+    uint32_t msb = 63u - static_cast<uint32_t>(__builtin_clzll(ticks));
+    if (msb >= MAX_BITS) {
+        return BUCKET_COUNT - 1;
+    }
+    uint32_t shift = msb - SUB_BITS;
+    uint32_t sub = static_cast<uint32_t>(ticks >> shift) - SUB_COUNT;
+    return ((shift + 1) << SUB_BITS) | sub;
+}
+
+// Largest value that lands in bucket
+inline uint64_t bucket_top(uint32_t bucket) {
+    uint32_t group = bucket >> SUB_BITS;
+    if (group == 0) {
+        return bucket;
+    }
+    uint64_t mantissa = (bucket & (SUB_COUNT - 1)) + SUB_COUNT + 1;
+    return (mantissa << (group - 1)) - 1;
+}
+
+// =============================================================================
+// SNAPSHOT
+// =============================================================================
+// Plain copy of a histogram's counts. Snapshots of several histograms
+// merge exactly (add), and the difference of two taken from the same
+// histogram is the interval between them (subtract).
+struct Snapshot {
+    std::array<uint64_t, BUCKET_COUNT> counts{};
+    
+    uint64_t count() const {
+        uint64_t total = 0;
+        for (uint64_t n : counts) {
+            total += n;
+        }
+        return total;
+    }
+    
+    void add(const Snapshot& other) {
+        for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+            counts[i] += other.counts[i];
+        }
+    }
+    
+    void subtract(const Snapshot& earlier) {
+        for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+            counts[i] -= earlier.counts[i];
+        }
+    }
+    
+    // Ticks that percentile% of samples are at or below (bucket top)
+    uint64_t percentile(double percentile) const {
+        uint64_t total = count();
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t target = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total) + 0.5);
+        if (target == 0) {
+            target = 1;
+        }
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+            seen += counts[i];
+            if (seen >= target) {
+                return bucket_top(i);
+            }
+        }
+        return bucket_top(BUCKET_COUNT - 1);
+    }
+};
+
+// What the stats reporter prints
+struct Summary {
+    uint64_t count;
+    double p50_us;
+    double p99_us;
+    double p999_us;
+    double max_us;
+};
+
+inline Summary summarize(const Snapshot& snapshot) {
+    double us_per_tick = ns_per_tick() / 1000.0;
+    Summary summary;
+    summary.count = snapshot.count();
+    summary.p50_us = snapshot.percentile(50.0) * us_per_tick;
+    summary.p99_us = snapshot.percentile(99.0) * us_per_tick;
+    summary.p999_us = snapshot.percentile(99.9) * us_per_tick;
+    summary.max_us = snapshot.percentile(100.0) * us_per_tick;
+    return summary;
+}
+
+// =============================================================================
+// HISTOGRAM
+// =============================================================================
+// Written by one thread, snapshotted by any other. The writer's increment
+// is a relaxed load and store (no locked instruction); a reader may miss
+// the samples of the last few nanoseconds, never tear a count.
+class Histogram {
+public:
+    Histogram() {
+        for (auto& count : counts_) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+    
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+    
+    void record(uint64_t ticks) {
+        std::atomic<uint64_t>& count = counts_[bucket_of(ticks)];
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    
+    // Ticks elapsed since start, recorded
+    void record_since(uint64_t start) {
+        record(read_tsc() - start);
+    }
+    
+    void snapshot(Snapshot& out) const {
+        for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+            out.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> counts_;
+};
+
+} // namespace latency
+} // namespace matching
+
+#endif // MATCHING_LATENCY_H
@@ -0,0 +1,674 @@
+#ifndef MATCHING_LOGGER_H
+#define MATCHING_LOGGER_H
+
+#include "spsc_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <pthread.h>
+#include <signal.h>
+
+namespace matching {
+namespace logging {
+
+// =============================================================================
+// ASYNCHRONOUS BINARY LOGGER
+// =============================================================================
+// Hot paths never format text or touch a stream. A log call copies its
+// format id (the address of a static LogFormat at the call site) and its
+// raw arguments into a fixed-size record in the calling thread's own SPSC
+// ring. One background thread merges every ring by timestamp, formats the
+// records and writes them out.
+//
+//   MX_LOG_INFO("[Gateway] Client {} connected (fd={})", address, fd);
+//   MX_AUDIT("NEW_ORDER user={} qty={}", msg.user_id, msg.quantity);
+//
+// "{}" takes the next argument. Arguments are taken by value (packed
+// protocol fields can be passed straight in): integers, enums, floating
+// point, C strings, std::string and LogText, a bounded view for fixed-size
+// char fields (log_text(msg.symbol)). Strings are copied, truncated to
+// what fits the record.
+//
+// Levels below MX_LOG_LEVEL are compiled out; the rest are filtered at
+// runtime with set_level(). Audit records are a separate trail, switched
+// with set_audit() and optionally written to their own file.
+//
+// Before start() and after stop() records are formatted and written
+// synchronously, so nothing logged outside a running session is lost.
+
+// 0 = TRACE, 1 = INFO, 2 = WARN, 3 = ERROR, 4 = none
+#ifndef MX_LOG_LEVEL
+#define MX_LOG_LEVEL 0
+#endif
+
+enum class LogLevel : uint8_t {
+    TRACE = 0,      // Per-message detail
+    INFO = 1,
+    WARN = 2,
+    ERROR = 3,
+    AUDIT = 4,      // Request audit trail, not a severity
+};
+
+inline const char* log_level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::TRACE: return "TRACE";
+        case LogLevel::INFO:  return "INFO ";
+        case LogLevel::WARN:  return "WARN ";
+        case LogLevel::ERROR: return "ERROR";
+        case LogLevel::AUDIT: return "AUDIT";
+        default:              return "?    ";
+    }
+}
+
+inline bool parse_log_level(const std::string& text, LogLevel& level) {
+    if (text == "trace" || text == "debug") {
+        level = LogLevel::TRACE;
+    } else if (text == "info") {
+        level = LogLevel::INFO;
+    } else if (text == "warn") {
+        level = LogLevel::WARN;
+    } else if (text == "error") {
+        level = LogLevel::ERROR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// One per call site; its address identifies the format in a record
+struct LogFormat {
+    LogLevel level;
+    const char* text;
+};
+
+// Bounded string argument, e.g. a protocol symbol that need not be
+// NUL-terminated
+struct LogText {
+    const char* data;
+    size_t size;
+};
+
+template <size_t N>
+LogText log_text(const char (&text)[N]) {
+    return LogText{text, strnlen(text, N)};
+}
+
+// =============================================================================
+// LOG RECORD
+// =============================================================================
+enum class LogArgType : uint8_t {
+    SIGNED,         // int64_t
+    UNSIGNED,       // uint64_t
+    DOUBLE,         // double
+    STRING,         // uint8_t length, then the bytes
+};
+
+constexpr uint32_t LOG_MAX_ARGS = 7;
+
+struct alignas(64) LogRecord {
+    const LogFormat* format;
+    uint64_t timestamp_ns;      // CLOCK_REALTIME
+    uint8_t arg_count;
+    uint8_t arg_types[LOG_MAX_ARGS];
+    uint8_t payload[104];
+};
+
+static_assert(sizeof(LogRecord) == 128, "LogRecord must be two cache lines");
+
+// Serialises arguments into a record's payload; arguments that do not fit
+// (or past LOG_MAX_ARGS) are left out and print as "?"
+class LogRecordWriter {
+public:
+    explicit LogRecordWriter(LogRecord& record)
+        : record_(record)
+        , used_(0)
+    {
+        record_.arg_count = 0;
+    }
+    
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+    add(T value) {
+        int64_t wide = value;
+        put(LogArgType::SIGNED, &wide, sizeof(wide));
+    }
+    
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+    add(T value) {
+        uint64_t wide = value;
+        put(LogArgType::UNSIGNED, &wide, sizeof(wide));
+    }
+    
+    template <typename T>
+    typename std::enable_if<std::is_enum<T>::value>::type
+    add(T value) {
+        add(static_cast<typename std::underlying_type<T>::type>(value));
+    }
+    
+    template <typename T>
+    typename std::enable_if<std::is_floating_point<T>::value>::type
+    add(T value) {
+        double wide = value;
+        put(LogArgType::DOUBLE, &wide, sizeof(wide));
+    }
+    
+    void add(LogText text) { add_string(text.data, text.size); }
+    void add(const char* text) { add_string(text ? text : "(null)", text ? strlen(text) : 6); }
+    void add(const std::string& text) { add_string(text.data(), text.size()); }
+    
+    void add_string(const char* text, size_t length) {
+        if (record_.arg_count >= LOG_MAX_ARGS || used_ + 1 > sizeof(record_.payload)) {
+            return;
+        }
+        length = std::min(length, std::min<size_t>(255, sizeof(record_.payload) - used_ - 1));
+        record_.payload[used_] = static_cast<uint8_t>(length);
+        memcpy(record_.payload + used_ + 1, text, length);
+        used_ += 1 + length;
+        record_.arg_types[record_.arg_count++] = static_cast<uint8_t>(LogArgType::STRING);
+    }
+
+private:
+    void put(LogArgType type, const void* value, size_t size) {
+        if (record_.arg_count >= LOG_MAX_ARGS || used_ + size > sizeof(record_.payload)) {
+            return;
+        }
+        memcpy(record_.payload + used_, value, size);
+        used_ += size;
+        record_.arg_types[record_.arg_count++] = static_cast<uint8_t>(type);
+    }
+    
+    LogRecord& record_;
+    size_t used_;
+};
+
+// =============================================================================
+// CONFIGURATION
+// =============================================================================
+struct LogConfig {
+    LogLevel level;
+    bool audit;
+    std::string log_path;       // Empty = stdout
+    std::string audit_path;     // Empty = with the log
+    uint32_t ring_capacity;     // Records per thread
+    
+    LogConfig()
+        : level(LogLevel::INFO)
+        , audit(true)
+        , ring_capacity(8192)
+    {}
+};
+
+// =============================================================================
+// LOGGER
+// =============================================================================
+class Logger {
+public:
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+    
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+    
+    // Open the outputs and start the formatter thread
+    bool start(const LogConfig& config) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        
+        if (!config.log_path.empty() && !open_output(config.log_path, log_file_)) {
+            return false;
+        }
+        if (!config.audit_path.empty() && !open_output(config.audit_path, audit_file_)) {
+            return false;
+        }
+        
+        ring_capacity_ = config.ring_capacity;
+        level_.store(config.level, std::memory_order_relaxed);
+        audit_.store(config.audit, std::memory_order_relaxed);
+        running_.store(true, std::memory_order_release);
+        
+        // Signals stay with the threads that wait on them
+        sigset_t signals, previous;
+        sigfillset(&signals);
+        pthread_sigmask(SIG_BLOCK, &signals, &previous);
+        thread_ = std::thread(&Logger::run, this);
+        pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+        return true;
+    }
+    
+    // Write out everything logged so far and stop the formatter thread
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_.exchange(false, std::memory_order_seq_cst)) {
+                return;
+            }
+        }
+        thread_.join();
+        
+        // Writers that saw running_ before it dropped finish publishing
+        // before the last drain; any later write() goes synchronous
+        uint32_t count = ring_count_.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < count; i++) {
+            ThreadRing* ring = rings_[i].load(std::memory_order_acquire);
+            while (ring->writing.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (drain_one()) {
+        }
+        report_drops();
+        flush_outputs();
+    }
+    
+    void set_level(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+    LogLevel level() const { return level_.load(std::memory_order_relaxed); }
+    void set_audit(bool enabled) { audit_.store(enabled, std::memory_order_relaxed); }
+    
+    bool enabled(LogLevel level) const {
+        if (level == LogLevel::AUDIT) {
+            return audit_.load(std::memory_order_relaxed);
+        }
+        return level >= level_.load(std::memory_order_relaxed);
+    }
+    
+    // Records lost to full rings since start()
+    uint64_t dropped() const {
+        uint64_t total = 0;
+        uint32_t count = ring_count_.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < count; i++) {
+            total += rings_[i].load(std::memory_order_acquire)->dropped.load(std::memory_order_relaxed);
+        }
+        return total + unregistered_drops_.load(std::memory_order_relaxed);
+    }
+    
+    template <typename... Args>
+    void write(const LogFormat& format, Args... args) {
+        if (!running_.load(std::memory_order_acquire)) {
+            write_now(format, args...);
+            return;
+        }
+        
+        ThreadRing* ring = thread_ring();
+        if (!ring) {
+            unregistered_drops_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        
+        // Flag the write before checking running_ again: stop() either
+        // waits for it or this call sees the logger stopped
+        ring->writing.store(true, std::memory_order_seq_cst);
+        if (running_.load(std::memory_order_seq_cst)) {
+            enqueue(*ring, format, args...);
+            ring->writing.store(false, std::memory_order_release);
+            return;
+        }
+        ring->writing.store(false, std::memory_order_relaxed);
+        write_now(format, args...);
+    }
+
+private:
+    static constexpr uint32_t MAX_THREADS = 64;
+    static constexpr uint32_t FORMAT_BATCH = 256;
+    
+    struct ThreadRing {
+        SpscQueue<LogRecord> queue;
+        std::atomic<uint64_t> dropped;
+        std::atomic<bool> writing;      // Between the running_ check and publish
+        
+        explicit ThreadRing(uint32_t capacity)
+            : queue(capacity)
+            , dropped(0)
+            , writing(false)
+        {}
+    };
+    
+    Logger()
+        : level_(LogLevel::INFO)
+        , audit_(true)
+        , running_(false)
+        , ring_count_(0)
+        , unregistered_drops_(0)
+        , reported_drops_(0)
+        , ring_capacity_(8192)
+        , log_file_(nullptr)
+        , audit_file_(nullptr)
+        , clock_second_(-1)
+    {
+        for (auto& ring : rings_) {
+            ring.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    
+    // Rings live as long as the process, so a record published by a thread
+    // that has since exited is still written
+    ~Logger() {
+        stop();
+        uint32_t count = ring_count_.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < count; i++) {
+            delete rings_[i].load(std::memory_order_relaxed);
+        }
+        if (log_file_) {
+            fclose(log_file_);
+        }
+        if (audit_file_) {
+            fclose(audit_file_);
+        }
+    }
+    
+    // -------------------------------------------------------------------------
+    // PRODUCER SIDE
+    // -------------------------------------------------------------------------
+    
+    ThreadRing* thread_ring() {
+        static thread_local ThreadRing* ring = nullptr;
+        static thread_local bool registered = false;
+        if (!registered) {
+            registered = true;
+            std::lock_guard<std::mutex> lock(mutex_);
+            uint32_t count = ring_count_.load(std::memory_order_relaxed);
+            if (count < MAX_THREADS) {
+                ring = new ThreadRing(ring_capacity_);
+                rings_[count].store(ring, std::memory_order_release);
+                ring_count_.store(count + 1, std::memory_order_release);
+            }
+        }
+        return ring;
+    }
+    
+    static uint64_t now_ns() {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    }
+    
+    // TRACE / INFO / WARN are dropped when the ring is full; errors
+    // and the audit trail wait for the formatter instead
+    template <typename... Args>
+    void enqueue(ThreadRing& ring, const LogFormat& format, const Args&... args) {
+        LogRecord* record = ring.queue.try_claim();
+        if (!record) {
+            if (format.level < LogLevel::ERROR) {
+                ring.dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            uint32_t idle_rounds = 0;
+            while (!(record = ring.queue.try_claim())) {
+                if (!running_.load(std::memory_order_acquire)) {
+                    ring.dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                idle_backoff(idle_rounds);
+            }
+        }
+        
+        fill(*record, format, args...);
+        ring.queue.publish();
+    }
+    
+    template <typename... Args>
+    static void fill(LogRecord& record, const LogFormat& format, const Args&... args) {
+        record.format = &format;
+        record.timestamp_ns = now_ns();
+        LogRecordWriter writer(record);
+        int expand[] = {0, (writer.add(args), 0)...};
+        (void)expand;
+    }
+    
+    template <typename... Args>
+    void write_now(const LogFormat& format, const Args&... args) {
+        LogRecord record;
+        fill(record, format, args...);
+        std::lock_guard<std::mutex> lock(mutex_);
+        format_record(record);
+        flush_outputs();
+    }
+    
+    // -------------------------------------------------------------------------
+    // FORMATTER SIDE (always under mutex_)
+    // -------------------------------------------------------------------------
+    
+    void run() {
+        uint32_t idle_rounds = 0;
+        while (running_.load(std::memory_order_acquire)) {
+            uint32_t written = 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                while (written < FORMAT_BATCH && drain_one()) {
+                    written++;
+                }
+                if (written < FORMAT_BATCH) {
+                    // Caught up: push the text out
+                    report_drops();
+                    flush_outputs();
+                }
+            }
+            if (written > 0) {
+                idle_rounds = 0;
+            } else if (++idle_rounds < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+    
+    // Format the oldest record at the front of any ring
+    bool drain_one() {
+        ThreadRing* oldest = nullptr;
+        LogRecord* record = nullptr;
+        uint32_t count = ring_count_.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < count; i++) {
+            ThreadRing* ring = rings_[i].load(std::memory_order_acquire);
+            LogRecord* front = ring->queue.front();
+            if (front && (!record || front->timestamp_ns < record->timestamp_ns)) {
+                oldest = ring;
+                record = front;
+            }
+        }
+        if (!record) {
+            return false;
+        }
+        
+        format_record(*record);
+        oldest->queue.pop();
+        return true;
+    }
+    
+    void report_drops() {
+        uint64_t total = dropped();
+        if (total != reported_drops_) {
+            static const LogFormat format = {LogLevel::WARN, "[Log] {} records dropped, rings full"};
+            LogRecord record;
+            fill(record, format, total - reported_drops_);
+            format_record(record);
+            reported_drops_ = total;
+        }
+    }
+    
+    void format_record(const LogRecord& record) {
+        std::string& line = line_;
+        line.clear();
+        append_time(line, record.timestamp_ns);
+        line += ' ';
+        line += log_level_name(record.format->level);
+        line += ' ';
+        
+        size_t offset = 0;
+        uint8_t arg = 0;
+        for (const char* text = record.format->text; *text; text++) {
+            if (text[0] != '{' || text[1] != '}') {
+                line += *text;
+                continue;
+            }
+            text++;
+            if (arg >= record.arg_count) {
+                line += '?';
+                continue;
+            }
+            append_arg(line, record, static_cast<LogArgType>(record.arg_types[arg++]), offset);
+        }
+        line += '\n';
+        
+        FILE* out = log_file_ ? log_file_ : stdout;
+        if (record.format->level == LogLevel::AUDIT && audit_file_) {
+            out = audit_file_;
+        }
+        fwrite(line.data(), 1, line.size(), out);
+    }
+    
+    static void append_arg(std::string& line, const LogRecord& record, LogArgType type, size_t& offset) {
+        char number[32];
+        switch (type) {
+            case LogArgType::SIGNED: {
+                int64_t value;
+                memcpy(&value, record.payload + offset, sizeof(value));
+                offset += sizeof(value);
+                snprintf(number, sizeof(number), "%lld", static_cast<long long>(value));
+                line += number;
+                break;
+            }
+            case LogArgType::UNSIGNED: {
+                uint64_t value;
+                memcpy(&value, record.payload + offset, sizeof(value));
+                offset += sizeof(value);
+                snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(value));
+                line += number;
+                break;
+            }
+            case LogArgType::DOUBLE: {
+                double value;
+                memcpy(&value, record.payload + offset, sizeof(value));
+                offset += sizeof(value);
+                snprintf(number, sizeof(number), "%g", value);
+                line += number;
+                break;
+            }
+            case LogArgType::STRING: {
+                size_t length = record.payload[offset];
+                line.append(reinterpret_cast<const char*>(record.payload + offset + 1), length);
+                offset += 1 + length;
+                break;
+            }
+        }
+    }
+    
+    // HH:MM:SS.uuuuuu local time; the broken-down second is cached
+    void append_time(std::string& line, uint64_t timestamp_ns) {
+        time_t seconds = static_cast<time_t>(timestamp_ns / 1000000000ull);
+        if (seconds != clock_second_) {
+            struct tm local;
+            localtime_r(&seconds, &local);
+            snprintf(clock_text_, sizeof(clock_text_), "%02d:%02d:%02d", local.tm_hour, local.tm_min, local.tm_sec);
+            clock_second_ = seconds;
+        }
+        char micros[16];
+        snprintf(micros, sizeof(micros), ".%06u", static_cast<unsigned>((timestamp_ns / 1000) % 1000000));
+        line += clock_text_;
+        line += micros;
+    }
+    
+    void flush_outputs() {
+        fflush(log_file_ ? log_file_ : stdout);
+        if (audit_file_) {
+            fflush(audit_file_);
+        }
+    }
+    
+    static bool open_output(const std::string& path, FILE*& file) {
+        if (file) {
+            fclose(file);
+        }
+        file = fopen(path.c_str(), "a");
+        if (!file) {
+            fprintf(stderr, "[Log] Cannot open %s: %s\n", path.c_str(), strerror(errno));
+            return false;
+        }
+        return true;
+    }
+    
+    std::atomic<LogLevel> level_;
+    std::atomic<bool> audit_;
+    std::atomic<bool> running_;
+    
+    std::atomic<ThreadRing*> rings_[MAX_THREADS];
+    std::atomic<uint32_t> ring_count_;
+    std::atomic<uint64_t> unregistered_drops_;
+    uint64_t reported_drops_;
+    uint32_t ring_capacity_;
+    
+    std::mutex mutex_;          // Registration, start / stop, synchronous writes
+    std::thread thread_;
+    FILE* log_file_;
+    FILE* audit_file_;
+    std::string line_;
+    time_t clock_second_;
+    char clock_text_[16];
+};
+
+} // namespace logging
+} // namespace matching
+
+// =============================================================================
+// LOGGING MACROS
+// =============================================================================
+#define MX_LOG(level, text, ...)                                                        \
+    do {                                                                                \
+        static const ::matching::logging::LogFormat mx_log_format_ = {level, text};     \
+        ::matching::logging::Logger& mx_logger_ = ::matching::logging::Logger::instance(); \
+        if (mx_logger_.enabled(level)) {                                                \
+            mx_logger_.write(mx_log_format_, ##__VA_ARGS__);                            \
+        }                                                                               \
+    } while (0)
+
+// Compiled out, but still type-checked
+#define MX_LOG_DISABLED(level, text, ...)                                               \
+    do {                                                                                \
+        if (false) {                                                                    \
+            MX_LOG(level, text, ##__VA_ARGS__);                                         \
+        }                                                                               \
+    } while (0)
+
+#if MX_LOG_LEVEL <= 0
+#define MX_LOG_TRACE(text, ...) MX_LOG(::matching::logging::LogLevel::TRACE, text, ##__VA_ARGS__)
+#else
+#define MX_LOG_TRACE(text, ...) MX_LOG_DISABLED(::matching::logging::LogLevel::TRACE, text, ##__VA_ARGS__)
+#endif
+
+#if MX_LOG_LEVEL <= 1
+#define MX_LOG_INFO(text, ...) MX_LOG(::matching::logging::LogLevel::INFO, text, ##__VA_ARGS__)
+#else
+#define MX_LOG_INFO(text, ...) MX_LOG_DISABLED(::matching::logging::LogLevel::INFO, text, ##__VA_ARGS__)
+#endif
+
+#if MX_LOG_LEVEL <= 2
+#define MX_LOG_WARN(text, ...) MX_LOG(::matching::logging::LogLevel::WARN, text, ##__VA_ARGS__)
+#else
+#define MX_LOG_WARN(text, ...) MX_LOG_DISABLED(::matching::logging::LogLevel::WARN, text, ##__VA_ARGS__)
+#endif
+
+#if MX_LOG_LEVEL <= 3
+#define MX_LOG_ERROR(text, ...) MX_LOG(::matching::logging::LogLevel::ERROR, text, ##__VA_ARGS__)
+#else
+#define MX_LOG_ERROR(text, ...) MX_LOG_DISABLED(::matching::logging::LogLevel::ERROR, text, ##__VA_ARGS__)
+#endif
+
+// The audit trail is never compiled out; set_audit(false) turns it off
+#define MX_AUDIT(text, ...) MX_LOG(::matching::logging::LogLevel::AUDIT, text, ##__VA_ARGS__)
+
+#endif // MATCHING_LOGGER_H
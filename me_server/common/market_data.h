@@ -0,0 +1,247 @@
+#ifndef MATCHING_MARKET_DATA_H
+#define MATCHING_MARKET_DATA_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace matching {
+namespace market_data {
+
+// =============================================================================
+// L2 MARKET DATA FEED
+// =============================================================================
+// Full-depth price level feed, published by the engine over UDP:
+//
+//   Incremental (multicast)  Every level change as it happens, ADD / MODIFY /
+//                            DELETE per price level, gap-free sequence
+//   Snapshot (multicast)     Periodic full book per symbol, stamped with
+//                            the last incremental sequence it reflects
+//   Recovery (unicast)       Retransmission of recent incremental packets,
+//                            and conflated per-subscriber streams
+//
+// A datagram is one PacketHeader followed by message_count messages, each
+// starting with type and length. Messages carry a per-channel sequence;
+// the packet header holds the first one, so a receiver expecting N that
+// sees a higher sequence has lost sequence - N messages. An empty packet
+// is a heartbeat carrying the next sequence.
+//
+// Recovery: ask the publisher's recovery port to retransmit the missing
+// range (RetransmitRequest). If it is no longer kept the answer is a
+// RetransmitReject; wait for the symbol's next snapshot instead, apply it
+// and then every incremental message after its last_sequence.
+//
+// The recovery port only answers requesters that can receive at their
+// source address: a request without a valid token is answered with a
+// RecoveryChallenge, smaller than the request, and the token it carries
+// goes into every later request from that address. Tokens change every
+// minute; a stale one is challenged again. Replies to each address are
+// also capped per second.
+//
+// All integers are little-endian, as on the wire protocol.
+
+constexpr uint32_t MD_MAGIC = 0x324C584D;       // "MXL2"
+constexpr uint8_t MD_VERSION = 1;
+constexpr size_t MD_MAX_PACKET = 1400;          // Fits an Ethernet MTU with headroom
+
+enum class Channel : uint8_t {
+    INCREMENTAL = 1,
+    SNAPSHOT    = 2,
+    RETRANSMIT  = 3,    // Replayed incremental packets (unicast)
+    CONFLATED   = 4,    // Per-subscriber conflated stream (unicast)
+};
+
+enum class MdMessageType : uint8_t {
+    LEVEL_UPDATE        = 0x01,
+    SYMBOL_DEFINITION   = 0x02,
+    SNAPSHOT_BEGIN      = 0x03,
+    
+    // Subscriber -> publisher (recovery port)
+    RETRANSMIT_REQUEST  = 0x10,
+    SUBSCRIBE           = 0x11,
+    UNSUBSCRIBE         = 0x12,
+    
+    // Publisher -> subscriber (recovery port)
+    RETRANSMIT_REJECT   = 0x20,
+    CHALLENGE           = 0x21,
+};
+
+enum class LevelAction : uint8_t {
+    ADD     = 0x00,
+    MODIFY  = 0x01,     // Conflated streams send MODIFY for new levels too
+    DELETE  = 0x02,
+};
+
+// =============================================================================
+// PACKET HEADER (24 bytes)
+// =============================================================================
+struct PacketHeader {
+    uint32_t magic;
+    uint8_t  version;
+    uint8_t  channel;           // Channel
+    uint16_t message_count;
+    uint64_t sequence;          // Sequence of the first message (next one if empty)
+    uint64_t send_time;         // Nanoseconds since epoch
+    
+    PacketHeader()
+        : magic(MD_MAGIC)
+        , version(MD_VERSION)
+        , channel(0)
+        , message_count(0)
+        , sequence(0)
+        , send_time(0)
+    {}
+} __attribute__((packed));
+
+static_assert(sizeof(PacketHeader) == 24, "PacketHeader must be 24 bytes");
+
+// =============================================================================
+// LEVEL UPDATE (32 bytes)
+// =============================================================================
+// Aggregate state of one price level after the change; DELETE carries
+// zero quantity and orders
+struct LevelUpdate {
+    uint8_t  type;              // LEVEL_UPDATE
+    uint8_t  length;
+    uint8_t  action;            // LevelAction
+    uint8_t  side;              // protocol::Side
+    uint32_t symbol_id;         // From SYMBOL_DEFINITION
+    uint64_t price;
+    uint64_t quantity;          // Total resting quantity at the level
+    uint32_t order_count;
+    uint32_t reserved;
+    
+    LevelUpdate()
+        : type(static_cast<uint8_t>(MdMessageType::LEVEL_UPDATE))
+        , length(sizeof(LevelUpdate))
+        , action(0)
+        , side(0)
+        , symbol_id(0)
+        , price(0)
+        , quantity(0)
+        , order_count(0)
+        , reserved(0)
+    {}
+} __attribute__((packed));
+
+static_assert(sizeof(LevelUpdate) == 32, "LevelUpdate must be 32 bytes");
+
+// =============================================================================
+// SYMBOL DEFINITION (24 bytes)
+// =============================================================================
+// Sent on the incremental channel when a symbol is added, and at the start
+// of every snapshot cycle
+struct SymbolDefinition {
+    uint8_t  type;              // SYMBOL_DEFINITION
+    uint8_t  length;
+    uint16_t reserved;
+    uint32_t symbol_id;
+    char     symbol[16];
+    
+    SymbolDefinition()
+        : type(static_cast<uint8_t>(MdMessageType::SYMBOL_DEFINITION))
+        , length(sizeof(SymbolDefinition))
+        , reserved(0)
+        , symbol_id(0)
+    {
+        memset(symbol, 0, sizeof(symbol));
+    }
+} __attribute__((packed));
+
+static_assert(sizeof(SymbolDefinition) == 24, "SymbolDefinition must be 24 bytes");
+
+// =============================================================================
+// SNAPSHOT BEGIN (24 bytes)
+// =============================================================================
+// Starts one symbol's snapshot; bid_levels + ask_levels LEVEL_UPDATE ADDs
+// follow on the snapshot channel, best price first on each side
+struct SnapshotBegin {
+    uint8_t  type;              // SNAPSHOT_BEGIN
+    uint8_t  length;
+    uint16_t reserved;
+    uint32_t symbol_id;
+    uint64_t last_sequence;     // Last incremental message the snapshot includes
+    uint32_t bid_levels;
+    uint32_t ask_levels;
+    
+    SnapshotBegin()
+        : type(static_cast<uint8_t>(MdMessageType::SNAPSHOT_BEGIN))
+        , length(sizeof(SnapshotBegin))
+        , reserved(0)
+        , symbol_id(0)
+        , last_sequence(0)
+        , bid_levels(0)
+        , ask_levels(0)
+    {}
+} __attribute__((packed));
+
+static_assert(sizeof(SnapshotBegin) == 24, "SnapshotBegin must be 24 bytes");
+
+// =============================================================================
+// RECOVERY REQUESTS (sent alone in a datagram, no packet header)
+// =============================================================================
+struct RecoveryRequest {
+    uint32_t magic;
+    uint8_t  type;              // RETRANSMIT_REQUEST / SUBSCRIBE / UNSUBSCRIBE
+    uint8_t  reserved[3];
+    uint64_t first_sequence;    // RETRANSMIT_REQUEST: first incremental message wanted
+    uint32_t count;             // RETRANSMIT_REQUEST: messages wanted
+    uint32_t window_us;         // SUBSCRIBE: conflation window (0 = publisher default)
+    uint64_t token;             // From the last CHALLENGE (0 on first contact)
+    
+    RecoveryRequest()
+        : magic(MD_MAGIC)
+        , type(0)
+        , first_sequence(0)
+        , count(0)
+        , window_us(0)
+        , token(0)
+    {
+        memset(reserved, 0, sizeof(reserved));
+    }
+} __attribute__((packed));
+
+static_assert(sizeof(RecoveryRequest) == 32, "RecoveryRequest must be 32 bytes");
+
+// Answer to a request without a valid token (sent alone in a datagram, no
+// packet header). Repeat the request with this token.
+struct RecoveryChallenge {
+    uint32_t magic;
+    uint8_t  type;              // CHALLENGE
+    uint8_t  reserved[3];
+    uint64_t token;
+    
+    RecoveryChallenge()
+        : magic(MD_MAGIC)
+        , type(static_cast<uint8_t>(MdMessageType::CHALLENGE))
+        , token(0)
+    {
+        memset(reserved, 0, sizeof(reserved));
+    }
+} __attribute__((packed));
+
+static_assert(sizeof(RecoveryChallenge) == 16, "RecoveryChallenge must be 16 bytes");
+
+// Answer to a retransmit request for messages no longer kept (inside a
+// RETRANSMIT packet)
+struct RetransmitReject {
+    uint8_t  type;              // RETRANSMIT_REJECT
+    uint8_t  length;
+    uint16_t reserved;
+    uint32_t reserved2;
+    uint64_t first_available;   // Oldest incremental message still kept
+    
+    RetransmitReject()
+        : type(static_cast<uint8_t>(MdMessageType::RETRANSMIT_REJECT))
+        , length(sizeof(RetransmitReject))
+        , reserved(0)
+        , reserved2(0)
+        , first_available(0)
+    {}
+} __attribute__((packed));
+
+static_assert(sizeof(RetransmitReject) == 16, "RetransmitReject must be 16 bytes");
+
+} // namespace market_data
+} // namespace matching
+
+#endif // MATCHING_MARKET_DATA_H
@@ -1,6 +1,7 @@
 #ifndef MATCHING_ENGINE_PROTOCOL_H
 #define MATCHING_ENGINE_PROTOCOL_H
 
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <string>
@@ -21,12 +22,14 @@ enum class MessageType : uint8_t {
     NEW_ORDER           = 0x01,
     CANCEL_ORDER        = 0x02,
     REPLACE_ORDER       = 0x03,
+    MASS_CANCEL         = 0x04,
     
     // Engine → Client (Responses)
     ORDER_ACK           = 0x10,
     ORDER_REJECT        = 0x11,
     ORDER_CANCELLED     = 0x12,
     ORDER_REPLACED      = 0x13,
+    MASS_CANCEL_ACK     = 0x14,
     
     // Engine → Client (Executions)
     EXECUTION           = 0x20,
@@ -37,7 +40,7 @@ enum class MessageType : uint8_t {
     
     // System
     HEARTBEAT           = 0xF0,
-    LOGON               = 0xF1,
+    LOGON               = 0xF1,     // Version and symbol negotiation
     LOGOUT              = 0xF2,
 };
 
@@ -79,14 +82,14 @@ enum class RejectReason : uint8_t {
 struct MessageHeader {
     uint8_t  version;       // Protocol version
     uint8_t  type;          // MessageType
-    uint16_t reserved;      // For alignment and future use
+    uint16_t stream;        // Sequence stream (engine shard + 1, 0 = unsharded)
     uint32_t length;        // Total message length (including header)
     uint64_t sequence;      // Sequence number for ordering/gap detection
     
     MessageHeader() 
         : version(PROTOCOL_VERSION)
         , type(0)
-        , reserved(0)
+        , stream(0)
         , length(sizeof(MessageHeader))
         , sequence(0)
     {}
@@ -184,6 +187,71 @@ struct CancelOrderMessage {
     }
 } __attribute__((packed));
 
+// =============================================================================
+// REPLACE ORDER MESSAGE
+// =============================================================================
+// Amends a resting order in place: a same-price reduction keeps time
+// priority, anything else queues it behind the new price level
+struct ReplaceOrderMessage {
+    MessageHeader header;
+    
+    char     symbol[16];            // Symbol
+    uint64_t client_order_id;       // Order to replace
+    uint64_t new_client_order_id;   // ID from now on (0 = keep client_order_id)
+    uint64_t user_id;               // User identifier
+    uint64_t price;                 // New price
+    uint64_t quantity;              // New total quantity, filled quantity included
+    uint64_t timestamp;             // Client timestamp
+    
+    ReplaceOrderMessage()
+        : header()
+        , client_order_id(0)
+        , new_client_order_id(0)
+        , user_id(0)
+        , price(0)
+        , quantity(0)
+        , timestamp(0)
+    {
+        memset(symbol, 0, sizeof(symbol));
+        header.set_type(MessageType::REPLACE_ORDER);
+        header.length = sizeof(ReplaceOrderMessage);
+    }
+    
+    void set_symbol(const std::string& sym) {
+        strncpy(symbol, sym.c_str(), sizeof(symbol) - 1);
+        symbol[sizeof(symbol) - 1] = '\0';
+    }
+    
+    std::string get_symbol() const {
+        return std::string(symbol, strnlen(symbol, sizeof(symbol)));
+    }
+} __attribute__((packed));
+
+// =============================================================================
+// MASS CANCEL MESSAGE
+// =============================================================================
+// Cancels every resting order of user_id on every symbol; side 0 = both,
+// otherwise a Side
+struct MassCancelMessage {
+    MessageHeader header;
+    
+    uint64_t user_id;           // User whose orders are cancelled
+    uint8_t  side;              // 0 = both, else Side enum
+    uint8_t  reserved[7];       // Alignment
+    uint64_t timestamp;         // Client timestamp
+    
+    MassCancelMessage()
+        : header()
+        , user_id(0)
+        , side(0)
+        , reserved{0}
+        , timestamp(0)
+    {
+        header.set_type(MessageType::MASS_CANCEL);
+        header.length = sizeof(MassCancelMessage);
+    }
+} __attribute__((packed));
+
 // =============================================================================
 // ORDER ACKNOWLEDGEMENT
 // =============================================================================
@@ -243,6 +311,61 @@ struct OrderRejectMessage {
     }
 } __attribute__((packed));
 
+// =============================================================================
+// ORDER REPLACED
+// =============================================================================
+// Sent before any execution the new price causes
+struct OrderReplacedMessage {
+    MessageHeader header;
+    
+    uint64_t orig_client_order_id;  // ID the replace named
+    uint64_t client_order_id;       // ID from now on
+    uint64_t exchange_order_id;     // Unchanged by a replace
+    uint64_t user_id;
+    uint64_t price;
+    uint64_t quantity;              // New total quantity
+    uint64_t leaves_quantity;       // Open after the replace
+    uint64_t timestamp;
+    
+    OrderReplacedMessage()
+        : header()
+        , orig_client_order_id(0)
+        , client_order_id(0)
+        , exchange_order_id(0)
+        , user_id(0)
+        , price(0)
+        , quantity(0)
+        , leaves_quantity(0)
+        , timestamp(0)
+    {
+        header.set_type(MessageType::ORDER_REPLACED);
+        header.length = sizeof(OrderReplacedMessage);
+    }
+} __attribute__((packed));
+
+// =============================================================================
+// MASS CANCEL ACKNOWLEDGEMENT
+// =============================================================================
+// Sent after the ORDER_CANCELLED of every order a mass cancel removed (one
+// per engine shard when sharded)
+struct MassCancelAckMessage {
+    MessageHeader header;
+    
+    uint64_t user_id;
+    uint64_t cancelled_count;   // Orders cancelled
+    uint64_t timestamp;
+    
+    MassCancelAckMessage()
+        : header()
+        , user_id(0)
+        , cancelled_count(0)
+        , timestamp(0)
+    {
+        header.set_type(MessageType::MASS_CANCEL_ACK);
+        header.length = sizeof(MassCancelAckMessage);
+    }
+} __attribute__((packed));
+
 // =============================================================================
 // EXECUTION REPORT (Trade Fill)
 // =============================================================================
@@ -371,6 +494,203 @@ struct HeartbeatMessage {
     }
 } __attribute__((packed));
 
+// =============================================================================
+// LOGON (Session setup, gateway only)
+// =============================================================================
+// Always sent with a v1 header, as the first message of a session. The
+// client offers the highest version it speaks and the symbols it will
+// trade; the gateway answers with the same message carrying the version
+// granted. Under v2 a symbol is then named by its position in this list.
+// Followed by symbol_count 16-byte symbol names.
+struct LogonMessage {
+    MessageHeader header;
+    
+    uint64_t user_id;           // User every v2 order is sent for
+    uint8_t  version;           // Offered (client) / granted (gateway)
+    uint8_t  reserved;
+    uint16_t symbol_count;      // Symbols after the message
+    uint32_t reserved2;
+    uint64_t timestamp;
+    
+    LogonMessage()
+        : header()
+        , user_id(0)
+        , version(PROTOCOL_VERSION)
+        , reserved(0)
+        , symbol_count(0)
+        , reserved2(0)
+        , timestamp(0)
+    {
+        header.set_type(MessageType::LOGON);
+        header.length = sizeof(LogonMessage);
+    }
+    
+    static constexpr size_t size_for(uint16_t symbols) {
+        return sizeof(LogonMessage) + static_cast<size_t>(symbols) * 16;
+    }
+    
+    const char* symbol(uint16_t index) const {
+        return reinterpret_cast<const char*>(this + 1) + static_cast<size_t>(index) * 16;
+    }
+} __attribute__((packed));
+
+// =============================================================================
+// PROTOCOL V2
+// =============================================================================
+// Compact encoding granted at LOGON. A frame is an 8-byte header followed
+// by count messages, each behind a 2-byte sub-header. Symbols are session
+// IDs from the LOGON list, prices and quantities are 32 bits (what the
+// book works in), and the user is the one logged on, so it is not repeated.
+// The frame length sits where the v1 header keeps its own, so a reader
+// finds the end of either kind of frame from the first 8 bytes.
+
+constexpr uint8_t PROTOCOL_VERSION_2 = 2;
+constexpr size_t FRAME_PREFIX = 8;          // Bytes that give any frame's length
+constexpr size_t V2_MAX_FRAME = 4096;
+constexpr size_t V2_MAX_MESSAGES = 255;
+
+struct FrameHeaderV2 {
+    uint8_t  version;           // PROTOCOL_VERSION_2
+    uint8_t  count;             // Messages in the frame
+    uint16_t reserved;
+    uint32_t length;            // Total frame length (including header)
+    
+    FrameHeaderV2()
+        : version(PROTOCOL_VERSION_2)
+        , count(0)
+        , reserved(0)
+        , length(sizeof(FrameHeaderV2))
+    {}
+} __attribute__((packed));
+
+static_assert(sizeof(FrameHeaderV2) == FRAME_PREFIX, "FrameHeaderV2 must be 8 bytes");
+static_assert(offsetof(FrameHeaderV2, length) == offsetof(MessageHeader, length),
+              "Both frame headers keep the length in the same place");
+
+struct SubHeaderV2 {
+    uint8_t type;               // MessageType
+    uint8_t length;             // Message length (including sub-header)
+    
+    MessageType get_type() const {
+        return static_cast<MessageType>(type);
+    }
+} __attribute__((packed));
+
+// Length of the frame starting at frame (at least FRAME_PREFIX bytes)
+inline uint32_t frame_length(const uint8_t* frame) {
+    uint32_t length;
+    memcpy(&length, frame + offsetof(MessageHeader, length), sizeof(length));
+    return length;
+}
+
+// Client → Gateway
+
+struct NewOrderV2 {
+    SubHeaderV2 sub;
+    uint16_t symbol_id;
+    uint8_t  side;
+    uint8_t  order_type;
+    uint32_t price;
+    uint32_t quantity;
+    uint64_t client_order_id;
+} __attribute__((packed));
+
+struct CancelOrderV2 {
+    SubHeaderV2 sub;
+    uint16_t symbol_id;
+    uint64_t client_order_id;
+} __attribute__((packed));
+
+struct ReplaceOrderV2 {
+    SubHeaderV2 sub;
+    uint16_t symbol_id;
+    uint32_t price;
+    uint32_t quantity;          // New total quantity, filled quantity included
+    uint64_t client_order_id;
+    uint64_t new_client_order_id;   // 0 = keep client_order_id
+} __attribute__((packed));
+
+struct MassCancelV2 {
+    SubHeaderV2 sub;
+    uint8_t side;               // 0 = both, else Side enum
+    uint8_t reserved;
+} __attribute__((packed));
+
+// Gateway → Client (only the logged-on user's responses, and market data
+// for the session's symbols)
+
+struct OrderAckV2 {
+    SubHeaderV2 sub;
+    uint64_t client_order_id;
+    uint64_t exchange_order_id;
+    uint64_t timestamp;
+} __attribute__((packed));
+
+// ORDER_REJECT, and ORDER_CANCELLED with reason NONE
+struct OrderRejectV2 {
+    SubHeaderV2 sub;
+    uint8_t  reason;
+    uint8_t  reserved;
+    uint64_t client_order_id;
+    uint64_t timestamp;
+} __attribute__((packed));
+
+struct OrderReplacedV2 {
+    SubHeaderV2 sub;
+    uint32_t price;
+    uint32_t quantity;
+    uint32_t leaves_quantity;
+    uint64_t orig_client_order_id;
+    uint64_t client_order_id;
+    uint64_t exchange_order_id;
+    uint64_t timestamp;
+} __attribute__((packed));
+
+struct MassCancelAckV2 {
+    SubHeaderV2 sub;
+    uint32_t cancelled_count;
+    uint64_t timestamp;
+} __attribute__((packed));
+
+struct ExecutionV2 {
+    SubHeaderV2 sub;
+    uint16_t symbol_id;
+    uint8_t  side;
+    uint8_t  reserved;
+    uint32_t fill_price;
+    uint32_t fill_quantity;
+    uint32_t leaves_quantity;
+    uint64_t client_order_id;
+    uint64_t exchange_order_id;
+    uint64_t execution_id;
+    uint64_t timestamp;
+} __attribute__((packed));
+
+struct TradeV2 {
+    SubHeaderV2 sub;
+    uint16_t symbol_id;
+    uint32_t price;
+    uint32_t quantity;
+    uint64_t trade_id;
+    uint64_t timestamp;
+} __attribute__((packed));
+
+struct QuoteV2 {
+    SubHeaderV2 sub;
+    uint16_t symbol_id;
+    uint32_t bid_price;
+    uint32_t bid_quantity;
+    uint32_t ask_price;
+    uint32_t ask_quantity;
+    uint64_t timestamp;
+} __attribute__((packed));
+
+// Either direction
+struct HeartbeatV2 {
+    SubHeaderV2 sub;
+    uint64_t timestamp;
+} __attribute__((packed));
+
 } // namespace protocol
 } // namespace matching
 
@@ -0,0 +1,394 @@
+#ifndef MATCHING_ENGINE_PROTOCOL_V2_H
+#define MATCHING_ENGINE_PROTOCOL_V2_H
+
+#include "protocol.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace matching {
+namespace protocol {
+
+// =============================================================================
+// SESSION SYMBOLS
+// =============================================================================
+// The LOGON list of one session: v2 symbol ID <-> 16-byte symbol name
+
+class SymbolMap {
+public:
+    static constexpr uint16_t MAX_SYMBOLS = 1024;
+
+    // False once full
+    bool add(const char* symbol) {
+        if (names_.size() >= MAX_SYMBOLS) {
+            return false;
+        }
+        std::string name(symbol, strnlen(symbol, 16));
+        ids_.emplace(name, static_cast<uint16_t>(names_.size()));
+        names_.push_back(name);
+        return true;
+    }
+
+    size_t size() const { return names_.size(); }
+
+    // nullptr if the ID was not in the LOGON list
+    const std::string* name(uint16_t id) const {
+        return id < names_.size() ? &names_[id] : nullptr;
+    }
+
+    bool find(const char* symbol, uint16_t& id) const {
+        auto it = ids_.find(std::string(symbol, strnlen(symbol, 16)));
+        if (it == ids_.end()) {
+            return false;
+        }
+        id = it->second;
+        return true;
+    }
+
+private:
+    std::vector<std::string> names_;
+    std::unordered_map<std::string, uint16_t> ids_;
+};
+
+// Largest LOGON: a full symbol list. It travels in v1 framing before any
+// version is agreed, so it is not bound by V2_MAX_FRAME
+constexpr size_t MAX_LOGON_LENGTH = LogonMessage::size_for(SymbolMap::MAX_SYMBOLS);
+
+// LOGON offering version for user_id and symbols, ready to send
+inline std::vector<uint8_t> make_logon(uint64_t user_id, uint8_t version,
+                                       const std::vector<std::string>& symbols) {
+    uint16_t count = static_cast<uint16_t>(symbols.size());
+    std::vector<uint8_t> bytes(LogonMessage::size_for(count), 0);
+
+    LogonMessage logon;
+    logon.header.length = static_cast<uint32_t>(bytes.size());
+    logon.user_id = user_id;
+    logon.version = version;
+    logon.symbol_count = count;
+    memcpy(bytes.data(), &logon, sizeof(logon));
+    for (uint16_t i = 0; i < count; i++) {
+        strncpy(reinterpret_cast<char*>(bytes.data() + sizeof(logon) + i * 16), symbols[i].c_str(), 15);
+    }
+    return bytes;
+}
+
+// =============================================================================
+// FRAME WRITER
+// =============================================================================
+// Packs messages into one v2 frame until it is sealed or full
+
+class FrameWriterV2 {
+public:
+    FrameWriterV2() : length_(sizeof(FrameHeaderV2)), count_(0) {}
+
+    bool empty() const { return count_ == 0; }
+
+    // False if the message does not fit; seal() and start again
+    bool append(const void* message, size_t length) {
+        if (count_ == V2_MAX_MESSAGES || length_ + length > V2_MAX_FRAME) {
+            return false;
+        }
+        memcpy(buffer_ + length_, message, length);
+        length_ += length;
+        count_++;
+        return true;
+    }
+
+    // The finished frame (valid until the next append or reset)
+    const uint8_t* seal(size_t& length) {
+        FrameHeaderV2 header;
+        header.count = static_cast<uint8_t>(count_);
+        header.length = static_cast<uint32_t>(length_);
+        memcpy(buffer_, &header, sizeof(header));
+        length = length_;
+        return buffer_;
+    }
+
+    void reset() {
+        length_ = sizeof(FrameHeaderV2);
+        count_ = 0;
+    }
+
+private:
+    uint8_t buffer_[V2_MAX_FRAME];
+    size_t length_;
+    size_t count_;
+};
+
+// =============================================================================
+// FRAME READER
+// =============================================================================
+// Calls on_message(const SubHeaderV2*) for each message of a whole v2
+// frame; false if the frame is malformed
+
+template <typename OnMessage>
+bool for_each_message_v2(const uint8_t* frame, size_t length, OnMessage&& on_message) {
+    if (length < sizeof(FrameHeaderV2)) {
+        return false;
+    }
+    const FrameHeaderV2* header = reinterpret_cast<const FrameHeaderV2*>(frame);
+    size_t offset = sizeof(FrameHeaderV2);
+    for (uint32_t i = 0; i < header->count; i++) {
+        if (length - offset < sizeof(SubHeaderV2)) {
+            return false;
+        }
+        const SubHeaderV2* message = reinterpret_cast<const SubHeaderV2*>(frame + offset);
+        if (message->length < sizeof(SubHeaderV2) || message->length > length - offset) {
+            return false;
+        }
+        on_message(message);
+        offset += message->length;
+    }
+    return offset == length;
+}
+
+// =============================================================================
+// V2 -> V1 (client orders)
+// =============================================================================
+// Expands one client message into its v1 form at out (room for any v1
+// order message) for user_id. Returns the v1 length, or 0 with error set.
+
+inline size_t decode_client_v2(const SubHeaderV2* message, const SymbolMap& symbols,
+                               uint64_t user_id, uint8_t* out, const char*& error) {
+    // Every field is checked against the message's own length first
+    auto fits = [&](size_t size) {
+        if (message->length < size) {
+            error = "Short v2 message";
+            return false;
+        }
+        return true;
+    };
+    auto symbol = [&](uint16_t id) -> const std::string* {
+        const std::string* name = symbols.name(id);
+        if (!name) {
+            error = "Unknown v2 symbol ID";
+        }
+        return name;
+    };
+
+    switch (message->get_type()) {
+        case MessageType::NEW_ORDER: {
+            if (!fits(sizeof(NewOrderV2))) return 0;
+            const NewOrderV2* in = reinterpret_cast<const NewOrderV2*>(message);
+            const std::string* name = symbol(in->symbol_id);
+            if (!name) return 0;
+
+            NewOrderMessage msg;
+            msg.set_symbol(*name);
+            msg.client_order_id = in->client_order_id;
+            msg.user_id = user_id;
+            msg.side = in->side;
+            msg.order_type = in->order_type;
+            msg.price = in->price;
+            msg.quantity = in->quantity;
+            memcpy(out, &msg, sizeof(msg));
+            return sizeof(msg);
+        }
+
+        case MessageType::CANCEL_ORDER: {
+            if (!fits(sizeof(CancelOrderV2))) return 0;
+            const CancelOrderV2* in = reinterpret_cast<const CancelOrderV2*>(message);
+            const std::string* name = symbol(in->symbol_id);
+            if (!name) return 0;
+
+            CancelOrderMessage msg;
+            msg.set_symbol(*name);
+            msg.client_order_id = in->client_order_id;
+            msg.user_id = user_id;
+            memcpy(out, &msg, sizeof(msg));
+            return sizeof(msg);
+        }
+
+        case MessageType::REPLACE_ORDER: {
+            if (!fits(sizeof(ReplaceOrderV2))) return 0;
+            const ReplaceOrderV2* in = reinterpret_cast<const ReplaceOrderV2*>(message);
+            const std::string* name = symbol(in->symbol_id);
+            if (!name) return 0;
+
+            ReplaceOrderMessage msg;
+            msg.set_symbol(*name);
+            msg.client_order_id = in->client_order_id;
+            msg.new_client_order_id = in->new_client_order_id;
+            msg.user_id = user_id;
+            msg.price = in->price;
+            msg.quantity = in->quantity;
+            memcpy(out, &msg, sizeof(msg));
+            return sizeof(msg);
+        }
+
+        case MessageType::MASS_CANCEL: {
+            if (!fits(sizeof(MassCancelV2))) return 0;
+            const MassCancelV2* in = reinterpret_cast<const MassCancelV2*>(message);
+
+            MassCancelMessage msg;
+            msg.user_id = user_id;
+            msg.side = in->side;
+            memcpy(out, &msg, sizeof(msg));
+            return sizeof(msg);
+        }
+
+        case MessageType::HEARTBEAT: {
+            HeartbeatMessage msg;
+            memcpy(out, &msg, sizeof(msg));
+            return sizeof(msg);
+        }
+
+        default:
+            error = "Unexpected v2 message type";
+            return 0;
+    }
+}
+
+// =============================================================================
+// V1 -> V2 (engine output)
+// =============================================================================
+// Compacts one engine message for a v2 session of user_id into out (room
+// for any v2 message). Returns the v2 length, or 0 if the session does not
+// get it: another user's response, or market data for a symbol it did not
+// name at LOGON.
+
+inline size_t encode_server_v2(const MessageHeader* message, size_t length, const SymbolMap& symbols,
+                               uint64_t user_id, uint8_t* out) {
+    auto begin = [&](auto& msg) {
+        msg.sub.type = message->type;
+        msg.sub.length = static_cast<uint8_t>(sizeof(msg));
+    };
+    auto finish = [&](const auto& msg) {
+        memcpy(out, &msg, sizeof(msg));
+        return sizeof(msg);
+    };
+
+    switch (message->get_type()) {
+        case MessageType::ORDER_ACK: {
+            if (length < sizeof(OrderAckMessage)) return 0;
+            const OrderAckMessage* in = reinterpret_cast<const OrderAckMessage*>(message);
+            if (in->user_id != user_id) return 0;
+
+            OrderAckV2 msg;
+            begin(msg);
+            msg.client_order_id = in->client_order_id;
+            msg.exchange_order_id = in->exchange_order_id;
+            msg.timestamp = in->timestamp;
+            return finish(msg);
+        }
+
+        case MessageType::ORDER_REJECT:
+        case MessageType::ORDER_CANCELLED: {
+            if (length < sizeof(OrderRejectMessage)) return 0;
+            const OrderRejectMessage* in = reinterpret_cast<const OrderRejectMessage*>(message);
+            if (in->user_id != user_id) return 0;
+
+            OrderRejectV2 msg;
+            begin(msg);
+            msg.reason = in->reason;
+            msg.reserved = 0;
+            msg.client_order_id = in->client_order_id;
+            msg.timestamp = in->timestamp;
+            return finish(msg);
+        }
+
+        case MessageType::ORDER_REPLACED: {
+            if (length < sizeof(OrderReplacedMessage)) return 0;
+            const OrderReplacedMessage* in = reinterpret_cast<const OrderReplacedMessage*>(message);
+            if (in->user_id != user_id) return 0;
+
+            OrderReplacedV2 msg;
+            begin(msg);
+            msg.price = static_cast<uint32_t>(in->price);
+            msg.quantity = static_cast<uint32_t>(in->quantity);
+            msg.leaves_quantity = static_cast<uint32_t>(in->leaves_quantity);
+            msg.orig_client_order_id = in->orig_client_order_id;
+            msg.client_order_id = in->client_order_id;
+            msg.exchange_order_id = in->exchange_order_id;
+            msg.timestamp = in->timestamp;
+            return finish(msg);
+        }
+
+        case MessageType::MASS_CANCEL_ACK: {
+            if (length < sizeof(MassCancelAckMessage)) return 0;
+            const MassCancelAckMessage* in = reinterpret_cast<const MassCancelAckMessage*>(message);
+            if (in->user_id != user_id) return 0;
+
+            MassCancelAckV2 msg;
+            begin(msg);
+            msg.cancelled_count = static_cast<uint32_t>(in->cancelled_count);
+            msg.timestamp = in->timestamp;
+            return finish(msg);
+        }
+
+        case MessageType::EXECUTION: {
+            if (length < sizeof(ExecutionMessage)) return 0;
+            const ExecutionMessage* in = reinterpret_cast<const ExecutionMessage*>(message);
+            uint16_t symbol_id;
+            if (in->user_id != user_id || !symbols.find(in->symbol, symbol_id)) return 0;
+
+            ExecutionV2 msg;
+            begin(msg);
+            msg.symbol_id = symbol_id;
+            msg.side = in->side;
+            msg.reserved = 0;
+            msg.fill_price = static_cast<uint32_t>(in->fill_price);
+            msg.fill_quantity = static_cast<uint32_t>(in->fill_quantity);
+            msg.leaves_quantity = static_cast<uint32_t>(in->leaves_quantity);
+            msg.client_order_id = in->client_order_id;
+            msg.exchange_order_id = in->exchange_order_id;
+            msg.execution_id = in->execution_id;
+            msg.timestamp = in->timestamp;
+            return finish(msg);
+        }
+
+        case MessageType::TRADE: {
+            if (length < sizeof(TradeMessage)) return 0;
+            const TradeMessage* in = reinterpret_cast<const TradeMessage*>(message);
+            uint16_t symbol_id;
+            if (!symbols.find(in->symbol, symbol_id)) return 0;
+
+            TradeV2 msg;
+            begin(msg);
+            msg.symbol_id = symbol_id;
+            msg.price = static_cast<uint32_t>(in->price);
+            msg.quantity = static_cast<uint32_t>(in->quantity);
+            msg.trade_id = in->trade_id;
+            msg.timestamp = in->timestamp;
+            return finish(msg);
+        }
+
+        case MessageType::QUOTE: {
+            if (length < sizeof(QuoteMessage)) return 0;
+            const QuoteMessage* in = reinterpret_cast<const QuoteMessage*>(message);
+            uint16_t symbol_id;
+            if (!symbols.find(in->symbol, symbol_id)) return 0;
+
+            QuoteV2 msg;
+            begin(msg);
+            msg.symbol_id = symbol_id;
+            msg.bid_price = static_cast<uint32_t>(in->bid_price);
+            msg.bid_quantity = static_cast<uint32_t>(in->bid_quantity);
+            msg.ask_price = static_cast<uint32_t>(in->ask_price);
+            msg.ask_quantity = static_cast<uint32_t>(in->ask_quantity);
+            msg.timestamp = in->timestamp;
+            return finish(msg);
+        }
+
+        case MessageType::HEARTBEAT: {
+            if (length < sizeof(HeartbeatMessage)) return 0;
+            HeartbeatV2 msg;
+            begin(msg);
+            msg.timestamp = reinterpret_cast<const HeartbeatMessage*>(message)->timestamp;
+            return finish(msg);
+        }
+
+        default:
+            return 0;
+    }
+}
+
+// Largest v2 message either direction
+constexpr size_t V2_MAX_MESSAGE = 64;
+static_assert(sizeof(ExecutionV2) <= V2_MAX_MESSAGE, "ExecutionV2 must fit V2_MAX_MESSAGE");
+static_assert(sizeof(OrderReplacedV2) <= V2_MAX_MESSAGE, "OrderReplacedV2 must fit V2_MAX_MESSAGE");
+
+} // namespace protocol
+} // namespace matching
+
+#endif // MATCHING_ENGINE_PROTOCOL_V2_H
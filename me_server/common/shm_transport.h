@@ -0,0 +1,417 @@
+#ifndef MATCHING_SHM_TRANSPORT_H
+#define MATCHING_SHM_TRANSPORT_H
+
+#include "protocol.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace matching {
+namespace transport {
+
+// =============================================================================
+// SHARED MEMORY TRANSPORT
+// =============================================================================
+// Alternative to the engine's Unix socket: one shared memory region holding
+// two single-producer / single-consumer byte rings, gateway -> engine and
+// engine -> gateway. Protocol messages are written straight into the ring
+// and read where they lie, so a hop costs two cache-line transfers instead
+// of a send() and two recv() calls.
+//
+// The engine creates the region (shm_open name) and the gateway attaches to
+// it. Each side publishes its pid; a cleared or dead pid means the peer is
+// gone.
+
+constexpr uint32_t SHM_MAGIC = 0x4D485358;     // "XSHM"
+constexpr uint32_t SHM_VERSION = 1;
+constexpr uint64_t SHM_DEFAULT_RING_SIZE = 4ull << 20;
+
+// Records start on their own cache line, so the consumer reading one
+// message never shares a line with the producer writing the next
+constexpr size_t SHM_RECORD_ALIGN = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Ring indices must be lock-free across processes");
+
+// =============================================================================
+// WAITING
+// =============================================================================
+enum class WaitMode : uint8_t {
+    BUSY_POLL,      // Spin on the ring forever (dedicated core, lowest latency)
+    ADAPTIVE,       // Spin, then yield, then sleep briefly while idle
+};
+
+class Backoff {
+public:
+    explicit Backoff(WaitMode mode)
+        : mode_(mode)
+        , rounds_(0)
+    {}
+    
+    void reset() { rounds_ = 0; }
+    
+    // One idle round; returns how many in a row so far
+    uint32_t idle() {
+        ++rounds_;
+        if (mode_ == WaitMode::BUSY_POLL || rounds_ < SPIN_ROUNDS) {
+            cpu_relax();
+        } else if (rounds_ < YIELD_ROUNDS) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(SLEEP_US));
+        }
+        return rounds_;
+    }
+
+private:
+    static constexpr uint32_t SPIN_ROUNDS = 4096;
+    static constexpr uint32_t YIELD_ROUNDS = 8192;
+    static constexpr uint32_t SLEEP_US = 50;
+    
+    WaitMode mode_;
+    uint32_t rounds_;
+};
+
+inline bool parse_wait_mode(const std::string& text, WaitMode& mode) {
+    if (text == "busy") {
+        mode = WaitMode::BUSY_POLL;
+    } else if (text == "adaptive") {
+        mode = WaitMode::ADAPTIVE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// =============================================================================
+// SHARED LAYOUT
+// =============================================================================
+struct ShmRingControl {
+    alignas(64) std::atomic<uint64_t> head;     // Bytes published (producer)
+    alignas(64) std::atomic<uint64_t> tail;     // Bytes released (consumer)
+};
+
+struct ShmRegionHeader {
+    std::atomic<uint32_t> magic;        // Set last by the engine once initialised
+    uint32_t version;
+    uint64_t ring_size;                 // Bytes per ring (power of 2)
+    std::atomic<int32_t> engine_pid;    // 0 = not attached
+    std::atomic<int32_t> gateway_pid;
+    ShmRingControl rings[2];            // TO_ENGINE, TO_GATEWAY
+};
+
+enum ShmRingIndex {
+    TO_ENGINE = 0,
+    TO_GATEWAY = 1,
+};
+
+constexpr size_t shm_header_size() {
+    return (sizeof(ShmRegionHeader) + SHM_RECORD_ALIGN - 1) & ~(SHM_RECORD_ALIGN - 1);
+}
+
+// =============================================================================
+// RING (one direction)
+// =============================================================================
+// A record is the protocol message itself, padded to SHM_RECORD_ALIGN.
+// A message never wraps: if it does not fit before the end of the ring,
+// the rest of the ring is filled with a padding record (a header with
+// version 0) and the message starts again at offset 0.
+class ShmRing {
+public:
+    ShmRing()
+        : control_(nullptr)
+        , data_(nullptr)
+        , size_(0)
+        , position_(0)
+        , cached_peer_(0)
+        , pending_(0)
+    {}
+    
+    void bind(ShmRingControl* control, uint8_t* data, uint64_t size, bool producer) {
+        control_ = control;
+        data_ = data;
+        size_ = size;
+        position_ = producer ? control->head.load(std::memory_order_acquire)
+                             : control->tail.load(std::memory_order_acquire);
+        cached_peer_ = producer ? control->tail.load(std::memory_order_acquire)
+                                : control->head.load(std::memory_order_acquire);
+        pending_ = 0;
+    }
+    
+    // -------------------------------------------------------------------------
+    // PRODUCER
+    // -------------------------------------------------------------------------
+    
+    // Space for a size-byte message, or nullptr if the ring is full
+    void* try_claim(size_t size) {
+        uint64_t record = record_size(size);
+        if (size < sizeof(protocol::MessageHeader) || record > size_ / 2) {
+            return nullptr;
+        }
+        
+        uint64_t offset = position_ & (size_ - 1);
+        uint64_t padding = (size_ - offset < record) ? size_ - offset : 0;
+        uint64_t needed = padding + record;
+        
+        if (position_ + needed - cached_peer_ > size_) {
+            cached_peer_ = control_->tail.load(std::memory_order_acquire);
+            if (position_ + needed - cached_peer_ > size_) {
+                return nullptr;
+            }
+        }
+        
+        if (padding) {
+            protocol::MessageHeader* pad = reinterpret_cast<protocol::MessageHeader*>(data_ + offset);
+            pad->version = 0;
+            pad->length = static_cast<uint32_t>(padding);
+            offset = 0;
+        }
+        
+        pending_ = needed;
+        return data_ + offset;
+    }
+    
+    // Make the claimed message visible to the consumer
+    void publish() {
+        position_ += pending_;
+        pending_ = 0;
+        control_->head.store(position_, std::memory_order_release);
+    }
+    
+    bool try_write(const void* message, size_t size) {
+        void* slot = try_claim(size);
+        if (!slot) {
+            return false;
+        }
+        memcpy(slot, message, size);
+        publish();
+        return true;
+    }
+    
+    // -------------------------------------------------------------------------
+    // CONSUMER
+    // -------------------------------------------------------------------------
+    
+    // Oldest unread message, in place, or nullptr if the ring is empty
+    const protocol::MessageHeader* front() {
+        while (true) {
+            if (position_ == cached_peer_) {
+                cached_peer_ = control_->head.load(std::memory_order_acquire);
+                if (position_ == cached_peer_) {
+                    return nullptr;
+                }
+            }
+            
+            const protocol::MessageHeader* header =
+                reinterpret_cast<const protocol::MessageHeader*>(data_ + (position_ & (size_ - 1)));
+            if (header->version != 0) {
+                pending_ = record_size(header->length);
+                return header;
+            }
+            position_ += header->length;    // Padding up to the end of the ring
+        }
+    }
+    
+    // Release the message returned by front()
+    void pop() {
+        position_ += pending_;
+        pending_ = 0;
+        control_->tail.store(position_, std::memory_order_release);
+    }
+
+private:
+    ShmRingControl* control_;
+    uint8_t* data_;
+    uint64_t size_;
+    uint64_t position_;         // Own index (head for producer, tail for consumer)
+    uint64_t cached_peer_;      // Last seen index of the other side
+    uint64_t pending_;          // Bytes of the claimed / fronted record
+    
+    static uint64_t record_size(size_t size) {
+        return (size + SHM_RECORD_ALIGN - 1) & ~(SHM_RECORD_ALIGN - 1);
+    }
+};
+
+// =============================================================================
+// CHANNEL (both directions, one side's view)
+// =============================================================================
+class ShmChannel {
+public:
+    ShmChannel()
+        : region_(nullptr)
+        , region_size_(0)
+        , creator_(false)
+    {}
+    
+    ~ShmChannel() {
+        close();
+    }
+    
+    ShmChannel(const ShmChannel&) = delete;
+    ShmChannel& operator=(const ShmChannel&) = delete;
+    
+    // Engine side: create (or recreate) the region and publish it
+    bool create(const std::string& name, uint64_t ring_size = SHM_DEFAULT_RING_SIZE) {
+        uint64_t size = SHM_RECORD_ALIGN;
+        while (size < ring_size) {
+            size <<= 1;
+        }
+        
+        shm_unlink(name.c_str());
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            std::cerr << "[SHM] Failed to create " << name << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        
+        size_t total = shm_header_size() + 2 * size;
+        if (ftruncate(fd, static_cast<off_t>(total)) != 0 || !map(fd, total)) {
+            std::cerr << "[SHM] Failed to size " << name << ": " << strerror(errno) << std::endl;
+            ::close(fd);
+            shm_unlink(name.c_str());
+            return false;
+        }
+        ::close(fd);
+        
+        ShmRegionHeader* header = new (region_) ShmRegionHeader();
+        header->version = SHM_VERSION;
+        header->ring_size = size;
+        header->engine_pid.store(getpid(), std::memory_order_relaxed);
+        header->gateway_pid.store(0, std::memory_order_relaxed);
+        for (ShmRingControl& ring : header->rings) {
+            ring.head.store(0, std::memory_order_relaxed);
+            ring.tail.store(0, std::memory_order_relaxed);
+        }
+        header->magic.store(SHM_MAGIC, std::memory_order_release);
+        
+        name_ = name;
+        creator_ = true;
+        bind_rings(TO_ENGINE, TO_GATEWAY);
+        return true;
+    }
+    
+    // Gateway side: attach to a region the engine has created
+    bool attach(const std::string& name) {
+        int fd = shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd < 0) {
+            std::cerr << "[SHM] Failed to open " << name << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < shm_header_size() ||
+            !map(fd, static_cast<size_t>(info.st_size))) {
+            std::cerr << "[SHM] Failed to map " << name << ": " << strerror(errno) << std::endl;
+            ::close(fd);
+            return false;
+        }
+        ::close(fd);
+        
+        ShmRegionHeader* header = this->header();
+        if (header->magic.load(std::memory_order_acquire) != SHM_MAGIC ||
+            header->version != SHM_VERSION ||
+            shm_header_size() + 2 * header->ring_size != region_size_) {
+            std::cerr << "[SHM] " << name << " is not a compatible engine channel" << std::endl;
+            unmap();
+            return false;
+        }
+        
+        int32_t expected = 0;
+        if (!header->gateway_pid.compare_exchange_strong(expected, getpid())) {
+            std::cerr << "[SHM] " << name << " already has a gateway (pid " << expected << ")" << std::endl;
+            unmap();
+            return false;
+        }
+        
+        name_ = name;
+        creator_ = false;
+        bind_rings(TO_GATEWAY, TO_ENGINE);
+        return true;
+    }
+    
+    // Withdraw this side; the creator also removes the name
+    void close() {
+        if (!region_) {
+            return;
+        }
+        std::atomic<int32_t>& own = creator_ ? header()->engine_pid : header()->gateway_pid;
+        own.store(0, std::memory_order_release);
+        unmap();
+        if (creator_) {
+            shm_unlink(name_.c_str());
+        }
+    }
+    
+    bool is_open() const { return region_ != nullptr; }
+    
+    // Other side has attached and not detached yet
+    bool peer_attached() const {
+        return region_ && peer_pid().load(std::memory_order_acquire) != 0;
+    }
+    
+    // peer_attached(), and the process still exists (catches a crashed peer)
+    bool peer_alive() const {
+        if (!peer_attached()) {
+            return false;
+        }
+        pid_t pid = peer_pid().load(std::memory_order_acquire);
+        return kill(pid, 0) == 0 || errno == EPERM;
+    }
+    
+    ShmRing& inbound() { return inbound_; }
+    ShmRing& outbound() { return outbound_; }
+
+private:
+    uint8_t* region_;
+    size_t region_size_;
+    bool creator_;
+    std::string name_;
+    ShmRing inbound_;
+    ShmRing outbound_;
+    
+    ShmRegionHeader* header() const { return reinterpret_cast<ShmRegionHeader*>(region_); }
+    
+    std::atomic<int32_t>& peer_pid() const {
+        return creator_ ? header()->gateway_pid : header()->engine_pid;
+    }
+    
+    bool map(int fd, size_t size) {
+        void* region = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (region == MAP_FAILED) {
+            return false;
+        }
+        region_ = static_cast<uint8_t*>(region);
+        region_size_ = size;
+        return true;
+    }
+    
+    void unmap() {
+        munmap(region_, region_size_);
+        region_ = nullptr;
+        region_size_ = 0;
+    }
+    
+    void bind_rings(ShmRingIndex in, ShmRingIndex out) {
+        ShmRegionHeader* header = this->header();
+        uint64_t size = header->ring_size;
+        uint8_t* data = region_ + shm_header_size();
+        inbound_.bind(&header->rings[in], data + in * size, size, false);
+        outbound_.bind(&header->rings[out], data + out * size, size, true);
+    }
+};
+
+} // namespace transport
+} // namespace matching
+
+#endif // MATCHING_SHM_TRANSPORT_H
@@ -0,0 +1,132 @@
+#ifndef MATCHING_SPSC_QUEUE_H
+#define MATCHING_SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace matching {
+
+// =============================================================================
+// CPU RELAX
+// =============================================================================
+// Hint to the core that we are spinning (frees pipeline resources for the
+// sibling hyperthread and avoids a memory-order flush on loop exit)
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Spin for a while, then start yielding the core
+inline void idle_backoff(uint32_t& idle_rounds) {
+    if (++idle_rounds < 1024) {
+        cpu_relax();
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+// =============================================================================
+// SPSC QUEUE
+// =============================================================================
+// Bounded single-producer / single-consumer ring of fixed-size slots.
+// The producer fills a slot in place (claim + publish) and the consumer
+// reads it in place (front + pop), so nothing is copied twice. Head and
+// tail live on their own cache lines, and each side caches the other's
+// index so the shared line is only touched when the cached view runs out.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(uint32_t capacity)
+        : slots_(nullptr)
+        , mask_(0)
+        , head_(0)
+        , cached_tail_(0)
+        , tail_(0)
+        , cached_head_(0)
+    {
+        uint64_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots_.reset(new T[size]);
+        mask_ = size - 1;
+    }
+    
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+    
+    // -------------------------------------------------------------------------
+    // PRODUCER
+    // -------------------------------------------------------------------------
+    
+    // Next free slot, or nullptr if the queue is full
+    T* try_claim() {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_tail_ > mask_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ > mask_) {
+                return nullptr;
+            }
+        }
+        return &slots_[head & mask_];
+    }
+    
+    // Next free slot, spinning until the consumer makes room
+    T* claim() {
+        T* slot;
+        uint32_t idle_rounds = 0;
+        while (!(slot = try_claim())) {
+            idle_backoff(idle_rounds);
+        }
+        return slot;
+    }
+    
+    // Make the claimed slot visible to the consumer
+    void publish() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    
+    // -------------------------------------------------------------------------
+    // CONSUMER
+    // -------------------------------------------------------------------------
+    
+    // Oldest published slot, or nullptr if the queue is empty
+    T* front() {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail == cached_head_) {
+                return nullptr;
+            }
+        }
+        return &slots_[tail & mask_];
+    }
+    
+    // Release the slot returned by front()
+    void pop() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::unique_ptr<T[]> slots_;
+    uint64_t mask_;
+    
+    alignas(64) std::atomic<uint64_t> head_;    // Producer
+    uint64_t cached_tail_;
+    
+    alignas(64) std::atomic<uint64_t> tail_;    // Consumer
+    uint64_t cached_head_;
+};
+
+} // namespace matching
+
+#endif // MATCHING_SPSC_QUEUE_H
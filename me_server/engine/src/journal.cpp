@@ -0,0 +1,655 @@
+#include "journal.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace matching {
+namespace engine {
+
+// =============================================================================
+// FILE HELPERS
+// =============================================================================
+
+namespace {
+
+constexpr const char* SEGMENT_PREFIX = "journal-";
+constexpr const char* SEGMENT_SUFFIX = ".wal";
+constexpr const char* SNAPSHOT_PREFIX = "snapshot-";
+constexpr uint64_t MIN_SEGMENT_SIZE = 1ull << 20;
+
+struct SegmentName {
+    uint64_t first_sequence;
+    std::string path;
+};
+
+size_t record_size(uint32_t length) {
+    return (sizeof(JournalRecordHeader) + length + 7) & ~static_cast<size_t>(7);
+}
+
+// Word-at-a-time hash of the sequence number and the zero-padded message,
+// cheap enough that verification does not limit replay speed
+uint32_t record_checksum(uint64_t sequence, const uint8_t* data, uint32_t length) {
+    uint64_t hash = 0xCBF29CE484222325ULL ^ sequence;
+    size_t words = (length + 7) / 8;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t word;
+        memcpy(&word, data + i * 8, sizeof(word));
+        hash = (hash ^ word) * 0x100000001B3ULL;
+        hash ^= hash >> 29;
+    }
+    return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+// Parse "<prefix><20 digits><suffix>"; returns false for other names
+bool parse_sequence_name(const char* name, const char* prefix, const char* suffix, uint64_t& sequence) {
+    size_t prefix_len = strlen(prefix);
+    size_t suffix_len = strlen(suffix);
+    size_t len = strlen(name);
+    if (len != prefix_len + 20 + suffix_len) return false;
+    if (strncmp(name, prefix, prefix_len) != 0) return false;
+    if (strcmp(name + prefix_len + 20, suffix) != 0) return false;
+    
+    sequence = 0;
+    for (size_t i = prefix_len; i < prefix_len + 20; i++) {
+        if (name[i] < '0' || name[i] > '9') return false;
+        sequence = sequence * 10 + static_cast<uint64_t>(name[i] - '0');
+    }
+    return true;
+}
+
+std::string sequence_name(const std::string& directory, const char* prefix,
+                          uint64_t sequence, const char* suffix) {
+    char name[64];
+    snprintf(name, sizeof(name), "%s%020" PRIu64 "%s", prefix, sequence, suffix);
+    return directory + "/" + name;
+}
+
+std::vector<SegmentName> list_segments(const std::string& directory) {
+    std::vector<SegmentName> segments;
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        return segments;
+    }
+    
+    while (struct dirent* entry = readdir(dir)) {
+        uint64_t sequence;
+        if (parse_sequence_name(entry->d_name, SEGMENT_PREFIX, SEGMENT_SUFFIX, sequence)) {
+            segments.push_back({sequence, directory + "/" + entry->d_name});
+        }
+    }
+    closedir(dir);
+    
+    std::sort(segments.begin(), segments.end(),
+              [](const SegmentName& a, const SegmentName& b) {
+                  return a.first_sequence < b.first_sequence;
+              });
+    return segments;
+}
+
+int sync_data(int fd) {
+#if defined(__APPLE__)
+    return fsync(fd);
+#else
+    return fdatasync(fd);
+#endif
+}
+
+uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+} // namespace
+
+// =============================================================================
+// JOURNAL - CONSTRUCTOR / DESTRUCTOR
+// =============================================================================
+
+Journal::Journal(const JournalConfig& config)
+    : config_(config)
+    , mask_(0)
+    , head_(0)
+    , cached_tail_(0)
+    , next_sequence_(1)
+    , producer_stalls_(0)
+    , tail_(0)
+    , stop_(false)
+    , failed_(false)
+    , durable_sequence_(0)
+    , segment_fd_(-1)
+    , segment_offset_(0)
+    , written_sequence_(0)
+    , recovered_sequence_(0)
+    , records_written_(0)
+    , bytes_written_(0)
+    , write_calls_(0)
+    , sync_calls_(0)
+    , segments_created_(0)
+{
+    // Round the queue up to a power of two
+    uint64_t capacity = 1;
+    while (capacity < config_.queue_capacity) {
+        capacity <<= 1;
+    }
+    config_.queue_capacity = static_cast<uint32_t>(capacity);
+    config_.segment_size = std::max(config_.segment_size, MIN_SEGMENT_SIZE);
+    config_.max_batch = std::max<uint32_t>(1, std::min<uint32_t>(config_.max_batch, config_.queue_capacity));
+    mask_ = capacity - 1;
+}
+
+Journal::~Journal() {
+    close();
+}
+
+// =============================================================================
+// JOURNAL - LIFECYCLE
+// =============================================================================
+
+bool Journal::open(uint64_t applied_sequence) {
+    if (!ensure_directory(config_.directory)) {
+        std::cerr << "[Journal] Cannot create " << config_.directory << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    
+    // Only the newest segment has to be read to find where numbering stops
+    std::vector<SegmentName> segments = list_segments(config_.directory);
+    recovered_sequence_ = 0;
+    if (!segments.empty()) {
+        recovered_sequence_ = segments.back().first_sequence - 1;
+        JournalReader reader;
+        if (reader.open(config_.directory, recovered_sequence_)) {
+            JournalEntry entry;
+            while (reader.next(entry)) {
+                recovered_sequence_ = entry.sequence;
+            }
+        }
+    }
+    
+    next_sequence_ = std::max(recovered_sequence_, applied_sequence) + 1;
+    written_sequence_ = next_sequence_ - 1;
+    durable_sequence_.store(written_sequence_, std::memory_order_release);
+    
+    slots_.reset(new Slot[config_.queue_capacity]);
+    write_buffer_.reserve(static_cast<size_t>(config_.max_batch) * JOURNAL_SLOT_SIZE);
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    cached_tail_ = 0;
+    
+    if (!open_segment(next_sequence_)) {
+        return false;
+    }
+    
+    stop_.store(false, std::memory_order_release);
+    writer_thread_ = std::thread(&Journal::writer_loop, this);
+    return true;
+}
+
+void Journal::close() {
+    if (writer_thread_.joinable()) {
+        stop_.store(true, std::memory_order_release);
+        writer_thread_.join();
+    }
+    close_segment();
+}
+
+// =============================================================================
+// JOURNAL - PRODUCER
+// =============================================================================
+
+uint64_t Journal::append(const void* message, size_t size, uint64_t timestamp) {
+    if (size > JOURNAL_MAX_MESSAGE) {
+        return 0;
+    }
+    
+    // A failed writer has stopped draining, so waiting on it would never end
+    if (failed_.load(std::memory_order_acquire)) {
+        return 0;
+    }
+    
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head - cached_tail_ >= config_.queue_capacity) {
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        if (head - cached_tail_ >= config_.queue_capacity) {
+            producer_stalls_.fetch_add(1, std::memory_order_relaxed);
+            do {
+                std::this_thread::yield();
+                if (failed_.load(std::memory_order_acquire)) {
+                    return 0;
+                }
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+            } while (head - cached_tail_ >= config_.queue_capacity);
+        }
+    }
+    
+    Slot& slot = slots_[head & mask_];
+    slot.header.length = static_cast<uint32_t>(size);
+    slot.header.checksum = 0;           // Filled in by the writer
+    slot.header.sequence = next_sequence_++;
+    slot.header.timestamp = timestamp;
+    memcpy(slot.data, message, size);
+    
+    head_.store(head + 1, std::memory_order_release);
+    return slot.header.sequence;
+}
+
+Journal::Statistics Journal::get_statistics() const {
+    Statistics stats;
+    stats.records_written = records_written_.load(std::memory_order_relaxed);
+    stats.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+    stats.write_calls = write_calls_.load(std::memory_order_relaxed);
+    stats.sync_calls = sync_calls_.load(std::memory_order_relaxed);
+    stats.segments_created = segments_created_.load(std::memory_order_relaxed);
+    stats.producer_stalls = producer_stalls_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// =============================================================================
+// JOURNAL - WRITER THREAD
+// =============================================================================
+
+void Journal::writer_loop() {
+    const uint64_t interval_ns = static_cast<uint64_t>(config_.sync_interval_us) * 1000;
+    uint64_t last_sync = now_ns();
+    bool dirty = false;
+    uint32_t idle_rounds = 0;
+    
+    while (!failed_.load(std::memory_order_relaxed)) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        uint64_t head = head_.load(std::memory_order_acquire);
+        
+        if (head == tail) {
+            if (dirty && now_ns() - last_sync >= interval_ns) {
+                if (!sync_segment()) break;
+                durable_sequence_.store(written_sequence_, std::memory_order_release);
+                last_sync = now_ns();
+                dirty = false;
+            }
+            if (stop_.load(std::memory_order_acquire) &&
+                head_.load(std::memory_order_acquire) == tail) {
+                break;
+            }
+            // Spin briefly for the next burst, then back off
+            if (++idle_rounds < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+            }
+            continue;
+        }
+        idle_rounds = 0;
+        
+        // Everything queued since the last pass goes out in one write
+        uint64_t count = std::min<uint64_t>(head - tail, config_.max_batch);
+        size_t gathered = gather_batch(tail, count);
+        tail_.store(tail + gathered, std::memory_order_release);
+        if (!flush_buffer()) break;
+        
+        switch (config_.sync_mode) {
+            case SyncMode::NONE:
+                durable_sequence_.store(written_sequence_, std::memory_order_release);
+                break;
+            
+            case SyncMode::BATCH:
+                if (!sync_segment()) break;
+                durable_sequence_.store(written_sequence_, std::memory_order_release);
+                break;
+            
+            case SyncMode::INTERVAL:
+                dirty = true;
+                if (now_ns() - last_sync >= interval_ns) {
+                    if (!sync_segment()) break;
+                    durable_sequence_.store(written_sequence_, std::memory_order_release);
+                    last_sync = now_ns();
+                    dirty = false;
+                }
+                break;
+        }
+    }
+    
+    if (!failed_.load(std::memory_order_relaxed) && sync_segment()) {
+        durable_sequence_.store(written_sequence_, std::memory_order_release);
+    }
+}
+
+size_t Journal::gather_batch(uint64_t tail, uint64_t count) {
+    size_t gathered = 0;
+    for (; gathered < count; gathered++) {
+        const Slot& slot = slots_[(tail + gathered) & mask_];
+        size_t size = record_size(slot.header.length);
+        
+        // Roll to a fresh segment when this record would not fit
+        if (segment_offset_ + write_buffer_.size() + size > config_.segment_size) {
+            if (!flush_buffer() || !sync_segment()) {
+                break;
+            }
+            close_segment();
+            if (!open_segment(slot.header.sequence)) {
+                break;
+            }
+        }
+        
+        size_t offset = write_buffer_.size();
+        write_buffer_.resize(offset + size);
+        uint8_t* out = write_buffer_.data() + offset;
+        
+        // Pad before hashing - the checksum covers whole words
+        JournalRecordHeader header = slot.header;
+        memcpy(out + sizeof(header), slot.data, header.length);
+        memset(out + sizeof(header) + header.length, 0, size - sizeof(header) - header.length);
+        header.checksum = record_checksum(header.sequence, out + sizeof(header), header.length);
+        memcpy(out, &header, sizeof(header));
+        
+        written_sequence_ = header.sequence;
+    }
+    records_written_.fetch_add(gathered, std::memory_order_relaxed);
+    return gathered;
+}
+
+bool Journal::flush_buffer() {
+    const uint8_t* data = write_buffer_.data();
+    size_t remaining = write_buffer_.size();
+    
+    while (remaining > 0) {
+        ssize_t written = pwrite(segment_fd_, data, remaining, static_cast<off_t>(segment_offset_));
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[Journal] Write failed: " << strerror(errno) << std::endl;
+            failed_.store(true, std::memory_order_release);
+            return false;
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+        segment_offset_ += static_cast<uint64_t>(written);
+        bytes_written_.fetch_add(static_cast<uint64_t>(written), std::memory_order_relaxed);
+        write_calls_.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    write_buffer_.clear();
+    return true;
+}
+
+// =============================================================================
+// JOURNAL - SEGMENTS
+// =============================================================================
+
+bool Journal::open_segment(uint64_t first_sequence) {
+    std::string path = sequence_name(config_.directory, SEGMENT_PREFIX, first_sequence, SEGMENT_SUFFIX);
+    
+    // A file with this name can only be an empty or torn leftover from a
+    // crash (its first record was never recovered), so start it afresh
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "[Journal] Cannot create " << path << ": " << strerror(errno) << std::endl;
+        failed_.store(true, std::memory_order_release);
+        return false;
+    }
+    
+    // Reserve the whole segment up front so appends never extend the file
+    int rc = -1;
+#if defined(__linux__)
+    rc = posix_fallocate(fd, 0, static_cast<off_t>(config_.segment_size));
+#endif
+    if (rc != 0 && ftruncate(fd, static_cast<off_t>(config_.segment_size)) != 0) {
+        std::cerr << "[Journal] Cannot preallocate " << path << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        failed_.store(true, std::memory_order_release);
+        return false;
+    }
+    
+    if (config_.sync_mode != SyncMode::NONE) {
+        fsync(fd);
+        sync_directory(config_.directory);
+    }
+    
+    segment_fd_ = fd;
+    segment_offset_ = 0;
+    segments_created_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool Journal::sync_segment() {
+    if (segment_fd_ < 0 || config_.sync_mode == SyncMode::NONE) {
+        return true;
+    }
+    if (sync_data(segment_fd_) != 0) {
+        std::cerr << "[Journal] Sync failed: " << strerror(errno) << std::endl;
+        failed_.store(true, std::memory_order_release);
+        return false;
+    }
+    sync_calls_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void Journal::close_segment() {
+    if (segment_fd_ >= 0) {
+        ::close(segment_fd_);
+        segment_fd_ = -1;
+    }
+}
+
+// =============================================================================
+// JOURNAL READER
+// =============================================================================
+
+JournalReader::JournalReader()
+    : segment_index_(0)
+    , map_(nullptr)
+    , map_size_(0)
+    , offset_(0)
+    , after_(0)
+    , expected_(0)
+    , gap_(false)
+{}
+
+JournalReader::~JournalReader() {
+    unmap_segment();
+}
+
+bool JournalReader::open(const std::string& directory, uint64_t after) {
+    struct stat st;
+    if (stat(directory.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return false;
+    }
+    
+    unmap_segment();
+    segments_.clear();
+    after_ = after;
+    expected_ = 0;
+    gap_ = false;
+    
+    std::vector<SegmentName> names = list_segments(directory);
+    
+    // Skip segments that end before the first record wanted
+    size_t first = 0;
+    while (first + 1 < names.size() && names[first + 1].first_sequence <= after + 1) {
+        first++;
+    }
+    for (size_t i = first; i < names.size(); i++) {
+        segments_.push_back({names[i].first_sequence, names[i].path});
+    }
+    
+    segment_index_ = 0;
+    return true;
+}
+
+bool JournalReader::next(JournalEntry& entry) {
+    while (!gap_) {
+        if (!map_ && !map_next_segment()) {
+            return false;
+        }
+        
+        // End of this segment's data: zero fill, torn record or end of file
+        if (offset_ + sizeof(JournalRecordHeader) > map_size_) {
+            unmap_segment();
+            continue;
+        }
+        
+        JournalRecordHeader header;
+        memcpy(&header, map_ + offset_, sizeof(header));
+        size_t size = record_size(header.length);
+        if (header.length == 0 || header.length > JOURNAL_MAX_MESSAGE ||
+            offset_ + size > map_size_ ||
+            record_checksum(header.sequence, map_ + offset_ + sizeof(header), header.length) != header.checksum) {
+            unmap_segment();
+            continue;
+        }
+        
+        if (expected_ != 0 && header.sequence != expected_) {
+            std::cerr << "[Journal] Sequence gap: expected " << expected_
+                      << ", found " << header.sequence << std::endl;
+            gap_ = true;
+            return false;
+        }
+        
+        const uint8_t* data = map_ + offset_ + sizeof(header);
+        offset_ += size;
+        expected_ = header.sequence + 1;
+        
+        if (header.sequence <= after_) {
+            continue;
+        }
+        
+        entry.sequence = header.sequence;
+        entry.timestamp = header.timestamp;
+        entry.data = data;
+        entry.length = header.length;
+        return true;
+    }
+    return false;
+}
+
+bool JournalReader::map_next_segment() {
+    while (segment_index_ < segments_.size()) {
+        const Segment& segment = segments_[segment_index_++];
+        
+        // A segment must pick up exactly where the previous one stopped
+        if (expected_ != 0 && segment.first_sequence != expected_) {
+            std::cerr << "[Journal] Sequence gap: expected " << expected_
+                      << ", next segment starts at " << segment.first_sequence << std::endl;
+            gap_ = true;
+            return false;
+        }
+        
+        int fd = ::open(segment.path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            continue;
+        }
+        
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            continue;
+        }
+        
+        void* map = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            continue;
+        }
+        
+        madvise(map, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+        madvise(map, static_cast<size_t>(st.st_size), MADV_WILLNEED);
+        
+        map_ = static_cast<const uint8_t*>(map);
+        map_size_ = static_cast<size_t>(st.st_size);
+        offset_ = 0;
+        if (expected_ == 0) {
+            expected_ = segment.first_sequence;
+        }
+        return true;
+    }
+    return false;
+}
+
+void JournalReader::unmap_segment() {
+    if (map_) {
+        munmap(const_cast<uint8_t*>(map_), map_size_);
+        map_ = nullptr;
+        map_size_ = 0;
+        offset_ = 0;
+    }
+}
+
+// =============================================================================
+// RECOVERY HELPERS
+// =============================================================================
+
+std::string snapshot_directory(const std::string& root, uint64_t sequence) {
+    return sequence_name(root, SNAPSHOT_PREFIX, sequence, "");
+}
+
+bool find_latest_snapshot(const std::string& root, std::string& directory, uint64_t& sequence) {
+    DIR* dir = opendir(root.c_str());
+    if (!dir) {
+        return false;
+    }
+    
+    // Snapshots are built under a temporary name and renamed when
+    // complete, so any directory with the final name is usable
+    bool found = false;
+    while (struct dirent* entry = readdir(dir)) {
+        uint64_t candidate;
+        if (parse_sequence_name(entry->d_name, SNAPSHOT_PREFIX, "", candidate) &&
+            (!found || candidate > sequence)) {
+            sequence = candidate;
+            found = true;
+        }
+    }
+    closedir(dir);
+    
+    if (found) {
+        directory = snapshot_directory(root, sequence);
+    }
+    return found;
+}
+
+bool ensure_directory(const std::string& directory) {
+    if (mkdir(directory.c_str(), 0755) == 0 || errno == EEXIST) {
+        return true;
+    }
+    return false;
+}
+
+bool sync_directory(const std::string& directory) {
+    int fd = ::open(directory.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+void remove_directory(const std::string& directory) {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        return;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        std::string path = directory + "/" + entry->d_name;
+        struct stat info;
+        if (lstat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+            remove_directory(path);
+        } else {
+            unlink(path.c_str());
+        }
+    }
+    closedir(dir);
+    rmdir(directory.c_str());
+}
+
+} // namespace engine
+} // namespace matching
@@ -0,0 +1,244 @@
+#ifndef MATCHING_ENGINE_JOURNAL_H
+#define MATCHING_ENGINE_JOURNAL_H
+
+#include "../../common/protocol.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace matching {
+namespace engine {
+
+// =============================================================================
+// JOURNAL RECORD (on disk)
+// =============================================================================
+// Segment files hold back-to-back records: this header followed by the raw
+// inbound message, padded to 8 bytes. Segments are preallocated (zeros), so
+// a zero length marks the end of the data written so far.
+struct JournalRecordHeader {
+    uint32_t length;        // Message bytes that follow
+    uint32_t checksum;      // Over sequence and padded message
+    uint64_t sequence;      // Engine sequence number (1-based, gap-free)
+    uint64_t timestamp;     // Engine receive time (ns since epoch)
+};
+
+static_assert(sizeof(JournalRecordHeader) == 24, "JournalRecordHeader must be 24 bytes");
+
+// One queue slot holds a record header plus the largest journaled message
+constexpr size_t JOURNAL_SLOT_SIZE = 128;
+constexpr size_t JOURNAL_MAX_MESSAGE = JOURNAL_SLOT_SIZE - sizeof(JournalRecordHeader);
+
+static_assert(sizeof(protocol::NewOrderMessage) <= JOURNAL_MAX_MESSAGE,
+              "NewOrderMessage must fit a journal slot");
+static_assert(sizeof(protocol::CancelOrderMessage) <= JOURNAL_MAX_MESSAGE,
+              "CancelOrderMessage must fit a journal slot");
+static_assert(sizeof(protocol::ReplaceOrderMessage) <= JOURNAL_MAX_MESSAGE,
+              "ReplaceOrderMessage must fit a journal slot");
+static_assert(sizeof(protocol::MassCancelMessage) <= JOURNAL_MAX_MESSAGE,
+              "MassCancelMessage must fit a journal slot");
+
+// =============================================================================
+// JOURNAL CONFIGURATION
+// =============================================================================
+enum class SyncMode : uint8_t {
+    NONE,       // Leave writeback to the OS (survives a process crash, not power loss)
+    BATCH,      // fdatasync every batch the writer drains (group commit)
+    INTERVAL,   // fdatasync at most once per sync_interval_us
+};
+
+struct JournalConfig {
+    std::string directory;
+    SyncMode sync_mode;
+    uint32_t sync_interval_us;
+    uint64_t segment_size;      // Bytes preallocated per segment file
+    uint32_t queue_capacity;    // Slots between matching and writer threads (power of 2)
+    uint32_t max_batch;         // Most records gathered into one write
+    
+    JournalConfig()
+        : sync_mode(SyncMode::BATCH)
+        , sync_interval_us(1000)
+        , segment_size(64ull << 20)
+        , queue_capacity(1u << 16)
+        , max_batch(4096)
+    {}
+};
+
+// =============================================================================
+// JOURNAL WRITER
+// =============================================================================
+// The matching thread copies each inbound message into a single-producer /
+// single-consumer ring and carries on. A dedicated writer thread drains
+// whatever has accumulated, writes it with one pwrite() and syncs according
+// to the sync mode, so the matching thread never makes a syscall.
+class Journal {
+public:
+    explicit Journal(const JournalConfig& config);
+    ~Journal();
+    
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+    
+    // Create the directory if needed, find the last record already on disk
+    // and start the writer. Numbering continues after the larger of that
+    // record and applied_sequence (the state recovered from a snapshot).
+    bool open(uint64_t applied_sequence);
+    
+    // Drain the queue, sync and stop the writer
+    void close();
+    
+    // Matching thread only. Queues a copy of the message and returns its
+    // sequence number (0 if the message is too large for a slot or the
+    // writer has failed). Spins if the writer has fallen a full queue behind.
+    uint64_t append(const void* message, size_t size, uint64_t timestamp);
+    
+    // Last sequence on disk when open() ran
+    uint64_t recovered_sequence() const { return recovered_sequence_; }
+    
+    // Last sequence handed to append()
+    uint64_t last_sequence() const { return next_sequence_ - 1; }
+    
+    // Last sequence written and synced as the sync mode requires
+    uint64_t durable_sequence() const { return durable_sequence_.load(std::memory_order_acquire); }
+    
+    // Set by the writer if a write or sync fails; nothing after that is durable
+    bool failed() const { return failed_.load(std::memory_order_acquire); }
+    
+    struct Statistics {
+        uint64_t records_written;
+        uint64_t bytes_written;
+        uint64_t write_calls;
+        uint64_t sync_calls;
+        uint64_t segments_created;
+        uint64_t producer_stalls;   // Appends that found the queue full
+    };
+    
+    Statistics get_statistics() const;
+
+private:
+    struct alignas(JOURNAL_SLOT_SIZE) Slot {
+        JournalRecordHeader header;
+        uint8_t data[JOURNAL_MAX_MESSAGE];
+    };
+    
+    static_assert(sizeof(Slot) == JOURNAL_SLOT_SIZE, "Slot must be one JOURNAL_SLOT_SIZE");
+    
+    JournalConfig config_;
+    std::unique_ptr<Slot[]> slots_;
+    uint64_t mask_;
+    
+    // -------------------------------------------------------------------------
+    // PRODUCER (matching thread)
+    // -------------------------------------------------------------------------
+    
+    alignas(64) std::atomic<uint64_t> head_;
+    uint64_t cached_tail_;
+    uint64_t next_sequence_;
+    std::atomic<uint64_t> producer_stalls_;
+    
+    // -------------------------------------------------------------------------
+    // CONSUMER (writer thread)
+    // -------------------------------------------------------------------------
+    
+    alignas(64) std::atomic<uint64_t> tail_;
+    std::atomic<bool> stop_;
+    std::atomic<bool> failed_;
+    std::atomic<uint64_t> durable_sequence_;
+    std::thread writer_thread_;
+    std::vector<uint8_t> write_buffer_;
+    
+    int segment_fd_;
+    uint64_t segment_offset_;
+    uint64_t written_sequence_;
+    uint64_t recovered_sequence_;
+    
+    std::atomic<uint64_t> records_written_;
+    std::atomic<uint64_t> bytes_written_;
+    std::atomic<uint64_t> write_calls_;
+    std::atomic<uint64_t> sync_calls_;
+    std::atomic<uint64_t> segments_created_;
+    
+    void writer_loop();
+    size_t gather_batch(uint64_t tail, uint64_t count);
+    bool flush_buffer();
+    bool open_segment(uint64_t first_sequence);
+    bool sync_segment();
+    void close_segment();
+};
+
+// =============================================================================
+// JOURNAL READER
+// =============================================================================
+// Walks every segment in sequence order through read-only mappings.
+// Reading stops at the end of the written data; a torn record at the end
+// of a segment is skipped as long as the next segment carries on with the
+// following sequence number. Anything else is reported as a gap.
+struct JournalEntry {
+    uint64_t sequence;
+    uint64_t timestamp;
+    const uint8_t* data;    // Raw message (starts with a MessageHeader)
+    uint32_t length;
+};
+
+class JournalReader {
+public:
+    JournalReader();
+    ~JournalReader();
+    
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+    
+    // List the directory's segments; records up to and including after are
+    // skipped (whole segments without having to read them where possible)
+    bool open(const std::string& directory, uint64_t after);
+    
+    // Next record, valid until the following call
+    bool next(JournalEntry& entry);
+    
+    // Reading stopped on a missing sequence number rather than end of data
+    bool has_gap() const { return gap_; }
+
+private:
+    struct Segment {
+        uint64_t first_sequence;
+        std::string path;
+    };
+    
+    std::vector<Segment> segments_;
+    size_t segment_index_;
+    const uint8_t* map_;
+    size_t map_size_;
+    size_t offset_;
+    uint64_t after_;
+    uint64_t expected_;     // Next sequence number (0 before the first record)
+    bool gap_;
+    
+    bool map_next_segment();
+    void unmap_segment();
+};
+
+// =============================================================================
+// RECOVERY HELPERS
+// =============================================================================
+
+// Snapshot directory for the state after journal record sequence
+std::string snapshot_directory(const std::string& root, uint64_t sequence);
+
+// Newest complete snapshot under root; false if there is none
+bool find_latest_snapshot(const std::string& root, std::string& directory, uint64_t& sequence);
+
+// Create directory (one level) if it does not exist
+bool ensure_directory(const std::string& directory);
+
+// fsync a directory so entries created or renamed in it are durable
+bool sync_directory(const std::string& directory);
+
+// Delete directory and everything below it; missing is not an error
+void remove_directory(const std::string& directory);
+
+} // namespace engine
+} // namespace matching
+
+#endif // MATCHING_ENGINE_JOURNAL_H
@@ -1,10 +1,21 @@
 #include "order_manager.h"
+#include "journal.h"
+#include "market_data.h"
+#include "sharded_engine.h"
+#include "../../common/latency.h"
+#include "../../common/logger.h"
 #include "../../common/protocol.h"
+#include "../../common/shm_transport.h"
 #include <iostream>
 #include <thread>
 #include <atomic>
+#include <chrono>
 #include <csignal>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <sstream>
 #include <vector>
 #include <sys/socket.h>
 #include <sys/un.h>
@@ -12,14 +23,35 @@
 #include <fcntl.h>
 
 using namespace matching::engine;
+using namespace matching::latency;
+using namespace matching::logging;
 using namespace matching::protocol;
+using namespace matching::transport;
 
 // =============================================================================
 // GLOBAL STATE
 // =============================================================================
 
 std::atomic<bool> g_running(true);
-OrderManager* g_order_manager = nullptr;
+
+// =============================================================================
+// DURABILITY OPTIONS
+// =============================================================================
+
+struct DurabilityOptions {
+    bool journal_enabled;
+    JournalConfig journal;
+    bool recover;               // Rebuild state from snapshot + journal at startup
+    uint64_t snapshot_every;    // Journal records between snapshots (0 = shutdown only)
+    
+    DurabilityOptions()
+        : journal_enabled(false)
+        , recover(false)
+        , snapshot_every(0)
+    {}
+    
+    std::string snapshot_root() const { return journal.directory + "/snapshots"; }
+};
 
 // =============================================================================
 // USAGE & VERSION
@@ -36,8 +68,38 @@ void print_usage(const char* program) {
               << "Options:\n"
               << "  -h, --help       Show this help message\n"
               << "  -v, --version    Show version information\n\n"
+              << "Transport:\n"
+              << "  --shm NAME             Talk to the gateway over shared memory rings NAME\n"
+              << "                         (e.g. /matching_engine) instead of the socket\n"
+              << "  --wait MODE            Ring polling: adaptive (default) | busy\n\n"
+              << "Durability:\n"
+              << "  --journal DIR          Journal inbound orders to segment files in DIR\n"
+              << "  --sync MODE            none | batch (default) | interval\n"
+              << "  --sync-interval-us N   fdatasync period for --sync interval (default 1000)\n"
+              << "  --segment-mb N         Preallocated segment size (default 64)\n"
+              << "  --snapshot-every N     Snapshot state every N journal records\n"
+              << "  --recover              Rebuild state from the latest snapshot and journal\n\n"
+              << "Logging:\n"
+              << "  --log-level LEVEL      trace | info (default) | warn | error\n"
+              << "  --log-file PATH        Append the log to PATH instead of stdout\n"
+              << "  --audit-log PATH       Write the order audit trail to PATH\n"
+              << "  --no-audit             Do not record the audit trail\n\n"
+              << "Sharding:\n"
+              << "  --shards N             Split symbols over N matching threads (default 0 = one)\n"
+              << "  --pin-cores LIST       Pin shard threads to cores, e.g. 2,3,4,5\n"
+              << "  --symbols-file PATH    Symbols to trade, one per line as SYMBOL [SHARD]\n\n"
+              << "Market data:\n"
+              << "  --md-group ADDR        Publish L2 depth to multicast group ADDR (enables)\n"
+              << "  --md-port N            Incremental port; snapshot N+1, recovery N+2 (default 31000)\n"
+              << "  --md-interface ADDR    Local address to send multicast from and bind recovery to\n"
+              << "  --md-snapshot-ms N     Full book snapshot period (default 1000, 0 = never)\n"
+              << "  --md-conflation-us N   Default conflated subscriber window (default 100000)\n\n"
               << "Examples:\n"
               << "  " << program << " /tmp/engine.sock\n"
+              << "  " << program << " --journal /var/lib/engine --recover\n"
+              << "  " << program << " --shards 4 --pin-cores 2,3,4,5 --symbols-file symbols.txt\n"
+              << "  " << program << " --shm /matching_engine --wait busy\n"
+              << "  " << program << " --md-group 239.1.1.1 --md-port 31000\n"
               << "  " << program << " --version\n"
               << std::endl;
 }
@@ -67,6 +129,10 @@ void setup_signal_handlers() {
 // =============================================================================
 // IPC COMMUNICATION
 // =============================================================================
+// Both transports hand the message loop one complete message at a time:
+// receive() returns it (nullptr if nothing is ready yet) and release()
+// is called once it has been processed. received_at() is the TSC reading
+// taken when the message's first bytes were seen.
 
 class IPCServer {
 public:
@@ -74,7 +140,11 @@ public:
         : socket_path_(socket_path)
         , server_fd_(-1)
         , client_fd_(-1)
-    {}
+        , connected_(false)
+        , received_at_(0)
+    {
+        buffer_.resize(4096); // 4KB buffer for messages
+    }
     
     ~IPCServer() {
         stop();
@@ -124,9 +194,62 @@ public:
         }
         
         std::cout << "[IPC] Gateway connected!" << std::endl;
+        connected_ = true;
         return true;
     }
     
+    const uint8_t* receive(size_t& length) {
+        // Read message header first
+        MessageHeader header;
+        ssize_t bytes_read = read_message(&header, sizeof(header));
+        
+        if (bytes_read < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                return nullptr;
+            }
+            std::cerr << "[Engine] Error reading header: " << strerror(errno) << std::endl;
+            connected_ = false;
+            return nullptr;
+        }
+        
+        if (bytes_read == 0) {
+            std::cout << "[Engine] Gateway disconnected" << std::endl;
+            connected_ = false;
+            return nullptr;
+        }
+        
+        if (bytes_read != sizeof(header) || header.length < sizeof(header)) {
+            std::cerr << "[Engine] Incomplete header received" << std::endl;
+            return nullptr;
+        }
+        received_at_ = read_tsc();
+        
+        // Read rest of message if needed
+        if (header.length > buffer_.size()) {
+            buffer_.resize(header.length);
+        }
+        memcpy(buffer_.data(), &header, sizeof(header));
+        
+        size_t remaining = header.length - sizeof(header);
+        if (remaining > 0) {
+            ssize_t remaining_read = read_message(buffer_.data() + sizeof(header), remaining);
+            if (remaining_read != static_cast<ssize_t>(remaining)) {
+                std::cerr << "[Engine] Incomplete message body" << std::endl;
+                return nullptr;
+            }
+        }
+        
+        length = header.length;
+        return buffer_.data();
+    }
+    
+    void release() {}
+    
+    uint64_t received_at() const {
+        return received_at_;
+    }
+    
     ssize_t read_message(void* buffer, size_t size) {
         if (client_fd_ < 0) {
             return -1;
@@ -144,6 +267,8 @@ public:
     }
     
     void stop() {
+        connected_ = false;
+        
         if (client_fd_ >= 0) {
             close(client_fd_);
             client_fd_ = -1;
@@ -158,119 +283,354 @@ public:
     }
     
     bool is_connected() const {
-        return client_fd_ >= 0;
+        return connected_;
     }
-    
+
 private:
     std::string socket_path_;
     int server_fd_;
     int client_fd_;
+    std::atomic<bool> connected_;
+    std::vector<uint8_t> buffer_;
+    uint64_t received_at_;
+};
+
+// Shared memory rings (--shm); messages are processed where they lie in
+// the inbound ring and outbound ones are written straight into the other
+class ShmIPCServer {
+public:
+    ShmIPCServer(const std::string& name, WaitMode wait_mode)
+        : name_(name)
+        , wait_mode_(wait_mode)
+        , idle_(wait_mode)
+        , connected_(false)
+        , received_at_(0)
+    {}
+    
+    ~ShmIPCServer() {
+        stop();
+    }
+    
+    bool start() {
+        if (!channel_.create(name_)) {
+            return false;
+        }
+        std::cout << "[IPC] Shared memory channel " << name_ << " ("
+                  << (wait_mode_ == WaitMode::BUSY_POLL ? "busy-poll" : "adaptive") << ")" << std::endl;
+        return true;
+    }
+    
+    bool accept_connection() {
+        std::cout << "[IPC] Waiting for gateway to attach..." << std::endl;
+        
+        Backoff wait(WaitMode::ADAPTIVE);
+        while (g_running && !channel_.peer_attached()) {
+            wait.idle();
+        }
+        if (!g_running) {
+            return false;
+        }
+        
+        std::cout << "[IPC] Gateway attached!" << std::endl;
+        connected_ = true;
+        return true;
+    }
+    
+    const uint8_t* receive(size_t& length) {
+        const MessageHeader* header = channel_.inbound().front();
+        if (!header) {
+            // Poll for a vanished gateway now and then while idle
+            if ((idle_.idle() & PEER_CHECK_MASK) == 0 && !channel_.peer_alive()) {
+                std::cout << "[Engine] Gateway disconnected" << std::endl;
+                connected_ = false;
+            }
+            return nullptr;
+        }
+        
+        received_at_ = read_tsc();
+        idle_.reset();
+        length = header->length;
+        return reinterpret_cast<const uint8_t*>(header);
+    }
+    
+    void release() {
+        channel_.inbound().pop();
+    }
+    
+    uint64_t received_at() const {
+        return received_at_;
+    }
+    
+    // Spins while the gateway is a full ring behind
+    ssize_t write_message(const void* buffer, size_t size) {
+        Backoff full(wait_mode_);
+        while (!channel_.outbound().try_write(buffer, size)) {
+            if (!connected_ ||
+                ((full.idle() & PEER_CHECK_MASK) == 0 && !channel_.peer_alive())) {
+                return -1;
+            }
+        }
+        return static_cast<ssize_t>(size);
+    }
+    
+    void stop() {
+        connected_ = false;
+        channel_.close();
+    }
+    
+    bool is_connected() const {
+        return connected_;
+    }
+
+private:
+    static constexpr uint32_t PEER_CHECK_MASK = 1023;
+    
+    std::string name_;
+    WaitMode wait_mode_;
+    Backoff idle_;
+    ShmChannel channel_;
+    std::atomic<bool> connected_;
+    uint64_t received_at_;
 };
 
 // =============================================================================
 // MESSAGE PROCESSING
 // =============================================================================
 
-void process_message(OrderManager& manager, const MessageHeader& header, 
-                     const std::vector<uint8_t>& buffer) {
+template <typename Engine>
+void process_message(Engine& manager, const MessageHeader& header, 
+                     const uint8_t* data, size_t length, uint64_t received_ns) {
     MessageType msg_type = header.get_type();
     
     switch (msg_type) {
         case MessageType::NEW_ORDER: {
-            if (buffer.size() >= sizeof(NewOrderMessage)) {
-                const NewOrderMessage* msg = reinterpret_cast<const NewOrderMessage*>(buffer.data());
-                std::cout << "[Engine] Processing NEW_ORDER: client_id=" << msg->client_order_id 
-                         << " symbol=" << msg->get_symbol() 
-                         << " side=" << (msg->get_side() == Side::BUY ? "BUY" : "SELL")
-                         << " price=" << msg->price 
-                         << " qty=" << msg->quantity << std::endl;
-                manager.handle_new_order(*msg);
+            if (length >= sizeof(NewOrderMessage)) {
+                const NewOrderMessage* msg = reinterpret_cast<const NewOrderMessage*>(data);
+                MX_AUDIT("[Engine] NEW_ORDER user={} client_id={} symbol={} side={} price={} qty={}",
+                         msg->user_id, msg->client_order_id, log_text(msg->symbol),
+                         msg->get_side() == Side::BUY ? "BUY" : "SELL", msg->price, msg->quantity);
+                manager.handle_new_order(*msg, received_ns);
             }
             break;
         }
         
         case MessageType::CANCEL_ORDER: {
-            if (buffer.size() >= sizeof(CancelOrderMessage)) {
-                const CancelOrderMessage* msg = reinterpret_cast<const CancelOrderMessage*>(buffer.data());
-                std::cout << "[Engine] Processing CANCEL_ORDER: client_id=" << msg->client_order_id << std::endl;
-                manager.handle_cancel_order(*msg);
+            if (length >= sizeof(CancelOrderMessage)) {
+                const CancelOrderMessage* msg = reinterpret_cast<const CancelOrderMessage*>(data);
+                MX_AUDIT("[Engine] CANCEL_ORDER user={} client_id={} symbol={}",
+                         msg->user_id, msg->client_order_id, log_text(msg->symbol));
+                manager.handle_cancel_order(*msg, received_ns);
+            }
+            break;
+        }
+        
+        case MessageType::REPLACE_ORDER: {
+            if (length >= sizeof(ReplaceOrderMessage)) {
+                const ReplaceOrderMessage* msg = reinterpret_cast<const ReplaceOrderMessage*>(data);
+                MX_AUDIT("[Engine] REPLACE_ORDER user={} client_id={} new_client_id={} symbol={} price={} qty={}",
+                         msg->user_id, msg->client_order_id, msg->new_client_order_id,
+                         log_text(msg->symbol), msg->price, msg->quantity);
+                manager.handle_replace_order(*msg, received_ns);
+            }
+            break;
+        }
+        
+        case MessageType::MASS_CANCEL: {
+            if (length >= sizeof(MassCancelMessage)) {
+                const MassCancelMessage* msg = reinterpret_cast<const MassCancelMessage*>(data);
+                MX_AUDIT("[Engine] MASS_CANCEL user={} side={}", msg->user_id,
+                         msg->side == 0 ? "BOTH" : msg->side == static_cast<uint8_t>(Side::BUY) ? "BUY" : "SELL");
+                manager.handle_mass_cancel(*msg, received_ns);
             }
             break;
         }
         
         case MessageType::HEARTBEAT: {
             // Echo heartbeat back
-            std::cout << "[Engine] Received HEARTBEAT" << std::endl;
+            MX_LOG_TRACE("[Engine] Received HEARTBEAT");
             break;
         }
         
         default:
-            std::cout << "[Engine] Unknown message type: " << static_cast<int>(msg_type) << std::endl;
+            MX_LOG_WARN("[Engine] Unknown message type: {}", msg_type);
             break;
     }
 }
 
 // =============================================================================
-// MESSAGE LOOP
+// SNAPSHOTS & RECOVERY
 // =============================================================================
 
-void run_message_loop(OrderManager& manager, IPCServer& ipc) {
-    std::vector<uint8_t> buffer;
-    buffer.resize(4096); // 4KB buffer for messages
+template <typename Engine>
+void take_snapshot(Engine& manager, const DurabilityOptions& durability, uint64_t sequence) {
+    auto start = std::chrono::steady_clock::now();
+    std::string root = durability.snapshot_root();
     
-    while (g_running && ipc.is_connected()) {
-        // Read message header first
-        MessageHeader header;
-        ssize_t bytes_read = ipc.read_message(&header, sizeof(header));
-        
-        if (bytes_read < 0) {
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                std::this_thread::sleep_for(std::chrono::microseconds(100));
-                continue;
-            }
-            std::cerr << "[Engine] Error reading header: " << strerror(errno) << std::endl;
-            break;
+    if (!ensure_directory(root) ||
+        !manager.save_snapshot(snapshot_directory(root, sequence), sequence)) {
+        std::cerr << "[Engine] Snapshot at sequence " << sequence << " failed" << std::endl;
+        return;
+    }
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cout << "[Engine] Snapshot at sequence " << sequence
+              << " (" << elapsed << " us)" << std::endl;
+}
+
+// Replay is asynchronous in sharded mode; wait for the shards to catch up
+void wait_until_applied(OrderManager&) {}
+void wait_until_applied(ShardedEngine& engine) { engine.wait_idle(); }
+
+// Apply every journal record after applied, straight to the order manager
+// (no logging, no outbound messages); applied ends at the last one. Each
+// record is handled at its journaled receive time, so recovered orders
+// carry their original book times
+template <typename Engine>
+bool replay_journal(Engine& manager, const std::string& directory, uint64_t& applied) {
+    JournalReader reader;
+    if (!reader.open(directory, applied)) {
+        return true;    // No journal yet
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    uint64_t replayed = 0;
+    JournalEntry entry;
+    
+    while (reader.next(entry)) {
+        const MessageHeader* header = reinterpret_cast<const MessageHeader*>(entry.data);
+        switch (header->get_type()) {
+            case MessageType::NEW_ORDER:
+                if (entry.length >= sizeof(NewOrderMessage)) {
+                    manager.handle_new_order(*reinterpret_cast<const NewOrderMessage*>(entry.data), entry.timestamp);
+                }
+                break;
+            
+            case MessageType::CANCEL_ORDER:
+                if (entry.length >= sizeof(CancelOrderMessage)) {
+                    manager.handle_cancel_order(*reinterpret_cast<const CancelOrderMessage*>(entry.data), entry.timestamp);
+                }
+                break;
+            
+            case MessageType::REPLACE_ORDER:
+                if (entry.length >= sizeof(ReplaceOrderMessage)) {
+                    manager.handle_replace_order(*reinterpret_cast<const ReplaceOrderMessage*>(entry.data), entry.timestamp);
+                }
+                break;
+            
+            case MessageType::MASS_CANCEL:
+                if (entry.length >= sizeof(MassCancelMessage)) {
+                    manager.handle_mass_cancel(*reinterpret_cast<const MassCancelMessage*>(entry.data), entry.timestamp);
+                }
+                break;
+            
+            default:
+                break;
         }
-        
-        if (bytes_read == 0) {
-            std::cout << "[Engine] Gateway disconnected" << std::endl;
-            break;
+        applied = entry.sequence;
+        replayed++;
+    }
+    wait_until_applied(manager);
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[Engine] Replayed " << replayed << " journal records in " << seconds << " s";
+    if (seconds > 0 && replayed > 0) {
+        std::cout << " (" << static_cast<uint64_t>(replayed / seconds) << " msgs/sec)";
+    }
+    std::cout << std::endl;
+    
+    if (reader.has_gap()) {
+        std::cerr << "[Engine] Journal is missing records after sequence " << applied << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Latest snapshot (if any) followed by the journal records after it
+template <typename Engine>
+bool recover_state(Engine& manager, const DurabilityOptions& durability,
+                   uint64_t& applied, uint64_t& snapshot_sequence) {
+    applied = 0;
+    snapshot_sequence = 0;
+    
+    std::string snapshot;
+    if (find_latest_snapshot(durability.snapshot_root(), snapshot, snapshot_sequence)) {
+        if (!manager.load_snapshot(snapshot, applied)) {
+            std::cerr << "[Engine] Failed to load snapshot " << snapshot << std::endl;
+            return false;
         }
-        
-        if (bytes_read != sizeof(header)) {
-            std::cerr << "[Engine] Incomplete header received" << std::endl;
+        std::cout << "[Engine] Loaded snapshot at sequence " << applied << std::endl;
+    }
+    
+    return replay_journal(manager, durability.journal.directory, applied);
+}
+
+// =============================================================================
+// MESSAGE LOOP
+// =============================================================================
+
+// Stages timed on the message loop thread, in TSC ticks. Match and send
+// are timed by the engine itself (get_latency()).
+struct LoopLatency {
+    Histogram recv;     // First bytes seen to whole message in hand
+    Histogram parse;    // Validation, journaling and dispatch up to the engine
+};
+
+template <typename Engine, typename Transport>
+void run_message_loop(Engine& manager, Transport& ipc, Journal* journal,
+                      const DurabilityOptions& durability, uint64_t& last_snapshot,
+                      LoopLatency& loop_latency) {
+    while (g_running && ipc.is_connected()) {
+        size_t length = 0;
+        const uint8_t* message = ipc.receive(length);
+        if (!message) {
             continue;
         }
+        uint64_t received = read_tsc();
+        loop_latency.recv.record(received - ipc.received_at());
+        
+        // The one wall-clock stamp for this message: journal record, book
+        // and every reply carry it
+        uint64_t received_ns = wall_ns_at(ipc.received_at());
+        const MessageHeader& header = *reinterpret_cast<const MessageHeader*>(message);
         
         // Validate protocol version
         if (header.version != PROTOCOL_VERSION) {
-            std::cerr << "[Engine] Invalid protocol version: " << (int)header.version << std::endl;
+            MX_LOG_WARN("[Engine] Invalid protocol version: {}", header.version);
+            ipc.release();
             continue;
         }
         
-        // Read rest of message if needed
-        size_t remaining = header.length - sizeof(header);
-        if (remaining > 0) {
-            if (remaining > buffer.size()) {
-                buffer.resize(remaining);
+        // Journal orders and cancels before applying them; the copy is
+        // queued here and written by the journal thread
+        MessageType msg_type = header.get_type();
+        bool journaled = journal &&
+                         (msg_type == MessageType::NEW_ORDER || msg_type == MessageType::CANCEL_ORDER ||
+                          msg_type == MessageType::REPLACE_ORDER || msg_type == MessageType::MASS_CANCEL);
+        if (journaled && journal->append(message, length, received_ns) == 0) {
+            // Never apply what the journal did not take
+            std::cerr << "[Engine] Journal append failed, stopping" << std::endl;
+            ipc.release();
+            break;
+        }
+        loop_latency.parse.record_since(received);
+        
+        // Process the message
+        process_message(manager, header, message, length, received_ns);
+        ipc.release();
+        
+        if (journaled) {
+            if (journal->failed()) {
+                std::cerr << "[Engine] Journal write failed, stopping" << std::endl;
+                break;
             }
             
-            // Copy header to buffer
-            memcpy(buffer.data(), &header, sizeof(header));
-            
-            // Read remaining bytes
-            ssize_t remaining_read = ipc.read_message(buffer.data() + sizeof(header), remaining);
-            if (remaining_read != static_cast<ssize_t>(remaining)) {
-                std::cerr << "[Engine] Incomplete message body" << std::endl;
-                continue;
+            uint64_t sequence = journal->last_sequence();
+            if (durability.snapshot_every && sequence - last_snapshot >= durability.snapshot_every) {
+                take_snapshot(manager, durability, sequence);
+                last_snapshot = sequence;
             }
-        } else {
-            // Just the header
-            memcpy(buffer.data(), &header, sizeof(header));
         }
-        
-        // Process the message
-        process_message(manager, header, buffer);
     }
 }
 
@@ -278,10 +638,65 @@ void run_message_loop(OrderManager& manager, IPCServer& ipc) {
 // STATISTICS REPORTER
 // =============================================================================
 
-void run_statistics_reporter(OrderManager& manager) {
+// Every histogram's counts at one moment
+struct StageSnapshots {
+    Snapshot recv;
+    Snapshot parse;
+    Snapshot match;
+    Snapshot send;
+    
+    template <typename Engine>
+    void take(const Engine& manager, const LoopLatency& loop_latency) {
+        loop_latency.recv.snapshot(recv);
+        loop_latency.parse.snapshot(parse);
+        OrderManager::LatencyStatistics engine_latency;
+        manager.get_latency(engine_latency);
+        match = engine_latency.match;
+        send = engine_latency.send;
+    }
+    
+    void subtract(const StageSnapshots& earlier) {
+        recv.subtract(earlier.recv);
+        parse.subtract(earlier.parse);
+        match.subtract(earlier.match);
+        send.subtract(earlier.send);
+    }
+};
+
+void print_stage_latency(const char* stage, const Snapshot& snapshot) {
+    Summary summary = summarize(snapshot);
+    char line[128];
+    if (summary.count == 0) {
+        snprintf(line, sizeof(line), "  %-8s        -         -         -         -", stage);
+    } else {
+        snprintf(line, sizeof(line), "  %-8s %9.2f %9.2f %9.2f %9.2f", stage,
+                 summary.p50_us, summary.p99_us, summary.p999_us, summary.max_us);
+    }
+    std::cout << line << std::endl;
+}
+
+void print_stage_latencies(const StageSnapshots& stages) {
+    char header[128];
+    snprintf(header, sizeof(header), "%-10s %9s %9s %9s %9s", "Latency us", "p50", "p99", "p99.9", "max");
+    std::cout << header << std::endl;
+    print_stage_latency("Recv", stages.recv);
+    print_stage_latency("Parse", stages.parse);
+    print_stage_latency("Match", stages.match);
+    print_stage_latency("Send", stages.send);
+}
+
+template <typename Engine>
+void run_statistics_reporter(Engine& manager, const LoopLatency& loop_latency) {
     auto last_stats = manager.get_statistics();
     auto last_time = std::chrono::steady_clock::now();
     
+    // Percentiles are printed per interval: the difference of consecutive
+    // snapshots of the cumulative histograms
+    std::unique_ptr<StageSnapshots> last_latency(new StageSnapshots());
+    std::unique_ptr<StageSnapshots> current_latency(new StageSnapshots());
+    std::unique_ptr<StageSnapshots> interval_latency(new StageSnapshots());
+    last_latency->take(manager, loop_latency);
+    
     while (g_running) {
         std::this_thread::sleep_for(std::chrono::seconds(10));
         
@@ -302,6 +717,12 @@ void run_statistics_reporter(OrderManager& manager) {
             std::cout << "Total Volume:     " << current_stats.total_volume << std::endl;
             std::cout << "Orders/sec:       " << orders_per_sec << std::endl;
             std::cout << "Executions/sec:   " << executions_per_sec << std::endl;
+            
+            current_latency->take(manager, loop_latency);
+            *interval_latency = *current_latency;
+            interval_latency->subtract(*last_latency);
+            print_stage_latencies(*interval_latency);
+            current_latency.swap(last_latency);
             std::cout << "========================================\n" << std::endl;
             
             last_stats = current_stats;
@@ -311,90 +732,162 @@ void run_statistics_reporter(OrderManager& manager) {
 }
 
 // =============================================================================
-// MAIN
+// ENGINE SETUP
 // =============================================================================
 
-int main(int argc, char* argv[]) {
-    // Parse command line arguments
-    std::string socket_path = "/tmp/matching_engine.sock";
+// Sharded mode runs matching on its own threads; stop them (draining their
+// output) before the IPC connection they write to goes away
+void stop_engine(OrderManager&) {}
+void stop_engine(ShardedEngine& engine) { engine.stop(); }
+
+// One market data source per matching thread
+size_t market_data_sources(OrderManager&) { return 1; }
+size_t market_data_sources(ShardedEngine& engine) { return engine.shard_count(); }
+
+void attach_market_data(OrderManager& manager, const std::vector<MarketDataSource*>& sources) {
+    manager.set_market_data(sources[0]);
+}
+void attach_market_data(ShardedEngine& engine, const std::vector<MarketDataSource*>& sources) {
+    engine.set_market_data(sources);
+}
+
+// Lines of "SYMBOL [SHARD]"; blank lines and # comments are skipped
+bool load_symbols_file(const std::string& path, std::vector<std::string>& symbols,
+                       ShardConfig& shards) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot open symbols file: " << path << std::endl;
+        return false;
+    }
     
-    for (int i = 1; i < argc; i++) {
-        std::string arg = argv[i];
-        
-        if (arg == "--help" || arg == "-h") {
-            print_usage(argv[0]);
-            return 0;
-        }
-        
-        if (arg == "--version" || arg == "-v") {
-            print_version();
-            return 0;
+    symbols.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string symbol;
+        if (!(fields >> symbol) || symbol[0] == '#') {
+            continue;
         }
-        
-        // If it's not a flag, treat it as socket path
-        if (arg[0] != '-') {
-            socket_path = arg;
+        uint32_t shard;
+        if (fields >> shard) {
+            shards.assignments[symbol] = shard;
         }
+        symbols.push_back(symbol);
+    }
+    return true;
+}
+
+template <typename Engine, typename Transport>
+int run_engine(Engine& manager, Transport& ipc, const std::vector<std::string>& symbols,
+               const DurabilityOptions& durability, const MarketDataConfig& market_data) {
+    // Add trading symbols
+    for (const auto& symbol : symbols) {
+        manager.add_symbol(symbol);
     }
     
-    std::cout << "========================================" << std::endl;
-    std::cout << "   MATCHING ENGINE v1.0" << std::endl;
-    std::cout << "========================================\n" << std::endl;
+    std::cout << "[Engine] Configured with " << symbols.size() << " symbols" << std::endl;
     
-    // Setup signal handlers
-    setup_signal_handlers();
+    // Recover and open the journal before any outbound messages are wired up,
+    // so replayed acks and executions go nowhere
+    std::unique_ptr<Journal> journal;
+    uint64_t applied = 0;
+    uint64_t last_snapshot = 0;
     
-    // Create order manager
-    OrderManager manager;
-    g_order_manager = &manager;
+    if (durability.journal_enabled) {
+        if (durability.recover) {
+            if (!recover_state(manager, durability, applied, last_snapshot)) {
+                std::cerr << "[Engine] Recovery failed" << std::endl;
+                return 1;
+            }
+        } else {
+            JournalReader probe;
+            JournalEntry entry;
+            if (probe.open(durability.journal.directory, 0) && probe.next(entry)) {
+                std::cerr << "[Engine] Journal " << durability.journal.directory
+                          << " already has records; start with --recover" << std::endl;
+                return 1;
+            }
+        }
+        
+        journal.reset(new Journal(durability.journal));
+        if (!journal->open(applied)) {
+            std::cerr << "[Engine] Failed to open journal" << std::endl;
+            return 1;
+        }
+        std::cout << "[Engine] Journaling to " << durability.journal.directory
+                  << " from sequence " << journal->last_sequence() + 1 << std::endl;
+    }
     
-    // Setup IPC server
-    IPCServer ipc(socket_path);
+    // Publish depth from the recovered books on. The publisher runs before
+    // the managers attach, since attaching replays every resting order
+    // into its queues.
+    std::unique_ptr<MarketDataPublisher> publisher;
+    if (market_data.enabled()) {
+        publisher.reset(new MarketDataPublisher(market_data));
+        std::vector<MarketDataSource*> sources;
+        for (size_t i = 0; i < market_data_sources(manager); i++) {
+            sources.push_back(publisher->add_source());
+        }
+        if (!publisher->start()) {
+            stop_engine(manager);
+            return 1;
+        }
+        attach_market_data(manager, sources);
+    }
     
     // Set message callback to send via IPC
     manager.set_message_callback([&ipc](const void* data, size_t size) {
         if (ipc.is_connected()) {
             ssize_t sent = ipc.write_message(data, size);
             if (sent != static_cast<ssize_t>(size)) {
-                std::cerr << "[Engine] Failed to send message: " << strerror(errno) << std::endl;
+                MX_LOG_ERROR("[Engine] Failed to send message: {}", strerror(errno));
             }
         }
     });
     
-    // Add default trading symbols
-    std::vector<std::string> symbols = {"AAPL", "GOOGL", "MSFT", "AMZN", "TSLA"};
-    for (const auto& symbol : symbols) {
-        manager.add_symbol(symbol);
-    }
-    
-    std::cout << "[Engine] Configured with " << symbols.size() << " symbols" << std::endl;
-    
     // Start IPC server
     if (!ipc.start()) {
         std::cerr << "[Engine] Failed to start IPC server" << std::endl;
+        stop_engine(manager);
         return 1;
     }
     
     // Wait for gateway connection
     if (!ipc.accept_connection()) {
         std::cerr << "[Engine] Failed to accept gateway connection" << std::endl;
+        stop_engine(manager);
         return 1;
     }
     
     // Start statistics reporter thread
-    std::thread stats_thread(run_statistics_reporter, std::ref(manager));
+    LoopLatency loop_latency;
+    std::thread stats_thread(run_statistics_reporter<Engine>, std::ref(manager),
+                             std::cref(loop_latency));
     
     // Run message loop (blocking)
     std::cout << "[Engine] Starting message loop..." << std::endl;
-    run_message_loop(manager, ipc);
+    run_message_loop(manager, ipc, journal.get(), durability, last_snapshot, loop_latency);
     
     // Cleanup
     std::cout << "[Engine] Shutting down..." << std::endl;
     g_running = false;
+    stop_engine(manager);
+    if (publisher) {
+        publisher->stop();
+    }
     
     if (stats_thread.joinable()) {
         stats_thread.join();
     }
+    Logger::instance().stop();
+    
+    // Flush the journal, then snapshot so the next recovery replays nothing
+    if (journal) {
+        journal->close();
+        if (!journal->failed() && journal->last_sequence() > last_snapshot) {
+            take_snapshot(manager, durability, journal->last_sequence());
+        }
+    }
     
     // Print final statistics
     auto final_stats = manager.get_statistics();
@@ -405,8 +898,224 @@ int main(int argc, char* argv[]) {
     std::cout << "Cancelled:        " << final_stats.total_orders_cancelled << std::endl;
     std::cout << "Executions:       " << final_stats.total_executions << std::endl;
     std::cout << "Total Volume:     " << final_stats.total_volume << std::endl;
+    if (journal) {
+        auto journal_stats = journal->get_statistics();
+        std::cout << "Journaled:        " << journal_stats.records_written << std::endl;
+        std::cout << "Journal Writes:   " << journal_stats.write_calls << std::endl;
+        std::cout << "Journal Syncs:    " << journal_stats.sync_calls << std::endl;
+        std::cout << "Durable Sequence: " << journal->durable_sequence() << std::endl;
+    }
+    if (publisher) {
+        auto md_stats = publisher->get_statistics();
+        std::cout << "Level Updates:    " << md_stats.level_updates << std::endl;
+        std::cout << "MD Packets:       " << md_stats.packets_sent << std::endl;
+        std::cout << "MD Retransmits:   " << md_stats.packets_retransmitted << std::endl;
+    }
+    std::unique_ptr<StageSnapshots> final_latency(new StageSnapshots());
+    final_latency->take(manager, loop_latency);
+    print_stage_latencies(*final_latency);
     std::cout << "======================================\n" << std::endl;
     
     std::cout << "[Engine] Shutdown complete" << std::endl;
     return 0;
 }
+
+struct TransportOptions {
+    std::string socket_path;
+    std::string shm_name;       // Non-empty selects the shared memory rings
+    WaitMode wait_mode;
+    
+    TransportOptions()
+        : socket_path("/tmp/matching_engine.sock")
+        , wait_mode(WaitMode::ADAPTIVE)
+    {}
+};
+
+template <typename Engine>
+int run_with_transport(Engine& manager, const TransportOptions& transport, const std::vector<std::string>& symbols,
+                       const DurabilityOptions& durability, const MarketDataConfig& market_data) {
+    if (!transport.shm_name.empty()) {
+        ShmIPCServer ipc(transport.shm_name, transport.wait_mode);
+        return run_engine(manager, ipc, symbols, durability, market_data);
+    }
+    
+    IPCServer ipc(transport.socket_path);
+    return run_engine(manager, ipc, symbols, durability, market_data);
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(int argc, char* argv[]) {
+    // Parse command line arguments
+    TransportOptions transport;
+    DurabilityOptions durability;
+    ShardConfig shards;
+    LogConfig logging;
+    MarketDataConfig market_data;
+    std::vector<std::string> symbols = {"AAPL", "GOOGL", "MSFT", "AMZN", "TSLA"};
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        
+        if (arg == "--help" || arg == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        }
+        
+        if (arg == "--version" || arg == "-v") {
+            print_version();
+            return 0;
+        }
+        
+        if (arg == "--journal" && has_value) {
+            durability.journal_enabled = true;
+            durability.journal.directory = argv[++i];
+            continue;
+        }
+        
+        if (arg == "--sync" && has_value) {
+            std::string mode = argv[++i];
+            if (mode == "none") {
+                durability.journal.sync_mode = SyncMode::NONE;
+            } else if (mode == "batch") {
+                durability.journal.sync_mode = SyncMode::BATCH;
+            } else if (mode == "interval") {
+                durability.journal.sync_mode = SyncMode::INTERVAL;
+            } else {
+                std::cerr << "Unknown sync mode: " << mode << std::endl;
+                return 1;
+            }
+            continue;
+        }
+        
+        if (arg == "--sync-interval-us" && has_value) {
+            durability.journal.sync_interval_us = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            continue;
+        }
+        
+        if (arg == "--segment-mb" && has_value) {
+            durability.journal.segment_size = std::strtoull(argv[++i], nullptr, 10) << 20;
+            continue;
+        }
+        
+        if (arg == "--snapshot-every" && has_value) {
+            durability.snapshot_every = std::strtoull(argv[++i], nullptr, 10);
+            continue;
+        }
+        
+        if (arg == "--recover") {
+            durability.recover = true;
+            continue;
+        }
+        
+        if (arg == "--shm" && has_value) {
+            transport.shm_name = argv[++i];
+            continue;
+        }
+        
+        if (arg == "--wait" && has_value) {
+            if (!parse_wait_mode(argv[++i], transport.wait_mode)) {
+                std::cerr << "Unknown wait mode: " << argv[i] << std::endl;
+                return 1;
+            }
+            continue;
+        }
+        
+        if (arg == "--shards" && has_value) {
+            shards.shard_count = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            continue;
+        }
+        
+        if (arg == "--pin-cores" && has_value) {
+            std::istringstream list(argv[++i]);
+            std::string core;
+            while (std::getline(list, core, ',')) {
+                shards.cores.push_back(std::atoi(core.c_str()));
+            }
+            continue;
+        }
+        
+        if (arg == "--log-level" && has_value) {
+            if (!parse_log_level(argv[++i], logging.level)) {
+                std::cerr << "Unknown log level: " << argv[i] << std::endl;
+                return 1;
+            }
+            continue;
+        }
+        
+        if (arg == "--log-file" && has_value) {
+            logging.log_path = argv[++i];
+            continue;
+        }
+        
+        if (arg == "--audit-log" && has_value) {
+            logging.audit_path = argv[++i];
+            continue;
+        }
+        
+        if (arg == "--no-audit") {
+            logging.audit = false;
+            continue;
+        }
+        
+        if (arg == "--md-group" && has_value) {
+            market_data.group = argv[++i];
+            continue;
+        }
+        
+        if (arg == "--md-port" && has_value) {
+            market_data.port = static_cast<uint16_t>(std::strtoul(argv[++i], nullptr, 10));
+            continue;
+        }
+        
+        if (arg == "--md-interface" && has_value) {
+            market_data.interface = argv[++i];
+            continue;
+        }
+        
+        if (arg == "--md-snapshot-ms" && has_value) {
+            market_data.snapshot_interval_ms = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            continue;
+        }
+        
+        if (arg == "--md-conflation-us" && has_value) {
+            market_data.conflation_window_us = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            continue;
+        }
+        
+        if (arg == "--symbols-file" && has_value) {
+            if (!load_symbols_file(argv[++i], symbols, shards)) {
+                return 1;
+            }
+            continue;
+        }
+        
+        // If it's not a flag, treat it as socket path
+        if (arg[0] != '-') {
+            transport.socket_path = arg;
+        }
+    }
+    
+    std::cout << "========================================" << std::endl;
+    std::cout << "   MATCHING ENGINE v1.0" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+    
+    // Setup signal handlers
+    setup_signal_handlers();
+    
+    if (!Logger::instance().start(logging)) {
+        return 1;
+    }
+    
+    if (shards.shard_count > 0) {
+        ShardedEngine engine(shards);
+        std::cout << "[Engine] Running " << engine.shard_count() << " shards" << std::endl;
+        return run_with_transport(engine, transport, symbols, durability, market_data);
+    }
+    
+    OrderManager manager;
+    return run_with_transport(manager, transport, symbols, durability, market_data);
+}
@@ -0,0 +1,815 @@
+#include "market_data.h"
+#include "../../common/shm_transport.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace matching {
+namespace engine {
+
+namespace md = market_data;
+
+// =============================================================================
+// HELPERS
+// =============================================================================
+
+namespace {
+
+constexpr size_t MAX_DRAIN = 256;                   // Deltas per source per round
+constexpr uint32_t HOUSEKEEPING_ROUNDS = 64;        // Busy rounds between timer / socket checks
+constexpr uint64_t HEARTBEAT_NS = 1000000000ull;    // Idle incremental channel
+constexpr uint64_t SUBSCRIPTION_TIMEOUT_NS = 10000000000ull;
+constexpr uint64_t MIN_WINDOW_NS = 1000000ull;
+constexpr size_t MAX_SUBSCRIBERS = 64;
+constexpr size_t MAX_RETRANSMIT_PACKETS = 256;      // Per request
+constexpr uint64_t TOKEN_ROTATION_NS = 60000000000ull;
+constexpr uint64_t REPLY_WINDOW_NS = 1000000000ull;
+constexpr uint32_t MAX_REPLY_PACKETS = 1024;        // Per source address per window
+constexpr size_t MAX_REPLY_SOURCES = 4096;
+
+uint64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+uint64_t wall_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+// SipHash-2-4 of one 64-bit word: cheap, and a token for one address
+// tells nothing about the key or another address's token
+uint64_t sip_hash(const uint64_t key[2], uint64_t message) {
+    auto rotl = [](uint64_t x, int b) { return (x << b) | (x >> (64 - b)); };
+    uint64_t v0 = key[0] ^ 0x736f6d6570736575ull;
+    uint64_t v1 = key[1] ^ 0x646f72616e646f6dull;
+    uint64_t v2 = key[0] ^ 0x6c7967656e657261ull;
+    uint64_t v3 = key[1] ^ 0x7465646279746573ull;
+    auto rounds = [&](int count) {
+        for (int i = 0; i < count; i++) {
+            v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+            v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+            v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+            v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+        }
+    };
+    
+    v3 ^= message;
+    rounds(2);
+    v0 ^= message;
+    
+    const uint64_t length = 8ull << 56;
+    v3 ^= length;
+    rounds(2);
+    v0 ^= length;
+    
+    v2 ^= 0xff;
+    rounds(4);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+bool same_address(const sockaddr_in& a, const sockaddr_in& b) {
+    return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+}
+
+bool parse_address(const std::string& text, uint16_t port, sockaddr_in& address) {
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    return inet_pton(AF_INET, text.c_str(), &address.sin_addr) == 1;
+}
+
+} // namespace
+
+// =============================================================================
+// CONSTRUCTOR / DESTRUCTOR
+// =============================================================================
+
+MarketDataPublisher::MarketDataPublisher(const MarketDataConfig& config)
+    : config_(config)
+    , next_sequence_(1)
+    , next_snapshot_sequence_(1)
+    , last_send_ns_(0)
+    , next_snapshot_ns_(0)
+    , sent_count_(0)
+    , feed_fd_(-1)
+    , recovery_fd_(-1)
+    , next_rotation_ns_(0)
+    , next_budget_sweep_ns_(0)
+    , running_(false)
+    , level_updates_(0)
+    , packets_sent_(0)
+    , snapshots_sent_(0)
+    , packets_retransmitted_(0)
+    , conflated_updates_(0)
+    , subscriber_count_(0)
+{
+    config_.retransmit_packets = std::max(config_.retransmit_packets, 1u);
+    config_.conflation_packets = std::max(config_.conflation_packets, 1u);
+    memset(&incremental_address_, 0, sizeof(incremental_address_));
+    memset(&snapshot_address_, 0, sizeof(snapshot_address_));
+    memset(token_key_, 0, sizeof(token_key_));
+    memset(previous_token_key_, 0, sizeof(previous_token_key_));
+}
+
+MarketDataPublisher::~MarketDataPublisher() {
+    stop();
+}
+
+MarketDataSource* MarketDataPublisher::add_source() {
+    sources_.emplace_back(new MarketDataSource(config_.queue_capacity));
+    return sources_.back().get();
+}
+
+// =============================================================================
+// START / STOP
+// =============================================================================
+
+bool MarketDataPublisher::start() {
+    if (!parse_address(config_.group, config_.port, incremental_address_) ||
+        !parse_address(config_.group, static_cast<uint16_t>(config_.port + 1), snapshot_address_)) {
+        std::cerr << "[MarketData] Invalid group address: " << config_.group << std::endl;
+        return false;
+    }
+    
+    feed_fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    recovery_fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (feed_fd_ < 0 || recovery_fd_ < 0) {
+        std::cerr << "[MarketData] Failed to create sockets: " << strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+    
+    // Multicast options only apply to a group; a unicast destination
+    // (one receiver, or testing on loopback) is sent to as is
+    if (IN_MULTICAST(ntohl(incremental_address_.sin_addr.s_addr))) {
+        int ttl = config_.ttl;
+        int loop = 1;
+        setsockopt(feed_fd_, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+        setsockopt(feed_fd_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+        
+        if (!config_.interface.empty()) {
+            in_addr interface;
+            if (inet_pton(AF_INET, config_.interface.c_str(), &interface) != 1 ||
+                setsockopt(feed_fd_, IPPROTO_IP, IP_MULTICAST_IF, &interface, sizeof(interface)) != 0) {
+                std::cerr << "[MarketData] Invalid interface address: " << config_.interface << std::endl;
+                stop();
+                return false;
+            }
+        }
+    }
+    
+    int reuse = 1;
+    setsockopt(recovery_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    
+    // Only reachable where the feed is published from, when that is set
+    sockaddr_in recovery;
+    if (config_.interface.empty()) {
+        parse_address("0.0.0.0", static_cast<uint16_t>(config_.port + 2), recovery);
+    } else if (!parse_address(config_.interface, static_cast<uint16_t>(config_.port + 2), recovery)) {
+        std::cerr << "[MarketData] Invalid interface address: " << config_.interface << std::endl;
+        stop();
+        return false;
+    }
+    if (bind(recovery_fd_, reinterpret_cast<sockaddr*>(&recovery), sizeof(recovery)) != 0) {
+        std::cerr << "[MarketData] Failed to bind recovery port " << config_.port + 2
+                  << ": " << strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+    fcntl(recovery_fd_, F_SETFL, fcntl(recovery_fd_, F_GETFL, 0) | O_NONBLOCK);
+    
+    sent_.reset(new SentPacket[config_.retransmit_packets]);
+    rotate_token_key();
+    rotate_token_key();     // Twice, so neither accepted key is the zeroed one
+    next_rotation_ns_ = steady_ns() + TOKEN_ROTATION_NS;
+    
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&MarketDataPublisher::run, this);
+    
+    std::cout << "[MarketData] Publishing to " << config_.group << ":" << config_.port
+              << " (snapshot " << config_.port + 1 << ", recovery " << config_.port + 2 << ")" << std::endl;
+    return true;
+}
+
+void MarketDataPublisher::stop() {
+    running_.store(false, std::memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    
+    if (feed_fd_ >= 0) {
+        close(feed_fd_);
+        feed_fd_ = -1;
+    }
+    if (recovery_fd_ >= 0) {
+        close(recovery_fd_);
+        recovery_fd_ = -1;
+    }
+}
+
+MarketDataPublisher::Statistics MarketDataPublisher::get_statistics() const {
+    Statistics stats;
+    stats.level_updates = level_updates_.load(std::memory_order_relaxed);
+    stats.packets_sent = packets_sent_.load(std::memory_order_relaxed);
+    stats.snapshots_sent = snapshots_sent_.load(std::memory_order_relaxed);
+    stats.packets_retransmitted = packets_retransmitted_.load(std::memory_order_relaxed);
+    stats.conflated_updates = conflated_updates_.load(std::memory_order_relaxed);
+    stats.subscribers = subscriber_count_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// =============================================================================
+// PUBLISHING THREAD
+// =============================================================================
+
+void MarketDataPublisher::run() {
+    transport::Backoff backoff(transport::WaitMode::ADAPTIVE);
+    uint32_t busy_rounds = 0;
+    last_send_ns_ = steady_ns();
+    next_snapshot_ns_ = last_send_ns_ + config_.snapshot_interval_ms * 1000000ull;
+    
+    for (;;) {
+        // Read before draining, so everything published before stop() is sent
+        bool stopping = !running_.load(std::memory_order_acquire);
+        size_t applied = drain_sources();
+        
+        if (applied > 0 && ++busy_rounds < HOUSEKEEPING_ROUNDS) {
+            backoff.reset();
+            continue;
+        }
+        busy_rounds = 0;
+        
+        // Sources have caught up (or we have been busy a while): send the
+        // partial packet rather than wait for it to fill
+        flush_incremental();
+        
+        uint64_t now = steady_ns();
+        if (now - last_send_ns_ >= HEARTBEAT_NS) {
+            Packet heartbeat;
+            begin_packet(heartbeat, md::Channel::INCREMENTAL, next_sequence_);
+            send_packet(feed_fd_, incremental_address_, heartbeat);
+            last_send_ns_ = now;
+        }
+        if (config_.snapshot_interval_ms > 0 && now >= next_snapshot_ns_) {
+            send_snapshots();
+            next_snapshot_ns_ = now + config_.snapshot_interval_ms * 1000000ull;
+        }
+        poll_recovery(now);
+        flush_subscribers(now);
+        
+        if (applied > 0) {
+            backoff.reset();
+        } else if (stopping) {
+            break;
+        } else {
+            backoff.idle();
+        }
+    }
+}
+
+size_t MarketDataPublisher::drain_sources() {
+    size_t applied = 0;
+    for (auto& source : sources_) {
+        for (size_t i = 0; i < MAX_DRAIN; i++) {
+            DepthDelta* delta = source->queue_.front();
+            if (!delta) {
+                break;
+            }
+            apply(*source, *delta);
+            source->queue_.pop();
+            applied++;
+        }
+    }
+    return applied;
+}
+
+void MarketDataPublisher::apply(MarketDataSource& source, const DepthDelta& delta) {
+    if (delta.kind == DepthDelta::DEFINE_SYMBOL) {
+        define_symbol(source, delta);
+        return;
+    }
+    
+    if (delta.symbol_id < source.feed_ids_.size() && source.feed_ids_[delta.symbol_id] != SymbolTable::NONE) {
+        apply_level(source.feed_ids_[delta.symbol_id], delta);
+    }
+}
+
+void MarketDataPublisher::define_symbol(MarketDataSource& source, const DepthDelta& delta) {
+    uint32_t symbol_id = symbols_.intern(std::string(delta.symbol, strnlen(delta.symbol, sizeof(delta.symbol))));
+    if (symbol_id == SymbolTable::NONE) {
+        return;
+    }
+    
+    if (source.feed_ids_.size() <= delta.symbol_id) {
+        source.feed_ids_.resize(delta.symbol_id + 1, SymbolTable::NONE);
+    }
+    source.feed_ids_[delta.symbol_id] = symbol_id;
+    
+    if (symbol_id < books_.size()) {
+        return; // Already on the feed
+    }
+    books_.emplace_back();
+    memcpy(books_.back().name, symbols_.name(symbol_id), sizeof(books_.back().name));
+    
+    md::SymbolDefinition definition;
+    definition.symbol_id = symbol_id;
+    memcpy(definition.symbol, books_.back().name, sizeof(definition.symbol));
+    add_incremental(&definition, sizeof(definition));
+}
+
+void MarketDataPublisher::apply_level(uint32_t symbol_id, const DepthDelta& delta) {
+    if (delta.quantity == 0 && delta.orders == 0) {
+        return;
+    }
+    
+    md::LevelUpdate update;
+    update.symbol_id = symbol_id;
+    update.side = delta.side;
+    update.price = delta.price;
+    
+    auto change = [&](auto& levels) {
+        auto it = levels.find(delta.price);
+        if (it == levels.end()) {
+            if (delta.quantity <= 0) {
+                return false; // Nothing resting to take away from
+            }
+            it = levels.emplace(delta.price, Level{0, 0}).first;
+            update.action = static_cast<uint8_t>(md::LevelAction::ADD);
+        } else {
+            update.action = static_cast<uint8_t>(md::LevelAction::MODIFY);
+        }
+        
+        Level& level = it->second;
+        int64_t quantity = static_cast<int64_t>(level.quantity) + delta.quantity;
+        int64_t orders = static_cast<int64_t>(level.orders) + delta.orders;
+        if (quantity <= 0 || orders <= 0) {
+            levels.erase(it);
+            update.action = static_cast<uint8_t>(md::LevelAction::DELETE);
+            return true;
+        }
+        
+        level.quantity = static_cast<uint64_t>(quantity);
+        level.orders = static_cast<uint32_t>(orders);
+        update.quantity = level.quantity;
+        update.order_count = level.orders;
+        return true;
+    };
+    
+    SymbolDepth& book = books_[symbol_id];
+    bool changed = delta.side == static_cast<uint8_t>(protocol::Side::BUY) ? change(book.bids) : change(book.asks);
+    if (!changed) {
+        return;
+    }
+    
+    add_incremental(&update, sizeof(update));
+    level_updates_.fetch_add(1, std::memory_order_relaxed);
+    
+    LevelKey key{symbol_id, delta.side, delta.price};
+    for (auto& subscriber : subscribers_) {
+        subscriber->dirty.insert(key);
+    }
+}
+
+// =============================================================================
+// INCREMENTAL CHANNEL
+// =============================================================================
+
+void MarketDataPublisher::add_incremental(const void* message, size_t size) {
+    if (incremental_.size + size > md::MD_MAX_PACKET) {
+        flush_incremental();
+    }
+    if (incremental_.size == 0) {
+        begin_packet(incremental_, md::Channel::INCREMENTAL, next_sequence_);
+    }
+    
+    memcpy(incremental_.data + incremental_.size, message, size);
+    incremental_.size += size;
+    incremental_.header().message_count++;
+    next_sequence_++;
+}
+
+void MarketDataPublisher::flush_incremental() {
+    if (incremental_.size == 0) {
+        return;
+    }
+    send_packet(feed_fd_, incremental_address_, incremental_);
+    keep_for_retransmit(incremental_);
+    incremental_.size = 0;
+    last_send_ns_ = steady_ns();
+}
+
+void MarketDataPublisher::keep_for_retransmit(const Packet& packet) {
+    SentPacket& slot = sent_[sent_count_ % config_.retransmit_packets];
+    const md::PacketHeader* header = reinterpret_cast<const md::PacketHeader*>(packet.data);
+    slot.first_sequence = header->sequence;
+    slot.message_count = header->message_count;
+    slot.size = static_cast<uint16_t>(packet.size);
+    memcpy(slot.data, packet.data, packet.size);
+    sent_count_++;
+}
+
+// =============================================================================
+// SNAPSHOT CHANNEL
+// =============================================================================
+
+void MarketDataPublisher::send_snapshots() {
+    // Every change applied so far goes out first, so the sequences the
+    // snapshots name have been sent
+    flush_incremental();
+    
+    Packet packet;
+    auto add = [&](const void* message, size_t size) {
+        if (packet.size + size > md::MD_MAX_PACKET) {
+            send_packet(feed_fd_, snapshot_address_, packet);
+            packet.size = 0;
+        }
+        if (packet.size == 0) {
+            begin_packet(packet, md::Channel::SNAPSHOT, next_snapshot_sequence_);
+        }
+        memcpy(packet.data + packet.size, message, size);
+        packet.size += size;
+        packet.header().message_count++;
+        next_snapshot_sequence_++;
+    };
+    
+    for (uint32_t symbol_id = 0; symbol_id < books_.size(); symbol_id++) {
+        const SymbolDepth& book = books_[symbol_id];
+        
+        md::SymbolDefinition definition;
+        definition.symbol_id = symbol_id;
+        memcpy(definition.symbol, book.name, sizeof(definition.symbol));
+        add(&definition, sizeof(definition));
+        
+        md::SnapshotBegin begin;
+        begin.symbol_id = symbol_id;
+        begin.last_sequence = next_sequence_ - 1;
+        begin.bid_levels = static_cast<uint32_t>(book.bids.size());
+        begin.ask_levels = static_cast<uint32_t>(book.asks.size());
+        add(&begin, sizeof(begin));
+        
+        for_each_level(symbol_id, [&](uint8_t side, uint64_t price, const Level& level) {
+            md::LevelUpdate update;
+            update.action = static_cast<uint8_t>(md::LevelAction::ADD);
+            update.side = side;
+            update.symbol_id = symbol_id;
+            update.price = price;
+            update.quantity = level.quantity;
+            update.order_count = level.orders;
+            add(&update, sizeof(update));
+        });
+    }
+    
+    if (packet.size > 0) {
+        send_packet(feed_fd_, snapshot_address_, packet);
+    }
+    snapshots_sent_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// =============================================================================
+// RECOVERY PORT
+// =============================================================================
+
+void MarketDataPublisher::poll_recovery(uint64_t now) {
+    if (now >= next_rotation_ns_) {
+        rotate_token_key();
+        next_rotation_ns_ = now + TOKEN_ROTATION_NS;
+    }
+    if (now >= next_budget_sweep_ns_) {
+        for (auto it = reply_budgets_.begin(); it != reply_budgets_.end();) {
+            it = now - it->second.window_start_ns >= REPLY_WINDOW_NS ? reply_budgets_.erase(it) : std::next(it);
+        }
+        next_budget_sweep_ns_ = now + REPLY_WINDOW_NS;
+    }
+    
+    for (int i = 0; i < 64; i++) {
+        md::RecoveryRequest request;
+        sockaddr_in from;
+        socklen_t from_length = sizeof(from);
+        ssize_t received = recvfrom(recovery_fd_, &request, sizeof(request), 0,
+                                    reinterpret_cast<sockaddr*>(&from), &from_length);
+        if (received < 0) {
+            return; // EAGAIN: nothing pending
+        }
+        if (static_cast<size_t>(received) != sizeof(request) || request.magic != md::MD_MAGIC) {
+            continue;
+        }
+        if (!confirmed(from, request.token)) {
+            challenge(from, now);
+            continue;
+        }
+        
+        switch (static_cast<md::MdMessageType>(request.type)) {
+            case md::MdMessageType::RETRANSMIT_REQUEST:
+                retransmit(from, request.first_sequence, request.count, now);
+                break;
+            case md::MdMessageType::SUBSCRIBE:
+                subscribe(from, request.window_us, now);
+                break;
+            case md::MdMessageType::UNSUBSCRIBE:
+                unsubscribe(from);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// The previous key stays valid for one rotation, so a token handed out
+// just before it is not refused straight away
+void MarketDataPublisher::rotate_token_key() {
+    std::random_device random;
+    memcpy(previous_token_key_, token_key_, sizeof(token_key_));
+    for (uint64_t& word : token_key_) {
+        word = (static_cast<uint64_t>(random()) << 32) | random();
+    }
+}
+
+uint64_t MarketDataPublisher::token_for(const sockaddr_in& address, const uint64_t key[2]) const {
+    return sip_hash(key, (static_cast<uint64_t>(address.sin_addr.s_addr) << 16) | address.sin_port);
+}
+
+bool MarketDataPublisher::confirmed(const sockaddr_in& from, uint64_t token) const {
+    return token != 0 &&
+           (token == token_for(from, token_key_) || token == token_for(from, previous_token_key_));
+}
+
+// Smaller than the request it answers, so a spoofed request gains nothing
+void MarketDataPublisher::challenge(const sockaddr_in& to, uint64_t now) {
+    if (!take_reply(to, now)) {
+        return;
+    }
+    md::RecoveryChallenge challenge;
+    challenge.token = token_for(to, token_key_);
+    sendto(recovery_fd_, &challenge, sizeof(challenge), 0, reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+}
+
+// False once the address has had its replies for this window
+bool MarketDataPublisher::take_reply(const sockaddr_in& to, uint64_t now) {
+    auto it = reply_budgets_.find(to.sin_addr.s_addr);
+    if (it == reply_budgets_.end()) {
+        if (reply_budgets_.size() >= MAX_REPLY_SOURCES) {
+            return false; // Too many sources this window; the sweep frees them
+        }
+        it = reply_budgets_.emplace(to.sin_addr.s_addr, ReplyBudget{now, 0}).first;
+    }
+    
+    ReplyBudget& budget = it->second;
+    if (now - budget.window_start_ns >= REPLY_WINDOW_NS) {
+        budget.window_start_ns = now;
+        budget.packets = 0;
+    }
+    if (budget.packets >= MAX_REPLY_PACKETS) {
+        return false;
+    }
+    budget.packets++;
+    return true;
+}
+
+void MarketDataPublisher::retransmit(const sockaddr_in& to, uint64_t first, uint32_t count, uint64_t now) {
+    uint64_t oldest = sent_count_ > config_.retransmit_packets ? sent_count_ - config_.retransmit_packets : 0;
+    auto slot = [&](uint64_t index) -> SentPacket& {
+        return sent_[index % config_.retransmit_packets];
+    };
+    
+    if (count == 0) {
+        return;
+    }
+    if (sent_count_ == 0 || first < slot(oldest).first_sequence) {
+        if (!take_reply(to, now)) {
+            return;
+        }
+        Packet packet;
+        begin_packet(packet, md::Channel::RETRANSMIT, first);
+        md::RetransmitReject reject;
+        reject.first_available = sent_count_ == 0 ? next_sequence_ : slot(oldest).first_sequence;
+        memcpy(packet.data + packet.size, &reject, sizeof(reject));
+        packet.size += sizeof(reject);
+        packet.header().message_count = 1;
+        send_packet(recovery_fd_, to, packet);
+        return;
+    }
+    
+    // Last kept packet starting at or before first
+    uint64_t low = oldest;
+    uint64_t high = sent_count_;
+    while (high - low > 1) {
+        uint64_t middle = low + (high - low) / 2;
+        if (slot(middle).first_sequence <= first) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    
+    uint64_t end = first + count;
+    for (size_t sent = 0; low < sent_count_ && sent < MAX_RETRANSMIT_PACKETS; low++, sent++) {
+        SentPacket& kept = slot(low);
+        if (kept.first_sequence >= end || !take_reply(to, now)) {
+            break;
+        }
+        
+        // Resent as recorded, send time included; only the channel differs
+        Packet packet;
+        memcpy(packet.data, kept.data, kept.size);
+        packet.size = kept.size;
+        packet.header().channel = static_cast<uint8_t>(md::Channel::RETRANSMIT);
+        sendto(recovery_fd_, packet.data, packet.size, 0,
+               reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+        packets_retransmitted_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void MarketDataPublisher::subscribe(const sockaddr_in& from, uint32_t window_us, uint64_t now) {
+    uint64_t window_ns = std::max(static_cast<uint64_t>(window_us ? window_us : config_.conflation_window_us) * 1000,
+                                  MIN_WINDOW_NS);
+    
+    // Renewal
+    for (auto& subscriber : subscribers_) {
+        if (same_address(subscriber->address, from)) {
+            subscriber->window_ns = window_ns;
+            subscriber->last_request_ns = now;
+            return;
+        }
+    }
+    if (subscribers_.size() >= MAX_SUBSCRIBERS) {
+        return;
+    }
+    
+    // Starts with every level dirty, so the first windows deliver the book
+    std::unique_ptr<Subscriber> subscriber(new Subscriber());
+    subscriber->address = from;
+    subscriber->window_ns = window_ns;
+    subscriber->next_flush_ns = now;
+    subscriber->last_request_ns = now;
+    subscriber->sequence = 1;
+    subscriber->symbols_sent = 0;
+    for (uint32_t symbol_id = 0; symbol_id < books_.size(); symbol_id++) {
+        for_each_level(symbol_id, [&](uint8_t side, uint64_t price, const Level&) {
+            subscriber->dirty.insert(LevelKey{symbol_id, side, price});
+        });
+    }
+    subscribers_.push_back(std::move(subscriber));
+    subscriber_count_.store(subscribers_.size(), std::memory_order_relaxed);
+}
+
+void MarketDataPublisher::unsubscribe(const sockaddr_in& from) {
+    subscribers_.erase(std::remove_if(subscribers_.begin(), subscribers_.end(),
+                                      [&](const std::unique_ptr<Subscriber>& subscriber) {
+                                          return same_address(subscriber->address, from);
+                                      }),
+                       subscribers_.end());
+    subscriber_count_.store(subscribers_.size(), std::memory_order_relaxed);
+}
+
+void MarketDataPublisher::flush_subscribers(uint64_t now) {
+    // Subscriptions lapse unless renewed
+    size_t before = subscribers_.size();
+    subscribers_.erase(std::remove_if(subscribers_.begin(), subscribers_.end(),
+                                      [&](const std::unique_ptr<Subscriber>& subscriber) {
+                                          return now - subscriber->last_request_ns > SUBSCRIPTION_TIMEOUT_NS;
+                                      }),
+                       subscribers_.end());
+    if (subscribers_.size() != before) {
+        subscriber_count_.store(subscribers_.size(), std::memory_order_relaxed);
+    }
+    
+    for (auto& subscriber : subscribers_) {
+        if (now >= subscriber->next_flush_ns) {
+            flush_subscriber(*subscriber);
+            subscriber->next_flush_ns = now + subscriber->window_ns;
+        }
+    }
+}
+
+void MarketDataPublisher::flush_subscriber(Subscriber& subscriber) {
+    if (subscriber.symbols_sent == books_.size() && subscriber.dirty.empty()) {
+        return;
+    }
+    
+    Packet packet;
+    uint32_t budget = config_.conflation_packets;
+    
+    // False once the window's packet budget is spent
+    auto add = [&](const void* message, size_t size) {
+        if (packet.size + size > md::MD_MAX_PACKET) {
+            send_packet(recovery_fd_, subscriber.address, packet);
+            packet.size = 0;
+            if (--budget == 0) {
+                return false;
+            }
+        }
+        if (packet.size == 0) {
+            begin_packet(packet, md::Channel::CONFLATED, subscriber.sequence);
+        }
+        memcpy(packet.data + packet.size, message, size);
+        packet.size += size;
+        packet.header().message_count++;
+        subscriber.sequence++;
+        return true;
+    };
+    
+    // Symbols defined since the subscriber last heard
+    while (subscriber.symbols_sent < books_.size()) {
+        md::SymbolDefinition definition;
+        definition.symbol_id = subscriber.symbols_sent;
+        memcpy(definition.symbol, books_[subscriber.symbols_sent].name, sizeof(definition.symbol));
+        if (!add(&definition, sizeof(definition))) {
+            return;
+        }
+        subscriber.symbols_sent++;
+    }
+    
+    // Latest state of each changed level; whatever does not fit the budget
+    // stays dirty and merges with the next window's changes
+    while (!subscriber.dirty.empty()) {
+        const LevelKey key = *subscriber.dirty.begin();
+        md::LevelUpdate update;
+        update.symbol_id = key.symbol_id;
+        update.side = key.side;
+        update.price = key.price;
+        
+        Level level;
+        if (find_level(key, level)) {
+            update.action = static_cast<uint8_t>(md::LevelAction::MODIFY);
+            update.quantity = level.quantity;
+            update.order_count = level.orders;
+        } else {
+            update.action = static_cast<uint8_t>(md::LevelAction::DELETE);
+        }
+        if (!add(&update, sizeof(update))) {
+            return;
+        }
+        subscriber.dirty.erase(subscriber.dirty.begin());
+        conflated_updates_.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    if (packet.size > 0) {
+        send_packet(recovery_fd_, subscriber.address, packet);
+    }
+}
+
+// =============================================================================
+// BOOK STATE
+// =============================================================================
+
+// visit(side, price, level) over bids then asks, best price first
+template <typename Visit>
+void MarketDataPublisher::for_each_level(uint32_t symbol_id, Visit&& visit) const {
+    const SymbolDepth& book = books_[symbol_id];
+    for (const auto& entry : book.bids) {
+        visit(static_cast<uint8_t>(protocol::Side::BUY), entry.first, entry.second);
+    }
+    for (const auto& entry : book.asks) {
+        visit(static_cast<uint8_t>(protocol::Side::SELL), entry.first, entry.second);
+    }
+}
+
+bool MarketDataPublisher::find_level(const LevelKey& key, Level& level) const {
+    if (key.symbol_id >= books_.size()) {
+        return false;
+    }
+    const SymbolDepth& book = books_[key.symbol_id];
+    if (key.side == static_cast<uint8_t>(protocol::Side::BUY)) {
+        auto it = book.bids.find(key.price);
+        if (it == book.bids.end()) return false;
+        level = it->second;
+    } else {
+        auto it = book.asks.find(key.price);
+        if (it == book.asks.end()) return false;
+        level = it->second;
+    }
+    return true;
+}
+
+// =============================================================================
+// PACKETS
+// =============================================================================
+
+void MarketDataPublisher::begin_packet(Packet& packet, md::Channel channel, uint64_t sequence) {
+    md::PacketHeader header;
+    header.channel = static_cast<uint8_t>(channel);
+    header.sequence = sequence;
+    memcpy(packet.data, &header, sizeof(header));
+    packet.size = sizeof(header);
+}
+
+// Best effort, as UDP is: a lost datagram is what the sequence numbers and
+// the recovery port are for
+void MarketDataPublisher::send_packet(int fd, const sockaddr_in& to, Packet& packet) {
+    packet.header().send_time = wall_ns();
+    sendto(fd, packet.data, packet.size, 0, reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+    packets_sent_.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace engine
+} // namespace matching
@@ -0,0 +1,308 @@
+#ifndef MATCHING_ENGINE_MARKET_DATA_H
+#define MATCHING_ENGINE_MARKET_DATA_H
+
+#include "order_store.h"
+#include "../../common/market_data.h"
+#include "../../common/protocol.h"
+#include "../../common/spsc_queue.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <netinet/in.h>
+
+namespace matching {
+namespace engine {
+
+// =============================================================================
+// MARKET DATA CONFIGURATION
+// =============================================================================
+struct MarketDataConfig {
+    std::string group;              // Destination address (multicast group); empty = disabled
+    uint16_t port;                  // Incremental; snapshot = port + 1, recovery = port + 2
+    std::string interface;          // Local address multicast leaves from and the recovery port
+                                    // binds to (empty = routing table, every address)
+    uint8_t ttl;
+    uint32_t snapshot_interval_ms;  // Full book cycle on the snapshot channel
+    uint32_t retransmit_packets;    // Incremental packets kept for gap-fill
+    uint32_t conflation_window_us;  // Subscriber default when SUBSCRIBE asks for 0
+    uint32_t conflation_packets;    // Most packets a subscriber is sent per window
+    uint32_t queue_capacity;        // Deltas between each order manager and the publisher
+    
+    MarketDataConfig()
+        : port(31000)
+        , ttl(1)
+        , snapshot_interval_ms(1000)
+        , retransmit_packets(4096)
+        , conflation_window_us(100000)
+        , conflation_packets(16)
+        , queue_capacity(1u << 16)
+    {}
+    
+    bool enabled() const { return !group.empty(); }
+};
+
+// =============================================================================
+// DEPTH DELTA (queue slot)
+// =============================================================================
+// What an order manager tells the publisher: a symbol it owns, or a change
+// to one price level's resting quantity and order count
+struct alignas(64) DepthDelta {
+    enum Kind : uint8_t {
+        DEFINE_SYMBOL,
+        LEVEL,
+    };
+    
+    uint8_t kind;
+    uint8_t side;                   // protocol::Side
+    uint16_t reserved;
+    uint32_t symbol_id;             // The order manager's own symbol ID
+    uint64_t price;
+    int64_t quantity;
+    int32_t orders;
+    char symbol[16];                // DEFINE_SYMBOL
+};
+
+// =============================================================================
+// MARKET DATA SOURCE
+// =============================================================================
+// One order manager's end of the feed. Called only from the thread driving
+// that manager; each call is a copy into an SPSC ring, and a full ring
+// waits for the publisher rather than losing depth.
+class MarketDataSource {
+public:
+    explicit MarketDataSource(uint32_t capacity)
+        : queue_(capacity)
+    {}
+    
+    void define_symbol(uint32_t symbol_id, const char* name) {
+        DepthDelta* delta = queue_.claim();
+        delta->kind = DepthDelta::DEFINE_SYMBOL;
+        delta->symbol_id = symbol_id;
+        memcpy(delta->symbol, name, sizeof(delta->symbol));
+        queue_.publish();
+    }
+    
+    void level_delta(uint32_t symbol_id, protocol::Side side, uint64_t price, int64_t quantity, int32_t orders) {
+        DepthDelta* delta = queue_.claim();
+        delta->kind = DepthDelta::LEVEL;
+        delta->side = static_cast<uint8_t>(side);
+        delta->symbol_id = symbol_id;
+        delta->price = price;
+        delta->quantity = quantity;
+        delta->orders = orders;
+        queue_.publish();
+    }
+
+private:
+    friend class MarketDataPublisher;
+    
+    SpscQueue<DepthDelta> queue_;
+    std::vector<uint32_t> feed_ids_;    // Source symbol ID -> feed symbol ID (publisher thread)
+};
+
+// =============================================================================
+// MARKET DATA PUBLISHER
+// =============================================================================
+// Aggregates the depth deltas of every source into per-symbol price levels
+// and publishes them on its own thread (common/market_data.h describes the
+// feed):
+//
+//   - each level change becomes ADD / MODIFY / DELETE on the incremental
+//     channel, packed into as few datagrams as the sources keep up with
+//   - a snapshot of every book goes out each snapshot interval
+//   - the recovery socket replays kept incremental packets on request, and
+//     serves conflated subscribers: levels that changed during a window
+//     are sent once, with their latest state, when it closes. One that
+//     cannot take everything within its packet budget keeps the rest
+//     marked for the next window, so it falls behind by conflating more
+//     rather than by queueing.
+//
+// The recovery port answers nothing but a CHALLENGE until the requester
+// echoes the token for its address, so it cannot be turned on a spoofed
+// source; tokens are a keyed hash of the address, nothing is kept per
+// unconfirmed requester. Replies to each address are capped per second.
+class MarketDataPublisher {
+public:
+    explicit MarketDataPublisher(const MarketDataConfig& config);
+    ~MarketDataPublisher();
+    
+    MarketDataPublisher(const MarketDataPublisher&) = delete;
+    MarketDataPublisher& operator=(const MarketDataPublisher&) = delete;
+    
+    // One per order manager; sources are owned by the publisher. Call
+    // before start().
+    MarketDataSource* add_source();
+    
+    // Open the sockets and start the publishing thread
+    bool start();
+    
+    // Publish whatever the sources still hold, then stop
+    void stop();
+    
+    struct Statistics {
+        uint64_t level_updates;
+        uint64_t packets_sent;
+        uint64_t snapshots_sent;
+        uint64_t packets_retransmitted;
+        uint64_t conflated_updates;
+        uint64_t subscribers;
+        
+        Statistics()
+            : level_updates(0)
+            , packets_sent(0)
+            , snapshots_sent(0)
+            , packets_retransmitted(0)
+            , conflated_updates(0)
+            , subscribers(0)
+        {}
+    };
+    
+    // Safe from any thread
+    Statistics get_statistics() const;
+
+private:
+    struct Level {
+        uint64_t quantity;
+        uint32_t orders;
+    };
+    
+    struct SymbolDepth {
+        char name[16];
+        std::map<uint64_t, Level, std::greater<uint64_t>> bids;     // Best first
+        std::map<uint64_t, Level> asks;
+    };
+    
+    // Identifies one level across all books
+    struct LevelKey {
+        uint32_t symbol_id;
+        uint8_t side;
+        uint64_t price;
+        
+        bool operator<(const LevelKey& other) const {
+            if (symbol_id != other.symbol_id) return symbol_id < other.symbol_id;
+            if (side != other.side) return side < other.side;
+            return price < other.price;
+        }
+    };
+    
+    // One datagram being filled
+    struct Packet {
+        uint8_t data[market_data::MD_MAX_PACKET];
+        size_t size;
+        
+        Packet() : size(0) {}
+        
+        market_data::PacketHeader& header() {
+            return *reinterpret_cast<market_data::PacketHeader*>(data);
+        }
+    };
+    
+    // Incremental packet kept for retransmission
+    struct SentPacket {
+        uint64_t first_sequence;
+        uint16_t message_count;
+        uint16_t size;
+        uint8_t data[market_data::MD_MAX_PACKET];
+    };
+    
+    struct Subscriber {
+        sockaddr_in address;
+        uint64_t window_ns;
+        uint64_t next_flush_ns;
+        uint64_t last_request_ns;
+        uint64_t sequence;              // Own conflated stream
+        uint32_t symbols_sent;          // Symbol definitions delivered so far
+        std::set<LevelKey> dirty;
+    };
+    
+    // Recovery port replies to one source address in the current second
+    struct ReplyBudget {
+        uint64_t window_start_ns;
+        uint32_t packets;
+    };
+    
+    MarketDataConfig config_;
+    std::vector<std::unique_ptr<MarketDataSource>> sources_;
+    
+    // Publisher thread state
+    SymbolTable symbols_;
+    std::vector<SymbolDepth> books_;
+    std::vector<std::unique_ptr<Subscriber>> subscribers_;
+    
+    Packet incremental_;
+    uint64_t next_sequence_;            // Incremental channel
+    uint64_t next_snapshot_sequence_;
+    uint64_t last_send_ns_;
+    uint64_t next_snapshot_ns_;
+    
+    std::unique_ptr<SentPacket[]> sent_;    // Ring of config_.retransmit_packets
+    uint64_t sent_count_;                   // Packets ever stored
+    
+    int feed_fd_;                       // Incremental and snapshot channels
+    int recovery_fd_;                   // Bound to the recovery port
+    
+    uint64_t token_key_[2];             // Keys the challenge tokens
+    uint64_t previous_token_key_[2];    // Accepted until the next rotation
+    uint64_t next_rotation_ns_;
+    std::unordered_map<uint32_t, ReplyBudget> reply_budgets_;     // By IPv4 address
+    uint64_t next_budget_sweep_ns_;
+    sockaddr_in incremental_address_;
+    sockaddr_in snapshot_address_;
+    
+    std::atomic<bool> running_;
+    std::thread thread_;
+    
+    std::atomic<uint64_t> level_updates_;
+    std::atomic<uint64_t> packets_sent_;
+    std::atomic<uint64_t> snapshots_sent_;
+    std::atomic<uint64_t> packets_retransmitted_;
+    std::atomic<uint64_t> conflated_updates_;
+    std::atomic<uint64_t> subscriber_count_;
+    
+    void run();
+    size_t drain_sources();
+    void apply(MarketDataSource& source, const DepthDelta& delta);
+    void define_symbol(MarketDataSource& source, const DepthDelta& delta);
+    void apply_level(uint32_t symbol_id, const DepthDelta& delta);
+    
+    // Incremental channel
+    void add_incremental(const void* message, size_t size);
+    void flush_incremental();
+    void keep_for_retransmit(const Packet& packet);
+    
+    // Snapshot channel
+    void send_snapshots();
+    
+    // Recovery port
+    void poll_recovery(uint64_t now);
+    void rotate_token_key();
+    uint64_t token_for(const sockaddr_in& address, const uint64_t key[2]) const;
+    bool confirmed(const sockaddr_in& from, uint64_t token) const;
+    void challenge(const sockaddr_in& to, uint64_t now);
+    bool take_reply(const sockaddr_in& to, uint64_t now);
+    void retransmit(const sockaddr_in& to, uint64_t first, uint32_t count, uint64_t now);
+    void subscribe(const sockaddr_in& from, uint32_t window_us, uint64_t now);
+    void unsubscribe(const sockaddr_in& from);
+    void flush_subscribers(uint64_t now);
+    void flush_subscriber(Subscriber& subscriber);
+    
+    template <typename Visit>
+    void for_each_level(uint32_t symbol_id, Visit&& visit) const;
+    bool find_level(const LevelKey& key, Level& level) const;
+    
+    void begin_packet(Packet& packet, market_data::Channel channel, uint64_t sequence);
+    void send_packet(int fd, const sockaddr_in& to, Packet& packet);
+};
+
+} // namespace engine
+} // namespace matching
+
+#endif // MATCHING_ENGINE_MARKET_DATA_H
@@ -1,6 +1,12 @@
 #include "order_manager.h"
+#include "journal.h"
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace matching {
 namespace engine {
@@ -14,7 +20,13 @@ OrderManager::OrderManager()
     , next_exchange_order_id_(1)
     , next_execution_id_(1)
     , next_sequence_(1)
+    , id_stride_(1)
     , message_callback_(nullptr)
+    , market_data_(nullptr)
+    , send_ticks_(0)
+    , message_time_(latency::wall_ns_at(latency::read_tsc()))
+    , mass_cancelling_(false)
+    , replacing_(nullptr)
 {
     // Create me_lib context
     context_ = mx_context_new();
@@ -28,6 +40,9 @@ OrderManager::OrderManager()
                             &OrderManager::trade_callback,
                             &OrderManager::order_callback,
                             this);
+    
+    // Books never read a clock: each inbound message sets their time
+    mx_context_set_timestamp(context_, message_time_);
 }
 
 OrderManager::~OrderManager() {
@@ -44,8 +59,39 @@ void OrderManager::set_message_callback(MessageCallback callback) {
     message_callback_ = callback;
 }
 
+void OrderManager::set_id_partition(uint64_t first, uint64_t stride) {
+    next_exchange_order_id_ = first;
+    next_execution_id_ = first;
+    id_stride_ = stride;
+    orders_.set_partition(first, stride);
+}
+
+void OrderManager::set_market_data(MarketDataSource* source) {
+    market_data_ = source;
+    if (!market_data_) {
+        return;
+    }
+    
+    for (uint32_t symbol_id = 0; symbol_id < books_.size(); symbol_id++) {
+        if (books_[symbol_id]) {
+            market_data_->define_symbol(symbol_id, books_[symbol_id]->name);
+        }
+    }
+    orders_.for_each([this](const OrderState& order) {
+        if (order.book_quantity > 0) {
+            market_data_->level_delta(order.symbol_id, order.side, order.price,
+                                      static_cast<int64_t>(order.book_quantity), 1);
+        }
+    });
+}
+
 bool OrderManager::add_symbol(const std::string& symbol) {
-    if (books_.find(symbol) != books_.end()) {
+    uint32_t symbol_id = symbols_.intern(symbol);
+    if (symbol_id == SymbolTable::NONE) {
+        std::cerr << "[OrderManager] Invalid symbol: " << symbol << std::endl;
+        return false;
+    }
+    if (find_book(symbol_id)) {
         return false; // Symbol already exists
     }
     
@@ -58,20 +104,35 @@ bool OrderManager::add_symbol(const std::string& symbol) {
         return false;
     }
     
+    data->name = symbols_.name(symbol_id);
     data->last_trade_id = 0;
-    books_[symbol] = std::move(data);
+    if (books_.size() <= symbol_id) {
+        books_.resize(symbol_id + 1);
+    }
+    books_[symbol_id] = std::move(data);
+    
+    if (market_data_) {
+        market_data_->define_symbol(symbol_id, symbols_.name(symbol_id));
+    }
     
     std::cout << "[OrderManager] Added symbol: " << symbol << std::endl;
     return true;
 }
 
 bool OrderManager::remove_symbol(const std::string& symbol) {
-    auto it = books_.find(symbol);
-    if (it == books_.end()) {
+    uint32_t symbol_id = symbols_.find(symbol.data(), symbol.size());
+    if (!find_book(symbol_id)) {
         return false;
     }
     
-    books_.erase(it);
+    // The ID stays interned, so orders still name their symbol; their
+    // depth goes with the book
+    books_[symbol_id].reset();
+    orders_.for_each([this, symbol_id](OrderState& order) {
+        if (order.symbol_id == symbol_id) {
+            set_book_quantity(order, 0);
+        }
+    });
     std::cout << "[OrderManager] Removed symbol: " << symbol << std::endl;
     return true;
 }
@@ -80,7 +141,8 @@ bool OrderManager::remove_symbol(const std::string& symbol) {
 // ORDER OPERATIONS
 // =============================================================================
 
-void OrderManager::handle_new_order(const protocol::NewOrderMessage& msg) {
+void OrderManager::handle_new_order(const protocol::NewOrderMessage& msg, uint64_t received_ns) {
+    StageTimer timer(*this, received_ns);
     stats_.total_orders_received++;
     
     // Validate the order
@@ -93,7 +155,7 @@ void OrderManager::handle_new_order(const protocol::NewOrderMessage& msg) {
     }
     
     // Check for duplicate order ID
-    if (orders_.find(msg.client_order_id) != orders_.end()) {
+    if (client_to_exchange_.find(msg.client_order_id)) {
         stats_.total_orders_rejected++;
         send_order_reject(msg.client_order_id, msg.user_id, 
                          protocol::RejectReason::DUPLICATE_ORDER_ID,
@@ -102,9 +164,9 @@ void OrderManager::handle_new_order(const protocol::NewOrderMessage& msg) {
     }
     
     // Get the order book for this symbol
-    std::string symbol = msg.get_symbol();
-    auto book_it = books_.find(symbol);
-    if (book_it == books_.end()) {
+    uint32_t symbol_id = symbols_.find(msg.symbol);
+    SymbolData* data = find_book(symbol_id);
+    if (!data) {
         stats_.total_orders_rejected++;
         send_order_reject(msg.client_order_id, msg.user_id,
                          protocol::RejectReason::INVALID_SYMBOL,
@@ -112,12 +174,11 @@ void OrderManager::handle_new_order(const protocol::NewOrderMessage& msg) {
         return;
     }
     
-    // Create order state
-    OrderState order;
+    // Create order state in its slab slot
+    OrderState& order = *orders_.insert(generate_exchange_order_id());
     order.client_order_id = msg.client_order_id;
-    order.exchange_order_id = generate_exchange_order_id();
     order.user_id = msg.user_id;
-    order.symbol = symbol;
+    order.symbol_id = symbol_id;
     order.side = msg.get_side();
     order.order_type = msg.get_order_type();
     order.price = msg.price;
@@ -127,16 +188,13 @@ void OrderManager::handle_new_order(const protocol::NewOrderMessage& msg) {
     order.timestamp = get_timestamp();
     order.status = OrderState::Status::PENDING;
     
-    // Store order state
-    orders_[order.client_order_id] = order;
-    exchange_to_client_[order.exchange_order_id] = order.client_order_id;
-    user_orders_[order.user_id].push_back(order.client_order_id);
+    track_order(order);
     
     // Send acknowledgement
     send_order_ack(order);
     
     // Update status to ACTIVE
-    orders_[order.client_order_id].status = OrderState::Status::ACTIVE;
+    order.status = OrderState::Status::ACTIVE;
     
     stats_.total_orders_accepted++;
     
@@ -144,7 +202,7 @@ void OrderManager::handle_new_order(const protocol::NewOrderMessage& msg) {
     mx_side_t mx_side = (order.side == protocol::Side::BUY) ? MX_SIDE_BUY : MX_SIDE_SELL;
     
     int result = mx_order_book_add_limit(
-        book_it->second->book,
+        data->book,
         order.exchange_order_id,
         mx_side,
         static_cast<uint32_t>(order.price),
@@ -154,30 +212,27 @@ void OrderManager::handle_new_order(const protocol::NewOrderMessage& msg) {
     if (result != MX_STATUS_OK) {
         std::cerr << "[OrderManager] Failed to add order to me_lib: " 
                   << mx_status_message(static_cast<mx_status_t>(result)) << std::endl;
+    } else if (order.book_quantity > 0) {
+        // Resting: tag it with its user so a mass cancel finds it
+        mx_order_book_set_owner(data->book, order.exchange_order_id, order.user_id);
     }
     
-    // Get best bid/ask for quote
-    uint32_t best_bid = mx_order_book_get_best_bid(book_it->second->book);
-    uint32_t best_ask = mx_order_book_get_best_ask(book_it->second->book);
-    
-    // Get volumes (simplified - you might want depth here)
-    uint32_t bid_volume = best_bid ? mx_order_book_get_volume_at_price(book_it->second->book, MX_SIDE_BUY, best_bid) : 0;
-    uint32_t ask_volume = best_ask ? mx_order_book_get_volume_at_price(book_it->second->book, MX_SIDE_SELL, best_ask) : 0;
-    
-    send_quote(symbol, best_bid, bid_volume, best_ask, ask_volume);
+    send_quote(*data);
 }
 
-void OrderManager::handle_cancel_order(const protocol::CancelOrderMessage& msg) {
+void OrderManager::handle_cancel_order(const protocol::CancelOrderMessage& msg, uint64_t received_ns) {
+    StageTimer timer(*this, received_ns);
+    
     // Find the order
-    auto order_it = orders_.find(msg.client_order_id);
-    if (order_it == orders_.end()) {
+    OrderState* found = find_client_order(msg.client_order_id);
+    if (!found) {
         send_order_reject(msg.client_order_id, msg.user_id,
                          protocol::RejectReason::UNKNOWN_ORDER,
                          "Order not found");
         return;
     }
     
-    OrderState& order = order_it->second;
+    OrderState& order = *found;
     
     // Verify user owns this order
     if (order.user_id != msg.user_id) {
@@ -198,8 +253,8 @@ void OrderManager::handle_cancel_order(const protocol::CancelOrderMessage& msg)
     }
     
     // Find the order book
-    auto book_it = books_.find(order.symbol);
-    if (book_it == books_.end()) {
+    SymbolData* data = find_book(order.symbol_id);
+    if (!data) {
         send_order_reject(msg.client_order_id, msg.user_id,
                          protocol::RejectReason::SYSTEM_ERROR,
                          "Order book not found");
@@ -207,7 +262,7 @@ void OrderManager::handle_cancel_order(const protocol::CancelOrderMessage& msg)
     }
     
     // Cancel in the matching engine
-    int result = mx_order_book_cancel(book_it->second->book, order.exchange_order_id);
+    int result = mx_order_book_cancel(data->book, order.exchange_order_id);
     
     if (result == MX_STATUS_OK) {
         update_order_cancelled(order);
@@ -215,12 +270,7 @@ void OrderManager::handle_cancel_order(const protocol::CancelOrderMessage& msg)
         stats_.total_orders_cancelled++;
         
         // Send updated quote
-        uint32_t best_bid = mx_order_book_get_best_bid(book_it->second->book);
-        uint32_t best_ask = mx_order_book_get_best_ask(book_it->second->book);
-        uint32_t bid_volume = best_bid ? mx_order_book_get_volume_at_price(book_it->second->book, MX_SIDE_BUY, best_bid) : 0;
-        uint32_t ask_volume = best_ask ? mx_order_book_get_volume_at_price(book_it->second->book, MX_SIDE_SELL, best_ask) : 0;
-        
-        send_quote(order.symbol, best_bid, bid_volume, best_ask, ask_volume);
+        send_quote(*data);
     } else {
         send_order_reject(msg.client_order_id, msg.user_id,
                          protocol::RejectReason::UNKNOWN_ORDER,
@@ -228,34 +278,428 @@ void OrderManager::handle_cancel_order(const protocol::CancelOrderMessage& msg)
     }
 }
 
+void OrderManager::handle_replace_order(const protocol::ReplaceOrderMessage& msg, uint64_t received_ns) {
+    StageTimer timer(*this, received_ns);
+    
+    OrderState* found = find_client_order(msg.client_order_id);
+    if (!found || found->user_id != msg.user_id) {
+        send_order_reject(msg.client_order_id, msg.user_id,
+                         protocol::RejectReason::UNKNOWN_ORDER,
+                         "Order not found");
+        return;
+    }
+    
+    OrderState& order = *found;
+    if (order.book_quantity == 0) {
+        send_order_reject(msg.client_order_id, msg.user_id,
+                         protocol::RejectReason::UNKNOWN_ORDER,
+                         "Order not resting in book");
+        return;
+    }
+    
+    uint64_t new_client_order_id = msg.new_client_order_id ? msg.new_client_order_id : msg.client_order_id;
+    if (new_client_order_id != msg.client_order_id && client_to_exchange_.find(new_client_order_id)) {
+        send_order_reject(msg.client_order_id, msg.user_id,
+                         protocol::RejectReason::DUPLICATE_ORDER_ID,
+                         "Order ID already exists");
+        return;
+    }
+    
+    SymbolData* data = find_book(order.symbol_id);
+    if (!data) {
+        send_order_reject(msg.client_order_id, msg.user_id,
+                         protocol::RejectReason::SYSTEM_ERROR,
+                         "Order book not found");
+        return;
+    }
+    
+    // The exchange order ID (and so the me_lib slot) stays the same;
+    // on_order_event() applies the new terms when REPLACED arrives
+    replacing_ = &msg;
+    int result = mx_order_book_replace(data->book, order.exchange_order_id, order.exchange_order_id,
+                                       static_cast<uint32_t>(msg.price),
+                                       static_cast<uint32_t>(msg.quantity));
+    replacing_ = nullptr;
+    
+    switch (result) {
+        case MX_STATUS_OK:
+            client_to_exchange_[new_client_order_id] = order.exchange_order_id;
+            send_quote(*data);
+            break;
+        
+        case MX_STATUS_INVALID_PRICE:
+            send_order_reject(msg.client_order_id, msg.user_id,
+                             protocol::RejectReason::INVALID_PRICE, "Invalid replace price");
+            break;
+        
+        case MX_STATUS_INVALID_QUANTITY:
+            send_order_reject(msg.client_order_id, msg.user_id,
+                             protocol::RejectReason::INVALID_QUANTITY, "Quantity not above filled quantity");
+            break;
+        
+        default:
+            send_order_reject(msg.client_order_id, msg.user_id,
+                             protocol::RejectReason::UNKNOWN_ORDER,
+                             mx_status_message(static_cast<mx_status_t>(result)));
+            break;
+    }
+}
+
+void OrderManager::handle_mass_cancel(const protocol::MassCancelMessage& msg, uint64_t received_ns) {
+    StageTimer timer(*this, received_ns);
+    
+    mx_side_filter_t filter = MX_SIDE_FILTER_BOTH;
+    if (msg.side == static_cast<uint8_t>(protocol::Side::BUY)) {
+        filter = MX_SIDE_FILTER_BUY;
+    } else if (msg.side == static_cast<uint8_t>(protocol::Side::SELL)) {
+        filter = MX_SIDE_FILTER_SELL;
+    }
+    
+    // me_lib reports each removed order through on_order_event(), which
+    // acks it while the flag is set
+    uint64_t cancelled = 0;
+    mass_cancelling_ = true;
+    for (const auto& data : books_) {
+        if (!data) {
+            continue;
+        }
+        uint32_t count = mx_order_book_mass_cancel(data->book, msg.user_id, filter);
+        if (count > 0) {
+            cancelled += count;
+            send_quote(*data);
+        }
+    }
+    mass_cancelling_ = false;
+    
+    send_mass_cancel_ack(msg.user_id, cancelled);
+}
+
 // =============================================================================
 // STATISTICS & MONITORING
 // =============================================================================
 
+void OrderManager::get_latency(LatencyStatistics& out) const {
+    match_latency_.snapshot(out.match);
+    send_latency_.snapshot(out.send);
+}
+
 const OrderState* OrderManager::get_order(uint64_t client_order_id) const {
-    auto it = orders_.find(client_order_id);
-    if (it == orders_.end()) {
-        return nullptr;
-    }
-    return &it->second;
+    return find_client_order(client_order_id);
 }
 
+// Oldest first
 std::vector<const OrderState*> OrderManager::get_user_orders(uint64_t user_id) const {
     std::vector<const OrderState*> result;
     
-    auto it = user_orders_.find(user_id);
-    if (it == user_orders_.end()) {
-        return result;
+    const uint64_t* last = user_last_order_.find(user_id);
+    for (uint64_t id = last ? *last : 0; id != 0; ) {
+        const OrderState* order = orders_.find(id);
+        if (!order) {
+            break;
+        }
+        result.push_back(order);
+        id = order->previous_user_order;
+    }
+    
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+// =============================================================================
+// ORDER STATE TRACKING
+// =============================================================================
+
+OrderState* OrderManager::find_client_order(uint64_t client_order_id) {
+    const uint64_t* exchange_order_id = client_to_exchange_.find(client_order_id);
+    OrderState* order = exchange_order_id ? orders_.find(*exchange_order_id) : nullptr;
+    
+    // An ID a replace moved away from still has its (never erased) entry
+    return order && order->client_order_id == client_order_id ? order : nullptr;
+}
+
+const OrderState* OrderManager::find_client_order(uint64_t client_order_id) const {
+    return const_cast<OrderManager*>(this)->find_client_order(client_order_id);
+}
+
+// Index a freshly filled slot by client order ID and chain it to its user
+void OrderManager::track_order(OrderState& order) {
+    client_to_exchange_[order.client_order_id] = order.exchange_order_id;
+    uint64_t& last = user_last_order_[order.user_id];
+    order.previous_user_order = last;
+    last = order.exchange_order_id;
+}
+
+// =============================================================================
+// SNAPSHOTS
+// =============================================================================
+
+namespace {
+
+constexpr uint32_t STATE_MAGIC = 0x54534D4F;     // "OMST" read little-endian
+constexpr uint32_t STATE_VERSION = 1;
+constexpr const char* STATE_FILE = "orders.state";
+
+struct StateHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t journal_sequence;
+    uint64_t next_exchange_order_id;
+    uint64_t next_execution_id;
+    uint64_t next_sequence;
+    uint64_t total_orders_received;
+    uint64_t total_orders_accepted;
+    uint64_t total_orders_rejected;
+    uint64_t total_orders_cancelled;
+    uint64_t total_executions;
+    uint64_t total_volume;
+    uint64_t symbol_count;
+    uint64_t order_count;
+};
+
+struct SymbolRecord {
+    char symbol[16];
+    uint64_t last_trade_id;
+};
+
+struct OrderRecord {
+    char symbol[16];
+    uint64_t client_order_id;
+    uint64_t exchange_order_id;
+    uint64_t user_id;
+    uint64_t price;
+    uint64_t original_quantity;
+    uint64_t remaining_quantity;
+    uint64_t filled_quantity;
+    uint64_t timestamp;
+    uint8_t side;
+    uint8_t order_type;
+    uint8_t status;
+    uint8_t reserved[5];
+};
+
+static_assert(sizeof(OrderRecord) == 88, "OrderRecord layout changed - bump STATE_VERSION");
+
+// SymbolTable names are already 16 zero-padded bytes
+void copy_symbol(char (&dest)[16], const char* symbol) {
+    memcpy(dest, symbol, sizeof(dest));
+}
+
+std::string book_path(const std::string& directory, const std::string& symbol) {
+    return directory + "/" + symbol + ".snap";
+}
+
+bool sync_path(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+} // namespace
+
+bool OrderManager::save_snapshot(const std::string& directory, uint64_t journal_sequence) const {
+    std::string staging = directory + ".tmp";
+    remove_directory(staging);
+    if (mkdir(staging.c_str(), 0755) != 0) {
+        std::cerr << "[OrderManager] Cannot create " << staging << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    
+    // Books first - each is written and synced by me_lib
+    uint64_t symbol_count = 0;
+    for (const auto& data : books_) {
+        if (!data) {
+            continue;
+        }
+        int result = mx_order_book_save_snapshot(data->book, book_path(staging, data->name).c_str());
+        if (result != MX_STATUS_OK) {
+            std::cerr << "[OrderManager] Failed to save book " << data->name << ": "
+                      << mx_status_message(static_cast<mx_status_t>(result)) << std::endl;
+            remove_directory(staging);
+            return false;
+        }
+        symbol_count++;
+    }
+    
+    // The slab is in exchange ID order, which is also the order each
+    // user's chain was built in
+    std::vector<const OrderState*> orders;
+    orders.reserve(client_to_exchange_.size());
+    orders_.for_each([&](const OrderState& order) {
+        orders.push_back(&order);
+    });
+    
+    StateHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = STATE_MAGIC;
+    header.version = STATE_VERSION;
+    header.journal_sequence = journal_sequence;
+    header.next_exchange_order_id = next_exchange_order_id_;
+    header.next_execution_id = next_execution_id_;
+    header.next_sequence = next_sequence_;
+    header.total_orders_received = stats_.total_orders_received;
+    header.total_orders_accepted = stats_.total_orders_accepted;
+    header.total_orders_rejected = stats_.total_orders_rejected;
+    header.total_orders_cancelled = stats_.total_orders_cancelled;
+    header.total_executions = stats_.total_executions;
+    header.total_volume = stats_.total_volume;
+    header.symbol_count = symbol_count;
+    header.order_count = orders.size();
+    
+    std::string state_path = staging + "/" + STATE_FILE;
+    FILE* file = fopen(state_path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "[OrderManager] Cannot create " << state_path << ": " << strerror(errno) << std::endl;
+        remove_directory(staging);
+        return false;
     }
     
-    for (uint64_t client_order_id : it->second) {
-        auto order_it = orders_.find(client_order_id);
-        if (order_it != orders_.end()) {
-            result.push_back(&order_it->second);
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (const auto& data : books_) {
+        if (!data) {
+            continue;
         }
+        SymbolRecord record;
+        copy_symbol(record.symbol, data->name);
+        record.last_trade_id = data->last_trade_id;
+        ok = ok && fwrite(&record, sizeof(record), 1, file) == 1;
     }
+    for (const OrderState* order : orders) {
+        OrderRecord record;
+        memset(&record, 0, sizeof(record));
+        copy_symbol(record.symbol, symbols_.name(order->symbol_id));
+        record.client_order_id = order->client_order_id;
+        record.exchange_order_id = order->exchange_order_id;
+        record.user_id = order->user_id;
+        record.price = order->price;
+        record.original_quantity = order->original_quantity;
+        record.remaining_quantity = order->remaining_quantity;
+        record.filled_quantity = order->filled_quantity;
+        record.timestamp = order->timestamp;
+        record.side = static_cast<uint8_t>(order->side);
+        record.order_type = static_cast<uint8_t>(order->order_type);
+        record.status = static_cast<uint8_t>(order->status);
+        ok = ok && fwrite(&record, sizeof(record), 1, file) == 1;
+    }
+    ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    ok = (fclose(file) == 0) && ok;
     
-    return result;
+    // Publish the finished directory in one rename
+    ok = ok && sync_path(staging) && rename(staging.c_str(), directory.c_str()) == 0;
+    if (!ok) {
+        std::cerr << "[OrderManager] Failed to write snapshot " << directory << ": " << strerror(errno) << std::endl;
+        remove_directory(staging);
+        return false;
+    }
+    
+    size_t slash = directory.find_last_of('/');
+    sync_path(slash == std::string::npos ? "." : directory.substr(0, slash));
+    return true;
+}
+
+bool OrderManager::load_snapshot(const std::string& directory, uint64_t& journal_sequence) {
+    std::string state_path = directory + "/" + STATE_FILE;
+    FILE* file = fopen(state_path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "[OrderManager] Cannot open " << state_path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    
+    StateHeader header;
+    std::vector<SymbolRecord> symbols;
+    std::vector<OrderRecord> records;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+              header.magic == STATE_MAGIC && header.version == STATE_VERSION;
+    
+    // Counts must account for exactly the rest of the file
+    struct stat st;
+    ok = ok && fstat(fileno(file), &st) == 0 &&
+         header.symbol_count <= static_cast<uint64_t>(st.st_size) / sizeof(SymbolRecord) &&
+         header.order_count <= static_cast<uint64_t>(st.st_size) / sizeof(OrderRecord) &&
+         static_cast<uint64_t>(st.st_size) == sizeof(StateHeader) +
+             header.symbol_count * sizeof(SymbolRecord) + header.order_count * sizeof(OrderRecord);
+    if (ok) {
+        symbols.resize(header.symbol_count);
+        records.resize(header.order_count);
+        ok = fread(symbols.data(), sizeof(SymbolRecord), symbols.size(), file) == symbols.size() &&
+             fread(records.data(), sizeof(OrderRecord), records.size(), file) == records.size();
+    }
+    fclose(file);
+    
+    if (!ok) {
+        std::cerr << "[OrderManager] Invalid snapshot state file: " << state_path << std::endl;
+        return false;
+    }
+    
+    // Books are restored without matching, so no callbacks fire here
+    for (const SymbolRecord& record : symbols) {
+        std::string symbol(record.symbol, strnlen(record.symbol, sizeof(record.symbol)));
+        if (!find_book(symbols_.find(record.symbol)) && !add_symbol(symbol)) {
+            return false;
+        }
+        
+        SymbolData& data = *find_book(symbols_.find(record.symbol));
+        int result = mx_order_book_load_snapshot(data.book, book_path(directory, symbol).c_str());
+        if (result != MX_STATUS_OK) {
+            std::cerr << "[OrderManager] Failed to load book " << symbol << ": "
+                      << mx_status_message(static_cast<mx_status_t>(result)) << std::endl;
+            return false;
+        }
+        data.last_trade_id = record.last_trade_id;
+    }
+    
+    orders_.for_each([this](OrderState& order) {
+        set_book_quantity(order, 0);
+    });
+    orders_.clear();
+    client_to_exchange_.clear();
+    user_last_order_.clear();
+    client_to_exchange_.reserve(records.size());
+    
+    for (const OrderRecord& record : records) {
+        // Symbols of orders whose book has since been removed are interned
+        // without one
+        uint32_t symbol_id = symbols_.intern(std::string(record.symbol, strnlen(record.symbol, sizeof(record.symbol))));
+        OrderState* slot = orders_.insert(record.exchange_order_id);
+        if (!slot || symbol_id == SymbolTable::NONE) {
+            std::cerr << "[OrderManager] Invalid order record in " << state_path << std::endl;
+            return false;
+        }
+        
+        OrderState& order = *slot;
+        order.client_order_id = record.client_order_id;
+        order.user_id = record.user_id;
+        order.symbol_id = symbol_id;
+        order.side = static_cast<protocol::Side>(record.side);
+        order.order_type = static_cast<protocol::OrderType>(record.order_type);
+        order.price = record.price;
+        order.original_quantity = record.original_quantity;
+        order.remaining_quantity = record.remaining_quantity;
+        order.filled_quantity = record.filled_quantity;
+        order.timestamp = record.timestamp;
+        order.status = static_cast<OrderState::Status>(record.status);
+        track_order(order);
+        
+        bool resting = (order.status == OrderState::Status::ACTIVE ||
+                        order.status == OrderState::Status::PARTIALLY_FILLED) && find_book(symbol_id);
+        set_book_quantity(order, resting ? order.remaining_quantity : 0);
+    }
+    
+    next_exchange_order_id_ = header.next_exchange_order_id;
+    next_execution_id_ = header.next_execution_id;
+    next_sequence_ = header.next_sequence;
+    stats_.total_orders_received = header.total_orders_received;
+    stats_.total_orders_accepted = header.total_orders_accepted;
+    stats_.total_orders_rejected = header.total_orders_rejected;
+    stats_.total_orders_cancelled = header.total_orders_cancelled;
+    stats_.total_executions = header.total_executions;
+    stats_.total_volume = header.total_volume;
+    
+    journal_sequence = header.journal_sequence;
+    return true;
 }
 
 // =============================================================================
@@ -264,11 +708,15 @@ std::vector<const OrderState*> OrderManager::get_user_orders(uint64_t user_id) c
 
 void OrderManager::send_message(const void* data, size_t size) {
     if (message_callback_) {
+        uint64_t start = latency::read_tsc();
         message_callback_(data, size);
+        send_ticks_ += latency::read_tsc() - start;
     }
 }
 
 void OrderManager::send_order_ack(const OrderState& order) {
+    if (suppressed()) return;
+    
     protocol::OrderAckMessage msg;
     msg.header.sequence = generate_sequence();
     msg.client_order_id = order.client_order_id;
@@ -281,6 +729,8 @@ void OrderManager::send_order_ack(const OrderState& order) {
 
 void OrderManager::send_order_reject(uint64_t client_order_id, uint64_t user_id,
                                      protocol::RejectReason reason, const std::string& text) {
+    if (suppressed()) return;
+    
     protocol::OrderRejectMessage msg;
     msg.header.sequence = generate_sequence();
     msg.client_order_id = client_order_id;
@@ -294,9 +744,11 @@ void OrderManager::send_order_reject(uint64_t client_order_id, uint64_t user_id,
 
 void OrderManager::send_execution(const OrderState& order, uint64_t fill_price,
                                   uint64_t fill_quantity, uint64_t execution_id) {
+    if (suppressed()) return;
+    
     protocol::ExecutionMessage msg;
     msg.header.sequence = generate_sequence();
-    msg.set_symbol(order.symbol);
+    memcpy(msg.symbol, symbols_.name(order.symbol_id), sizeof(msg.symbol));
     msg.client_order_id = order.client_order_id;
     msg.exchange_order_id = order.exchange_order_id;
     msg.execution_id = execution_id;
@@ -311,6 +763,8 @@ void OrderManager::send_execution(const OrderState& order, uint64_t fill_price,
 }
 
 void OrderManager::send_cancel_ack(const OrderState& order) {
+    if (suppressed()) return;
+    
     protocol::OrderRejectMessage msg;
     msg.header.set_type(protocol::MessageType::ORDER_CANCELLED);
     msg.header.sequence = generate_sequence();
@@ -323,11 +777,42 @@ void OrderManager::send_cancel_ack(const OrderState& order) {
     send_message(&msg, sizeof(msg));
 }
 
-void OrderManager::send_trade(const std::string& symbol, uint64_t trade_id,
+void OrderManager::send_order_replaced(const OrderState& order, uint64_t orig_client_order_id) {
+    if (suppressed()) return;
+    
+    protocol::OrderReplacedMessage msg;
+    msg.header.sequence = generate_sequence();
+    msg.orig_client_order_id = orig_client_order_id;
+    msg.client_order_id = order.client_order_id;
+    msg.exchange_order_id = order.exchange_order_id;
+    msg.user_id = order.user_id;
+    msg.price = order.price;
+    msg.quantity = order.original_quantity;
+    msg.leaves_quantity = order.remaining_quantity;
+    msg.timestamp = get_timestamp();
+    
+    send_message(&msg, sizeof(msg));
+}
+
+void OrderManager::send_mass_cancel_ack(uint64_t user_id, uint64_t cancelled_count) {
+    if (suppressed()) return;
+    
+    protocol::MassCancelAckMessage msg;
+    msg.header.sequence = generate_sequence();
+    msg.user_id = user_id;
+    msg.cancelled_count = cancelled_count;
+    msg.timestamp = get_timestamp();
+    
+    send_message(&msg, sizeof(msg));
+}
+
+void OrderManager::send_trade(const SymbolData& symbol, uint64_t trade_id,
                               uint64_t price, uint64_t quantity) {
+    if (suppressed()) return;
+    
     protocol::TradeMessage msg;
     msg.header.sequence = generate_sequence();
-    msg.set_symbol(symbol);
+    memcpy(msg.symbol, symbol.name, sizeof(msg.symbol));
     msg.trade_id = trade_id;
     msg.price = price;
     msg.quantity = quantity;
@@ -336,15 +821,23 @@ void OrderManager::send_trade(const std::string& symbol, uint64_t trade_id,
     send_message(&msg, sizeof(msg));
 }
 
-void OrderManager::send_quote(const std::string& symbol, uint32_t bid_price,
-                              uint32_t bid_quantity, uint32_t ask_price, uint32_t ask_quantity) {
+void OrderManager::send_quote(const SymbolData& symbol) {
+    if (suppressed()) return;
+    
+    mx_order_book_t* book = symbol.book;
+    
+    // Get best bid/ask for quote
+    uint32_t best_bid = mx_order_book_get_best_bid(book);
+    uint32_t best_ask = mx_order_book_get_best_ask(book);
+    
+    // Get volumes (simplified - you might want depth here)
     protocol::QuoteMessage msg;
     msg.header.sequence = generate_sequence();
-    msg.set_symbol(symbol);
-    msg.bid_price = bid_price;
-    msg.bid_quantity = bid_quantity;
-    msg.ask_price = ask_price;
-    msg.ask_quantity = ask_quantity;
+    memcpy(msg.symbol, symbol.name, sizeof(msg.symbol));
+    msg.bid_price = best_bid;
+    msg.bid_quantity = best_bid ? mx_order_book_get_volume_at_price(book, MX_SIDE_BUY, best_bid) : 0;
+    msg.ask_price = best_ask;
+    msg.ask_quantity = best_ask ? mx_order_book_get_volume_at_price(book, MX_SIDE_SELL, best_ask) : 0;
     msg.timestamp = get_timestamp();
     
     send_message(&msg, sizeof(msg));
@@ -355,8 +848,8 @@ void OrderManager::send_quote(const std::string& symbol, uint32_t bid_price,
 // =============================================================================
 
 protocol::RejectReason OrderManager::validate_new_order(const protocol::NewOrderMessage& msg) {
-    std::string symbol = msg.get_symbol();
-    if (symbol.empty() || symbol.length() > 15) {
+    size_t symbol_length = strnlen(msg.symbol, sizeof(msg.symbol));
+    if (symbol_length == 0 || symbol_length > SymbolTable::MAX_LENGTH) {
         return protocol::RejectReason::INVALID_SYMBOL;
     }
     
@@ -410,71 +903,76 @@ void OrderManager::on_trade(uint64_t aggressive_order_id,
     stats_.total_executions++;
     stats_.total_volume += quantity;
     
-    // Find orders
-    auto agg_it = exchange_to_client_.find(aggressive_order_id);
-    auto pass_it = exchange_to_client_.find(passive_order_id);
+    // Find orders - me_lib order IDs are the slab's exchange order IDs
+    OrderState* agg_order = orders_.find(aggressive_order_id);
+    OrderState* pass_order = orders_.find(passive_order_id);
     
-    if (agg_it == exchange_to_client_.end() || pass_it == exchange_to_client_.end()) {
+    if (!agg_order || !pass_order) {
         std::cerr << "[OrderManager] Trade for unknown order IDs" << std::endl;
         return;
     }
     
-    auto agg_order_it = orders_.find(agg_it->second);
-    auto pass_order_it = orders_.find(pass_it->second);
-    
-    if (agg_order_it == orders_.end() || pass_order_it == orders_.end()) {
-        return;
-    }
-    
-    OrderState& agg_order = agg_order_it->second;
-    OrderState& pass_order = pass_order_it->second;
-    
-    // Find symbol for this trade
-    std::string symbol = agg_order.symbol;
-    auto book_it = books_.find(symbol);
-    if (book_it != books_.end()) {
-        uint64_t trade_id = ++book_it->second->last_trade_id;
-        send_trade(symbol, trade_id, price, quantity);
+    // Book for this trade
+    if (SymbolData* data = find_book(agg_order->symbol_id)) {
+        uint64_t trade_id = ++data->last_trade_id;
+        send_trade(*data, trade_id, price, quantity);
     }
     
     // Send executions to both sides
-    send_execution(agg_order, price, quantity, generate_execution_id());
-    send_execution(pass_order, price, quantity, generate_execution_id());
+    send_execution(*agg_order, price, quantity, generate_execution_id());
+    send_execution(*pass_order, price, quantity, generate_execution_id());
 }
 
 void OrderManager::on_order_event(uint64_t order_id,
                                   mx_order_event_t event,
                                   uint32_t filled_quantity,
                                   uint32_t remaining_quantity) {
-    auto it = exchange_to_client_.find(order_id);
-    if (it == exchange_to_client_.end()) {
+    OrderState* found = orders_.find(order_id);
+    if (!found) {
         return;
     }
     
-    auto order_it = orders_.find(it->second);
-    if (order_it == orders_.end()) {
-        return;
-    }
-    
-    OrderState& order = order_it->second;
+    OrderState& order = *found;
     
+    // ACCEPTED and PARTIAL arrive once the order rests (PARTIAL also as a
+    // resting order is filled into), the others once it has left the book
     switch (event) {
+        case MX_EVENT_ORDER_ACCEPTED:
+            set_book_quantity(order, remaining_quantity);
+            break;
+        
         case MX_EVENT_ORDER_PARTIAL:
             order.filled_quantity = filled_quantity;
             order.remaining_quantity = remaining_quantity;
             order.status = OrderState::Status::PARTIALLY_FILLED;
+            set_book_quantity(order, remaining_quantity);
             break;
-            
+        
         case MX_EVENT_ORDER_FILLED:
             order.filled_quantity = filled_quantity;
             order.remaining_quantity = 0;
             order.status = OrderState::Status::FILLED;
+            set_book_quantity(order, 0);
             break;
-            
+        
         case MX_EVENT_ORDER_CANCELLED:
             order.status = OrderState::Status::CANCELLED;
+            set_book_quantity(order, 0);
+            if (mass_cancelling_) {
+                send_cancel_ack(order);
+                stats_.total_orders_cancelled++;
+            }
             break;
-            
+        
+        case MX_EVENT_ORDER_REPLACED:
+            update_order_replaced(order, remaining_quantity);
+            break;
+        
+        case MX_EVENT_ORDER_REJECTED:
+        case MX_EVENT_ORDER_EXPIRED:
+            set_book_quantity(order, 0);
+            break;
+        
         default:
             break;
     }
@@ -499,5 +997,33 @@ void OrderManager::update_order_cancelled(OrderState& order) {
     order.status = OrderState::Status::CANCELLED;
 }
 
+void OrderManager::update_order_replaced(OrderState& order, uint32_t remaining_quantity) {
+    if (!replacing_) {
+        return;
+    }
+    
+    // Depth leaves the old price before it lands on the new one
+    uint64_t orig_client_order_id = order.client_order_id;
+    set_book_quantity(order, 0);
+    if (replacing_->new_client_order_id) {
+        order.client_order_id = replacing_->new_client_order_id;
+    }
+    order.price = replacing_->price;
+    order.original_quantity = replacing_->quantity;
+    order.remaining_quantity = remaining_quantity;
+    set_book_quantity(order, remaining_quantity);
+    
+    send_order_replaced(order, orig_client_order_id);
+}
+
+void OrderManager::set_book_quantity(OrderState& order, uint64_t quantity) {
+    if (market_data_ && quantity != order.book_quantity) {
+        int32_t orders = static_cast<int32_t>(quantity > 0) - static_cast<int32_t>(order.book_quantity > 0);
+        market_data_->level_delta(order.symbol_id, order.side, order.price,
+                                  static_cast<int64_t>(quantity) - static_cast<int64_t>(order.book_quantity), orders);
+    }
+    order.book_quantity = quantity;
+}
+
 } // namespace engine
 } // namespace matching
@@ -1,12 +1,13 @@
 #ifndef MATCHING_ENGINE_ORDER_MANAGER_H
 #define MATCHING_ENGINE_ORDER_MANAGER_H
 
+#include "market_data.h"
+#include "order_store.h"
 #include "../../common/protocol.h"
+#include "../../common/latency.h"
 #include "matchengine.h"
 #include <memory>
-#include <unordered_map>
 #include <functional>
-#include <chrono>
 #include <string>
 #include <vector>
 
@@ -16,17 +17,20 @@ namespace engine {
 // =============================================================================
 // ORDER STATE
 // =============================================================================
+// One slot of the order slab; exchange_order_id == 0 marks an empty slot
 struct OrderState {
     uint64_t client_order_id;
     uint64_t exchange_order_id;
     uint64_t user_id;
-    std::string symbol;
+    uint64_t previous_user_order;   // User's previous exchange order ID (0 = none)
+    uint32_t symbol_id;             // OrderManager::symbol_name()
     protocol::Side side;
     protocol::OrderType order_type;
     uint64_t price;
     uint64_t original_quantity;
     uint64_t remaining_quantity;
     uint64_t filled_quantity;
+    uint64_t book_quantity;         // Resting in the book, as published in market data
     uint64_t timestamp;
     
     enum class Status {
@@ -44,12 +48,15 @@ struct OrderState {
         : client_order_id(0)
         , exchange_order_id(0)
         , user_id(0)
+        , previous_user_order(0)
+        , symbol_id(0)
         , side(protocol::Side::BUY)
         , order_type(protocol::OrderType::LIMIT)
         , price(0)
         , original_quantity(0)
         , remaining_quantity(0)
         , filled_quantity(0)
+        , book_quantity(0)
         , timestamp(0)
         , status(Status::PENDING)
     {}
@@ -70,10 +77,28 @@ public:
     
     void set_message_callback(MessageCallback callback);
     bool add_symbol(const std::string& symbol);
+    
+    // Issue exchange order and execution IDs as first, first + stride, ...
+    // so managers running side by side (engine shards) never share an ID
+    void set_id_partition(uint64_t first, uint64_t stride);
+    
+    // Publish depth changes to source from now on, starting with every
+    // symbol and resting order already held
+    void set_market_data(MarketDataSource* source);
     bool remove_symbol(const std::string& symbol);
     
-    void handle_new_order(const protocol::NewOrderMessage& msg);
-    void handle_cancel_order(const protocol::CancelOrderMessage& msg);
+    // Handlers take the inbound message's receive time (epoch ns), which
+    // every message sent in reply and the book itself are stamped with
+    void handle_new_order(const protocol::NewOrderMessage& msg, uint64_t received_ns);
+    void handle_cancel_order(const protocol::CancelOrderMessage& msg, uint64_t received_ns);
+    
+    // Amend a resting order in place (me_lib replace); ORDER_REPLACED goes
+    // out ahead of any executions the new price causes
+    void handle_replace_order(const protocol::ReplaceOrderMessage& msg, uint64_t received_ns);
+    
+    // Cancel every resting order of msg.user_id, one me_lib mass cancel
+    // per book; an ORDER_CANCELLED per order, then one MASS_CANCEL_ACK
+    void handle_mass_cancel(const protocol::MassCancelMessage& msg, uint64_t received_ns);
     
     struct Statistics {
         uint64_t total_orders_received;
@@ -94,9 +119,28 @@ public:
     };
     
     Statistics get_statistics() const { return stats_; }
+    
+    // Handler time per message, in TSC ticks: match covers validation and
+    // me_lib, send covers the output callbacks it fired (excluded from match)
+    struct LatencyStatistics {
+        latency::Snapshot match;
+        latency::Snapshot send;
+    };
+    
+    void get_latency(LatencyStatistics& out) const;
     const OrderState* get_order(uint64_t client_order_id) const;
     std::vector<const OrderState*> get_user_orders(uint64_t user_id) const;
+    const char* symbol_name(uint32_t symbol_id) const { return symbols_.name(symbol_id); }
     
+    // Write every book (me_lib snapshot) and the order tracking state into
+    // directory, built under a temporary name and renamed once complete.
+    // journal_sequence is the last journal record the state reflects.
+    bool save_snapshot(const std::string& directory, uint64_t journal_sequence) const;
+    
+    // Replace books and order tracking with a snapshot from save_snapshot();
+    // journal_sequence receives the sequence it was taken at
+    bool load_snapshot(const std::string& directory, uint64_t& journal_sequence);
+
 private:
     // -------------------------------------------------------------------------
     // INTERNAL ORDER BOOK MANAGEMENT
@@ -104,9 +148,10 @@ private:
     
     struct SymbolData {
         mx_order_book_t* book;      // me_lib order book for this symbol
+        const char* name;           // SymbolTable name, 16 bytes zero-padded
         uint64_t last_trade_id;
         
-        SymbolData() : book(nullptr), last_trade_id(0) {}
+        SymbolData() : book(nullptr), name(nullptr), last_trade_id(0) {}
         ~SymbolData() {
             if (book) {
                 mx_order_book_free(book);
@@ -117,16 +162,29 @@ private:
     // Context for me_lib
     mx_context_t* context_;
     
-    // Symbol -> OrderBook mapping
-    std::unordered_map<std::string, std::unique_ptr<SymbolData>> books_;
+    // Symbols interned at add_symbol(); books_ is indexed by symbol ID and
+    // holds nullptr for a removed symbol
+    SymbolTable symbols_;
+    std::vector<std::unique_ptr<SymbolData>> books_;
+    
+    SymbolData* find_book(uint32_t symbol_id) const {
+        return symbol_id < books_.size() ? books_[symbol_id].get() : nullptr;
+    }
     
     // -------------------------------------------------------------------------
     // ORDER STATE TRACKING
     // -------------------------------------------------------------------------
     
-    std::unordered_map<uint64_t, OrderState> orders_;
-    std::unordered_map<uint64_t, uint64_t> exchange_to_client_;
-    std::unordered_map<uint64_t, std::vector<uint64_t>> user_orders_;
+    // State by exchange order ID, so me_lib callbacks index it directly.
+    // Each user's orders are chained newest first through
+    // previous_user_order, starting at user_last_order_.
+    OrderSlab<OrderState> orders_;
+    FlatIndex client_to_exchange_;
+    FlatIndex user_last_order_;
+    
+    OrderState* find_client_order(uint64_t client_order_id);
+    const OrderState* find_client_order(uint64_t client_order_id) const;
+    void track_order(OrderState& order);
     
     // -------------------------------------------------------------------------
     // ID GENERATION
@@ -135,9 +193,18 @@ private:
     uint64_t next_exchange_order_id_;
     uint64_t next_execution_id_;
     uint64_t next_sequence_;
+    uint64_t id_stride_;
     
-    uint64_t generate_exchange_order_id() { return next_exchange_order_id_++; }
-    uint64_t generate_execution_id() { return next_execution_id_++; }
+    uint64_t generate_exchange_order_id() {
+        uint64_t id = next_exchange_order_id_;
+        next_exchange_order_id_ += id_stride_;
+        return id;
+    }
+    uint64_t generate_execution_id() {
+        uint64_t id = next_execution_id_;
+        next_execution_id_ += id_stride_;
+        return id;
+    }
     uint64_t generate_sequence() { return next_sequence_++; }
     
     // -------------------------------------------------------------------------
@@ -145,6 +212,15 @@ private:
     // -------------------------------------------------------------------------
     
     MessageCallback message_callback_;
+    MarketDataSource* market_data_;
+    
+    // With no callback (journal replay) the send_* helpers only advance the
+    // sequence number, so replayed state matches without building messages
+    bool suppressed() {
+        if (message_callback_) return false;
+        generate_sequence();
+        return true;
+    }
     
     void send_message(const void* data, size_t size);
     void send_order_ack(const OrderState& order);
@@ -153,10 +229,11 @@ private:
     void send_execution(const OrderState& order, uint64_t fill_price, 
                        uint64_t fill_quantity, uint64_t execution_id);
     void send_cancel_ack(const OrderState& order);
-    void send_trade(const std::string& symbol, uint64_t trade_id,
+    void send_order_replaced(const OrderState& order, uint64_t orig_client_order_id);
+    void send_mass_cancel_ack(uint64_t user_id, uint64_t cancelled_count);
+    void send_trade(const SymbolData& symbol, uint64_t trade_id,
                    uint64_t price, uint64_t quantity);
-    void send_quote(const std::string& symbol, uint32_t bid_price, 
-                   uint32_t bid_quantity, uint32_t ask_price, uint32_t ask_quantity);
+    void send_quote(const SymbolData& symbol);
     
     // -------------------------------------------------------------------------
     // ORDER VALIDATION
@@ -198,11 +275,21 @@ private:
     
     void update_order_filled(OrderState& order, uint64_t filled_qty);
     void update_order_cancelled(OrderState& order);
+    void update_order_replaced(OrderState& order, uint32_t remaining_quantity);
+    
+    // Record how much of order now rests in its book, and publish the
+    // level change
+    void set_book_quantity(OrderState& order, uint64_t quantity);
     
-    uint64_t get_timestamp() const {
-        return std::chrono::duration_cast<std::chrono::nanoseconds>(
-            std::chrono::system_clock::now().time_since_epoch()
-        ).count();
+    // Every message sent while handling one inbound message carries the
+    // same time: the inbound message's receive time
+    uint64_t get_timestamp() const { return message_time_; }
+    
+    // Also handed to me_lib so book timestamps match without it reading
+    // a clock
+    void stamp_message(uint64_t received_ns) {
+        message_time_ = received_ns;
+        mx_context_set_timestamp(context_, message_time_);
     }
     
     // -------------------------------------------------------------------------
@@ -210,6 +297,40 @@ private:
     // -------------------------------------------------------------------------
     
     Statistics stats_;
+    
+    latency::Histogram match_latency_;
+    latency::Histogram send_latency_;
+    uint64_t send_ticks_;           // Spent in send_message() by the current handler
+    uint64_t message_time_;         // Wall time of the inbound message being handled
+    bool mass_cancelling_;          // Inside handle_mass_cancel(): CANCELLED events are acked
+    const protocol::ReplaceOrderMessage* replacing_;    // Inside handle_replace_order()
+    
+    // Stamps one handler call and times it into match_latency_ /
+    // send_latency_; journal replay (no callback) is not timed
+    class StageTimer {
+    public:
+        StageTimer(OrderManager& manager, uint64_t received_ns)
+            : manager_(manager)
+            , start_(manager.message_callback_ ? latency::read_tsc() : 0)
+        {
+            manager_.send_ticks_ = 0;
+            manager_.stamp_message(received_ns);
+        }
+        
+        ~StageTimer() {
+            if (!manager_.message_callback_) return;
+            uint64_t elapsed = latency::read_tsc() - start_;
+            uint64_t sent = manager_.send_ticks_;
+            manager_.match_latency_.record(elapsed > sent ? elapsed - sent : 0);
+            if (sent) {
+                manager_.send_latency_.record(sent);
+            }
+        }
+    
+    private:
+        OrderManager& manager_;
+        uint64_t start_;
+    };
 };
 
 } // namespace engine
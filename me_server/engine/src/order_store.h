@@ -0,0 +1,314 @@
+#ifndef MATCHING_ENGINE_ORDER_STORE_H
+#define MATCHING_ENGINE_ORDER_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace matching {
+namespace engine {
+
+// =============================================================================
+// SYMBOL TABLE
+// =============================================================================
+// Interns symbols (up to 15 characters, the protocol's field minus its
+// NUL) to dense IDs 0, 1, 2, ... in the order they are added. Lookups hash
+// the 16-byte protocol field as two words, so no std::string is built per
+// message. Open addressing, linear probing, kept at most half full.
+// Names never move once interned, so callers may keep name() pointers.
+class SymbolTable {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    static constexpr size_t MAX_LENGTH = 15;
+    
+    SymbolTable()
+        : slots_(16, NONE)
+    {}
+    
+    // ID for text[0, length), or NONE
+    uint32_t find(const char* text, size_t length) const {
+        if (length == 0 || length > MAX_LENGTH) {
+            return NONE;
+        }
+        Key key = make_key(text, length);
+        for (size_t i = hash(key) & mask(); ; i = (i + 1) & mask()) {
+            uint32_t id = slots_[i];
+            if (id == NONE || keys_[id] == key) {
+                return id;
+            }
+        }
+    }
+    
+    // Protocol field: read up to the first NUL within the 16 bytes
+    uint32_t find(const char (&symbol)[16]) const {
+        return find(symbol, strnlen(symbol, sizeof(symbol)));
+    }
+    
+    // Existing ID, or the next one; NONE if the symbol does not fit
+    uint32_t intern(const std::string& symbol) {
+        uint32_t id = find(symbol.data(), symbol.size());
+        if (id != NONE || symbol.empty() || symbol.size() > MAX_LENGTH) {
+            return id;
+        }
+        
+        if ((keys_.size() + 1) * 2 > slots_.size()) {
+            rehash(slots_.size() * 2);
+        }
+        id = static_cast<uint32_t>(keys_.size());
+        keys_.push_back(make_key(symbol.data(), symbol.size()));
+        place(id);
+        return id;
+    }
+    
+    // Zero-padded, NUL-terminated 16-byte name
+    const char* name(uint32_t id) const { return keys_[id].text; }
+    
+    uint32_t size() const { return static_cast<uint32_t>(keys_.size()); }
+
+private:
+    struct Key {
+        char text[16];
+        
+        bool operator==(const Key& other) const { return memcmp(text, other.text, sizeof(text)) == 0; }
+    };
+    
+    static Key make_key(const char* text, size_t length) {
+        Key key;
+        memset(key.text, 0, sizeof(key.text));
+        memcpy(key.text, text, length);
+        return key;
+    }
+    
+    static size_t hash(const Key& key) {
+        uint64_t words[2];
+        memcpy(words, key.text, sizeof(words));
+        uint64_t h = (words[0] ^ (words[1] * 0x9E3779B97F4A7C15ull)) * 0xBF58476D1CE4E5B9ull;
+        return static_cast<size_t>(h ^ (h >> 31));
+    }
+    
+    size_t mask() const { return slots_.size() - 1; }
+    
+    void place(uint32_t id) {
+        size_t i = hash(keys_[id]) & mask();
+        while (slots_[i] != NONE) {
+            i = (i + 1) & mask();
+        }
+        slots_[i] = id;
+    }
+    
+    void rehash(size_t size) {
+        slots_.assign(size, NONE);
+        for (uint32_t id = 0; id < keys_.size(); id++) {
+            place(id);
+        }
+    }
+    
+    std::deque<Key> keys_;          // By ID (deque: growth leaves names in place)
+    std::vector<uint32_t> slots_;   // Hash slots holding IDs
+};
+
+// =============================================================================
+// FLAT INDEX
+// =============================================================================
+// uint64 -> uint64 map in one open-addressed array (linear probing, at
+// most half full). Entries are only ever added or overwritten, matching
+// how long the order manager keeps its order state.
+class FlatIndex {
+public:
+    FlatIndex() {
+        clear();
+    }
+    
+    const uint64_t* find(uint64_t key) const {
+        for (size_t i = hash(key) & mask(); ; i = (i + 1) & mask()) {
+            const Entry& entry = entries_[i];
+            if (!entry.used) {
+                return nullptr;
+            }
+            if (entry.key == key) {
+                return &entry.value;
+            }
+        }
+    }
+    
+    // Value for key, added as 0 if absent
+    uint64_t& operator[](uint64_t key) {
+        if ((count_ + 1) * 2 > entries_.size()) {
+            rehash(entries_.size() * 2);
+        }
+        size_t i = hash(key) & mask();
+        while (entries_[i].used && entries_[i].key != key) {
+            i = (i + 1) & mask();
+        }
+        Entry& entry = entries_[i];
+        if (!entry.used) {
+            entry.used = true;
+            entry.key = key;
+            entry.value = 0;
+            count_++;
+        }
+        return entry.value;
+    }
+    
+    void reserve(size_t count) {
+        size_t size = entries_.size();
+        while (count * 2 > size) {
+            size <<= 1;
+        }
+        if (size != entries_.size()) {
+            rehash(size);
+        }
+    }
+    
+    void clear() {
+        entries_.assign(16, Entry());
+        count_ = 0;
+    }
+    
+    size_t size() const { return count_; }
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint64_t value;
+        bool used;
+        
+        Entry() : key(0), value(0), used(false) {}
+    };
+    
+    static size_t hash(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xFF51AFD7ED558CCDull;
+        key ^= key >> 33;
+        return static_cast<size_t>(key);
+    }
+    
+    size_t mask() const { return entries_.size() - 1; }
+    
+    void rehash(size_t size) {
+        std::vector<Entry> old(size);
+        old.swap(entries_);
+        for (const Entry& entry : old) {
+            if (entry.used) {
+                size_t i = hash(entry.key) & mask();
+                while (entries_[i].used) {
+                    i = (i + 1) & mask();
+                }
+                entries_[i] = entry;
+            }
+        }
+    }
+    
+    std::vector<Entry> entries_;
+    size_t count_;
+};
+
+// =============================================================================
+// ORDER SLAB
+// =============================================================================
+// Order state stored by exchange order ID. IDs are issued as first,
+// first + stride, ..., so (id - first) / stride is a dense slot index and
+// the ID me_lib reports in a callback leads straight to its state. Slots
+// live in fixed-size pages that never move, so references stay valid as
+// the slab grows.
+template <typename T>
+class OrderSlab {
+public:
+    OrderSlab()
+        : first_(1)
+        , stride_(1)
+        , count_(0)
+    {}
+    
+    void set_partition(uint64_t first, uint64_t stride) {
+        first_ = first;
+        stride_ = stride;
+    }
+    
+    // Slot for id, or nullptr if id was never stored. T's exchange_order_id
+    // is 0 in a slot that has not been filled.
+    T* find(uint64_t id) {
+        uint64_t index;
+        if (!slot_index(id, index) || index >= count_) {
+            return nullptr;
+        }
+        T& slot = at(index);
+        return slot.exchange_order_id == id ? &slot : nullptr;
+    }
+    
+    const T* find(uint64_t id) const {
+        return const_cast<OrderSlab*>(this)->find(id);
+    }
+    
+    // Fresh slot for id, growing as needed; nullptr if id is not in this
+    // slab's partition
+    T* insert(uint64_t id) {
+        uint64_t index;
+        if (!slot_index(id, index)) {
+            return nullptr;
+        }
+        while (index >= pages_.size() * PAGE_SIZE) {
+            pages_.emplace_back(new T[PAGE_SIZE]);
+        }
+        if (index >= count_) {
+            count_ = index + 1;
+        }
+        T& slot = at(index);
+        slot = T();
+        slot.exchange_order_id = id;
+        return &slot;
+    }
+    
+    // Filled slots in ID order
+    template <typename Visit>
+    void for_each(Visit&& visit) {
+        for (uint64_t index = 0; index < count_; index++) {
+            T& slot = at(index);
+            if (slot.exchange_order_id != 0) {
+                visit(slot);
+            }
+        }
+    }
+    
+    template <typename Visit>
+    void for_each(Visit&& visit) const {
+        const_cast<OrderSlab*>(this)->for_each([&](const T& slot) {
+            visit(slot);
+        });
+    }
+    
+    void clear() {
+        pages_.clear();
+        count_ = 0;
+    }
+
+private:
+    static constexpr uint64_t PAGE_SHIFT = 12;
+    static constexpr uint64_t PAGE_SIZE = 1ull << PAGE_SHIFT;
+    
+    bool slot_index(uint64_t id, uint64_t& index) const {
+        if (id < first_ || (id - first_) % stride_ != 0) {
+            return false;
+        }
+        index = (id - first_) / stride_;
+        return true;
+    }
+    
+    T& at(uint64_t index) {
+        return pages_[index >> PAGE_SHIFT][index & (PAGE_SIZE - 1)];
+    }
+    
+    uint64_t first_;
+    uint64_t stride_;
+    uint64_t count_;                        // Slots up to the highest ID stored
+    std::vector<std::unique_ptr<T[]>> pages_;
+};
+
+} // namespace engine
+} // namespace matching
+
+#endif // MATCHING_ENGINE_ORDER_STORE_H
@@ -0,0 +1,379 @@
+#include "sharded_engine.h"
+#include "journal.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace matching {
+namespace engine {
+
+namespace {
+
+// FNV-1a over the symbol text
+uint32_t symbol_hash(const std::string& symbol) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : symbol) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool path_exists(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0;
+}
+
+void pin_current_thread(int core) {
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    int result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (result != 0) {
+        std::cerr << "[Shard] Cannot pin to core " << core << ": " << strerror(result) << std::endl;
+    }
+#else
+    (void)core;
+#endif
+}
+
+} // namespace
+
+// =============================================================================
+// CONSTRUCTION
+// =============================================================================
+
+ShardedEngine::ShardedEngine(const ShardConfig& config)
+    : config_(config)
+    , running_(true)
+    , output_running_(false)
+{
+    uint32_t count = config_.shard_count ? config_.shard_count : 1;
+    shards_.reserve(count);
+    
+    for (uint32_t i = 0; i < count; i++) {
+        int core = config_.cores.empty() ? -1 : config_.cores[i % config_.cores.size()];
+        shards_.emplace_back(new Shard(i, core, config_.queue_capacity));
+        
+        // Shard i issues IDs i + 1, i + 1 + count, ... so IDs stay unique engine-wide
+        shards_.back()->manager.set_id_partition(i + 1, count);
+    }
+    
+    for (auto& shard : shards_) {
+        Shard* target = shard.get();
+        shard->thread = std::thread([this, target]() { run_shard(*target); });
+    }
+}
+
+ShardedEngine::~ShardedEngine() {
+    stop();
+}
+
+void ShardedEngine::set_message_callback(MessageCallback callback) {
+    wait_idle();
+    
+    // Shard threads are idle, and the next inbound publish orders these
+    // writes before the shard's next read of its manager
+    for (auto& shard : shards_) {
+        Shard* source = shard.get();
+        shard->manager.set_message_callback([this, source](const void* data, size_t size) {
+            push_output(*source, data, size);
+        });
+    }
+    
+    if (!output_running_.load(std::memory_order_acquire)) {
+        output_callback_ = callback;
+        output_running_.store(true, std::memory_order_release);
+        output_thread_ = std::thread([this]() { run_output(); });
+    }
+}
+
+bool ShardedEngine::add_symbol(const std::string& symbol) {
+    wait_idle();
+    return shards_[shard_for(symbol)]->manager.add_symbol(symbol);
+}
+
+void ShardedEngine::set_market_data(const std::vector<MarketDataSource*>& sources) {
+    // Idle shards, ordered by the next inbound publish as for callbacks
+    wait_idle();
+    for (auto& shard : shards_) {
+        shard->manager.set_market_data(sources[shard->index]);
+    }
+}
+
+uint32_t ShardedEngine::shard_for(const std::string& symbol) const {
+    auto it = config_.assignments.find(symbol);
+    if (it != config_.assignments.end() && it->second < shards_.size()) {
+        return it->second;
+    }
+    return symbol_hash(symbol) % static_cast<uint32_t>(shards_.size());
+}
+
+// =============================================================================
+// DISPATCH
+// =============================================================================
+
+void ShardedEngine::handle_new_order(const protocol::NewOrderMessage& msg, uint64_t received_ns) {
+    route(msg.symbol, &msg, sizeof(msg), received_ns);
+}
+
+void ShardedEngine::handle_cancel_order(const protocol::CancelOrderMessage& msg, uint64_t received_ns) {
+    route(msg.symbol, &msg, sizeof(msg), received_ns);
+}
+
+void ShardedEngine::handle_replace_order(const protocol::ReplaceOrderMessage& msg, uint64_t received_ns) {
+    route(msg.symbol, &msg, sizeof(msg), received_ns);
+}
+
+void ShardedEngine::handle_mass_cancel(const protocol::MassCancelMessage& msg, uint64_t received_ns) {
+    for (auto& shard : shards_) {
+        push_inbound(*shard, &msg, sizeof(msg), received_ns);
+    }
+}
+
+void ShardedEngine::route(const char* symbol, const void* message, size_t size, uint64_t received_ns) {
+    // Symbols are at most 15 characters, so this stays in the small-string buffer
+    std::string name(symbol, strnlen(symbol, sizeof(protocol::NewOrderMessage::symbol)));
+    push_inbound(*shards_[shard_for(name)], message, size, received_ns);
+}
+
+void ShardedEngine::push_inbound(Shard& shard, const void* message, size_t size, uint64_t received_ns) {
+    ShardMessage* slot = shard.inbound.claim();
+    slot->received_ns = received_ns;
+    slot->size = static_cast<uint32_t>(size);
+    memcpy(slot->data, message, size);
+    shard.inbound.publish();
+    shard.routed++;
+}
+
+void ShardedEngine::wait_idle() {
+    for (auto& shard : shards_) {
+        uint32_t idle_rounds = 0;
+        while (shard->applied.load(std::memory_order_acquire) != shard->routed) {
+            idle_backoff(idle_rounds);
+        }
+    }
+}
+
+void ShardedEngine::stop() {
+    if (!running_.load(std::memory_order_acquire)) {
+        return;
+    }
+    
+    // Every routed message is applied and its output queued before the
+    // shard threads stop, and the output thread drains before it does
+    wait_idle();
+    running_.store(false, std::memory_order_release);
+    for (auto& shard : shards_) {
+        if (shard->thread.joinable()) {
+            shard->thread.join();
+        }
+    }
+    
+    output_running_.store(false, std::memory_order_release);
+    if (output_thread_.joinable()) {
+        output_thread_.join();
+    }
+}
+
+// =============================================================================
+// SHARD AND OUTPUT THREADS
+// =============================================================================
+
+void ShardedEngine::run_shard(Shard& shard) {
+    if (shard.core >= 0) {
+        pin_current_thread(shard.core);
+    }
+    
+    uint32_t idle_rounds = 0;
+    uint64_t applied = 0;
+    
+    while (true) {
+        ShardMessage* slot = shard.inbound.front();
+        if (!slot) {
+            if (!running_.load(std::memory_order_acquire)) {
+                break;
+            }
+            idle_backoff(idle_rounds);
+            continue;
+        }
+        idle_rounds = 0;
+        
+        const protocol::MessageHeader* header = reinterpret_cast<const protocol::MessageHeader*>(slot->data);
+        uint64_t received_ns = slot->received_ns;
+        switch (header->get_type()) {
+            case protocol::MessageType::NEW_ORDER:
+                shard.manager.handle_new_order(
+                    *reinterpret_cast<const protocol::NewOrderMessage*>(slot->data), received_ns);
+                break;
+            
+            case protocol::MessageType::CANCEL_ORDER:
+                shard.manager.handle_cancel_order(
+                    *reinterpret_cast<const protocol::CancelOrderMessage*>(slot->data), received_ns);
+                break;
+            
+            case protocol::MessageType::REPLACE_ORDER:
+                shard.manager.handle_replace_order(
+                    *reinterpret_cast<const protocol::ReplaceOrderMessage*>(slot->data), received_ns);
+                break;
+            
+            case protocol::MessageType::MASS_CANCEL:
+                shard.manager.handle_mass_cancel(
+                    *reinterpret_cast<const protocol::MassCancelMessage*>(slot->data), received_ns);
+                break;
+            
+            default:
+                break;
+        }
+        
+        shard.inbound.pop();
+        shard.applied.store(++applied, std::memory_order_release);
+    }
+}
+
+void ShardedEngine::push_output(Shard& shard, const void* data, size_t size) {
+    if (size > sizeof(ShardMessage::data)) {
+        std::cerr << "[Shard] Dropping oversized outbound message (" << size << " bytes)" << std::endl;
+        return;
+    }
+    
+    ShardMessage* slot = shard.outbound.claim();
+    slot->size = static_cast<uint32_t>(size);
+    memcpy(slot->data, data, size);
+    reinterpret_cast<protocol::MessageHeader*>(slot->data)->stream = static_cast<uint16_t>(shard.index + 1);
+    shard.outbound.publish();
+}
+
+void ShardedEngine::run_output() {
+    // A bounded batch per shard per round keeps one busy shard from
+    // starving the others' streams
+    const uint32_t batch = 64;
+    uint32_t idle_rounds = 0;
+    
+    while (true) {
+        bool stopping = !output_running_.load(std::memory_order_acquire);
+        bool progressed = false;
+        
+        for (auto& shard : shards_) {
+            for (uint32_t n = 0; n < batch; n++) {
+                ShardMessage* slot = shard->outbound.front();
+                if (!slot) {
+                    break;
+                }
+                output_callback_(slot->data, slot->size);
+                shard->outbound.pop();
+                progressed = true;
+            }
+        }
+        
+        if (progressed) {
+            idle_rounds = 0;
+        } else if (stopping) {
+            break;
+        } else {
+            idle_backoff(idle_rounds);
+        }
+    }
+}
+
+// =============================================================================
+// STATISTICS
+// =============================================================================
+
+OrderManager::Statistics ShardedEngine::get_statistics() const {
+    OrderManager::Statistics total;
+    for (const auto& shard : shards_) {
+        OrderManager::Statistics stats = shard->manager.get_statistics();
+        total.total_orders_received += stats.total_orders_received;
+        total.total_orders_accepted += stats.total_orders_accepted;
+        total.total_orders_rejected += stats.total_orders_rejected;
+        total.total_orders_cancelled += stats.total_orders_cancelled;
+        total.total_executions += stats.total_executions;
+        total.total_volume += stats.total_volume;
+    }
+    return total;
+}
+
+void ShardedEngine::get_latency(OrderManager::LatencyStatistics& out) const {
+    out = OrderManager::LatencyStatistics();
+    OrderManager::LatencyStatistics shard_latency;
+    for (const auto& shard : shards_) {
+        shard->manager.get_latency(shard_latency);
+        out.match.add(shard_latency.match);
+        out.send.add(shard_latency.send);
+    }
+}
+
+// =============================================================================
+// SNAPSHOTS
+// =============================================================================
+
+std::string ShardedEngine::shard_directory(const std::string& directory, uint32_t shard) const {
+    char name[16];
+    snprintf(name, sizeof(name), "shard-%02u", shard);
+    return directory + "/" + name;
+}
+
+bool ShardedEngine::save_snapshot(const std::string& directory, uint64_t journal_sequence) {
+    wait_idle();
+    
+    std::string staging = directory + ".tmp";
+    remove_directory(staging);
+    if (mkdir(staging.c_str(), 0755) != 0) {
+        std::cerr << "[ShardedEngine] Cannot create " << staging << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    
+    for (auto& shard : shards_) {
+        if (!shard->manager.save_snapshot(shard_directory(staging, shard->index), journal_sequence)) {
+            remove_directory(staging);
+            return false;
+        }
+    }
+    
+    if (!sync_directory(staging) || rename(staging.c_str(), directory.c_str()) != 0) {
+        std::cerr << "[ShardedEngine] Failed to publish snapshot " << directory << ": " << strerror(errno) << std::endl;
+        remove_directory(staging);
+        return false;
+    }
+    
+    size_t slash = directory.find_last_of('/');
+    sync_directory(slash == std::string::npos ? "." : directory.substr(0, slash));
+    return true;
+}
+
+bool ShardedEngine::load_snapshot(const std::string& directory, uint64_t& journal_sequence) {
+    wait_idle();
+    
+    // Symbols are placed by shard count, so a snapshot only fits the same count
+    uint32_t count = shard_count();
+    if (!path_exists(shard_directory(directory, count - 1)) || path_exists(shard_directory(directory, count))) {
+        std::cerr << "[ShardedEngine] Snapshot " << directory << " was not taken with "
+                  << count << " shards" << std::endl;
+        return false;
+    }
+    
+    for (auto& shard : shards_) {
+        uint64_t sequence = 0;
+        if (!shard->manager.load_snapshot(shard_directory(directory, shard->index), sequence)) {
+            return false;
+        }
+        if (shard->index > 0 && sequence != journal_sequence) {
+            std::cerr << "[ShardedEngine] Shard " << shard->index << " snapshot is at sequence "
+                      << sequence << ", expected " << journal_sequence << std::endl;
+            return false;
+        }
+        journal_sequence = sequence;
+    }
+    return true;
+}
+
+} // namespace engine
+} // namespace matching
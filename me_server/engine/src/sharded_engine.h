@@ -0,0 +1,145 @@
+#ifndef MATCHING_ENGINE_SHARDED_ENGINE_H
+#define MATCHING_ENGINE_SHARDED_ENGINE_H
+
+#include "order_manager.h"
+#include "../../common/protocol.h"
+#include "../../common/spsc_queue.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace matching {
+namespace engine {
+
+// =============================================================================
+// SHARD CONFIGURATION
+// =============================================================================
+struct ShardConfig {
+    uint32_t shard_count;
+    std::vector<int> cores;     // Core for shard i is cores[i % size]; empty = unpinned
+    std::unordered_map<std::string, uint32_t> assignments;  // Symbol -> shard overrides
+    uint32_t queue_capacity;    // Slots in each inbound / outbound queue
+    
+    ShardConfig()
+        : shard_count(0)
+        , queue_capacity(1u << 14)
+    {}
+};
+
+// =============================================================================
+// SHARD MESSAGE SLOT
+// =============================================================================
+// One protocol message, copied whole into a queue slot (data first, so
+// the message keeps the slot's alignment), with its receive time
+struct alignas(64) ShardMessage {
+    uint8_t data[112];
+    uint64_t received_ns;       // Inbound only
+    uint32_t size;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(ShardMessage) == 128, "ShardMessage must be two cache lines");
+static_assert(sizeof(protocol::NewOrderMessage) <= sizeof(ShardMessage::data), "NewOrderMessage must fit a slot");
+static_assert(sizeof(protocol::ReplaceOrderMessage) <= sizeof(ShardMessage::data), "ReplaceOrderMessage must fit a slot");
+static_assert(sizeof(protocol::MassCancelMessage) <= sizeof(ShardMessage::data), "MassCancelMessage must fit a slot");
+static_assert(sizeof(protocol::OrderRejectMessage) <= sizeof(ShardMessage::data), "OrderRejectMessage must fit a slot");
+static_assert(sizeof(protocol::ExecutionMessage) <= sizeof(ShardMessage::data), "ExecutionMessage must fit a slot");
+
+// =============================================================================
+// SHARDED ENGINE
+// =============================================================================
+// Symbols are split over N shards, each an OrderManager (own mx_context_t,
+// books and order state) driven by its own, optionally core-pinned, thread.
+// The caller's thread is the dispatcher: it routes every order and cancel
+// on its symbol into that shard's inbound queue. Shards push their outbound
+// messages into per-shard queues that one output thread merges; each shard
+// numbers its messages itself and stamps its stream (shard + 1) in the
+// header, so every stream is gap-free on its own.
+//
+// Mirrors the OrderManager interface used by the engine's main loop. All
+// calls are made from the dispatcher thread.
+class ShardedEngine {
+public:
+    explicit ShardedEngine(const ShardConfig& config);
+    ~ShardedEngine();
+    
+    ShardedEngine(const ShardedEngine&) = delete;
+    ShardedEngine& operator=(const ShardedEngine&) = delete;
+    
+    // Outbound messages from every shard; starts the output thread
+    void set_message_callback(MessageCallback callback);
+    bool add_symbol(const std::string& symbol);
+    
+    // Market data source for each shard, sources[shard]
+    void set_market_data(const std::vector<MarketDataSource*>& sources);
+    
+    void handle_new_order(const protocol::NewOrderMessage& msg, uint64_t received_ns);
+    void handle_cancel_order(const protocol::CancelOrderMessage& msg, uint64_t received_ns);
+    void handle_replace_order(const protocol::ReplaceOrderMessage& msg, uint64_t received_ns);
+    
+    // A user's orders can rest on every shard, so each gets a copy (and
+    // sends its own MASS_CANCEL_ACK)
+    void handle_mass_cancel(const protocol::MassCancelMessage& msg, uint64_t received_ns);
+    
+    // Block until every shard has applied everything routed to it
+    void wait_idle();
+    
+    // Drain all shards and outputs, then stop every thread
+    void stop();
+    
+    // Sum over shards
+    OrderManager::Statistics get_statistics() const;
+    
+    // Handler latencies merged across shards
+    void get_latency(OrderManager::LatencyStatistics& out) const;
+    
+    // One OrderManager snapshot per shard in directory/shard-NN
+    bool save_snapshot(const std::string& directory, uint64_t journal_sequence);
+    bool load_snapshot(const std::string& directory, uint64_t& journal_sequence);
+    
+    uint32_t shard_count() const { return static_cast<uint32_t>(shards_.size()); }
+    uint32_t shard_for(const std::string& symbol) const;
+
+private:
+    struct Shard {
+        uint32_t index;
+        int core;                               // -1 = unpinned
+        OrderManager manager;
+        SpscQueue<ShardMessage> inbound;        // Dispatcher -> shard
+        SpscQueue<ShardMessage> outbound;       // Shard -> output thread
+        uint64_t routed;                        // Dispatcher only
+        std::atomic<uint64_t> applied;          // Written by the shard thread
+        std::thread thread;
+        
+        Shard(uint32_t shard_index, int shard_core, uint32_t capacity)
+            : index(shard_index)
+            , core(shard_core)
+            , inbound(capacity)
+            , outbound(capacity)
+            , routed(0)
+            , applied(0)
+        {}
+    };
+    
+    ShardConfig config_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<bool> running_;
+    std::atomic<bool> output_running_;
+    MessageCallback output_callback_;
+    std::thread output_thread_;
+    
+    void route(const char* symbol, const void* message, size_t size, uint64_t received_ns);
+    void push_inbound(Shard& shard, const void* message, size_t size, uint64_t received_ns);
+    void run_shard(Shard& shard);
+    void run_output();
+    void push_output(Shard& shard, const void* data, size_t size);
+    std::string shard_directory(const std::string& directory, uint32_t shard) const;
+};
+
+} // namespace engine
+} // namespace matching
+
+#endif // MATCHING_ENGINE_SHARDED_ENGINE_H
@@ -0,0 +1,249 @@
+#ifndef MATCHING_GATEWAY_FRAMING_H
+#define MATCHING_GATEWAY_FRAMING_H
+
+#include "../../common/protocol.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace matching {
+namespace gateway {
+
+// =============================================================================
+// FRAME READER
+// =============================================================================
+// Cuts a byte stream into protocol messages. Every frame that lies whole
+// in the bytes of one read is handed out where it lies (the protocol
+// structs are packed, so any address is fine); only a frame split across
+// reads is copied, into a buffer that holds at most one partial frame.
+//
+// Both v1 messages and v2 frames are accepted (their first 8 bytes give
+// the length either way); callbacks receive (const protocol::MessageHeader*
+// frame, size_t length), must check frame->version before reading past the
+// first byte, and must not keep the pointer.
+
+class FrameReader {
+public:
+    // max_length bounds a single frame; capacity >= max_length is the
+    // buffer used by space() / commit()
+    explicit FrameReader(size_t max_length, size_t capacity = 0)
+        : max_length_(max_length)
+        , capacity_(std::max(max_length, capacity))
+        , buffer_(new uint8_t[capacity_])
+        , used_(0)
+    {}
+    
+    FrameReader(const FrameReader&) = delete;
+    FrameReader& operator=(const FrameReader&) = delete;
+    
+    // Bytes read elsewhere (reactor buffers). Returns an error once the
+    // stream is malformed; it cannot be resynchronised after that.
+    template <typename OnFrame>
+    const char* consume(const uint8_t* data, size_t size, OnFrame&& on_frame) {
+        if (used_ > 0) {
+            // Finish the frame the previous read split
+            size_t wanted = used_ < protocol::FRAME_PREFIX ? protocol::FRAME_PREFIX : frame_length(buffer_.get());
+            size_t take = std::min(wanted - used_, size);
+            memcpy(buffer_.get() + used_, data, take);
+            used_ += take;
+            data += take;
+            size -= take;
+            
+            if (used_ == protocol::FRAME_PREFIX) {
+                if (const char* error = check_header(buffer_.get())) {
+                    return error;
+                }
+                take = std::min(frame_length(buffer_.get()) - used_, size);
+                memcpy(buffer_.get() + used_, data, take);
+                used_ += take;
+                data += take;
+                size -= take;
+            }
+            
+            if (used_ < protocol::FRAME_PREFIX || used_ < frame_length(buffer_.get())) {
+                return nullptr; // Still partial: everything was taken
+            }
+            on_frame(reinterpret_cast<const protocol::MessageHeader*>(buffer_.get()), used_);
+            used_ = 0;
+        }
+        
+        if (const char* error = scan(data, size, on_frame)) {
+            return error;
+        }
+        
+        memcpy(buffer_.get(), data, size);
+        used_ = size;
+        return nullptr;
+    }
+    
+    // Direct reads into the buffer: read up to room() bytes at space(),
+    // then commit() them to parse every complete frame in place
+    uint8_t* space() { return buffer_.get() + used_; }
+    size_t room() const { return capacity_ - used_; }
+    
+    template <typename OnFrame>
+    const char* commit(size_t added, OnFrame&& on_frame) {
+        const uint8_t* data = buffer_.get();
+        size_t size = used_ + added;
+        if (const char* error = scan(data, size, on_frame)) {
+            return error;
+        }
+        
+        // Less than one frame is left; move it to the front
+        memmove(buffer_.get(), data, size);
+        used_ = size;
+        return nullptr;
+    }
+
+private:
+    static size_t frame_length(const uint8_t* frame) {
+        return protocol::frame_length(frame);
+    }
+    
+    const char* check_header(const uint8_t* frame) const {
+        size_t minimum;
+        if (frame[0] == protocol::PROTOCOL_VERSION) {
+            minimum = sizeof(protocol::MessageHeader);
+        } else if (frame[0] == protocol::PROTOCOL_VERSION_2) {
+            minimum = sizeof(protocol::FrameHeaderV2);
+        } else {
+            return "Invalid protocol version";
+        }
+        size_t length = frame_length(frame);
+        if (length < minimum || length > max_length_) {
+            return "Invalid message length";
+        }
+        return nullptr;
+    }
+    
+    // Hand out whole frames, advancing data / size past them
+    template <typename OnFrame>
+    const char* scan(const uint8_t*& data, size_t& size, OnFrame&& on_frame) const {
+        while (size >= protocol::FRAME_PREFIX) {
+            if (const char* error = check_header(data)) {
+                return error;
+            }
+            size_t length = frame_length(data);
+            if (size < length) {
+                break;
+            }
+            on_frame(reinterpret_cast<const protocol::MessageHeader*>(data), length);
+            data += length;
+            size -= length;
+        }
+        return nullptr;
+    }
+    
+    size_t max_length_;
+    size_t capacity_;
+    std::unique_ptr<uint8_t[]> buffer_;
+    size_t used_;
+};
+
+// =============================================================================
+// SEND QUEUE
+// =============================================================================
+// Outbound bytes for one socket, coalesced so a burst of messages leaves
+// in a single sendmsg(). A power-of-two byte ring that grows on demand up
+// to a limit; a wrapped ring goes out as two iovecs.
+
+class SendQueue {
+public:
+    explicit SendQueue(size_t limit)
+        : limit_(limit)
+        , capacity_(0)
+        , head_(0)
+        , tail_(0)
+    {}
+    
+    SendQueue(const SendQueue&) = delete;
+    SendQueue& operator=(const SendQueue&) = delete;
+    
+    size_t size() const { return static_cast<size_t>(tail_ - head_); }
+    bool empty() const { return head_ == tail_; }
+    
+    // False if the bytes would take the queue past its limit
+    bool append(const void* data, size_t length) {
+        if (size() + length > limit_) {
+            return false;
+        }
+        if (size() + length > capacity_) {
+            grow(size() + length);
+        }
+        
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        size_t offset = static_cast<size_t>(tail_) & (capacity_ - 1);
+        size_t first = std::min(length, capacity_ - offset);
+        memcpy(ring_.get() + offset, bytes, first);
+        memcpy(ring_.get(), bytes + first, length - first);
+        tail_ += length;
+        return true;
+    }
+    
+    // Write as much as the socket takes. False on a socket error (errno
+    // set); EAGAIN is not an error.
+    bool flush(int fd) {
+        while (!empty()) {
+            struct iovec iov[2];
+            size_t offset = static_cast<size_t>(head_) & (capacity_ - 1);
+            size_t first = std::min(size(), capacity_ - offset);
+            iov[0].iov_base = ring_.get() + offset;
+            iov[0].iov_len = first;
+            iov[1].iov_base = ring_.get();
+            iov[1].iov_len = size() - first;
+            
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = iov;
+            msg.msg_iovlen = iov[1].iov_len ? 2 : 1;
+            
+            ssize_t sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            head_ += static_cast<uint64_t>(sent);
+        }
+        return true;
+    }
+
+private:
+    void grow(size_t needed) {
+        size_t capacity = capacity_ ? capacity_ : 4096;
+        while (capacity < needed) {
+            capacity <<= 1;
+        }
+        
+        std::unique_ptr<uint8_t[]> ring(new uint8_t[capacity]);
+        size_t count = size();
+        if (count > 0) {
+            size_t offset = static_cast<size_t>(head_) & (capacity_ - 1);
+            size_t first = std::min(count, capacity_ - offset);
+            memcpy(ring.get(), ring_.get() + offset, first);
+            memcpy(ring.get() + first, ring_.get(), count - first);
+        }
+        
+        ring_ = std::move(ring);
+        capacity_ = capacity;
+        head_ = 0;
+        tail_ = count;
+    }
+    
+    size_t limit_;
+    size_t capacity_;
+    std::unique_ptr<uint8_t[]> ring_;
+    uint64_t head_;     // Next byte to send
+    uint64_t tail_;     // Next byte to fill
+};
+
+} // namespace gateway
+} // namespace matching
+
+#endif // MATCHING_GATEWAY_FRAMING_H
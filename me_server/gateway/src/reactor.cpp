@@ -0,0 +1,783 @@
+#include "reactor.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+namespace matching {
+namespace gateway {
+
+namespace {
+
+// =============================================================================
+// EVENT TOKENS
+// =============================================================================
+// Every registration carries kind | generation | fd. A client's generation
+// moves on each add_client(), so events still in flight for a descriptor
+// that was dropped (and possibly reused by a new client) are recognised
+// as stale and ignored.
+enum TokenKind : uint64_t {
+    TOKEN_WAKE = 1,
+    TOKEN_LISTENER = 2,
+    TOKEN_CLIENT = 3,
+    TOKEN_WRITABLE = 4,
+    TOKEN_CANCEL = 5,
+};
+
+constexpr uint32_t GENERATION_MASK = 0xFFFFFF;
+
+uint64_t make_token(TokenKind kind, uint32_t generation, int fd) {
+    return (static_cast<uint64_t>(kind) << 56) |
+           (static_cast<uint64_t>(generation & GENERATION_MASK) << 32) |
+           static_cast<uint32_t>(fd);
+}
+
+TokenKind token_kind(uint64_t token) { return static_cast<TokenKind>(token >> 56); }
+uint32_t token_generation(uint64_t token) { return static_cast<uint32_t>(token >> 32) & GENERATION_MASK; }
+int token_fd(uint64_t token) { return static_cast<int>(static_cast<uint32_t>(token)); }
+
+// =============================================================================
+// CLIENT TABLE
+// =============================================================================
+// Per-descriptor registration state, indexed by fd
+struct ClientState {
+    uint32_t generation = 0;
+    bool active = false;
+    bool want_write = false;
+    bool write_armed = false;   // io_uring: a POLLOUT request is pending
+};
+
+class ClientTable {
+public:
+    uint32_t activate(int fd) {
+        if (static_cast<size_t>(fd) >= states_.size()) {
+            states_.resize(static_cast<size_t>(fd) + 1);
+        }
+        ClientState& state = states_[fd];
+        state.generation = (state.generation + 1) & GENERATION_MASK;
+        state.active = true;
+        state.want_write = false;
+        state.write_armed = false;
+        return state.generation;
+    }
+    
+    // Active registration for fd, or nullptr
+    ClientState* find(int fd) {
+        if (fd < 0 || static_cast<size_t>(fd) >= states_.size() || !states_[fd].active) {
+            return nullptr;
+        }
+        return &states_[fd];
+    }
+    
+    // Active registration for fd that still matches an event's generation
+    ClientState* current(int fd, uint32_t generation) {
+        ClientState* state = find(fd);
+        return state && state->generation == generation ? state : nullptr;
+    }
+
+private:
+    std::vector<ClientState> states_;
+};
+
+// =============================================================================
+// EPOLL BACKEND
+// =============================================================================
+// Clients are edge-triggered for both directions: each readiness edge is
+// drained with recv() until EAGAIN, and the EPOLLOUT edge after a short
+// write is reported only while the handler wants it.
+class EpollReactor : public Reactor {
+public:
+    explicit EpollReactor(ReactorHandler& handler)
+        : Reactor(handler)
+        , epoll_fd_(-1)
+        , scratch_(RECV_CHUNK)
+        , events_(MAX_EVENTS)
+    {}
+    
+    ~EpollReactor() override {
+        if (epoll_fd_ >= 0) {
+            close(epoll_fd_);
+        }
+    }
+    
+    bool open() override {
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ < 0) {
+            std::cerr << "[Reactor] epoll_create1 failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        return open_wake_fd() && watch(EPOLL_CTL_ADD, wake_fd_, EPOLLIN | EPOLLET, make_token(TOKEN_WAKE, 0, wake_fd_));
+    }
+    
+    bool add_listener(int fd) override {
+        return watch(EPOLL_CTL_ADD, fd, EPOLLIN | EPOLLET, make_token(TOKEN_LISTENER, 0, fd));
+    }
+    
+    bool add_client(int fd) override {
+        uint32_t generation = clients_.activate(fd);
+        uint32_t events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        if (!watch(EPOLL_CTL_ADD, fd, events, make_token(TOKEN_CLIENT, generation, fd))) {
+            clients_.find(fd)->active = false;
+            return false;
+        }
+        return true;
+    }
+    
+    void remove_client(int fd) override {
+        ClientState* state = clients_.find(fd);
+        if (!state) {
+            return;
+        }
+        state->active = false;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+    
+    void want_write(int fd, bool enabled) override {
+        // EPOLLOUT stays registered; a short write always precedes the
+        // edge that reports room again
+        if (ClientState* state = clients_.find(fd)) {
+            state->want_write = enabled;
+        }
+    }
+    
+    void poll(int timeout_ms) override {
+        int count = epoll_wait(epoll_fd_, events_.data(), static_cast<int>(events_.size()), timeout_ms);
+        if (count < 0) {
+            if (errno != EINTR) {
+                std::cerr << "[Reactor] epoll_wait failed: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+        
+        for (int i = 0; i < count; i++) {
+            uint64_t token = events_[i].data.u64;
+            int fd = token_fd(token);
+            
+            switch (token_kind(token)) {
+                case TOKEN_WAKE:
+                    drain_wake_fd();
+                    handler_.on_wakeup();
+                    break;
+                
+                case TOKEN_LISTENER:
+                    accept_clients(fd);
+                    break;
+                
+                case TOKEN_CLIENT:
+                    handle_client(fd, token_generation(token), events_[i].events);
+                    break;
+                
+                default:
+                    break;
+            }
+        }
+    }
+    
+    const char* name() const override { return "epoll"; }
+
+private:
+    static constexpr size_t RECV_CHUNK = 64 * 1024;
+    static constexpr size_t MAX_EVENTS = 256;
+    
+    bool watch(int op, int fd, uint32_t events, uint64_t token) {
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.u64 = token;
+        if (epoll_ctl(epoll_fd_, op, fd, &event) < 0) {
+            std::cerr << "[Reactor] epoll_ctl failed for fd " << fd << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
+    void accept_clients(int listen_fd) {
+        while (true) {
+            int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd >= 0) {
+                handler_.on_accept(fd);
+                continue;
+            }
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "[Reactor] accept failed: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+    }
+    
+    void handle_client(int fd, uint32_t generation, uint32_t events) {
+        if (!clients_.current(fd, generation)) {
+            return; // Dropped earlier in this batch
+        }
+        
+        if ((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) && !read_client(fd, generation)) {
+            return;
+        }
+        
+        ClientState* state = clients_.current(fd, generation);
+        if (state && state->want_write && (events & EPOLLOUT)) {
+            handler_.on_writable(fd);
+        }
+    }
+    
+    // False once the client is gone (closed by the peer or by the handler)
+    bool read_client(int fd, uint32_t generation) {
+        while (true) {
+            ssize_t received = recv(fd, scratch_.data(), scratch_.size(), 0);
+            if (received > 0) {
+                handler_.on_data(fd, scratch_.data(), static_cast<size_t>(received));
+                if (!clients_.current(fd, generation)) {
+                    return false;
+                }
+                continue;
+            }
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return true;
+            }
+            
+            remove_client(fd);
+            handler_.on_closed(fd);
+            return false;
+        }
+    }
+    
+    int epoll_fd_;
+    ClientTable clients_;
+    std::vector<uint8_t> scratch_;
+    std::vector<struct epoll_event> events_;
+};
+
+// =============================================================================
+// IO_URING BACKEND
+// =============================================================================
+// Raw io_uring (no liburing): one multishot accept per listener and one
+// multishot recv per client, which the kernel fills from a provided buffer
+// ring registered with the ring (IORING_REGISTER_PBUF_RING), so an idle
+// session holds no receive buffer at all. Buffers go back to the ring as
+// soon as on_data() returns. Writes stay plain non-blocking send() calls
+// from the handler; want_write() arms a one-shot POLLOUT request.
+class IoUringReactor : public Reactor {
+public:
+    explicit IoUringReactor(ReactorHandler& handler)
+        : Reactor(handler)
+        , ring_fd_(-1)
+        , sq_ring_(MAP_FAILED)
+        , cq_ring_(MAP_FAILED)
+        , sq_ring_size_(0)
+        , cq_ring_size_(0)
+        , sqes_(static_cast<io_uring_sqe*>(MAP_FAILED))
+        , sqes_size_(0)
+        , sq_khead_(nullptr)
+        , sq_ktail_(nullptr)
+        , sq_kflags_(nullptr)
+        , sq_array_(nullptr)
+        , sq_mask_(0)
+        , sq_entries_(0)
+        , sq_tail_(0)
+        , cq_khead_(nullptr)
+        , cq_ktail_(nullptr)
+        , cqes_(nullptr)
+        , cq_mask_(0)
+        , buf_ring_(static_cast<io_uring_buf_ring*>(MAP_FAILED))
+        , buf_ring_size_(0)
+        , buf_tail_(0)
+    {}
+    
+    ~IoUringReactor() override {
+        if (ring_fd_ >= 0) {
+            close(ring_fd_);
+        }
+        if (buf_ring_ != MAP_FAILED) {
+            munmap(buf_ring_, buf_ring_size_);
+        }
+        if (sqes_ != MAP_FAILED) {
+            munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+            munmap(cq_ring_, cq_ring_size_);
+        }
+        if (sq_ring_ != MAP_FAILED) {
+            munmap(sq_ring_, sq_ring_size_);
+        }
+    }
+    
+    bool open() override {
+        if (!setup_ring() || !setup_buffers() || !open_wake_fd()) {
+            return false;
+        }
+        arm_wake();
+        return true;
+    }
+    
+    bool add_listener(int fd) override {
+        listeners_.push_back(fd);
+        return arm_accept(fd);
+    }
+    
+    bool add_client(int fd) override {
+        uint32_t generation = clients_.activate(fd);
+        if (!arm_recv(fd, generation)) {
+            clients_.find(fd)->active = false;
+            return false;
+        }
+        return true;
+    }
+    
+    void remove_client(int fd) override {
+        ClientState* state = clients_.find(fd);
+        if (!state) {
+            return;
+        }
+        state->active = false;
+        
+        // Pending requests hold a reference to the socket, so they are
+        // cancelled now, while fd still names it
+        if (io_uring_sqe* sqe = next_sqe()) {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = fd;
+            sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+            sqe->user_data = make_token(TOKEN_CANCEL, 0, fd);
+        }
+        submit(0, 0);
+    }
+    
+    void want_write(int fd, bool enabled) override {
+        ClientState* state = clients_.find(fd);
+        if (!state) {
+            return;
+        }
+        state->want_write = enabled;
+        if (enabled && !state->write_armed) {
+            state->write_armed = arm_poll(fd, POLLOUT, false, make_token(TOKEN_WRITABLE, state->generation, fd));
+        }
+    }
+    
+    void poll(int timeout_ms) override {
+        bool ready = *cq_khead_ != __atomic_load_n(cq_ktail_, __ATOMIC_ACQUIRE);
+        
+        if (timeout_ms == 0 || ready) {
+            // GETEVENTS also runs deferred completion work and flushes a
+            // CQ overflow backlog
+            submit(0, IORING_ENTER_GETEVENTS);
+        } else {
+            struct __kernel_timespec timeout;
+            struct io_uring_getevents_arg arg;
+            memset(&arg, 0, sizeof(arg));
+            arg.sigmask_sz = _NSIG / 8;
+            if (timeout_ms > 0) {
+                timeout.tv_sec = timeout_ms / 1000;
+                timeout.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000;
+                arg.ts = reinterpret_cast<uint64_t>(&timeout);
+            }
+            submit(1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+        }
+        
+        reap();
+    }
+    
+    const char* name() const override { return "io_uring"; }
+
+private:
+    static constexpr unsigned RING_ENTRIES = 4096;
+    static constexpr unsigned BUFFER_COUNT = 1024;      // Power of two
+    static constexpr unsigned BUFFER_SIZE = 4096;
+    static constexpr uint16_t BUFFER_GROUP = 0;
+    
+    static int io_uring_setup(unsigned entries, struct io_uring_params* params) {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+    
+    int io_uring_enter(unsigned to_submit, unsigned min_complete, unsigned flags, void* arg, size_t arg_size) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, arg, arg_size));
+    }
+    
+    bool setup_ring() {
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN;
+        params.cq_entries = RING_ENTRIES * 4;
+        ring_fd_ = io_uring_setup(RING_ENTRIES, &params);
+        
+        if (ring_fd_ < 0 && errno == EINVAL) {
+            // Kernels before 5.19 lack COOP_TASKRUN
+            memset(&params, 0, sizeof(params));
+            params.flags = IORING_SETUP_CQSIZE;
+            params.cq_entries = RING_ENTRIES * 4;
+            ring_fd_ = io_uring_setup(RING_ENTRIES, &params);
+        }
+        if (ring_fd_ < 0) {
+            std::cerr << "[Reactor] io_uring_setup failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        if (!(params.features & IORING_FEAT_EXT_ARG)) {
+            std::cerr << "[Reactor] io_uring needs Linux 6.0 or later" << std::endl;
+            return false;
+        }
+        
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        }
+        
+        sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd_, IORING_OFF_SQ_RING);
+        cq_ring_ = single_mmap ? sq_ring_ :
+                   mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd_, IORING_OFF_CQ_RING);
+        sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                                                MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+        if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+            std::cerr << "[Reactor] Cannot map io_uring: " << strerror(errno) << std::endl;
+            return false;
+        }
+        
+        uint8_t* sq = static_cast<uint8_t*>(sq_ring_);
+        sq_khead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_ktail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_kflags_ = reinterpret_cast<unsigned*>(sq + params.sq_off.flags);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_entries_ = params.sq_entries;
+        sq_tail_ = *sq_ktail_;
+        
+        uint8_t* cq = static_cast<uint8_t*>(cq_ring_);
+        cq_khead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_ktail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        return true;
+    }
+    
+    bool setup_buffers() {
+        buf_ring_size_ = BUFFER_COUNT * sizeof(struct io_uring_buf);
+        buf_ring_ = static_cast<io_uring_buf_ring*>(mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE,
+                                                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (buf_ring_ == MAP_FAILED) {
+            std::cerr << "[Reactor] Cannot map buffer ring: " << strerror(errno) << std::endl;
+            return false;
+        }
+        buffers_.resize(static_cast<size_t>(BUFFER_COUNT) * BUFFER_SIZE);
+        
+        struct io_uring_buf_reg reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.ring_addr = reinterpret_cast<uint64_t>(buf_ring_);
+        reg.ring_entries = BUFFER_COUNT;
+        reg.bgid = BUFFER_GROUP;
+        if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+            std::cerr << "[Reactor] Cannot register buffer ring: " << strerror(errno) << std::endl;
+            return false;
+        }
+        
+        for (unsigned id = 0; id < BUFFER_COUNT; id++) {
+            recycle_buffer(static_cast<uint16_t>(id));
+        }
+        publish_buffers();
+        return true;
+    }
+    
+    uint8_t* buffer(uint16_t id) {
+        return buffers_.data() + static_cast<size_t>(id) * BUFFER_SIZE;
+    }
+    
+    void recycle_buffer(uint16_t id) {
+        // Index the ring as a plain array: the uapi header's bufs[] member is
+        // misplaced when compiled as C++ (its flex-array helper adds an
+        // empty struct in front of it)
+        struct io_uring_buf* entry = reinterpret_cast<struct io_uring_buf*>(buf_ring_) + (buf_tail_ & (BUFFER_COUNT - 1));
+        entry->addr = reinterpret_cast<uint64_t>(buffer(id));
+        entry->len = BUFFER_SIZE;
+        entry->bid = id;
+        buf_tail_++;
+    }
+    
+    void publish_buffers() {
+        __atomic_store_n(&buf_ring_->tail, buf_tail_, __ATOMIC_RELEASE);
+    }
+    
+    // =========================================================================
+    // SUBMISSION
+    // =========================================================================
+    
+    io_uring_sqe* next_sqe() {
+        if (sq_tail_ - __atomic_load_n(sq_khead_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+            submit(0, 0);
+            if (sq_tail_ - __atomic_load_n(sq_khead_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+                std::cerr << "[Reactor] io_uring submission queue full" << std::endl;
+                return nullptr;
+            }
+        }
+        
+        unsigned index = sq_tail_ & sq_mask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sq_array_[index] = index;
+        sq_tail_++;
+        return sqe;
+    }
+    
+    void submit(unsigned min_complete, unsigned flags, void* arg = nullptr, size_t arg_size = 0) {
+        __atomic_store_n(sq_ktail_, sq_tail_, __ATOMIC_RELEASE);
+        unsigned pending = sq_tail_ - __atomic_load_n(sq_khead_, __ATOMIC_ACQUIRE);
+        if (__atomic_load_n(sq_kflags_, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW) {
+            flags |= IORING_ENTER_GETEVENTS;
+        }
+        if (pending == 0 && flags == 0) {
+            return;
+        }
+        
+        if (io_uring_enter(pending, min_complete, flags, arg, arg_size) < 0 &&
+            errno != EINTR && errno != ETIME && errno != EBUSY) {
+            std::cerr << "[Reactor] io_uring_enter failed: " << strerror(errno) << std::endl;
+        }
+    }
+    
+    bool arm_accept(int fd) {
+        io_uring_sqe* sqe = next_sqe();
+        if (!sqe) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = fd;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+        sqe->user_data = make_token(TOKEN_LISTENER, 0, fd);
+        return true;
+    }
+    
+    bool arm_recv(int fd, uint32_t generation) {
+        io_uring_sqe* sqe = next_sqe();
+        if (!sqe) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = fd;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = BUFFER_GROUP;
+        sqe->user_data = make_token(TOKEN_CLIENT, generation, fd);
+        return true;
+    }
+    
+    bool arm_poll(int fd, uint32_t events, bool multishot, uint64_t token) {
+        io_uring_sqe* sqe = next_sqe();
+        if (!sqe) {
+            return false;
+        }
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = fd;
+        sqe->poll32_events = events;
+        sqe->len = multishot ? IORING_POLL_ADD_MULTI : 0;
+        sqe->user_data = token;
+        return true;
+    }
+    
+    void arm_wake() {
+        arm_poll(wake_fd_, POLLIN, true, make_token(TOKEN_WAKE, 0, wake_fd_));
+    }
+    
+    // =========================================================================
+    // COMPLETION
+    // =========================================================================
+    
+    void reap() {
+        unsigned head = *cq_khead_;
+        unsigned tail = __atomic_load_n(cq_ktail_, __ATOMIC_ACQUIRE);
+        
+        while (head != tail) {
+            // Copy out and release the slot first: handlers may submit
+            struct io_uring_cqe cqe = cqes_[head & cq_mask_];
+            head++;
+            __atomic_store_n(cq_khead_, head, __ATOMIC_RELEASE);
+            dispatch(cqe);
+        }
+        
+        publish_buffers();
+    }
+    
+    void dispatch(const struct io_uring_cqe& cqe) {
+        int fd = token_fd(cqe.user_data);
+        bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+        
+        switch (token_kind(cqe.user_data)) {
+            case TOKEN_WAKE:
+                drain_wake_fd();
+                if (!more) {
+                    arm_wake();
+                }
+                handler_.on_wakeup();
+                break;
+            
+            case TOKEN_LISTENER:
+                if (cqe.res >= 0) {
+                    handler_.on_accept(cqe.res);
+                } else if (cqe.res != -ECANCELED) {
+                    std::cerr << "[Reactor] accept failed: " << strerror(-cqe.res) << std::endl;
+                }
+                if (!more) {
+                    arm_accept(fd);
+                }
+                break;
+            
+            case TOKEN_CLIENT:
+                handle_recv(fd, token_generation(cqe.user_data), cqe, more);
+                break;
+            
+            case TOKEN_WRITABLE:
+                if (ClientState* state = clients_.current(fd, token_generation(cqe.user_data))) {
+                    state->write_armed = false;
+                    if (state->want_write) {
+                        handler_.on_writable(fd);
+                    }
+                }
+                break;
+            
+            default:
+                break;
+        }
+    }
+    
+    void handle_recv(int fd, uint32_t generation, const struct io_uring_cqe& cqe, bool more) {
+        bool has_buffer = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+        uint16_t id = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        
+        // Stale completions still hand back their buffer
+        if (!clients_.current(fd, generation)) {
+            if (has_buffer) {
+                recycle_buffer(id);
+            }
+            return;
+        }
+        
+        if (cqe.res > 0) {
+            handler_.on_data(fd, buffer(id), static_cast<size_t>(cqe.res));
+            recycle_buffer(id);
+            if (!more && clients_.current(fd, generation)) {
+                arm_recv(fd, generation);
+            }
+            return;
+        }
+        
+        if (has_buffer) {
+            recycle_buffer(id);
+        }
+        if (cqe.res == -ENOBUFS) {
+            // Every buffer was in flight; this batch returns them
+            arm_recv(fd, generation);
+            return;
+        }
+        
+        remove_client(fd);
+        handler_.on_closed(fd);
+    }
+    
+    int ring_fd_;
+    void* sq_ring_;
+    void* cq_ring_;
+    size_t sq_ring_size_;
+    size_t cq_ring_size_;
+    io_uring_sqe* sqes_;
+    size_t sqes_size_;
+    
+    unsigned* sq_khead_;
+    unsigned* sq_ktail_;
+    unsigned* sq_kflags_;
+    unsigned* sq_array_;
+    unsigned sq_mask_;
+    unsigned sq_entries_;
+    unsigned sq_tail_;          // Local tail, published on submit
+    
+    unsigned* cq_khead_;
+    unsigned* cq_ktail_;
+    struct io_uring_cqe* cqes_;
+    unsigned cq_mask_;
+    
+    io_uring_buf_ring* buf_ring_;
+    size_t buf_ring_size_;
+    uint16_t buf_tail_;         // Local tail, published after each reap
+    std::vector<uint8_t> buffers_;
+    
+    ClientTable clients_;
+    std::vector<int> listeners_;
+};
+
+} // namespace
+
+// =============================================================================
+// REACTOR
+// =============================================================================
+
+bool parse_reactor_backend(const std::string& text, ReactorBackend& backend) {
+    if (text == "epoll") {
+        backend = ReactorBackend::EPOLL;
+    } else if (text == "io_uring" || text == "uring") {
+        backend = ReactorBackend::IO_URING;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* reactor_backend_name(ReactorBackend backend) {
+    return backend == ReactorBackend::IO_URING ? "io_uring" : "epoll";
+}
+
+std::unique_ptr<Reactor> Reactor::create(ReactorBackend backend, ReactorHandler& handler) {
+    if (backend == ReactorBackend::IO_URING) {
+        return std::unique_ptr<Reactor>(new IoUringReactor(handler));
+    }
+    return std::unique_ptr<Reactor>(new EpollReactor(handler));
+}
+
+Reactor::Reactor(ReactorHandler& handler)
+    : handler_(handler)
+    , wake_fd_(-1)
+{}
+
+Reactor::~Reactor() {
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+    }
+}
+
+void Reactor::wake() {
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd_, &one, sizeof(one));
+    (void)written; // EAGAIN only when the counter is already pending
+}
+
+bool Reactor::open_wake_fd() {
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        std::cerr << "[Reactor] eventfd failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Reactor::drain_wake_fd() {
+    uint64_t count;
+    ssize_t got = read(wake_fd_, &count, sizeof(count));
+    (void)got;
+}
+
+} // namespace gateway
+} // namespace matching
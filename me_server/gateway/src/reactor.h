@@ -0,0 +1,94 @@
+#ifndef MATCHING_GATEWAY_REACTOR_H
+#define MATCHING_GATEWAY_REACTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace matching {
+namespace gateway {
+
+// =============================================================================
+// REACTOR BACKENDS
+// =============================================================================
+enum class ReactorBackend : uint8_t {
+    EPOLL,          // Edge-triggered epoll, recv() until EAGAIN
+    IO_URING,       // Multishot accept / recv into a provided buffer ring
+};
+
+bool parse_reactor_backend(const std::string& text, ReactorBackend& backend);
+const char* reactor_backend_name(ReactorBackend backend);
+
+// =============================================================================
+// REACTOR HANDLER
+// =============================================================================
+// Callbacks run on the thread calling Reactor::poll(). A handler that
+// drops a client calls remove_client() before closing the descriptor, and
+// the descriptor must stay open until then.
+class ReactorHandler {
+public:
+    virtual ~ReactorHandler() = default;
+    
+    // New non-blocking client socket from a listener; call add_client()
+    // to watch it, or close it
+    virtual void on_accept(int fd) = 0;
+    
+    // Bytes read from a client; the buffer is only valid during the call
+    virtual void on_data(int fd, const uint8_t* data, size_t size) = 0;
+    
+    // A client asked for with want_write() can take more bytes
+    virtual void on_writable(int fd) = 0;
+    
+    // Peer closed or the socket failed; the reactor no longer watches fd
+    // and the handler closes it
+    virtual void on_closed(int fd) = 0;
+    
+    // Another thread called wake()
+    virtual void on_wakeup() = 0;
+};
+
+// =============================================================================
+// REACTOR
+// =============================================================================
+// One event loop over listeners and client sockets. Everything except
+// wake() is called from the owning thread.
+class Reactor {
+public:
+    static std::unique_ptr<Reactor> create(ReactorBackend backend, ReactorHandler& handler);
+    
+    virtual ~Reactor();
+    
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+    
+    virtual bool open() = 0;
+    virtual bool add_listener(int fd) = 0;
+    virtual bool add_client(int fd) = 0;
+    virtual void remove_client(int fd) = 0;
+    
+    // Ask for (or stop asking for) on_writable() once fd has room again
+    virtual void want_write(int fd, bool enabled) = 0;
+    
+    // Wait up to timeout_ms (-1 = forever, 0 = just collect) and dispatch
+    virtual void poll(int timeout_ms) = 0;
+    
+    virtual const char* name() const = 0;
+    
+    // Interrupt poll() from any thread; coalesces until the next on_wakeup()
+    void wake();
+
+protected:
+    explicit Reactor(ReactorHandler& handler);
+    
+    bool open_wake_fd();
+    void drain_wake_fd();
+    
+    ReactorHandler& handler_;
+    int wake_fd_;
+};
+
+} // namespace gateway
+} // namespace matching
+
+#endif // MATCHING_GATEWAY_REACTOR_H
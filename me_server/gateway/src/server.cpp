@@ -1,22 +1,39 @@
+#include "framing.h"
+#include "reactor.h"
+#include "../../common/logger.h"
 #include "../../common/protocol.h"
+#include "../../common/protocol_v2.h"
+#include "../../common/shm_transport.h"
+#include "../../common/spsc_queue.h"
+#include <algorithm>
 #include <iostream>
 #include <vector>
-#include <map>
-#include <set>
+#include <memory>
+#include <unordered_map>
+#include <cstdlib>
 #include <cstring>
 #include <csignal>
 #include <atomic>
+#include <mutex>
 #include <thread>
 #include <chrono>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <poll.h>
+#include <pthread.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
 
 using namespace matching::protocol;
+using namespace matching::transport;
+using namespace matching::gateway;
+using namespace matching::logging;
+using matching::SpscQueue;
 
 // =============================================================================
 // GLOBAL STATE
@@ -39,9 +56,21 @@ void print_usage(const char* program) {
               << "                   (default: /tmp/matching_engine.sock)\n\n"
               << "Options:\n"
               << "  -h, --help       Show this help message\n"
-              << "  -v, --version    Show version information\n\n"
+              << "  -v, --version    Show version information\n"
+              << "  --shm NAME       Attach to the engine's shared memory rings NAME\n"
+              << "                   instead of its socket (engine started with --shm)\n"
+              << "  --wait MODE      Ring polling: adaptive (default) | busy\n"
+              << "  --reactors N     Reactor threads sharing the client sessions (default: 1)\n"
+              << "  --reactor TYPE   Reactor backend: epoll (default) | io_uring\n"
+              << "  --cancel-on-disconnect\n"
+              << "                   Mass cancel a user's resting orders once their last\n"
+              << "                   session disconnects\n"
+              << "  --log-level L    trace | info (default) | warn | error\n"
+              << "  --log-file PATH  Append the log to PATH instead of stdout\n\n"
               << "Examples:\n"
               << "  " << program << " 8080 /tmp/engine.sock\n"
+              << "  " << program << " 8080 --shm /matching_engine --wait busy\n"
+              << "  " << program << " 8080 /tmp/engine.sock --reactors 4 --reactor io_uring\n"
               << "  " << program << " 9000\n"
               << "  " << program << " --version\n"
               << std::endl;
@@ -70,20 +99,63 @@ void setup_signal_handlers() {
     signal(SIGPIPE, SIG_IGN); // Ignore broken pipe (client disconnect)
 }
 
+// Every session is a descriptor; lift the soft limit as far as allowed
+void raise_file_limit() {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+// =============================================================================
+// MESSAGE NAMES
+// =============================================================================
+
+const char* get_message_type_name(MessageType type) {
+    switch (type) {
+        case MessageType::NEW_ORDER: return "NEW_ORDER";
+        case MessageType::CANCEL_ORDER: return "CANCEL_ORDER";
+        case MessageType::REPLACE_ORDER: return "REPLACE_ORDER";
+        case MessageType::MASS_CANCEL: return "MASS_CANCEL";
+        case MessageType::ORDER_ACK: return "ORDER_ACK";
+        case MessageType::ORDER_REJECT: return "ORDER_REJECT";
+        case MessageType::ORDER_CANCELLED: return "ORDER_CANCELLED";
+        case MessageType::ORDER_REPLACED: return "ORDER_REPLACED";
+        case MessageType::MASS_CANCEL_ACK: return "MASS_CANCEL_ACK";
+        case MessageType::EXECUTION: return "EXECUTION";
+        case MessageType::TRADE: return "TRADE";
+        case MessageType::QUOTE: return "QUOTE";
+        case MessageType::HEARTBEAT: return "HEARTBEAT";
+        case MessageType::LOGON: return "LOGON";
+        default: return "UNKNOWN";
+    }
+}
+
 // =============================================================================
 // CLIENT SESSION
 // =============================================================================
+// Speaks v1 until a LOGON grants v2. A v2 session's orders are expanded to
+// v1 for the engine link, and engine output is compacted into one v2 frame
+// per flush, holding only its user's responses and its symbols' market data.
 
 class ClientSession {
 public:
-    ClientSession(int fd, const std::string& address)
+    ClientSession(int fd, const std::string& address, size_t max_frame)
         : fd_(fd)
         , address_(address)
         , connected_(true)
+        , closing_(false)
+        , write_wanted_(false)
+        , queued_(false)
         , sequence_(0)
+        , version_(PROTOCOL_VERSION)
+        , logged_on_(false)
+        , user_id_(0)
+        , reader_(max_frame)
+        , output_(MAX_PENDING)
     {
-        buffer_.resize(4096);
-        std::cout << "[Gateway] New client connected: " << address_ << " (fd=" << fd_ << ")" << std::endl;
+        MX_LOG_INFO("[Gateway] New client connected: {} (fd={})", address_.c_str(), fd_);
     }
     
     ~ClientSession() {
@@ -94,72 +166,96 @@ public:
     const std::string& get_address() const { return address_; }
     bool is_connected() const { return connected_; }
     
-    // Read message from client
-    ssize_t read_message(MessageHeader& header, std::vector<uint8_t>& message) {
-        // Read header first
-        ssize_t bytes_read = recv(fd_, &header, sizeof(header), MSG_PEEK);
-        
-        if (bytes_read <= 0) {
-            return bytes_read;
-        }
-        
-        if (bytes_read < static_cast<ssize_t>(sizeof(header))) {
-            return 0; // Not enough data yet
-        }
-        
-        // Validate header
-        if (header.version != PROTOCOL_VERSION) {
-            std::cerr << "[Gateway] Invalid protocol version from " << address_ << std::endl;
-            return -1;
-        }
-        
-        if (header.length > 4096) {
-            std::cerr << "[Gateway] Message too large from " << address_ << std::endl;
-            return -1;
+    FrameReader& reader() { return reader_; }
+    
+    // Dropped from its reactor; the descriptor closes with the session
+    bool is_closing() const { return closing_; }
+    void set_closing() { closing_ = true; }
+    
+    // Queue an engine message for the next flush(), compacted into the
+    // open frame under v2. False once the client is too far behind.
+    bool queue_message(const void* data, size_t size) {
+        if (version_ == PROTOCOL_VERSION_2) {
+            uint8_t message[V2_MAX_MESSAGE];
+            size_t length = encode_server_v2(static_cast<const MessageHeader*>(data), size,
+                                             symbols_, user_id_, message);
+            if (length == 0 || frame_->append(message, length)) {
+                return true;
+            }
+            if (!seal_frame()) {
+                return false;
+            }
+            frame_->append(message, length);
+            return true;
         }
-        
-        // Check if full message is available
-        bytes_read = recv(fd_, nullptr, 0, MSG_PEEK | MSG_TRUNC);
-        if (bytes_read < static_cast<ssize_t>(header.length)) {
-            return 0; // Wait for more data
+        return queue_raw(data, size);
+    }
+    
+    // One sendmsg() for everything queued (as far as the socket takes
+    // it); false once the session has failed
+    bool flush() {
+        if (!seal_frame()) {
+            return false;
         }
-        
-        // Read the full message
-        message.resize(header.length);
-        bytes_read = recv(fd_, message.data(), header.length, 0);
-        
-        if (bytes_read != static_cast<ssize_t>(header.length)) {
-            std::cerr << "[Gateway] Failed to read full message from " << address_ << std::endl;
-            return -1;
+        if (!connected_ || !output_.flush(fd_)) {
+            MX_LOG_WARN("[Gateway] Failed to send to {}: {}", address_.c_str(), strerror(errno));
+            return false;
         }
-        
-        // Copy header from message buffer
-        memcpy(&header, message.data(), sizeof(header));
-        
-        return bytes_read;
+        return true;
     }
     
-    // Send message to client
-    bool send_message(const void* data, size_t size) {
-        if (!connected_) {
+    bool has_pending() const { return !output_.empty() || (frame_ && !frame_->empty()); }
+    
+    // Apply a LOGON: the version granted (v2 at most) and, under v2, the
+    // session's symbol IDs. Answered with the same message in v1 framing;
+    // everything after it uses the granted version. False if the session
+    // has already logged on.
+    bool logon(const LogonMessage& request) {
+        if (logged_on_) {
             return false;
         }
+        logged_on_ = true;
+        user_id_ = request.user_id;
         
-        ssize_t sent = send(fd_, data, size, MSG_NOSIGNAL);
+        uint8_t version = request.version >= PROTOCOL_VERSION_2 ? PROTOCOL_VERSION_2 : PROTOCOL_VERSION;
+        for (uint16_t i = 0; i < request.symbol_count && version == PROTOCOL_VERSION_2; i++) {
+            if (!symbols_.add(request.symbol(i))) {
+                break;
+            }
+        }
         
-        if (sent != static_cast<ssize_t>(size)) {
-            std::cerr << "[Gateway] Failed to send to " << address_ 
-                     << ": " << strerror(errno) << std::endl;
-            disconnect();
+        LogonMessage reply;
+        reply.user_id = user_id_;
+        reply.version = version;
+        reply.symbol_count = static_cast<uint16_t>(symbols_.size());
+        if (!queue_raw(&reply, sizeof(reply))) {
             return false;
         }
         
+        if (version == PROTOCOL_VERSION_2) {
+            frame_.reset(new FrameWriterV2());
+            version_ = version;
+        }
+        MX_LOG_INFO("[Gateway] {} logged on as user {}, protocol v{} with {} symbols",
+                    address_.c_str(), user_id_, version, symbols_.size());
         return true;
     }
     
+    uint8_t version() const { return version_; }
+    uint64_t user_id() const { return user_id_; }
+    const SymbolMap& symbols() const { return symbols_; }
+    
+    // Whether the reactor has been asked for on_writable()
+    bool write_wanted() const { return write_wanted_; }
+    void set_write_wanted(bool wanted) { write_wanted_ = wanted; }
+    
+    // Whether the session is on its reactor's flush list
+    bool is_queued() const { return queued_; }
+    void set_queued(bool queued) { queued_ = queued; }
+    
     void disconnect() {
         if (connected_) {
-            std::cout << "[Gateway] Client disconnected: " << address_ << " (fd=" << fd_ << ")" << std::endl;
+            MX_LOG_INFO("[Gateway] Client disconnected: {} (fd={})", address_.c_str(), fd_);
             close(fd_);
             connected_ = false;
         }
@@ -169,12 +265,85 @@ public:
         return ++sequence_;
     }
     
+    // Users this session has sent orders for; true if user is new to it
+    bool add_user(uint64_t user_id) {
+        if (std::find(users_.begin(), users_.end(), user_id) != users_.end()) {
+            return false;
+        }
+        users_.push_back(user_id);
+        return true;
+    }
+    
+    const std::vector<uint64_t>& users() const { return users_; }
+
 private:
+    // A client this far behind the engine's output is cut off
+    static constexpr size_t MAX_PENDING = 4 * 1024 * 1024;
+    
+    bool queue_raw(const void* data, size_t size) {
+        if (!output_.append(data, size)) {
+            MX_LOG_WARN("[Gateway] Client {} is not reading, dropping it", address_.c_str());
+            return false;
+        }
+        return true;
+    }
+    
+    // Move the open v2 frame (if any) to the output
+    bool seal_frame() {
+        if (!frame_ || frame_->empty()) {
+            return true;
+        }
+        size_t length;
+        const uint8_t* frame = frame_->seal(length);
+        frame_->reset();
+        return queue_raw(frame, length);
+    }
+    
     int fd_;
     std::string address_;
     bool connected_;
+    bool closing_;
+    bool write_wanted_;
+    bool queued_;
     uint64_t sequence_;
-    std::vector<uint8_t> buffer_;
+    uint8_t version_;
+    bool logged_on_;
+    uint64_t user_id_;                      // From LOGON
+    SymbolMap symbols_;                     // v2 symbol IDs
+    FrameReader reader_;
+    SendQueue output_;
+    std::unique_ptr<FrameWriterV2> frame_;  // v2 output not yet queued
+    std::vector<uint64_t> users_;   // Only tracked for cancel-on-disconnect
+};
+
+// =============================================================================
+// USER SESSIONS
+// =============================================================================
+// Live sessions per user across every reactor, for cancel-on-disconnect:
+// a user's orders are pulled when the last session that traded for them
+// goes away. Touched once per user per session, so a mutex is enough.
+
+class UserSessions {
+public:
+    void acquire(uint64_t user_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        counts_[user_id]++;
+    }
+    
+    // True if that was the user's last session
+    bool release(uint64_t user_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = counts_.find(user_id);
+        if (it == counts_.end() || --it->second > 0) {
+            return false;
+        }
+        counts_.erase(it);
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<uint64_t, uint32_t> counts_;
 };
 
 // =============================================================================
@@ -183,10 +352,14 @@ private:
 
 class EngineConnection {
 public:
-    EngineConnection(const std::string& socket_path)
+    EngineConnection(const std::string& socket_path, const std::string& shm_name, WaitMode wait_mode)
         : socket_path_(socket_path)
+        , shm_name_(shm_name)
+        , wait_mode_(wait_mode)
         , fd_(-1)
         , connected_(false)
+        , reader_(MAX_MESSAGE_SIZE, READ_BUFFER_SIZE)
+        , output_(SIZE_MAX)
     {}
     
     ~EngineConnection() {
@@ -194,6 +367,16 @@ public:
     }
     
     bool connect() {
+        if (uses_shm()) {
+            if (!channel_.attach(shm_name_)) {
+                return false;
+            }
+            connected_ = true;
+            std::cout << "[Gateway] Attached to engine rings " << shm_name_ << " ("
+                      << (wait_mode_ == WaitMode::BUSY_POLL ? "busy-poll" : "adaptive") << ")" << std::endl;
+            return true;
+        }
+        
         fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
         if (fd_ < 0) {
             std::cerr << "[Gateway] Failed to create socket: " << strerror(errno) << std::endl;
@@ -212,6 +395,10 @@ public:
             return false;
         }
         
+        // The link thread never blocks on the engine: a full socket in both
+        // directions would otherwise deadlock the two processes
+        fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) | O_NONBLOCK);
+        
         connected_ = true;
         std::cout << "[Gateway] Connected to engine at " << socket_path_ << std::endl;
         return true;
@@ -222,6 +409,7 @@ public:
             close(fd_);
             fd_ = -1;
         }
+        channel_.close();
         connected_ = false;
     }
     
@@ -233,78 +421,208 @@ public:
         return fd_;
     }
     
-    bool send_message(const void* data, size_t size) {
-        if (!connected_) {
-            return false;
-        }
-        
-        ssize_t sent = send(fd_, data, size, 0);
-        
-        if (sent != static_cast<ssize_t>(size)) {
+    // Shared memory mode has no descriptor to poll; poll front()
+    bool uses_shm() const {
+        return !shm_name_.empty();
+    }
+    
+    // Socket mode: queued for the next flush()
+    void queue_message(const void* data, size_t size) {
+        output_.append(data, size);
+    }
+    
+    // Socket mode: one sendmsg() for everything queued, as far as the
+    // socket takes it
+    bool flush() {
+        if (!connected_ || !output_.flush(fd_)) {
             std::cerr << "[Gateway] Failed to send to engine: " << strerror(errno) << std::endl;
             disconnect();
             return false;
         }
-        
         return true;
     }
     
-    ssize_t read_message(MessageHeader& header, std::vector<uint8_t>& message) {
-        // Read header
-        ssize_t bytes_read = recv(fd_, &header, sizeof(header), MSG_PEEK);
-        
-        if (bytes_read <= 0) {
-            return bytes_read;
-        }
-        
-        if (bytes_read < static_cast<ssize_t>(sizeof(header))) {
-            return 0; // Not enough data yet
-        }
-        
-        // Read full message
-        message.resize(header.length);
-        bytes_read = recv(fd_, message.data(), header.length, 0);
-        
-        if (bytes_read != static_cast<ssize_t>(header.length)) {
-            return -1;
+    bool has_pending() const { return !output_.empty(); }
+    size_t pending_bytes() const { return output_.size(); }
+    
+    // Socket mode: read straight into the frame buffer and hand over each
+    // complete message in place; false once the engine has gone away
+    template <typename OnMessage>
+    bool read_messages(OnMessage&& on_message) {
+        while (true) {
+            ssize_t bytes_read = recv(fd_, reader_.space(), reader_.room(), 0);
+            if (bytes_read < 0 && errno == EINTR) {
+                continue;
+            }
+            if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return true;
+            }
+            if (bytes_read <= 0) {
+                return false;
+            }
+            
+            if (const char* error = reader_.commit(static_cast<size_t>(bytes_read), on_message)) {
+                std::cerr << "[Gateway] " << error << " from engine" << std::endl;
+                return false;
+            }
         }
-        
-        memcpy(&header, message.data(), sizeof(header));
-        return bytes_read;
     }
     
+    // Shared memory mode: false if the ring to the engine is full
+    bool try_send(const void* data, size_t size) {
+        return connected_ && channel_.outbound().try_write(data, size);
+    }
+    
+    // Shared memory mode: next engine message in place (nullptr if none),
+    // released with pop()
+    const MessageHeader* front() {
+        return channel_.inbound().front();
+    }
+    
+    void pop() {
+        channel_.inbound().pop();
+    }
+    
+    // Shared memory mode: false once the engine has detached or died
+    bool engine_alive() const {
+        return channel_.peer_alive();
+    }
+    
+    static constexpr uint32_t PEER_CHECK_MASK = 1023;
+    static constexpr size_t MAX_MESSAGE_SIZE = 4096;
+    static constexpr size_t READ_BUFFER_SIZE = 64 * 1024;
+
 private:
     std::string socket_path_;
+    std::string shm_name_;
+    WaitMode wait_mode_;
     int fd_;
     bool connected_;
+    ShmChannel channel_;
+    FrameReader reader_;
+    SendQueue output_;
 };
 
 // =============================================================================
-// GATEWAY SERVER
+// LINK QUEUES
 // =============================================================================
+// One protocol message per slot between a reactor thread and the engine
+// link thread (data first, so the message keeps the slot's alignment)
 
-class GatewayServer {
+struct alignas(64) LinkMessage {
+    uint8_t data[120];
+    uint32_t size;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(LinkMessage) == 128, "LinkMessage must be two cache lines");
+static_assert(sizeof(NewOrderMessage) <= sizeof(LinkMessage::data), "NewOrderMessage must fit a slot");
+static_assert(sizeof(MassCancelMessage) <= sizeof(LinkMessage::data), "MassCancelMessage must fit a slot");
+static_assert(sizeof(OrderRejectMessage) <= sizeof(LinkMessage::data), "OrderRejectMessage must fit a slot");
+static_assert(sizeof(ExecutionMessage) <= sizeof(LinkMessage::data), "ExecutionMessage must fit a slot");
+
+constexpr uint32_t LINK_QUEUE_CAPACITY = 1u << 14;
+
+// Sleep / wake handshake for a thread that blocks when it has nothing to
+// do: it raises sleeping, re-checks its queues and only then blocks; a
+// producer publishes first and then wakes it only if sleeping is up. The
+// seq_cst fences on both sides keep a wakeup from being lost in between.
+class Doorbell {
 public:
-    GatewayServer(int port, const std::string& engine_socket)
-        : port_(port)
-        , engine_socket_path_(engine_socket)
+    Doorbell() : sleeping_(false) {}
+    
+    // Waiter: call before the final queue check
+    void begin_sleep() {
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+    
+    void end_sleep() {
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+    
+    // Producer: call after publishing; true if the waiter must be woken
+    bool needs_wake() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return sleeping_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<bool> sleeping_;
+};
+
+// The engine link's doorbell: reactor threads ring it after queueing
+// client messages
+class LinkDoorbell : public Doorbell {
+public:
+    LinkDoorbell() : fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {}
+    
+    ~LinkDoorbell() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+    
+    int get_fd() const { return fd_; }
+    
+    void ring() {
+        if (needs_wake()) {
+            uint64_t one = 1;
+            ssize_t written = write(fd_, &one, sizeof(one));
+            (void)written;
+        }
+    }
+    
+    void drain() {
+        uint64_t count;
+        ssize_t got = read(fd_, &count, sizeof(count));
+        (void)got;
+    }
+
+private:
+    int fd_;
+};
+
+// =============================================================================
+// REACTOR THREAD
+// =============================================================================
+// Owns a share of the client sessions: its own SO_REUSEPORT listener (the
+// kernel spreads new connections over the reactors), its own reactor, and
+// a queue pair to the engine link. Client messages go to the link through
+// to_engine; engine messages arrive on from_engine and are sent to every
+// local session. Sessions are only destroyed between reactor rounds, so a
+// descriptor is never reused while events for it may still be queued.
+// With cancel-on-disconnect (users set), a session that closes while the
+// gateway runs releases its users, and the reactor sends the engine a
+// MASS_CANCEL for each one it was the last session of.
+
+class ReactorThread : public ReactorHandler {
+public:
+    ReactorThread(uint32_t index, int port, ReactorBackend backend, WaitMode wait_mode,
+                  LinkDoorbell& link, std::atomic<size_t>& total_clients, UserSessions* users)
+        : index_(index)
+        , port_(port)
+        , backend_(backend)
+        , wait_mode_(wait_mode)
         , listen_fd_(-1)
-        , engine_(engine_socket)
+        , link_(link)
+        , link_pending_(false)
+        , total_clients_(total_clients)
+        , users_(users)
+        , to_engine_(LINK_QUEUE_CAPACITY)
+        , from_engine_(LINK_QUEUE_CAPACITY)
     {}
     
-    ~GatewayServer() {
-        stop();
+    ~ReactorThread() override {
+        join();
+        sessions_.clear();
+        if (listen_fd_ >= 0) {
+            close(listen_fd_);
+        }
     }
     
     bool start() {
-        // Connect to engine first
-        if (!engine_.connect()) {
-            std::cerr << "[Gateway] Failed to connect to engine" << std::endl;
-            return false;
-        }
-        
-        // Create TCP listening socket
-        listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
         if (listen_fd_ < 0) {
             std::cerr << "[Gateway] Failed to create socket: " << strerror(errno) << std::endl;
             return false;
@@ -315,6 +633,10 @@ public:
         if (setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
             std::cerr << "[Gateway] Failed to set SO_REUSEADDR: " << strerror(errno) << std::endl;
         }
+        if (setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+            std::cerr << "[Gateway] Failed to set SO_REUSEPORT: " << strerror(errno) << std::endl;
+            return false;
+        }
         
         // Bind
         struct sockaddr_in addr;
@@ -324,205 +646,654 @@ public:
         addr.sin_port = htons(port_);
         
         if (bind(listen_fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-            std::cerr << "[Gateway] Failed to bind to port " << port_ 
+            std::cerr << "[Gateway] Failed to bind to port " << port_
                      << ": " << strerror(errno) << std::endl;
-            close(listen_fd_);
             return false;
         }
         
         // Listen
-        if (listen(listen_fd_, 128) < 0) {
+        if (listen(listen_fd_, SOMAXCONN) < 0) {
             std::cerr << "[Gateway] Failed to listen: " << strerror(errno) << std::endl;
-            close(listen_fd_);
             return false;
         }
         
-        std::cout << "[Gateway] Listening on port " << port_ << std::endl;
-        return true;
+        reactor_ = Reactor::create(backend_, *this);
+        return reactor_->open() && reactor_->add_listener(listen_fd_);
+    }
+    
+    void launch() {
+        thread_ = std::thread([this]() { run(); });
+    }
+    
+    void join() {
+        if (thread_.joinable()) {
+            reactor_->wake();
+            thread_.join();
+        }
+    }
+    
+    SpscQueue<LinkMessage>& to_engine() { return to_engine_; }
+    SpscQueue<LinkMessage>& from_engine() { return from_engine_; }
+    
+    // Link thread: messages were published to from_engine
+    void notify() {
+        if (doorbell_.needs_wake()) {
+            reactor_->wake();
+        }
+    }
+    
+    // Link thread: from_engine is full, so wake regardless
+    void wake() {
+        reactor_->wake();
+    }
+    
+    // -------------------------------------------------------------------------
+    // REACTOR EVENTS
+    // -------------------------------------------------------------------------
+    
+    void on_accept(int fd) override {
+        struct sockaddr_in client_addr;
+        socklen_t addr_len = sizeof(client_addr);
+        memset(&client_addr, 0, sizeof(client_addr));
+        getpeername(fd, (struct sockaddr*)&client_addr, &addr_len);
+        
+        // Get client address
+        char addr_str[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &client_addr.sin_addr, addr_str, sizeof(addr_str));
+        std::string address = std::string(addr_str) + ":" + std::to_string(ntohs(client_addr.sin_port));
+        
+        // Create session
+        // Sized for the largest LOGON; v2 frames are held to V2_MAX_FRAME
+        // when they arrive
+        auto session = std::make_unique<ClientSession>(fd, address, std::max(V2_MAX_FRAME, MAX_LOGON_LENGTH));
+        if (!reactor_->add_client(fd)) {
+            return; // Session closes the descriptor
+        }
+        sessions_[fd] = std::move(session);
+        
+        MX_LOG_INFO("[Gateway] Total clients: {}", ++total_clients_);
+    }
+    
+    void on_data(int fd, const uint8_t* data, size_t size) override {
+        ClientSession* client = find_session(fd);
+        if (!client) {
+            return;
+        }
+        
+        // Every whole v1 message in this read is forwarded from where it
+        // lies; v2 frames are expanded message by message
+        const char* error = client->reader().consume(data, size, [&](const MessageHeader* message, size_t length) {
+            if (client->is_closing()) {
+                return;
+            }
+            if (message->version == PROTOCOL_VERSION_2) {
+                on_frame_v2(*client, reinterpret_cast<const uint8_t*>(message), length);
+                return;
+            }
+            
+            MX_LOG_TRACE("[Gateway] Received {} from {}", get_message_type_name(message->get_type()),
+                         client->get_address().c_str());
+            
+            if (message->get_type() == MessageType::LOGON) {
+                on_logon(*client, message, length);
+            } else if (length > sizeof(LinkMessage::data)) {
+                reject(*client, "Message too long");
+            } else {
+                forward_from(*client, message, length);
+            }
+        });
+        
+        if (error) {
+            MX_LOG_WARN("[Gateway] {} from {}", error, client->get_address().c_str());
+            drop(*client);
+        }
+    }
+    
+    void on_writable(int fd) override {
+        ClientSession* client = find_session(fd);
+        if (!client) {
+            return;
+        }
+        
+        if (!client->flush()) {
+            drop(*client);
+        } else if (!client->has_pending()) {
+            client->set_write_wanted(false);
+            reactor_->want_write(fd, false);
+        }
+    }
+    
+    void on_closed(int fd) override {
+        // The reactor has already let go of fd
+        if (ClientSession* client = find_session(fd)) {
+            client->set_closing();
+            closing_.push_back(fd);
+        }
+    }
+    
+    void on_wakeup() override {
+        // The loop drains from_engine after every poll
+    }
+
+private:
+    // -------------------------------------------------------------------------
+    // CLIENT MESSAGES
+    // -------------------------------------------------------------------------
+    
+    void forward_from(ClientSession& client, const MessageHeader* message, size_t length) {
+        if (users_ && message->get_type() == MessageType::NEW_ORDER && length >= sizeof(NewOrderMessage)) {
+            track_user(client, reinterpret_cast<const NewOrderMessage*>(message)->user_id);
+        }
+        forward_to_link(message, length);
+    }
+    
+    void track_user(ClientSession& client, uint64_t user_id) {
+        if (user_id != 0 && client.add_user(user_id)) {
+            users_->acquire(user_id);
+        }
+    }
+    
+    void on_logon(ClientSession& client, const MessageHeader* message, size_t length) {
+        const LogonMessage* logon = reinterpret_cast<const LogonMessage*>(message);
+        if (length < sizeof(LogonMessage) || length != LogonMessage::size_for(logon->symbol_count)) {
+            reject(client, "Malformed LOGON");
+            return;
+        }
+        if (!client.logon(*logon)) {
+            reject(client, "Repeated LOGON");
+            return;
+        }
+        if (users_) {
+            track_user(client, logon->user_id);
+        }
+        schedule_flush(client);
+    }
+    
+    void on_frame_v2(ClientSession& client, const uint8_t* frame, size_t length) {
+        if (client.version() != PROTOCOL_VERSION_2) {
+            reject(client, "Protocol v2 frame without a v2 LOGON");
+            return;
+        }
+        if (length > V2_MAX_FRAME) {
+            reject(client, "v2 frame too long");
+            return;
+        }
+        
+        const char* error = nullptr;
+        bool whole = for_each_message_v2(frame, length, [&](const SubHeaderV2* message) {
+            if (error) {
+                return;
+            }
+            alignas(8) uint8_t expanded[sizeof(LinkMessage::data)];
+            size_t size = decode_client_v2(message, client.symbols(), client.user_id(), expanded, error);
+            if (size) {
+                MX_LOG_TRACE("[Gateway] Received {} (v2) from {}", get_message_type_name(message->get_type()),
+                             client.get_address().c_str());
+                forward_to_link(reinterpret_cast<const MessageHeader*>(expanded), size);
+            }
+        });
+        if (!whole && !error) {
+            error = "Malformed v2 frame";
+        }
+        if (error) {
+            reject(client, error);
+        }
+    }
+    
+    // The stream cannot be trusted past a protocol error
+    void reject(ClientSession& client, const char* error) {
+        MX_LOG_WARN("[Gateway] {} from {}", error, client.get_address().c_str());
+        drop(client);
+    }
+    
+    void schedule_flush(ClientSession& client) {
+        if (!client.is_queued() && client.has_pending()) {
+            client.set_queued(true);
+            flush_list_.push_back(client.get_fd());
+        }
     }
     
     void run() {
-        std::cout << "[Gateway] Server started, waiting for connections..." << std::endl;
+        std::cout << "[Gateway] Reactor " << index_ << " (" << reactor_->name() << ") running" << std::endl;
         
         while (g_running) {
-            fd_set read_fds;
-            FD_ZERO(&read_fds);
+            drain_engine_queue();
+            flush_sessions();
+            reap_closed();
             
-            // Add listen socket
-            FD_SET(listen_fd_, &read_fds);
-            int max_fd = listen_fd_;
+            if (link_pending_) {
+                link_.ring();
+                link_pending_ = false;
+            }
             
-            // Add engine socket
-            if (engine_.is_connected()) {
-                FD_SET(engine_.get_fd(), &read_fds);
-                max_fd = std::max(max_fd, engine_.get_fd());
+            // Busy-poll mode never blocks; otherwise block until a client
+            // or the link (through the doorbell) has something for us
+            int timeout_ms = 0;
+            if (wait_mode_ != WaitMode::BUSY_POLL) {
+                doorbell_.begin_sleep();
+                timeout_ms = from_engine_.empty() && g_running ? 1000 : 0;
+            }
+            reactor_->poll(timeout_ms);
+            doorbell_.end_sleep();
+        }
+        
+        for (auto& pair : sessions_) {
+            if (!pair.second->is_closing()) {
+                reactor_->remove_client(pair.first);
+            }
+        }
+        sessions_.clear();
+    }
+    
+    ClientSession* find_session(int fd) {
+        auto it = sessions_.find(fd);
+        if (it == sessions_.end() || it->second->is_closing()) {
+            return nullptr;
+        }
+        return it->second.get();
+    }
+    
+    // Stop watching now, destroy (and close) after this round
+    void drop(ClientSession& client) {
+        if (client.is_closing()) {
+            return;
+        }
+        client.set_closing();
+        reactor_->remove_client(client.get_fd());
+        closing_.push_back(client.get_fd());
+    }
+    
+    void reap_closed() {
+        for (int fd : closing_) {
+            auto it = sessions_.find(fd);
+            if (it == sessions_.end()) {
+                continue;
+            }
+            if (users_) {
+                release_users(*it->second);
+            }
+            sessions_.erase(it);
+            --total_clients_;
+        }
+        closing_.clear();
+    }
+    
+    void release_users(const ClientSession& client) {
+        for (uint64_t user_id : client.users()) {
+            if (!users_->release(user_id)) {
+                continue;
             }
             
-            // Add client sockets
-            for (auto& pair : clients_) {
-                ClientSession* client = pair.second.get();
-                if (client->is_connected()) {
-                    FD_SET(client->get_fd(), &read_fds);
-                    max_fd = std::max(max_fd, client->get_fd());
+            MX_LOG_INFO("[Gateway] Last session of user {} closed, cancelling its orders", user_id);
+            MassCancelMessage msg;
+            msg.user_id = user_id;
+            msg.timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+            forward_to_link(&msg.header, sizeof(msg));
+        }
+    }
+    
+    void forward_to_link(const MessageHeader* message, size_t length) {
+        LinkMessage* slot = to_engine_.try_claim();
+        if (!slot) {
+            // Keep feeding our clients while the link catches up: it may be
+            // waiting for room in our from_engine queue
+            link_.ring();
+            Backoff full(wait_mode_);
+            while (!(slot = to_engine_.try_claim())) {
+                if (!g_running) {
+                    return;
+                }
+                if (drain_engine_queue()) {
+                    flush_sessions();
+                    full.reset();
+                } else {
+                    full.idle();
                 }
             }
-            
-            // Wait for activity (1 second timeout)
-            struct timeval timeout;
-            timeout.tv_sec = 1;
-            timeout.tv_usec = 0;
-            
-            int activity = select(max_fd + 1, &read_fds, nullptr, nullptr, &timeout);
-            
-            if (activity < 0 && errno != EINTR) {
-                std::cerr << "[Gateway] Select error: " << strerror(errno) << std::endl;
-                break;
+        }
+        
+        memcpy(slot->data, message, length);
+        slot->size = static_cast<uint32_t>(length);
+        to_engine_.publish();
+        link_pending_ = true;
+    }
+    
+    bool drain_engine_queue() {
+        bool drained = false;
+        while (LinkMessage* slot = from_engine_.front()) {
+            broadcast(slot->data, slot->size);
+            from_engine_.pop();
+            drained = true;
+        }
+        return drained;
+    }
+    
+    // Queue for every client; the bytes go out in flush_sessions()
+    void broadcast(const uint8_t* data, size_t size) {
+        // Broadcast to all clients (in real system, route by user_id)
+        const MessageHeader* header = reinterpret_cast<const MessageHeader*>(data);
+        
+        MX_LOG_TRACE("[Gateway] Broadcasting {} to {} clients", get_message_type_name(header->get_type()),
+                     sessions_.size());
+        
+        for (auto& pair : sessions_) {
+            ClientSession* client = pair.second.get();
+            if (client->is_closing()) {
+                continue;
             }
             
-            if (activity <= 0) {
-                continue; // Timeout or interrupt
+            if (!client->queue_message(data, size)) {
+                drop(*client);
+            } else {
+                schedule_flush(*client);
             }
-            
-            // Check for new connection
-            if (FD_ISSET(listen_fd_, &read_fds)) {
-                accept_client();
+        }
+    }
+    
+    // One sendmsg() per client with queued output. A client whose socket
+    // is full waits for on_writable() instead.
+    void flush_sessions() {
+        for (int fd : flush_list_) {
+            ClientSession* client = find_session(fd);
+            if (!client) {
+                continue;
+            }
+            client->set_queued(false);
+            if (client->write_wanted()) {
+                continue;
             }
             
-            // Check for engine messages
-            if (engine_.is_connected() && FD_ISSET(engine_.get_fd(), &read_fds)) {
-                handle_engine_message();
+            if (!client->flush()) {
+                drop(*client);
+            } else if (client->has_pending()) {
+                client->set_write_wanted(true);
+                reactor_->want_write(fd, true);
+            }
+        }
+        flush_list_.clear();
+    }
+    
+    uint32_t index_;
+    int port_;
+    ReactorBackend backend_;
+    WaitMode wait_mode_;
+    int listen_fd_;
+    LinkDoorbell& link_;
+    bool link_pending_;
+    std::atomic<size_t>& total_clients_;
+    UserSessions* users_;                   // nullptr = no cancel-on-disconnect
+    Doorbell doorbell_;
+    SpscQueue<LinkMessage> to_engine_;      // Reactor -> link
+    SpscQueue<LinkMessage> from_engine_;    // Link -> reactor
+    std::unique_ptr<Reactor> reactor_;
+    std::unordered_map<int, std::unique_ptr<ClientSession>> sessions_;
+    std::vector<int> closing_;
+    std::vector<int> flush_list_;
+    std::thread thread_;
+};
+
+// =============================================================================
+// GATEWAY SERVER
+// =============================================================================
+// The calling thread is the single engine link: it forwards every
+// reactor's client messages to the engine and fans each engine message
+// out to every reactor.
+
+class GatewayServer {
+public:
+    GatewayServer(int port, const std::string& engine_socket, const std::string& engine_shm,
+                  WaitMode wait_mode, uint32_t reactor_count, ReactorBackend backend,
+                  bool cancel_on_disconnect)
+        : port_(port)
+        , engine_socket_path_(engine_socket)
+        , wait_mode_(wait_mode)
+        , reactor_count_(reactor_count ? reactor_count : 1)
+        , backend_(backend)
+        , engine_(engine_socket, engine_shm, wait_mode)
+        , engine_idle_(wait_mode)
+        , reactors_pending_(false)
+        , total_clients_(0)
+        , cancel_on_disconnect_(cancel_on_disconnect)
+    {}
+    
+    ~GatewayServer() {
+        stop();
+    }
+    
+    bool start() {
+        // Connect to engine first
+        if (!engine_.connect()) {
+            std::cerr << "[Gateway] Failed to connect to engine" << std::endl;
+            return false;
+        }
+        
+        for (uint32_t i = 0; i < reactor_count_; i++) {
+            reactors_.emplace_back(new ReactorThread(i, port_, backend_, wait_mode_, link_, total_clients_,
+                                                    cancel_on_disconnect_ ? &user_sessions_ : nullptr));
+            if (!reactors_.back()->start()) {
+                return false;
+            }
+        }
+        
+        std::cout << "[Gateway] Listening on port " << port_ << " (" << reactor_count_ << " "
+                  << reactor_backend_name(backend_) << " reactor" << (reactor_count_ > 1 ? "s" : "") << ")" << std::endl;
+        return true;
+    }
+    
+    void run() {
+        // Signals are taken by this thread, so its poll() sees them
+        sigset_t signals, previous;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, &previous);
+        for (auto& reactor : reactors_) {
+            reactor->launch();
+        }
+        pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+        
+        std::cout << "[Gateway] Server started, waiting for connections..." << std::endl;
+        
+        while (g_running) {
+            bool progressed = false;
+            if (engine_.uses_shm()) {
+                progressed |= drain_engine_ring();
             }
+            progressed |= forward_client_messages();
+            if (engine_.has_pending() && !engine_.flush()) {
+                lost_engine();
+                break;
+            }
+            notify_reactors();
             
-            // Check client sockets
-            std::vector<int> to_remove;
-            for (auto& pair : clients_) {
-                int fd = pair.first;
-                ClientSession* client = pair.second.get();
-                
-                if (client->is_connected() && FD_ISSET(fd, &read_fds)) {
-                    if (!handle_client_message(client)) {
-                        to_remove.push_back(fd);
-                    }
+            if (engine_.uses_shm()) {
+                if (progressed) {
+                    engine_idle_.reset();
+                } else if ((engine_idle_.idle() & EngineConnection::PEER_CHECK_MASK) == 0 &&
+                           !engine_.engine_alive()) {
+                    lost_engine();
                 }
+                continue;
             }
             
-            // Remove disconnected clients
-            for (int fd : to_remove) {
-                clients_.erase(fd);
-            }
+            poll_engine_socket(progressed);
         }
+        
+        stop_reactors();
     }
     
     void stop() {
         std::cout << "[Gateway] Stopping server..." << std::endl;
         
-        clients_.clear();
+        stop_reactors();
+        reactors_.clear();
         engine_.disconnect();
-        
-        if (listen_fd_ >= 0) {
-            close(listen_fd_);
-            listen_fd_ = -1;
-        }
     }
-    
+
 private:
-    void accept_client() {
-        struct sockaddr_in client_addr;
-        socklen_t addr_len = sizeof(client_addr);
-        
-        int client_fd = accept(listen_fd_, (struct sockaddr*)&client_addr, &addr_len);
-        if (client_fd < 0) {
-            std::cerr << "[Gateway] Failed to accept client: " << strerror(errno) << std::endl;
-            return;
+    // Bytes queued toward a slow engine before client queues are left to
+    // back up instead
+    static constexpr size_t ENGINE_PENDING_LIMIT = 1024 * 1024;
+    static constexpr uint32_t FORWARD_BATCH = 64;
+    
+    void lost_engine() {
+        std::cerr << "[Gateway] Lost connection to engine" << std::endl;
+        g_running = false;
+    }
+    
+    void stop_reactors() {
+        g_running = false;
+        for (auto& reactor : reactors_) {
+            reactor->join();
         }
-        
-        // Get client address
-        char addr_str[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &client_addr.sin_addr, addr_str, sizeof(addr_str));
-        std::string address = std::string(addr_str) + ":" + std::to_string(ntohs(client_addr.sin_port));
-        
-        // Create session
-        auto session = std::make_unique<ClientSession>(client_fd, address);
-        clients_[client_fd] = std::move(session);
-        
-        std::cout << "[Gateway] Total clients: " << clients_.size() << std::endl;
     }
     
-    bool handle_client_message(ClientSession* client) {
-        MessageHeader header;
-        std::vector<uint8_t> message;
+    void poll_engine_socket(bool progressed) {
+        // Sleep only when a last look at every client queue is empty
+        int timeout_ms = 0;
+        if (!progressed) {
+            link_.begin_sleep();
+            timeout_ms = 1000;
+            for (auto& reactor : reactors_) {
+                if (!reactor->to_engine().empty()) {
+                    timeout_ms = 0;
+                }
+            }
+        }
         
-        ssize_t result = client->read_message(header, message);
+        struct pollfd fds[2];
+        fds[0].fd = engine_.get_fd();
+        fds[0].events = POLLIN | (engine_.has_pending() ? POLLOUT : 0);
+        fds[0].revents = 0;
+        fds[1].fd = link_.get_fd();
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
         
-        if (result < 0) {
-            // Error or disconnect
-            return false;
-        }
+        int activity = ::poll(fds, 2, timeout_ms);
+        link_.end_sleep();
         
-        if (result == 0) {
-            // No complete message yet
-            return true;
+        if (activity < 0) {
+            if (errno != EINTR) {
+                std::cerr << "[Gateway] Poll error: " << strerror(errno) << std::endl;
+                g_running = false;
+            }
+            return;
         }
         
-        // Log message
-        std::cout << "[Gateway] Received " << get_message_type_name(header.get_type()) 
-                 << " from " << client->get_address() << std::endl;
+        if (fds[1].revents & POLLIN) {
+            link_.drain();
+        }
         
-        // Forward to engine
-        if (!engine_.send_message(message.data(), message.size())) {
-            std::cerr << "[Gateway] Failed to forward message to engine" << std::endl;
-            return false;
+        if ((fds[0].revents & POLLOUT) && !engine_.flush()) {
+            lost_engine();
+            return;
         }
         
-        return true;
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            bool alive = engine_.read_messages([&](const MessageHeader* message, size_t length) {
+                broadcast(*message, reinterpret_cast<const uint8_t*>(message), length);
+            });
+            notify_reactors();
+            if (!alive) {
+                lost_engine();
+            }
+        }
     }
     
-    void handle_engine_message() {
-        MessageHeader header;
-        std::vector<uint8_t> message;
-        
-        ssize_t result = engine_.read_message(header, message);
-        
-        if (result <= 0) {
-            std::cerr << "[Gateway] Lost connection to engine" << std::endl;
-            g_running = false;
+    bool forward_client_messages() {
+        bool forwarded = false;
+        for (auto& reactor : reactors_) {
+            SpscQueue<LinkMessage>& queue = reactor->to_engine();
+            for (uint32_t n = 0; n < FORWARD_BATCH; n++) {
+                if (!engine_.uses_shm() && engine_.pending_bytes() > ENGINE_PENDING_LIMIT) {
+                    return forwarded;
+                }
+                
+                LinkMessage* slot = queue.front();
+                if (!slot) {
+                    break;
+                }
+                
+                if (engine_.uses_shm()) {
+                    // Ring full: leave it queued and drain the engine first
+                    if (!engine_.try_send(slot->data, slot->size)) {
+                        return forwarded;
+                    }
+                } else {
+                    engine_.queue_message(slot->data, slot->size);
+                }
+                
+                queue.pop();
+                forwarded = true;
+            }
+        }
+        return forwarded;
+    }
+    
+    // Forward everything waiting in the engine ring, straight from the ring
+    bool drain_engine_ring() {
+        bool drained = false;
+        while (const MessageHeader* header = engine_.front()) {
+            broadcast(*header, reinterpret_cast<const uint8_t*>(header), header->length);
+            engine_.pop();
+            drained = true;
+        }
+        return drained;
+    }
+    
+    void broadcast(const MessageHeader& header, const uint8_t* data, size_t size) {
+        if (size > sizeof(LinkMessage::data)) {
+            MX_LOG_WARN("[Gateway] Dropping oversized {} from engine ({} bytes)",
+                        get_message_type_name(header.get_type()), size);
             return;
         }
         
-        // Broadcast to all clients (in real system, route by user_id)
-        MessageType msg_type = header.get_type();
-        
-        std::cout << "[Gateway] Broadcasting " << get_message_type_name(msg_type) 
-                 << " to " << clients_.size() << " clients" << std::endl;
-        
-        for (auto& pair : clients_) {
-            ClientSession* client = pair.second.get();
-            if (client->is_connected()) {
-                client->send_message(message.data(), message.size());
+        for (auto& reactor : reactors_) {
+            SpscQueue<LinkMessage>& queue = reactor->from_engine();
+            LinkMessage* slot = queue.try_claim();
+            if (!slot) {
+                // Reactors never block on us while their from_engine queue
+                // is non-empty, so waiting here always ends
+                reactor->wake();
+                Backoff full(wait_mode_);
+                while (!(slot = queue.try_claim())) {
+                    if (!g_running) {
+                        return;
+                    }
+                    full.idle();
+                }
             }
+            
+            memcpy(slot->data, data, size);
+            slot->size = static_cast<uint32_t>(size);
+            queue.publish();
         }
+        reactors_pending_ = true;
     }
     
-    const char* get_message_type_name(MessageType type) {
-        switch (type) {
-            case MessageType::NEW_ORDER: return "NEW_ORDER";
-            case MessageType::CANCEL_ORDER: return "CANCEL_ORDER";
-            case MessageType::ORDER_ACK: return "ORDER_ACK";
-            case MessageType::ORDER_REJECT: return "ORDER_REJECT";
-            case MessageType::ORDER_CANCELLED: return "ORDER_CANCELLED";
-            case MessageType::EXECUTION: return "EXECUTION";
-            case MessageType::TRADE: return "TRADE";
-            case MessageType::QUOTE: return "QUOTE";
-            case MessageType::HEARTBEAT: return "HEARTBEAT";
-            default: return "UNKNOWN";
+    void notify_reactors() {
+        if (reactors_pending_) {
+            for (auto& reactor : reactors_) {
+                reactor->notify();
+            }
+            reactors_pending_ = false;
         }
     }
     
     int port_;
     std::string engine_socket_path_;
-    int listen_fd_;
+    WaitMode wait_mode_;
+    uint32_t reactor_count_;
+    ReactorBackend backend_;
     EngineConnection engine_;
-    std::map<int, std::unique_ptr<ClientSession>> clients_;
+    Backoff engine_idle_;
+    LinkDoorbell link_;
+    bool reactors_pending_;
+    std::atomic<size_t> total_clients_;
+    bool cancel_on_disconnect_;
+    UserSessions user_sessions_;
+    std::vector<std::unique_ptr<ReactorThread>> reactors_;
 };
 
 // =============================================================================
@@ -533,9 +1304,16 @@ int main(int argc, char* argv[]) {
     // Parse command line arguments
     int port = 8080;
     std::string engine_socket = "/tmp/matching_engine.sock";
+    std::string engine_shm;
+    WaitMode wait_mode = WaitMode::ADAPTIVE;
+    uint32_t reactor_count = 1;
+    ReactorBackend backend = ReactorBackend::EPOLL;
+    bool cancel_on_disconnect = false;
+    LogConfig logging;
     
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
         
         if (arg == "--help" || arg == "-h") {
             print_usage(argv[0]);
@@ -547,6 +1325,54 @@ int main(int argc, char* argv[]) {
             return 0;
         }
         
+        if (arg == "--shm" && has_value) {
+            engine_shm = argv[++i];
+            continue;
+        }
+        
+        if (arg == "--wait" && has_value) {
+            if (!parse_wait_mode(argv[++i], wait_mode)) {
+                std::cerr << "Unknown wait mode: " << argv[i] << std::endl;
+                return 1;
+            }
+            continue;
+        }
+        
+        if (arg == "--reactors" && has_value) {
+            reactor_count = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            if (reactor_count == 0) {
+                std::cerr << "--reactors needs at least 1" << std::endl;
+                return 1;
+            }
+            continue;
+        }
+        
+        if (arg == "--reactor" && has_value) {
+            if (!parse_reactor_backend(argv[++i], backend)) {
+                std::cerr << "Unknown reactor backend: " << argv[i] << std::endl;
+                return 1;
+            }
+            continue;
+        }
+        
+        if (arg == "--cancel-on-disconnect") {
+            cancel_on_disconnect = true;
+            continue;
+        }
+        
+        if (arg == "--log-level" && has_value) {
+            if (!parse_log_level(argv[++i], logging.level)) {
+                std::cerr << "Unknown log level: " << argv[i] << std::endl;
+                return 1;
+            }
+            continue;
+        }
+        
+        if (arg == "--log-file" && has_value) {
+            logging.log_path = argv[++i];
+            continue;
+        }
+        
         // First non-flag argument is port
         if (arg[0] != '-' && i == 1) {
             port = std::atoi(arg.c_str());
@@ -562,14 +1388,26 @@ int main(int argc, char* argv[]) {
     std::cout << "========================================\n" << std::endl;
     
     setup_signal_handlers();
+    raise_file_limit();
+    
+    if (!Logger::instance().start(logging)) {
+        return 1;
+    }
     
     std::cout << "[Gateway] Configuration:" << std::endl;
     std::cout << "  Port: " << port << std::endl;
-    std::cout << "  Engine socket: " << engine_socket << std::endl;
+    if (engine_shm.empty()) {
+        std::cout << "  Engine socket: " << engine_socket << std::endl;
+    } else {
+        std::cout << "  Engine rings: " << engine_shm << std::endl;
+    }
+    std::cout << "  Reactors: " << reactor_count << " x " << reactor_backend_name(backend) << std::endl;
+    std::cout << "  Cancel on disconnect: " << (cancel_on_disconnect ? "on" : "off") << std::endl;
     std::cout << std::endl;
     
     // Create and start gateway
-    GatewayServer gateway(port, engine_socket);
+    GatewayServer gateway(port, engine_socket, engine_shm, wait_mode, reactor_count, backend,
+                          cancel_on_disconnect);
     
     if (!gateway.start()) {
         std::cerr << "[Gateway] Failed to start server" << std::endl;
@@ -581,6 +1419,7 @@ int main(int argc, char* argv[]) {
     
     // Cleanup
     gateway.stop();
+    Logger::instance().stop();
     
     std::cout << "[Gateway] Shutdown complete" << std::endl;
     return 0;
@@ -26,7 +26,7 @@ workspace "MatchingEngine"
         
     filter "system:linux"
         buildoptions { "-std=c++17", "-Wall", "-Wextra", "-pthread" }
-        links { "pthread" }
+        links { "pthread", "rt" }
         
     filter "system:macosx"
         buildoptions { "-std=c++17", "-Wall", "-Wextra", "-pthread" }
@@ -125,3 +125,32 @@ project "TradingClient"
     }
     
     targetname "trading_client"
+
+-- =============================================================================
+-- TESTS - Server Test Suite
+-- =============================================================================
+project "Tests"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+    
+    targetdir (basedir .. "/bin/" .. outputdir .. "/%{prj.name}")
+    objdir (basedir .. "/build/obj/" .. outputdir .. "/%{prj.name}")
+    
+    files {
+        basedir .. "/tests/**.cpp",
+        basedir .. "/engine/src/journal.cpp",
+        basedir .. "/engine/src/journal.h",
+        basedir .. "/engine/src/market_data.cpp",
+        basedir .. "/engine/src/market_data.h",
+        basedir .. "/gateway/src/framing.h",
+        basedir .. "/common/**.h"
+    }
+    
+    includedirs {
+        basedir .. "/engine/src",
+        basedir .. "/gateway/src",
+        basedir .. "/common"
+    }
+    
+    targetname "me_server_tests"
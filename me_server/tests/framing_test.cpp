@@ -0,0 +1,295 @@
+// me_server test suite: gateway frame reader and send queue
+
+#include "test_harness.h"
+#include "framing.h"
+#include "../common/protocol.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace matching::gateway;
+using namespace matching::protocol;
+
+namespace {
+
+constexpr size_t MAX_FRAME = 256;
+
+struct Frame {
+    std::vector<uint8_t> bytes;
+};
+
+// v1, v2, v1: one frame of each prefix and two v1 lengths
+std::vector<uint8_t> make_stream(std::vector<Frame>& frames) {
+    NewOrderMessage order;
+    order.header.length = sizeof(order);
+    order.client_order_id = 1;
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&order);
+    frames.push_back(Frame{std::vector<uint8_t>(bytes, bytes + sizeof(order))});
+
+    FrameHeaderV2 header;
+    header.count = 1;
+    header.length = static_cast<uint32_t>(sizeof(header) + sizeof(order));
+    std::vector<uint8_t> v2(reinterpret_cast<const uint8_t*>(&header),
+                            reinterpret_cast<const uint8_t*>(&header) + sizeof(header));
+    order.client_order_id = 2;
+    v2.insert(v2.end(), bytes, bytes + sizeof(order));
+    frames.push_back(Frame{v2});
+
+    CancelOrderMessage cancel;
+    cancel.header.length = sizeof(cancel);
+    const uint8_t* cancel_bytes = reinterpret_cast<const uint8_t*>(&cancel);
+    frames.push_back(Frame{std::vector<uint8_t>(cancel_bytes, cancel_bytes + sizeof(cancel))});
+
+    std::vector<uint8_t> stream;
+    for (const Frame& frame : frames) {
+        stream.insert(stream.end(), frame.bytes.begin(), frame.bytes.end());
+    }
+    return stream;
+}
+
+// Feeds stream to a fresh reader in reads of the given sizes (the last
+// one repeats); true if exactly the expected frames come out
+bool frames_match(const std::vector<uint8_t>& stream, const std::vector<Frame>& expected,
+                  const std::vector<size_t>& reads) {
+    FrameReader reader(MAX_FRAME);
+    std::vector<std::vector<uint8_t>> received;
+    auto on_frame = [&](const MessageHeader* frame, size_t length) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(frame);
+        received.emplace_back(bytes, bytes + length);
+    };
+
+    size_t offset = 0;
+    for (size_t i = 0; offset < stream.size(); i++) {
+        size_t size = std::min(reads[std::min(i, reads.size() - 1)], stream.size() - offset);
+        if (reader.consume(stream.data() + offset, size, on_frame) != nullptr) {
+            return false;
+        }
+        offset += size;
+    }
+
+    if (received.size() != expected.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < expected.size(); i++) {
+        if (received[i] != expected[i].bytes) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Error from the first read that reports one, or "" if none did
+std::string consume_error(const std::vector<uint8_t>& bytes, size_t first_read) {
+    FrameReader reader(MAX_FRAME);
+    auto on_frame = [](const MessageHeader*, size_t) {};
+    size_t split = std::min(first_read, bytes.size());
+    if (const char* error = reader.consume(bytes.data(), split, on_frame)) {
+        return error;
+    }
+    if (const char* error = reader.consume(bytes.data() + split, bytes.size() - split, on_frame)) {
+        return error;
+    }
+    return "";
+}
+
+std::vector<uint8_t> header_bytes(uint8_t version, uint32_t length) {
+    std::vector<uint8_t> bytes(sizeof(MessageHeader), 0);
+    bytes[0] = version;
+    memcpy(bytes.data() + offsetof(MessageHeader, length), &length, sizeof(length));
+    return bytes;
+}
+
+// Distinct bytes per stream position, so a reordering shows
+std::vector<uint8_t> pattern(size_t start, size_t count) {
+    std::vector<uint8_t> bytes(count);
+    for (size_t i = 0; i < count; i++) {
+        bytes[i] = static_cast<uint8_t>(((start + i) * 7) % 251);
+    }
+    return bytes;
+}
+
+// Appends what one read returns, up to limit bytes in out
+bool read_some(int fd, std::vector<uint8_t>& out, size_t limit) {
+    pollfd entry{fd, POLLIN, 0};
+    if (poll(&entry, 1, 2000) != 1) {
+        return false;
+    }
+    uint8_t buffer[65536];
+    ssize_t received = read(fd, buffer, std::min(sizeof(buffer), limit - out.size()));
+    if (received <= 0) {
+        return false;
+    }
+    out.insert(out.end(), buffer, buffer + received);
+    return true;
+}
+
+bool read_exactly(int fd, std::vector<uint8_t>& out, size_t count) {
+    while (out.size() < count) {
+        if (!read_some(fd, out, count)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// =============================================================================
+// TESTS
+// =============================================================================
+
+// Every way of splitting the stream into two reads, and one byte at a
+// time, yields the same frames
+bool test_frame_split_across_reads() {
+    std::vector<Frame> frames;
+    std::vector<uint8_t> stream = make_stream(frames);
+
+    for (size_t split = 1; split < stream.size(); split++) {
+        CHECK(frames_match(stream, frames, {split, stream.size()}));
+    }
+    CHECK(frames_match(stream, frames, {1}));
+    CHECK(frames_match(stream, frames, {3}));
+    CHECK(frames_match(stream, frames, {FRAME_PREFIX + 1}));
+
+    // Direct reads into the reader's own buffer, in short pieces
+    FrameReader reader(MAX_FRAME);
+    std::vector<std::vector<uint8_t>> received;
+    auto on_frame = [&](const MessageHeader* frame, size_t length) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(frame);
+        received.emplace_back(bytes, bytes + length);
+    };
+    for (size_t offset = 0; offset < stream.size();) {
+        size_t size = std::min<size_t>({5, stream.size() - offset, reader.room()});
+        memcpy(reader.space(), stream.data() + offset, size);
+        CHECK(reader.commit(size, on_frame) == nullptr);
+        offset += size;
+    }
+    CHECK(received.size() == frames.size());
+    for (size_t i = 0; i < frames.size(); i++) {
+        CHECK(received[i] == frames[i].bytes);
+    }
+    return true;
+}
+
+// Lengths outside [header, max_length] and unknown versions are errors,
+// whether the prefix arrives whole or split
+bool test_frame_bad_lengths() {
+    for (size_t first_read : {size_t(3), size_t(FRAME_PREFIX), size_t(64)}) {
+        CHECK(consume_error(header_bytes(PROTOCOL_VERSION, MAX_FRAME + 1), first_read) ==
+              "Invalid message length");
+        CHECK(consume_error(header_bytes(PROTOCOL_VERSION, sizeof(MessageHeader) - 1), first_read) ==
+              "Invalid message length");
+        CHECK(consume_error(header_bytes(PROTOCOL_VERSION_2, sizeof(FrameHeaderV2) - 1), first_read) ==
+              "Invalid message length");
+        CHECK(consume_error(header_bytes(PROTOCOL_VERSION_2, 0xFFFFFFFFu), first_read) ==
+              "Invalid message length");
+        CHECK(consume_error(header_bytes(7, sizeof(MessageHeader)), first_read) ==
+              "Invalid protocol version");
+    }
+
+    // The bounds themselves are frames
+    std::vector<uint8_t> largest = header_bytes(PROTOCOL_VERSION, MAX_FRAME);
+    largest.resize(MAX_FRAME, 0);
+    CHECK(consume_error(largest, 3) == "");
+    CHECK(consume_error(header_bytes(PROTOCOL_VERSION, sizeof(MessageHeader)), 3) == "");
+    std::vector<uint8_t> empty_v2 = header_bytes(PROTOCOL_VERSION_2, sizeof(FrameHeaderV2));
+    empty_v2.resize(sizeof(FrameHeaderV2));
+    CHECK(consume_error(empty_v2, 3) == "");
+
+    // Frames before a bad one are still handed out
+    std::vector<Frame> frames;
+    std::vector<uint8_t> stream = make_stream(frames);
+    std::vector<uint8_t> bad = header_bytes(PROTOCOL_VERSION, MAX_FRAME + 1);
+    stream.insert(stream.end(), bad.begin(), bad.end());
+    FrameReader reader(MAX_FRAME);
+    size_t count = 0;
+    const char* error = reader.consume(stream.data(), stream.size(),
+                                       [&](const MessageHeader*, size_t) { count++; });
+    CHECK(error != nullptr);
+    CHECK(count == frames.size());
+    return true;
+}
+
+// Bytes written across the end of the ring go out as two iovecs, in
+// order, including when the socket takes only part of them, and survive
+// the ring growing while wrapped
+bool test_send_queue_wraps() {
+    int fds[2];
+    CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL, 0) | O_NONBLOCK);
+
+    SendQueue queue(1 << 20);
+    size_t position = 0;
+    std::vector<uint8_t> expected;
+    auto append = [&](size_t count) {
+        std::vector<uint8_t> bytes = pattern(position, count);
+        position += count;
+        expected.insert(expected.end(), bytes.begin(), bytes.end());
+        return queue.append(bytes.data(), bytes.size());
+    };
+
+    // 4096-byte ring: move head and tail to 3000, then wrap 2000 bytes
+    std::vector<uint8_t> received;
+    CHECK(append(3000));
+    CHECK(queue.flush(fds[0]));
+    CHECK(queue.empty());
+    CHECK(append(2000));
+    CHECK(queue.flush(fds[0]));
+    CHECK(queue.empty());
+    CHECK(read_exactly(fds[1], received, expected.size()));
+    CHECK(received == expected);
+
+    // Head near the end of the ring again, wrapped, then grown past it
+    CHECK(append(3000));
+    CHECK(queue.flush(fds[0]));
+    CHECK(append(2000));
+    CHECK(append(6000));
+    CHECK(queue.size() == 8000);
+
+    // More than the socket holds: flush stops at EAGAIN, keeps the rest
+    while (queue.size() < 600000) {
+        CHECK(append(50000));
+    }
+    CHECK(queue.flush(fds[0]));
+    CHECK(!queue.empty());
+    while (!queue.empty()) {
+        CHECK(read_some(fds[1], received, expected.size()));
+        CHECK(queue.flush(fds[0]));
+    }
+    CHECK(read_exactly(fds[1], received, expected.size()));
+    CHECK(received == expected);
+
+    close(fds[0]);
+    close(fds[1]);
+    return true;
+}
+
+// append() refuses what would take the queue past its limit, and the
+// queue stays usable
+bool test_send_queue_limit() {
+    SendQueue queue(8192);
+    std::vector<uint8_t> bytes = pattern(0, 8192);
+    CHECK(queue.append(bytes.data(), 5000));
+    CHECK(!queue.append(bytes.data(), 3193));
+    CHECK(queue.size() == 5000);
+    CHECK(queue.append(bytes.data(), 3192));
+    CHECK(queue.size() == 8192);
+    return true;
+}
+
+const TestCase TESTS[] = {
+    { "frame split across reads", test_frame_split_across_reads },
+    { "frame bad lengths", test_frame_bad_lengths },
+    { "send queue wraps", test_send_queue_wraps },
+    { "send queue limit", test_send_queue_limit },
+};
+
+} // namespace
+
+TestSuite framing_tests() {
+    return TestSuite{TESTS, sizeof(TESTS) / sizeof(TESTS[0])};
+}
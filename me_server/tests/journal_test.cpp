@@ -0,0 +1,135 @@
+// me_server test suite: journal writer and reader
+
+#include "test_harness.h"
+#include "journal.h"
+#include "../common/protocol.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+using namespace matching::engine;
+using namespace matching::protocol;
+
+namespace {
+
+std::string make_temp_directory() {
+    char pattern[] = "/tmp/me_server_journal_XXXXXX";
+    const char* directory = mkdtemp(pattern);
+    return directory ? directory : "";
+}
+
+NewOrderMessage make_order(uint64_t client_order_id) {
+    NewOrderMessage msg;
+    snprintf(msg.symbol, sizeof(msg.symbol), "TEST");
+    msg.client_order_id = client_order_id;
+    msg.user_id = 1;
+    msg.price = 15000;
+    msg.quantity = 100;
+    return msg;
+}
+
+// =============================================================================
+// TESTS
+// =============================================================================
+
+// Records come back in order, numbered from 1
+bool test_round_trip() {
+    std::string directory = make_temp_directory();
+    CHECK(!directory.empty());
+
+    const uint64_t count = 1000;
+    {
+        JournalConfig config;
+        config.directory = directory;
+        config.sync_mode = SyncMode::NONE;
+        config.queue_capacity = 64;
+        Journal journal(config);
+        CHECK(journal.open(0));
+        for (uint64_t i = 1; i <= count; i++) {
+            NewOrderMessage msg = make_order(i);
+            CHECK(journal.append(&msg, sizeof(msg), i) == i);
+        }
+        journal.close();
+        CHECK(!journal.failed());
+        CHECK(journal.durable_sequence() == count);
+    }
+
+    JournalReader reader;
+    CHECK(reader.open(directory, 0));
+    JournalEntry entry;
+    uint64_t expected = 1;
+    while (reader.next(entry)) {
+        CHECK(entry.sequence == expected);
+        CHECK(entry.length == sizeof(NewOrderMessage));
+        CHECK(reinterpret_cast<const NewOrderMessage*>(entry.data)->client_order_id == expected);
+        expected++;
+    }
+    CHECK(expected == count + 1);
+    CHECK(!reader.has_gap());
+
+    remove_directory(directory);
+    return true;
+}
+
+// A writer that fails stops draining; appends waiting on a full queue
+// must give up with 0 rather than spin forever
+bool test_append_after_writer_failure() {
+    std::string directory = make_temp_directory();
+    CHECK(!directory.empty());
+
+    JournalConfig config;
+    config.directory = directory;
+    config.sync_mode = SyncMode::NONE;
+    config.segment_size = 1ull << 20;       // The minimum - rolls after ~8k records
+    config.queue_capacity = 16;
+    Journal journal(config);
+    CHECK(journal.open(0));
+
+    // The open segment stays writable, but the roll to the next one fails
+    remove_directory(directory);
+
+    // More records than one segment holds, through a queue the producer
+    // keeps full
+    std::future<uint64_t> appended = std::async(std::launch::async, [&journal]() {
+        NewOrderMessage msg = make_order(1);
+        for (uint64_t i = 1; i <= (1u << 20); i++) {
+            if (journal.append(&msg, sizeof(msg), i) == 0) {
+                return i - 1;
+            }
+        }
+        return static_cast<uint64_t>(1u << 20);
+    });
+
+    if (appended.wait_for(std::chrono::seconds(10)) != std::future_status::ready) {
+        std::cerr << "  append still blocked 10 s after the writer failed" << std::endl;
+        std::_Exit(1);      // The producer thread cannot be joined
+    }
+
+    uint64_t accepted = appended.get();
+    CHECK(accepted < (1u << 20));
+    CHECK(journal.failed());
+    CHECK(journal.get_statistics().producer_stalls > 0);
+
+    // Later appends fail straight away
+    NewOrderMessage msg = make_order(2);
+    CHECK(journal.append(&msg, sizeof(msg), 0) == 0);
+    CHECK(journal.last_sequence() == accepted);
+
+    journal.close();
+    return true;
+}
+
+const TestCase TESTS[] = {
+    { "journal round trip", test_round_trip },
+    { "append after writer failure", test_append_after_writer_failure },
+};
+
+} // namespace
+
+TestSuite journal_tests() {
+    return TestSuite{TESTS, sizeof(TESTS) / sizeof(TESTS[0])};
+}
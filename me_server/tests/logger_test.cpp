@@ -0,0 +1,105 @@
+// me_server test suite: asynchronous logger
+
+#include "test_harness.h"
+#include "../common/logger.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace matching::logging;
+
+namespace {
+
+const char* const MARKER = "logger-test";
+
+uint64_t count_lines(const std::string& path, const char* marker) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file) {
+        return 0;
+    }
+    uint64_t count = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        if (strstr(line, marker)) {
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+// =============================================================================
+// TESTS
+// =============================================================================
+
+// Every record is either written or counted as dropped, including those
+// logged while stop() runs
+bool test_stop_loses_nothing() {
+    char pattern[] = "/tmp/me_server_logger_XXXXXX";
+    int fd = mkstemp(pattern);
+    CHECK(fd >= 0);
+    close(fd);
+    std::string path = pattern;
+
+    Logger& logger = Logger::instance();
+    const uint32_t threads = 4;
+    const int rounds = 8;
+    uint64_t attempts = 0;
+    uint64_t dropped_before = logger.dropped();
+
+    for (int round = 0; round < rounds; round++) {
+        LogConfig config;
+        config.level = LogLevel::INFO;
+        config.audit = false;
+        config.log_path = path;
+        config.ring_capacity = 64;
+        CHECK(logger.start(config));
+
+        std::atomic<bool> done(false);
+        std::vector<uint64_t> counts(threads, 0);
+        std::vector<std::thread> writers;
+        for (uint32_t t = 0; t < threads; t++) {
+            writers.emplace_back([&done, &counts, t]() {
+                while (!done.load(std::memory_order_relaxed)) {
+                    MX_LOG_INFO("[Test] logger-test thread={} record={}", t, counts[t]);
+                    counts[t]++;
+                }
+            });
+        }
+
+        // Writers keep going through stop() and on into synchronous writes
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        logger.stop();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        done.store(true, std::memory_order_relaxed);
+        for (std::thread& writer : writers) {
+            writer.join();
+        }
+        for (uint64_t count : counts) {
+            attempts += count;
+        }
+    }
+
+    uint64_t dropped = logger.dropped() - dropped_before;
+    uint64_t written = count_lines(path, MARKER);
+    unlink(path.c_str());
+    CHECK(written > 0);
+    CHECK(written + dropped == attempts);
+    return true;
+}
+
+const TestCase TESTS[] = {
+    { "logger stop loses nothing", test_stop_loses_nothing },
+};
+
+} // namespace
+
+TestSuite logger_tests() {
+    return TestSuite{TESTS, sizeof(TESTS) / sizeof(TESTS[0])};
+}
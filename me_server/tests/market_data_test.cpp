@@ -0,0 +1,396 @@
+// me_server test suite: L2 market data publisher, driven over loopback
+
+#include "test_harness.h"
+#include "market_data.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace matching::engine;
+using namespace matching::protocol;
+namespace md = matching::market_data;
+
+namespace {
+
+constexpr int RECEIVE_TIMEOUT_MS = 2000;
+
+// One received datagram, split into its messages
+struct ReceivedPacket {
+    md::PacketHeader header;
+    std::vector<std::vector<uint8_t>> messages;
+    std::vector<uint8_t> bytes;
+    std::chrono::steady_clock::time_point arrived;
+};
+
+struct Socket {
+    int fd;
+
+    Socket() : fd(socket(AF_INET, SOCK_DGRAM, 0)) {}
+    ~Socket() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+};
+
+sockaddr_in loopback(uint16_t port) {
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+}
+
+bool wait_readable(int fd, int timeout_ms) {
+    pollfd entry{fd, POLLIN, 0};
+    return poll(&entry, 1, timeout_ms) == 1;
+}
+
+// Next feed packet on fd; heartbeats are skipped
+bool receive_packet(int fd, ReceivedPacket& packet, int timeout_ms = RECEIVE_TIMEOUT_MS) {
+    for (;;) {
+        if (!wait_readable(fd, timeout_ms)) {
+            return false;
+        }
+        uint8_t data[md::MD_MAX_PACKET];
+        ssize_t received = recv(fd, data, sizeof(data), 0);
+        if (received < static_cast<ssize_t>(sizeof(md::PacketHeader))) {
+            return false;
+        }
+
+        packet.arrived = std::chrono::steady_clock::now();
+        memcpy(&packet.header, data, sizeof(packet.header));
+        if (packet.header.magic != md::MD_MAGIC || packet.header.message_count == 0) {
+            continue;
+        }
+        packet.bytes.assign(data, data + received);
+        packet.messages.clear();
+        size_t offset = sizeof(md::PacketHeader);
+        for (uint16_t i = 0; i < packet.header.message_count; i++) {
+            uint8_t length = data[offset + 1];
+            if (length == 0 || offset + length > static_cast<size_t>(received)) {
+                return false;
+            }
+            packet.messages.emplace_back(data + offset, data + offset + length);
+            offset += length;
+        }
+        return true;
+    }
+}
+
+// define_symbol() copies a full 16-byte name
+void define_symbol(MarketDataSource* source, uint32_t symbol_id, const char* text) {
+    char name[16] = {};
+    strncpy(name, text, sizeof(name) - 1);
+    source->define_symbol(symbol_id, name);
+}
+
+md::LevelUpdate as_update(const std::vector<uint8_t>& message) {
+    md::LevelUpdate update;
+    memcpy(&update, message.data(), std::min(message.size(), sizeof(update)));
+    return update;
+}
+
+// A publisher sending to a socket of ours on loopback; the recovery port
+// is the feed port + 2, so retry until both are free
+struct Feed {
+    Socket incremental;
+    std::unique_ptr<MarketDataPublisher> publisher;
+    MarketDataSource* source;
+    uint16_t recovery_port;
+
+    Feed() : source(nullptr), recovery_port(0) {}
+
+    bool start(MarketDataConfig config) {
+        for (int attempt = 0; attempt < 20; attempt++) {
+            Socket candidate;
+            sockaddr_in address = loopback(0);
+            socklen_t length = sizeof(address);
+            if (bind(candidate.fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+                getsockname(candidate.fd, reinterpret_cast<sockaddr*>(&address), &length) != 0 ||
+                ntohs(address.sin_port) > 65533) {
+                continue;
+            }
+
+            config.group = "127.0.0.1";
+            config.interface = "127.0.0.1";
+            config.port = ntohs(address.sin_port);
+            config.snapshot_interval_ms = 0;
+            publisher.reset(new MarketDataPublisher(config));
+            source = publisher->add_source();
+            if (publisher->start()) {
+                std::swap(incremental.fd, candidate.fd);
+                recovery_port = static_cast<uint16_t>(config.port + 2);
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// Sends request to the recovery port, answering the publisher's challenge
+bool send_request(int fd, uint16_t recovery_port, md::RecoveryRequest request) {
+    sockaddr_in to = loopback(recovery_port);
+    request.token = 0;
+    sendto(fd, &request, sizeof(request), 0, reinterpret_cast<sockaddr*>(&to), sizeof(to));
+
+    md::RecoveryChallenge challenge;
+    if (!wait_readable(fd, RECEIVE_TIMEOUT_MS) ||
+        recv(fd, &challenge, sizeof(challenge), 0) != static_cast<ssize_t>(sizeof(challenge)) ||
+        challenge.type != static_cast<uint8_t>(md::MdMessageType::CHALLENGE)) {
+        return false;
+    }
+
+    request.token = challenge.token;
+    return sendto(fd, &request, sizeof(request), 0, reinterpret_cast<sockaddr*>(&to), sizeof(to)) ==
+           static_cast<ssize_t>(sizeof(request));
+}
+
+// =============================================================================
+// TESTS
+// =============================================================================
+
+// Resting quantity deltas become ADD, MODIFY, DELETE of the aggregate level;
+// deltas that change nothing publish nothing
+bool test_level_actions() {
+    Feed feed;
+    CHECK(feed.start(MarketDataConfig()));
+
+    define_symbol(feed.source, 0, "TEST");
+    feed.source->level_delta(0, Side::BUY, 10000, 10, 1);
+    feed.source->level_delta(0, Side::BUY, 10000, 5, 1);
+    feed.source->level_delta(0, Side::SELL, 10100, -5, -1);     // Nothing resting there
+    feed.source->level_delta(0, Side::BUY, 10000, 0, 0);
+    feed.source->level_delta(0, Side::BUY, 10000, -15, -2);
+    feed.source->level_delta(0, Side::SELL, 10100, 7, 1);
+
+    std::vector<std::vector<uint8_t>> messages;
+    uint64_t expected_sequence = 1;
+    while (messages.size() < 5) {
+        ReceivedPacket packet;
+        CHECK(receive_packet(feed.incremental.fd, packet));
+        CHECK(packet.header.channel == static_cast<uint8_t>(md::Channel::INCREMENTAL));
+        CHECK(packet.header.sequence == expected_sequence);
+        expected_sequence += packet.header.message_count;
+        messages.insert(messages.end(), packet.messages.begin(), packet.messages.end());
+    }
+    CHECK(messages.size() == 5);
+
+    md::SymbolDefinition definition;
+    memcpy(&definition, messages[0].data(), sizeof(definition));
+    CHECK(definition.type == static_cast<uint8_t>(md::MdMessageType::SYMBOL_DEFINITION));
+    CHECK(strcmp(definition.symbol, "TEST") == 0);
+
+    struct Expected {
+        md::LevelAction action;
+        Side side;
+        uint64_t price;
+        uint64_t quantity;
+        uint32_t orders;
+    };
+    const Expected expected[] = {
+        { md::LevelAction::ADD, Side::BUY, 10000, 10, 1 },
+        { md::LevelAction::MODIFY, Side::BUY, 10000, 15, 2 },
+        { md::LevelAction::DELETE, Side::BUY, 10000, 0, 0 },
+        { md::LevelAction::ADD, Side::SELL, 10100, 7, 1 },
+    };
+    for (size_t i = 0; i < 4; i++) {
+        md::LevelUpdate update = as_update(messages[i + 1]);
+        CHECK(update.type == static_cast<uint8_t>(md::MdMessageType::LEVEL_UPDATE));
+        CHECK(update.symbol_id == definition.symbol_id);
+        CHECK(update.action == static_cast<uint8_t>(expected[i].action));
+        CHECK(update.side == static_cast<uint8_t>(expected[i].side));
+        CHECK(update.price == expected[i].price);
+        CHECK(update.quantity == expected[i].quantity);
+        CHECK(update.order_count == expected[i].orders);
+    }
+
+    CHECK(feed.publisher->get_statistics().level_updates == 4);
+    return true;
+}
+
+// A subscriber whose window budget cannot hold the whole book gets one
+// packet a window, the rest carried to later windows, every level once
+bool test_conflation_budget_carries_over() {
+    MarketDataConfig config;
+    config.conflation_packets = 1;
+    Feed feed;
+    CHECK(feed.start(config));
+
+    const uint32_t levels = 100;
+    define_symbol(feed.source, 0, "DEEP");
+    for (uint32_t i = 0; i < levels; i++) {
+        feed.source->level_delta(0, Side::BUY, 10000 - i, i + 1, 1);
+    }
+
+    // Every level on the feed, so the publisher holds the whole book
+    size_t published = 0;
+    while (published < levels + 1) {
+        ReceivedPacket packet;
+        CHECK(receive_packet(feed.incremental.fd, packet));
+        published += packet.messages.size();
+    }
+
+    Socket subscriber;
+    const uint32_t window_us = 20000;
+    md::RecoveryRequest request;
+    request.type = static_cast<uint8_t>(md::MdMessageType::SUBSCRIBE);
+    request.window_us = window_us;
+    CHECK(send_request(subscriber.fd, feed.recovery_port, request));
+
+    std::vector<ReceivedPacket> packets;
+    std::vector<bool> seen(levels, false);
+    uint32_t updates = 0;
+    uint64_t expected_sequence = 1;
+    while (updates < levels) {
+        ReceivedPacket packet;
+        CHECK(receive_packet(subscriber.fd, packet));
+        CHECK(packet.header.channel == static_cast<uint8_t>(md::Channel::CONFLATED));
+        CHECK(packet.header.sequence == expected_sequence);
+        expected_sequence += packet.header.message_count;
+
+        for (const auto& message : packet.messages) {
+            if (message[0] != static_cast<uint8_t>(md::MdMessageType::LEVEL_UPDATE)) {
+                continue;
+            }
+            md::LevelUpdate update = as_update(message);
+            uint32_t index = static_cast<uint32_t>(10000 - update.price);
+            CHECK(index < levels && !seen[index]);
+            CHECK(update.quantity == index + 1);
+            seen[index] = true;
+            updates++;
+        }
+        packets.push_back(packet);
+    }
+
+    // Three windows' worth, each a single packet
+    CHECK(packets.size() == 3);
+    CHECK(packets[0].bytes.size() + sizeof(md::LevelUpdate) > md::MD_MAX_PACKET);
+    CHECK(packets[1].bytes.size() + sizeof(md::LevelUpdate) > md::MD_MAX_PACKET);
+    CHECK(packets[2].arrived - packets[0].arrived >= std::chrono::microseconds(window_us));
+
+    md::RecoveryRequest unsubscribe;
+    unsubscribe.type = static_cast<uint8_t>(md::MdMessageType::UNSUBSCRIBE);
+    CHECK(send_request(subscriber.fd, feed.recovery_port, unsubscribe));
+    return true;
+}
+
+// Retransmission starts from the kept packet holding the first sequence
+// asked for, and names the oldest kept sequence when it is too old
+bool test_retransmit_finds_range() {
+    MarketDataConfig config;
+    config.retransmit_packets = 8;
+    Feed feed;
+    CHECK(feed.start(config));
+
+    // One or more packets per batch: wait for each batch to go out
+    std::vector<ReceivedPacket> sent;
+    define_symbol(feed.source, 0, "GAPS");
+    uint64_t next_sequence = 1;
+    for (uint32_t batch = 0; batch <= 20; batch++) {
+        for (uint32_t i = 0; batch > 0 && i < 3; i++) {
+            feed.source->level_delta(0, Side::SELL, 20000 + batch * 10 + i, 1, 1);
+        }
+        uint64_t end = batch == 0 ? 2 : 2 + batch * 3;
+        while (next_sequence < end) {
+            ReceivedPacket packet;
+            CHECK(receive_packet(feed.incremental.fd, packet));
+            CHECK(packet.header.sequence == next_sequence);
+            next_sequence += packet.header.message_count;
+            sent.push_back(packet);
+        }
+    }
+    CHECK(sent.size() > 8);
+
+    Socket client;
+    md::RecoveryRequest request;
+    request.type = static_cast<uint8_t>(md::MdMessageType::RETRANSMIT_REQUEST);
+
+    // From the last message of a kept packet through the next two packets
+    const ReceivedPacket& from = sent[sent.size() - 5];
+    const ReceivedPacket& to = sent[sent.size() - 3];
+    request.first_sequence = from.header.sequence + from.header.message_count - 1;
+    request.count = static_cast<uint32_t>(to.header.sequence + to.header.message_count - request.first_sequence);
+    CHECK(send_request(client.fd, feed.recovery_port, request));
+    for (size_t i = sent.size() - 5; i <= sent.size() - 3; i++) {
+        ReceivedPacket packet;
+        CHECK(receive_packet(client.fd, packet));
+        CHECK(packet.header.channel == static_cast<uint8_t>(md::Channel::RETRANSMIT));
+        CHECK(packet.header.sequence == sent[i].header.sequence);
+        CHECK(packet.bytes.size() == sent[i].bytes.size());
+        CHECK(memcmp(packet.bytes.data() + sizeof(md::PacketHeader),
+                     sent[i].bytes.data() + sizeof(md::PacketHeader),
+                     packet.bytes.size() - sizeof(md::PacketHeader)) == 0);
+    }
+    CHECK(!wait_readable(client.fd, 100));
+
+    // Older than the ring keeps
+    request.first_sequence = 1;
+    request.count = 1;
+    CHECK(send_request(client.fd, feed.recovery_port, request));
+    uint8_t data[md::MD_MAX_PACKET];
+    CHECK(wait_readable(client.fd, RECEIVE_TIMEOUT_MS));
+    CHECK(recv(client.fd, data, sizeof(data), 0) ==
+          static_cast<ssize_t>(sizeof(md::PacketHeader) + sizeof(md::RetransmitReject)));
+    md::RetransmitReject reject;
+    memcpy(&reject, data + sizeof(md::PacketHeader), sizeof(reject));
+    CHECK(reject.type == static_cast<uint8_t>(md::MdMessageType::RETRANSMIT_REJECT));
+    CHECK(reject.first_available == sent[sent.size() - 8].header.sequence);
+
+    CHECK(feed.publisher->get_statistics().packets_retransmitted == 3);
+    return true;
+}
+
+// Nothing but a challenge, no bigger than the request, until the token
+// for the sender's address comes back
+bool test_recovery_requires_token() {
+    Feed feed;
+    CHECK(feed.start(MarketDataConfig()));
+    define_symbol(feed.source, 0, "AUTH");
+    ReceivedPacket packet;
+    CHECK(receive_packet(feed.incremental.fd, packet));
+
+    Socket client;
+    sockaddr_in to = loopback(feed.recovery_port);
+    md::RecoveryRequest request;
+    request.type = static_cast<uint8_t>(md::MdMessageType::RETRANSMIT_REQUEST);
+    request.first_sequence = 1;
+    request.count = 1;
+    request.token = 12345;
+    sendto(client.fd, &request, sizeof(request), 0, reinterpret_cast<sockaddr*>(&to), sizeof(to));
+
+    uint8_t data[md::MD_MAX_PACKET];
+    CHECK(wait_readable(client.fd, RECEIVE_TIMEOUT_MS));
+    ssize_t received = recv(client.fd, data, sizeof(data), 0);
+    CHECK(received == static_cast<ssize_t>(sizeof(md::RecoveryChallenge)));
+    CHECK(received < static_cast<ssize_t>(sizeof(request)));
+    CHECK(data[4] == static_cast<uint8_t>(md::MdMessageType::CHALLENGE));
+    CHECK(feed.publisher->get_statistics().packets_retransmitted == 0);
+
+    CHECK(send_request(client.fd, feed.recovery_port, request));
+    CHECK(receive_packet(client.fd, packet));
+    CHECK(packet.header.channel == static_cast<uint8_t>(md::Channel::RETRANSMIT));
+    CHECK(packet.header.sequence == 1);
+    return true;
+}
+
+const TestCase TESTS[] = {
+    { "market data level actions", test_level_actions },
+    { "conflation budget carries over", test_conflation_budget_carries_over },
+    { "retransmit finds range", test_retransmit_finds_range },
+    { "recovery requires token", test_recovery_requires_token },
+};
+
+} // namespace
+
+TestSuite market_data_tests() {
+    return TestSuite{TESTS, sizeof(TESTS) / sizeof(TESTS[0])};
+}
@@ -0,0 +1,39 @@
+#ifndef MATCHING_TEST_HARNESS_H
+#define MATCHING_TEST_HARNESS_H
+
+#include <cstddef>
+#include <iostream>
+
+// =============================================================================
+// TEST HARNESS
+// =============================================================================
+// Each test returns true on success; test_main.cpp runs every suite and
+// exits non-zero if any test failed. A test that would hang fails on a
+// timeout.
+
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            std::cerr << "  " << __FILE__ << ":" << __LINE__                    \
+                      << ": CHECK(" #cond ") failed" << std::endl;              \
+            return false;                                                       \
+        }                                                                       \
+    } while (0)
+
+struct TestCase {
+    const char* name;
+    bool (*run)();
+};
+
+struct TestSuite {
+    const TestCase* tests;
+    size_t count;
+};
+
+// One per test file
+TestSuite framing_tests();
+TestSuite journal_tests();
+TestSuite logger_tests();
+TestSuite market_data_tests();
+
+#endif // MATCHING_TEST_HARNESS_H
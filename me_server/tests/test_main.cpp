@@ -0,0 +1,28 @@
+// me_server test suite runner
+
+#include "test_harness.h"
+
+int main() {
+    const TestSuite suites[] = {
+        framing_tests(),
+        journal_tests(),
+        logger_tests(),
+        market_data_tests(),
+    };
+
+    size_t total = 0;
+    size_t failures = 0;
+    for (const TestSuite& suite : suites) {
+        for (size_t i = 0; i < suite.count; i++) {
+            const TestCase& test = suite.tests[i];
+            bool passed = test.run();
+            std::cout << (passed ? "[PASS] " : "[FAIL] ") << test.name << std::endl;
+            if (!passed) {
+                failures++;
+            }
+            total++;
+        }
+    }
+    std::cout << (total - failures) << "/" << total << " tests passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}